@@ -108,6 +108,11 @@ namespace gui
         ImGui_ImplVulkan_RenderDrawData(drawData, commandBuffer);
     }
 
+    void EndFrame()
+    {
+        ImGui::EndFrame();
+    }
+
     void OnFramebufferResized(uint32_t minImageCount)
     {
         ImGui_ImplVulkan_SetMinImageCount(minImageCount);
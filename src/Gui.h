@@ -84,6 +84,12 @@ namespace gui
      */
     void Render(VkCommandBuffer commandBuffer);
 
+    /**
+     * @brief Call after all ImGui draw functions instead of "Render()", if
+     *  nothing is drawn this frame
+     */
+    void EndFrame();
+
     /**
      * @brief Call on frame resized
      */
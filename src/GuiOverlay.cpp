@@ -0,0 +1,401 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "GuiOverlay.h"
+
+#include <bitset>
+#include <cstring>
+
+#include <imgui/imgui.h>
+#include <imgui/backends/imgui_impl_vulkan.h>
+
+#include "core/Profile.h"
+#include "vulkan/GpuProfile.h"
+
+
+namespace gui
+{
+    // Function prototypes
+
+    /** @return Of the vertices, indices and commands of the lists */
+    static uint64_t HashDrawData(const ImDrawData& drawData);
+    /** @return Whether the GUI is interacted with this frame */
+    static bool HasInput();
+
+    // =========================================================================
+    // =========================================================================
+
+    Overlay::Overlay(const vkp::Device& device,
+                     const vkp::DescriptorPool& descriptorPool)
+        : m_kDevice(device),
+          m_kDescriptorPool(descriptorPool)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        CreateDescriptorSetLayout();
+        SetupPipeline();
+
+        auto err = m_kDescriptorPool.AllocateDescriptorSet(
+            *m_DescriptorSetLayout,
+            m_DescriptorSet
+        );
+        VKP_ASSERT_RESULT(err);
+    }
+
+    Overlay::~Overlay()
+    {
+        VKP_REGISTER_FUNCTION();
+        DestroyImage();
+    }
+
+    void Overlay::CreateRenderData(
+        VkRenderPass renderPass,
+        const VkExtent2D kFramebufferExtent,
+        VkFormat imageFormat,
+        VkFormat depthFormat,
+        VkImageView depthView)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        // Composited by the pending frames
+        m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+        DestroyImage();
+
+        m_Extent = kFramebufferExtent;
+        m_DepthView = depthView;
+
+        // Left as a color attachment, transitioned by "RecordRefresh()"
+        m_RenderPass.reset(
+            new vkp::RenderPass(m_kDevice, imageFormat, depthFormat)
+        );
+        auto& colorAttachment = m_RenderPass->GetAttachmentDescriptions()[0];
+        colorAttachment.initialLayout =
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        const bool kHasDepthAttachment = depthView != VK_NULL_HANDLE;
+        m_RenderPass->Create(kHasDepthAttachment);
+
+        m_Pipeline->Create(kFramebufferExtent,
+                           renderPass,
+                           kHasDepthAttachment);
+        m_NeedsRefresh = true;
+    }
+
+    void Overlay::PrepareRender(VkCommandBuffer cmdBuffer, float dt)
+    {
+        VKP_PROFILE_SCOPE();
+        VKP_ASSERT(m_RenderPass != nullptr);
+
+        ImGui::Render();
+        ImDrawData* drawData = ImGui::GetDrawData();
+
+        m_RefreshHistory <<= 1;
+        m_TimeSinceRefresh += dt;
+
+        const bool kIsMinimized = drawData->DisplaySize.x <= 0.0f ||
+                                  drawData->DisplaySize.y <= 0.0f;
+        if (kIsMinimized)
+            return;
+
+        if (m_Image == nullptr)
+            CreateImage(cmdBuffer);
+
+        // Changes without input, e.g., of the times, wait for the interval
+        const uint64_t kHash = HashDrawData(*drawData);
+        const bool kIsDue = m_TimeSinceRefresh >= m_RefreshInterval ||
+                            HasInput();
+        if (!m_NeedsRefresh && (kHash == m_DrawDataHash || !kIsDue))
+            return;
+
+        RecordRefresh(cmdBuffer);
+
+        m_DrawDataHash = kHash;
+        m_TimeSinceRefresh = 0.0f;
+        m_NeedsRefresh = false;
+        m_RefreshHistory |= 1;
+    }
+
+    void Overlay::Render(VkCommandBuffer cmdBuffer) const
+    {
+        if (m_Image == nullptr)
+            return;
+
+        // Dynamic states are not inherited by the secondary buffers
+        vkp::Pipeline::CmdSetViewportScissor(cmdBuffer, m_Extent);
+
+        vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          *m_Pipeline);
+
+        const uint32_t kFirstSet = 0, kDescriptorSetCount = 1;
+        vkCmdBindDescriptorSets(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            m_Pipeline->GetPipelineLayout(),
+            kFirstSet,
+            kDescriptorSetCount,
+            &m_DescriptorSet,
+            0, nullptr
+        );
+
+        // Draw fullscreen triangle
+        const uint32_t kVertexCount = 3, kInstanceCount = 1;
+        const uint32_t kFirstVertex = 0, kFirstInstance = 0;
+        vkCmdDraw(cmdBuffer, kVertexCount, kInstanceCount,
+                             kFirstVertex, kFirstInstance);
+    }
+
+    void Overlay::RecompileShaders(
+        VkRenderPass renderPass,
+        const VkExtent2D kFramebufferExtent,
+        const bool kFramebufferHasDepthAttachment)
+    {
+        if (!m_Pipeline->RecompileShaders())
+            return;
+
+        m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+        m_Pipeline->Create(kFramebufferExtent,
+                           renderPass,
+                           kFramebufferHasDepthAttachment);
+    }
+
+    uint32_t Overlay::GetRefreshCount() const
+    {
+        return static_cast<uint32_t>(
+            std::bitset<s_kRefreshWindow>(m_RefreshHistory).count()
+        );
+    }
+
+    // -------------------------------------------------------------------------
+    // Creation functions
+
+    void Overlay::CreateDescriptorSetLayout()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        m_DescriptorSetLayout = vkp::DescriptorSetLayout::Builder(m_kDevice)
+            // Overlay image
+            .AddBinding({
+                .binding = 0,
+                .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
+            })
+            .Build();
+    }
+
+    void Overlay::SetupPipeline()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        std::vector<std::shared_ptr<vkp::ShaderModule>> shaders;
+        shaders.reserve(s_kShaderInfos.size());
+        for (const auto& kInfo : s_kShaderInfos)
+        {
+            shaders.push_back(
+                std::make_shared<vkp::ShaderModule>(m_kDevice, kInfo)
+            );
+        }
+
+        m_Pipeline = std::make_unique<vkp::Pipeline>(m_kDevice, shaders);
+
+        auto& pipelineLayoutInfo = m_Pipeline->GetPipelineLayoutInfo();
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout->GetLayout();
+
+        // Fullscreen triangle
+        m_Pipeline->SetVertexInputState( vkp::Pipeline::InitVertexInput() );
+
+        auto rasterizationState = vkp::Pipeline::InitRasterization();
+        rasterizationState.cullMode = VK_CULL_MODE_FRONT_BIT;
+        rasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        m_Pipeline->SetRasterizationState(rasterizationState);
+
+        // Over everything, at the far plane of the triangle
+        m_Pipeline->SetDepthState(VK_COMPARE_OP_ALWAYS, false);
+        m_Pipeline->SetPremultipliedBlending();
+    }
+
+    void Overlay::CreateImage(VkCommandBuffer cmdBuffer)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        m_Image.reset(
+            new vkp::Texture2D(m_kDevice, vkp::MemoryTag::Framebuffer)
+        );
+        m_Image->Create(cmdBuffer, m_Extent.width, m_Extent.height,
+                        m_RenderPass->GetAttachmentFormat(),
+                        VK_IMAGE_TILING_OPTIMAL,
+                        VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                        VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT,
+                        VK_IMAGE_USAGE_SAMPLED_BIT |
+                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        const std::array<VkImageView, 2> kAttachments{
+            m_Image->GetImageView(),
+            m_DepthView
+        };
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = *m_RenderPass;
+        framebufferInfo.attachmentCount = m_DepthView != VK_NULL_HANDLE ? 2 : 1;
+        framebufferInfo.pAttachments = kAttachments.data();
+        framebufferInfo.width = m_Extent.width;
+        framebufferInfo.height = m_Extent.height;
+        framebufferInfo.layers = 1;
+
+        auto err = vkCreateFramebuffer(m_kDevice, &framebufferInfo, nullptr,
+                                       &m_Framebuffer);
+        VKP_ASSERT_RESULT(err);
+
+        // Not used by any pending frame, waited for by "CreateRenderData()"
+        VkDescriptorImageInfo imageInfos[1] = { m_Image->GetDescriptor() };
+        imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        vkp::DescriptorWriter(*m_DescriptorSetLayout, m_kDescriptorPool)
+            .AddImageDescriptor(0, &imageInfos[0])
+            .UpdateSet(m_DescriptorSet);
+
+        m_NeedsRefresh = true;
+    }
+
+    void Overlay::DestroyImage()
+    {
+        if (m_Framebuffer != VK_NULL_HANDLE)
+        {
+            vkDestroyFramebuffer(m_kDevice, m_Framebuffer, nullptr);
+            m_Framebuffer = VK_NULL_HANDLE;
+        }
+        m_Image.reset();
+    }
+
+    // -------------------------------------------------------------------------
+    // Update functions
+
+    void Overlay::RecordRefresh(VkCommandBuffer cmdBuffer)
+    {
+        VKP_PROFILE_GPU_SCOPE(cmdBuffer, "GUI overlay");
+
+        vkp::Image& image = m_Image->GetImage();
+
+        // Previous composites of the frames in flight, the contents are
+        //  cleared
+        image.RecordImageBarrier(cmdBuffer,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            0,
+            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        image.SetLayout(VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+        // Transparent, of premultiplied colors
+        const std::array<VkClearValue, 2> kClearValues{
+            VkClearValue{ 0.0f, 0.0f, 0.0f, 0.0f },
+            VkClearValue{ 1.0f, 0.0f, 0.0f, 0.0f }
+        };
+
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = *m_RenderPass;
+        renderPassInfo.framebuffer = m_Framebuffer;
+        renderPassInfo.renderArea.offset = { 0, 0 };
+        renderPassInfo.renderArea.extent = m_Extent;
+        renderPassInfo.clearValueCount =
+            static_cast<uint32_t>(kClearValues.size());
+        renderPassInfo.pClearValues = kClearValues.data();
+
+        vkCmdBeginRenderPass(cmdBuffer, &renderPassInfo,
+                             VK_SUBPASS_CONTENTS_INLINE);
+
+        // Of the pipeline of the main render pass, compatible with this one
+        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmdBuffer);
+
+        vkCmdEndRenderPass(cmdBuffer);
+
+        // Composited by the main render pass of this frame
+        image.RecordImageBarrier(cmdBuffer,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            VK_ACCESS_SHADER_READ_BIT,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        image.SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    // =========================================================================
+    // =========================================================================
+
+    static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+    {
+        // FNV-1a of 8-byte words, then of the remaining bytes
+        constexpr uint64_t kPrime = 0x100000001b3ull;
+        const auto* bytes = static_cast<const uint8_t*>(data);
+
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            hash = (hash ^ word) * kPrime;
+        }
+        for (; i < size; ++i)
+            hash = (hash ^ bytes[i]) * kPrime;
+
+        return hash;
+    }
+
+    template<typename T>
+    static uint64_t HashValue(uint64_t hash, const T& value)
+    {
+        return HashBytes(hash, &value, sizeof(value));
+    }
+
+    static uint64_t HashDrawData(const ImDrawData& drawData)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        hash = HashValue(hash, drawData.DisplayPos);
+        hash = HashValue(hash, drawData.DisplaySize);
+        hash = HashValue(hash, drawData.CmdListsCount);
+
+        for (int i = 0; i < drawData.CmdListsCount; ++i)
+        {
+            const ImDrawList& kList = *drawData.CmdLists[i];
+
+            hash = HashBytes(hash, kList.VtxBuffer.Data,
+                             kList.VtxBuffer.size_in_bytes());
+            hash = HashBytes(hash, kList.IdxBuffer.Data,
+                             kList.IdxBuffer.size_in_bytes());
+
+            // Of the members, not of the padding
+            for (const ImDrawCmd& kCmd : kList.CmdBuffer)
+            {
+                hash = HashValue(hash, kCmd.ClipRect);
+                hash = HashValue(hash, kCmd.TextureId);
+                hash = HashValue(hash, kCmd.VtxOffset);
+                hash = HashValue(hash, kCmd.IdxOffset);
+                hash = HashValue(hash, kCmd.ElemCount);
+            }
+        }
+        return hash;
+    }
+
+    static bool HasInput()
+    {
+        const ImGuiIO& io = ImGui::GetIO();
+
+        const bool kMouseInput = io.MouseDelta.x != 0.0f ||
+                                 io.MouseDelta.y != 0.0f ||
+                                 io.MouseWheel != 0.0f ||
+                                 ImGui::IsAnyMouseDown();
+
+        // Of a widget being edited, e.g., a text field or a dragged slider
+        return (io.WantCaptureMouse && kMouseInput) ||
+               (io.WantCaptureKeyboard && !io.InputQueueCharacters.empty()) ||
+               ImGui::IsAnyItemActive();
+    }
+
+} // namespace gui
@@ -0,0 +1,151 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_GUI_OVERLAY_H_
+#define WATER_SURFACE_RENDERING_GUI_OVERLAY_H_
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan/Device.h"
+#include "vulkan/Descriptors.h"
+#include "vulkan/ShaderModule.h"
+#include "vulkan/Pipeline.h"
+#include "vulkan/RenderPass.h"
+#include "vulkan/Texture2D.h"
+
+
+namespace gui
+{
+    /**
+     * @brief GUI rendered into a cached image of the framebuffer's size,
+     *  composited over the frame by a single full-screen triangle.
+     *
+     * The ImGui frame is built each frame as usual, its draw data hashed: the
+     *  image is rendered again only if the data has changed, at once on any
+     *  input to the GUI, otherwise at most once per refresh interval, e.g.,
+     *  of the status window's times changing every frame. Unchanged frames
+     *  neither upload the vertices nor draw them.
+     *
+     * The pass of the image has the formats of the main render pass, so the
+     *  ImGui pipeline of the main pass draws into it, and only clears the
+     *  depth of the main framebuffer, cleared again by the main pass. The
+     *  backend blends the alpha as "a + (1 - a) * dst" over the transparent
+     *  clear, the image is of premultiplied colors.
+     *
+     * Usage, each frame, after the ImGui windows:
+     *  1. "PrepareRender()" outside the render pass, instead of "Render()"
+     *  2. "Render()" inside the main render pass
+     */
+    class Overlay
+    {
+    public:
+        /** @param descriptorPool Of a combined image sampler, and a set */
+        Overlay(const vkp::Device& device,
+                const vkp::DescriptorPool& descriptorPool);
+        ~Overlay();
+
+        Overlay(const Overlay&) = delete;
+        Overlay& operator=(const Overlay&) = delete;
+
+        /**
+         * @brief Creates the pass of the image and the composite pipeline,
+         *  the image is created by the next "PrepareRender()"
+         * @param depthView Of the main framebuffer, if it has a depth
+         *  attachment of 'depthFormat'
+         */
+        void CreateRenderData(
+            VkRenderPass renderPass,
+            const VkExtent2D kFramebufferExtent,
+            VkFormat imageFormat,
+            VkFormat depthFormat,
+            VkImageView depthView);
+
+        /**
+         * @brief Ends the ImGui frame, renders it into the image if it has
+         *  changed and is due
+         * @param cmdBuffer Command buffer in recording state, outside a render
+         *  pass
+         * @param dt Since the last call, in seconds
+         */
+        void PrepareRender(VkCommandBuffer cmdBuffer, float dt);
+
+        /** @brief Composites the image, inside the main render pass */
+        void Render(VkCommandBuffer cmdBuffer) const;
+
+        void RecompileShaders(
+            VkRenderPass renderPass,
+            const VkExtent2D kFramebufferExtent,
+            const bool kFramebufferHasDepthAttachment);
+
+        /** @brief The next "PrepareRender()" renders the image */
+        void Invalidate() { m_NeedsRefresh = true; }
+
+        /** @param interval In seconds, of the changes without input */
+        void SetRefreshInterval(float interval) {
+            m_RefreshInterval = std::max(interval, 0.0f);
+        }
+        float GetRefreshInterval() const { return m_RefreshInterval; }
+
+        /** @return Of the last "s_kRefreshWindow" frames, rendered ones */
+        uint32_t GetRefreshCount() const;
+        static constexpr uint32_t s_kRefreshWindow{ 64 };
+
+    private:
+        void CreateDescriptorSetLayout();
+        void SetupPipeline();
+        /** @brief Of the image, its framebuffer and descriptor */
+        void CreateImage(VkCommandBuffer cmdBuffer);
+        void DestroyImage();
+
+        /** @brief Records the ImGui draw data into the image */
+        void RecordRefresh(VkCommandBuffer cmdBuffer);
+
+    private:
+        const vkp::Device& m_kDevice;
+        const vkp::DescriptorPool& m_kDescriptorPool;
+
+        static const inline std::array<vkp::ShaderInfo, 2> s_kShaderInfos {
+            vkp::ShaderInfo{
+                .paths = { "shaders/FullScreenQuad.vert" },
+                .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                .isSPV = false
+            },
+            vkp::ShaderInfo{
+                .paths = { "shaders/GuiOverlay.frag" },
+                .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .isSPV = false
+            }
+        };
+
+        std::unique_ptr<vkp::DescriptorSetLayout> m_DescriptorSetLayout{
+            nullptr
+        };
+        VkDescriptorSet m_DescriptorSet{ VK_NULL_HANDLE };
+        std::unique_ptr<vkp::Pipeline> m_Pipeline{ nullptr };
+
+        // Of the formats of the main one, to be compatible with its pipelines
+        std::unique_ptr<vkp::RenderPass> m_RenderPass{ nullptr };
+        VkExtent2D m_Extent{ 0, 0 };
+        VkImageView m_DepthView{ VK_NULL_HANDLE };
+
+        std::unique_ptr<vkp::Texture2D> m_Image{ nullptr };
+        VkFramebuffer m_Framebuffer{ VK_NULL_HANDLE };
+
+        float m_RefreshInterval{ 0.1f };    ///< In seconds
+        float m_TimeSinceRefresh{ 0.0f };
+        uint64_t m_DrawDataHash{ 0 };
+        bool m_NeedsRefresh{ true };
+
+        // Bit per frame of the window, set if the image was rendered
+        uint64_t m_RefreshHistory{ 0 };
+    };
+
+} // namespace gui
+
+#endif // WATER_SURFACE_RENDERING_GUI_OVERLAY_H_
@@ -10,6 +10,9 @@
 
 #include "Gui.h"
 #include "core/Profile.h"
+#include "core/Threads.h"
+#include "core/TaskGraph.h"
+#include "vulkan/GpuProfile.h"
 
 
 WaterSurface::WaterSurface(AppCmdLineArgs args)
@@ -20,7 +23,25 @@ WaterSurface::WaterSurface(AppCmdLineArgs args)
     m_Requirements.deviceType = VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
     m_Requirements.deviceFeatures.fillModeNonSolid = VK_TRUE;
     m_Requirements.deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // Tessellated water surface, if supported
+    m_Requirements.optionalDeviceFeatures.tessellationShader = VK_TRUE;
+    // Counters of the passes' draws, if supported
+    m_Requirements.optionalDeviceFeatures.pipelineStatisticsQuery = VK_TRUE;
     m_Requirements.queueFamilies = { VK_QUEUE_GRAPHICS_BIT };
+    // Per-frame descriptors of the sky are pushed, the queues' submissions
+    //  tracked by timeline semaphores, the display times of the presents
+    //  measured, the heaps' budgets reported, and the water shaded at reduced
+    //  rates, of its dependency, if supported
+    m_Requirements.optionalDeviceExtensions = {
+        VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME,
+        VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME,
+        VK_KHR_PRESENT_ID_EXTENSION_NAME,
+        VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
+        VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME,
+        VK_EXT_MEMORY_BUDGET_EXTENSION_NAME,
+        VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+        VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME
+    };
     m_Requirements.presentationSupport = true;
 
     m_DepthTestingEnabled = true;
@@ -31,64 +52,231 @@ WaterSurface::~WaterSurface()
     VKP_REGISTER_FUNCTION();
 
     gui::DestroyImGui();
+    vkp::GpuProfile::Destroy();
 }
 
 void WaterSurface::Start()
 {
     VKP_REGISTER_FUNCTION();
 
+    SetupThreadPlacement();
+    SetupViews();
+
     CreateRenderPass();
     m_SwapChain->CreateFramebuffers(*m_RenderPass);
 
-    const uint32_t kImageCount = m_SwapChain->GetImageCount();
+    const uint32_t kFrameCount = m_SwapChain->GetFramesInFlight();
 
-    CreateDrawCommandPools(kImageCount);
+    CreateDrawCommandPools(kFrameCount);
     CreateDrawCommandBuffers();
+    // Scopes of the multiview pass write a query per view
+    vkp::GpuProfile::Init(*m_Device, kFrameCount, GetViewCount());
 
     CreateDescriptorPool();
 
     SetupAssets();
+
+    // Only the metrics are shown, nothing is controlled, nor captured
+    if (GetBenchmark() != nullptr || GetFrameCapture() != nullptr)
+        m_State = States::CameraControls;
+}
+
+void WaterSurface::SetupThreadPlacement()
+{
+    vkp::ThreadPlacement::Settings settings;
+
+    // e.g. "--sim-threads=6", 0 of each CPU not reserved
+    const std::string_view kSimThreads = m_Args.GetOption("sim-threads");
+    if (!kSimThreads.empty())
+    {
+        settings.threadCount =
+            static_cast<uint32_t>(std::atoi(std::string(kSimThreads).c_str()));
+    }
+    // e.g. "--reserved-cpus=2", first CPUs, of the main loop thread
+    const std::string_view kReservedCpus = m_Args.GetOption("reserved-cpus");
+    if (!kReservedCpus.empty())
+    {
+        settings.reservedCpus = static_cast<uint32_t>(
+            std::atoi(std::string(kReservedCpus).c_str()));
+    }
+    settings.pin = m_Args.HasFlag("pin-threads");
+    settings.firstTouch = m_Args.HasFlag("numa-first-touch");
+
+    // Before any model is prepared, the worker is placed on its first waves
+    vkp::ThreadPlacement::SetSettings(settings);
+    vkp::ThreadPlacement::PlaceMainThread();
+}
+
+void WaterSurface::SetupViews()
+{
+    // e.g. "--views=2", of a stereo pair, or of the projectors of a wall
+    const std::string_view kViews = m_Args.GetOption("views");
+    if (kViews.empty())
+        return;
+
+    uint32_t count = static_cast<uint32_t>(
+        std::max(std::atoi(std::string(kViews).c_str()), 1));
+
+    const uint32_t kMaxCount = m_Device->SupportsMultiview()
+        ? std::min(m_Device->GetMaxMultiviewViewCount(),
+                   vkp::Camera::s_kMaxViewCount)
+        : 1;
+    if (count > kMaxCount)
+    {
+        VKP_LOG_WARN("Multiview: {} views requested, {} supported",
+                     count, kMaxCount);
+        count = kMaxCount;
+    }
+    m_Views.count = count;
+
+    // e.g. "--view-separation=0.065", in meters, e.g., of the eyes
+    const std::string_view kSeparation = m_Args.GetOption("view-separation");
+    m_Views.separation = kSeparation.empty()
+        ? 0.065f
+        : static_cast<float>(std::atof(std::string(kSeparation).c_str()));
+
+    // e.g. "--view-yaw=40", in degrees, e.g., of the projectors of a wall
+    const std::string_view kYaw = m_Args.GetOption("view-yaw");
+    if (!kYaw.empty())
+    {
+        m_Views.yawStep = glm::radians(
+            static_cast<float>(std::atof(std::string(kYaw).c_str())));
+    }
 }
 
 void WaterSurface::SetupAssets()
 {
-    SetupGUI();
+    VKP_REGISTER_FUNCTION();
+    VKP_PROFILE_SCOPE();
+
+    using Thread = vkp::TaskGraph::Thread;
+    vkp::TaskGraph graph;
+
+    // Recorded into the one-time command buffers, and ImGui, on the main
+    //  thread, while the shaders of the water and the sky are compiled, and
+    //  the water's spectrum and FFT planned, on the workers
+    // Of the render pass of the water's and the sky's pipelines, first of the
+    //  main thread's tasks
+    const auto kMultiview = graph.Add("Multiview target", [this]() {
+        CreateMultiviewTarget();
+    }, {}, Thread::Main);
+    const auto kGui = graph.Add("GUI", [this]() {
+        SetupGUI();
+    }, {}, Thread::Main);
+    const auto kCamera = graph.Add("Camera", [this]() {
+        CreateCamera();
+    }, {}, Thread::Main);
+
+    const auto kWater = graph.Add("Water surface", [this]() {
+        CreateWaterSurfaceMesh();
+    }, { kMultiview });
+    const auto kWaterModel = graph.Add("Water surface model", [this]() {
+        // Of the threads of its plans, as of the simulation's
+        vkp::ThreadPlacement::PlaceSimulationThread();
+        m_WaterSurfaceMesh->PrepareModel();
+    }, { kWater });
+    const auto kWaterMaps = graph.Add("Water surface maps", [this]() {
+        PrepareWaterSurfaceMesh();
+    }, { kWaterModel }, Thread::Main);
+
+    const auto kSky = graph.Add("Sky", [this]() {
+        CreateSkyModel();
+    }, { kMultiview });
+
+    // Uploads of the fonts and the mesh, in one submission
+    graph.Add("Uploads", [this]() {
+        WaitTransferComplete( FlushTransfers() );
+        gui::DestroyFontUploadObjects();
+    }, { kGui, kCamera, kWaterMaps, kSky }, Thread::Main);
+
+    graph.Run();
+}
 
-    CreateCamera();
-    CreateWaterSurfaceMesh();
-    CreateSkyModel();
+void WaterSurface::CreateMultiviewTarget()
+{
+    if (GetViewCount() == 1)
+        return;
+
+    m_MultiviewTarget.reset(
+        new vkp::MultiviewTarget(*m_Device, *m_DescriptorPool)
+    );
+    CreateMultiviewRenderData();
 }
 
 void WaterSurface::CreateWaterSurfaceMesh()
 {
     m_WaterSurfaceMesh.reset(
-        new WaterSurfaceMesh(*m_Device, *m_DescriptorPool)
+        new WaterSurfaceMesh(*m_Device, *m_DescriptorPool, GetViewCount())
     );
 
     m_WaterSurfaceMesh->CreateRenderData(
-        *m_RenderPass,
-        m_SwapChain->GetImageCount(),
-        m_SwapChain->GetExtent(),
+        GetSceneRenderPass(),
+        m_SwapChain->GetFramesInFlight(),
+        GetSceneExtent(),
         m_SwapChain->HasDepthAttachment()
     );
 
+    // e.g. "--tile-size=512"
+    const std::string_view kTileSize = m_Args.GetOption("tile-size");
+    if (!kTileSize.empty())
+    {
+        m_WaterSurfaceMesh->SetTileSize(
+            static_cast<uint32_t>(std::atoi(std::string(kTileSize).c_str()))
+        );
+    }
+
+    // e.g. "--baked-loop=64", layers of the period, baked by the first frame
+    const std::string_view kBakedLoop = m_Args.GetOption("baked-loop");
+    if (!kBakedLoop.empty())
+    {
+        m_WaterSurfaceMesh->SetLoopFrameCount(
+            static_cast<uint32_t>(std::atoi(std::string(kBakedLoop).c_str()))
+        );
+    }
+    // e.g. "--loop-cache=waves.wslc", of the baked loop, mapped if of the
+    //  same model, else written once baked
+    const std::string_view kLoopCache = m_Args.GetOption("loop-cache");
+    if (!kLoopCache.empty())
+        m_WaterSurfaceMesh->SetLoopCachePath(std::string(kLoopCache));
+
+    // e.g. "--frame-budget=16.6", in ms, the resolutions set above are the
+    //  highest ones
+    const std::string_view kFrameBudget = m_Args.GetOption("frame-budget");
+    if (!kFrameBudget.empty())
+    {
+        m_WaterSurfaceMesh->SetFrameBudget(
+            static_cast<float>(std::atof(std::string(kFrameBudget).c_str()))
+        );
+    }
+
+    // First frames at a low resolution, unless measured, captured, or
+    //  "--full-resolution-start"
+    m_WaterSurfaceMesh->SetProgressiveStart(
+        GetBenchmark() == nullptr && GetFrameCapture() == nullptr &&
+        !m_Args.HasFlag("full-resolution-start")
+    );
+}
+
+void WaterSurface::PrepareWaterSurfaceMesh()
+{
     auto& cmdBuffer = BeginOneTimeCommands();
 
         m_WaterSurfaceMesh->Prepare(cmdBuffer);
 
-    EndOneTimeCommands(cmdBuffer);
+    BatchTransferCmdBuffer(cmdBuffer);
 }
 
 void WaterSurface::CreateSkyModel()
 {
     m_Sky.reset(
-        new SkyModel(*m_Device, *m_DescriptorPool, s_kStartSunDir)
+        new SkyModel(*m_Device, *m_DescriptorPool, s_kStartSunDir,
+                     GetViewCount())
     );
 
     m_Sky->CreateRenderData(
-        *m_RenderPass,
-        m_SwapChain->GetImageCount(),
-        m_SwapChain->GetExtent(),
+        GetSceneRenderPass(),
+        m_SwapChain->GetFramesInFlight(),
+        GetSceneExtent(),
         m_SwapChain->HasDepthAttachment()
     );
 }
@@ -97,38 +285,87 @@ void WaterSurface::OnFrameBufferResize(int width, int height)
 {
     // Application
 
-    m_RenderPass->Destroy();
-    CreateRenderPass();
+    // Pipelines of the render pass survive the resize, of dynamic viewport
+    //  and scissor, unless its formats have changed
+    const bool kRenderPassChanged =
+        m_RenderPass->GetAttachmentFormat() != m_SwapChain->GetImageFormat() ||
+        m_RenderPass->GetDepthAttachmentFormat() !=
+            m_SwapChain->GetDepthAttachmentFormat();
+
+    const uint32_t kFrameCount = m_SwapChain->GetFramesInFlight();
+    const bool kFrameCountChanged = m_DrawCmdPools.size() != kFrameCount;
+
+    if (kRenderPassChanged)
+    {
+        m_Device->QueueWaitIdle(vkp::QFamily::Graphics);
+        m_RenderPass->Destroy();
+        CreateRenderPass();
+    }
     m_SwapChain->CreateFramebuffers(*m_RenderPass);
 
-    // Also destroyes all the draw command buffers
-    DestroyDrawCommandPools();
+    // Recorded of the previous framebuffers, pending ones are waited for
+    InvalidateStaticFrames();
 
-    const uint32_t kImageCount = m_SwapChain->GetImageCount();
+    if (kFrameCountChanged)
+    {
+        m_Device->GetTimeline(vkp::QFamily::Graphics).Wait(
+            m_SwapChain->GetLastSubmitValue()
+        );
+        // Also destroyes all the draw command buffers
+        DestroyDrawCommandPools();
 
-    CreateDrawCommandPools(kImageCount);
-    CreateDrawCommandBuffers();
+        CreateDrawCommandPools(kFrameCount);
+        CreateDrawCommandBuffers();
+        vkp::GpuProfile::Init(*m_Device, kFrameCount, GetViewCount());
+    }
+    else
+    {
+        // Of the new image count, none is pending
+        m_StaticCmdPool = std::make_unique<vkp::CommandPool>(
+            *m_Device,
+            vkp::QFamily::Graphics,
+            VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+        );
+        const uint32_t kImageCount = m_SwapChain->GetImageCount();
+        m_StaticCmdPool->AllocateCommandBuffers(kImageCount);
+        m_StaticFramesRecorded.assign(kImageCount, false);
+        m_StaticFrameCount = 0;
+    }
 
     // -----------------------------------------------------
     // Assets
 
-    m_WaterSurfaceMesh->CreateRenderData(
-        *m_RenderPass,
-        m_SwapChain->GetImageCount(),
-        m_SwapChain->GetExtent(),
-        m_SwapChain->HasDepthAttachment()
-    );
+    // Layers of the new tiles, their pass of the same formats as before
+    if (m_MultiviewTarget != nullptr)
+        CreateMultiviewRenderData();
 
-    m_Sky->CreateRenderData(
-        *m_RenderPass,
-        m_SwapChain->GetImageCount(),
-        m_SwapChain->GetExtent(),
-        m_SwapChain->HasDepthAttachment()
-    );
+    if (kRenderPassChanged || kFrameCountChanged)
+    {
+        m_WaterSurfaceMesh->CreateRenderData(
+            GetSceneRenderPass(),
+            kFrameCount,
+            GetSceneExtent(),
+            m_SwapChain->HasDepthAttachment()
+        );
+
+        m_Sky->CreateRenderData(
+            GetSceneRenderPass(),
+            kFrameCount,
+            GetSceneExtent(),
+            m_SwapChain->HasDepthAttachment()
+        );
+    }
+    else
+    {
+        m_WaterSurfaceMesh->SetFramebufferExtent(GetSceneExtent());
+    }
 
     gui::OnFramebufferResized(m_SwapChain->GetMinImageCount());
+    CreateGuiOverlayRenderData();
 
-    m_Camera->SetAspectRatio(width / static_cast<float>(height));
+    // Of a tile each, if several views
+    m_Camera->SetAspectRatio(
+        width / static_cast<float>(GetViewCount() * height));
 }
 
 void WaterSurface::Update(vkp::Timestep dt)
@@ -136,28 +373,65 @@ void WaterSurface::Update(vkp::Timestep dt)
     UpdateGui();    // TODO wrong priority??
 
     UpdateCamera(dt);
+    WatchShaders(dt);
 
     m_Sky->Update(dt);
     m_WaterSurfaceMesh->Update(dt);
+
+    UpdateStaticFrames();
+
+    m_IsIdle = m_IdleWhenStatic && IsSettled();
+    if (m_IsIdle)
+        gui::EndFrame();
 }
 
 void WaterSurface::Render(
     uint32_t frameIndex,
+    uint32_t imageIndex,
     vkp::Timestep dt,
+    std::vector<VkSemaphore>& semaphoresToWait,
     std::vector<VkPipelineStageFlags>& stagesToWait,
     std::vector<VkCommandBuffer>& buffersToSubmit)
 {
+    // Same as the previous frames of the image, nothing to prepare
+    if (m_ReuseStaticFrames && IsSettled())
+    {
+        if (m_StaticFramesRecorded[imageIndex])
+            gui::EndFrame();
+        else
+            RecordStaticFrame(frameIndex, imageIndex);
+
+        stagesToWait.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        buffersToSubmit.push_back((*m_StaticCmdPool)[imageIndex]);
+        return;
+    }
+
     auto& drawCmdPool = m_DrawCmdPools[frameIndex];
     drawCmdPool.Reset();
     
     vkp::CommandBuffer& commandBuffer = drawCmdPool.Front();
     commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    // Its previous submission is done, of the acquired frame
+    vkp::GpuProfile::BeginFrame(commandBuffer, frameIndex);
+    const float kGpuFrameTime = vkp::GpuProfile::GetFrameDuration();
+    if (kGpuFrameTime >= 0.0f)
     {
-        const VkExtent2D kSwapChainExtent = m_SwapChain->GetExtent();
+        m_FramePacing.AddGpuFrameTime(kGpuFrameTime);
+        m_WaterSurfaceMesh->AddGpuFrameTime(kGpuFrameTime);
+    }
+
+    const VkFramebuffer kFramebuffer = m_SwapChain->GetFramebuffer(imageIndex);
+    {
+        const VkExtent2D kSceneExtent = GetSceneExtent();
 
+        for (uint32_t i = 0; i < m_Camera->GetViewCount(); ++i)
+            m_Sky->SetView(i, m_Camera->GetView(i));
+
+        // Bakes the sky's LUT if it has changed, read by both passes
         m_Sky->PrepareRender(
-            frameIndex,
-            glm::vec2(kSwapChainExtent.width, kSwapChainExtent.height),
+            frameIndex, commandBuffer,
+            glm::vec2(kSceneExtent.width, kSceneExtent.height),
             m_Camera->GetPosition(),
             m_Camera->GetView(),
             m_Camera->GetFov()
@@ -166,30 +440,55 @@ void WaterSurface::Render(
         // Copy to water surface maps, update uniform buffers
         m_WaterSurfaceMesh->PrepareRender(
             frameIndex, commandBuffer,
-            m_Camera->GetViewMat(),
-            m_Camera->GetProjMat(),
-            m_Camera->GetPosition(),
-            m_Sky->GetParams()
+            *m_Camera,
+            *m_Sky
         );
 
-        BeginRenderPass(
-            commandBuffer,
-            m_SwapChain->GetFramebuffer(frameIndex)
-        );
+        // Ends the GUI's frame, rendered into the overlay only if changed
+        if (m_CacheGui)
+            m_GuiOverlay->PrepareRender(commandBuffer, dt);
 
-        // TODO optimize - render last
-        // Render sky first - rendered in the background,
-        //  does not write into depth attachment
-        m_Sky->Render(frameIndex, commandBuffer);
+        if (m_MultiviewTarget != nullptr)
+            RecordMultiviewPass(frameIndex, commandBuffer);
 
-        m_WaterSurfaceMesh->Render(frameIndex, commandBuffer);
+        // The multiview pass is recorded inline, only composited in the main
+        //  one, the GUI with it
+        if (m_RecordInParallel && m_MultiviewTarget == nullptr)
+        {
+            const auto kSecondaryBuffers =
+                RecordSecondaryPasses(frameIndex, kFramebuffer);
 
-        gui::Render(commandBuffer);
+            BeginRenderPass(commandBuffer, kFramebuffer,
+                            VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+            vkCmdExecuteCommands(
+                commandBuffer,
+                static_cast<uint32_t>(kSecondaryBuffers.size()),
+                kSecondaryBuffers.data()
+            );
 
-        vkCmdEndRenderPass(commandBuffer);
+            vkCmdEndRenderPass(commandBuffer);
+        }
+        else
+        {
+            BeginRenderPass(commandBuffer, kFramebuffer);
+            RecordPasses(frameIndex, commandBuffer);
+            vkCmdEndRenderPass(commandBuffer);
+        }
     }
     commandBuffer.End();
 
+    vkp::GpuProfile::EndFrame();
+
+    // Maps uploaded on the transfer queue are first read by the vertex shader
+    const VkSemaphore kMapUploadSemaphore =
+        m_WaterSurfaceMesh->GetMapUploadSemaphore();
+    if (kMapUploadSemaphore != VK_NULL_HANDLE)
+    {
+        semaphoresToWait.push_back(kMapUploadSemaphore);
+        stagesToWait.push_back(VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+    }
+
     stagesToWait.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
     buffersToSubmit.push_back(commandBuffer);
 }
@@ -208,6 +507,13 @@ void WaterSurface::CreateRenderPass()
             m_SwapChain->GetDepthAttachmentFormat())
     );
 
+    // Compatible with the pipelines regardless of the final layout
+    if (m_SwapChain->IsOffscreen())
+    {
+        m_RenderPass->GetAttachmentDescriptions()[0].finalLayout =
+            vkp::SwapChain::s_kOffscreenImageLayout;
+    }
+
     m_RenderPass->Create(m_SwapChain->HasDepthAttachment());
 }
 
@@ -225,6 +531,24 @@ void WaterSurface::CreateDrawCommandPools(const uint32_t kCount)
             VK_COMMAND_POOL_CREATE_TRANSIENT_BIT    // short-lived
         );
     }
+
+    // Buffers are recorded again individually
+    m_StaticCmdPool = std::make_unique<vkp::CommandPool>(
+        *m_Device,
+        vkp::QFamily::Graphics,
+        VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+    );
+
+    m_SecondaryCmdPools.reserve(kCount * PassCount);
+
+    for (uint32_t i = 0; i < kCount * PassCount; ++i)
+    {
+        m_SecondaryCmdPools.emplace_back(
+            *m_Device,
+            vkp::QFamily::Graphics,
+            VK_COMMAND_POOL_CREATE_TRANSIENT_BIT
+        );
+    }
 }
 
 void WaterSurface::CreateDrawCommandBuffers()
@@ -236,6 +560,17 @@ void WaterSurface::CreateDrawCommandBuffers()
     {
         pool.AllocateCommandBuffers(kBuffersPerFrame);
     }
+
+    for (auto& pool : m_SecondaryCmdPools)
+    {
+        pool.AllocateCommandBuffers(kBuffersPerFrame,
+                                    VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+    }
+
+    const uint32_t kImageCount = m_SwapChain->GetImageCount();
+    m_StaticCmdPool->AllocateCommandBuffers(kImageCount);
+    m_StaticFramesRecorded.assign(kImageCount, false);
+    m_StaticFrameCount = 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -248,13 +583,25 @@ void WaterSurface::CreateDescriptorPool()
     m_DescriptorPool = vkp::DescriptorPool::Builder(*m_Device)
         .AddPoolSize(
             VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            m_SwapChain->GetImageCount() * 10
+            m_SwapChain->GetFramesInFlight() * 10
         )
+        // Also the maps of the water surface's detail cascades, and its
+        //  second maps blended at a fixed simulation rate, and the GUI's
+        //  overlay, and the views' layers
         .AddPoolSize(
             VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            m_SwapChain->GetImageCount() * 10
+            m_SwapChain->GetFramesInFlight() * 18 + 2
         )
-        .Build(m_SwapChain->GetImageCount() * 2);
+        // Map buffers of the water surface, if the device supports it
+        .AddPoolSize(
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            m_SwapChain->GetFramesInFlight() * 4
+        )
+        // Compute backend of the water surface, and the bakes of the sky's LUT
+        //  and of the terrain map
+        .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4)
+        .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 4)
+        .Build(m_SwapChain->GetFramesInFlight() * 2 + 5);
 }
 
 // -----------------------------------------------------------------------------
@@ -264,13 +611,20 @@ void WaterSurface::CreateCamera()
 {
     const VkExtent2D kSwapChainExtent = m_SwapChain->GetExtent();
 
+    // Of a tile each, if several views
     m_Camera = std::make_unique<vkp::Camera>(
-        kSwapChainExtent.width / static_cast<float>(kSwapChainExtent.height),
+        kSwapChainExtent.width /
+            static_cast<float>(GetViewCount() * kSwapChainExtent.height),
         s_kCamStartPos,
         s_kCamStartPitch,
         s_kCamStartYaw
     );
     m_Camera->SetFov(s_kCamStartFov);
+    m_Camera->SetViews(m_Views);
+
+    const std::string_view kCameraPath = m_Args.GetOption("camera-path");
+    if (!kCameraPath.empty())
+        m_CameraPath.Load(std::filesystem::path(kCameraPath));
 }
 
 void WaterSurface::SetupGUI()
@@ -297,21 +651,57 @@ void WaterSurface::SetupGUI()
         m_Device->GetQueue(vkp::QFamily::Graphics),
         descriptorPool,
         m_SwapChain->GetMinImageCount(),
-        m_SwapChain->GetImageCount(),
+        // Its buffers rotate per frame, reused once all frames in flight have
+        //  finished
+        std::max(m_SwapChain->GetImageCount(),
+                 m_SwapChain->GetFramesInFlight()),
         [](VkResult err){ 
             VKP_ASSERT_RESULT(err);
         },
         *m_Window,
-        *m_RenderPass
+        *m_RenderPass,
+        m_Device->GetPipelineCache()
     );
 
     vkp::CommandBuffer& cmdBuffer = BeginOneTimeCommands();
 
         gui::UploadFonts(cmdBuffer);
 
-    EndOneTimeCommands(cmdBuffer);
+    // Upload objects are destroyed once flushed by "SetupAssets()"
+    BatchTransferCmdBuffer(cmdBuffer);
+
+    m_GuiOverlay.reset(new gui::Overlay(*m_Device, *m_DescriptorPool));
+    CreateGuiOverlayRenderData();
+    m_CacheGui = m_Args.HasFlag("cached-gui");
+}
 
-    gui::DestroyFontUploadObjects();
+void WaterSurface::CreateMultiviewRenderData()
+{
+    const bool kHasDepthAttachment = m_SwapChain->HasDepthAttachment();
+
+    m_MultiviewTarget->CreateRenderData(
+        *m_RenderPass,
+        m_SwapChain->GetExtent(),
+        kHasDepthAttachment,
+        GetViewCount(),
+        m_SwapChain->GetImageFormat(),
+        kHasDepthAttachment ? m_SwapChain->GetDepthAttachmentFormat()
+                            : VK_FORMAT_UNDEFINED
+    );
+}
+
+void WaterSurface::CreateGuiOverlayRenderData()
+{
+    const bool kHasDepthAttachment = m_SwapChain->HasDepthAttachment();
+
+    m_GuiOverlay->CreateRenderData(
+        *m_RenderPass,
+        m_SwapChain->GetExtent(),
+        m_SwapChain->GetImageFormat(),
+        m_SwapChain->GetDepthAttachmentFormat(),
+        kHasDepthAttachment ? m_SwapChain->GetDepthImageView()
+                            : VK_NULL_HANDLE
+    );
 }
 
 // =============================================================================
@@ -319,7 +709,8 @@ void WaterSurface::SetupGUI()
 
 void WaterSurface::BeginRenderPass(
     VkCommandBuffer commandBuffer,
-    VkFramebuffer framebuffer)
+    VkFramebuffer framebuffer,
+    VkSubpassContents contents)
 {
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -329,25 +720,280 @@ void WaterSurface::BeginRenderPass(
     renderPassInfo.renderArea.offset = {0, 0};
     renderPassInfo.renderArea.extent = m_SwapChain->GetExtent();
 
+    const std::array<VkClearValue, 2> clearValues = GetClearValues();
     renderPassInfo.clearValueCount = 
-        static_cast<uint32_t>(m_ClearValues.size());
-    renderPassInfo.pClearValues = m_ClearValues.data();
+        static_cast<uint32_t>(clearValues.size());
+    renderPassInfo.pClearValues = clearValues.data();
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, 
-                         VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+}
+
+std::array<VkClearValue, 2> WaterSurface::GetClearValues() const
+{
+    // The overdraw heatmap adds up from zero
+    std::array<VkClearValue, 2> clearValues = m_ClearValues;
+    if (m_ShowOverdraw)
+        clearValues[0] = VkClearValue{ 0.0f, 0.0f, 0.0f, 1.0f };
+
+    return clearValues;
+}
+
+std::array<VkCommandBuffer, WaterSurface::PassCount>
+WaterSurface::RecordSecondaryPasses(
+    uint32_t frameIndex,
+    VkFramebuffer framebuffer)
+{
+    VKP_ASSERT(m_SecondaryCmdPools.size() >= (frameIndex + 1) * PassCount);
+
+    VkCommandBufferInheritanceInfo inheritInfo{};
+    inheritInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritInfo.renderPass = *m_RenderPass;
+    inheritInfo.subpass = 0;
+    inheritInfo.framebuffer = framebuffer;
+
+    std::array<VkCommandBuffer, PassCount> cmdBuffers{};
+
+    // Each pass only records its own buffer, from its own pool
+    #pragma omp parallel for schedule(dynamic)
+    for (int pass = 0; pass < PassCount; ++pass)
+    {
+        auto& pool = m_SecondaryCmdPools[frameIndex * PassCount + pass];
+        pool.Reset();
+
+        vkp::CommandBuffer& cmdBuffer = pool.Front();
+        cmdBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                        VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                        &inheritInfo);
+
+        // Dynamic states are not inherited, GUI sets its own
+        if (pass != PassGui)
+            vkp::Pipeline::CmdSetViewportScissor(cmdBuffer,
+                                                 m_SwapChain->GetExtent());
+
+        if (pass == PassSky)
+            m_Sky->Render(frameIndex, cmdBuffer);
+        else if (pass == PassWaterSurface)
+            m_WaterSurfaceMesh->Render(frameIndex, cmdBuffer);
+        else
+            RecordGuiPass(cmdBuffer);
+
+        cmdBuffer.End();
+        cmdBuffers[pass] = cmdBuffer;
+    }
+
+    // Sky is tested at the far plane, shaded only where the water is not,
+    //  otherwise it is in the background
+    if (m_SwapChain->HasDepthAttachment())
+        std::swap(cmdBuffers[PassSky], cmdBuffers[PassWaterSurface]);
+
+    return cmdBuffers;
+}
+
+void WaterSurface::RecordPasses(uint32_t frameIndex, VkCommandBuffer cmdBuffer)
+{
+    vkp::Pipeline::CmdSetViewportScissor(cmdBuffer, m_SwapChain->GetExtent());
+
+    // Views were rendered by "RecordMultiviewPass()"
+    if (m_MultiviewTarget != nullptr)
+        m_MultiviewTarget->Render(cmdBuffer);
+    else
+        RecordScenePasses(frameIndex, cmdBuffer,
+                          m_SwapChain->HasDepthAttachment());
+
+    RecordGuiPass(cmdBuffer);
+}
+
+void WaterSurface::RecordScenePasses(uint32_t frameIndex,
+                                     VkCommandBuffer cmdBuffer,
+                                     bool hasDepthAttachment)
+{
+    // Sky is tested at the far plane, shaded only where the water is not,
+    //  otherwise it is in the background
+    const bool kSkyIsLast = hasDepthAttachment;
+    if (!kSkyIsLast)
+        m_Sky->Render(frameIndex, cmdBuffer);
+
+    m_WaterSurfaceMesh->Render(frameIndex, cmdBuffer);
+
+    if (kSkyIsLast)
+        m_Sky->Render(frameIndex, cmdBuffer);
+}
+
+void WaterSurface::RecordMultiviewPass(uint32_t frameIndex,
+                                       VkCommandBuffer cmdBuffer)
+{
+    m_MultiviewTarget->Begin(cmdBuffer, GetClearValues());
+    RecordScenePasses(frameIndex, cmdBuffer,
+                      m_MultiviewTarget->HasDepthAttachment());
+    m_MultiviewTarget->End(cmdBuffer);
+}
+
+void WaterSurface::RecordGuiPass(VkCommandBuffer cmdBuffer)
+{
+    VKP_PROFILE_GPU_SCOPE(cmdBuffer, "GUI pass");
+
+    // Its frame is ended by the overlay's "PrepareRender()"
+    if (m_CacheGui)
+        m_GuiOverlay->Render(cmdBuffer);
+    else
+        gui::Render(cmdBuffer);
+}
+
+void WaterSurface::UpdateStaticFrames()
+{
+    const glm::mat4 kViewProj = m_Camera->GetProjMat() * m_Camera->GetViewMat();
+
+    // Any of the widgets may change the scene while the GUI is shown
+    const bool kIsStatic = m_State != States::GuiControls &&
+                           kViewProj == m_LastViewProj &&
+                           m_WaterSurfaceMesh->IsStatic();
+    m_LastViewProj = kViewProj;
+
+    if (kIsStatic)
+    {
+        m_StaticFrameCount = std::min(m_StaticFrameCount + 1,
+                                      GetSettleFrameCount());
+        return;
+    }
+
+    InvalidateStaticFrames();
+    m_StaticFrameCount = 0;
+}
+
+void WaterSurface::RecordStaticFrame(uint32_t frameIndex, uint32_t imageIndex)
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Not pending, its image's previous frame is done
+    vkp::CommandBuffer& cmdBuffer = (*m_StaticCmdPool)[imageIndex];
+    cmdBuffer.Begin();
+
+    // The overlay is kept as last rendered, the same for all the images
+    if (m_CacheGui)
+        gui::EndFrame();
+
+    if (m_MultiviewTarget != nullptr)
+        RecordMultiviewPass(frameIndex, cmdBuffer);
+
+    BeginRenderPass(cmdBuffer, m_SwapChain->GetFramebuffer(imageIndex));
+    RecordPasses(frameIndex, cmdBuffer);
+    vkCmdEndRenderPass(cmdBuffer);
+
+    cmdBuffer.End();
+    m_StaticFramesRecorded[imageIndex] = true;
+}
+
+void WaterSurface::InvalidateStaticFrames()
+{
+    const bool kHasRecorded = std::find(m_StaticFramesRecorded.begin(),
+                                        m_StaticFramesRecorded.end(),
+                                        true) != m_StaticFramesRecorded.end();
+    if (!kHasRecorded)
+        return;
+
+    m_Device->QueueWaitIdle(vkp::QFamily::Graphics);
+    m_StaticFramesRecorded.assign(m_StaticFramesRecorded.size(), false);
 }
 
 void WaterSurface::UpdateCamera(vkp::Timestep dt)
 {
+    if (!m_CameraPath.IsEmpty())
+    {
+        m_CameraPathTime += dt;
+        m_CameraPath.Apply(*m_Camera, m_CameraPathTime);
+    }
+
     m_Camera->Update(dt);
 }
 
+VkRenderPass WaterSurface::GetSceneRenderPass() const
+{
+    if (m_MultiviewTarget != nullptr)
+        return m_MultiviewTarget->GetRenderPass();
+
+    return *m_RenderPass;
+}
+
+VkExtent2D WaterSurface::GetSceneExtent() const
+{
+    if (m_MultiviewTarget != nullptr)
+        return m_MultiviewTarget->GetViewExtent();
+
+    return m_SwapChain->GetExtent();
+}
+
+void WaterSurface::RecompileShaders()
+{
+    // Recorded ones may use the replaced pipelines
+    InvalidateStaticFrames();
+
+    m_WaterSurfaceMesh->RecompileShaders(
+        GetSceneRenderPass(),
+        GetSceneExtent(),
+        m_SwapChain->HasDepthAttachment()
+    );
+    m_Sky->RecompileShaders(
+        GetSceneRenderPass(),
+        GetSceneExtent(),
+        m_SwapChain->HasDepthAttachment()
+    );
+    if (m_MultiviewTarget != nullptr)
+    {
+        m_MultiviewTarget->RecompileShaders(
+            *m_RenderPass,
+            m_SwapChain->GetExtent(),
+            m_SwapChain->HasDepthAttachment()
+        );
+    }
+    m_GuiOverlay->RecompileShaders(
+        *m_RenderPass,
+        m_SwapChain->GetExtent(),
+        m_SwapChain->HasDepthAttachment()
+    );
+}
+
+void WaterSurface::WatchShaders(vkp::Timestep dt)
+{
+    if (!m_WatchShaders)
+        return;
+
+    m_ShaderWatchTime += dt;
+    if (m_ShaderWatchTime < s_kShaderWatchInterval)
+        return;
+    m_ShaderWatchTime = 0.0f;
+
+    const auto kWriteTime = GetShadersWriteTime();
+    if (kWriteTime <= m_ShadersWriteTime)
+        return;
+
+    m_ShadersWriteTime = kWriteTime;
+    RecompileShaders();
+}
+
+std::filesystem::file_time_type WaterSurface::GetShadersWriteTime()
+{
+    std::filesystem::file_time_type latest{};
+
+    std::error_code err;
+    for (const auto& kEntry :
+         std::filesystem::directory_iterator(s_kShadersDir, err))
+    {
+        const auto kWriteTime = kEntry.last_write_time(err);
+        if (!err)
+            latest = std::max(latest, kWriteTime);
+    }
+    return latest;
+}
+
 // =============================================================================
 // Destroy functions
 
 void WaterSurface::DestroyDrawCommandPools()
 {
     VKP_REGISTER_FUNCTION();
+    m_StaticFramesRecorded.clear();
+    m_StaticCmdPool.reset();
+    m_SecondaryCmdPools.clear();
     m_DrawCmdPools.clear();
 }
 
@@ -384,16 +1030,11 @@ void WaterSurface::OnKeyPressed(int key, int action, int mods)
         }
         else if (key == KeyRecompileShaders)
         {
-            m_WaterSurfaceMesh->RecompileShaders(
-                *m_RenderPass,
-                m_SwapChain->GetExtent(),
-                m_SwapChain->HasDepthAttachment()
-            );
-            m_Sky->RecompileShaders(
-                *m_RenderPass,
-                m_SwapChain->GetExtent(),
-                m_SwapChain->HasDepthAttachment()
-            );
+            RecompileShaders();
+        }
+        else if (key == KeyCaptureTrace && !vkp::Profile::IsCapturing())
+        {
+            StartTraceCapture();
         }
     }
 }
@@ -429,6 +1070,43 @@ void WaterSurface::UpdateGui()
     if ( ImGui::Button("Open Controls window") )
         controlsOpened = true;
 
+    // From the current sources, only later writes recompile them
+    if ( ImGui::Checkbox("Watch Shaders", &m_WatchShaders) && m_WatchShaders )
+        m_ShadersWriteTime = GetShadersWriteTime();
+
+    ImGui::Checkbox("Record Passes in Parallel", &m_RecordInParallel);
+    // Once the GUI is hidden, the camera still, and the animation paused
+    ImGui::Checkbox("Reuse Static Frames", &m_ReuseStaticFrames);
+    ImGui::Checkbox("Idle When Static", &m_IdleWhenStatic);
+
+    // Of the water and the sky, the GUI is drawn over as usual
+    if (ImGui::Checkbox("Overdraw Heatmap", &m_ShowOverdraw))
+    {
+        m_WaterSurfaceMesh->SetShowOverdraw(m_ShowOverdraw);
+        m_Sky->SetShowOverdraw(m_ShowOverdraw);
+    }
+    if (m_ShowOverdraw && ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Fragments per pixel: dark red 1, red 8, "
+                          "yellow 16, white 32");
+    }
+
+    // Rendered again once changed, at once on input, else at the interval
+    if (ImGui::Checkbox("Cache GUI", &m_CacheGui) && m_CacheGui)
+        m_GuiOverlay->Invalidate();
+    if (m_CacheGui)
+    {
+        float interval = m_GuiOverlay->GetRefreshInterval() * 1000.0f;
+        if (ImGui::SliderFloat("GUI Refresh Interval", &interval,
+                               0.0f, 1000.0f, "%.0f ms"))
+        {
+            m_GuiOverlay->SetRefreshInterval(interval / 1000.0f);
+        }
+        ImGui::Text("GUI rendered: %u of %u frames",
+                    m_GuiOverlay->GetRefreshCount(),
+                    gui::Overlay::s_kRefreshWindow);
+    }
+
     ShowCameraSettings();
     m_WaterSurfaceMesh->ShowGUISettings();
     m_Sky->ShowGUISettings();
@@ -446,6 +1124,8 @@ void WaterSurface::ShowControlsWindow(bool* p_open) const
 
     ImGui::Text("Global:");
     ImGui::BulletText("ESC to show / hide Configuration menu");
+    ImGui::BulletText("F1 to recompile the shaders");
+    ImGui::BulletText("F2 to capture a trace of the next frames");
     ImGui::Separator();
 
     ImGui::Text("Camera:");
@@ -456,7 +1136,7 @@ void WaterSurface::ShowControlsWindow(bool* p_open) const
     ImGui::Separator();
 }
 
-void WaterSurface::ShowStatusWindow() const
+void WaterSurface::ShowStatusWindow()
 {
     const float kIsControlsHidden =
         static_cast<float>(m_State != States::GuiControls);
@@ -476,31 +1156,130 @@ void WaterSurface::ShowStatusWindow() const
     ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 
                 kFrameTime, io.Framerate);
 
-    // Record frametimes
-    static const uint32_t kMaxFrameTimeCount = 256;
-    static std::vector<float> frameTimes(kMaxFrameTimeCount);
-    frameTimes.back() = kFrameTime;
-    std::copy(frameTimes.begin()+1, frameTimes.end(), frameTimes.begin());
-    
-    ImGui::PlotLines("Frame Times", frameTimes.data(), kMaxFrameTimeCount,
+    // Record frametimes, of each frame, not averaged
+    static vkp::RollingStats frameTimes;
+    frameTimes.Add(io.DeltaTime * 1000.0f);
+
+    // Of the frame times and the profiling records
+    static int statsWindowSize = vkp::RollingStats::s_kDefaultWindowSize;
+    if (ImGui::SliderInt("Statistics Window", &statsWindowSize, 16, 4096,
+                         "%d samples", ImGuiSliderFlags_Logarithmic))
+    {
+        frameTimes.SetWindowSize(static_cast<uint32_t>(statsWindowSize));
+        m_FramePacing.SetWindowSize(static_cast<uint32_t>(statsWindowSize));
+        vkp::Profile::SetStatsWindowSize(
+            static_cast<uint32_t>(statsWindowSize)
+        );
+    }
+
+    const std::vector<float> kFrameTimes = frameTimes.GetValues();
+    ImGui::PlotLines("Frame Times", kFrameTimes.data(),
+                     static_cast<int>(kFrameTimes.size()),
                      0, NULL, FLT_MAX, FLT_MAX, ImVec2(0,60));
 
+    const vkp::RollingStats::Summary kFrameStats = frameTimes.GetSummary();
+    ImGui::Text("min %.2f, mean %.2f, max %.2f ms",
+                kFrameStats.min, kFrameStats.mean, kFrameStats.max);
+    ImGui::Text("p50 %.2f, p95 %.2f, p99 %.2f ms",
+                kFrameStats.p50, kFrameStats.p95, kFrameStats.p99);
+
+    // Of the distribution of the frame times, hitches in the right tail
+    static constexpr uint32_t kHistogramBinCount = 32;
+    const float kHistogramMax = std::max(kFrameStats.max, 1.0f);
+    const std::vector<float> kHistogram =
+        frameTimes.GetHistogram(kHistogramBinCount, kHistogramMax);
+
+    char histogramOverlay[32];
+    std::snprintf(histogramOverlay, sizeof(histogramOverlay), "0 - %.1f ms",
+                  kHistogramMax);
+    ImGui::PlotHistogram("Frame Time Histogram", kHistogram.data(),
+                         static_cast<int>(kHistogram.size()), 0,
+                         histogramOverlay, 0.0f, FLT_MAX, ImVec2(0,60));
+
+    ShowFramePacing();
+    ShowPipelineStatistics();
+    ShowMemoryUsage();
+
     // Show profiling records
     #ifdef VKP_PROFILE
         ImGui::NewLine();
         ImGui::Text("Profiling data");
-        if ( ImGui::BeginTable("Profiling data", 2, ImGuiTableFlags_Resizable | 
-                                                    ImGuiTableFlags_BordersOuter |
-                                                    ImGuiTableFlags_BordersV) )
+        static bool showRecordStats = false;
+        ImGui::Checkbox("Rolling Statistics", &showRecordStats);
+
+        const int kColumnCount = showRecordStats ? 9 : 3;
+        if ( ImGui::BeginTable("Profiling data", kColumnCount,
+                               ImGuiTableFlags_Resizable | 
+                               ImGuiTableFlags_BordersOuter |
+                               ImGuiTableFlags_BordersV) )
         {
+            ImGui::TableSetupColumn("CPU");
+            ImGui::TableSetupColumn("GPU");
+            if (showRecordStats)
+            {
+                // Of the CPU durations, those of the GPU in the tooltip
+                ImGui::TableSetupColumn("min");
+                ImGui::TableSetupColumn("mean");
+                ImGui::TableSetupColumn("p50");
+                ImGui::TableSetupColumn("p95");
+                ImGui::TableSetupColumn("p99");
+                ImGui::TableSetupColumn("max");
+            }
+            ImGui::TableSetupColumn("Scope");
+            ImGui::TableHeadersRow();
+
+            // Negative durations are of no scope on the CPU, or the GPU
+            auto textDuration = [](float duration) {
+                if (duration < 0.0f)
+                    ImGui::TextDisabled("-");
+                else
+                    ImGui::Text("%.3f ms", duration);
+            };
+
             const auto& kRecords = vkp::Profile::GetRecordsFromLatest();
             for (const auto& record : kRecords)
             {
                 ImGui::TableNextRow();
                 ImGui::TableNextColumn();
-                ImGui::Text("%.3f ms", record.duration);
+                textDuration(record.duration);
+                ImGui::TableNextColumn();
+                textDuration(record.gpuDuration);
+                if (record.gpuStats.count > 0 && ImGui::IsItemHovered())
+                {
+                    const auto& kGpu = record.gpuStats;
+                    ImGui::SetTooltip(
+                        "min %.3f, mean %.3f, p50 %.3f, p95 %.3f, p99 %.3f, "
+                        "max %.3f ms", kGpu.min, kGpu.mean, kGpu.p50, kGpu.p95,
+                        kGpu.p99, kGpu.max);
+                }
+
+                if (showRecordStats)
+                {
+                    const auto& kCpu = record.stats;
+                    const bool kHasCpu = kCpu.count > 0;
+                    for (float value : { kCpu.min, kCpu.mean, kCpu.p50,
+                                         kCpu.p95, kCpu.p99, kCpu.max })
+                    {
+                        ImGui::TableNextColumn();
+                        textDuration(kHasCpu ? value : -1.0f);
+                    }
+                }
+
                 ImGui::TableNextColumn();
                 ImGui::Text("%s", record.name);
+
+                // Load balance of the scopes of parallel regions
+                if (record.threadDurations.size() > 1 &&
+                    ImGui::IsItemHovered())
+                {
+                    ImGui::BeginTooltip();
+                    for (size_t t = 0; t < record.threadDurations.size(); ++t)
+                    {
+                        ImGui::Text("Thread %zu: %.3f ms", t,
+                                    record.threadDurations[t]);
+                    }
+                    ImGui::EndTooltip();
+                }
             }
             ImGui::EndTable();
         }
@@ -509,6 +1288,238 @@ void WaterSurface::ShowStatusWindow() const
     ImGui::End();
 }
 
+void WaterSurface::ShowFramePacing() const
+{
+    if (!ImGui::CollapsingHeader("Frame Pacing"))
+        return;
+
+    using Stage = vkp::FramePacing::Stage;
+    const vkp::FramePacing& kPacing = GetFramePacing();
+
+    ImGui::Text("Bound: %s",
+                vkp::FramePacing::ToString(kPacing.GetBound()));
+
+    if ( ImGui::BeginTable("Frame stages", 4,
+                           ImGuiTableFlags_BordersOuter |
+                           ImGuiTableFlags_BordersV) )
+    {
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("mean");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableHeadersRow();
+
+        auto row = [](const char* name, const vkp::RollingStats& stats) {
+            const vkp::RollingStats::Summary kStats = stats.GetSummary();
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", name);
+            for (float value : { kStats.mean, kStats.p95, kStats.max })
+            {
+                ImGui::TableNextColumn();
+                if (kStats.count > 0)
+                    ImGui::Text("%.3f ms", value);
+                else
+                    ImGui::TextDisabled("-");
+            }
+        };
+
+        for (int i = 0; i < static_cast<int>(Stage::Total); ++i)
+        {
+            const auto kStage = static_cast<Stage>(i);
+            row(vkp::FramePacing::ToString(kStage),
+                kPacing.GetStageTimes(kStage));
+        }
+        row("CPU Frame", kPacing.GetFrameTimes());
+        row("GPU Frame", kPacing.GetGpuFrameTimes());
+        row("Latency", kPacing.GetLatencies());
+
+        ImGui::EndTable();
+    }
+
+    // From the events polled, to the frame displayed
+    switch (m_SwapChain->GetPresentTiming())
+    {
+    case vkp::SwapChain::PresentTiming::DisplayTiming:
+        ImGui::TextDisabled("Latency of VK_GOOGLE_display_timing");
+        break;
+    case vkp::SwapChain::PresentTiming::PresentWait:
+        ImGui::TextDisabled("Latency of VK_KHR_present_wait, polled once a "
+                            "frame, an upper bound");
+        break;
+    default:
+        ImGui::TextDisabled("Latency not measured, no present timing");
+        break;
+    }
+}
+
+void WaterSurface::ShowPipelineStatistics() const
+{
+    if (!ImGui::CollapsingHeader("Pipeline Statistics"))
+        return;
+
+    if (!vkp::GpuProfile::HasStatistics())
+    {
+        ImGui::TextDisabled("Not counted, the device has no "
+                            "pipelineStatisticsQuery");
+        return;
+    }
+
+    const std::vector<vkp::GpuProfile::Statistics> kStatistics =
+        vkp::GpuProfile::GetStatistics();
+    if (kStatistics.empty())
+    {
+        ImGui::TextDisabled("None of the frame, e.g., of a reused one");
+        return;
+    }
+
+    const VkExtent2D kExtent = m_SwapChain->GetExtent();
+    const double kPixelCount = std::max(
+        1.0, static_cast<double>(kExtent.width) * kExtent.height
+    );
+
+    if ( ImGui::BeginTable("Pipeline statistics", 8,
+                           ImGuiTableFlags_BordersOuter |
+                           ImGuiTableFlags_BordersV) )
+    {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Primitives");
+        ImGui::TableSetupColumn("VS");
+        ImGui::TableSetupColumn("TES");
+        ImGui::TableSetupColumn("Clipped in");
+        ImGui::TableSetupColumn("Clipped out");
+        ImGui::TableSetupColumn("FS");
+        ImGui::TableSetupColumn("FS / pixel");
+        ImGui::TableHeadersRow();
+
+        for (const auto& kScope : kStatistics)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", kScope.name);
+
+            for (uint64_t count : { kScope.inputPrimitives,
+                                    kScope.vertexInvocations,
+                                    kScope.tessEvaluationInvocations,
+                                    kScope.clippingInvocations,
+                                    kScope.clippingPrimitives,
+                                    kScope.fragmentInvocations })
+            {
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(count));
+            }
+
+            // Of the whole framebuffer, the overdraw averaged over it
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", kScope.fragmentInvocations / kPixelCount);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void WaterSurface::ShowMemoryUsage() const
+{
+    if (!ImGui::CollapsingHeader("GPU Memory"))
+        return;
+
+    static constexpr double kBytesToMiB{ 1.0 / (1 << 20) };
+    auto textSize = [](VkDeviceSize size) {
+        ImGui::Text("%.1f MiB", size * kBytesToMiB);
+    };
+
+    const vkp::MemoryAllocator& kAllocator = m_Device->GetMemoryAllocator();
+    const auto kTagUsages = kAllocator.GetTagUsages();
+
+    if ( ImGui::BeginTable("Memory tags", 5,
+                           ImGuiTableFlags_BordersOuter |
+                           ImGuiTableFlags_BordersV) )
+    {
+        ImGui::TableSetupColumn("Tag");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Size");
+        ImGui::TableSetupColumn("Device local");
+        ImGui::TableSetupColumn("Peak");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < kTagUsages.size(); ++i)
+        {
+            const auto& kUsage = kTagUsages[i];
+            if (kUsage.peakSize == 0)
+                continue;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", vkp::ToString(static_cast<vkp::MemoryTag>(i)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", kUsage.allocationCount);
+            ImGui::TableNextColumn();
+            textSize(kUsage.size);
+            ImGui::TableNextColumn();
+            textSize(kUsage.deviceLocalSize);
+            ImGui::TableNextColumn();
+            textSize(kUsage.peakSize);
+        }
+        ImGui::EndTable();
+    }
+
+    // Blocks of the allocator, the rest of the usage is of the GUI's and
+    //  the driver's own allocations
+    const vkp::PhysicalDevice& kPhysDevice = m_Device->GetPhysicalDevice();
+    const bool kHasBudget = kPhysDevice.SupportsMemoryBudget();
+    const std::vector<VkDeviceSize> kReserved =
+        kAllocator.GetHeapReservedSizes();
+    const auto kBudgets = kPhysDevice.GetMemoryBudgets();
+
+    if ( ImGui::BeginTable("Memory heaps", 6,
+                           ImGuiTableFlags_BordersOuter |
+                           ImGuiTableFlags_BordersV) )
+    {
+        ImGui::TableSetupColumn("Heap");
+        ImGui::TableSetupColumn("Size");
+        ImGui::TableSetupColumn("Budget");
+        ImGui::TableSetupColumn("Usage");
+        ImGui::TableSetupColumn("Blocks");
+        ImGui::TableSetupColumn("Untracked");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < kBudgets.size(); ++i)
+        {
+            const auto& kHeap = kBudgets[i];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu %s", i, kHeap.isDeviceLocal ? "device local"
+                                                         : "host");
+            ImGui::TableNextColumn();
+            textSize(kHeap.size);
+            ImGui::TableNextColumn();
+            textSize(kHeap.budget);
+
+            ImGui::TableNextColumn();
+            if (!kHasBudget)
+                ImGui::TextDisabled("-");
+            else if (kHeap.usage > kHeap.budget)
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                                   "%.1f MiB", kHeap.usage * kBytesToMiB);
+            else
+                textSize(kHeap.usage);
+
+            ImGui::TableNextColumn();
+            textSize(kReserved[i]);
+
+            ImGui::TableNextColumn();
+            if (kHasBudget && kHeap.usage >= kReserved[i])
+                textSize(kHeap.usage - kReserved[i]);
+            else
+                ImGui::TextDisabled("-");
+        }
+        ImGui::EndTable();
+    }
+
+    if (!kHasBudget)
+        ImGui::TextDisabled("Heap usage not reported, no VK_EXT_memory_budget");
+}
+
 void WaterSurface::ShowCameraSettings()
 {
     if (ImGui::CollapsingHeader("Camera Settings"))
@@ -6,6 +6,9 @@
 #ifndef WATER_SURFACE_RENDERING_WATER_SURFACE_H_
 #define WATER_SURFACE_RENDERING_WATER_SURFACE_H_
 
+#include <filesystem>
+#include <string_view>
+
 #include "core/Application.h"
 
 #include "vulkan/RenderPass.h"
@@ -13,11 +16,15 @@
 #include "vulkan/ShaderModule.h"
 #include "vulkan/Pipeline.h"
 #include "vulkan/Texture2D.h"
+#include "vulkan/MultiviewTarget.h"
 
 #include "scene/Camera.h"
+#include "scene/CameraPath.h"
 #include "scene/WaterSurfaceMesh.h"
 #include "scene/SkyModel.h"
 
+#include "GuiOverlay.h"
+
 
 class WaterSurface : public vkp::Application
 {
@@ -32,10 +39,15 @@ protected:
     /** @brief Called each frame, before rendering */
     void Update(vkp::Timestep deltaTime) override;
 
+    /** @brief Idle once settled, if enabled */
+    bool IsIdle() const override { return m_IsIdle; }
+
     /** @brief Render call, called each frame */
     void Render(
         uint32_t frameIndex,
+        uint32_t imageIndex,
         vkp::Timestep dt,
+        std::vector<VkSemaphore>& semaphoresToWait,
         std::vector<VkPipelineStageFlags>& stagesToWait,
         std::vector<VkCommandBuffer>& buffersToSubmit) override;
 
@@ -46,9 +58,72 @@ protected:
     void OnCursorEntered(int entered) override;
 
 private:
+    // Recorded into secondary command buffers in parallel, if enabled
+    enum SecondaryPasses
+    {
+        PassSky = 0,
+        PassWaterSurface,
+        PassGui,
+
+        PassCount
+    };
+
     void CreateRenderPass();
     void BeginRenderPass(VkCommandBuffer cmdBuffer,
-                         VkFramebuffer framebuffer);
+                         VkFramebuffer framebuffer,
+                         VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+
+    /**
+     * @brief Records each of the passes into its secondary command buffer
+     *  of the frame, concurrently on the OpenMP threads
+     * @return Secondary buffers in the order of execution
+     */
+    std::array<VkCommandBuffer, PassCount> RecordSecondaryPasses(
+        uint32_t frameIndex,
+        VkFramebuffer framebuffer);
+    /** @brief Records the passes inline, inside the render pass */
+    void RecordPasses(uint32_t frameIndex, VkCommandBuffer cmdBuffer);
+    /**
+     * @brief Records the sky and the water in order of the depth test,
+     *  inside a render pass of their pipelines
+     */
+    void RecordScenePasses(uint32_t frameIndex, VkCommandBuffer cmdBuffer,
+                           bool hasDepthAttachment);
+    /**
+     * @brief Records the sky and the water into the layers of all the views,
+     *  outside the main render pass, composited by "RecordPasses()"
+     */
+    void RecordMultiviewPass(uint32_t frameIndex, VkCommandBuffer cmdBuffer);
+    /** @return Of the clear color, black for the overdraw heatmap */
+    std::array<VkClearValue, 2> GetClearValues() const;
+    /** @brief Draws the GUI, or composites its cached overlay */
+    void RecordGuiPass(VkCommandBuffer cmdBuffer);
+
+    /**
+     * @brief Counts the frames the scene stays unchanged for: the GUI is
+     *  hidden, the camera still, and the water surface static
+     */
+    void UpdateStaticFrames();
+    /**
+     * @return True once all the frames in flight, and the delayed waves, are
+     *  of the unchanged scene
+     */
+    bool IsSettled() const {
+        return m_StaticFrameCount >= GetSettleFrameCount();
+    }
+    uint32_t GetSettleFrameCount() const {
+        return m_SwapChain->GetFramesInFlight() + WSSimulation::s_kMaxLatency + 1;
+    }
+    /**
+     * @brief Records the render pass of the image, to be resubmitted while
+     *  settled, of the frame's descriptor sets
+     */
+    void RecordStaticFrame(uint32_t frameIndex, uint32_t imageIndex);
+    /**
+     * @brief Waits for the graphics queue if any is recorded: those
+     *  submitted read the descriptor sets of any of the frames
+     */
+    void InvalidateStaticFrames();
 
     void CreateDrawCommandPools(const uint32_t count);
     void CreateDrawCommandBuffers();
@@ -56,17 +131,59 @@ private:
 
     void CreateDescriptorPool();
 
+    /** @brief Of the command line, e.g., "--sim-threads=6 --pin-threads" */
+    void SetupThreadPlacement();
+    /**
+     * @brief Of the command line, e.g., "--views=2 --view-separation=0.065",
+     *  a single view unless the device supports their multiview
+     */
+    void SetupViews();
+    /**
+     * @brief Of a graph of tasks, @see vkp::TaskGraph: those of ImGui and of
+     *  the one-time commands on the main thread, the others on workers
+     */
     void SetupAssets();
         void SetupGUI();
+        /** @brief Of the swap chain's formats, extent and depth */
+        void CreateGuiOverlayRenderData();
+        /** @brief Of the swap chain's formats, extent and depth */
+        void CreateMultiviewRenderData();
+        /** @brief Of more than one view only */
+        void CreateMultiviewTarget();
         void CreateCamera();
+        /** @brief Of its pipelines and the options of the command line */
         void CreateWaterSurfaceMesh();
+        /** @brief Records the uploads of its maps and of its mesh */
+        void PrepareWaterSurfaceMesh();
         void CreateSkyModel();
 
     void UpdateCamera(vkp::Timestep dt);
 
+    /** @return Of the sky's and the water's pipelines */
+    VkRenderPass GetSceneRenderPass() const;
+    /** @return Of a view, a tile of the framebuffer if several */
+    VkExtent2D GetSceneExtent() const;
+    uint32_t GetViewCount() const { return m_Views.count; }
+
+    /** @brief The water surface's pipelines are rebuilt in the background */
+    void RecompileShaders();
+    /**
+     * @brief If watched, recompiles the shaders once any in s_kShadersDir is
+     *  written, polled every s_kShaderWatchInterval
+     */
+    void WatchShaders(vkp::Timestep dt);
+    /** @return Of the most recently written file in s_kShadersDir */
+    static std::filesystem::file_time_type GetShadersWriteTime();
+
     // GUI:
     void UpdateGui();
-    void ShowStatusWindow() const;
+    void ShowStatusWindow();
+    /** @brief Stages of the main loop, the present latency, and the bound */
+    void ShowFramePacing() const;
+    /** @brief Counters of the passes' draws, of the GPU statistics scopes */
+    void ShowPipelineStatistics() const;
+    /** @brief Of the memory tags, and of the heaps' budgets */
+    void ShowMemoryUsage() const;
     void ShowCameraSettings();
     void ShowControlsWindow(bool* p_open) const;
 
@@ -80,11 +197,41 @@ private:
         VkClearValue{ 1.0f, 0.0f, 0.0f, 0.0f }  // clear depth, stencil
     };
 
+    // The water and the sky add a color per fragment, cleared to black
+    bool m_ShowOverdraw{ false };
+
     // TODO maybe into app
     std::vector<vkp::CommandPool> m_DrawCmdPools;
 
+    // Of each frame, one for each pass: pools are not thread safe, indexed
+    //  by 'frameIndex * PassCount + pass'
+    std::vector<vkp::CommandPool> m_SecondaryCmdPools;
+    bool m_RecordInParallel{ false };
+
+    // Of each swap chain image, recorded once settled, resubmitted unchanged
+    //  while the scene stays so
+    std::unique_ptr<vkp::CommandPool> m_StaticCmdPool{ nullptr };
+    std::vector<bool> m_StaticFramesRecorded;
+    bool m_ReuseStaticFrames{ true };
+    // Nothing is rendered while settled
+    bool m_IdleWhenStatic{ false };
+    bool m_IsIdle{ false };
+
+    uint32_t m_StaticFrameCount{ 0 };   ///< Saturates at the settle count
+    glm::mat4 m_LastViewProj{ 1.0f };
+
     std::unique_ptr<vkp::DescriptorPool> m_DescriptorPool{ nullptr };
 
+    // Of the pool above, the GUI is rendered into it only once changed,
+    //  composited each frame, if enabled
+    std::unique_ptr<gui::Overlay> m_GuiOverlay{ nullptr };
+    bool m_CacheGui{ false };
+
+    // Of the pool above, the sky and the water are drawn once into the
+    //  layers of all the views of the rig, if more than one
+    std::unique_ptr<vkp::MultiviewTarget> m_MultiviewTarget{ nullptr };
+    vkp::Camera::ViewSetup m_Views;
+
     // =========================================================================
 
     /// @brief Application states
@@ -102,12 +249,23 @@ private:
     {
         KeyHideGui = GLFW_KEY_ESCAPE,
         KeyRecompileShaders = GLFW_KEY_F1,
+        KeyCaptureTrace = GLFW_KEY_F2,
     };
 
+    static constexpr std::string_view s_kShadersDir{ "shaders" };
+    static constexpr float s_kShaderWatchInterval{ 0.5f };  ///< In seconds
+
+    bool m_WatchShaders{ false };
+    float m_ShaderWatchTime{ 0.0f };
+    std::filesystem::file_time_type m_ShadersWriteTime{};
+
     // -------------------------------------------------------------------------
     // Assets
 
     std::unique_ptr<vkp::Camera> m_Camera{ nullptr };
+    // Of "--camera-path=file", drives the camera if not empty
+    vkp::CameraPath m_CameraPath;
+    float m_CameraPathTime{ 0.0f };
     static const inline glm::vec3 s_kCamStartPos{ 0.0, 100.0, -520.0 };
     static const inline float s_kCamStartPitch{ glm::radians(-4.0f) };
     static const inline float s_kCamStartYaw  { glm::radians(88.0f) };
@@ -0,0 +1,450 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSTessendorf.h"
+
+#include <omp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+/**
+ * @brief Micro-benchmark of the CPU wave simulation alone, without Vulkan or
+ *  GLFW. For each tile size, thread count, FFT schedule and SIMD level, times
+ *  "Prepare()", and "ComputeWaves()" writing to preallocated outputs.
+ *
+ *  Options, each "--name=value", lists separated by commas:
+ *   --sizes=16,...,1024    Tile sizes, powers of two
+ *   --threads=1,2,...      OpenMP thread counts, by default powers of two
+ *                          up to the count of the cores
+ *   --schedules=auto       auto|transforms|threaded|mixed, or all
+ *   --simd=best            scalar|avx2|avx512|best, or all
+ *   --iterations=100       Timed "ComputeWaves()" calls, after warmup ones
+ *   --prepares=3           Timed "Prepare()" calls, the first one cold
+ *   --dt=0                 Time step of incremental phasors, 0 disables it
+ *   --half --no-normals --unpacked --jacobian
+ *   --output=path.csv      Also writes the results as CSV
+ */
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    constexpr uint32_t s_kWarmupIterations{ 5 };
+
+    struct Options
+    {
+        std::vector<uint32_t> sizes{ 16, 32, 64, 128, 256, 512, 1024 };
+        std::vector<uint32_t> threadCounts;
+        std::vector<WSTessendorf::FFTSchedule> schedules{
+            WSTessendorf::FFTSchedule::Auto
+        };
+        std::vector<wst::SimdLevel> simdLevels;
+        uint32_t iterations{ 100 };
+        uint32_t prepares{ 3 };
+        float timeStep{ 0.0f };
+        bool isHalf{ false };
+        bool computeNormals{ true };
+        bool computeJacobian{ false };
+        bool packed{ true };
+        std::string outputPath;
+    };
+
+    struct Result
+    {
+        uint32_t size;
+        uint32_t threadCount;
+        WSTessendorf::FFTSchedule schedule;     ///< Resolved one
+        wst::SimdLevel simdLevel;               ///< Resolved one
+        double coldPrepareMs;
+        double prepareMs;       ///< Mean of the ones after the first
+        double computeMs;       ///< Mean
+        double computeMinMs;
+        double samplesPerSec;
+        double gbPerSec;
+    };
+
+    double ToMs(Clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+    /** @return Value of "--name=value", or null if not given */
+    const char* GetOption(int argc, char** argv, const char* name)
+    {
+        const size_t kLength = std::strlen(name);
+        for (int i = 1; i < argc; i++)
+        {
+            const char* arg = argv[i];
+            if (std::strncmp(arg, "--", 2) == 0 &&
+                std::strncmp(arg + 2, name, kLength) == 0 &&
+                arg[2 + kLength] == '=')
+            {
+                return arg + 3 + kLength;
+            }
+        }
+        return nullptr;
+    }
+
+    bool HasFlag(int argc, char** argv, const char* name)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (std::strncmp(argv[i], "--", 2) == 0 &&
+                std::strcmp(argv[i] + 2, name) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::string> Split(const char* list)
+    {
+        std::vector<std::string> items;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ','))
+        {
+            if (!item.empty())
+                items.push_back(item);
+        }
+        return items;
+    }
+
+    bool ParseSchedules(const char* list,
+                        std::vector<WSTessendorf::FFTSchedule>& schedules)
+    {
+        using Schedule = WSTessendorf::FFTSchedule;
+        schedules.clear();
+        for (const auto& kName : Split(list))
+        {
+            if (kName == "all")
+            {
+                schedules = { Schedule::Transforms, Schedule::Threaded,
+                              Schedule::Mixed };
+                return true;
+            }
+            if (kName == "auto")            schedules.push_back(Schedule::Auto);
+            else if (kName == "transforms") schedules.push_back(Schedule::Transforms);
+            else if (kName == "threaded")   schedules.push_back(Schedule::Threaded);
+            else if (kName == "mixed")      schedules.push_back(Schedule::Mixed);
+            else
+                return false;
+        }
+        return !schedules.empty();
+    }
+
+    bool ParseSimdLevels(const char* list, std::vector<wst::SimdLevel>& levels)
+    {
+        const auto kSupported = wst::GetSupportedSimdLevel();
+        levels.clear();
+        for (const auto& kName : Split(list))
+        {
+            if (kName == "all")
+            {
+                for (int i = 0; i <= static_cast<int>(kSupported); i++)
+                    levels.push_back(static_cast<wst::SimdLevel>(i));
+                return true;
+            }
+            wst::SimdLevel level;
+            if (kName == "best")        level = kSupported;
+            else if (kName == "scalar") level = wst::SimdLevel::Scalar;
+            else if (kName == "avx2")   level = wst::SimdLevel::AVX2;
+            else if (kName == "avx512") level = wst::SimdLevel::AVX512;
+            else
+                return false;
+
+            if (level > kSupported)
+            {
+                std::fprintf(stderr, "SIMD level %s not supported, skipped\n",
+                             kName.c_str());
+                continue;
+            }
+            levels.push_back(level);
+        }
+        return !levels.empty();
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        try
+        {
+            if (const char* kSizes = GetOption(argc, argv, "sizes"))
+            {
+                options.sizes.clear();
+                for (const auto& kSize : Split(kSizes))
+                {
+                    const auto kValue = static_cast<uint32_t>(std::stoul(kSize));
+                    if (kValue == 0 || (kValue & (kValue - 1)) != 0)
+                        return false;
+                    options.sizes.push_back(kValue);
+                }
+            }
+
+            if (const char* kThreads = GetOption(argc, argv, "threads"))
+            {
+                for (const auto& kCount : Split(kThreads))
+                {
+                    const auto kValue = static_cast<uint32_t>(std::stoul(kCount));
+                    if (kValue == 0)
+                        return false;
+                    options.threadCounts.push_back(kValue);
+                }
+            }
+            else
+            {
+                const auto kMaxThreads =
+                    static_cast<uint32_t>(omp_get_num_procs());
+                for (uint32_t n = 1; n < kMaxThreads; n *= 2)
+                    options.threadCounts.push_back(n);
+                options.threadCounts.push_back(kMaxThreads);
+            }
+
+            if (const char* kSchedules = GetOption(argc, argv, "schedules"))
+            {
+                if (!ParseSchedules(kSchedules, options.schedules))
+                    return false;
+            }
+
+            const char* kSimd = GetOption(argc, argv, "simd");
+            if (!ParseSimdLevels(kSimd ? kSimd : "best", options.simdLevels))
+                return false;
+
+            if (const char* kValue = GetOption(argc, argv, "iterations"))
+                options.iterations = std::max(1u,
+                    static_cast<uint32_t>(std::stoul(kValue)));
+            if (const char* kValue = GetOption(argc, argv, "prepares"))
+                options.prepares = std::max(1u,
+                    static_cast<uint32_t>(std::stoul(kValue)));
+            if (const char* kValue = GetOption(argc, argv, "dt"))
+                options.timeStep = std::stof(kValue);
+            if (const char* kValue = GetOption(argc, argv, "output"))
+                options.outputPath = kValue;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        options.isHalf         = HasFlag(argc, argv, "half");
+        options.computeNormals = !HasFlag(argc, argv, "no-normals");
+        options.computeJacobian = HasFlag(argc, argv, "jacobian");
+        options.packed         = !HasFlag(argc, argv, "unpacked");
+        return true;
+    }
+
+    const char* GetVariant(const Options& options)
+    {
+        return options.computeNormals && options.computeJacobian ? "jacobian"
+                                                                 : "default";
+    }
+
+    /** @brief Mirrors "WSTessendorf::GetTransformCount()" */
+    uint32_t GetTransformCount(const Options& options)
+    {
+        uint32_t pairCount = 1;
+        if (options.computeNormals)
+            pairCount += options.computeJacobian ? 3 : 2;
+        return 1 + pairCount * (options.packed ? 1 : 2);
+    }
+
+    /**
+     * @return Bytes moved per sample by a "ComputeWaves()" call, at least:
+     *  the spectrum read, the FFT inputs written, read and written by the
+     *  transforms in place, read once more, and the outputs written
+     */
+    double GetBytesPerSample(const Options& options)
+    {
+        // h0(k), conj(h0(-k)), k, dispersion, as floats
+        constexpr double kSpectrumBytes = 9 * sizeof(float);
+        constexpr double kComplexBytes  = 2 * sizeof(float);
+        const double kTexelBytes = options.isHalf ? 4 * sizeof(uint16_t) :
+                                                    4 * sizeof(float);
+
+        const double kFFTBytes = 4.0 * GetTransformCount(options) * kComplexBytes;
+        const double kOutputBytes =
+            kTexelBytes * (options.computeNormals ? 2.0 : 1.0);
+
+        return kSpectrumBytes + kFFTBytes + kOutputBytes;
+    }
+
+    Result Run(const Options& options, uint32_t size, uint32_t threadCount,
+               WSTessendorf::FFTSchedule schedule, wst::SimdLevel simdLevel)
+    {
+        omp_set_num_threads(static_cast<int>(threadCount));
+
+        WSTessendorf surface(size);
+        surface.SetPackedFFT(options.packed);
+        surface.SetComputeNormals(options.computeNormals);
+        surface.SetComputeJacobian(options.computeJacobian);
+        surface.SetFFTSchedule(schedule);
+        surface.SetSimdLevel(simdLevel);
+        surface.SetTimeStep(options.timeStep);
+
+        Result result{};
+        result.size        = size;
+        result.threadCount = threadCount;
+
+        // The first one plans the transforms, if there is no wisdom yet
+        for (uint32_t i = 0; i < options.prepares; i++)
+        {
+            // Of all the structures, not only the ones of changed properties
+            surface.Invalidate();
+
+            const auto kBegin = Clock::now();
+            surface.Prepare();
+            const double kMs = ToMs(Clock::now() - kBegin);
+
+            if (i == 0)
+                result.coldPrepareMs = kMs;
+            else
+                result.prepareMs += kMs;
+        }
+        if (options.prepares > 1)
+            result.prepareMs /= options.prepares - 1;
+
+        result.schedule  = surface.GetFFTSchedule();
+        result.simdLevel = surface.GetSimdLevel();
+
+        // Aligned as the texels, written each once, as in staging memory
+        const size_t kCount = surface.GetDisplacementCount();
+        std::vector<glm::vec4> displacements(kCount);
+        std::vector<glm::vec4> normals(options.computeNormals ? kCount : 0);
+        const WSTessendorf::Outputs kOutputs{
+            displacements.data(),
+            options.computeNormals ? normals.data() : nullptr,
+            options.isHalf
+        };
+
+        const float kDt = options.timeStep > 0.0f ? options.timeStep :
+                                                    1.0f / 60.0f;
+        float t = 0.0f;
+        for (uint32_t i = 0; i < s_kWarmupIterations; i++, t += kDt)
+            surface.ComputeWaves(t, kOutputs);
+
+        double totalMs = 0.0;
+        result.computeMinMs = std::numeric_limits<double>::max();
+        for (uint32_t i = 0; i < options.iterations; i++, t += kDt)
+        {
+            const auto kBegin = Clock::now();
+            surface.ComputeWaves(t, kOutputs);
+            const double kMs = ToMs(Clock::now() - kBegin);
+
+            totalMs += kMs;
+            result.computeMinMs = std::min(result.computeMinMs, kMs);
+        }
+        result.computeMs = totalMs / options.iterations;
+
+        const double kSamples = static_cast<double>(kCount);
+        result.samplesPerSec = kSamples / (result.computeMs * 1e-3);
+        result.gbPerSec = result.samplesPerSec * GetBytesPerSample(options) * 1e-9;
+
+        return result;
+    }
+
+    void PrintHeader(const Options& options)
+    {
+        const char* kVariant = GetVariant(options);
+        std::printf("WSTessendorf: variant %s, %u transforms%s%s%s, "
+                    "%.0f B/sample, %u iterations\n",
+                    kVariant, GetTransformCount(options),
+                    options.packed ? " (packed)" : "",
+                    options.computeNormals ? "" : " (without normals)",
+                    options.isHalf ? ", half outputs" : "",
+                    GetBytesPerSample(options), options.iterations);
+        std::printf("%6s %7s %-10s %-6s %12s %12s %11s %11s %14s %9s\n",
+                    "size", "threads", "schedule", "simd",
+                    "prepare0 ms", "prepare ms", "compute ms", "min ms",
+                    "samples/s", "GB/s");
+    }
+
+    void Print(const Result& r)
+    {
+        std::printf("%6u %7u %-10s %-6s %12.3f %12.3f %11.4f %11.4f %14.4g %9.3f\n",
+                    r.size, r.threadCount,
+                    WSTessendorf::ToString(r.schedule), wst::ToString(r.simdLevel),
+                    r.coldPrepareMs, r.prepareMs, r.computeMs, r.computeMinMs,
+                    r.samplesPerSec, r.gbPerSec);
+        std::fflush(stdout);
+    }
+
+    bool WriteCSV(const Options& options, const std::vector<Result>& results)
+    {
+        std::ofstream file(options.outputPath);
+        if (!file.is_open())
+            return false;
+
+        const char* kVariant = GetVariant(options);
+        file << "variant,size,threads,schedule,simd,half,normals,packed,"
+                "prepare_cold_ms,prepare_ms,compute_ms,compute_min_ms,"
+                "samples_per_s,gb_per_s\n";
+        for (const auto& r : results)
+        {
+            file << kVariant << ',' << r.size << ',' << r.threadCount << ','
+                 << WSTessendorf::ToString(r.schedule) << ','
+                 << wst::ToString(r.simdLevel) << ','
+                 << options.isHalf << ',' << options.computeNormals << ','
+                 << options.packed << ','
+                 << r.coldPrepareMs << ',' << r.prepareMs << ','
+                 << r.computeMs << ',' << r.computeMinMs << ','
+                 << r.samplesPerSec << ',' << r.gbPerSec << '\n';
+        }
+        return true;
+    }
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+    vkp::Log::Init();
+#ifdef VKP_DEBUG
+    // Only problems, not the messages of each "Prepare()"
+    vkp::Log::GetLogger()->set_level(spdlog::level::warn);
+    if (auto& assertLogger = vkp::Log::GetAssertLogger())
+        assertLogger->set_level(spdlog::level::warn);
+#endif
+
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Invalid options, see the top of %s\n", __FILE__);
+        return EXIT_FAILURE;
+    }
+
+    PrintHeader(options);
+
+    std::vector<Result> results;
+    for (const uint32_t kSize : options.sizes)
+    {
+        for (const uint32_t kThreadCount : options.threadCounts)
+        {
+            for (const auto kSchedule : options.schedules)
+            {
+                for (const auto kSimdLevel : options.simdLevels)
+                {
+                    results.push_back(Run(options, kSize, kThreadCount,
+                                          kSchedule, kSimdLevel));
+                    Print(results.back());
+                }
+            }
+        }
+    }
+
+    if (!options.outputPath.empty() && !WriteCSV(options, results))
+    {
+        std::fprintf(stderr, "Failed to write: %s\n",
+                     options.outputPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -11,6 +11,37 @@
 
 namespace vkp
 {
+    std::string_view Application::AppCmdLineArgs::GetOption(
+        std::string_view name) const
+    {
+        std::string_view value;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view arg(argv[i]);
+            if (arg.size() > name.size() + 3 && arg.substr(0, 2) == "--" &&
+                arg.substr(2, name.size()) == name &&
+                arg[name.size() + 2] == '=')
+            {
+                value = arg.substr(name.size() + 3);
+            }
+        }
+        return value;
+    }
+
+    bool Application::AppCmdLineArgs::HasFlag(std::string_view name) const
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view arg(argv[i]);
+            if (arg.size() == name.size() + 2 && arg.substr(0, 2) == "--" &&
+                arg.substr(2) == name)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
     Application::Application(const std::string& name, AppCmdLineArgs args)
         : m_Name(name), 
           m_Args(args),
@@ -18,7 +49,8 @@ namespace vkp
     {
         VKP_REGISTER_FUNCTION();
 
-        srand((unsigned int)time(NULL));
+        ParseBenchmarkSettings();
+        ParseCaptureSettings();
     }
 
     Application::~Application()
@@ -42,6 +74,11 @@ namespace vkp
         SetupVulkan();
 
         this->Start();
+
+        // e.g. "--trace-frames=300 --trace-file=capture.json", of the first
+        //  frames of the loop
+        if (!m_Args.GetOption("trace-frames").empty())
+            StartTraceCapture();
     }
 
     void Application::Loop()
@@ -59,21 +96,67 @@ namespace vkp
             //  input data to main application.
 			// Generally, always pass all inputs to dear imgui, and hide them
             //  from application based on those two flags.
+            m_FramePacing.BeginFrame();
+
             glfwPollEvents();
+            m_FramePacing.SampleInput();
 
             if (m_FramebufferResized || m_SwapChain->NeedsRecreation())
             {
                 RecreateSwapChain();
             }
 
+            // Of the previous frames, displayed since
+            for (const auto& kPresent : m_SwapChain->PollPresentTimes())
+                m_FramePacing.OnPresented(kPresent.presentId, kPresent.time);
+
+            m_FramePacing.EndStage(FramePacing::Stage::Poll);
+
             const float curTime = static_cast<float>(glfwGetTime());
             Timestep dt(curTime - m_LastFrameTime);
             m_LastFrameTime = curTime;
 
+            // Records of the previous frame, of all the threads
+            Profile::EndFrame();
+
+            if (m_Benchmark != nullptr)
+            {
+                m_Benchmark->EndFrame();
+                if (m_Benchmark->IsDone())
+                    break;
+
+                // Independent of the real clock
+                dt = Timestep(m_Benchmark->GetTimeStep());
+            }
+            if (m_Capture != nullptr)
+            {
+                if (m_Capture->IsDone())
+                    break;
+
+                // Of the captured sequence, as fast as it is rendered
+                dt = Timestep(m_Capture->GetTimeStep());
+            }
+
             this->Update(dt);
+            m_FramePacing.EndStage(FramePacing::Stage::Update);
+
+            // Nothing would change on the screen, until an event
+            if (this->IsIdle())
+            {
+                glfwWaitEventsTimeout(s_kIdleWaitTimeout);
+                continue;
+            }
+
+            // Resources of the frame in flight are reusable once acquired
+            const uint32_t kFrameIndex = m_SwapChain->GetFrameIndex();
 
-            uint32_t frameIndex;
-            if (m_SwapChain->AcquireNextImage(&frameIndex) != VK_SUCCESS)
+            uint32_t imageIndex;
+            const VkResult kAcquireResult =
+                m_SwapChain->AcquireNextImage(&imageIndex);
+            m_FramePacing.EndStage(FramePacing::Stage::Acquire,
+                                   FramePacing::Stage::FrameWait,
+                                   m_SwapChain->GetFrameWaitTime());
+            if (kAcquireResult != VK_SUCCESS)
                 continue;
         /*
             m_Gui->NewFrame();
@@ -91,31 +174,221 @@ namespace vkp
         */
             //this->OnImGuiRender();
 
+            std::vector<VkSemaphore> waitSemaphores;
             std::vector<VkPipelineStageFlags> waitStages;
             std::vector<VkCommandBuffer> cmdBuffers;
 
             this->Render(
-                frameIndex,
+                kFrameIndex,
+                imageIndex,
                 dt,
+                waitSemaphores,
                 waitStages,
                 cmdBuffers
             );
+            // Last of the frame, after its passes, may wait for the writer
+            if (m_Capture != nullptr)
+            {
+                cmdBuffers.push_back(m_Capture->RecordCopy(
+                    m_SwapChain->GetImage(imageIndex),
+                    m_SwapChain->GetExtent()
+                ));
+            }
+            m_FramePacing.EndStage(FramePacing::Stage::Record);
 
             // TODO GUI renderpass
             //m_Gui->Render(cmdBuffers.back());
             // TODO
 
-            m_SwapChain->DrawFrame(
+            m_SwapChain->SubmitFrame(
+                waitSemaphores,
                 waitStages,
-                cmdBuffers
+                cmdBuffers,
+                {}
             );
+            if (m_Capture != nullptr)
+                m_Capture->Submit(m_SwapChain->GetLastSubmitValue());
+            m_FramePacing.EndStage(FramePacing::Stage::Submit);
 
+            const uint64_t kLastPresentId = m_SwapChain->GetLastPresentId();
             m_SwapChain->PresentFrame();
+            m_FramePacing.EndStage(FramePacing::Stage::Present);
+
+            // Of a new id only if presented
+            const uint64_t kPresentId = m_SwapChain->GetLastPresentId();
+            m_FramePacing.EndFrame(kPresentId != kLastPresentId ? kPresentId : 0);
         }
 
         // Finish operations before exiting and destroying the window
         //  else might destroy objects while still drawing
         m_Device->WaitIdle();
+
+        if (m_Benchmark != nullptr)
+        {
+            m_Benchmark->SetMemoryUsage(GetMemoryUsage());
+            m_Benchmark->Write();
+        }
+    }
+
+    std::vector<Benchmark::MemoryRow> Application::GetMemoryUsage() const
+    {
+        std::vector<Benchmark::MemoryRow> rows;
+
+        const MemoryAllocator& kAllocator = m_Device->GetMemoryAllocator();
+        const auto kTagUsages = kAllocator.GetTagUsages();
+        for (size_t i = 0; i < kTagUsages.size(); ++i)
+        {
+            const MemoryAllocator::TagUsage& kUsage = kTagUsages[i];
+            if (kUsage.peakSize == 0)
+                continue;
+
+            rows.push_back({
+                .name = ToString(static_cast<MemoryTag>(i)),
+                .size = kUsage.size,
+                .peakSize = kUsage.peakSize
+            });
+        }
+
+        // Of all the allocations of the process, with the driver's and
+        //  the GUI's, if reported
+        const std::vector<VkDeviceSize> kReserved =
+            kAllocator.GetHeapReservedSizes();
+        const auto kBudgets = m_Device->GetPhysicalDevice().GetMemoryBudgets();
+        for (size_t i = 0; i < kBudgets.size(); ++i)
+        {
+            const std::string kHeap = "Heap " + std::to_string(i) +
+                (kBudgets[i].isDeviceLocal ? " device local" : " host");
+            if (kBudgets[i].usage > 0)
+            {
+                rows.push_back({ .name = kHeap, .size = kBudgets[i].usage,
+                                 .budget = kBudgets[i].budget });
+            }
+            rows.push_back({ .name = kHeap + " blocks", .size = kReserved[i],
+                             .budget = kBudgets[i].budget });
+        }
+
+        return rows;
+    }
+
+    void Application::ParseBenchmarkSettings()
+    {
+        if (!m_Args.HasFlag("benchmark"))
+            return;
+
+        Benchmark::Settings settings;
+
+        // Of a positive integer, otherwise the default is kept
+        auto parseCount = [this](std::string_view name, uint32_t* value,
+                                 bool allowZero) {
+            const std::string_view kValue = m_Args.GetOption(name);
+            if (kValue.empty())
+                return;
+
+            const int kCount = std::atoi(std::string(kValue).c_str());
+            if (kCount > 0 || (allowZero && kValue == "0"))
+                *value = static_cast<uint32_t>(kCount);
+            else
+                VKP_LOG_WARN("Invalid {}: {}", name, kValue);
+        };
+
+        parseCount("benchmark-frames", &settings.frameCount, false);
+        parseCount("benchmark-warmup", &settings.warmupFrameCount, true);
+
+        const std::string_view kTimeStep = m_Args.GetOption("benchmark-dt");
+        if (!kTimeStep.empty())
+        {
+            const float kStep = std::strtof(std::string(kTimeStep).c_str(),
+                                            nullptr);
+            if (kStep > 0.0f)
+                settings.timeStep = kStep;
+            else
+                VKP_LOG_WARN("Invalid benchmark time step: {}", kTimeStep);
+        }
+
+        ParseResolution(&settings.width, &settings.height);
+
+        const std::string_view kOutput = m_Args.GetOption("benchmark-output");
+        if (!kOutput.empty())
+            settings.outputPath = kOutput;
+
+        VKP_LOG_INFO("Benchmark: {} frames after {} warmup, {}x{}, step {} s",
+                     settings.frameCount, settings.warmupFrameCount,
+                     settings.width, settings.height, settings.timeStep);
+
+        m_Benchmark = std::make_unique<Benchmark>(settings);
+    }
+
+    void Application::ParseCaptureSettings()
+    {
+        const std::string_view kOutputDir = m_Args.GetOption("capture");
+        if (kOutputDir.empty())
+            return;
+
+        FrameCapture::Settings settings;
+        settings.outputDir = kOutputDir;
+
+        // Of a positive integer, otherwise the default is kept
+        auto parseCount = [this](std::string_view name, uint32_t* value) {
+            const std::string_view kValue = m_Args.GetOption(name);
+            if (kValue.empty())
+                return;
+
+            const int kCount = std::atoi(std::string(kValue).c_str());
+            if (kCount > 0)
+                *value = static_cast<uint32_t>(kCount);
+            else
+                VKP_LOG_WARN("Invalid {}: {}", name, kValue);
+        };
+
+        parseCount("capture-frames", &settings.frameCount);
+        parseCount("capture-latency", &settings.latency);
+
+        const std::string_view kTimeStep = m_Args.GetOption("capture-dt");
+        if (!kTimeStep.empty())
+        {
+            const float kStep = std::strtof(std::string(kTimeStep).c_str(),
+                                            nullptr);
+            if (kStep > 0.0f)
+                settings.timeStep = kStep;
+            else
+                VKP_LOG_WARN("Invalid capture time step: {}", kTimeStep);
+        }
+
+        ParseResolution(&settings.width, &settings.height);
+
+        m_CaptureSettings = settings;
+    }
+
+    void Application::ParseResolution(uint32_t* width, uint32_t* height) const
+    {
+        // e.g. "--resolution=3840x2160"
+        const std::string_view kResolution = m_Args.GetOption("resolution");
+        if (kResolution.empty())
+            return;
+
+        unsigned int w = 0, h = 0;
+        if (std::sscanf(std::string(kResolution).c_str(), "%ux%u",
+                        &w, &h) == 2 && w > 0 && h > 0)
+        {
+            *width = w;
+            *height = h;
+        }
+        else
+            VKP_LOG_WARN("Invalid resolution: {}", kResolution);
+    }
+
+    VkExtent2D Application::GetOffscreenExtent() const
+    {
+        // Both of the same "--resolution"
+        if (m_Benchmark != nullptr)
+        {
+            const Benchmark::Settings& kSettings = m_Benchmark->GetSettings();
+            return { kSettings.width, kSettings.height };
+        }
+        if (m_CaptureSettings.has_value())
+            return { m_CaptureSettings->width, m_CaptureSettings->height };
+
+        return { 0, 0 };
     }
 
     // =============================================================================
@@ -125,7 +398,19 @@ namespace vkp
 
     void Application::SetupWindow()
     {
-        m_Window = std::make_unique<Window>(m_Name.c_str());
+        const VkExtent2D kOffscreenExtent = GetOffscreenExtent();
+        if (kOffscreenExtent.width > 0)
+        {
+            // Of the offscreen images, never shown
+            m_Window = std::make_unique<Window>(
+                m_Name.c_str(),
+                static_cast<int>(kOffscreenExtent.width),
+                static_cast<int>(kOffscreenExtent.height),
+                false
+            );
+        }
+        else
+            m_Window = std::make_unique<Window>(m_Name.c_str());
 
         // Register window callbacks
         m_Window->SetUserPointer(this);
@@ -143,7 +428,13 @@ namespace vkp
         CreateSurface();
         SetupSwapChain();
 
-        CreateTransferCommandPool();
+        CreateTransferContext();
+
+        if (m_CaptureSettings.has_value())
+        {
+            m_Capture = std::make_unique<FrameCapture>(*m_Device,
+                                                       *m_CaptureSettings);
+        }
     }
 
     void Application::CreateInstance()
@@ -204,7 +495,52 @@ namespace vkp
                        "No WSI support on physical device:");
 
         m_SwapChain = std::make_unique<SwapChain>(*m_Device, *m_Surface);
+        const VkExtent2D kOffscreenExtent = GetOffscreenExtent();
+        m_SwapChain->SetOffscreen(kOffscreenExtent.width > 0);
 
+        // e.g. "--present-mode=fifo --frames-in-flight=3"
+        const std::string_view kPresentMode = m_Args.GetOption("present-mode");
+        if (!kPresentMode.empty())
+        {
+            static const std::pair<std::string_view, VkPresentModeKHR> kModes[] = {
+                { "mailbox", VK_PRESENT_MODE_MAILBOX_KHR },
+                { "immediate", VK_PRESENT_MODE_IMMEDIATE_KHR },
+                { "fifo", VK_PRESENT_MODE_FIFO_KHR },
+                { "fifo_relaxed", VK_PRESENT_MODE_FIFO_RELAXED_KHR }
+            };
+
+            bool isKnown = false;
+            for (const auto& [kName, kMode] : kModes)
+            {
+                if (kName == kPresentMode)
+                {
+                    m_SwapChain->SetPreferredPresentMode(kMode);
+                    isKnown = true;
+                }
+            }
+            if (!isKnown)
+                VKP_LOG_WARN("Unknown present mode: {}", kPresentMode);
+        }
+
+        const std::string_view kFramesInFlight =
+            m_Args.GetOption("frames-in-flight");
+        if (!kFramesInFlight.empty())
+        {
+            const int kCount = std::atoi(std::string(kFramesInFlight).c_str());
+            if (kCount > 0)
+                m_SwapChain->SetFramesInFlight(static_cast<uint32_t>(kCount));
+            else
+                VKP_LOG_WARN("Invalid frames in flight: {}", kFramesInFlight);
+        }
+
+        if (kOffscreenExtent.width > 0)
+        {
+            // Regardless of the window, e.g., of a display of a lower one
+            m_SwapChain->Create(kOffscreenExtent.width,
+                                kOffscreenExtent.height,
+                                m_DepthTestingEnabled);
+        }
+        else
         {
             int width = 0, height = 0;
             m_Window->GetFramebufferSize(&width, &height);
@@ -233,12 +569,12 @@ namespace vkp
             isMinimized = width == 0 || height == 0;
         }
 
-        auto err = m_Device->WaitIdle();
-        VKP_ASSERT_RESULT(err);
-
+        // Resources in use by the frames in flight are retired by the swap
+        //  chain, instead of waiting for the device
         //m_RenderPass->Destroy();
         //DestroyDrawCommandPools();
         m_SwapChain->Create(width, height, m_DepthTestingEnabled);
+        m_FramePacing.DiscardPending();
 
     /*
         CreateRenderPass();
@@ -254,15 +590,12 @@ namespace vkp
         m_FramebufferResized = false;
     }
 
-    void Application::CreateTransferCommandPool()
+    void Application::CreateTransferContext()
     {
         VKP_REGISTER_FUNCTION();
 
-        m_TransferCmdPool = 
-            std::make_unique<CommandPool>(
-                *m_Device, QFamily::Graphics,
-                VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |  // short-lived
-                VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT // individually reset
+        m_TransferContext = std::make_unique<TransferContext>(
+            *m_Device, s_kTransferCmdPoolQueueFamily
         );
     }
 
@@ -270,58 +603,64 @@ namespace vkp
     // Utils
     // ============================================================================
 
-    CommandBuffer& Application::CreateTransferCmdBuffer()
+    uint64_t Application::SubmitTransferCmdBuffer(CommandBuffer& cmdBuffer)
     {
         VKP_REGISTER_FUNCTION();
 
-        m_TransferCmdPool->AllocateCommandBuffers(1);
-        return m_TransferCmdPool->Back();
+        m_TransferContext->End(cmdBuffer);
+        return m_TransferContext->Flush();
     }
 
-    void Application::SubmitTransferCmdBuffer(CommandBuffer& cmdBuffer) const
+    void Application::BatchTransferCmdBuffer(CommandBuffer& cmdBuffer)
     {
-        VKP_REGISTER_FUNCTION();
-
-        cmdBuffer.End();
-
-        // Execute the command buffer to complete the transfer
-        {
-            VkSubmitInfo submitInfo{};
-            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &cmdBuffer.buffer;
+        m_TransferContext->End(cmdBuffer);
+    }
 
-            m_Device->QueueSubmit(m_TransferCmdPool->GetAssignedQueueFamily(),
-                                  { submitInfo });
-        }
+    uint64_t Application::FlushTransfers()
+    {
+        VKP_REGISTER_FUNCTION();
+        return m_TransferContext->Flush();
     }
 
-    void Application::WaitTransferComplete() const
+    void Application::WaitTransferComplete(uint64_t value) const
     {
-        // Wait for the transfer to complete
-        // TODO bad for unified - NEVER WAIT
-        m_Device->QueueWaitIdle(m_TransferCmdPool->GetAssignedQueueFamily());
+        // Frames in flight on a unified queue are not waited for
+        m_TransferContext->Wait(value);
     }
 
     CommandBuffer& Application::BeginOneTimeCommands()
     {
         VKP_REGISTER_FUNCTION();
-
-        CommandBuffer& cmdBuffer = CreateTransferCmdBuffer();
-        cmdBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-        return cmdBuffer;
+        return m_TransferContext->Begin();
     }
 
     void Application::EndOneTimeCommands(CommandBuffer& cmdBuffer)
     {
         VKP_REGISTER_FUNCTION();
 
-        SubmitTransferCmdBuffer(cmdBuffer);
-        WaitTransferComplete();
+        // Buffer is reused by a later "BeginOneTimeCommands()"
+        WaitTransferComplete( SubmitTransferCmdBuffer(cmdBuffer) );
+    }
+
+    void Application::StartTraceCapture() const
+    {
+        uint32_t frameCount = s_kDefaultTraceFrameCount;
+
+        const std::string_view kFrames = m_Args.GetOption("trace-frames");
+        if (!kFrames.empty())
+        {
+            const int kCount = std::atoi(std::string(kFrames).c_str());
+            if (kCount > 0)
+                frameCount = static_cast<uint32_t>(kCount);
+            else
+                VKP_LOG_WARN("Invalid trace frames: {}", kFrames);
+        }
+
+        std::string_view path = m_Args.GetOption("trace-file");
+        if (path.empty())
+            path = s_kDefaultTraceFile;
 
-        // TODO only free the cmdBuffer
-        m_TransferCmdPool->FreeCommandBuffers();
+        Profile::StartCapture(frameCount, std::filesystem::path(path));
     }
 
     std::vector<
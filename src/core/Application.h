@@ -7,11 +7,15 @@
 #define WATER_SURFACE_RENDERING_APPLICATION_H_
 
 #include <string>
+#include <string_view>
 #include <memory>
+#include <optional>
 
 #include <vulkan/vulkan.h>
 
 #include "core/Assert.h"
+#include "core/Benchmark.h"
+#include "core/FramePacing.h"
 #include "core/Timestep.h"
 #include "core/Timer.h"
 #include "core/Window.h"
@@ -19,6 +23,8 @@
 #include "vulkan/Device.h"
 #include "vulkan/SwapChain.h"
 #include "vulkan/CommandPool.h"
+#include "vulkan/FrameCapture.h"
+#include "vulkan/TransferContext.h"
 #include "vulkan/ShaderModule.h"
 
 
@@ -37,6 +43,15 @@ namespace vkp
                 VKP_ASSERT(i < argc);
                 return argv[i];
             }
+
+            /**
+             * @return Value of the last "--name=value" argument, empty if
+             *  there is none
+             */
+            std::string_view GetOption(std::string_view name) const;
+
+            /** @return True if there is a "--name" argument */
+            bool HasFlag(std::string_view name) const;
         };
 
     public:
@@ -59,10 +74,28 @@ namespace vkp
         /** @brief Called each frame, before rendering */
         virtual void Update(Timestep deltaTime) = 0;
 
-        /** @brief Render call, called each frame */
+        /**
+         * @brief Called after "Update()", if true the frame is neither
+         *  rendered nor presented, the loop waits for events, at most
+         *  s_kIdleWaitTimeout
+         */
+        virtual bool IsIdle() const { return false; }
+
+        /**
+         * @brief Render call, called each frame
+         * @param frameIndex Of the frame in flight, its previous submission
+         *  has finished, indexes the per-frame resources
+         * @param imageIndex Of the acquired swap chain image, its framebuffer
+         * @param semaphoresToWait Semaphores the submission waits on, each at
+         *  the stage in 'stagesToWait' of the same index
+         * @param stagesToWait One more stage than semaphores, the last one
+         *  waits for the acquired image
+         */
         virtual void Render(
             uint32_t frameIndex,
+            uint32_t imageIndex,
             Timestep dt,
+            std::vector<VkSemaphore>& semaphoresToWait,
             std::vector<VkPipelineStageFlags>& stagesToWait,
             std::vector<VkCommandBuffer>& buffersToSubmit) = 0;
 
@@ -79,33 +112,63 @@ namespace vkp
         // Utility functions 
 
         /**
-        * @return Allocated command buffer from the transfer command pool, that
-        *  can be individually reset for multiple submissions */
-        CommandBuffer& CreateTransferCmdBuffer();
+        * @brief Ends the recording, and submits the command buffer to 
+        *  the transfer queue, along with the batched ones, through its timeline
+        * @return Value of the timeline reached once the transfer is done
+        */
+        uint64_t SubmitTransferCmdBuffer(CommandBuffer& cmdBuffer);
 
         /**
-        * @brief Ends the recording, and submits the command buffer to 
-        *  the transfer queue
+        * @brief Ends the recording, the command buffer is submitted by
+        *  the next "FlushTransfers()", or "SubmitTransferCmdBuffer()"
+        */
+        void BatchTransferCmdBuffer(CommandBuffer& cmdBuffer);
+
+        /**
+        * @brief Submits the batched command buffers in one submission
+        * @return Value of the timeline reached once the transfers are done
         */
-        void SubmitTransferCmdBuffer(CommandBuffer& cmdBuffer) const;
+        uint64_t FlushTransfers();
 
-        /** @brief Host waits until the transfer queue is idle */
-        void WaitTransferComplete() const;
+        bool IsTransferComplete(uint64_t value) const {
+            return m_TransferContext->IsComplete(value);
+        }
+
+        /**
+        * @brief Host waits until the transfer of the timeline value is done,
+        *  not for any other work of the queue
+        */
+        void WaitTransferComplete(uint64_t value) const;
 
         /**
-        * @brief Allocates a command buffer from the transfer command pool, and
-        *  begins the recording as a "one time submit buffer"
+        * @brief Begins the recording of a command buffer of the transfer
+        *  context, reused once its previous submission is done, as
+        *  a "one time submit buffer"
         * @return Command buffer in a recording state
         */
         CommandBuffer& BeginOneTimeCommands();
 
         /**
         * @brief Ends the recording, submits the buffer to the transfer queue,
-        *  host waits for the queue to go idle, then frees the command buffer
+        *  host waits for its transfer to complete
         * @param cmdBuffer Command buffer in recording state
         */
         void EndOneTimeCommands(CommandBuffer& cmdBuffer);
 
+        /**
+         * @brief Captures the profile of the next "--trace-frames=N" frames,
+         *  s_kDefaultTraceFrameCount by default, into "--trace-file=path"
+         */
+        void StartTraceCapture() const;
+
+        /** @return Null unless run by "--benchmark" */
+        const Benchmark* GetBenchmark() const { return m_Benchmark.get(); }
+        /** @return Null unless run by "--capture=dir" */
+        const FrameCapture* GetFrameCapture() const { return m_Capture.get(); }
+
+        /** @brief Of the stages of the main loop, and the present latency */
+        const FramePacing& GetFramePacing() const { return m_FramePacing; }
+
         std::vector<
             std::shared_ptr<ShaderModule>
         > CreateShadersFromShaderInfos(const ShaderInfo* kShaderInfos,
@@ -123,8 +186,10 @@ namespace vkp
         Device::Requirements m_Requirements{
             .deviceType = VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU,
             .deviceFeatures = {},
+            .optionalDeviceFeatures = {},
             .queueFamilies = { VK_QUEUE_GRAPHICS_BIT },
             .deviceExtensions = {},
+            .optionalDeviceExtensions = {},
             .presentationSupport = true
         };
         
@@ -144,8 +209,25 @@ namespace vkp
         static const auto s_kTransferCmdPoolQueueFamily = QFamily::Graphics;
 
         // Used for issuing transfer commands
-        std::unique_ptr<CommandPool> m_TransferCmdPool{ nullptr };
+        std::unique_ptr<TransferContext> m_TransferContext{ nullptr };
+
+        // Of "--benchmark": the window is hidden, the frames are rendered
+        //  offscreen, each advanced by the same time step
+        std::unique_ptr<Benchmark> m_Benchmark{ nullptr };
+        // Of "--capture=dir": offscreen as well, each frame is copied after
+        //  its passes and written by a worker, created with the device
+        std::optional<FrameCapture::Settings> m_CaptureSettings;
+        std::unique_ptr<FrameCapture> m_Capture{ nullptr };
         
+        // Stages of the main loop, the GPU time of the frames added by the
+        //  application, @see FramePacing::AddGpuFrameTime()
+        FramePacing m_FramePacing;
+
+        static constexpr double s_kIdleWaitTimeout{ 0.1 };  ///< In seconds
+
+        static constexpr uint32_t s_kDefaultTraceFrameCount{ 120 };
+        static constexpr std::string_view s_kDefaultTraceFile{ "trace.json" };
+
         float m_LastFrameTime      { 0.0f };
         bool  m_FramebufferResized { false };
         bool m_DepthTestingEnabled{ false };
@@ -154,6 +236,31 @@ namespace vkp
         void Init();
         void Loop();
 
+        /**
+         * @brief Of "--benchmark", "--benchmark-frames=N",
+         *  "--benchmark-warmup=N", "--benchmark-dt=seconds",
+         *  "--benchmark-output=path" and "--resolution=WxH"
+         */
+        void ParseBenchmarkSettings();
+        /**
+         * @brief Of "--capture=dir", "--capture-frames=N",
+         *  "--capture-dt=seconds", "--capture-latency=N" and
+         *  "--resolution=WxH"
+         */
+        void ParseCaptureSettings();
+        /** @brief Of "--resolution=WxH", the values are kept if invalid */
+        void ParseResolution(uint32_t* width, uint32_t* height) const;
+        /**
+         * @return Of the benchmark or of the capture, rendered offscreen,
+         *  zero if rendered to the window
+         */
+        VkExtent2D GetOffscreenExtent() const;
+        /**
+         * @return Of each memory tag, and of each heap: its usage reported by
+         *  VK_EXT_memory_budget, and the blocks of the allocator
+         */
+        std::vector<Benchmark::MemoryRow> GetMemoryUsage() const;
+
         void SetupVulkan();
         void SetupWindow();
 
@@ -168,7 +275,7 @@ namespace vkp
         bool MakeDeviceSupportPresentation(/*Device& device*/);
 
         void RecreateSwapChain();
-        void CreateTransferCommandPool();
+        void CreateTransferContext();
 
         // ----------------------------------------------------------------------
 
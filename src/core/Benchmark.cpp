@@ -0,0 +1,164 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "core/Benchmark.h"
+
+#include <fstream>
+
+#include "core/Profile.h"
+
+
+namespace vkp
+{
+    // Reserved for each measured frame
+    static constexpr uint32_t s_kRowsPerFrame{ 32 };
+
+    Benchmark::Benchmark(const Settings& settings)
+        : m_Settings(settings),
+          m_FrameTimes(std::max(settings.frameCount, 1u))
+    {
+        VKP_REGISTER_FUNCTION();
+
+        // Reallocated only if the frames have more records
+        m_Rows.reserve(
+            static_cast<size_t>(m_Settings.frameCount) * s_kRowsPerFrame
+        );
+    }
+
+    void Benchmark::EndFrame()
+    {
+        const auto kNow = std::chrono::high_resolution_clock::now();
+
+        // Called at the beginning of each frame, of the previous one
+        if (!m_IsStarted)
+        {
+            m_IsStarted = true;
+            m_FrameBegin = kNow;
+            return;
+        }
+
+        const float kFrameTime =
+            std::chrono::duration<float, std::milli>(kNow - m_FrameBegin).count();
+        m_FrameBegin = kNow;
+
+        const uint32_t kFrame = m_FrameCount++;
+        if (kFrame < m_Settings.warmupFrameCount)
+            return;
+
+        const uint32_t kMeasuredFrame = kFrame - m_Settings.warmupFrameCount;
+        m_FrameTimes.Add(kFrameTime);
+        m_Rows.push_back({ kMeasuredFrame, "Frame", kFrameTime, -1.0f });
+
+        // CPU durations merged just now, GPU ones read back during the frame
+        const uint64_t kProfileFrame = Profile::GetFrameCount();
+        for (const auto& record : Profile::GetRecordsFromLatest())
+        {
+            const bool kHasCpu = record.frame == kProfileFrame &&
+                                 record.duration >= 0.0f;
+            const bool kHasGpu = record.gpuFrame + 1 == kProfileFrame &&
+                                 record.gpuDuration >= 0.0f;
+            if (!kHasCpu && !kHasGpu)
+                continue;
+
+            m_Rows.push_back({
+                kMeasuredFrame, record.name,
+                kHasCpu ? record.duration : -1.0f,
+                kHasGpu ? record.gpuDuration : -1.0f
+            });
+        }
+    }
+
+    bool Benchmark::Write() const
+    {
+        VKP_REGISTER_FUNCTION();
+
+        const RollingStats::Summary kStats = m_FrameTimes.GetSummary();
+        VKP_LOG_INFO("Benchmark: {} frames, {}x{}, frame time ms: "
+                     "min {:.3f}, mean {:.3f}, p50 {:.3f}, p95 {:.3f}, "
+                     "p99 {:.3f}, max {:.3f}",
+                     kStats.count, m_Settings.width, m_Settings.height,
+                     kStats.min, kStats.mean, kStats.p50, kStats.p95,
+                     kStats.p99, kStats.max);
+
+        std::ofstream file(m_Settings.outputPath);
+        if (!file)
+        {
+            VKP_LOG_ERR("Benchmark: failed to write: {}",
+                        m_Settings.outputPath.string());
+            return false;
+        }
+
+        // Empty if none
+        auto writeDuration = [&file](float duration) {
+            if (duration >= 0.0f)
+                file << duration;
+        };
+
+        file << "frame,time,scope,cpu_ms,gpu_ms\n";
+        for (const Row& row : m_Rows)
+        {
+            file << row.frame << ',' << row.frame * m_Settings.timeStep << ','
+                 << '"' << row.scope << "\",";
+            writeDuration(row.cpuDuration);
+            file << ',';
+            writeDuration(row.gpuDuration);
+            file << '\n';
+        }
+
+        VKP_LOG_INFO("Benchmark: written into {}",
+                     m_Settings.outputPath.string());
+        return WriteMemoryUsage();
+    }
+
+    bool Benchmark::WriteMemoryUsage() const
+    {
+        if (m_MemoryRows.empty())
+            return true;
+
+        static constexpr double kBytesToMiB{ 1.0 / (1 << 20) };
+        for (const MemoryRow& row : m_MemoryRows)
+        {
+            VKP_LOG_INFO("Benchmark: memory of {}: {:.1f} MiB, peak {:.1f} MiB",
+                         row.name, row.size * kBytesToMiB,
+                         row.peakSize * kBytesToMiB);
+            if (row.budget > 0 && row.size > row.budget)
+            {
+                VKP_LOG_WARN("Benchmark: {} over its budget of {:.1f} MiB",
+                             row.name, row.budget * kBytesToMiB);
+            }
+        }
+
+        std::filesystem::path path = m_Settings.outputPath;
+        path.replace_filename(path.stem().string() + "_memory.csv");
+
+        std::ofstream file(path);
+        if (!file)
+        {
+            VKP_LOG_ERR("Benchmark: failed to write: {}", path.string());
+            return false;
+        }
+
+        // Empty if none
+        auto writeSize = [&file](uint64_t size) {
+            if (size > 0)
+                file << size;
+        };
+
+        file << "name,bytes,peak_bytes,budget_bytes\n";
+        for (const MemoryRow& row : m_MemoryRows)
+        {
+            file << '"' << row.name << "\"," << row.size << ',';
+            writeSize(row.peakSize);
+            file << ',';
+            writeSize(row.budget);
+            file << '\n';
+        }
+
+        VKP_LOG_INFO("Benchmark: memory usage written into {}", path.string());
+        return true;
+    }
+
+} // namespace vkp
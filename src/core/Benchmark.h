@@ -0,0 +1,106 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_CORE_BENCHMARK_H_
+#define WATER_SURFACE_RENDERING_CORE_BENCHMARK_H_
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "core/RollingStats.h"
+
+
+namespace vkp
+{
+    /**
+     * @brief Measures a fixed count of frames, each advanced by the same
+     *  time step: of each frame, its CPU time, and the CPU and GPU durations
+     *  of the profile records merged by it. Written as CSV rows of
+     *  "frame,time,scope,cpu_ms,gpu_ms", the frame time in the "Frame" scope.
+     *
+     *  GPU durations are of the frame read back last, that is the frames in
+     *  flight earlier than the row's frame.
+     *
+     *  The memory usage set at the end is written beside, into
+     *  "<output>_memory.csv" of rows "name,bytes,peak_bytes,budget_bytes".
+     */
+    class Benchmark
+    {
+    public:
+        struct Settings
+        {
+            uint32_t frameCount{ 600 };
+            // Not measured, e.g., of the caches and the pipelines warming up
+            uint32_t warmupFrameCount{ 60 };
+            float timeStep{ 1.0f / 60.0f };     ///< In seconds
+            uint32_t width{ 1920 };
+            uint32_t height{ 1080 };
+            std::filesystem::path outputPath{ "benchmark.csv" };
+        };
+
+        /** @brief Of a subsystem's or a heap's memory, in bytes */
+        struct MemoryRow
+        {
+            std::string name;
+            uint64_t size{ 0 };
+            uint64_t peakSize{ 0 };     ///< Zero if not tracked
+            uint64_t budget{ 0 };       ///< Zero if none
+        };
+
+        explicit Benchmark(const Settings& settings);
+
+        /**
+         * @brief Of the frame just finished, after its profile records are
+         *  merged by "Profile::EndFrame()"
+         */
+        void EndFrame();
+
+        bool IsDone() const {
+            return m_FrameCount >= m_Settings.warmupFrameCount +
+                                   m_Settings.frameCount;
+        }
+
+        const Settings& GetSettings() const { return m_Settings; }
+        float GetTimeStep() const { return m_Settings.timeStep; }
+
+        /** @brief Of the end of the run, before "Write()" */
+        void SetMemoryUsage(std::vector<MemoryRow> rows) {
+            m_MemoryRows = std::move(rows);
+        }
+
+        /**
+         * @brief Writes the rows, and logs the summary of the frame times and
+         *  of the memory usage
+         */
+        bool Write() const;
+
+    private:
+        struct Row
+        {
+            uint32_t frame;
+            const char* scope;
+            float cpuDuration;   ///< Negative if none
+            float gpuDuration;   ///< Negative if none
+        };
+
+        bool WriteMemoryUsage() const;
+
+    private:
+        Settings m_Settings;
+
+        bool m_IsStarted{ false };   ///< Once the first frame has begun
+        uint32_t m_FrameCount{ 0 };
+        std::chrono::high_resolution_clock::time_point m_FrameBegin;
+
+        std::vector<Row> m_Rows;
+        RollingStats m_FrameTimes;
+        std::vector<MemoryRow> m_MemoryRows;
+    };
+
+} // namespace vkp
+
+#endif // WATER_SURFACE_RENDERING_CORE_BENCHMARK_H_
@@ -0,0 +1,140 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "core/FramePacing.h"
+
+
+namespace vkp
+{
+    static float ToMillis(FramePacing::Clock::duration d)
+    {
+        return std::chrono::duration<float, std::milli>(d).count();
+    }
+
+    const char* FramePacing::ToString(Stage stage)
+    {
+        switch (stage)
+        {
+        case Stage::Poll:       return "Poll";
+        case Stage::Update:     return "Update";
+        case Stage::FrameWait:  return "Frame Wait";
+        case Stage::Acquire:    return "Acquire";
+        case Stage::Record:     return "Record";
+        case Stage::Submit:     return "Submit";
+        case Stage::Present:    return "Present";
+        default:                return "Unknown";
+        }
+    }
+
+    const char* FramePacing::ToString(Bound bound)
+    {
+        switch (bound)
+        {
+        case Bound::CPU:        return "CPU";
+        case Bound::GPU:        return "GPU";
+        case Bound::Present:    return "Present (vsync)";
+        default:                return "Unknown";
+        }
+    }
+
+    FramePacing::FramePacing(uint32_t windowSize)
+        : m_FrameTimes(windowSize),
+          m_GpuFrameTimes(windowSize),
+          m_Latencies(windowSize)
+    {
+        SetWindowSize(windowSize);
+    }
+
+    void FramePacing::BeginFrame()
+    {
+        m_StageBegin = Clock::now();
+        m_InputTime = m_StageBegin;
+        m_FrameStages.fill(0.0f);
+    }
+
+    void FramePacing::EndStage(Stage stage)
+    {
+        const auto kNow = Clock::now();
+        m_FrameStages[static_cast<size_t>(stage)] += ToMillis(kNow - m_StageBegin);
+        m_StageBegin = kNow;
+    }
+
+    void FramePacing::EndStage(Stage stage, Stage waitStage, float waitTime)
+    {
+        const auto kNow = Clock::now();
+        const float kTime = ToMillis(kNow - m_StageBegin);
+        const float kWaitTime = std::clamp(waitTime, 0.0f, kTime);
+
+        m_FrameStages[static_cast<size_t>(stage)] += kTime - kWaitTime;
+        m_FrameStages[static_cast<size_t>(waitStage)] += kWaitTime;
+        m_StageBegin = kNow;
+    }
+
+    void FramePacing::EndFrame(uint64_t presentId)
+    {
+        float frameTime = 0.0f;
+        for (size_t i = 0; i < s_kStageCount; ++i)
+        {
+            m_StageTimes[i].Add(m_FrameStages[i]);
+            frameTime += m_FrameStages[i];
+        }
+        m_FrameTimes.Add(frameTime);
+
+        if (presentId == 0)
+            return;
+
+        if (m_Pending.size() >= s_kMaxPendingPresents)
+            m_Pending.pop_front();
+        m_Pending.push_back({ presentId, m_InputTime });
+    }
+
+    void FramePacing::OnPresented(uint64_t presentId,
+                                  Clock::time_point displayTime)
+    {
+        // Older ones are not displayed, e.g., replaced in a mailbox
+        while (!m_Pending.empty() && m_Pending.front().presentId < presentId)
+            m_Pending.pop_front();
+
+        if (m_Pending.empty() || m_Pending.front().presentId != presentId)
+            return;
+
+        m_Latencies.Add(ToMillis(displayTime - m_Pending.front().inputTime));
+        m_Pending.pop_front();
+    }
+
+    void FramePacing::SetWindowSize(uint32_t size)
+    {
+        for (auto& stats : m_StageTimes)
+            stats.SetWindowSize(size);
+
+        m_FrameTimes.SetWindowSize(size);
+        m_GpuFrameTimes.SetWindowSize(size);
+        m_Latencies.SetWindowSize(size);
+    }
+
+    FramePacing::Bound FramePacing::GetBound() const
+    {
+        const float kFrameTime = m_FrameTimes.GetSummary().mean;
+        if (kFrameTime <= 0.0f)
+            return Bound::Unknown;
+
+        // Of the stages the host is not waiting in
+        float cpuTime = 0.0f;
+        for (const Stage kStage : { Stage::Poll, Stage::Update, Stage::Record,
+                                    Stage::Submit })
+        {
+            cpuTime += GetStageTimes(kStage).GetSummary().mean;
+        }
+
+        const float kThreshold = s_kBoundFraction * kFrameTime;
+        if (cpuTime >= kThreshold)
+            return Bound::CPU;
+        if (m_GpuFrameTimes.GetSummary().mean >= kThreshold)
+            return Bound::GPU;
+        return Bound::Present;
+    }
+
+} // namespace vkp
@@ -0,0 +1,132 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_CORE_FRAME_PACING_H_
+#define WATER_SURFACE_RENDERING_CORE_FRAME_PACING_H_
+
+#include <array>
+#include <chrono>
+#include <deque>
+
+#include "core/RollingStats.h"
+
+
+namespace vkp
+{
+    /**
+     * @brief Rolling statistics of the CPU time of each stage of the main
+     *  loop, of the GPU time of the frames, and of the latency from sampling
+     *  the input to displaying the frame. From them, whether the frames are
+     *  bound by the CPU, the GPU, or the presentation, e.g., vsync.
+     *
+     *  Stages are consecutive, each ends where the next begins. A frame not
+     *  presented, e.g., idle, is discarded.
+     */
+    class FramePacing
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class Stage
+        {
+            Poll = 0,   ///< Events, and the swap chain recreation
+            Update,
+            FrameWait,  ///< For the previous submissions of the frame in flight
+            Acquire,    ///< Of the next image, rest of "AcquireNextImage()"
+            Record,
+            Submit,
+            Present,
+
+            Total
+        };
+
+        enum class Bound
+        {
+            Unknown = 0,
+            CPU,
+            GPU,
+            Present,    ///< Neither is busy most of the frame, e.g., vsync
+        };
+
+        // Busy for this fraction of the frame time at least, it is the bound
+        static constexpr float s_kBoundFraction{ 0.9f };
+        // Older are dropped, e.g., never displayed
+        static constexpr size_t s_kMaxPendingPresents{ 16 };
+
+        static const char* ToString(Stage stage);
+        static const char* ToString(Bound bound);
+
+        explicit FramePacing(
+            uint32_t windowSize = RollingStats::s_kDefaultWindowSize);
+
+        /** @brief Of each iteration of the main loop, before the events */
+        void BeginFrame();
+        /** @brief Input of the frame is sampled now, e.g., events polled */
+        void SampleInput() { m_InputTime = Clock::now(); }
+        /** @brief Ends the stage, begun by the end of the previous one */
+        void EndStage(Stage stage);
+        /**
+         * @brief Ends the stage, of which the host waited 'waitTime' ms for
+         *  another stage, e.g., "Acquire" for "FrameWait"
+         */
+        void EndStage(Stage stage, Stage waitStage, float waitTime);
+        /**
+         * @brief Of a presented frame, adds its stages
+         * @param presentId Of the present, if its display time is known,
+         *  otherwise 0
+         */
+        void EndFrame(uint64_t presentId);
+
+        /** @brief Of a present of "EndFrame()", its latency is added */
+        void OnPresented(uint64_t presentId, Clock::time_point displayTime);
+        /** @brief Presents not yet displayed never will be, e.g., replaced */
+        void DiscardPending() { m_Pending.clear(); }
+
+        /** @param gpuTime In milliseconds, of a frame read back */
+        void AddGpuFrameTime(float gpuTime) { m_GpuFrameTimes.Add(gpuTime); }
+
+        void SetWindowSize(uint32_t size);
+
+        // In milliseconds
+
+        const RollingStats& GetStageTimes(Stage stage) const {
+            return m_StageTimes[static_cast<size_t>(stage)];
+        }
+        /** @return Of all the stages, of the main loop */
+        const RollingStats& GetFrameTimes() const { return m_FrameTimes; }
+        const RollingStats& GetGpuFrameTimes() const { return m_GpuFrameTimes; }
+        /** @return From the input sampled, to the frame displayed */
+        const RollingStats& GetLatencies() const { return m_Latencies; }
+
+        /** @return Of the means of the busy stages, and the frame time */
+        Bound GetBound() const;
+
+    private:
+        static constexpr size_t s_kStageCount{
+            static_cast<size_t>(Stage::Total)
+        };
+
+        struct PendingPresent
+        {
+            uint64_t presentId;
+            Clock::time_point inputTime;
+        };
+
+        Clock::time_point m_StageBegin;
+        Clock::time_point m_InputTime;
+        std::array<float, s_kStageCount> m_FrameStages{};
+
+        std::array<RollingStats, s_kStageCount> m_StageTimes;
+        RollingStats m_FrameTimes;
+        RollingStats m_GpuFrameTimes;
+        RollingStats m_Latencies;
+
+        // In the order of their ids
+        std::deque<PendingPresent> m_Pending;
+    };
+
+} // namespace vkp
+
+#endif // WATER_SURFACE_RENDERING_CORE_FRAME_PACING_H_
@@ -6,18 +6,28 @@
 #include "pch.h"
 #include "core/Profile.h"
 
+#include <fstream>
+
 
 namespace vkp 
 {
     std::vector<Profile::Record> Profile::GetRecordsFromLatest()
     {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+
         std::vector<Record> records;
         records.reserve(s_Records.size());
 
         InternalRecord* head = s_LatestRecord;
         while (head != nullptr)
         {
-            records.emplace_back(head->name, head->duration, head->fileName);
+            records.emplace_back(head->name, head->duration, head->fileName,
+                                 head->gpuDuration);
+            records.back().threadDurations = head->threadDurations;
+            records.back().stats = head->durations.GetSummary();
+            records.back().gpuStats = head->gpuDurations.GetSummary();
+            records.back().frame = head->mergedFrame;
+            records.back().gpuFrame = head->gpuFrame;
             head = head->prev;
         }
 
@@ -26,13 +36,266 @@ namespace vkp
 
     void Profile::InsertRecord(const Record& r)
     {
-        InternalRecord record(r);
+        ThreadBuffer& buffer = GetThreadBuffer();
+
+        const uint32_t kHead = buffer.head.load(std::memory_order_relaxed);
+        const uint32_t kTail = buffer.tail.load(std::memory_order_acquire);
+        if (kHead - kTail >= ThreadBuffer::s_kCapacity)
+        {
+            buffer.droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.entries[kHead % ThreadBuffer::s_kCapacity] = {
+            r.name, r.fileName, r.duration, r.begin
+        };
+        buffer.head.store(kHead + 1, std::memory_order_release);
+    }
+
+    void Profile::EndFrame()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        ++s_FrameCounter;
+
+        for (auto it = s_ThreadBuffers.begin(); it != s_ThreadBuffers.end();)
+        {
+            ThreadBuffer* buffer = *it;
+
+            // Of the last records, before the retirement of the buffer
+            const bool kIsRetired =
+                buffer->isRetired.load(std::memory_order_acquire);
+            const uint32_t kHead = buffer->head.load(std::memory_order_acquire);
+            const uint32_t kTail = buffer->tail.load(std::memory_order_relaxed);
+
+            for (uint32_t i = kTail; i != kHead; ++i)
+            {
+                MergeRecord(buffer->entries[i % ThreadBuffer::s_kCapacity],
+                            buffer->threadIndex);
+            }
+            buffer->tail.store(kHead, std::memory_order_release);
+
+            const uint32_t kDropped =
+                buffer->droppedCount.exchange(0, std::memory_order_relaxed);
+            if (kDropped > 0)
+            {
+                VKP_LOG_WARN("Profile: {} records of thread {} dropped",
+                             kDropped, buffer->threadIndex);
+            }
+
+            // Its thread has exited, nothing is written to it anymore
+            if (kIsRetired)
+            {
+                s_FreeThreadIndices.insert(buffer->threadIndex);
+                delete buffer;
+                it = s_ThreadBuffers.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (s_CaptureFramesLeft == 0)
+            return;
+
+        // Spans the merges, of the calling thread
+        const uint64_t kNow = ToEpochMicros(Clock::now());
+        CaptureRecord({
+            "Frame", nullptr, s_CaptureFrameBegin,
+            (kNow - s_CaptureFrameBegin) * static_cast<float>(MICRO_TO_MILLIS),
+            s_tThreadBufferOwner.buffer != nullptr
+                ? s_tThreadBufferOwner.buffer->threadIndex
+                : 0
+        });
+        s_CaptureFrameBegin = kNow;
+
+        if (--s_CaptureFramesLeft == 0)
+            WriteCapture();
+    }
+
+    void Profile::StartCapture(
+        uint32_t frameCount,
+        const std::filesystem::path& path)
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+
+        if (frameCount == 0)
+            return;
+
+        // Never reallocated while capturing
+        s_CaptureEvents.clear();
+        s_CaptureEvents.reserve(
+            static_cast<size_t>(frameCount) * s_kCaptureEventsPerFrame
+        );
+        s_CapturePath = path;
+        s_CaptureFramesLeft = frameCount;
+        s_CaptureDroppedCount = 0;
+        s_CaptureBegin = ToEpochMicros(Clock::now());
+        s_CaptureFrameBegin = s_CaptureBegin;
+
+        VKP_LOG_INFO("Profile: capturing {} frames", frameCount);
+    }
+
+    bool Profile::IsCapturing()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_CaptureFramesLeft > 0;
+    }
+
+    void Profile::CaptureRecord(const CaptureEvent& event)
+    {
+        if (s_CaptureFramesLeft == 0 || event.begin < s_CaptureBegin)
+            return;
+
+        if (s_CaptureEvents.size() == s_CaptureEvents.capacity())
+        {
+            ++s_CaptureDroppedCount;
+            return;
+        }
+        s_CaptureEvents.push_back(event);
+    }
+
+    void Profile::WriteCapture()
+    {
+        if (s_CaptureDroppedCount > 0)
+        {
+            VKP_LOG_WARN("Profile: {} captured events dropped",
+                         s_CaptureDroppedCount);
+        }
+
+        std::ofstream file(s_CapturePath);
+        if (!file)
+        {
+            VKP_LOG_ERR("Profile: failed to write the capture: {}",
+                        s_CapturePath.string());
+            s_CaptureEvents.clear();
+            return;
+        }
+
+        // Names are string literals, only quotes and backslashes are escaped
+        auto writeString = [&file](const char* str) {
+            file << '"';
+            for (; str != nullptr && *str != '\0'; ++str)
+            {
+                if (*str == '"' || *str == '\\')
+                    file << '\\';
+                file << *str;
+            }
+            file << '"';
+        };
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+        // Names of the threads, also of the exited ones, and of the GPU
+        //  "thread"
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"tid\":" << s_kCaptureGpuThread << ",\"args\":{\"name\":"
+                "\"GPU\"}}";
+        std::set<uint32_t> threadIndices;
+        for (const CaptureEvent& event : s_CaptureEvents)
+        {
+            if (event.threadIndex != s_kCaptureGpuThread)
+                threadIndices.insert(event.threadIndex);
+        }
+        for (const uint32_t kIndex : threadIndices)
+        {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                    "\"tid\":" << kIndex << ",\"args\":{\"name\":"
+                    "\"Thread " << kIndex << "\"}}";
+        }
+
+        // Complete events, of the begin and the duration in microseconds
+        for (const CaptureEvent& event : s_CaptureEvents)
+        {
+            file << ",\n{\"name\":";
+            writeString(event.name);
+            file << ",\"cat\":"
+                 << (event.threadIndex == s_kCaptureGpuThread ? "\"gpu\""
+                                                              : "\"cpu\"")
+                 << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadIndex
+                 << ",\"ts\":" << event.begin
+                 << ",\"dur\":" << event.duration * 1000.0f;
+            if (event.fileName != nullptr)
+            {
+                file << ",\"args\":{\"file\":";
+                writeString(event.fileName);
+                file << '}';
+            }
+            file << '}';
+        }
+        file << "\n]}\n";
+
+        VKP_LOG_INFO("Profile: {} events captured into {}",
+                     s_CaptureEvents.size(), s_CapturePath.string());
+
+        s_CaptureEvents.clear();
+        s_CaptureEvents.shrink_to_fit();
+    }
+
+    uint64_t Profile::GetFrameCount()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_FrameCounter;
+    }
+
+    uint32_t Profile::GetThreadIndex()
+    {
+        return GetThreadBuffer().threadIndex;
+    }
+
+    void Profile::SetStatsWindowSize(uint32_t size)
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+
+        s_StatsWindowSize = std::max(size, 1u);
+        for (auto& [name, record] : s_Records)
+        {
+            record.durations.SetWindowSize(s_StatsWindowSize);
+            record.gpuDurations.SetWindowSize(s_StatsWindowSize);
+        }
+    }
+
+    uint32_t Profile::GetStatsWindowSize()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_StatsWindowSize;
+    }
+
+    Profile::ThreadBuffer& Profile::GetThreadBuffer()
+    {
+        // Registered once by each thread
+        ThreadBufferOwner& owner = s_tThreadBufferOwner;
+        if (owner.buffer == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(s_Mutex);
+
+            ThreadBuffer* buffer =
+                s_ThreadBuffers.emplace_back(new ThreadBuffer);
+            if (s_FreeThreadIndices.empty())
+            {
+                buffer->threadIndex = s_NextThreadIndex++;
+            }
+            else
+            {
+                buffer->threadIndex = *s_FreeThreadIndices.begin();
+                s_FreeThreadIndices.erase(s_FreeThreadIndices.begin());
+            }
+            owner.buffer = buffer;
+        }
+        return *owner.buffer;
+    }
+
+    void Profile::MergeRecord(
+        const ThreadBuffer::Entry& entry,
+        uint32_t threadIndex)
+    {
+        InternalRecord record(entry.name, entry.duration, entry.fileName);
 
         if (s_LatestRecord != nullptr && *s_LatestRecord == record)
             s_LatestRecord->duration = record.duration;
         else
         {
-            auto [pair, inserted] = s_Records.try_emplace(r.name, record);
+            auto [pair, inserted] = s_Records.try_emplace(entry.name, record);
             auto& it = pair->second;
             if (!inserted)
             {
@@ -57,6 +320,50 @@ namespace vkp
 
             s_LatestRecord = &it;
         }
+
+        // Sums of the merged frame, the previous ones are replaced
+        InternalRecord& merged = *s_LatestRecord;
+        if (merged.mergedFrame != s_FrameCounter)
+        {
+            merged.mergedFrame = s_FrameCounter;
+            merged.threadDurations.assign(merged.threadDurations.size(), 0.0f);
+        }
+        if (merged.threadDurations.size() <= threadIndex)
+            merged.threadDurations.resize(threadIndex + 1, 0.0f);
+
+        merged.threadDurations[threadIndex] += entry.duration;
+        merged.durations.Add(entry.duration);
+
+        CaptureRecord({ entry.name, entry.fileName, entry.begin,
+                        entry.duration, threadIndex });
+    }
+
+    void Profile::InsertGpuRecord(const Record& r)
+    {
+        InternalRecord record(r);
+        record.duration = -1.0f;
+
+        std::lock_guard<std::mutex> lock(s_Mutex);
+
+        CaptureRecord({ r.name, r.fileName, r.begin, r.gpuDuration,
+                        s_kCaptureGpuThread });
+
+        auto [pair, inserted] = s_Records.try_emplace(r.name, record);
+        auto& it = pair->second;
+        it.gpuDurations.Add(record.gpuDuration);
+        it.gpuFrame = s_FrameCounter;
+        if (!inserted)
+        {
+            it.gpuDuration = record.gpuDuration;
+            return;
+        }
+
+        it.prev = s_LatestRecord;
+        it.next = nullptr;
+        if (s_LatestRecord != nullptr)
+            s_LatestRecord->next = &it;
+
+        s_LatestRecord = &it;
     }
 
 } // namespace vkp 
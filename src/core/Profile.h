@@ -2,8 +2,17 @@
 #ifndef WATER_SURFACE_RENDERING_CORE_PROFILE_H_
 #define WATER_SURFACE_RENDERING_CORE_PROFILE_H_
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <unordered_map>
+#include <vector>
+
+#include "core/RollingStats.h"
 
 #define MICRO_TO_MILLIS 0.001
 
@@ -63,6 +72,15 @@ namespace vkp
      *      using the "GetRecordsFromLatest" function, that implements a "walk"
      *      through the internal doubly-linked list in the data structure 
      *      in O(n) time.
+     *  f) Records are inserted from any thread, e.g., of the OpenMP parallel
+     *      regions, without locking: into a ring buffer of the thread, merged
+     *      into the data structure once per frame by "EndFrame()". Durations
+     *      of each thread are summed over the merged frame, of the load
+     *      balance between the threads.
+     *  g) A capture records the begin and the duration of each merged record,
+     *      and of the GPU ones, of the next N frames into a pre-allocated
+     *      buffer, written to a Chrome trace-event JSON file once done, e.g.,
+     *      opened by chrome://tracing or ui.perfetto.dev.
      */
     class Profile
     {
@@ -73,12 +91,26 @@ namespace vkp
             const char* name;
             float duration;
             const char* fileName;
+            // Of the GPU scope of the same name, negative if none
+            float gpuDuration;
+            // Summed over the last merged frame, indexed by the thread index
+            std::vector<float> threadDurations;
+            // Of the durations within the window, of no count if none
+            RollingStats::Summary stats;
+            RollingStats::Summary gpuStats;
+            // In microseconds since "GetEpoch()", of the captured events
+            uint64_t begin{ 0 };
+            // Of "GetFrameCount()" when its CPU, or GPU, duration was merged
+            uint64_t frame{ 0 };
+            uint64_t gpuFrame{ 0 };
 
             Record(const char* str, const char* filename)
                 : Record(str, 0.0f, filename) {}
             
-            Record(const char* str, float val, const char* filename)
-                : name(str), duration(val), fileName(filename) {}
+            Record(const char* str, float val, const char* filename,
+                   float gpuVal = -1.0f)
+                : name(str), duration(val), fileName(filename),
+                  gpuDuration(gpuVal) {}
 
             bool operator==(const Record& o) const
             {
@@ -92,10 +124,56 @@ namespace vkp
         static std::vector<Record> GetRecordsFromLatest();
 
         /**
-         * @brief Inserts a record into the global profile data structure
+         * @brief Inserts a record into the ring buffer of the calling thread,
+         *  lock-free, merged into the global profile data structure by
+         *  the next "EndFrame()". Dropped if the buffer is full
          */
         static void InsertRecord(const Record& r);
 
+        /**
+         * @brief Merges the records of all the threads, from the main thread
+         *  once per frame
+         */
+        static void EndFrame();
+
+        /** @return Of the "EndFrame()" calls so far */
+        static uint64_t GetFrameCount();
+
+        /**
+         * @return Of the calling thread, in the order of the first insertion,
+         *  those of the exited threads are taken again
+         */
+        static uint32_t GetThreadIndex();
+
+        /** @brief Of the rolling statistics of each record, in insertions */
+        static void SetStatsWindowSize(uint32_t size);
+        static uint32_t GetStatsWindowSize();
+
+        /**
+         * @brief Sets the GPU duration of the record of the name, read back
+         *  frames later, without bumping it to the front. Inserted of no CPU
+         *  duration if not yet present
+         */
+        static void InsertGpuRecord(const Record& r);
+
+        /**
+         * @brief Records the events of the next 'frameCount' frames, written
+         *  as a Chrome trace once the last one is merged. Any running capture
+         *  is discarded
+         */
+        static void StartCapture(uint32_t frameCount,
+                                 const std::filesystem::path& path);
+        static bool IsCapturing();
+
+        using Clock = std::chrono::high_resolution_clock;
+        static Clock::time_point GetEpoch() { return s_kEpoch; }
+        /** @return In microseconds since "GetEpoch()" */
+        static uint64_t ToEpochMicros(Clock::time_point t)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                t - s_kEpoch).count();
+        }
+
         class Timer 
         {
         public:
@@ -121,6 +199,7 @@ namespace vkp
             {
                 m_Stopped = true;
                 m_Record.duration = ElapsedMillis();
+                m_Record.begin = Profile::ToEpochMicros(m_Start);
                 Profile::InsertRecord(m_Record);
             }
 
@@ -139,11 +218,64 @@ namespace vkp
         };
 
     private:
+        static inline uint32_t s_StatsWindowSize{
+            RollingStats::s_kDefaultWindowSize
+        };
+
+        // Single producer, its thread, single consumer, "EndFrame()"
+        struct ThreadBuffer
+        {
+            static constexpr uint32_t s_kCapacity{ 1024 };
+
+            struct Entry
+            {
+                const char* name;
+                const char* fileName;
+                float duration;
+                uint64_t begin;
+            };
+
+            std::array<Entry, s_kCapacity> entries;
+            std::atomic<uint32_t> head{ 0 };   ///< Written by the thread
+            std::atomic<uint32_t> tail{ 0 };   ///< Written by the merge
+            std::atomic<uint32_t> droppedCount{ 0 };
+            // Set once its thread exits, after its last record
+            std::atomic<bool> isRetired{ false };
+            uint32_t threadIndex{ 0 };
+        };
+
+        // Of each thread, retires its buffer when the thread exits
+        struct ThreadBufferOwner
+        {
+            ThreadBuffer* buffer;
+
+            ThreadBufferOwner() : buffer(nullptr) {}
+            ~ThreadBufferOwner()
+            {
+                if (buffer != nullptr)
+                    buffer->isRetired.store(true, std::memory_order_release);
+            }
+        };
+
+        static ThreadBuffer& GetThreadBuffer();
+
+        /** @pre Locked s_Mutex */
+        static void MergeRecord(const ThreadBuffer::Entry& entry,
+                                uint32_t threadIndex);
+
         struct InternalRecord
         {
             const char* name;
             float duration;
             const char* fileName;
+            float gpuDuration{ -1.0f };
+            std::vector<float> threadDurations;
+            // Of "EndFrame()", the thread durations are of
+            uint64_t mergedFrame{ 0 };
+            // Of "InsertGpuRecord()"
+            uint64_t gpuFrame{ 0 };
+            RollingStats durations{ s_StatsWindowSize };
+            RollingStats gpuDurations{ s_StatsWindowSize };
 
             InternalRecord* prev;
             InternalRecord* next;
@@ -151,7 +283,10 @@ namespace vkp
             InternalRecord() : InternalRecord("Undef", 0.0f, nullptr) {}
 
             InternalRecord(const Record& record)
-                : InternalRecord(record.name, record.duration, record.fileName) {}
+                : InternalRecord(record.name, record.duration, record.fileName)
+            {
+                gpuDuration = record.gpuDuration;
+            }
 
             InternalRecord(const char* desc, float val, const char* filename)
                 : name(desc), duration(val), fileName(filename),
@@ -166,6 +301,50 @@ namespace vkp
 
         static inline std::unordered_map<const char*, InternalRecord> s_Records;
         static inline InternalRecord* s_LatestRecord{ nullptr };
+        // Of the records, and the registration of the thread buffers
+        static inline std::mutex s_Mutex;
+
+        // Freed by "EndFrame()" once retired and drained, the rest are left
+        //  at exit, worker threads may outlive anything else
+        static inline std::vector<ThreadBuffer*> s_ThreadBuffers;
+        static inline thread_local ThreadBufferOwner s_tThreadBufferOwner;
+        // Of the freed buffers, taken by the threads registered next, the
+        //  durations per thread stay of the count of the live threads
+        static inline std::set<uint32_t> s_FreeThreadIndices;
+        static inline uint32_t s_NextThreadIndex{ 0 };
+        static inline uint64_t s_FrameCounter{ 0 };
+
+        // ---------------------------------------------------------------------
+        // Capture
+
+        // Reserved for each captured frame, the rest is dropped
+        static constexpr uint32_t s_kCaptureEventsPerFrame{ 512 };
+        // Thread index of the GPU events
+        static constexpr uint32_t s_kCaptureGpuThread{ ~0u };
+
+        struct CaptureEvent
+        {
+            const char* name;
+            const char* fileName;
+            uint64_t begin;         ///< In microseconds since the epoch
+            float duration;         ///< In milliseconds
+            uint32_t threadIndex;
+        };
+
+        /** @pre Locked s_Mutex */
+        static void CaptureRecord(const CaptureEvent& event);
+        /** @pre Locked s_Mutex, the capture is done */
+        static void WriteCapture();
+
+        static inline const Clock::time_point s_kEpoch{ Clock::now() };
+
+        static inline std::vector<CaptureEvent> s_CaptureEvents;
+        static inline std::filesystem::path s_CapturePath;
+        static inline uint32_t s_CaptureFramesLeft{ 0 };
+        static inline uint32_t s_CaptureDroppedCount{ 0 };
+        // Earlier records merged after the start are not captured
+        static inline uint64_t s_CaptureBegin{ 0 };
+        static inline uint64_t s_CaptureFrameBegin{ 0 };
     };
 
     /**
@@ -0,0 +1,153 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_CORE_ROLLING_STATS_H_
+#define WATER_SURFACE_RENDERING_CORE_ROLLING_STATS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+
+namespace vkp
+{
+    /**
+     * @brief Statistics of the last values within a window, e.g., of
+     *  the durations of a profiled scope, or the frame times: their min,
+     *  mean, percentiles, max, and a histogram
+     */
+    class RollingStats
+    {
+    public:
+        static constexpr uint32_t s_kDefaultWindowSize{ 256 };
+
+        struct Summary
+        {
+            float min{ 0.0f };
+            float mean{ 0.0f };
+            float p50{ 0.0f };
+            float p95{ 0.0f };
+            float p99{ 0.0f };
+            float max{ 0.0f };
+            uint32_t count{ 0 };
+        };
+
+        explicit RollingStats(uint32_t windowSize = s_kDefaultWindowSize)
+            : m_WindowSize(std::max(windowSize, 1u))
+        {
+            m_Values.reserve(m_WindowSize);
+        }
+
+        /** @brief Keeps the latest values that fit */
+        void SetWindowSize(uint32_t size)
+        {
+            size = std::max(size, 1u);
+            if (size == m_WindowSize)
+                return;
+
+            std::vector<float> values = GetValues();
+            if (values.size() > size)
+                values.erase(values.begin(), values.end() - size);
+
+            m_WindowSize = size;
+            m_Values = std::move(values);
+            m_Values.reserve(m_WindowSize);
+            m_Next = static_cast<uint32_t>(m_Values.size()) % m_WindowSize;
+        }
+        uint32_t GetWindowSize() const { return m_WindowSize; }
+
+        void Add(float value)
+        {
+            if (m_Values.size() < m_WindowSize)
+                m_Values.push_back(value);
+            else
+                m_Values[m_Next] = value;
+
+            m_Next = (m_Next + 1) % m_WindowSize;
+        }
+
+        void Clear()
+        {
+            m_Values.clear();
+            m_Next = 0;
+        }
+
+        /** @return Of the nearest ranks, zeros if empty */
+        Summary GetSummary() const
+        {
+            Summary summary;
+            if (m_Values.empty())
+                return summary;
+
+            std::vector<float> sorted(m_Values);
+            std::sort(sorted.begin(), sorted.end());
+
+            const size_t kCount = sorted.size();
+            auto percentile = [&](float p) {
+                const size_t kRank = static_cast<size_t>(
+                    std::ceil(p * static_cast<float>(kCount))
+                );
+                return sorted[std::clamp<size_t>(kRank, 1, kCount) - 1];
+            };
+
+            double sum = 0.0;
+            for (float value : sorted)
+                sum += value;
+
+            summary.min = sorted.front();
+            summary.mean = static_cast<float>(sum / kCount);
+            summary.p50 = percentile(0.50f);
+            summary.p95 = percentile(0.95f);
+            summary.p99 = percentile(0.99f);
+            summary.max = sorted.back();
+            summary.count = static_cast<uint32_t>(kCount);
+
+            return summary;
+        }
+
+        /**
+         * @return Counts of the values in equal bins of [0, maxValue], those
+         *  above are in the last bin
+         */
+        std::vector<float> GetHistogram(uint32_t binCount, float maxValue) const
+        {
+            std::vector<float> bins(std::max(binCount, 1u), 0.0f);
+            if (maxValue <= 0.0f)
+                return bins;
+
+            const float kScale = static_cast<float>(bins.size()) / maxValue;
+            for (float value : m_Values)
+            {
+                const auto kBin = static_cast<size_t>(
+                    std::max(value, 0.0f) * kScale
+                );
+                bins[std::min(kBin, bins.size() - 1)] += 1.0f;
+            }
+            return bins;
+        }
+
+        /** @return From the oldest */
+        std::vector<float> GetValues() const
+        {
+            if (m_Values.size() < m_WindowSize)
+                return m_Values;
+
+            std::vector<float> values(m_Values.begin() + m_Next, m_Values.end());
+            values.insert(values.end(), m_Values.begin(),
+                          m_Values.begin() + m_Next);
+            return values;
+        }
+
+    private:
+        uint32_t m_WindowSize;
+        std::vector<float> m_Values;
+        // Of the oldest value, once the window is full
+        uint32_t m_Next{ 0 };
+    };
+
+} // namespace vkp
+
+#endif // WATER_SURFACE_RENDERING_CORE_ROLLING_STATS_H_
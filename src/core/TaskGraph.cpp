@@ -0,0 +1,137 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "core/TaskGraph.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "core/Profile.h"
+
+
+namespace vkp
+{
+    TaskGraph::TaskId TaskGraph::Add(const char* name,
+                                     std::function<void()> task,
+                                     std::initializer_list<TaskId> dependencies,
+                                     Thread thread)
+    {
+        // Of the tasks added before only, the graph is acyclic
+        const TaskId kId = static_cast<TaskId>(m_Tasks.size());
+        VKP_ASSERT(std::all_of(dependencies.begin(), dependencies.end(),
+                               [kId](TaskId dependency) {
+                                   return dependency < kId;
+                               }));
+
+        m_Tasks.push_back(Task{
+            .name = name,
+            .function = std::move(task),
+            .dependencies = dependencies,
+            .thread = thread
+        });
+        return kId;
+    }
+
+    void TaskGraph::Run()
+    {
+        VKP_REGISTER_FUNCTION();
+        VKP_PROFILE_SCOPE();
+
+        const size_t kTaskCount = m_Tasks.size();
+
+        // Of each task, its dependencies not yet done, and the tasks of it
+        std::vector<uint32_t> pendingCounts(kTaskCount);
+        std::vector<std::vector<TaskId>> dependents(kTaskCount);
+        for (TaskId id = 0; id < kTaskCount; ++id)
+        {
+            pendingCounts[id] =
+                static_cast<uint32_t>(m_Tasks[id].dependencies.size());
+            for (const TaskId kDependency : m_Tasks[id].dependencies)
+                dependents[kDependency].push_back(id);
+        }
+
+        std::mutex mutex;
+        std::condition_variable doneCondition;
+        std::vector<TaskId> doneWorkerTasks;    ///< Of the mutex
+
+        std::deque<TaskId> readyMainTasks;
+        std::vector<std::thread> workers;
+        size_t doneCount = 0;
+
+        auto start = [&](TaskId id) {
+            if (m_Tasks[id].thread == Thread::Main)
+            {
+                readyMainTasks.push_back(id);
+                return;
+            }
+
+            workers.emplace_back([&, id]() {
+                Execute(m_Tasks[id]);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    doneWorkerTasks.push_back(id);
+                }
+                doneCondition.notify_one();
+            });
+        };
+        // Dependents are started by the main thread only
+        auto finish = [&](TaskId id) {
+            ++doneCount;
+            for (const TaskId kDependent : dependents[id])
+            {
+                if (--pendingCounts[kDependent] == 0)
+                    start(kDependent);
+            }
+        };
+
+        for (TaskId id = 0; id < kTaskCount; ++id)
+        {
+            if (pendingCounts[id] == 0)
+                start(id);
+        }
+
+        while (doneCount < kTaskCount)
+        {
+            if (!readyMainTasks.empty())
+            {
+                const TaskId kId = readyMainTasks.front();
+                readyMainTasks.pop_front();
+
+                Execute(m_Tasks[kId]);
+                finish(kId);
+                continue;
+            }
+
+            std::vector<TaskId> doneTasks;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                doneCondition.wait(lock, [&doneWorkerTasks]() {
+                    return !doneWorkerTasks.empty();
+                });
+                doneTasks.swap(doneWorkerTasks);
+            }
+            for (const TaskId kId : doneTasks)
+                finish(kId);
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        m_Tasks.clear();
+    }
+
+    void TaskGraph::Execute(const Task& kTask)
+    {
+        VKP_PROFILE_SCOPE(kTask.name);
+        VKP_LOG_INFO("Task: {}", kTask.name);
+
+        kTask.function();
+    }
+
+} // namespace vkp
@@ -0,0 +1,67 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_CORE_TASK_GRAPH_H_
+#define WATER_SURFACE_RENDERING_CORE_TASK_GRAPH_H_
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+
+namespace vkp
+{
+    /**
+     * @brief Tasks of dependencies on each other, each run once all of its
+     *  dependencies are done. Those of the main thread are run in order of
+     *  their readiness by the caller of "Run()", the others concurrently,
+     *  each on a thread of its own.
+     *
+     * E.g., of the startup: the shaders are compiled and the FFT planned on
+     *  the workers, while the main thread records the uploads into the
+     *  one-time command buffers, and sets up the GUI.
+     */
+    class TaskGraph
+    {
+    public:
+        using TaskId = uint32_t;
+
+        enum class Thread
+        {
+            Worker = 0,
+            Main        ///< Of the caller of "Run()"
+        };
+
+        /**
+         * @param name Of the profiled scope of the task, a string literal
+         * @param dependencies Added before, done before the task starts
+         * @return Of the dependencies of the tasks added later
+         */
+        TaskId Add(const char* name,
+                   std::function<void()> task,
+                   std::initializer_list<TaskId> dependencies = {},
+                   Thread thread = Thread::Worker);
+
+        /** @brief Runs all the tasks, returns once all are done */
+        void Run();
+
+    private:
+        struct Task
+        {
+            const char* name;
+            std::function<void()> function;
+            std::vector<TaskId> dependencies;
+            Thread thread;
+        };
+
+        static void Execute(const Task& kTask);
+
+    private:
+        std::vector<Task> m_Tasks;
+    };
+}
+
+#endif // WATER_SURFACE_RENDERING_CORE_TASK_GRAPH_H_
@@ -0,0 +1,221 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "core/Threads.h"
+
+#include <fstream>
+
+#include <omp.h>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+
+namespace vkp
+{
+    ThreadPlacement::Settings ThreadPlacement::s_Settings;
+
+    void ThreadPlacement::SetSettings(const Settings& settings)
+    {
+        Init();
+        {
+            std::lock_guard<std::mutex> lock(s_Mutex);
+            s_Settings = settings;
+        }
+        s_Generation.fetch_add(1, std::memory_order_release);
+
+        VKP_LOG_INFO("Thread placement: {} simulation threads, {} reserved "
+                     "CPUs of {}, pinned: {}, first touch: {}",
+                     GetThreadCount(), settings.reservedCpus, GetCpuCount(),
+                     settings.pin, IsFirstTouch());
+    }
+
+    ThreadPlacement::Settings ThreadPlacement::GetSettings()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_Settings;
+    }
+
+    uint32_t ThreadPlacement::GetCpuCount()
+    {
+        Init();
+
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return static_cast<uint32_t>(s_Cpus.size());
+    }
+
+    uint32_t ThreadPlacement::GetNumaNodeCount()
+    {
+        // e.g. "0-1", or "0,2-3"
+        std::ifstream file("/sys/devices/system/node/online");
+        std::string ranges;
+        if (!std::getline(file, ranges))
+            return 1;
+
+        uint32_t count = 0;
+        size_t begin = 0;
+        while (begin < ranges.size())
+        {
+            size_t end = ranges.find(',', begin);
+            if (end == std::string::npos)
+                end = ranges.size();
+
+            const std::string kRange = ranges.substr(begin, end - begin);
+            const size_t kDash = kRange.find('-');
+            if (kDash == std::string::npos)
+                ++count;
+            else
+            {
+                count += std::atoi(kRange.c_str() + kDash + 1) -
+                         std::atoi(kRange.c_str()) + 1;
+            }
+            begin = end + 1;
+        }
+        return std::max(count, 1u);
+    }
+
+    uint32_t ThreadPlacement::GetThreadCount()
+    {
+        Init();
+
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        if (s_Settings.threadCount > 0)
+            return s_Settings.threadCount;
+
+        return static_cast<uint32_t>(GetSimulationCpus(s_Settings).size());
+    }
+
+    bool ThreadPlacement::IsFirstTouch()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_Settings.pin && s_Settings.firstTouch;
+    }
+
+    void ThreadPlacement::PlaceMainThread()
+    {
+        Init();
+
+        const Settings kSettings = GetSettings();
+        s_tPlacedGeneration = s_Generation.load(std::memory_order_acquire);
+
+        omp_set_num_threads(static_cast<int>(GetThreadCount()));
+
+        std::vector<uint32_t> cpus;
+        {
+            std::lock_guard<std::mutex> lock(s_Mutex);
+            cpus = s_Cpus;
+        }
+        // Of no reserved CPU, or of all of them, it is not pinned
+        if (kSettings.pin && kSettings.reservedCpus > 0 &&
+            kSettings.reservedCpus < cpus.size())
+        {
+            cpus.resize(kSettings.reservedCpus);
+        }
+
+        if (!SetAffinity(cpus) && kSettings.pin)
+            VKP_LOG_WARN("Thread placement: threads are not pinned");
+    }
+
+    void ThreadPlacement::PlaceSimulationThread()
+    {
+        const uint32_t kGeneration =
+            s_Generation.load(std::memory_order_acquire);
+        if (s_tPlacedGeneration == kGeneration)
+            return;
+        s_tPlacedGeneration = kGeneration;
+
+        Init();
+
+        const Settings kSettings = GetSettings();
+        omp_set_num_threads(static_cast<int>(GetThreadCount()));
+
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        if (kSettings.pin)
+            SetAffinity({ GetSimulationCpus(kSettings).front() });
+        else
+            SetAffinity(s_Cpus);
+    }
+
+    void ThreadPlacement::PlaceTeamThread(uint32_t index)
+    {
+        if (index == 0)
+            return;
+
+        // Of another index in another team, e.g., of a team of another size,
+        //  the thread of the pool is placed again
+        const uint32_t kGeneration =
+            s_Generation.load(std::memory_order_acquire);
+        if (s_tPlacedGeneration == kGeneration && s_tPlacedIndex == index)
+            return;
+        s_tPlacedGeneration = kGeneration;
+        s_tPlacedIndex = index;
+
+        Init();
+
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        if (s_Settings.pin)
+        {
+            const std::vector<uint32_t> kCpus = GetSimulationCpus(s_Settings);
+            SetAffinity({ kCpus[index % kCpus.size()] });
+        }
+        else
+            SetAffinity(s_Cpus);
+    }
+
+    void ThreadPlacement::Init()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        if (!s_Cpus.empty())
+            return;
+
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (uint32_t i = 0; i < CPU_SETSIZE; ++i)
+            {
+                if (CPU_ISSET(i, &set))
+                    s_Cpus.push_back(i);
+            }
+        }
+#endif
+        if (s_Cpus.empty())
+        {
+            const uint32_t kCount =
+                static_cast<uint32_t>(std::max(omp_get_num_procs(), 1));
+            for (uint32_t i = 0; i < kCount; ++i)
+                s_Cpus.push_back(i);
+        }
+    }
+
+    std::vector<uint32_t> ThreadPlacement::GetSimulationCpus(
+        const Settings& settings)
+    {
+        if (settings.reservedCpus >= s_Cpus.size())
+            return s_Cpus;
+
+        return std::vector<uint32_t>(s_Cpus.begin() + settings.reservedCpus,
+                                     s_Cpus.end());
+    }
+
+    bool ThreadPlacement::SetAffinity(const std::vector<uint32_t>& cpus)
+    {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (uint32_t cpu : cpus)
+            CPU_SET(cpu, &set);
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpus;
+        return false;
+#endif
+    }
+}
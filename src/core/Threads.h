@@ -0,0 +1,109 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_CORE_THREADS_H_
+#define WATER_SURFACE_RENDERING_CORE_THREADS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+namespace vkp
+{
+    /**
+     * @brief Singleton of the placement of the threads on the CPUs of the
+     *  process, of the main loop and of the simulation:
+     *  a) The first "reservedCpus" CPUs are of the main loop thread, the
+     *      others of the simulation, all of them if none is left.
+     *  b) Parallel regions of a placed thread are of "GetThreadCount()"
+     *      threads, the OpenMP ICV of the thread is set, also used by FFTW
+     *      for the threads of its plans.
+     *  c) Pinned, each thread of the simulation is bound to a CPU of its
+     *      own, by its index in the team, the worker of the simulation to
+     *      the first one. OpenMP keeps the threads of its pool between the
+     *      regions, each is placed once within a region, and again only if
+     *      the settings changed since.
+     *  d) First touched, buffers of the simulation are written first by the
+     *      pinned threads of their rows, their pages allocated on the NUMA
+     *      nodes of those threads.
+     *
+     *  Affinity is set on Linux only, elsewhere the threads are counted but
+     *  not pinned.
+     */
+    class ThreadPlacement
+    {
+    public:
+        struct Settings
+        {
+            // 0: a thread of each CPU not reserved
+            uint32_t threadCount{ 0 };
+            uint32_t reservedCpus{ 1 }; ///< Of the main loop thread
+            bool pin{ false };
+            bool firstTouch{ false };   ///< Of the pinned threads only
+        };
+
+        /** @brief Taking effect on the next placement of each thread */
+        static void SetSettings(const Settings& settings);
+        static Settings GetSettings();
+
+        /** @return CPUs of the process at its first placement */
+        static uint32_t GetCpuCount();
+        /** @return 1 if unknown */
+        static uint32_t GetNumaNodeCount();
+        /** @return Of the parallel regions of the simulation, at least 1 */
+        static uint32_t GetThreadCount();
+
+        /** @return Whether its buffers are first written by pinned threads */
+        static bool IsFirstTouch();
+
+        /**
+         * @brief Of the main loop thread, pinned to the reserved CPUs, or to
+         *  all of them if not pinned. Its parallel regions, e.g., of the
+         *  simulation computed on it, are of "GetThreadCount()" threads
+         */
+        static void PlaceMainThread();
+
+        /**
+         * @brief Of a thread running the simulation, e.g., the worker of
+         *  "WSSimulation", pinned to the first CPU of the simulation. Only
+         *  the first call after a change of the settings places it
+         */
+        static void PlaceSimulationThread();
+
+        /**
+         * @brief Of each thread of a parallel region of the simulation, by
+         *  its index in the team. The first is the thread of the region,
+         *  placed by its owner. Placed again if its index changed, of the
+         *  threads of the pool not bound to an index
+         */
+        static void PlaceTeamThread(uint32_t index);
+
+    private:
+        static void Init();
+
+        /** @return CPUs of the simulation, of the settings */
+        static std::vector<uint32_t> GetSimulationCpus(
+            const Settings& settings);
+
+        /** @return False if the affinity is not set, e.g., unsupported */
+        static bool SetAffinity(const std::vector<uint32_t>& cpus);
+
+    private:
+        static inline std::mutex s_Mutex;
+        static Settings s_Settings;
+        // Of the process at its first placement, in the order of their ids
+        static inline std::vector<uint32_t> s_Cpus;
+
+        // Changed by each "SetSettings()", of the placed threads
+        static inline std::atomic<uint32_t> s_Generation{ 1 };
+        static inline thread_local uint32_t s_tPlacedGeneration{ 0 };
+        // Of "PlaceTeamThread()", of the CPU the thread is pinned to
+        static inline thread_local uint32_t s_tPlacedIndex{ 0 };
+    };
+}
+
+#endif // WATER_SURFACE_RENDERING_CORE_THREADS_H_
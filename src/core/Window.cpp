@@ -15,12 +15,12 @@ namespace vkp
         fprintf(stderr, "Glfw Error %d: %s\n", error, description);
     }
 
-    Window::Window(const char* title, int width, int height)
+    Window::Window(const char* title, int width, int height, bool visible)
     {
         VKP_REGISTER_FUNCTION();
 
         InitGLFW();
-        CreateWindow(title, width, height);
+        CreateWindow(title, width, height, visible);
     }
 
     Window::~Window()
@@ -44,8 +44,11 @@ namespace vkp
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     }
 
-    void Window::CreateWindow(const char* title, int width, int height)
+    void Window::CreateWindow(const char* title, int width, int height,
+                              bool visible)
     {
+        glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+
         // Create the GLFWwindow
         //  windowed mode, do not share resources
         m_Window = glfwCreateWindow(width, height, title, nullptr, nullptr);
@@ -22,10 +22,13 @@ namespace vkp
         /**
          * @brief Initializes GLFW, creates window, and checks whether Vulkan
          *  is supported.
+         * @param visible If not, the window is never shown, e.g., of
+         *  offscreen rendering
          */
         Window(const char* title, 
                int width = VKP_DEFAULT_WINDOW_WIDTH, 
-               int height = VKP_DEFAULT_WINDOW_HEIGHT);
+               int height = VKP_DEFAULT_WINDOW_HEIGHT,
+               bool visible = true);
         ~Window();
 
         operator GLFWwindow*() const { return m_Window; }
@@ -70,7 +73,8 @@ namespace vkp
 
     private:
         void InitGLFW();
-        void CreateWindow(const char* title, int width, int height);
+        void CreateWindow(const char* title, int width, int height,
+                          bool visible);
 
     private:
         GLFWwindow* m_Window;
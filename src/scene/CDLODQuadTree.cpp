@@ -0,0 +1,124 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/CDLODQuadTree.h"
+
+
+void CDLODQuadTree::Setup(float size, uint32_t levelCount, float rangeFactor)
+{
+    VKP_ASSERT(size > 0.0f);
+    VKP_ASSERT(levelCount > 0 && levelCount <= s_kMaxLevelCount);
+
+    m_Size = size;
+    m_LevelCount = levelCount;
+
+    const float kFinestNodeSize =
+        size / static_cast<float>(1u << (levelCount - 1));
+    m_FinestRange = std::max(rangeFactor, s_kMinRangeFactor) * kFinestNodeSize;
+}
+
+uint32_t CDLODQuadTree::Select(
+    const glm::vec3& camPos,
+    const Frustum& frustum,
+    float minHeight,
+    float maxHeight,
+    float margin,
+    uint32_t maxPatchCount,
+    std::vector<glm::vec4>& patches) const
+{
+    patches.clear();
+
+    Selection selection{
+        .camPos = camPos,
+        .frustum = frustum,
+        .minHeight = minHeight,
+        .maxHeight = maxHeight,
+        .margin = margin,
+        .maxPatchCount = maxPatchCount,
+        .patches = patches
+    };
+
+    const glm::vec2 kRootMin( -0.5f * m_Size );
+    const uint32_t kRootLevel = m_LevelCount - 1;
+
+    // Beyond all the ranges, still drawn at the coarsest level
+    if (!SelectNode(selection, kRootMin, m_Size, kRootLevel))
+        AddPatch(selection, kRootMin, m_Size, kRootLevel);
+
+    return static_cast<uint32_t>(patches.size());
+}
+
+bool CDLODQuadTree::SelectNode(
+    Selection& selection,
+    const glm::vec2& nodeMin,
+    float nodeSize,
+    uint32_t level) const
+{
+    const glm::vec3 kBoxMin(nodeMin.x - selection.margin,
+                            selection.minHeight,
+                            nodeMin.y - selection.margin);
+    const glm::vec3 kBoxMax(nodeMin.x + nodeSize + selection.margin,
+                            selection.maxHeight,
+                            nodeMin.y + nodeSize + selection.margin);
+
+    if (!SphereIntersectsBox(selection.camPos, GetRange(level),
+                             kBoxMin, kBoxMax))
+        return false;
+
+    if (!selection.frustum.IntersectsBox(kBoxMin, kBoxMax))
+        return true;
+
+    if (level == 0 ||
+        !SphereIntersectsBox(selection.camPos, GetRange(level - 1),
+                             kBoxMin, kBoxMax))
+    {
+        AddPatch(selection, nodeMin, nodeSize, level);
+        return true;
+    }
+
+    const float kChildSize = 0.5f * nodeSize;
+    const glm::vec2 kChildOffsets[4] = {
+        { 0.0f, 0.0f }, { kChildSize, 0.0f },
+        { 0.0f, kChildSize }, { kChildSize, kChildSize }
+    };
+
+    for (const glm::vec2& kOffset : kChildOffsets)
+    {
+        const glm::vec2 kChildMin = nodeMin + kOffset;
+
+        // Out of the finer range, the child's patch morphs entirely into
+        //  this level's grid
+        if (!SelectNode(selection, kChildMin, kChildSize, level - 1))
+            AddPatch(selection, kChildMin, kChildSize, level - 1);
+    }
+
+    return true;
+}
+
+void CDLODQuadTree::AddPatch(
+    Selection& selection,
+    const glm::vec2& nodeMin,
+    float nodeSize,
+    uint32_t level) const
+{
+    if (selection.patches.size() >= selection.maxPatchCount)
+        return;
+
+    selection.patches.emplace_back(nodeMin.x, nodeMin.y, nodeSize,
+                                   static_cast<float>(level));
+}
+
+bool CDLODQuadTree::SphereIntersectsBox(
+    const glm::vec3& center,
+    float radius,
+    const glm::vec3& boxMin,
+    const glm::vec3& boxMax)
+{
+    const glm::vec3 kClosest = glm::clamp(center, boxMin, boxMax);
+    const glm::vec3 kDiff = center - kClosest;
+
+    return glm::dot(kDiff, kDiff) <= radius * radius;
+}
@@ -0,0 +1,115 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_CDLOD_QUAD_TREE_H_
+#define WATER_SURFACE_RENDERING_SCENE_CDLOD_QUAD_TREE_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "scene/Frustum.h"
+
+
+/**
+ * @brief Continuous distance-dependent level of detail [Strugar 2009] of
+ *  a square centered at the origin, on the XZ plane.
+ *
+ * The square is a quadtree of nodes, each drawn as the same patch of quads,
+ *  the nodes of level 0 are the smallest. A node of level 'L' is selected if
+ *  it is within the range of its level, 'finestRange * 2^L', it is subdivided
+ *  if it is also within the range of level 'L-1'. Ranges are spheres around
+ *  the camera, nodes are tested by their bounding boxes.
+ *
+ * Vertices of a patch morph into the grid of the parent level towards the end
+ *  of the range, from s_kMorphStart of it, so that they match the neighbouring
+ *  patches of the coarser level, without cracks.
+ *
+ * Selected patches: vec4(x and z of the min corner, side length, level)
+ */
+class CDLODQuadTree
+{
+public:
+    static constexpr uint32_t s_kMaxLevelCount{ 16 };
+
+    // Of the range of a level, where the vertices start to morph
+    static constexpr float s_kMorphStart{ 0.75f };
+    // Of the node size, the range ensures that the neighbouring patches
+    //  of a coarser level are not morphing
+    static constexpr float s_kMinRangeFactor{ 6.0f };
+
+public:
+    /**
+     * @param size Side length of the root node
+     * @param levelCount Number of levels, the root's is 'levelCount - 1'
+     * @param rangeFactor Range of level 0 as a multiple of its node size,
+     *  at least s_kMinRangeFactor
+     */
+    void Setup(float size, uint32_t levelCount, float rangeFactor);
+
+    /**
+     * @brief Selects the patches within the frustum, for the camera position
+     * @param minHeight,maxHeight Vertical extent of the nodes' boxes
+     * @param margin Horizontal extent of the boxes, beyond the nodes, by
+     *  the horizontal displacement
+     * @param maxPatchCount Further patches are dropped
+     * @return Number of the selected patches
+     */
+    uint32_t Select(const glm::vec3& camPos,
+                    const Frustum& frustum,
+                    float minHeight,
+                    float maxHeight,
+                    float margin,
+                    uint32_t maxPatchCount,
+                    std::vector<glm::vec4>& patches) const;
+
+    float GetSize() const { return m_Size; }
+    uint32_t GetLevelCount() const { return m_LevelCount; }
+    /** @return Range of level 0, the others double it */
+    float GetFinestRange() const { return m_FinestRange; }
+
+private:
+    struct Selection
+    {
+        const glm::vec3& camPos;
+        const Frustum& frustum;
+        float minHeight;
+        float maxHeight;
+        float margin;
+        uint32_t maxPatchCount;
+        std::vector<glm::vec4>& patches;
+    };
+
+    /**
+     * @return False if the node is out of its level's range, then it is
+     *  selected at the parent's level instead, true if covered by
+     *  the selected patches, or culled
+     */
+    bool SelectNode(Selection& selection,
+                    const glm::vec2& nodeMin,
+                    float nodeSize,
+                    uint32_t level) const;
+
+    void AddPatch(Selection& selection,
+                  const glm::vec2& nodeMin,
+                  float nodeSize,
+                  uint32_t level) const;
+
+    float GetRange(uint32_t level) const {
+        return m_FinestRange * static_cast<float>(1u << level);
+    }
+
+    static bool SphereIntersectsBox(const glm::vec3& center, float radius,
+                                    const glm::vec3& boxMin,
+                                    const glm::vec3& boxMax);
+
+private:
+    float m_Size{ 1.0f };
+    uint32_t m_LevelCount{ 1 };
+    float m_FinestRange{ 1.0f };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_CDLOD_QUAD_TREE_H_
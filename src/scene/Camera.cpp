@@ -111,6 +111,68 @@ namespace vkp
         UpdateProjMat();
     }
 
+    void Camera::SetViews(const ViewSetup& views)
+    {
+        m_Views = views;
+        m_Views.count = glm::clamp(views.count, 1u, s_kMaxViewCount);
+        UpdateViewMats();
+        UpdateFrustum();
+    }
+
+    void Camera::UpdateViewMats()
+    {
+        const float kCenter = 0.5f * static_cast<float>(m_Views.count - 1);
+
+        for (uint32_t i = 0; i < m_Views.count; ++i)
+        {
+            // Negative to the left, of the views turned to the left
+            const float kOffset = static_cast<float>(i) - kCenter;
+            const glm::mat3 kYaw = glm::mat3(
+                glm::rotate(glm::mat4(1.0f), -m_Views.yawStep * kOffset, m_Up)
+            );
+
+            const glm::vec3 kPos =
+                m_Position + m_Right * (m_Views.separation * kOffset);
+            m_ViewFronts[i] = kYaw * m_Front;
+            m_ViewRights[i] = kYaw * m_Right;
+            m_ViewMats[i] = glm::lookAt(kPos, kPos + m_ViewFronts[i], m_Up);
+        }
+    }
+
+    void Camera::UpdateFrustum()
+    {
+        if (m_Views.count == 1)
+        {
+            m_Frustum.Set(m_ProjMat * m_ViewMat);
+            return;
+        }
+
+        // Of the outer views, turned by 'kYaw' and moved by 'kSide'
+        const float kYaw = glm::abs(m_Views.yawStep) *
+                           0.5f * static_cast<float>(m_Views.count - 1);
+        const float kSide = glm::abs(m_Views.separation) *
+                            0.5f * static_cast<float>(m_Views.count - 1);
+
+        const float kTanV = glm::tan(0.5f * m_Fov);
+        const float kTanH = kTanV * m_AspectRatio;
+
+        // Wider by the turn, of the outer corners' slopes, and moved back
+        //  until its sides pass the outer views' positions
+        const float kHalfH = glm::min(glm::atan(kTanH) + kYaw,
+                                      glm::radians(85.0f));
+        const float kTanHRig = glm::tan(kHalfH);
+        const float kTanVRig = kTanV / glm::max(glm::cos(kYaw) -
+                                                kTanH * glm::sin(kYaw), 0.1f);
+        const float kBack = kSide / kTanHRig;
+
+        const glm::vec3 kApex = m_Position - m_Front * kBack;
+        const glm::mat4 kView = glm::lookAt(kApex, kApex + m_Front, m_Up);
+        const glm::mat4 kProj = glm::perspective(2.0f * glm::atan(kTanVRig),
+                                                 kTanHRig / kTanVRig,
+                                                 m_Near, m_Far + kBack);
+        m_Frustum.Set(kProj * kView);
+    }
+
     void Camera::SetFov(float fov)
     {
         m_Fov = fov;
@@ -6,6 +6,7 @@
 #ifndef WATER_SURFACE_RENDERING_SCENE_CAMERA_H_
 #define WATER_SURFACE_RENDERING_SCENE_CAMERA_H_
 
+#include <array>
 #include <unordered_map>
 #include <functional>
 
@@ -13,6 +14,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/string_cast.hpp>
 
+#include "scene/Frustum.h"
+
 
 namespace vkp
 {
@@ -55,6 +58,21 @@ namespace vkp
         static inline const float s_kSpeedupMultiplier{ 3.0  };
         static inline const float s_kMouseSensitivity { 0.1  };
 
+        static constexpr uint32_t s_kMaxViewCount{ 4 };
+
+        /**
+         * @brief Views of a rig around the camera, rendered by one multiview
+         *  pass, e.g., of the eyes of a stereo pair, or of the projectors of
+         *  a wall. The views are ordered from the left, centered on the
+         *  camera, each of the same projection
+         */
+        struct ViewSetup
+        {
+            uint32_t count{ 1 };
+            float separation{ 0.0f };   ///< Between the neighbours, sideways
+            float yawStep{ 0.0f };      ///< Between the neighbours, in radians
+        };
+
     public:
         Camera(float screenAspectRatio,
                const glm::vec3& pos = glm::vec3(0.0, 0.0, 0.0), 
@@ -85,6 +103,36 @@ namespace vkp
         inline const glm::mat4& GetViewMat() const { return m_ViewMat; }
         inline const glm::mat4& GetProjMat() const { return m_ProjMat; }
 
+        inline const ViewSetup& GetViews() const { return m_Views; }
+        inline uint32_t GetViewCount() const { return m_Views.count; }
+        /** @return Of a view of the rig, @see "SetViews()" */
+        inline const glm::mat4& GetViewMat(uint32_t view) const {
+            return m_ViewMats[view];
+        }
+        /** @return Of a view of the rig, without the translation part */
+        inline glm::mat3 GetView(uint32_t view) const {
+            return glm::mat3(m_ViewRights[view], m_Up, m_ViewFronts[view]);
+        }
+
+        /**
+         * @return Of the current view and projection matrices, of all the
+         *  views of the rig if there are more
+         */
+        inline const Frustum& GetFrustum() const { return m_Frustum; }
+
+        /** @return False only if the box is surely out of the view */
+        inline bool IsBoxVisible(const glm::vec3& boxMin,
+                                 const glm::vec3& boxMax) const
+        {
+            return m_Frustum.IntersectsBox(boxMin, boxMax);
+        }
+
+        /** @return False only if the sphere is surely out of the view */
+        inline bool IsSphereVisible(const glm::vec3& center, float radius) const
+        {
+            return m_Frustum.IntersectsSphere(center, radius);
+        }
+
         /** @return View matrix without the translation part */
         inline const glm::mat3 GetView() const
         {
@@ -118,6 +166,8 @@ namespace vkp
         }
 
         void SetAspectRatio(float aspect);
+        /** @brief Also updates the frustum, to contain all the views */
+        void SetViews(const ViewSetup& views);
         void SetFov(float rad);
         void SetFovDeg(float deg) { SetFov( glm::radians(deg) ); }
         void SetNear(float dist);
@@ -141,13 +191,21 @@ namespace vkp
         inline void UpdateViewMat()
         {
             m_ViewMat = glm::lookAt(m_Position, m_Position + m_Front, m_Up);
+            UpdateViewMats();
+            UpdateFrustum();
         }
 
         inline void UpdateProjMat()
         {
             m_ProjMat = glm::perspective(m_Fov, m_AspectRatio, m_Near, m_Far);
+            UpdateFrustum();
         }
 
+        /** @brief Of the views of the rig, about the current vectors */
+        void UpdateViewMats();
+        /** @brief Of the single view, or of a volume containing all */
+        void UpdateFrustum();
+
         // @brief Keeps the camera from flipping along Y-axis
         inline void _SetPitch(float rad)
         { 
@@ -232,6 +290,15 @@ namespace vkp
         glm::mat4 m_ViewMat{ 1.0 };
         glm::mat4 m_ProjMat{ 1.0 };
 
+        // Of the rig, the first of the single view is the camera's
+        ViewSetup m_Views;
+        std::array<glm::mat4, s_kMaxViewCount> m_ViewMats;
+        std::array<glm::vec3, s_kMaxViewCount> m_ViewFronts;
+        std::array<glm::vec3, s_kMaxViewCount> m_ViewRights;
+        // Planes of the view's volume, the Y axis flipped for Vulkan only
+        //  swaps the top and bottom ones
+        Frustum m_Frustum;
+
         // ---------------------------------------------------------------------
         // Controls
 
@@ -0,0 +1,94 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/CameraPath.h"
+
+#include <fstream>
+#include <sstream>
+
+
+namespace vkp
+{
+    bool CameraPath::Load(const std::filesystem::path& path)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        std::ifstream file(path);
+        if (!file)
+        {
+            VKP_LOG_ERR("Camera path: failed to read: {}", path.string());
+            return false;
+        }
+
+        std::vector<Key> keys;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            line = line.substr(0, line.find('#'));
+
+            std::istringstream stream(line);
+            Key key{};
+            float yawDeg = 0.0f, pitchDeg = 0.0f;
+            if (!(stream >> key.time >> key.position.x >> key.position.y
+                         >> key.position.z >> yawDeg >> pitchDeg))
+            {
+                continue;
+            }
+
+            key.yaw = glm::radians(yawDeg);
+            key.pitch = glm::radians(pitchDeg);
+            keys.push_back(key);
+        }
+
+        if (keys.empty())
+        {
+            VKP_LOG_ERR("Camera path: no keys in: {}", path.string());
+            return false;
+        }
+
+        std::stable_sort(keys.begin(), keys.end(),
+                         [](const Key& a, const Key& b) {
+                             return a.time < b.time;
+                         });
+        m_Keys = std::move(keys);
+        return true;
+    }
+
+    void CameraPath::Apply(Camera& camera, float time) const
+    {
+        if (m_Keys.empty())
+            return;
+
+        const float kDuration = GetDuration();
+        if (kDuration > 0.0f)
+            time = std::fmod(time, kDuration);
+
+        // First key after the time, the last one holds
+        auto next = std::upper_bound(m_Keys.begin(), m_Keys.end(), time,
+                                     [](float t, const Key& key) {
+                                         return t < key.time;
+                                     });
+        Key key = m_Keys.back();
+        if (next == m_Keys.begin())
+            key = m_Keys.front();
+        else if (next != m_Keys.end())
+        {
+            const Key& a = *(next - 1);
+            const Key& b = *next;
+            const float kT = (time - a.time) / (b.time - a.time);
+
+            key.position = glm::mix(a.position, b.position, kT);
+            key.yaw = glm::mix(a.yaw, b.yaw, kT);
+            key.pitch = glm::mix(a.pitch, b.pitch, kT);
+        }
+
+        camera.SetPosition(key.position);
+        camera.SetYaw(key.yaw);
+        camera.SetPitch(key.pitch);
+        camera.UpdateVectors();
+    }
+
+} // namespace vkp
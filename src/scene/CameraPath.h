@@ -0,0 +1,55 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_CAMERA_PATH_H_
+#define WATER_SURFACE_RENDERING_SCENE_CAMERA_PATH_H_
+
+#include <filesystem>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "scene/Camera.h"
+
+
+namespace vkp
+{
+    /**
+     * @brief Scripted camera, of keys interpolated linearly, looped over
+     *  the time of the last key
+     */
+    class CameraPath
+    {
+    public:
+        struct Key
+        {
+            float time;         ///< In seconds, ascending
+            glm::vec3 position;
+            float yaw;          ///< In radians
+            float pitch;        ///< In radians
+        };
+
+        /**
+         * @brief Reads a key of each line: "time x y z yawDeg pitchDeg",
+         *  '#' starts a comment
+         * @return False if not readable, or of no keys
+         */
+        bool Load(const std::filesystem::path& path);
+
+        /** @brief Sets the camera's position and orientation at the time */
+        void Apply(Camera& camera, float time) const;
+
+        bool IsEmpty() const { return m_Keys.empty(); }
+        float GetDuration() const {
+            return m_Keys.empty() ? 0.0f : m_Keys.back().time;
+        }
+
+    private:
+        std::vector<Key> m_Keys;
+    };
+
+} // namespace vkp
+
+#endif // WATER_SURFACE_RENDERING_SCENE_CAMERA_PATH_H_
@@ -0,0 +1,81 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_FRUSTUM_H_
+#define WATER_SURFACE_RENDERING_SCENE_FRUSTUM_H_
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+
+/**
+ * @brief View frustum as six planes in world space, extracted from
+ *  a view-projection matrix with depth in [0, 1] [Gribb, Hartmann 2001]
+ */
+class Frustum
+{
+public:
+    Frustum() = default;
+
+    /** @param viewProj Projection times the view matrix */
+    explicit Frustum(const glm::mat4& viewProj) { Set(viewProj); }
+
+    void Set(const glm::mat4& viewProj)
+    {
+        // Rows of the column-major matrix
+        const glm::mat4 kRows = glm::transpose(viewProj);
+
+        m_Planes[0] = kRows[3] + kRows[0];     // Left
+        m_Planes[1] = kRows[3] - kRows[0];     // Right
+        m_Planes[2] = kRows[3] + kRows[1];     // Bottom
+        m_Planes[3] = kRows[3] - kRows[1];     // Top
+        m_Planes[4] = kRows[2];                // Near
+        m_Planes[5] = kRows[3] - kRows[2];     // Far
+    }
+
+    /**
+     * @return False only if the box is entirely outside of a plane,
+     *  conservative: boxes near the corners may pass
+     */
+    bool IntersectsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+    {
+        for (const glm::vec4& kPlane : m_Planes)
+        {
+            // Corner of the box farthest along the plane's normal
+            const glm::vec3 kPositive{
+                kPlane.x >= 0.0f ? boxMax.x : boxMin.x,
+                kPlane.y >= 0.0f ? boxMax.y : boxMin.y,
+                kPlane.z >= 0.0f ? boxMax.z : boxMin.z
+            };
+
+            if (glm::dot(glm::vec3(kPlane), kPositive) + kPlane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    /** @return False only if the sphere is entirely outside of a plane */
+    bool IntersectsSphere(const glm::vec3& center, float radius) const
+    {
+        for (const glm::vec4& kPlane : m_Planes)
+        {
+            const glm::vec3 kNormal(kPlane);
+
+            // Distance scaled by the normal's length
+            if (glm::dot(kNormal, center) + kPlane.w <
+                -radius * glm::length(kNormal))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    // Inside where dot(plane.xyz, p) + plane.w >= 0, not normalized
+    std::array<glm::vec4, 6> m_Planes{};
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_FRUSTUM_H_
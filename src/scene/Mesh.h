@@ -15,16 +15,34 @@
 
 /**
  * @brief TODO use case
+ * @tparam T Vertex type
+ * @tparam I Index type, uint16_t or uint32_t
  */
-template<class T>
+template<class T, class I = uint32_t>
 class Mesh
 {
+public:
+    /**
+     * @brief Range of the indices drawn by one call, relative to its first
+     *  vertex, so that 16-bit indices may address large meshes
+     */
+    struct Chunk
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        int32_t  vertexOffset;
+    };
+
+    static constexpr VkIndexType s_kIndexType =
+        sizeof(I) == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16
+                                      : VK_INDEX_TYPE_UINT32;
+
 public:
     Mesh();
 
     Mesh(const vkp::Device& device,
          const std::vector<T>& vertices,
-         const std::vector<uint32_t>& indices) 
+         const std::vector<I>& indices) 
         : m_Vertices(vertices), m_Indices(indices)
     {
         CreateBuffers(device, GetVerticesSize(), GetIndicesSize());
@@ -32,7 +50,7 @@ public:
 
     Mesh(const vkp::Device& device,
          std::vector<T>&& vertices,
-         std::vector<uint32_t>&& indices)
+         std::vector<I>&& indices)
          : m_Vertices(vertices), m_Indices(indices)
     {
         CreateBuffers(device, GetVerticesSize(), GetIndicesSize());
@@ -56,15 +74,18 @@ public:
         m_LatestBuffersOnDevice = false;
     }
 
-    void SetIndices(const std::vector<uint32_t>& kIndices) {
+    void SetIndices(const std::vector<I>& kIndices) {
         m_Indices = kIndices;
         m_LatestBuffersOnDevice = false;
     }
-    void SetIndices(std::vector<uint32_t>&& indices) {
+    void SetIndices(std::vector<I>&& indices) {
         m_Indices = indices;
         m_LatestBuffersOnDevice = false;
     }
 
+    /** @brief Drawn by separate calls, if none all the indices are drawn */
+    void SetChunks(std::vector<Chunk>&& chunks) { m_Chunks = chunks; }
+
     /**
      * @pre Set vertices and indices
      * @brief Stages a copy of the set vertices and indices to the device buffers.
@@ -86,15 +107,59 @@ public:
         return true;
     }
 
+    /** @brief Uploads the set vertices and indices again, e.g., to new buffers */
+    void SetBuffersDirty() { m_LatestBuffersOnDevice = false; }
+
     /**
      * @pre Uploaded data to vertex and index buffers
      */
     void Render(VkCommandBuffer cmdBuffer)
     {
         BindBuffers(cmdBuffer);
-        DrawIndexed(cmdBuffer, GetIndexCount());
+
+        if (m_Chunks.empty())
+        {
+            DrawIndexed(cmdBuffer, GetIndexCount());
+            return;
+        }
+
+        for (const Chunk& kChunk : m_Chunks)
+        {
+            DrawIndexed(cmdBuffer, kChunk.indexCount, kChunk.firstIndex,
+                        kChunk.vertexOffset);
+        }
     }
 
+    /**
+     * @brief Draws only the chunks flagged visible, nothing is bound if none is
+     * @param kChunkVisible Flag of each of the set chunks
+     * @pre Uploaded data to vertex and index buffers, chunks are set
+     */
+    void Render(VkCommandBuffer cmdBuffer,
+                const std::vector<bool>& kChunkVisible)
+    {
+        VKP_ASSERT(kChunkVisible.size() == m_Chunks.size());
+
+        bool isBound = false;
+        for (size_t i = 0; i < m_Chunks.size(); ++i)
+        {
+            if (!kChunkVisible[i])
+                continue;
+
+            if (!isBound)
+            {
+                BindBuffers(cmdBuffer);
+                isBound = true;
+            }
+
+            const Chunk& kChunk = m_Chunks[i];
+            DrawIndexed(cmdBuffer, kChunk.indexCount, kChunk.firstIndex,
+                        kChunk.vertexOffset);
+        }
+    }
+
+    size_t GetChunkCount() const { return m_Chunks.size(); }
+
     /**
      * @brief Creates vertex and index buffers on the device with
      *  reserved size according to the set vertices and indices.
@@ -124,7 +189,7 @@ public:
 
     VkDeviceSize GetVerticesSize() const { return sizeof(T) * GetVertexCount(); }
     VkDeviceSize GetIndicesSize() const {
-        return sizeof(uint32_t) * GetIndexCount();
+        return sizeof(I) * GetIndexCount();
     }
 
 private:
@@ -138,11 +203,14 @@ private:
 
     void BindBuffers(VkCommandBuffer cmdBuffer) const;
     void DrawIndexed(VkCommandBuffer cmdBuffer,
-                     const uint32_t kIndexCount) const;
+                     const uint32_t kIndexCount,
+                     const uint32_t kFirstIndex = 0,
+                     const int32_t kVertexOffset = 0) const;
 
 private:
     std::vector<T> m_Vertices;
-    std::vector<uint32_t> m_Indices;
+    std::vector<I> m_Indices;
+    std::vector<Chunk> m_Chunks;
 
     // On device buffers
     std::unique_ptr<vkp::Buffer> m_VertexBuffer{ nullptr };
@@ -154,20 +222,20 @@ private:
 
 // TODO into implementation header file
 
-template <class T>
-Mesh<T>::Mesh()
+template <class T, class I>
+Mesh<T, I>::Mesh()
 {
     VKP_REGISTER_FUNCTION();
 }
 
-template <class T>
-Mesh<T>::~Mesh()
+template <class T, class I>
+Mesh<T, I>::~Mesh()
 {
     VKP_REGISTER_FUNCTION();
 }
 
-template <class T>
-void Mesh<T>::CreateBuffers(
+template <class T, class I>
+void Mesh<T, I>::CreateBuffers(
     const vkp::Device& device,
     VkDeviceSize verticesSize,
     VkDeviceSize indicesSize
@@ -175,8 +243,8 @@ void Mesh<T>::CreateBuffers(
 {
     VKP_REGISTER_FUNCTION();
 
-    m_VertexBuffer.reset( new vkp::Buffer(device) );
-    m_IndexBuffer.reset( new vkp::Buffer(device) );
+    m_VertexBuffer.reset( new vkp::Buffer(device, vkp::MemoryTag::Mesh) );
+    m_IndexBuffer.reset( new vkp::Buffer(device, vkp::MemoryTag::Mesh) );
 
     m_VertexBuffer->Create(verticesSize,
                            VK_BUFFER_USAGE_TRANSFER_DST_BIT |
@@ -189,8 +257,8 @@ void Mesh<T>::CreateBuffers(
                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 }
 
-template <class T>
-void Mesh<T>::StageCopyVerticesToVertexBuffer(vkp::Buffer& stagingBuffer,
+template <class T, class I>
+void Mesh<T, I>::StageCopyVerticesToVertexBuffer(vkp::Buffer& stagingBuffer,
                                            VkCommandBuffer cmdBuffer)
 {
     VKP_REGISTER_FUNCTION();
@@ -207,8 +275,8 @@ void Mesh<T>::StageCopyVerticesToVertexBuffer(vkp::Buffer& stagingBuffer,
     m_VertexBuffer->StageCopy(stagingBuffer, &copyRegion, cmdBuffer);
 }
 
-template <class T>
-void Mesh<T>::StageCopyIndicesToIndexBuffer(vkp::Buffer& stagingBuffer,
+template <class T, class I>
+void Mesh<T, I>::StageCopyIndicesToIndexBuffer(vkp::Buffer& stagingBuffer,
                                          VkCommandBuffer cmdBuffer)
 {
     VKP_REGISTER_FUNCTION();
@@ -234,8 +302,8 @@ void Mesh<T>::StageCopyIndicesToIndexBuffer(vkp::Buffer& stagingBuffer,
     m_IndexBuffer->StageCopy(stagingBuffer, &copyRegion, cmdBuffer);
 }
 
-template <class T>
-void Mesh<T>::BindBuffers(VkCommandBuffer cmdBuffer) const
+template <class T, class I>
+void Mesh<T, I>::BindBuffers(VkCommandBuffer cmdBuffer) const
 {
     const VkBuffer kVertexBuffers[] = { m_VertexBuffer->GetBuffer() };
     const VkDeviceSize kOffsets[] = { 0 };
@@ -246,16 +314,17 @@ void Mesh<T>::BindBuffers(VkCommandBuffer cmdBuffer) const
 
     const VkDeviceSize kIndexOffset = 0;
     vkCmdBindIndexBuffer(cmdBuffer, m_IndexBuffer->GetBuffer(),
-                         kIndexOffset, VK_INDEX_TYPE_UINT32);
+                         kIndexOffset, s_kIndexType);
 }
 
-template <class T>
-void Mesh<T>::DrawIndexed(VkCommandBuffer cmdBuffer,
-                                   const uint32_t kIndexCount) const
+template <class T, class I>
+void Mesh<T, I>::DrawIndexed(VkCommandBuffer cmdBuffer,
+                             const uint32_t kIndexCount,
+                             const uint32_t kFirstIndex,
+                             const int32_t kVertexOffset) const
 {
     const uint32_t kInstanceCount = 1; 
-    const uint32_t kFirstIndex = 0, kFirstInstance = 0;
-    const uint32_t kVertexOffset = 0;
+    const uint32_t kFirstInstance = 0;
 
     vkCmdDrawIndexed(cmdBuffer, kIndexCount, kInstanceCount, kFirstIndex,
                      kVertexOffset, kFirstInstance);
@@ -9,19 +9,26 @@
 
 #include <imgui/imgui.h>
 
+#include <core/Profile.h>
+#include <vulkan/GpuProfile.h>
+
 
 SkyModel::SkyModel(
     const vkp::Device& device,
     const vkp::DescriptorPool& descriptorPool,
-    const glm::vec3& sunDir
+    const glm::vec3& sunDir,
+    uint32_t viewCount
 )
     : m_kDevice(device),
-      m_kDescriptorPool(descriptorPool)
+      m_kDescriptorPool(descriptorPool),
+      m_kUsesPushDescriptors(device.SupportsPushDescriptors()),
+      m_kViewCount(viewCount)
 {
     VKP_REGISTER_FUNCTION();
 
     CreateDescriptorSetLayout();
     SetupPipeline();
+    SetupLutPipeline();
 
     m_Sky.reset( new SkyPreetham(sunDir) );
     UpdateSkyUBO();
@@ -53,10 +60,10 @@ void SkyModel::CreateRenderData(
         m_UniformBuffers.clear();
         CreateUniformBuffers(kImageCount);
 
+        // Updated by "PrepareRender()", once the LUT is created
         m_DescriptorSets.clear();
-        CreateDescriptorSets(kImageCount);
-
-        UpdateDescriptorSets();
+        if (!m_kUsesPushDescriptors)
+            CreateDescriptorSets(kImageCount);
     }
 }
 
@@ -67,12 +74,21 @@ void SkyModel::Update(float dt)
 
 void SkyModel::PrepareRender(
     const uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer,
     glm::uvec2 screenResolution,
     const glm::vec3& camPos,
     const glm::mat3& camView,
     float camFOV
 )
 {
+    if (m_Lut == nullptr)
+        CreateLut(cmdBuffer);
+    if (m_LutNeedsUpdate)
+    {
+        RecordLutBake(cmdBuffer);
+        m_LutNeedsUpdate = false;
+    }
+
     m_SkyUBO.resolution = screenResolution;
     m_SkyUBO.camPos = camPos;
     m_SkyUBO.camViewRow0 = camView[0];
@@ -82,11 +98,13 @@ void SkyModel::PrepareRender(
 
     UpdateUniformBuffer(m_UniformBuffers[frameIndex]);
 
-    // TODO not needed
-    //UpdateDescriptorSet(
-    //    m_DescriptorSets[frameIndex],
-    //    m_UniformBuffers[frameIndex]
-    //);
+    if (m_kUsesPushDescriptors)
+        return;
+
+    UpdateDescriptorSet(
+        m_DescriptorSets[frameIndex],
+        m_UniformBuffers[frameIndex]
+    );
 }
 
 void SkyModel::Render(
@@ -94,26 +112,45 @@ void SkyModel::Render(
     VkCommandBuffer cmdBuffer
 )
 {
+   VKP_PROFILE_GPU_SCOPE(cmdBuffer, "Sky pass");
+   VKP_PROFILE_GPU_STATISTICS(cmdBuffer, "Sky pass");
+
+   // Of the same layout, the set is bound of the sky's pipeline either way
    vkCmdBindPipeline(
        cmdBuffer,
        VK_PIPELINE_BIND_POINT_GRAPHICS, 
-       *m_Pipeline
+       m_ShowOverdraw ? *m_OverdrawPipeline : *m_Pipeline
    );
 
    const uint32_t kFirstSet = 0, kDescriptorSetCount = 1;
-   const uint32_t kDynamicOffsetCount = 0;
-   const uint32_t* kDynamicOffsets = nullptr;
 
-   vkCmdBindDescriptorSets(
-       cmdBuffer,
-       VK_PIPELINE_BIND_POINT_GRAPHICS,
-       *m_Pipeline,
-       kFirstSet,
-       kDescriptorSetCount,
-       &m_DescriptorSets[frameIndex].set,
-       kDynamicOffsetCount,
-       kDynamicOffsets
-   );
+   if (m_kUsesPushDescriptors)
+   {
+       DescriptorInfos infos =
+           GetDescriptorInfos(m_UniformBuffers[frameIndex]);
+
+       vkp::DescriptorWriter(*m_DescriptorSetLayout, m_kDescriptorPool)
+           .AddBufferDescriptor(0, &infos.skyUBO)
+           .AddImageDescriptor(1, &infos.lut)
+           .PushSet(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_Pipeline,
+                    kFirstSet);
+   }
+   else
+   {
+       const uint32_t kDynamicOffsetCount = 0;
+       const uint32_t* kDynamicOffsets = nullptr;
+
+       vkCmdBindDescriptorSets(
+           cmdBuffer,
+           VK_PIPELINE_BIND_POINT_GRAPHICS,
+           *m_Pipeline,
+           kFirstSet,
+           kDescriptorSetCount,
+           &m_DescriptorSets[frameIndex].set,
+           kDynamicOffsetCount,
+           kDynamicOffsets
+       );
+   }
 
    // Draw fullscreen triangle
    const uint32_t kVertexCount = 3, kInstanceCount = 1;
@@ -136,19 +173,6 @@ void SkyModel::UpdateSkyUBO()
     m_SkyUBO.params.props = m_Sky->GetProperties();
 }
 
-void SkyModel::UpdateDescriptorSets()
-{
-    VKP_ASSERT(m_DescriptorSets.size() == m_UniformBuffers.size());
-
-    for (uint32_t i = 0; i < m_DescriptorSets.size(); ++i)
-    {
-        UpdateDescriptorSet(
-            m_DescriptorSets[i],
-            m_UniformBuffers[i]
-        );
-    }
-}
-
 void SkyModel::UpdateDescriptorSet(
     DescriptorSet& descriptor,
     const vkp::Buffer& buffer
@@ -159,21 +183,31 @@ void SkyModel::UpdateDescriptorSet(
 
     VKP_REGISTER_FUNCTION();
 
-    VkDescriptorBufferInfo bufferInfos[1] = {};
-    bufferInfos[0].buffer = buffer;
-    bufferInfos[0].offset = 0;
-    bufferInfos[0].range = sizeof(SkyUBO);
-
-    vkp::DescriptorWriter descriptorWriter(*m_DescriptorSetLayout,
-                                            m_kDescriptorPool);
-    uint32_t binding = 0;
+    const DescriptorInfos kInfos = GetDescriptorInfos(buffer);
 
-    descriptorWriter.AddBufferDescriptor(binding++, &bufferInfos[0]);
-
-    descriptorWriter.UpdateSet(descriptor.set);
+    m_DescriptorTemplate->UpdateSet(descriptor.set, &kInfos);
     descriptor.isDirty = false;
 }
 
+SkyModel::DescriptorInfos SkyModel::GetDescriptorInfos(
+    const vkp::Buffer& buffer
+) const
+{
+    VKP_ASSERT(m_Lut != nullptr);
+
+    DescriptorInfos infos{
+        .skyUBO = {
+            .buffer = buffer,
+            .offset = 0,
+            .range = sizeof(SkyUBO)
+        },
+        .lut = m_Lut->GetDescriptor()
+    };
+    infos.lut.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    return infos;
+}
+
 // -----------------------------------------------------------------------------
 // Creation functions
 
@@ -190,6 +224,32 @@ void SkyModel::CreateDescriptorSetLayout()
             .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
             .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
         })
+        // LUT
+        .AddBinding({
+            .binding = bindingPoint++,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
+        })
+        .SetFlags(m_kUsesPushDescriptors ?
+                  VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0)
+        .Build();
+
+    if (!m_kUsesPushDescriptors)
+    {
+        m_DescriptorTemplate = vkp::DescriptorUpdateTemplate::Builder(
+                m_kDevice, *m_DescriptorSetLayout)
+            .AddBinding(0, offsetof(DescriptorInfos, skyUBO))
+            .AddBinding(1, offsetof(DescriptorInfos, lut))
+            .Build();
+    }
+
+    m_LutDescriptorSetLayout = vkp::DescriptorSetLayout::Builder(m_kDevice)
+        // LUT, written by the bake
+        .AddBinding({
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        })
         .Build();
 }
 
@@ -204,7 +264,8 @@ void SkyModel::CreateUniformBuffers(const uint32_t kBufferCount)
 
     for (uint32_t i = 0; i < kBufferCount; ++i)
     {
-        auto& buffer = m_UniformBuffers.emplace_back(m_kDevice);
+        auto& buffer = m_UniformBuffers.emplace_back(m_kDevice,
+                                                    vkp::MemoryTag::Sky);
 
         buffer.Create(kBufferSize,
                       VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
@@ -226,6 +287,7 @@ std::vector<
         std::shared_ptr<vkp::ShaderModule>
     > shaders(kShaderInfoCount, nullptr);
 
+    #pragma omp parallel for schedule(dynamic)
     for (uint32_t i = 0; i < kShaderInfoCount; ++i)
     {
         shaders[i] = std::make_shared<vkp::ShaderModule>(
@@ -240,12 +302,25 @@ void SkyModel::SetupPipeline()
 {
     VKP_REGISTER_FUNCTION();
 
+    const auto& kShaderInfos = m_kViewCount > 1 ? s_kMultiviewShaderInfos
+                                                : s_kShaderInfos;
+    m_Pipeline = SetupPipeline(kShaderInfos.data(), kShaderInfos.size());
+
+    m_OverdrawPipeline = SetupPipeline(s_kOverdrawShaderInfos.data(),
+                                       s_kOverdrawShaderInfos.size());
+    m_OverdrawPipeline->SetAdditiveBlending();
+}
+
+std::unique_ptr<vkp::Pipeline> SkyModel::SetupPipeline(
+    const vkp::ShaderInfo* kShaderInfos,
+    const uint32_t kShaderInfoCount
+) const
+{
     std::vector<
         std::shared_ptr<vkp::ShaderModule>
-    > shaders = CreateShadersFromShaderInfos(s_kShaderInfos.data(),
-                                             s_kShaderInfos.size());
+    > shaders = CreateShadersFromShaderInfos(kShaderInfos, kShaderInfoCount);
 
-    m_Pipeline = std::make_unique<vkp::Pipeline>(
+    auto pipeline = std::make_unique<vkp::Pipeline>(
         m_kDevice, shaders
     );
 
@@ -256,20 +331,137 @@ void SkyModel::SetupPipeline()
     {
         const auto& descriptorSetLayout = m_DescriptorSetLayout->GetLayout();
 
-        auto& pipelineLayoutInfo = m_Pipeline->GetPipelineLayoutInfo();
+        auto& pipelineLayoutInfo = pipeline->GetPipelineLayoutInfo();
         pipelineLayoutInfo.setLayoutCount = 1;
         pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
     }
 
     // Fullscreen triangle
-    m_Pipeline->SetVertexInputState( vkp::Pipeline::InitVertexInput() );
+    pipeline->SetVertexInputState( vkp::Pipeline::InitVertexInput() );
 
     // Set front face as counter clockwise
     auto rasterizationState = vkp::Pipeline::InitRasterization();
     rasterizationState.cullMode = VK_CULL_MODE_FRONT_BIT;
     rasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
 
-    m_Pipeline->SetRasterizationState(rasterizationState);
+    pipeline->SetRasterizationState(rasterizationState);
+
+    // At the far plane, drawn last only where nothing else is
+    pipeline->SetDepthState(VK_COMPARE_OP_LESS_OR_EQUAL, false);
+
+    return pipeline;
+}
+
+void SkyModel::SetupLutPipeline()
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_ASSERT(m_LutDescriptorSetLayout != nullptr);
+
+    std::vector<
+        std::shared_ptr<vkp::ShaderModule>
+    > shaders = CreateShadersFromShaderInfos(&s_kLutShaderInfo, 1);
+
+    m_LutPipeline = std::make_unique<vkp::Pipeline>(m_kDevice, shaders);
+
+    auto& pipelineLayoutInfo = m_LutPipeline->GetPipelineLayoutInfo();
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_LutDescriptorSetLayout->GetLayout();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &s_kLutPushConstantRange;
+
+    m_LutPipeline->CreateCompute();
+}
+
+void SkyModel::CreateLut(VkCommandBuffer cmdBuffer)
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Repeats around the zenith, clamped at the poles
+    m_Lut.reset( new vkp::Texture2D(m_kDevice, vkp::MemoryTag::Sky) );
+    m_Lut->Create(cmdBuffer, s_kLutWidth, s_kLutHeight, s_kLutFormat,
+                  VK_IMAGE_TILING_OPTIMAL,
+                  VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                  VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT,
+                  VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                  {},
+                  VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                  VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                  VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
+
+    if (m_LutDescriptorSet == VK_NULL_HANDLE)
+    {
+        auto err = m_kDescriptorPool.AllocateDescriptorSet(
+            *m_LutDescriptorSetLayout,
+            m_LutDescriptorSet
+        );
+        VKP_ASSERT_RESULT(err);
+    }
+
+    VkDescriptorImageInfo imageInfos[1] = { m_Lut->GetDescriptor() };
+    imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    vkp::DescriptorWriter(*m_LutDescriptorSetLayout, m_kDescriptorPool)
+        .AddImageDescriptor(0, &imageInfos[0])
+        .UpdateSet(m_LutDescriptorSet);
+
+    for (auto& descriptor : m_DescriptorSets)
+        descriptor.isDirty = true;
+    m_LutNeedsUpdate = true;
+}
+
+void SkyModel::RecordLutBake(VkCommandBuffer cmdBuffer)
+{
+    VKP_PROFILE_GPU_SCOPE(cmdBuffer, "Sky LUT bake");
+
+    vkp::Image& image = m_Lut->GetImage();
+
+    // Previous reads of the frames in flight, the contents are discarded
+    image.RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_GENERAL);
+    image.SetLayout(VK_IMAGE_LAYOUT_GENERAL);
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                      *m_LutPipeline);
+
+    const uint32_t kFirstSet = 0, kDescriptorSetCount = 1;
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_LutPipeline->GetPipelineLayout(),
+        kFirstSet,
+        kDescriptorSetCount,
+        &m_LutDescriptorSet,
+        0, nullptr
+    );
+
+    const SkyPreetham::Props& kProps = m_Sky->GetProperties();
+    vkCmdPushConstants(
+        cmdBuffer,
+        m_LutPipeline->GetPipelineLayout(),
+        s_kLutPushConstantRange.stageFlags,
+        s_kLutPushConstantRange.offset,
+        s_kLutPushConstantRange.size,
+        &kProps
+    );
+
+    vkCmdDispatch(cmdBuffer,
+                  (s_kLutWidth + s_kLutGroupSize - 1) / s_kLutGroupSize,
+                  (s_kLutHeight + s_kLutGroupSize - 1) / s_kLutGroupSize,
+                  1);
+
+    // Read by the sky and the water surface of this frame
+    image.RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    image.SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
 void SkyModel::CreateDescriptorSets(const uint32_t kCount)
@@ -300,10 +492,12 @@ void SkyModel::CreatePipeline(
 
     m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
 
-    // Disable depth test
     m_Pipeline->Create(framebufferExtent,
                        renderPass,
-                       false);
+                       framebufferHasDepthAttachment);
+    m_OverdrawPipeline->Create(framebufferExtent,
+                               renderPass,
+                               framebufferHasDepthAttachment);
 }
 
 void SkyModel::RecompileShaders(
@@ -312,13 +506,22 @@ void SkyModel::RecompileShaders(
     const bool kFramebufferHasDepthAttachment
 )
 {
-    const bool kNeedsRecreation = m_Pipeline->RecompileShaders();
+    // Both recompiled, not short-circuited, of the shared vertex shader
+    const bool kNeedsRecreation = m_Pipeline->RecompileShaders() |
+                                  m_OverdrawPipeline->RecompileShaders();
     if (kNeedsRecreation)
     {
         CreatePipeline(kFramebufferExtent,
                        renderPass,
                        kFramebufferHasDepthAttachment);
     }
+
+    if (m_LutPipeline->RecompileShaders())
+    {
+        m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+        m_LutPipeline->CreateCompute();
+        m_LutNeedsUpdate = true;
+    }
 }
 
 // =============================================================================
@@ -381,5 +584,6 @@ void SkyModel::ShowLightingSettings()
         m_Sky->SetTurbidity(turbidity);
         m_Sky->Update();
         UpdateSkyUBO();
+        m_LutNeedsUpdate = true;
     }
 }
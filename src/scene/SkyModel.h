@@ -14,10 +14,18 @@
 #include "vulkan/ShaderModule.h"
 #include "vulkan/Buffer.h"
 #include "vulkan/Pipeline.h"
+#include "vulkan/Texture2D.h"
 
 #include "scene/SkyPreetham.h"
+#include "scene/Camera.h"
 
 
+/**
+ * @brief Preetham sky of the background, and of the reflections on the water.
+ *  The sky's luminance is baked into a lat-long LUT of the whole sphere by
+ *  a compute shader whenever the sun or the turbidity change, its passes then
+ *  only sample it, @see "shaders/SkyLut.glsl"
+ */
 class SkyModel
 {
 public:
@@ -30,11 +38,20 @@ public:
     };
 
 public:
+    /**
+     * @param viewCount Of the render pass, its pipeline shades each of the
+     *  views, @see "SetView()"
+     */
     SkyModel(const vkp::Device& device,
              const vkp::DescriptorPool& descriptorPool,
-             const glm::vec3& sunDir);
+             const glm::vec3& sunDir,
+             uint32_t viewCount = 1);
     ~SkyModel();
 
+    /**
+     * @param kImageCount Number of the frames in flight, indexing
+     *  the per-frame resources
+     */
     void CreateRenderData(
         VkRenderPass renderPass,
         const uint32_t kImageCount,
@@ -43,8 +60,14 @@ public:
 
     void Update(float dt);
 
+    /**
+     * @brief Updates the frame's uniforms, creates the LUT and records its
+     *  bake if the sky has changed
+     * @param cmdBuffer Command buffer in recording state, outside a render pass
+     */
     void PrepareRender(
         const uint32_t frameIndex,
+        VkCommandBuffer cmdBuffer,
         glm::uvec2 screenResolution,
         const glm::vec3& camPos,
         const glm::mat3& camView,
@@ -55,6 +78,14 @@ public:
         const uint32_t frameIndex,
         VkCommandBuffer cmdBuffer);
 
+    /**
+     * @brief Of a view of the multiview pass, of the next "PrepareRender()"
+     * @param camView Of the view, without the translation part
+     */
+    void SetView(uint32_t view, const glm::mat3& camView) {
+        m_SkyUBO.camViews[view] = glm::mat4(camView);
+    }
+
     // @pre Called inside ImGui Window scope
     void ShowGUISettings();
 
@@ -65,11 +96,40 @@ public:
     
     const Params& GetParams() const { return m_SkyUBO.params; }
 
+    /**
+     * @brief Draws the sky by the overdraw pipeline, adding a constant color
+     *  per shaded fragment, @see "shaders/Overdraw.frag"
+     */
+    void SetShowOverdraw(bool showOverdraw) { m_ShowOverdraw = showOverdraw; }
+
+    /**
+     * @return Sky luminance of the directions, in SHADER_READ_ONLY_OPTIMAL
+     *  for the fragment shaders
+     * @pre Created by the first "PrepareRender()"
+     */
+    const vkp::Texture2D& GetLut() const { return *m_Lut; }
+
 private:
     struct DescriptorSet;
 
+    // Of the set, in the order of the template's entries
+    struct DescriptorInfos
+    {
+        VkDescriptorBufferInfo skyUBO;
+        VkDescriptorImageInfo lut;
+    };
+
     void CreateDescriptorSetLayout();
+    /** @brief Sets up the sky's pipeline, and its overdraw variant */
     void SetupPipeline();
+    /** @return Of the sky's layout and states, of the shaders */
+    std::unique_ptr<vkp::Pipeline> SetupPipeline(
+        const vkp::ShaderInfo* kShaderInfos,
+        const uint32_t kShaderInfoCount) const;
+    void SetupLutPipeline();
+    void CreateLut(VkCommandBuffer cmdBuffer);
+    /** @brief Records the bake of the current properties into the LUT */
+    void RecordLutBake(VkCommandBuffer cmdBuffer);
 
     void CreateUniformBuffers(const uint32_t kBufferCount);
     void CreateDescriptorSets(const uint32_t kCount);
@@ -79,11 +139,11 @@ private:
         bool framebufferHasDepthAttachment
     );
 
-    void UpdateDescriptorSets();
     void UpdateDescriptorSet(
         DescriptorSet& descriptor,
         const vkp::Buffer& buffer
     );
+    DescriptorInfos GetDescriptorInfos(const vkp::Buffer& buffer) const;
     void UpdateUniformBuffer(const vkp::Buffer& buffer);
     void UpdateSkyUBO();
 
@@ -98,9 +158,18 @@ private:
     const vkp::Device&         m_kDevice;
     // TODO static GetDescriptorPoolSizes
     const vkp::DescriptorPool& m_kDescriptorPool;
+    // The set is pushed to the command buffer, without the per-frame sets
+    const bool                 m_kUsesPushDescriptors;
+    // Of the render pass, shaded by the multiview variant if more than one
+    const uint32_t             m_kViewCount;
 
     // =========================================================================
 
+    // Mapping of the directions to the LUT, appended to its shaders
+    static const inline std::string_view s_kLutShaderPath{
+        "shaders/SkyLut.glsl"
+    };
+
     static const inline std::array<vkp::ShaderInfo, 2> s_kShaderInfos {
         vkp::ShaderInfo{
             .paths = { "shaders/FullScreenQuad.vert" },
@@ -108,13 +177,31 @@ private:
             .isSPV = false
         },
         vkp::ShaderInfo{
-            .paths = { "shaders/SkyPreetham.frag" },
+            .paths = { "shaders/SkyVersion.glsl", "shaders/SkyPreetham.frag",
+                       s_kLutShaderPath },
+            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .isSPV = false
+        }
+    };
+
+    // Of the multiview pass, the directions are of each view's rotation
+    static const inline std::array<
+        vkp::ShaderInfo, 2
+    > s_kMultiviewShaderInfos {
+        s_kShaderInfos[0],
+        vkp::ShaderInfo{
+            .paths = { "shaders/SkyVersionMultiview.glsl",
+                       "shaders/SkyPreetham.frag", s_kLutShaderPath },
             .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
             .isSPV = false
         }
     };
 
     std::unique_ptr<vkp::DescriptorSetLayout> m_DescriptorSetLayout{ nullptr };
+    // Of the per-frame sets, if not pushed
+    std::unique_ptr<vkp::DescriptorUpdateTemplate> m_DescriptorTemplate{
+        nullptr
+    };
 
     struct DescriptorSet
     {
@@ -125,8 +212,51 @@ private:
 
     std::unique_ptr<vkp::Pipeline> m_Pipeline{ nullptr };
 
+    static const inline std::array<vkp::ShaderInfo, 2> s_kOverdrawShaderInfos {
+        s_kShaderInfos[0],
+        vkp::ShaderInfo({ "shaders/Overdraw.frag" },
+                        VK_SHADER_STAGE_FRAGMENT_BIT,
+                        false)
+    };
+
+    // Of the same states, adds the fragments' colors
+    std::unique_ptr<vkp::Pipeline> m_OverdrawPipeline{ nullptr };
+    bool m_ShowOverdraw{ false };
+
     std::vector<vkp::Buffer> m_UniformBuffers;
 
+    // =========================================================================
+    // LUT
+
+    static constexpr uint32_t s_kLutWidth{ 512 };   ///< Of the azimuth
+    static constexpr uint32_t s_kLutHeight{ 256 };  ///< Of the inclination
+    static constexpr VkFormat s_kLutFormat{ VK_FORMAT_R16G16B16A16_SFLOAT };
+    // Local size of the bake shader
+    static constexpr uint32_t s_kLutGroupSize{ 16 };
+
+    static const inline vkp::ShaderInfo s_kLutShaderInfo{
+        .paths = { "shaders/SkyPreethamLut.comp", s_kLutShaderPath },
+        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+        .isSPV = false
+    };
+
+    // Properties of the sky are pushed, within the minimum limit
+    static_assert(sizeof(SkyPreetham::Props) <= 128);
+    static const inline VkPushConstantRange s_kLutPushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(SkyPreetham::Props)
+    };
+
+    std::unique_ptr<vkp::Texture2D> m_Lut{ nullptr };
+    bool m_LutNeedsUpdate{ true };
+
+    std::unique_ptr<vkp::DescriptorSetLayout> m_LutDescriptorSetLayout{
+        nullptr
+    };
+    VkDescriptorSet m_LutDescriptorSet{ VK_NULL_HANDLE };
+    std::unique_ptr<vkp::Pipeline> m_LutPipeline{ nullptr };
+
     // =========================================================================
 
     struct SkyUBO
@@ -138,6 +268,10 @@ private:
         alignas(16) glm::vec3 camPos;
         float camFOV;
         Params params;
+        // Of the views of a multiview pass, the upper 3x3 of each
+        alignas(16) std::array<
+            glm::mat4, vkp::Camera::s_kMaxViewCount
+        > camViews{};
     };
     SkyUBO m_SkyUBO;
 
@@ -0,0 +1,162 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/TerrainMap.h"
+
+#include <core/Profile.h>
+
+
+TerrainMap::TerrainMap(
+    const vkp::Device& device,
+    const vkp::DescriptorPool& descriptorPool
+)
+    : m_kDevice(device),
+      m_kDescriptorPool(descriptorPool)
+{
+    VKP_REGISTER_FUNCTION();
+
+    CreateDescriptorSetLayout();
+    SetupPipeline();
+}
+
+TerrainMap::~TerrainMap()
+{
+    VKP_REGISTER_FUNCTION();
+}
+
+bool TerrainMap::Prepare(VkCommandBuffer cmdBuffer)
+{
+    const bool kCreated = m_Map == nullptr;
+    if (kCreated)
+        CreateMap(cmdBuffer);
+
+    if (m_NeedsBake)
+    {
+        RecordBake(cmdBuffer);
+        m_NeedsBake = false;
+    }
+
+    return kCreated;
+}
+
+void TerrainMap::RecompileShaders()
+{
+    if (m_Pipeline->RecompileShaders())
+    {
+        m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+        m_Pipeline->CreateCompute();
+        m_NeedsBake = true;
+    }
+}
+
+void TerrainMap::CreateDescriptorSetLayout()
+{
+    m_DescriptorSetLayout = vkp::DescriptorSetLayout::Builder(m_kDevice)
+        // Map, written by the bake
+        .AddBinding({
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        })
+        .Build();
+}
+
+void TerrainMap::SetupPipeline()
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_ASSERT(m_DescriptorSetLayout != nullptr);
+
+    std::vector<
+        std::shared_ptr<vkp::ShaderModule>
+    > shaders{
+        std::make_shared<vkp::ShaderModule>(m_kDevice, s_kShaderInfo)
+    };
+
+    m_Pipeline = std::make_unique<vkp::Pipeline>(m_kDevice, shaders);
+
+    auto& pipelineLayoutInfo = m_Pipeline->GetPipelineLayoutInfo();
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout->GetLayout();
+
+    m_Pipeline->CreateCompute();
+}
+
+void TerrainMap::CreateMap(VkCommandBuffer cmdBuffer)
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Mirrored beyond its extent, without seams
+    m_Map.reset( new vkp::Texture2D(m_kDevice, vkp::MemoryTag::Terrain) );
+    m_Map->Create(cmdBuffer, s_kSize, s_kSize, s_kFormat,
+                  VK_IMAGE_TILING_OPTIMAL,
+                  VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                  VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT,
+                  VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                  {},
+                  VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT,
+                  VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT,
+                  VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT);
+
+    if (m_DescriptorSet == VK_NULL_HANDLE)
+    {
+        auto err = m_kDescriptorPool.AllocateDescriptorSet(
+            *m_DescriptorSetLayout,
+            m_DescriptorSet
+        );
+        VKP_ASSERT_RESULT(err);
+    }
+
+    VkDescriptorImageInfo imageInfos[1] = { m_Map->GetDescriptor() };
+    imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    vkp::DescriptorWriter(*m_DescriptorSetLayout, m_kDescriptorPool)
+        .AddImageDescriptor(0, &imageInfos[0])
+        .UpdateSet(m_DescriptorSet);
+
+    m_NeedsBake = true;
+}
+
+void TerrainMap::RecordBake(VkCommandBuffer cmdBuffer)
+{
+    VKP_PROFILE_SCOPE();
+
+    vkp::Image& image = m_Map->GetImage();
+
+    // Previous reads of the frames in flight, the contents are discarded
+    image.RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_GENERAL);
+    image.SetLayout(VK_IMAGE_LAYOUT_GENERAL);
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, *m_Pipeline);
+
+    const uint32_t kFirstSet = 0, kDescriptorSetCount = 1;
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_Pipeline->GetPipelineLayout(),
+        kFirstSet,
+        kDescriptorSetCount,
+        &m_DescriptorSet,
+        0, nullptr
+    );
+
+    const uint32_t kGroupCount = (s_kSize + s_kGroupSize - 1) / s_kGroupSize;
+    vkCmdDispatch(cmdBuffer, kGroupCount, kGroupCount, 1);
+
+    // Read by the water surface of this frame
+    image.RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    image.SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
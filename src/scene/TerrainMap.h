@@ -0,0 +1,84 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_TERRAIN_MAP_H_
+#define WATER_SURFACE_RENDERING_SCENE_TERRAIN_MAP_H_
+
+#include <memory>
+#include <string_view>
+
+#include "vulkan/Device.h"
+#include "vulkan/Descriptors.h"
+#include "vulkan/ShaderModule.h"
+#include "vulkan/Pipeline.h"
+#include "vulkan/Texture2D.h"
+
+
+/**
+ * @brief Terrain below the water surface, of its fractal noise baked once
+ *  by a compute shader, instead of evaluated per fragment. The map covers
+ *  a square centered at the origin, mirrored beyond, @see
+ *  "shaders/TerrainMap.glsl".
+ *
+ * Stores the normal of the terrain in xyz and its color factor in w,
+ *  in RGBA8 SNORM
+ */
+class TerrainMap
+{
+public:
+    static constexpr uint32_t s_kSize{ 2048 };
+    static constexpr VkFormat s_kFormat{ VK_FORMAT_R8G8B8A8_SNORM };
+
+    // Mapping of the positions to the map, appended to the shaders using it
+    static const inline std::string_view s_kShaderPath{
+        "shaders/TerrainMap.glsl"
+    };
+
+public:
+    TerrainMap(const vkp::Device& device,
+               const vkp::DescriptorPool& descriptorPool);
+    ~TerrainMap();
+
+    /**
+     * @brief Creates the map and records its bake, if not yet
+     * @param cmdBuffer Command buffer in recording state, outside a render pass
+     * @return True if the map was created, the descriptors need an update
+     */
+    bool Prepare(VkCommandBuffer cmdBuffer);
+
+    /** @pre "Prepare()" was called */
+    const vkp::Texture2D& GetMap() const { return *m_Map; }
+
+    /** @brief The map is rebaked by the next "Prepare()" if recompiled */
+    void RecompileShaders();
+
+private:
+    void CreateDescriptorSetLayout();
+    void SetupPipeline();
+    void CreateMap(VkCommandBuffer cmdBuffer);
+    void RecordBake(VkCommandBuffer cmdBuffer);
+
+private:
+    const vkp::Device& m_kDevice;
+    const vkp::DescriptorPool& m_kDescriptorPool;
+
+    static constexpr uint32_t s_kGroupSize{ 16 };
+
+    static const inline vkp::ShaderInfo s_kShaderInfo{
+        .paths = { "shaders/TerrainMapBake.comp", s_kShaderPath },
+        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+        .isSPV = false
+    };
+
+    std::unique_ptr<vkp::Texture2D> m_Map{ nullptr };
+    bool m_NeedsBake{ true };
+
+    std::unique_ptr<vkp::DescriptorSetLayout> m_DescriptorSetLayout{ nullptr };
+    VkDescriptorSet m_DescriptorSet{ VK_NULL_HANDLE };
+    std::unique_ptr<vkp::Pipeline> m_Pipeline{ nullptr };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_TERRAIN_MAP_H_
@@ -0,0 +1,253 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSBodies.h"
+
+#include <core/Profile.h>
+
+
+WSBodies::WSBodies(const vkp::Device& device)
+    : m_kDevice(device)
+{
+    VKP_REGISTER_FUNCTION();
+}
+
+WSBodies::~WSBodies()
+{
+    VKP_REGISTER_FUNCTION();
+}
+
+void WSBodies::AddBody(const Body& body)
+{
+    VKP_ASSERT(body.waves.tileLength > 0.0f);
+
+    if (m_Bodies.size() >= s_kMaxBodyCount)
+    {
+        VKP_LOG_WARN("Water bodies: at most {}", s_kMaxBodyCount);
+        return;
+    }
+    m_Bodies.push_back(body);
+    m_NeedsPrepare = true;
+}
+
+void WSBodies::RemoveBody(uint32_t index)
+{
+    VKP_ASSERT(index < m_Bodies.size());
+
+    if (m_Bodies.size() == 1)
+        return;
+
+    m_Bodies.erase(m_Bodies.begin() + index);
+    m_NeedsPrepare = true;
+}
+
+void WSBodies::SetBody(uint32_t index, const Body& body)
+{
+    VKP_ASSERT(index < m_Bodies.size());
+    VKP_ASSERT(body.waves.tileLength > 0.0f);
+
+    m_NeedsPrepare |= !(body.waves == m_Bodies[index].waves);
+    m_Bodies[index] = body;
+}
+
+void WSBodies::Prepare(const WSTessendorf& primary)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_PROFILE_SCOPE();
+
+    DestroyResources();
+
+    // Layer of each distinct waves, in the order of their first body
+    std::vector<Waves> layerWaves;
+    m_BodyLayers.resize(m_Bodies.size());
+    for (uint32_t i = 0; i < m_Bodies.size(); ++i)
+    {
+        const Waves& kWaves = m_Bodies[i].waves;
+        const auto kIt = std::find(layerWaves.begin(), layerWaves.end(),
+                                   kWaves);
+
+        m_BodyLayers[i] = static_cast<uint32_t>(kIt - layerWaves.begin());
+        if (kIt == layerWaves.end())
+            layerWaves.push_back(kWaves);
+    }
+
+    // Of a previous preparation, only the structures of the changed
+    //  properties are recreated, the plans are of the same size
+    m_Layers.resize(layerWaves.size());
+    for (uint32_t i = 0; i < m_Layers.size(); ++i)
+    {
+        const Waves& kWaves = layerWaves[i];
+        Layer& layer = m_Layers[i];
+
+        if (layer.model == nullptr)
+        {
+            layer.model.reset( new WSTessendorf(s_kLayerSize,
+                                                kWaves.tileLength) );
+        }
+        auto& model = *layer.model;
+        model.SetTileLength(kWaves.tileLength);
+
+        // Same spectrum as the primary's, sampled at a coarser step of
+        //  the wave numbers, @see WSCascades::Prepare()
+        const float kStepRatio = primary.GetTileLength() / kWaves.tileLength;
+
+        model.SetWindDirection(kWaves.windDir);
+        model.SetWindSpeed(kWaves.windSpeed);
+        model.SetAnimationPeriod(primary.GetAnimationPeriod());
+        model.SetPhillipsConst(primary.GetPhillipsConst() *
+                               kStepRatio * kStepRatio);
+        model.SetDamping(primary.GetDamping());
+        model.SetLambda(primary.GetDisplacementLambda());
+        model.SetSeed(primary.GetSeed() + i + 1);
+        model.Prepare();
+
+        layer.amplitude = 0.0f;
+    }
+
+    CreateStagingBuffer();
+    m_NeedsPrepare = false;
+    m_NeedsUpdate = true;
+
+    VKP_LOG_INFO("Water bodies: {}, of {} simulated layers", m_Bodies.size(),
+                 m_Layers.size());
+}
+
+void WSBodies::SetFrameCount(uint32_t count)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_ASSERT(count > 0);
+
+    m_FrameCount = count;
+
+    if (m_StagingBuffer == nullptr)
+        return;
+
+    // Slices may still be read
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    CreateStagingBuffer();
+    m_NeedsUpdate = true;
+}
+
+bool WSBodies::Update(
+    VkCommandBuffer cmdBuffer,
+    uint32_t frameIndex,
+    float time,
+    bool animate,
+    VkPipelineStageFlags dstStages
+)
+{
+    VKP_PROFILE_SCOPE();
+    VKP_ASSERT(frameIndex < m_FrameCount);
+    VKP_ASSERT(!m_Layers.empty());
+
+    bool mapsCreated = false;
+    if (m_DisplacementMaps == nullptr)
+    {
+        CreateMaps(cmdBuffer);
+        m_NeedsUpdate = true;
+        mapsCreated = true;
+    }
+
+    if (!animate && !m_NeedsUpdate)
+        return mapsCreated;
+
+    // Slice of the frame, its previous copies are done
+    const VkDeviceSize kSliceOffset = m_StagingSliceSize * frameIndex;
+    const VkDeviceSize kMapSize = GetLayerMapSize();
+    const VkDeviceSize kNormalsOffset = kMapSize * m_Layers.size();
+
+    uint8_t* sliceData =
+        static_cast<uint8_t*>(m_StagingBuffer->GetMappedAddress()) +
+        kSliceOffset;
+
+    for (uint32_t i = 0; i < m_Layers.size(); ++i)
+    {
+        Layer& layer = m_Layers[i];
+        layer.amplitude = layer.model->ComputeWaves(time, WSTessendorf::Outputs{
+            .displacements = sliceData + kMapSize * i,
+            .normals = sliceData + kNormalsOffset + kMapSize * i,
+            .isHalf = true
+        });
+    }
+
+    m_StagingBuffer->FlushMappedRange(
+        m_kDevice.GetNonCoherentAtomSizeAlignment(2 * kNormalsOffset),
+        kSliceOffset
+    );
+
+    // All the layers of each map by one copy
+    m_DisplacementMaps->CopyFromBuffer(cmdBuffer,
+                                       *m_StagingBuffer,
+                                       kSliceOffset,
+                                       kMapSize,
+                                       dstStages);
+    m_NormalMaps->CopyFromBuffer(cmdBuffer,
+                                 *m_StagingBuffer,
+                                 kSliceOffset + kNormalsOffset,
+                                 kMapSize,
+                                 dstStages);
+    m_NeedsUpdate = false;
+
+    return mapsCreated;
+}
+
+float WSBodies::GetAmplitude() const
+{
+    float amplitude = 0.0f;
+    for (const Layer& kLayer : m_Layers)
+        amplitude = std::max(amplitude, kLayer.amplitude);
+
+    return amplitude;
+}
+
+void WSBodies::CreateStagingBuffer()
+{
+    // Slices are flushed separately
+    m_StagingSliceSize = m_kDevice.GetNonCoherentAtomSizeAlignment(
+        2 * GetLayerMapSize() * m_Layers.size()
+    );
+
+    m_StagingBuffer.reset(new vkp::Buffer(m_kDevice, vkp::MemoryTag::Staging));
+    m_StagingBuffer->Create(m_StagingSliceSize * m_FrameCount,
+                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+    auto err = m_StagingBuffer->Map();
+    VKP_ASSERT_RESULT(err);
+}
+
+void WSBodies::CreateMaps(VkCommandBuffer cmdBuffer)
+{
+    VKP_REGISTER_FUNCTION();
+
+    const uint32_t kLayerCount = static_cast<uint32_t>(m_Layers.size());
+
+    m_DisplacementMaps.reset(
+        new vkp::Texture2DArray(m_kDevice, vkp::MemoryTag::Maps)
+    );
+    m_DisplacementMaps->Create(cmdBuffer, s_kLayerSize, s_kLayerSize,
+                               kLayerCount, s_kMapFormat);
+
+    m_NormalMaps.reset(
+        new vkp::Texture2DArray(m_kDevice, vkp::MemoryTag::Maps)
+    );
+    m_NormalMaps->Create(cmdBuffer, s_kLayerSize, s_kLayerSize,
+                         kLayerCount, s_kMapFormat);
+}
+
+void WSBodies::DestroyResources()
+{
+    if (m_StagingBuffer == nullptr)
+        return;
+
+    // Maps and slices may still be read
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    m_DisplacementMaps.reset();
+    m_NormalMaps.reset();
+    m_StagingBuffer.reset();
+}
@@ -0,0 +1,191 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_BODIES_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_BODIES_H_
+
+#include <memory>
+#include <vector>
+
+#include "vulkan/Device.h"
+#include "vulkan/Buffer.h"
+#include "vulkan/Texture2D.h"
+#include "vulkan/Texture2DArray.h"
+
+#include "scene/WSTessendorf.h"
+
+
+/**
+ * @brief Separate water areas of the scene, e.g., harbors and pools, each a
+ *  rectangle of the water plane of its own waves. Bodies of the same waves
+ *  share a simulation: each distinct one is a WSTessendorf model of a layer
+ *  of the maps, all the bodies are drawn by one pipeline, as instances
+ *  referencing their layer.
+ *
+ * Waves of the layers are computed on the calling thread into a staging slice
+ *  of the frame, then copied to the layers of the two map arrays, each by a
+ *  single copy command.
+ *
+ * Maps are in RGBA16F, without mipmaps, of the same contents as those of
+ *  the cascades, @see WSCascades
+ */
+class WSBodies
+{
+public:
+    static constexpr uint32_t s_kMaxBodyCount{ 256 };
+    static constexpr uint32_t s_kLayerSize{ 128 };
+    static constexpr VkFormat s_kMapFormat{ VK_FORMAT_R16G16B16A16_SFLOAT };
+
+    /** @brief Simulated once for all the bodies of the same ones */
+    struct Waves
+    {
+        float tileLength;           ///< In meters
+        glm::vec2 windDir;
+        float windSpeed;            ///< In m/s
+
+        bool operator==(const Waves& other) const {
+            return tileLength == other.tileLength &&
+                   windDir == other.windDir &&
+                   windSpeed == other.windSpeed;
+        }
+    };
+
+    struct Body
+    {
+        glm::vec2 center;           ///< x and z, in meters
+        glm::vec2 halfExtent;
+        Waves waves;
+    };
+
+    // Two basins of a harbor, of the same waves, and a pool
+    static inline const std::vector<Body> s_kDefaultBodies{
+        { { 0.0f, 0.0f }, { 150.0f, 100.0f },
+          { 100.0f, { 1.0f, 1.0f }, 12.0f } },
+        { { 0.0f, 260.0f }, { 80.0f, 120.0f },
+          { 100.0f, { 1.0f, 1.0f }, 12.0f } },
+        { { 260.0f, 0.0f }, { 25.0f, 12.5f },
+          { 10.0f, { 1.0f, 0.0f }, 3.0f } }
+    };
+
+public:
+    explicit WSBodies(const vkp::Device& device);
+    ~WSBodies();
+
+    WSBodies(const WSBodies&) = delete;
+    WSBodies& operator=(const WSBodies&) = delete;
+
+    /** @brief Up to s_kMaxBodyCount, of other waves on the next "Prepare()" */
+    void AddBody(const Body& body);
+    /** @brief The last body is kept, the maps have at least a layer */
+    void RemoveBody(uint32_t index);
+    /** @brief Of other waves, they take effect on the next "Prepare()" */
+    void SetBody(uint32_t index, const Body& body);
+
+    const std::vector<Body>& GetBodies() const { return m_Bodies; }
+    uint32_t GetBodyCount() const {
+        return static_cast<uint32_t>(m_Bodies.size());
+    }
+
+    /** @return Whether the waves of the bodies changed since "Prepare()" */
+    bool NeedsPrepare() const { return m_NeedsPrepare; }
+
+    /**
+     * @brief (Re)Creates a model for each distinct waves of the bodies, with
+     *  the spectrum of the primary model. Their maps are (re)created by the
+     *  next "Update()" call. Waits for the graphics queue if the maps or the
+     *  staging buffer are freed
+     * @pre The FFTW planner is not used by another thread
+     */
+    void Prepare(const WSTessendorf& primary);
+
+    /**
+     * @brief Reallocates the staging buffer, with a slice for each frame in
+     *  flight, waits for the graphics queue
+     */
+    void SetFrameCount(uint32_t count);
+
+    /**
+     * @brief Creates the missing maps, computes the waves of all the layers
+     *  and records their copies to the maps
+     * @param frameIndex Its staging slice is written, its previous frame
+     *  is done
+     * @param time Elapsed time in seconds
+     * @param animate Whether the waves advance, otherwise they are computed
+     *  only once after their preparation
+     * @param dstStages Stages reading the maps
+     * @return True if maps were created, the descriptors need an update
+     */
+    bool Update(VkCommandBuffer cmdBuffer,
+                uint32_t frameIndex,
+                float time,
+                bool animate,
+                VkPipelineStageFlags dstStages);
+
+    /** @return Number of the layers of the last "Prepare()" */
+    uint32_t GetLayerCount() const {
+        return static_cast<uint32_t>(m_Layers.size());
+    }
+    /** @return Layer of the body's waves, of the last "Prepare()" */
+    uint32_t GetLayer(uint32_t bodyIndex) const {
+        return m_BodyLayers[bodyIndex];
+    }
+    float GetLayerTileLength(uint32_t layer) const {
+        return m_Layers[layer].model->GetTileLength();
+    }
+
+    /** @return Null if not created yet */
+    const vkp::Texture2DArray* GetDisplacementMaps() const {
+        return m_DisplacementMaps.get();
+    }
+    const vkp::Texture2DArray* GetNormalMaps() const {
+        return m_NormalMaps.get();
+    }
+
+    /** @return Highest of the layers' amplitudes of the last waves */
+    float GetAmplitude() const;
+
+private:
+    struct Layer
+    {
+        std::unique_ptr<WSTessendorf> model{ nullptr };
+        float amplitude{ 0.0f };
+    };
+
+    void CreateStagingBuffer();
+    void CreateMaps(VkCommandBuffer cmdBuffer);
+
+    /** @brief Frees the maps and the staging buffer, waits for the queue */
+    void DestroyResources();
+
+    /** @return Of one layer of a map, in bytes */
+    static VkDeviceSize GetLayerMapSize() {
+        return vkp::Texture2D::FormatToBytes(s_kMapFormat) *
+               s_kLayerSize * s_kLayerSize;
+    }
+
+private:
+    const vkp::Device& m_kDevice;
+
+    std::vector<Body> m_Bodies{ s_kDefaultBodies };
+    bool m_NeedsPrepare{ true };
+
+    // Of the distinct waves of the bodies, of the last "Prepare()"
+    std::vector<Layer> m_Layers;
+    std::vector<uint32_t> m_BodyLayers;
+
+    std::unique_ptr<vkp::Texture2DArray> m_DisplacementMaps{ nullptr };
+    std::unique_ptr<vkp::Texture2DArray> m_NormalMaps{ nullptr };
+    // Slice for each frame in flight, of all the displacement layers, then
+    //  all the normal layers
+    std::unique_ptr<vkp::Buffer> m_StagingBuffer{ nullptr };
+    VkDeviceSize m_StagingSliceSize{ 0 };
+    // Computed by the next "Update()" even if not animated
+    bool m_NeedsUpdate{ true };
+
+    uint32_t m_FrameCount{ 1 };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_BODIES_H_
@@ -0,0 +1,332 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSCascades.h"
+
+#include <imgui/imgui.h>
+
+#include <core/Profile.h>
+
+
+/** @return Highest wave number of the tile, of the Nyquist frequency */
+static float GetMaxWaveNumber(uint32_t tileSize, float tileLength)
+{
+    return glm::pi<float>() * static_cast<float>(tileSize) / tileLength;
+}
+
+// =============================================================================
+
+WSCascades::WSCascades(const vkp::Device& device)
+    : m_kDevice(device)
+{
+    VKP_REGISTER_FUNCTION();
+}
+
+WSCascades::~WSCascades()
+{
+    VKP_REGISTER_FUNCTION();
+}
+
+void WSCascades::SetCount(uint32_t count)
+{
+    count = std::min(count, s_kMaxCount);
+
+    while (m_Settings.size() < count)
+        m_Settings.push_back(s_kDefaultSettings[m_Settings.size()]);
+    m_Settings.resize(count);
+}
+
+void WSCascades::SetSettings(uint32_t index, const Settings& settings)
+{
+    VKP_ASSERT(index < m_Settings.size());
+    VKP_ASSERT(settings.tileSize > 0 && settings.tileLength > 0.0f);
+
+    m_Settings[index] = settings;
+    m_Settings[index].updateInterval = std::max(settings.updateInterval, 1u);
+}
+
+void WSCascades::Prepare(const WSTessendorf& primary)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_PROFILE_SCOPE();
+
+    DestroyResources();
+
+    const float kPrimaryLength = primary.GetTileLength();
+    // Longer waves are already in the primary's, or the previous cascade's
+    float minWaveNumber = GetMaxWaveNumber(primary.GetTileSize(),
+                                           kPrimaryLength);
+
+    for (uint32_t i = 0; i < m_Settings.size(); ++i)
+    {
+        const Settings& kSettings = m_Settings[i];
+        Cascade& cascade = m_Cascades[i];
+
+        // Of a previous preparation, only the structures of the changed
+        //  properties are recreated, e.g., not the plans on a wind change
+        if (cascade.model == nullptr)
+        {
+            cascade.model.reset( new WSTessendorf(kSettings.tileSize,
+                                                  kSettings.tileLength) );
+        }
+        auto& model = *cascade.model;
+        model.SetTileSize(kSettings.tileSize);
+        model.SetTileLength(kSettings.tileLength);
+
+        // Same spectrum, sampled at a coarser step of the wave numbers,
+        //  the amplitudes of the modes scale by its square
+        const float kStepRatio = kPrimaryLength / kSettings.tileLength;
+
+        model.SetWindDirection(primary.GetWindDir());
+        model.SetWindSpeed(primary.GetWindSpeed());
+        model.SetAnimationPeriod(primary.GetAnimationPeriod());
+        model.SetPhillipsConst(primary.GetPhillipsConst() *
+                               kStepRatio * kStepRatio);
+        model.SetDamping(primary.GetDamping());
+        model.SetLambda(primary.GetDisplacementLambda());
+        model.SetMinWaveNumber(minWaveNumber);
+        // Of other random amplitudes than the primary's, not repeating them
+        model.SetSeed(primary.GetSeed() + i + 1);
+        model.Prepare();
+
+        minWaveNumber = std::max(minWaveNumber,
+                                 GetMaxWaveNumber(kSettings.tileSize,
+                                                  kSettings.tileLength));
+
+        CreateStagingBuffer(cascade);
+        cascade.amplitude = 0.0f;
+        cascade.needsUpdate = true;
+    }
+
+    m_PreparedCount = static_cast<uint32_t>(m_Settings.size());
+    for (uint32_t i = m_PreparedCount; i < s_kMaxCount; ++i)
+        m_Cascades[i].model.reset();
+}
+
+void WSCascades::SetFrameCount(uint32_t count)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_ASSERT(count > 0);
+
+    m_FrameCount = count;
+
+    // Slices may still be read
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    for (uint32_t i = 0; i < m_PreparedCount; ++i)
+    {
+        CreateStagingBuffer(m_Cascades[i]);
+        m_Cascades[i].needsUpdate = true;
+    }
+}
+
+bool WSCascades::Update(
+    VkCommandBuffer cmdBuffer,
+    uint32_t frameIndex,
+    float time,
+    bool animate,
+    VkPipelineStageFlags dstStages
+)
+{
+    VKP_PROFILE_SCOPE();
+    VKP_ASSERT(frameIndex < m_FrameCount);
+
+    ++m_FrameCounter;
+    bool mapsCreated = false;
+
+    for (uint32_t i = 0; i < m_PreparedCount; ++i)
+    {
+        Cascade& cascade = m_Cascades[i];
+
+        if (cascade.displacementMap == nullptr)
+        {
+            CreateMaps(cmdBuffer, cascade);
+            cascade.needsUpdate = true;
+            mapsCreated = true;
+        }
+
+        const bool kIsDue =
+            animate && m_FrameCounter % m_Settings[i].updateInterval == 0;
+        if (!kIsDue && !cascade.needsUpdate)
+            continue;
+
+        UpdateCascade(cmdBuffer, cascade, frameIndex, time, dstStages);
+        cascade.needsUpdate = false;
+    }
+
+    return mapsCreated;
+}
+
+void WSCascades::GetMapDescriptors(
+    const vkp::Texture2D& fallback,
+    VkDescriptorImageInfo (&infos)[2][s_kMaxCount]
+) const
+{
+    for (uint32_t i = 0; i < s_kMaxCount; ++i)
+    {
+        const bool kIsPrepared = i < m_PreparedCount;
+        const vkp::Texture2D* maps[2] = {
+            kIsPrepared ? GetDisplacementMap(i) : nullptr,
+            kIsPrepared ? GetNormalMap(i) : nullptr
+        };
+
+        for (uint32_t j = 0; j < 2; ++j)
+        {
+            const vkp::Texture2D& kMap = maps[j] != nullptr ? *maps[j]
+                                                            : fallback;
+            infos[j][i] = kMap.GetDescriptor();
+            infos[j][i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+    }
+}
+
+glm::vec4 WSCascades::GetTileLengths() const
+{
+    glm::vec4 lengths(0.0f);
+    for (uint32_t i = 0; i < m_PreparedCount; ++i)
+        lengths[i] = m_Cascades[i].model->GetTileLength();
+
+    return lengths;
+}
+
+float WSCascades::GetAmplitude() const
+{
+    float amplitude = 0.0f;
+    for (uint32_t i = 0; i < m_PreparedCount; ++i)
+        amplitude += m_Cascades[i].amplitude;
+
+    return amplitude;
+}
+
+bool WSCascades::ShowGUISettings()
+{
+    // Waves of the primary model are the first cascade
+    int cascadeCount = static_cast<int>(GetCount()) + 1;
+    ImGui::SliderInt("Cascades", &cascadeCount, 1, s_kMaxCount + 1);
+    SetCount(static_cast<uint32_t>(cascadeCount - 1));
+
+    for (uint32_t i = 0; i < GetCount(); ++i)
+    {
+        Settings settings = GetSettings(i);
+
+        ImGui::PushID(static_cast<int>(i));
+        ImGui::Text("Cascade %u", i + 2);
+
+        int resIndex = s_kResolutions.GetIndex(settings.tileSize);
+        ImGui::Combo("Resolution", &resIndex, s_kResolutions.strings.data(),
+                     static_cast<int>(s_kResolutions.size()));
+        settings.tileSize = s_kResolutions[resIndex];
+
+        ImGui::DragFloat("Length", &settings.tileLength, 0.5f, 1.0f,
+                         1000.0f, "%.1f m");
+
+        // Applied right away, the others on "Apply Cascades"
+        int interval = static_cast<int>(settings.updateInterval);
+        ImGui::SliderInt("Update Every", &interval, 1, 8, "%d frames");
+        settings.updateInterval = static_cast<uint32_t>(interval);
+
+        SetSettings(i, settings);
+        ImGui::PopID();
+    }
+
+    return ImGui::Button("Apply Cascades");
+}
+
+void WSCascades::CreateStagingBuffer(Cascade& cascade) const
+{
+    // Slices are flushed separately
+    cascade.stagingSliceSize =
+        m_kDevice.GetNonCoherentAtomSizeAlignment(2 * GetMapSize(cascade));
+
+    cascade.stagingBuffer.reset(
+        new vkp::Buffer(m_kDevice, vkp::MemoryTag::Staging)
+    );
+    cascade.stagingBuffer->Create(cascade.stagingSliceSize * m_FrameCount,
+                                  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+    auto err = cascade.stagingBuffer->Map();
+    VKP_ASSERT_RESULT(err);
+}
+
+void WSCascades::CreateMaps(VkCommandBuffer cmdBuffer, Cascade& cascade) const
+{
+    VKP_REGISTER_FUNCTION();
+
+    const uint32_t kSize = cascade.model->GetTileSize();
+
+    // Short waves alias the most in the distance
+    cascade.displacementMap.reset(
+        new vkp::Texture2D(m_kDevice, vkp::MemoryTag::Maps)
+    );
+    cascade.displacementMap->Create(cmdBuffer, kSize, kSize, s_kMapFormat,
+                                    true);
+
+    cascade.normalMap.reset(
+        new vkp::Texture2D(m_kDevice, vkp::MemoryTag::Maps)
+    );
+    cascade.normalMap->Create(cmdBuffer, kSize, kSize, s_kMapFormat, true);
+}
+
+void WSCascades::UpdateCascade(
+    VkCommandBuffer cmdBuffer,
+    Cascade& cascade,
+    uint32_t frameIndex,
+    float time,
+    VkPipelineStageFlags dstStages)
+{
+    // Slice of the frame, its previous copies are done
+    const VkDeviceSize kSliceOffset = cascade.stagingSliceSize * frameIndex;
+    const VkDeviceSize kMapSize = GetMapSize(cascade);
+
+    uint8_t* sliceData =
+        static_cast<uint8_t*>(cascade.stagingBuffer->GetMappedAddress()) +
+        kSliceOffset;
+
+    cascade.amplitude = cascade.model->ComputeWaves(time, WSTessendorf::Outputs{
+        .displacements = sliceData,
+        .normals = sliceData + kMapSize,
+        .isHalf = true
+    });
+
+    cascade.stagingBuffer->FlushMappedRange(
+        m_kDevice.GetNonCoherentAtomSizeAlignment(2 * kMapSize),
+        kSliceOffset
+    );
+
+    // Mipmaps blitted after the copy
+    cascade.displacementMap->CopyFromBuffer(cmdBuffer,
+                                            *cascade.stagingBuffer,
+                                            true,
+                                            dstStages,
+                                            kSliceOffset);
+    cascade.normalMap->CopyFromBuffer(cmdBuffer,
+                                      *cascade.stagingBuffer,
+                                      true,
+                                      dstStages,
+                                      kSliceOffset + kMapSize);
+}
+
+void WSCascades::DestroyResources()
+{
+    bool hasResources = false;
+    for (const Cascade& kCascade : m_Cascades)
+        hasResources |= kCascade.stagingBuffer != nullptr;
+
+    if (!hasResources)
+        return;
+
+    // Maps and slices may still be read
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    for (Cascade& cascade : m_Cascades)
+    {
+        cascade.displacementMap.reset();
+        cascade.normalMap.reset();
+        cascade.stagingBuffer.reset();
+    }
+    m_PreparedCount = 0;
+}
@@ -0,0 +1,190 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_CASCADES_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_CASCADES_H_
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "vulkan/Device.h"
+#include "vulkan/Buffer.h"
+#include "vulkan/Texture2D.h"
+
+#include "scene/WSTessendorf.h"
+
+#include "Gui.h"
+
+
+/**
+ * @brief Detail cascades of the waves, added on top of those of the primary
+ *  model: each is a WSTessendorf model of its own resolution and shorter tile
+ *  length, e.g., 128^2 over 50 m with the primary's 512^2 over 1000 m. Their
+ *  sum shows the short waves the primary tile is too coarse for, and hides
+ *  the repetition of the tiles.
+ *
+ * Each cascade samples the primary's spectrum, from the wave numbers beyond
+ *  those of the previous, longer tile. Its waves are computed on the calling
+ *  thread into a staging slice of the frame, then copied to its maps on
+ *  the graphics queue, every few frames set per cascade.
+ *
+ * Maps are in RGBA16F, with mipmaps, the displacement map of xyz displacement and w
+ *  Jacobian, the normal map of the slopes and the derivatives of
+ *  the displacements, @see WSTessendorf::ComputeWaves()
+ */
+class WSCascades
+{
+public:
+    static constexpr uint32_t s_kMaxCount{ 3 };
+    static constexpr VkFormat s_kMapFormat{ VK_FORMAT_R16G16B16A16_SFLOAT };
+
+    struct Settings
+    {
+        uint32_t tileSize;
+        float tileLength;           ///< In meters
+        uint32_t updateInterval;    ///< In frames, at least 1
+    };
+
+    // Of the cascades added by "SetCount()", from the longest
+    static constexpr std::array<Settings, s_kMaxCount> s_kDefaultSettings{{
+        { 128, 50.0f, 1 },
+        { 64, 12.0f, 1 },
+        { 32, 3.0f, 2 }
+    }};
+
+    // Of the cascades' tile sizes, as those of the primary model
+    static const inline gui::ValueStringArray<uint32_t, 7> s_kResolutions{
+        { 16, 32, 64, 128, 256, 512, 1024 },
+        { "16", "32", "64", "128", "256", "512", "1024" }
+    };
+
+public:
+    explicit WSCascades(const vkp::Device& device);
+    ~WSCascades();
+
+    /**
+     * @brief Adds or removes cascades, up to s_kMaxCount, the added ones of
+     *  the default settings. Takes effect on the next "Prepare()" call
+     */
+    void SetCount(uint32_t count);
+    uint32_t GetCount() const { return static_cast<uint32_t>(m_Settings.size()); }
+
+    /** @brief Takes effect on the next "Prepare()" call */
+    void SetSettings(uint32_t index, const Settings& settings);
+    const Settings& GetSettings(uint32_t index) const {
+        return m_Settings[index];
+    }
+
+    /**
+     * @brief (Re)Creates the models of the cascades of the current settings,
+     *  with the spectrum of the primary model. Their maps are (re)created by
+     *  the next "Update()" call. Waits for the graphics queue if the maps or
+     *  the staging buffers are freed
+     * @pre The FFTW planner is not used by another thread
+     */
+    void Prepare(const WSTessendorf& primary);
+
+    /**
+     * @brief Reallocates the staging buffers of the cascades, with a slice
+     *  for each frame in flight, waits for the graphics queue
+     */
+    void SetFrameCount(uint32_t count);
+
+    /**
+     * @brief Creates the missing maps, computes the waves of the cascades due
+     *  at the frame, and records the copies to their maps
+     * @param frameIndex Its staging slices are written, its previous frame
+     *  is done
+     * @param time Elapsed time in seconds
+     * @param animate Whether the waves advance, otherwise only the cascades
+     *  not yet computed are
+     * @param dstStages Stages reading the maps
+     * @return True if maps were created, the descriptors need an update
+     */
+    bool Update(VkCommandBuffer cmdBuffer,
+                uint32_t frameIndex,
+                float time,
+                bool animate,
+                VkPipelineStageFlags dstStages);
+
+    /** @return Number of the cascades of the last "Prepare()", rendered */
+    uint32_t GetPreparedCount() const { return m_PreparedCount; }
+
+    /** @return Null if not created yet */
+    const vkp::Texture2D* GetDisplacementMap(uint32_t index) const {
+        return m_Cascades[index].displacementMap.get();
+    }
+    const vkp::Texture2D* GetNormalMap(uint32_t index) const {
+        return m_Cascades[index].normalMap.get();
+    }
+
+    /**
+     * @brief Of the maps of each cascade, by the index of the cascade, those
+     *  not created yet are replaced by 'fallback', valid yet not read
+     * @param infos Of the displacement maps, then of the normal maps
+     */
+    void GetMapDescriptors(
+        const vkp::Texture2D& fallback,
+        VkDescriptorImageInfo (&infos)[2][s_kMaxCount]) const;
+
+    /** @return Tile lengths of the cascades, zero beyond the count */
+    glm::vec4 GetTileLengths() const;
+    /** @return Sum of the cascades' amplitudes of the last waves */
+    float GetAmplitude() const;
+
+    /**
+     * @brief Of the count and the settings of the cascades, in the scope of
+     *  an ImGui window
+     * @return Whether they are to be applied by "Prepare()"
+     */
+    bool ShowGUISettings();
+
+private:
+    struct Cascade
+    {
+        std::unique_ptr<WSTessendorf> model{ nullptr };
+        std::unique_ptr<vkp::Texture2D> displacementMap{ nullptr };
+        std::unique_ptr<vkp::Texture2D> normalMap{ nullptr };
+        // Slice for each frame in flight, of the displacements and normals
+        std::unique_ptr<vkp::Buffer> stagingBuffer{ nullptr };
+        VkDeviceSize stagingSliceSize{ 0 };
+        float amplitude{ 0.0f };
+        // Computed by the next "Update()" even if not animated
+        bool needsUpdate{ true };
+    };
+
+    void CreateStagingBuffer(Cascade& cascade) const;
+    void CreateMaps(VkCommandBuffer cmdBuffer, Cascade& cascade) const;
+    void UpdateCascade(VkCommandBuffer cmdBuffer,
+                       Cascade& cascade,
+                       uint32_t frameIndex,
+                       float time,
+                       VkPipelineStageFlags dstStages);
+
+    /** @brief Frees the maps and the staging buffers, waits for the queue */
+    void DestroyResources();
+
+    /** @return Of one map of the cascade's resolution, in bytes */
+    static VkDeviceSize GetMapSize(const Cascade& cascade) {
+        return vkp::Texture2D::FormatToBytes(s_kMapFormat) *
+               cascade.model->GetDisplacementCount();
+    }
+
+private:
+    const vkp::Device& m_kDevice;
+
+    std::vector<Settings> m_Settings;
+    std::array<Cascade, s_kMaxCount> m_Cascades;
+    // Number of the prepared ones, of the settings of the last "Prepare()"
+    uint32_t m_PreparedCount{ 0 };
+
+    uint32_t m_FrameCount{ 1 };
+    // Of the "Update()" calls, cascades are due at multiples of the interval
+    uint64_t m_FrameCounter{ 0 };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_CASCADES_H_
@@ -0,0 +1,155 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSGrid.h"
+
+
+void WSGrid::Setup(uint32_t gridSize, float vertexDistance, float meshDetail)
+{
+    m_GridSize = gridSize;
+    m_VertexDistance = vertexDistance;
+    m_MeshDetail = meshDetail;
+}
+
+std::vector<vkp::ShaderInfo> WSGrid::GetShaderInfos(
+    const ShaderPaths& paths
+) const
+{
+    return { GetVertexShaderInfo(paths, GetShaderPath()) };
+}
+
+void WSGrid::SetupPipeline(vkp::Pipeline& pipeline) const
+{
+    pipeline.SetVertexInputState( vkp::Pipeline::InitVertexInput() );
+}
+
+vkp::ShaderInfo WSGrid::GetVertexShaderInfo(const ShaderPaths& paths,
+                                            std::string_view gridPath)
+{
+    return vkp::ShaderInfo(
+        { paths.vertexVersion, paths.uniforms, paths.displacement, paths.maps,
+          paths.cascades, gridPath },
+        VK_SHADER_STAGE_VERTEX_BIT,
+        false
+    );
+}
+
+bool WSGrid::IsGridVisible(
+    const vkp::Camera& camera,
+    const DisplacementBounds& bounds,
+    float halfLength
+)
+{
+    const float kHalfExtent = halfLength + bounds.margin;
+
+    return camera.IsBoxVisible(
+        glm::vec3(-kHalfExtent, bounds.minHeight, -kHalfExtent),
+        glm::vec3( kHalfExtent, bounds.maxHeight,  kHalfExtent)
+    );
+}
+
+void WSGrid::CreateInstanceBuffers(
+    uint32_t frameCount,
+    VkDeviceSize instanceSize,
+    bool hasIndirectDraw
+)
+{
+    VKP_REGISTER_FUNCTION();
+
+    m_InstanceBuffers.clear();
+    m_IndirectBuffers.clear();
+
+    m_InstanceBuffers.reserve(frameCount);
+    if (hasIndirectDraw)
+        m_IndirectBuffers.reserve(frameCount);
+
+    for (uint32_t i = 0; i < frameCount; ++i)
+    {
+        auto& buffer = m_InstanceBuffers.emplace_back(m_kDevice,
+                                                     vkp::MemoryTag::Mesh);
+
+        buffer.Create(s_kMaxInstanceCount * instanceSize,
+                      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+        auto err = buffer.Map();
+        VKP_ASSERT_RESULT(err);
+
+        if (!hasIndirectDraw)
+            continue;
+
+        auto& indirectBuffer = m_IndirectBuffers.emplace_back(
+            m_kDevice, vkp::MemoryTag::Mesh
+        );
+
+        indirectBuffer.Create(sizeof(VkDrawIndirectCommand),
+                              VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+        err = indirectBuffer.Map();
+        VKP_ASSERT_RESULT(err);
+    }
+}
+
+void WSGrid::WriteInstances(
+    uint32_t frameIndex,
+    const void* instances,
+    VkDeviceSize size
+)
+{
+    if (size == 0)
+        return;
+
+    auto& buffer = m_InstanceBuffers[frameIndex];
+    buffer.CopyToMapped(instances, size);
+    buffer.FlushMappedRange(m_kDevice.GetNonCoherentAtomSizeAlignment(size));
+}
+
+void WSGrid::WriteIndirectDraw(
+    uint32_t frameIndex,
+    uint32_t vertexCount,
+    uint32_t instanceCount
+)
+{
+    const VkDrawIndirectCommand kDraw{
+        .vertexCount = vertexCount,
+        .instanceCount = instanceCount,
+        .firstVertex = 0,
+        .firstInstance = 0
+    };
+
+    auto& buffer = m_IndirectBuffers[frameIndex];
+    buffer.CopyToMapped(&kDraw, sizeof(kDraw));
+    buffer.FlushMappedRange();
+}
+
+void WSGrid::BindInstanceBuffer(
+    uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer
+) const
+{
+    const VkBuffer kInstanceBuffers[] = { m_InstanceBuffers[frameIndex] };
+    const VkDeviceSize kOffsets[] = { 0 };
+    const uint32_t kFirstBinding = 0, kBindingCount = 1;
+
+    vkCmdBindVertexBuffers(cmdBuffer, kFirstBinding, kBindingCount,
+                           kInstanceBuffers, kOffsets);
+}
+
+void WSGrid::RecordIndirectDraw(
+    uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer
+) const
+{
+    BindInstanceBuffer(frameIndex, cmdBuffer);
+
+    const VkDeviceSize kIndirectOffset = 0;
+    const uint32_t kDrawCount = 1;
+
+    vkCmdDrawIndirect(cmdBuffer, m_IndirectBuffers[frameIndex],
+                      kIndirectOffset, kDrawCount,
+                      sizeof(VkDrawIndirectCommand));
+}
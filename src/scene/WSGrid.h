@@ -0,0 +1,204 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_GRID_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_GRID_H_
+
+#include <string_view>
+#include <vector>
+
+#include "vulkan/Device.h"
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+#include "vulkan/ShaderModule.h"
+
+#include "scene/Camera.h"
+
+
+/**
+ * @brief Grid mode of the water surface, of its own instances, culling and
+ *  draws. Its vertices are displaced by the maps bound by WaterSurfaceMesh,
+ *  which owns the descriptor sets and the pipelines of all the grid modes,
+ *  and draws the grid of the selected one.
+ *
+ * A grid of "size" quads per side, "vertexDistance" apart, centered at
+ *  the origin, is the tile of the maps. Each mode derives its vertices from
+ *  it in its vertex shader, @see GetShaderInfos()
+ */
+class WSGrid
+{
+public:
+    static constexpr uint32_t s_kMaxInstanceCount{ 4096 };
+
+    struct Instance;
+
+    /** @brief Extent of the displaced vertices beyond the flat grid */
+    struct DisplacementBounds
+    {
+        float minHeight;
+        float maxHeight;
+        float margin;       ///< Horizontal, of the choppy waves
+    };
+
+    /** @brief Of the frame being prepared */
+    struct FrameInfo
+    {
+        const vkp::Camera& camera;
+        DisplacementBounds bounds;  ///< Of the primary waves and the cascades
+        float heightAmp;            ///< Of the waves of the maps
+        float choppiness;           ///< Of the horizontal displacements
+    };
+
+    /** @brief Shared by the stages before the rasterization of all grids */
+    struct ShaderPaths
+    {
+        std::string_view version;
+        // Of the vertex stage, may write the rates of the primitives
+        std::string_view vertexVersion;
+        std::string_view uniforms;
+        std::string_view displacement;
+        std::string_view maps;      ///< Sampled, or read from the map buffer
+        std::string_view cascades;
+    };
+
+public:
+    explicit WSGrid(const vkp::Device& device) : m_kDevice(device) {}
+    virtual ~WSGrid() = default;
+
+    WSGrid(const WSGrid&) = delete;
+    WSGrid& operator=(const WSGrid&) = delete;
+
+    /**
+     * @brief Of the grid's size, or of the mesh's detail changed
+     * @param meshDetail Scale of the vertex density, 1 is the finest
+     */
+    virtual void Setup(uint32_t gridSize, float vertexDistance,
+                       float meshDetail);
+
+    /** @return Whether a coarser mesh detail reduces its vertices */
+    virtual bool CanCoarsen() const { return false; }
+
+    /** @brief Of the frames in flight, indexing the per-frame buffers */
+    virtual void SetFrameCount(uint32_t count) {}
+
+    /**
+     * @brief Culls the grid by the camera's frustum, writes what is visible
+     *  to the frame's buffers
+     * @param frameIndex Its buffers are no longer read by its previous frame
+     */
+    virtual void Update(uint32_t frameIndex, const FrameInfo& info) = 0;
+
+    /** @return Whether the last "Update()" left anything to draw */
+    virtual bool IsVisible() const { return true; }
+
+    /** @brief Records the draw of the frame, its pipeline is bound */
+    virtual void RecordDraw(uint32_t frameIndex,
+                            VkCommandBuffer cmdBuffer) const = 0;
+
+    /**
+     * @return Shaders of the stages before the rasterization, by default
+     *  the vertex stage of "GetShaderPath()"
+     * @note Called by the workers of the pipelines, only reads the paths
+     */
+    virtual std::vector<vkp::ShaderInfo> GetShaderInfos(
+        const ShaderPaths& paths) const;
+
+    /** @brief Sets the vertex input state of the grid, and the others */
+    virtual void SetupPipeline(vkp::Pipeline& pipeline) const;
+
+    /** @pre Called inside ImGui Window scope */
+    virtual void ShowGUISettings() {}
+
+    /** @return Vertex stage reading the shared paths, then 'gridPath' */
+    static vkp::ShaderInfo GetVertexShaderInfo(const ShaderPaths& paths,
+                                               std::string_view gridPath);
+
+    /**
+     * @return Whether the square of 'halfLength' centered at the origin,
+     *  grown by the displacements, intersects the camera's frustum
+     */
+    static bool IsGridVisible(const vkp::Camera& camera,
+                              const DisplacementBounds& bounds,
+                              float halfLength);
+
+    /** @return Vertices of a grid of triangles of 'size' quads per side */
+    static uint32_t GetVertexCount(uint32_t size) {
+        const uint32_t kVerticesPerQuad = 6;
+        return size * size * kVerticesPerQuad;
+    }
+
+protected:
+    /** @return Path of the vertex shader of the grid's vertices */
+    virtual std::string_view GetShaderPath() const = 0;
+
+    /**
+     * @brief (Re)Creates a mapped instance buffer for each frame, of
+     *  s_kMaxInstanceCount instances, and its indirect buffer of one draw
+     *  if 'hasIndirectDraw'
+     */
+    void CreateInstanceBuffers(uint32_t frameCount,
+                               VkDeviceSize instanceSize,
+                               bool hasIndirectDraw);
+    void WriteInstances(uint32_t frameIndex, const void* instances,
+                        VkDeviceSize size);
+    void WriteIndirectDraw(uint32_t frameIndex, uint32_t vertexCount,
+                           uint32_t instanceCount);
+    void BindInstanceBuffer(uint32_t frameIndex,
+                            VkCommandBuffer cmdBuffer) const;
+    void RecordIndirectDraw(uint32_t frameIndex,
+                            VkCommandBuffer cmdBuffer) const;
+
+protected:
+    const vkp::Device& m_kDevice;
+
+    uint32_t m_GridSize{ 1 };
+    float m_VertexDistance{ 1.0f };
+    float m_MeshDetail{ 1.0f };
+
+private:
+    std::vector<vkp::Buffer> m_InstanceBuffers;
+    // Of the instances written to each frame, empty if drawn directly
+    std::vector<vkp::Buffer> m_IndirectBuffers;
+};
+
+/**
+ * @brief Instance data of the CDLOD patches, @see CDLODQuadTree::Select(),
+ *  or of the tiles: vec4(x and z of the tile's center, 0, 0)
+ */
+struct WSGrid::Instance
+{
+    glm::vec4 data;
+
+    constexpr static VkVertexInputBindingDescription GetBindingDescription()
+    {
+        return VkVertexInputBindingDescription {
+            .binding = 0,
+            .stride = sizeof(Instance),
+            .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+        };
+    }
+
+    static std::vector<VkVertexInputAttributeDescription>
+        GetAttributeDescriptions()
+    {
+        return std::vector<VkVertexInputAttributeDescription> {
+            {
+                .location = 0,
+                .binding = 0,
+                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                .offset = offsetof(Instance, data)
+            }
+        };
+    }
+
+    static const inline std::vector<VkVertexInputBindingDescription>
+        s_BindingDescriptions{ GetBindingDescription() };
+
+    static const inline std::vector<VkVertexInputAttributeDescription>
+        s_AttribDescriptions{ GetAttributeDescriptions() };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_GRID_H_
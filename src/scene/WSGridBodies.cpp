@@ -0,0 +1,127 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSGridBodies.h"
+
+#include <imgui/imgui.h>
+
+#include <core/Profile.h>
+
+
+void WSGridBodies::SetFrameCount(uint32_t count)
+{
+    static_assert(WSBodies::s_kMaxBodyCount * sizeof(BodyInstance) <=
+                  s_kMaxInstanceCount * sizeof(Instance));
+
+    // Of the same size as those of the other grids
+    CreateInstanceBuffers(count, sizeof(Instance), true);
+}
+
+void WSGridBodies::Update(uint32_t frameIndex, const FrameInfo& info)
+{
+    VKP_PROFILE_SCOPE();
+
+    // Of the highest waves of the layers, of any body
+    const float kAmplitude = info.heightAmp * m_Bodies.GetAmplitude();
+    const float kMargin =
+        kAmplitude * glm::max(1.0f, glm::abs(info.choppiness));
+
+    m_Instances.clear();
+    const auto& kBodies = m_Bodies.GetBodies();
+    for (uint32_t i = 0; i < kBodies.size(); ++i)
+    {
+        const WSBodies::Body& kBody = kBodies[i];
+
+        const glm::vec2 kMin = kBody.center - kBody.halfExtent - kMargin;
+        const glm::vec2 kMax = kBody.center + kBody.halfExtent + kMargin;
+        if (!info.camera.IsBoxVisible(glm::vec3(kMin.x, -kAmplitude, kMin.y),
+                                      glm::vec3(kMax.x, kAmplitude, kMax.y)))
+            continue;
+
+        const uint32_t kLayer = m_Bodies.GetLayer(i);
+        m_Instances.emplace_back(kBody.center, kBody.halfExtent);
+        m_Instances.emplace_back(static_cast<float>(kLayer),
+                                 m_Bodies.GetLayerTileLength(kLayer),
+                                 0.0f, 0.0f);
+    }
+    m_InstanceCount = static_cast<uint32_t>(m_Instances.size() / 2);
+
+    // All the bodies by one draw, of the same grid
+    WriteInstances(frameIndex, m_Instances.data(),
+                   m_InstanceCount * sizeof(BodyInstance));
+    WriteIndirectDraw(frameIndex, GetVertexCount(m_BodyGridSize),
+                      m_InstanceCount);
+}
+
+void WSGridBodies::RecordDraw(
+    uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer
+) const
+{
+    RecordIndirectDraw(frameIndex, cmdBuffer);
+}
+
+std::vector<vkp::ShaderInfo> WSGridBodies::GetShaderInfos(
+    const ShaderPaths& paths
+) const
+{
+    // Bodies read the layers of their own waves, of either variant
+    ShaderPaths layeredPaths = paths;
+    layeredPaths.maps = "shaders/WaterSurfaceMeshMapsLayered.vert";
+
+    return WSGrid::GetShaderInfos(layeredPaths);
+}
+
+void WSGridBodies::SetupPipeline(vkp::Pipeline& pipeline) const
+{
+    pipeline.SetVertexInputState(
+        vkp::Pipeline::InitVertexInput(BodyInstance::s_BindingDescriptions,
+                                       BodyInstance::s_AttribDescriptions)
+    );
+}
+
+void WSGridBodies::ShowGUISettings()
+{
+    int gridSize = m_BodyGridSize;
+    ImGui::SliderInt("Quads per Side", &gridSize, 1, 256);
+    m_BodyGridSize = gridSize;
+
+    // Waves are applied by the next "PrepareRender()", the rectangles
+    //  right away
+    int removed = -1;
+    for (uint32_t i = 0; i < m_Bodies.GetBodyCount(); ++i)
+    {
+        WSBodies::Body body = m_Bodies.GetBodies()[i];
+
+        ImGui::PushID(static_cast<int>(i));
+        ImGui::Text("Body %u", i + 1);
+        ImGui::DragFloat2("Center", &body.center[0], 1.0f);
+        ImGui::DragFloat2("Half Extent", &body.halfExtent[0], 0.5f, 1.0f,
+                          5000.0f, "%.1f m");
+        ImGui::DragFloat("Tile Length", &body.waves.tileLength, 0.5f,
+                         1.0f, 1000.0f, "%.1f m");
+        ImGui::DragFloat("Wind Speed", &body.waves.windSpeed, 0.1f, 0.1f,
+                         100.0f, "%.1f m/s");
+        m_Bodies.SetBody(i, body);
+
+        if (m_Bodies.GetBodyCount() > 1 && ImGui::Button("Remove"))
+            removed = static_cast<int>(i);
+        ImGui::PopID();
+    }
+    if (removed >= 0)
+        m_Bodies.RemoveBody(static_cast<uint32_t>(removed));
+
+    // Of the same waves as the last one, beside it
+    if (ImGui::Button("Add Body"))
+    {
+        WSBodies::Body body = m_Bodies.GetBodies().back();
+        body.center.x += 2.0f * body.halfExtent.x + 10.0f;
+        m_Bodies.AddBody(body);
+    }
+
+    ImGui::Text("Visible Bodies: %u of %u, Layers: %u", m_InstanceCount,
+                m_Bodies.GetBodyCount(), m_Bodies.GetLayerCount());
+}
@@ -0,0 +1,107 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_GRID_BODIES_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_GRID_BODIES_H_
+
+#include "scene/WSGrid.h"
+#include "scene/WSBodies.h"
+
+
+/**
+ * @brief Instances of a grid stretched over each water body's rectangle,
+ *  of the layer of its waves, @see WSBodies. Bodies out of the frustum are
+ *  culled, the visible ones are drawn by one indirect draw
+ */
+class WSGridBodies : public WSGrid
+{
+public:
+    struct BodyInstance;
+
+public:
+    /** @param bodies Simulated and prepared by WaterSurfaceMesh */
+    WSGridBodies(const vkp::Device& device, WSBodies& bodies)
+        : WSGrid(device), m_Bodies(bodies) {}
+
+    void SetFrameCount(uint32_t count) override;
+
+    /**
+     * @brief Writes the water bodies visible by the camera to the frame's
+     *  instance buffer, and their draw to its indirect buffer
+     */
+    void Update(uint32_t frameIndex, const FrameInfo& info) override;
+    void RecordDraw(uint32_t frameIndex,
+                    VkCommandBuffer cmdBuffer) const override;
+
+    /** @brief Of the maps of the layers, instead of the shared maps */
+    std::vector<vkp::ShaderInfo> GetShaderInfos(
+        const ShaderPaths& paths) const override;
+    void SetupPipeline(vkp::Pipeline& pipeline) const override;
+    void ShowGUISettings() override;
+
+    /** @return Quads per side of each body, of its own size */
+    uint32_t GetBodyGridSize() const { return m_BodyGridSize; }
+
+protected:
+    std::string_view GetShaderPath() const override {
+        return "shaders/WaterSurfaceMeshGridBodies.vert";
+    }
+
+private:
+    WSBodies& m_Bodies;
+    uint32_t m_BodyGridSize{ 64 };
+
+    // Two vec4 per body, @see BodyInstance
+    std::vector<glm::vec4> m_Instances;
+    // Of the last frame
+    uint32_t m_InstanceCount{ 0 };
+};
+
+/**
+ * @brief Instance data of the water bodies: vec4(x and z of the center,
+ *  x and z of the half extent), vec4(layer of the waves, tile length, 0, 0)
+ */
+struct WSGridBodies::BodyInstance
+{
+    glm::vec4 rect;
+    glm::vec4 waves;
+
+    constexpr static VkVertexInputBindingDescription GetBindingDescription()
+    {
+        return VkVertexInputBindingDescription {
+            .binding = 0,
+            .stride = sizeof(BodyInstance),
+            .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+        };
+    }
+
+    static std::vector<VkVertexInputAttributeDescription>
+        GetAttributeDescriptions()
+    {
+        return std::vector<VkVertexInputAttributeDescription> {
+            {
+                .location = 0,
+                .binding = 0,
+                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                .offset = offsetof(BodyInstance, rect)
+            },
+            {
+                .location = 1,
+                .binding = 0,
+                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                .offset = offsetof(BodyInstance, waves)
+            }
+        };
+    }
+
+    static const inline std::vector<VkVertexInputBindingDescription>
+        s_BindingDescriptions{ GetBindingDescription() };
+
+    static const inline std::vector<VkVertexInputAttributeDescription>
+        s_AttribDescriptions{ GetAttributeDescriptions() };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_GRID_BODIES_H_
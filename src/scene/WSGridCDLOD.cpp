@@ -0,0 +1,100 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSGridCDLOD.h"
+
+#include <imgui/imgui.h>
+
+#include <core/Profile.h>
+
+
+void WSGridCDLOD::Setup(
+    uint32_t gridSize,
+    float vertexDistance,
+    float meshDetail
+)
+{
+    WSGrid::Setup(gridSize, vertexDistance, meshDetail);
+    SetupQuadTree();
+}
+
+bool WSGridCDLOD::CanCoarsen() const
+{
+    return m_LodRangeFactor * m_MeshDetail > CDLODQuadTree::s_kMinRangeFactor;
+}
+
+void WSGridCDLOD::SetFrameCount(uint32_t count)
+{
+    // Of the patch count of each frame, drawn directly
+    CreateInstanceBuffers(count, sizeof(Instance), false);
+}
+
+void WSGridCDLOD::Update(uint32_t frameIndex, const FrameInfo& info)
+{
+    VKP_PROFILE_SCOPE();
+
+    const DisplacementBounds& kBounds = info.bounds;
+
+    m_InstanceCount = m_QuadTree.Select(info.camera.GetPosition(),
+                                        info.camera.GetFrustum(),
+                                        kBounds.minHeight, kBounds.maxHeight,
+                                        kBounds.margin, s_kMaxInstanceCount,
+                                        m_Instances);
+
+    WriteInstances(frameIndex, m_Instances.data(),
+                   m_InstanceCount * sizeof(Instance));
+}
+
+void WSGridCDLOD::RecordDraw(
+    uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer
+) const
+{
+    BindInstanceBuffer(frameIndex, cmdBuffer);
+
+    const uint32_t kFirstVertex = 0, kFirstInstance = 0;
+
+    vkCmdDraw(cmdBuffer, GetVertexCount(GetPatchSize()), m_InstanceCount,
+              kFirstVertex, kFirstInstance);
+}
+
+void WSGridCDLOD::SetupPipeline(vkp::Pipeline& pipeline) const
+{
+    pipeline.SetVertexInputState(
+        vkp::Pipeline::InitVertexInput(Instance::s_BindingDescriptions,
+                                       Instance::s_AttribDescriptions)
+    );
+}
+
+void WSGridCDLOD::ShowGUISettings()
+{
+    if (ImGui::DragFloat("LOD Range", &m_LodRangeFactor, 0.1f,
+                         CDLODQuadTree::s_kMinRangeFactor, 100.0f))
+    {
+        SetupQuadTree();
+    }
+    ImGui::Text("Levels: %u, Patches: %u", m_QuadTree.GetLevelCount(),
+                m_InstanceCount);
+}
+
+void WSGridCDLOD::SetupQuadTree()
+{
+    // Levels down to the grid's vertex distance, for power of two sizes
+    const uint32_t kPatchSize = GetPatchSize();
+    uint32_t levelCount = 1;
+    while ((kPatchSize << levelCount) <= m_GridSize &&
+           levelCount < CDLODQuadTree::s_kMaxLevelCount)
+    {
+        ++levelCount;
+    }
+
+    // Of a coarser detail, the finer levels are of shorter ranges
+    const float kRangeFactor =
+        glm::max(m_LodRangeFactor * m_MeshDetail,
+                 CDLODQuadTree::s_kMinRangeFactor);
+
+    m_QuadTree.Setup(m_GridSize * m_VertexDistance, levelCount, kRangeFactor);
+}
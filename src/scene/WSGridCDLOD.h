@@ -0,0 +1,68 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_GRID_CDLOD_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_GRID_CDLOD_H_
+
+#include "scene/WSGrid.h"
+#include "scene/CDLODQuadTree.h"
+
+
+/**
+ * @brief Patch instances of a quadtree over the grid, selected by their
+ *  distance to the camera and culled by its frustum, @see CDLODQuadTree.
+ *  Each frame's patches are drawn by one instanced draw
+ */
+class WSGridCDLOD : public WSGrid
+{
+public:
+    // Quads per side of a patch, fewer if the grid is smaller
+    static constexpr uint32_t s_kPatchSize{ 32 };
+
+public:
+    explicit WSGridCDLOD(const vkp::Device& device) : WSGrid(device) {}
+
+    void Setup(uint32_t gridSize, float vertexDistance,
+               float meshDetail) override;
+    /** @brief Finer levels are not yet at their shortest ranges */
+    bool CanCoarsen() const override;
+    void SetFrameCount(uint32_t count) override;
+
+    /** @brief Selects the visible patches, writes them to the frame's buffer */
+    void Update(uint32_t frameIndex, const FrameInfo& info) override;
+    bool IsVisible() const override { return m_InstanceCount > 0; }
+    void RecordDraw(uint32_t frameIndex,
+                    VkCommandBuffer cmdBuffer) const override;
+
+    void SetupPipeline(vkp::Pipeline& pipeline) const override;
+    void ShowGUISettings() override;
+
+    /** @return Range of the finest level, doubled by each coarser one */
+    float GetFinestRange() const { return m_QuadTree.GetFinestRange(); }
+    uint32_t GetPatchSize() const {
+        return std::min(s_kPatchSize, m_GridSize);
+    }
+
+protected:
+    std::string_view GetShaderPath() const override {
+        return "shaders/WaterSurfaceMeshGridCDLOD.vert";
+    }
+
+private:
+    /** @brief Levels of the quadtree for the current resolution */
+    void SetupQuadTree();
+
+private:
+    // Grid of m_GridSize quads, its finest level at m_VertexDistance
+    CDLODQuadTree m_QuadTree;
+    float m_LodRangeFactor{ 2.0f * CDLODQuadTree::s_kMinRangeFactor };
+
+    std::vector<glm::vec4> m_Instances;
+    // Of the last frame
+    uint32_t m_InstanceCount{ 0 };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_GRID_CDLOD_H_
@@ -0,0 +1,55 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSGridProjected.h"
+
+#include <imgui/imgui.h>
+
+
+void WSGridProjected::SetFramebufferExtent(const VkExtent2D& extent)
+{
+    m_FramebufferExtent = extent;
+    UpdateSize();
+}
+
+void WSGridProjected::RecordDraw(
+    uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer
+) const
+{
+    const uint32_t kQuadCount = m_ColumnCount * m_RowCount;
+    const uint32_t kVerticesPerQuad = 6, kInstanceCount = 1;
+    const uint32_t kFirstVertex = 0, kFirstInstance = 0;
+
+    vkCmdDraw(cmdBuffer, kQuadCount * kVerticesPerQuad, kInstanceCount,
+              kFirstVertex, kFirstInstance);
+}
+
+void WSGridProjected::ShowGUISettings()
+{
+    int pixelsPerQuad = m_PixelsPerQuad;
+    if (ImGui::SliderInt("Pixels per Quad", &pixelsPerQuad, 1, 64))
+    {
+        m_PixelsPerQuad = pixelsPerQuad;
+        UpdateSize();
+    }
+    ImGui::DragFloat("Max Distance", &m_MaxDistance, 10.0f, 100.0f,
+                     100000.0f);
+
+    ImGui::Text("Grid: %u x %u quads", m_ColumnCount, m_RowCount);
+}
+
+void WSGridProjected::UpdateSize()
+{
+    const float kScale = s_kOverscan / static_cast<float>(m_PixelsPerQuad);
+
+    m_ColumnCount = std::max(1u, static_cast<uint32_t>(
+        glm::ceil(m_FramebufferExtent.width * kScale)
+    ));
+    m_RowCount = std::max(1u, static_cast<uint32_t>(
+        glm::ceil(m_FramebufferExtent.height * kScale)
+    ));
+}
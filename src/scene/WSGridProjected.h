@@ -0,0 +1,63 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_GRID_PROJECTED_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_GRID_PROJECTED_H_
+
+#include "scene/WSGrid.h"
+
+
+/**
+ * @brief Grid of the screen, of a constant size of its quads in pixels,
+ *  projected onto the water plane by the vertex stage, up to a maximum
+ *  distance. It is always in the view, drawn directly without instances
+ */
+class WSGridProjected : public WSGrid
+{
+public:
+    // Grid extends beyond the screen, the displaced vertices at the borders
+    //  move into the view
+    static constexpr float s_kOverscan{ 1.1f };
+
+public:
+    explicit WSGridProjected(const vkp::Device& device) : WSGrid(device) {}
+
+    /** @brief Of the quads of the grid, in pixels of the framebuffer */
+    void SetFramebufferExtent(const VkExtent2D& extent);
+
+    /** @brief Of the screen, there is nothing to cull */
+    void Update(uint32_t frameIndex, const FrameInfo& info) override {}
+    void RecordDraw(uint32_t frameIndex,
+                    VkCommandBuffer cmdBuffer) const override;
+
+    void ShowGUISettings() override;
+
+    /** @return Quads per row and per column of the screen */
+    uint32_t GetColumnCount() const { return m_ColumnCount; }
+    uint32_t GetRowCount() const { return m_RowCount; }
+    /** @return Of the vertices at the horizon */
+    float GetMaxDistance() const { return m_MaxDistance; }
+
+protected:
+    std::string_view GetShaderPath() const override {
+        return "shaders/WaterSurfaceMeshGridProjected.vert";
+    }
+
+private:
+    /** @brief Quads of the grid for the framebuffer's size */
+    void UpdateSize();
+
+private:
+    VkExtent2D m_FramebufferExtent{ 1, 1 };
+    // Of the quads, in pixels of the framebuffer
+    uint32_t m_PixelsPerQuad{ 8 };
+    float m_MaxDistance{ 10000.0f };
+
+    uint32_t m_ColumnCount{ 1 };
+    uint32_t m_RowCount{ 1 };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_GRID_PROJECTED_H_
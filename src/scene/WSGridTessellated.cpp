@@ -0,0 +1,70 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSGridTessellated.h"
+
+#include <imgui/imgui.h>
+
+#include <core/Profile.h>
+
+
+void WSGridTessellated::Update(uint32_t frameIndex, const FrameInfo& info)
+{
+    VKP_PROFILE_SCOPE();
+
+    const float kHalfLength = 0.5f * m_GridSize * m_VertexDistance;
+    m_IsVisible = IsGridVisible(info.camera, info.bounds, kHalfLength);
+}
+
+void WSGridTessellated::RecordDraw(
+    uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer
+) const
+{
+    const uint32_t kInstanceCount = 1;
+    const uint32_t kFirstVertex = 0, kFirstInstance = 0;
+
+    vkCmdDraw(cmdBuffer, GetPatchCount() * s_kControlPointsPerPatch,
+              kInstanceCount, kFirstVertex, kFirstInstance);
+}
+
+std::vector<vkp::ShaderInfo> WSGridTessellated::GetShaderInfos(
+    const ShaderPaths& paths
+) const
+{
+    // Displaced in the evaluation stage, of the patches' control points
+    return {
+        vkp::ShaderInfo(
+            { paths.version, paths.uniforms,
+              "shaders/WaterSurfaceMeshTess.vert" },
+            VK_SHADER_STAGE_VERTEX_BIT,
+            false
+        ),
+        vkp::ShaderInfo(
+            { paths.version, paths.uniforms,
+              "shaders/WaterSurfaceMeshTess.tesc" },
+            VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+            false
+        ),
+        vkp::ShaderInfo(
+            { paths.version, paths.uniforms, paths.displacement, paths.maps,
+              paths.cascades, GetShaderPath() },
+            VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
+            false
+        )
+    };
+}
+
+void WSGridTessellated::SetupPipeline(vkp::Pipeline& pipeline) const
+{
+    pipeline.SetVertexInputState( vkp::Pipeline::InitVertexInput() );
+    pipeline.SetTessellationState(s_kControlPointsPerPatch);
+}
+
+void WSGridTessellated::ShowGUISettings()
+{
+    ImGui::DragFloat("Edge Length (px)", &m_EdgeLength, 0.1f, 1.0f, 256.0f);
+}
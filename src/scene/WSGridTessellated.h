@@ -0,0 +1,68 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_GRID_TESSELLATED_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_GRID_TESSELLATED_H_
+
+#include "scene/WSGrid.h"
+
+
+/**
+ * @brief Coarse patches of the grid, subdivided by the tessellation stages
+ *  so that their edges are of a constant screen size, displaced in the
+ *  evaluation stage. Its pipelines need the tessellation shaders
+ */
+class WSGridTessellated : public WSGrid
+{
+public:
+    // Quads per side of a patch, fewer if the grid is smaller
+    static constexpr uint32_t s_kPatchSize{ 16 };
+
+public:
+    explicit WSGridTessellated(const vkp::Device& device) : WSGrid(device) {}
+
+    /** @brief Coarser details lengthen the edges */
+    bool CanCoarsen() const override { return true; }
+
+    /** @brief Culls the whole grid, by its bounds grown by the waves */
+    void Update(uint32_t frameIndex, const FrameInfo& info) override;
+    bool IsVisible() const override { return m_IsVisible; }
+    void RecordDraw(uint32_t frameIndex,
+                    VkCommandBuffer cmdBuffer) const override;
+
+    /** @return Control points by the vertex stage, displaced by the last */
+    std::vector<vkp::ShaderInfo> GetShaderInfos(
+        const ShaderPaths& paths) const override;
+    void SetupPipeline(vkp::Pipeline& pipeline) const override;
+    void ShowGUISettings() override;
+
+    uint32_t GetPatchSize() const {
+        return std::min(s_kPatchSize, m_GridSize);
+    }
+    /** @return Of the subdivided edges, in px, of the mesh's detail */
+    float GetEdgeLength() const { return m_EdgeLength / m_MeshDetail; }
+
+protected:
+    std::string_view GetShaderPath() const override {
+        return "shaders/WaterSurfaceMeshGridTessellated.tese";
+    }
+
+private:
+    uint32_t GetPatchCount() const {
+        const uint32_t kPatchesPerSide = m_GridSize / GetPatchSize();
+        return kPatchesPerSide * kPatchesPerSide;
+    }
+
+private:
+    static constexpr uint32_t s_kControlPointsPerPatch{ 4 };
+
+    // Of the finest detail, in px
+    float m_EdgeLength{ 16.0f };
+    // Of the last frame, whether the grid is in the frustum
+    bool m_IsVisible{ true };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_GRID_TESSELLATED_H_
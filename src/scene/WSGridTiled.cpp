@@ -0,0 +1,86 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSGridTiled.h"
+
+#include <imgui/imgui.h>
+
+#include <core/Profile.h>
+
+
+void WSGridTiled::SetFrameCount(uint32_t count)
+{
+    CreateInstanceBuffers(count, sizeof(Instance), true);
+}
+
+void WSGridTiled::Update(uint32_t frameIndex, const FrameInfo& info)
+{
+    VKP_PROFILE_SCOPE();
+
+    const glm::vec3& camPos = info.camera.GetPosition();
+    const DisplacementBounds& kBounds = info.bounds;
+
+    // Whole tiles, so that the maps repeat seamlessly
+    const float kTileLength = m_GridSize * m_VertexDistance;
+    const glm::vec2 kCenterTile = glm::floor(
+        glm::vec2(camPos.x, camPos.z) / kTileLength + 0.5f
+    );
+    const float kHalfExtent = 0.5f * kTileLength + kBounds.margin;
+    const int32_t kFirstTile = -static_cast<int32_t>(m_TileCount / 2);
+    const int32_t kEndTile = kFirstTile + static_cast<int32_t>(m_TileCount);
+
+    m_Instances.clear();
+    for (int32_t z = kFirstTile; z < kEndTile; ++z)
+    {
+        for (int32_t x = kFirstTile; x < kEndTile; ++x)
+        {
+            const glm::vec2 kCenter =
+                (kCenterTile + glm::vec2(x, z)) * kTileLength;
+
+            const glm::vec3 kBoxMin(kCenter.x - kHalfExtent,
+                                    kBounds.minHeight,
+                                    kCenter.y - kHalfExtent);
+            const glm::vec3 kBoxMax(kCenter.x + kHalfExtent,
+                                    kBounds.maxHeight,
+                                    kCenter.y + kHalfExtent);
+
+            if (info.camera.IsBoxVisible(kBoxMin, kBoxMax))
+                m_Instances.emplace_back(kCenter.x, kCenter.y, 0.0f, 0.0f);
+        }
+    }
+    m_InstanceCount = static_cast<uint32_t>(m_Instances.size());
+
+    WriteInstances(frameIndex, m_Instances.data(),
+                   m_InstanceCount * sizeof(Instance));
+    WriteIndirectDraw(frameIndex, GetVertexCount(m_GridSize),
+                      m_InstanceCount);
+}
+
+void WSGridTiled::RecordDraw(
+    uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer
+) const
+{
+    RecordIndirectDraw(frameIndex, cmdBuffer);
+}
+
+void WSGridTiled::SetupPipeline(vkp::Pipeline& pipeline) const
+{
+    pipeline.SetVertexInputState(
+        vkp::Pipeline::InitVertexInput(Instance::s_BindingDescriptions,
+                                       Instance::s_AttribDescriptions)
+    );
+}
+
+void WSGridTiled::ShowGUISettings()
+{
+    int tileCount = m_TileCount;
+    ImGui::SliderInt("Tiles per Side", &tileCount, 1, s_kMaxTileCount);
+    m_TileCount = tileCount;
+
+    ImGui::Text("Visible Tiles: %u of %u", m_InstanceCount,
+                m_TileCount * m_TileCount);
+}
@@ -0,0 +1,54 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_GRID_TILED_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_GRID_TILED_H_
+
+#include "scene/WSGrid.h"
+
+
+/**
+ * @brief Instances of the whole grid, tiled around the camera's tile, so
+ *  that the maps repeat seamlessly. Tiles out of the frustum are culled,
+ *  the visible ones are drawn by one indirect draw
+ */
+class WSGridTiled : public WSGrid
+{
+public:
+    // Tiles per side, centered at the camera's tile
+    static constexpr uint32_t s_kMaxTileCount{ 31 };
+    static_assert(s_kMaxTileCount * s_kMaxTileCount <= s_kMaxInstanceCount);
+
+public:
+    explicit WSGridTiled(const vkp::Device& device) : WSGrid(device) {}
+
+    void SetFrameCount(uint32_t count) override;
+
+    /**
+     * @brief Writes the tiles visible by the camera to the frame's instance
+     *  buffer, and their draw to its indirect buffer
+     */
+    void Update(uint32_t frameIndex, const FrameInfo& info) override;
+    void RecordDraw(uint32_t frameIndex,
+                    VkCommandBuffer cmdBuffer) const override;
+
+    void SetupPipeline(vkp::Pipeline& pipeline) const override;
+    void ShowGUISettings() override;
+
+protected:
+    std::string_view GetShaderPath() const override {
+        return "shaders/WaterSurfaceMeshGridTiled.vert";
+    }
+
+private:
+    uint32_t m_TileCount{ 9 };
+
+    std::vector<glm::vec4> m_Instances;
+    // Of the last frame
+    uint32_t m_InstanceCount{ 0 };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_GRID_TILED_H_
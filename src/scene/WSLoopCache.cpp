@@ -0,0 +1,262 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSLoopCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#ifdef _WIN32
+    // Read into memory
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+// Written and mapped as is
+static_assert(std::is_trivially_copyable_v<WSLoopCache::Header>);
+static_assert(sizeof(WSLoopCache::Header) == 96);
+static_assert(sizeof(WSLoopCache::Header) <= WSLoopCache::s_kChunkAlignment);
+
+namespace
+{
+    void HashBytes(uint64_t& hash, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+    }
+
+    template<typename T>
+    void HashValue(uint64_t& hash, const T& value)
+    {
+        HashBytes(hash, &value, sizeof(T));
+    }
+
+    uint64_t AlignUp(uint64_t size, uint64_t alignment)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+}
+
+WSLoopCache::Header WSLoopCache::GetHeader(
+    const WSTessendorf& model,
+    uint32_t frameCount,
+    bool isHalf,
+    bool hasNormals
+)
+{
+    const uint64_t kMapSize = (isHalf ? 8 : 16) * model.GetDisplacementCount();
+
+    Header header{
+        .tileSize = model.GetTileSize(),
+        .frameCount = frameCount,
+        .isHalf = isHalf,
+        .hasNormals = hasNormals,
+        .tileLength = model.GetTileLength(),
+        .windDir = { model.GetWindDir().x, model.GetWindDir().y },
+        .windSpeed = model.GetWindSpeed(),
+        .animationPeriod = model.GetAnimationPeriod(),
+        .phillipsConst = model.GetPhillipsConst(),
+        .damping = model.GetDamping(),
+        .minWaveNumber = model.GetMinWaveNumber(),
+        .seed = model.GetSeed(),
+        .mapSize = kMapSize,
+        .frameStride = AlignUp(hasNormals ? 2 * kMapSize : kMapSize,
+                               s_kChunkAlignment)
+    };
+    header.hash = GetHash(header);
+    return header;
+}
+
+uint64_t WSLoopCache::GetHash(const Header& header)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    HashValue(hash, header.version);
+    HashValue(hash, header.tileSize);
+    HashValue(hash, header.frameCount);
+    HashValue(hash, header.isHalf);
+    HashValue(hash, header.hasNormals);
+    HashValue(hash, header.tileLength);
+    HashValue(hash, header.windDir);
+    HashValue(hash, header.windSpeed);
+    HashValue(hash, header.animationPeriod);
+    HashValue(hash, header.phillipsConst);
+    HashValue(hash, header.damping);
+    HashValue(hash, header.minWaveNumber);
+    HashValue(hash, header.seed);
+    return hash;
+}
+
+bool WSLoopCache::Write(
+    const std::filesystem::path& path,
+    const Header& header,
+    const uint8_t* frames,
+    uint64_t stride
+)
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Renamed once complete, a partial file is never opened
+    std::filesystem::path tmpPath = path;
+    tmpPath += ".tmp";
+
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            VKP_LOG_ERR("Loop cache: failed to write: {}", tmpPath.string());
+            return false;
+        }
+
+        const uint64_t kFrameSize = header.hasNormals ? 2 * header.mapSize
+                                                      : header.mapSize;
+        const std::vector<char> kPadding(s_kChunkAlignment, 0);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(kPadding.data(), s_kChunkAlignment - sizeof(Header));
+
+        for (uint32_t i = 0; i < header.frameCount; ++i)
+        {
+            file.write(reinterpret_cast<const char*>(frames + stride * i),
+                       kFrameSize);
+            // Last one is not padded
+            if (i + 1 < header.frameCount)
+                file.write(kPadding.data(), header.frameStride - kFrameSize);
+        }
+
+        if (!file)
+        {
+            VKP_LOG_ERR("Loop cache: failed to write: {}", tmpPath.string());
+            return false;
+        }
+    }
+
+    std::error_code err;
+    std::filesystem::rename(tmpPath, path, err);
+    if (err)
+    {
+        VKP_LOG_ERR("Loop cache: failed to rename to: {}, {}", path.string(),
+                    err.message());
+        return false;
+    }
+    return true;
+}
+
+WSLoopCache::~WSLoopCache()
+{
+    Close();
+}
+
+bool WSLoopCache::Open(const std::filesystem::path& path,
+                       const Header& expected)
+{
+    VKP_REGISTER_FUNCTION();
+
+    Close();
+
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    m_Contents.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(m_Contents.data()), m_Contents.size());
+    if (!file)
+    {
+        m_Contents.clear();
+        return false;
+    }
+    m_Data = m_Contents.data();
+    m_Size = m_Contents.size();
+#else
+    const int kFd = ::open(path.c_str(), O_RDONLY);
+    if (kFd < 0)
+        return false;
+
+    struct stat info{};
+    void* data = MAP_FAILED;
+    if (::fstat(kFd, &info) == 0 && info.st_size > 0)
+    {
+        data = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                      MAP_PRIVATE, kFd, 0);
+    }
+    // Mapping holds its own reference to the file
+    ::close(kFd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    // Frames are copied from in order, once
+    ::madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+    m_Data = static_cast<const uint8_t*>(data);
+    m_Size = static_cast<size_t>(info.st_size);
+#endif
+
+    if (m_Size < sizeof(Header))
+    {
+        VKP_LOG_WARN("Loop cache: truncated: {}", path.string());
+        Close();
+        return false;
+    }
+    std::memcpy(&m_Header, m_Data, sizeof(Header));
+
+    const bool kIsSame =
+        std::memcmp(m_Header.magic, expected.magic, sizeof(m_Header.magic))
+            == 0 &&
+        m_Header.version == expected.version &&
+        m_Header.hash == expected.hash &&
+        m_Header.hash == GetHash(m_Header) &&
+        m_Header.mapSize == expected.mapSize &&
+        m_Header.frameStride == expected.frameStride;
+    if (!kIsSame)
+    {
+        VKP_LOG_INFO("Loop cache: of other parameters: {}", path.string());
+        Close();
+        return false;
+    }
+
+    const uint64_t kFrameSize = m_Header.hasNormals ? 2 * m_Header.mapSize
+                                                    : m_Header.mapSize;
+    const uint64_t kSize = s_kChunkAlignment +
+                           m_Header.frameStride * m_Header.frameCount -
+                           (m_Header.frameStride - kFrameSize);
+    if (m_Header.frameCount == 0 || m_Size < kSize)
+    {
+        VKP_LOG_WARN("Loop cache: truncated: {}", path.string());
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void WSLoopCache::Close()
+{
+#ifndef _WIN32
+    if (m_Data != nullptr)
+        ::munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+    m_Contents.clear();
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+const uint8_t* WSLoopCache::GetFrame(uint32_t index) const
+{
+    VKP_ASSERT(IsOpen() && index < m_Header.frameCount);
+    return m_Data + s_kChunkAlignment + m_Header.frameStride * index;
+}
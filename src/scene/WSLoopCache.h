@@ -0,0 +1,109 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_LOOP_CACHE_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_LOOP_CACHE_H_
+
+#include <filesystem>
+#include <vector>
+
+#include "scene/WSTessendorf.h"
+
+
+/**
+ * @brief File of the waves of one animation period, baked by the mesh, so
+ *  that the next run maps it instead of computing the waves again.
+ *
+ * Layout, little-endian:
+ *  --------------------------------------------------------------
+ * | Header | pad | Frame 0 | pad | Frame 1 | pad | ... | Frame N-1 |
+ *  --------------------------------------------------------------
+ *  Each frame starts at a multiple of s_kChunkAlignment, of the
+ *  displacements, then the normals if any, in the map format (half or
+ *  single floats). Pages of a frame are read only once it is copied from.
+ *
+ * The header records the model's parameters and their hash, a file of
+ *  other parameters, or of another version, is not opened.
+ */
+class WSLoopCache
+{
+public:
+    static constexpr uint32_t s_kVersion{ 1 };
+    static constexpr uint64_t s_kChunkAlignment{ 64 * 1024 };
+
+    struct Header
+    {
+        char magic[4]{ 'W', 'S', 'L', 'C' };
+        uint32_t version{ s_kVersion };
+        uint64_t hash{ 0 };         ///< Of the fields below, @see GetHash()
+
+        uint32_t tileSize{ 0 };
+        uint32_t frameCount{ 0 };
+        uint32_t isHalf{ 0 };       ///< Texels of 4 half floats, else floats
+        uint32_t hasNormals{ 0 };
+        float tileLength{ 0.0f };
+        float windDir[2]{ 0.0f, 0.0f };
+        float windSpeed{ 0.0f };
+        float animationPeriod{ 0.0f };
+        float phillipsConst{ 0.0f };
+        float damping{ 0.0f };
+        float minWaveNumber{ 0.0f };
+        uint64_t seed{ 0 };
+
+        float minHeight{ 0.0f };    ///< Of all the frames, not hashed
+        float maxHeight{ 0.0f };
+        uint64_t mapSize{ 0 };      ///< Bytes of each map of a frame
+        uint64_t frameStride{ 0 };  ///< Bytes between the frames
+    };
+
+    /** @return Header of the model's waves, without the heights */
+    static Header GetHeader(const WSTessendorf& model,
+                            uint32_t frameCount,
+                            bool isHalf,
+                            bool hasNormals);
+
+    /** @return FNV-1a of the fields of the model, frames and format */
+    static uint64_t GetHash(const Header& header);
+
+    /**
+     * @brief Writes the header and the frames, each of 'mapSize' bytes of
+     *  displacements, then of normals if any, at 'frames' + i * 'stride'
+     * @return False if not written, e.g., of a read-only directory
+     */
+    static bool Write(const std::filesystem::path& path,
+                      const Header& header,
+                      const uint8_t* frames,
+                      uint64_t stride);
+
+public:
+    WSLoopCache() = default;
+    ~WSLoopCache();
+
+    WSLoopCache(const WSLoopCache&) = delete;
+    WSLoopCache& operator=(const WSLoopCache&) = delete;
+
+    /**
+     * @brief Maps the file, if of the same hash and version as 'expected'
+     * @return False if missing, stale or truncated
+     */
+    bool Open(const std::filesystem::path& path, const Header& expected);
+    void Close();
+
+    bool IsOpen() const { return m_Data != nullptr; }
+    const Header& GetHeader() const { return m_Header; }
+
+    /** @return Displacements of the frame, followed by its normals */
+    const uint8_t* GetFrame(uint32_t index) const;
+
+private:
+    Header m_Header;
+
+    const uint8_t* m_Data{ nullptr };
+    size_t m_Size{ 0 };
+    // Read into memory where files are not mapped
+    std::vector<uint8_t> m_Contents;
+};
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_LOOP_CACHE_H_
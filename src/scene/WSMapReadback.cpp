@@ -0,0 +1,247 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSMapReadback.h"
+
+#include <core/Profile.h>
+
+
+WSMapReadback::WSMapReadback(const vkp::Device& device)
+    : m_kDevice(device)
+{
+    VKP_REGISTER_FUNCTION();
+}
+
+WSMapReadback::~WSMapReadback()
+{
+    VKP_REGISTER_FUNCTION();
+}
+
+void WSMapReadback::SetSize(uint32_t size)
+{
+    VKP_ASSERT_MSG(size > 0 && (size & (size - 1)) == 0,
+                   "Readback size must be a power of two");
+    m_Size = size;
+}
+
+void WSMapReadback::SetFrameCount(uint32_t count)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_ASSERT(count > 0);
+
+    m_FrameCount = count;
+    m_Slices.assign(count, Slice{});
+
+    if (m_Buffer == nullptr)
+        return;
+
+    // Slices may still be written
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    // Created again by the next update
+    m_Image.reset();
+    m_Buffer.reset();
+    m_CreatedSize = 0;
+}
+
+void WSMapReadback::Reset()
+{
+    for (Slice& slice : m_Slices)
+        slice.isPending = false;
+}
+
+void WSMapReadback::Update(
+    VkCommandBuffer cmdBuffer,
+    uint32_t frameIndex,
+    vkp::Texture2D& displacementMap,
+    float time,
+    VkPipelineStageFlags dstStages,
+    WSTessendorf& model
+)
+{
+    VKP_PROFILE_SCOPE();
+    VKP_ASSERT(frameIndex < m_FrameCount);
+
+    const uint32_t kSize = std::min(m_Size, displacementMap.GetWidth());
+    if (kSize != m_CreatedSize)
+        CreateResources(kSize);
+
+    Slice& slice = m_Slices[frameIndex];
+    const VkDeviceSize kSliceOffset = m_SliceSize * frameIndex;
+
+    // Copied by the frame's previous submission, done by now
+    if (slice.isPending)
+    {
+        m_Buffer->InvalidateMappedRange(m_SliceSize, kSliceOffset);
+
+        model.SetQueryDisplacements(
+            slice.time,
+            m_CreatedSize,
+            reinterpret_cast<const WSTessendorf::Displacement*>(
+                static_cast<const uint8_t*>(m_Buffer->GetMappedAddress()) +
+                kSliceOffset)
+        );
+        slice.isPending = false;
+    }
+
+    vkp::Image& mapImage = displacementMap.GetImage();
+    VKP_ASSERT(mapImage.GetLayout() ==
+               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // After the compute shaders writing the map
+    mapImage.RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        VK_ACCESS_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    mapImage.SetLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+    // Previous contents are discarded, after the copy of the previous frame
+    m_Image->SetLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+    m_Image->RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    m_Image->SetLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    const int32_t kMapSize = static_cast<int32_t>(displacementMap.GetWidth());
+    const int32_t kCopySize = static_cast<int32_t>(m_CreatedSize);
+    const VkImageBlit kBlit{
+        .srcSubresource = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        },
+        .srcOffsets = { { 0, 0, 0 }, { kMapSize, kMapSize, 1 } },
+        .dstSubresource = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        },
+        .dstOffsets = { { 0, 0, 0 }, { kCopySize, kCopySize, 1 } }
+    };
+    // Point sampled, linear filtering of the float formats is optional
+    vkCmdBlitImage(cmdBuffer,
+                   mapImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   *m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   1, &kBlit,
+                   VK_FILTER_NEAREST);
+
+    mapImage.RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        dstStages,
+        0,
+        VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    mapImage.SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    m_Image->RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_ACCESS_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    m_Image->SetLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+    const VkBufferImageCopy kRegion{
+        .bufferOffset = kSliceOffset,
+        // Tightly packed data
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        },
+        .imageOffset = { 0, 0, 0 },
+        .imageExtent = { m_CreatedSize, m_CreatedSize, 1 }
+    };
+    vkCmdCopyImageToBuffer(cmdBuffer,
+                           *m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           *m_Buffer,
+                           1, &kRegion);
+
+    // Visible to the host once the frame's fence is signaled
+    const VkBufferMemoryBarrier kBarrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = *m_Buffer,
+        .offset = kSliceOffset,
+        .size = GetCopySize()
+    };
+    vkCmdPipelineBarrier(cmdBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         0, nullptr,
+                         1, &kBarrier,
+                         0, nullptr);
+
+    slice.time = time;
+    slice.isPending = true;
+}
+
+void WSMapReadback::CreateResources(uint32_t size)
+{
+    VKP_REGISTER_FUNCTION();
+
+    if (m_Buffer != nullptr)
+    {
+        // Image and slices may still be used
+        m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+    }
+    m_CreatedSize = size;
+    m_Slices.assign(m_FrameCount, Slice{});
+
+    m_Image.reset(new vkp::Image(m_kDevice, vkp::MemoryTag::Staging));
+    m_Image->Create(VkExtent3D{ size, size, 1 },
+                    1,
+                    s_kFormat,
+                    VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                        VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // Slices are invalidated separately
+    m_SliceSize = m_kDevice.GetNonCoherentAtomSizeAlignment(GetCopySize());
+
+    m_Buffer.reset(new vkp::Buffer(m_kDevice, vkp::MemoryTag::Staging));
+    m_Buffer->Create(m_SliceSize * m_FrameCount,
+                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     GetMemoryProperties());
+
+    auto err = m_Buffer->Map();
+    VKP_ASSERT_RESULT(err);
+
+    VKP_LOG_INFO("Map readback: {}x{}, {} frames in flight", size, size,
+                 m_FrameCount);
+}
+
+VkMemoryPropertyFlags WSMapReadback::GetMemoryProperties() const
+{
+    // Read by the host, uncached reads are slow
+    constexpr VkMemoryPropertyFlags kCached =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+    const VkPhysicalDeviceMemoryProperties& kProperties =
+        m_kDevice.GetPhysicalDevice().GetMemoryProperties();
+    for (uint32_t i = 0; i < kProperties.memoryTypeCount; ++i)
+    {
+        if ((kProperties.memoryTypes[i].propertyFlags & kCached) == kCached)
+            return kCached;
+    }
+    return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+}
@@ -0,0 +1,116 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_MAP_READBACK_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_MAP_READBACK_H_
+
+#include <memory>
+#include <vector>
+
+#include "vulkan/Device.h"
+#include "vulkan/Buffer.h"
+#include "vulkan/Image.h"
+#include "vulkan/Texture2D.h"
+
+#include "scene/WSTessendorf.h"
+
+
+/**
+ * @brief Reads the displacement maps of the GPU backend back to the CPU,
+ *  downsampled, for the queries of the waves, @see WSTessendorf::QueryWaves()
+ *
+ * Each frame in flight blits the map to a smaller image, and copies it to its
+ *  own slice of a host-visible buffer. The slice is read by the next
+ *  "Update()" of the same frame, once its previous frame is done, so the
+ *  results lag behind by the frames in flight, the queue is never waited for
+ */
+class WSMapReadback
+{
+public:
+    static constexpr uint32_t s_kDefaultSize{ 128 };
+    // Of the maps of either format, as the model's displacements
+    static constexpr VkFormat s_kFormat{ VK_FORMAT_R32G32B32A32_SFLOAT };
+
+public:
+    explicit WSMapReadback(const vkp::Device& device);
+    ~WSMapReadback();
+
+    WSMapReadback(const WSMapReadback&) = delete;
+    WSMapReadback& operator=(const WSMapReadback&) = delete;
+
+    /**
+     * @brief Texels per side of the copies, of at most those of the maps,
+     *  the maps are point sampled. Takes effect on the next "Update()"
+     * @param size Power of two
+     */
+    void SetSize(uint32_t size);
+    uint32_t GetSize() const { return m_Size; }
+
+    /**
+     * @brief Reallocates the buffer with a slice for each frame in flight,
+     *  waits for the graphics queue
+     */
+    void SetFrameCount(uint32_t count);
+
+    /**
+     * @brief Publishes the frame's previous copy to the model, if any, then
+     *  records the copy of the map of the frame's waves to its slice
+     * @param cmdBuffer Command buffer in recording state, outside a render
+     *  pass, after the compute shaders writing the map
+     * @param frameIndex Its previous frame is done
+     * @param displacementMap In LAYOUT_SHADER_READ_ONLY_OPTIMAL, left in it
+     * @param time Of the waves of the map, in seconds
+     * @param dstStages Stages reading the map after
+     * @param model Its queries are of the published copies
+     */
+    void Update(VkCommandBuffer cmdBuffer,
+                uint32_t frameIndex,
+                vkp::Texture2D& displacementMap,
+                float time,
+                VkPipelineStageFlags dstStages,
+                WSTessendorf& model);
+
+    /** @brief Drops the copies not yet published, e.g., of other waves */
+    void Reset();
+
+private:
+    /**
+     * @brief (Re)Creates the image and the buffer of the size, waits for
+     *  the graphics queue if they are replaced
+     */
+    void CreateResources(uint32_t size);
+
+    /** @return Of the host-visible memory, cached if there is one */
+    VkMemoryPropertyFlags GetMemoryProperties() const;
+
+    VkDeviceSize GetCopySize() const {
+        return vkp::Texture2D::FormatToBytes(s_kFormat) *
+               static_cast<VkDeviceSize>(m_CreatedSize) * m_CreatedSize;
+    }
+
+private:
+    const vkp::Device& m_kDevice;
+
+    uint32_t m_Size{ s_kDefaultSize };
+    uint32_t m_FrameCount{ 1 };
+
+    // Of the resources, of at most the size of the map
+    uint32_t m_CreatedSize{ 0 };
+    // Blitted to from the map, copied from to the frame's slice
+    std::unique_ptr<vkp::Image> m_Image{ nullptr };
+    std::unique_ptr<vkp::Buffer> m_Buffer{ nullptr };
+    VkDeviceSize m_SliceSize{ 0 };
+
+    // Of each frame in flight, of the copy recorded to its slice
+    struct Slice
+    {
+        float time{ 0.0f };
+        bool isPending{ false };
+    };
+    std::vector<Slice> m_Slices;
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_MAP_READBACK_H_
@@ -0,0 +1,65 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSResolutionScaler.h"
+
+
+WSResolutionScaler::WSResolutionScaler()
+    : m_SimulationTimes(m_Settings.windowFrames),
+      m_GpuFrameTimes(m_Settings.windowFrames)
+{
+}
+
+void WSResolutionScaler::SetSettings(const Settings& settings)
+{
+    m_Settings = settings;
+    m_Settings.windowFrames = std::max(settings.windowFrames, 1u);
+
+    m_SimulationTimes.SetWindowSize(m_Settings.windowFrames);
+    m_GpuFrameTimes.SetWindowSize(m_Settings.windowFrames);
+    Reset();
+}
+
+WSResolutionScaler::Step WSResolutionScaler::Update(const Limits& limits)
+{
+    const vkp::RollingStats::Summary kGpu = m_GpuFrameTimes.GetSummary();
+    if (kGpu.count < m_Settings.windowFrames)
+        return Step::None;
+
+    const float kSimulation = GetSimulationTime();
+    const float kUpBudget = m_Settings.budget * m_Settings.upFraction;
+
+    Step step = Step::None;
+    if (kGpu.p95 > m_Settings.budget)
+    {
+        step = limits.meshDown ? Step::MeshDown :
+               limits.simulationDown ? Step::SimulationDown : Step::None;
+    }
+    else if (kSimulation > m_Settings.budget)
+    {
+        step = limits.simulationDown ? Step::SimulationDown : Step::None;
+    }
+    else if (limits.simulationUp && 4.0f * kSimulation < kUpBudget &&
+             kGpu.p95 < kUpBudget)
+    {
+        step = Step::SimulationUp;
+    }
+    else if (limits.meshUp && 2.0f * kGpu.p95 < kUpBudget)
+    {
+        step = Step::MeshUp;
+    }
+
+    if (step != Step::None)
+        Reset();
+
+    return step;
+}
+
+void WSResolutionScaler::Reset()
+{
+    m_SimulationTimes.Clear();
+    m_GpuFrameTimes.Clear();
+}
@@ -0,0 +1,93 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_RESOLUTION_SCALER_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_RESOLUTION_SCALER_H_
+
+#include "core/RollingStats.h"
+
+
+/**
+ * @brief Steps the resolutions of the water surface to hold a frame-time
+ *  budget, from the measured times of the CPU simulation and of the GPU
+ *  frames. Only the decision is made here, the caller applies it.
+ *
+ * Each decision is of the 95th percentile of a full window of the times
+ *  measured since the last step:
+ *  a) Over the budget on the GPU, the mesh is coarsened, or the simulation
+ *      if the mesh is at its coarsest, e.g., of the Compute backend.
+ *  b) Over the budget on the CPU, the simulation is coarsened.
+ *  c) The simulation is refined only if 4 times its time, of twice the
+ *      samples in both dimensions, and the GPU time are below a fraction of
+ *      the budget, then the mesh if twice the GPU time is.
+ *
+ * The windows are cleared by each step, the times of the previous
+ *  resolutions are not judged, and the gap between the thresholds of the
+ *  steps down and up keeps them from oscillating.
+ */
+class WSResolutionScaler
+{
+public:
+    enum class Step
+    {
+        None = 0,
+        SimulationDown,
+        SimulationUp,
+        MeshDown,
+        MeshUp
+    };
+
+    struct Settings
+    {
+        float budget{ 16.6f };          ///< Of a frame, in ms
+        float upFraction{ 0.7f };       ///< Of the budget, to refine
+        uint32_t windowFrames{ 60 };    ///< Measured before each decision
+    };
+
+    /** @brief Of the current resolutions, whether each step is possible */
+    struct Limits
+    {
+        bool simulationDown{ false };
+        bool simulationUp{ false };
+        bool meshDown{ false };
+        bool meshUp{ false };
+    };
+
+public:
+    WSResolutionScaler();
+
+    void SetSettings(const Settings& settings);
+    const Settings& GetSettings() const { return m_Settings; }
+
+    /** @param ms Of a computation of the waves on the CPU */
+    void AddSimulationTime(float ms) { m_SimulationTimes.Add(ms); }
+    /** @param ms Of a frame on the GPU, its first to last timestamp */
+    void AddGpuFrameTime(float ms) { m_GpuFrameTimes.Add(ms); }
+
+    /**
+     * @brief Of a full window of the GPU times, the simulation times are of
+     *  the CPU backend only
+     * @return Step to apply, the windows are cleared if not None
+     */
+    Step Update(const Limits& limits);
+
+    /** @brief Clears the windows, e.g., of resolutions set by the user */
+    void Reset();
+
+    /** @return 95th percentiles of the current windows, 0 if empty */
+    float GetSimulationTime() const {
+        return m_SimulationTimes.GetSummary().p95;
+    }
+    float GetGpuFrameTime() const { return m_GpuFrameTimes.GetSummary().p95; }
+
+private:
+    Settings m_Settings;
+
+    vkp::RollingStats m_SimulationTimes;
+    vkp::RollingStats m_GpuFrameTimes;
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_RESOLUTION_SCALER_H_
@@ -0,0 +1,166 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSSimulation.h"
+
+#include "core/Profile.h"
+#include "core/Threads.h"
+#include "core/Timer.h"
+
+
+WSSimulation::WSSimulation(WSTessendorf& model)
+    : m_Model(model)
+{
+    VKP_REGISTER_FUNCTION();
+
+    m_Thread = std::thread(&WSSimulation::Run, this);
+}
+
+WSSimulation::~WSSimulation()
+{
+    VKP_REGISTER_FUNCTION();
+
+    m_Running.store(false);
+    Notify(m_WorkCondition);
+
+    if (m_Thread.joinable())
+        m_Thread.join();
+}
+
+void WSSimulation::Submit(float t, const WSTessendorf::Outputs& outputs)
+{
+    const uint64_t kIndex = m_Submitted.load(std::memory_order_relaxed);
+    VKP_ASSERT_MSG(kIndex - m_Consumed < s_kSlotCount,
+                   "Too many results of the simulation are not released");
+
+    Waves& waves = m_Slots[kIndex % s_kSlotCount];
+    waves.outputs = outputs;
+    waves.time = t;
+
+    if (m_Latency == 0)
+    {
+        Compute(waves);
+        // Completed first, so the worker never sees it as pending
+        m_Completed.store(kIndex + 1, std::memory_order_release);
+        m_Submitted.store(kIndex + 1, std::memory_order_release);
+        return;
+    }
+
+    m_Submitted.store(kIndex + 1, std::memory_order_release);
+    Notify(m_WorkCondition);
+}
+
+const WSSimulation::Waves* WSSimulation::Acquire(uint32_t latency)
+{
+    VKP_ASSERT(!m_Acquired);
+
+    const uint64_t kSubmitted = m_Submitted.load(std::memory_order_relaxed);
+    if (kSubmitted - m_Consumed <= latency)
+        return nullptr;
+
+    // Results are completed in order, waiting for the newest one also
+    //  waits for those skipped
+    const uint64_t kIndex = kSubmitted - latency - 1;
+    m_Consumed = kIndex;
+
+    if (m_Completed.load(std::memory_order_acquire) <= kIndex)
+    {
+        VKP_PROFILE_SCOPE("WSSimulation::Acquire wait");
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_DoneCondition.wait(lock, [this, kIndex]() {
+            return m_Completed.load(std::memory_order_acquire) > kIndex;
+        });
+    }
+
+    m_Acquired = true;
+    return &m_Slots[kIndex % s_kSlotCount];
+}
+
+void WSSimulation::Release()
+{
+    VKP_ASSERT(m_Acquired);
+
+    ++m_Consumed;
+    m_Acquired = false;
+}
+
+void WSSimulation::Drain()
+{
+    VKP_ASSERT(!m_Acquired);
+
+    const uint64_t kSubmitted = m_Submitted.load(std::memory_order_relaxed);
+    if (m_Completed.load(std::memory_order_acquire) < kSubmitted)
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_DoneCondition.wait(lock, [this, kSubmitted]() {
+            return m_Completed.load(std::memory_order_acquire) >= kSubmitted;
+        });
+    }
+
+    m_Consumed = kSubmitted;
+}
+
+void WSSimulation::SetLatency(uint32_t latency)
+{
+    Drain();
+    m_Latency = glm::min(latency, s_kMaxLatency);
+}
+
+// =============================================================================
+
+void WSSimulation::Run()
+{
+    const auto kHasWork = [this]() {
+        // Submitted first: with zero latency it is stored after completed
+        const uint64_t kSubmitted = m_Submitted.load(std::memory_order_acquire);
+        return kSubmitted > m_Completed.load(std::memory_order_acquire);
+    };
+
+    while (true)
+    {
+        if (!kHasWork())
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkCondition.wait(lock, [this, &kHasWork]() {
+                return !m_Running.load() || kHasWork();
+            });
+        }
+
+        if (!m_Running.load())
+            return;
+
+        // Placed again only if the settings changed since
+        vkp::ThreadPlacement::PlaceSimulationThread();
+
+        const uint64_t kIndex = m_Completed.load(std::memory_order_relaxed);
+        Compute(m_Slots[kIndex % s_kSlotCount]);
+
+        m_Completed.store(kIndex + 1, std::memory_order_release);
+        Notify(m_DoneCondition);
+    }
+}
+
+void WSSimulation::Compute(Waves& waves)
+{
+    VKP_PROFILE_SCOPE();
+
+    const vkp::Timer kTimer;
+    m_Model.ComputeWaves(waves.time, waves.outputs);
+    waves.computeTime = kTimer.ElapsedMicro() * 0.001f;
+
+    waves.minHeight = m_Model.GetMinHeight();
+    waves.maxHeight = m_Model.GetMaxHeight();
+}
+
+void WSSimulation::Notify(std::condition_variable& condition)
+{
+    // Waiter is either before its check of the counters, or already waiting
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+    }
+    condition.notify_one();
+}
@@ -0,0 +1,120 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_SIMULATION_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_SIMULATION_H_
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "scene/WSTessendorf.h"
+
+
+/**
+ * @brief Computes the waves of a WSTessendorf model on a dedicated thread,
+ *  so that the waves of the next frame are computed while the current one
+ *  is recorded and rendered.
+ *
+ * Results are written directly to the outputs of each submission, e.g.,
+ *  mapped staging memory, and handed over through a ring of slots, single
+ *  producer (the worker) and single consumer (the caller), synchronized by
+ *  atomic counters only. A mutex is locked just to put a starved thread to
+ *  sleep.
+ *
+ * The worker is placed by vkp::ThreadPlacement, e.g., pinned to the first CPU
+ *  of the simulation, before its next computation.
+ *
+ * Usage, each frame:
+ *  1. "Submit(time, outputs)"
+ *  2. "Acquire(latency)" returns the waves of 'latency' submissions ago
+ *  3. "Release()" once the outputs are no longer read
+ *
+ * @pre The model must not be modified, nor its results read, by the caller
+ *  unless "Drain()" is called first
+ */
+class WSSimulation
+{
+public:
+    static constexpr uint32_t s_kMaxLatency{ 2 };
+
+    /** @brief Results of one computation of the model */
+    struct Waves
+    {
+        WSTessendorf::Outputs outputs{};
+        float time{ 0.0f };
+        float minHeight{ -1.0f };
+        float maxHeight{ 1.0f };
+        float computeTime{ 0.0f };  ///< Of the model's waves, in ms
+    };
+
+public:
+    /** @param model Prepared before the first "Submit()" */
+    WSSimulation(WSTessendorf& model);
+    ~WSSimulation();
+
+    /**
+     * @brief Requests the waves at time 't'. With zero latency they are
+     *  computed right away on the calling thread.
+     * @param outputs Sized for the model, not accessed by the caller until
+     *  the results are acquired, discarded, or released
+     * @pre Fewer than s_kMaxLatency + 1 results are not released
+     */
+    void Submit(float t, const WSTessendorf::Outputs& outputs);
+
+    /**
+     * @brief Waits for the results submitted more than 'latency' submissions
+     *  ago, older ones are skipped
+     * @return The newest of them, valid until "Release()", or null if none
+     */
+    const Waves* Acquire(uint32_t latency);
+    void Release();
+
+    /**
+     * @brief Waits for the submitted computations to finish, discards their
+     *  results. Then the model may be modified.
+     */
+    void Drain();
+
+    /**
+     * @brief Number of frames the results are delayed by, when played
+     * @param latency Up to s_kMaxLatency, 0 computes on the calling thread
+     */
+    void SetLatency(uint32_t latency);
+    uint32_t GetLatency() const { return m_Latency; }
+
+private:
+    void Run();
+    void Compute(Waves& waves);
+
+    /** @brief Wakes up a thread waiting on the condition */
+    void Notify(std::condition_variable& condition);
+
+private:
+    WSTessendorf& m_Model;
+    uint32_t m_Latency{ 1 };
+
+    // Results in flight, plus the acquired one
+    static constexpr uint32_t s_kSlotCount{ s_kMaxLatency + 1 };
+    std::array<Waves, s_kSlotCount> m_Slots;
+
+    // Counters of the ring, slot of a counter 'c' is 'c % s_kSlotCount'
+    std::atomic<uint64_t> m_Submitted{ 0 };    ///< Written by the caller
+    std::atomic<uint64_t> m_Completed{ 0 };    ///< Written by the worker
+    uint64_t m_Consumed{ 0 };                  ///< Caller's only
+    bool m_Acquired{ false };
+
+    std::atomic<bool> m_Running{ true };
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkCondition;
+    std::condition_variable m_DoneCondition;
+
+    std::thread m_Thread;
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_SIMULATION_H_
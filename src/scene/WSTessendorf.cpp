@@ -7,8 +7,16 @@
 #include "scene/WSTessendorf.h"
 
 #include <core/Profile.h>
+#include <core/Threads.h>
 #include <omp.h>
 
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <cpuid.h>
+#endif
+
 
 WSTessendorf::WSTessendorf(uint32_t tileSize, float tileLength)
 {
@@ -23,14 +31,53 @@ WSTessendorf::WSTessendorf(uint32_t tileSize, float tileLength)
 
     SetPhillipsConst(s_kDefaultPhillipsConst);
     SetDamping(s_kDefaultPhillipsDamping);
+
+    SetSimdLevel(wst::GetSupportedSimdLevel());
+
+    // Threads of FFTW are of all the models, set up by the first one
+    std::lock_guard<std::mutex> lock(s_PlannerMutex);
+    if (s_ModelCount++ == 0)
+        fftwf_init_threads();
+}
+
+WSTessendorf::WSTessendorf(const WSTessendorf& other, uint32_t tileSize)
+    : WSTessendorf(tileSize, other.m_TileLength)
+{
+    m_WindDir = other.m_WindDir;
+    m_WindSpeed = other.m_WindSpeed;
+    m_A = other.m_A;
+    m_Damping = other.m_Damping;
+    m_MinWaveNumber = other.m_MinWaveNumber;
+    m_Seed = other.m_Seed;
+    m_AnimationPeriod = other.m_AnimationPeriod;
+    m_BaseFreq = other.m_BaseFreq;
+    m_Lambda = other.m_Lambda;
+
+    m_PackedFFT = other.m_PackedFFT;
+    m_ComputeNormals = other.m_ComputeNormals;
+    m_ComputeJacobian = other.m_ComputeJacobian;
+    m_SeparateFFTInputs = other.m_SeparateFFTInputs;
+    m_FFTScheduleRequest = other.m_FFTScheduleRequest;
+    m_TimeStep = other.m_TimeStep;
+
+    m_SimdLevel = other.m_SimdLevel;
+    m_SpectrumKernel = other.m_SpectrumKernel;
+    m_ConvertToHalf = other.m_ConvertToHalf;
+
+    // Of the spectrum built, compared by "AdoptTileSize()" to the other's
+    m_SpectrumVersion = other.m_SpectrumVersion;
 }
 
 WSTessendorf::~WSTessendorf()
 {
     VKP_REGISTER_FUNCTION();
     DestroyFFTW();
+    for (auto& tile : m_TileCache)
+        FreeTile(tile);
 
-    fftwf_cleanup();
+    std::lock_guard<std::mutex> lock(s_PlannerMutex);
+    if (--s_ModelCount == 0)
+        fftwf_cleanup_threads();
 }
 
 void WSTessendorf::Prepare()
@@ -38,23 +85,113 @@ void WSTessendorf::Prepare()
     VKP_REGISTER_FUNCTION();
     VKP_PROFILE_SCOPE();
 
+    UpdateSpectrum();
+
+    // Of another thread placement, e.g., changed at runtime
+    m_FFTWDirty |= m_PlanHeight != nullptr &&
+        (m_FFTThreadCount != static_cast<uint32_t>(omp_get_max_threads()) ||
+         m_FFTFirstTouch != vkp::ThreadPlacement::IsFirstTouch());
+
+    if (m_FFTWDirty)
+        DestroyFFTW();
+    // Plans of the same size and layout are kept
+    if (m_PlanHeight == nullptr)
+        SetupFFTW();
+}
+
+void WSTessendorf::PrepareSpectrum()
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_PROFILE_SCOPE();
+
+    UpdateSpectrum();
+
+    // Not used while the waves are computed elsewhere
+    DestroyFFTW();
+}
+
+void WSTessendorf::Invalidate()
+{
+    m_WaveVectorsDirty = true;
+    m_GaussRandomsDirty = true;
+    m_BuiltSpectrumVersion = 0;
+    m_FFTWDirty = true;
+}
+
+void WSTessendorf::UpdateSpectrum()
+{
+    VKP_PROFILE_SCOPE();
+
+    // E.g., switched back to a cached tile size
+    if (!m_WaveVectorsDirty && !m_GaussRandomsDirty &&
+        m_BuiltSpectrumVersion == m_SpectrumVersion)
+        return;
+
     VKP_LOG_INFO("Water surface resolution: {} x {}", m_TileSize, m_TileSize);
 
-    m_WaveVectors = ComputeWaveVectors();
+    // Only the parameters of the spectrum changed, e.g., the wind, reuse
+    //  the wave vectors and the random numbers
+    if (m_WaveVectorsDirty)
+    {
+        m_WaveVectors = ComputeWaveVectors();
+        m_WaveVectorsDirty = false;
+    }
+    if (m_GaussRandomsDirty)
+    {
+        m_GaussRandoms = ComputeGaussRandomArray();
+        m_GaussRandomsDirty = false;
+    }
 
-    std::vector<Complex> gaussRandomArr = ComputeGaussRandomArray();
-    m_BaseWaveHeights = ComputeBaseWaveHeightField(gaussRandomArr);
+    m_BaseWaveHeights = ComputeBaseWaveHeightField(m_GaussRandoms);
 
     const uint32_t kSize = m_TileSize;
 
-    const Displacement kDefaultDisplacement{ 0.0 };
-    m_Displacements.resize(kSize * kSize, kDefaultDisplacement);
+    m_Spectrum.Resize(kSize * kSize);
 
-    const Normal kDefaultNormal{ 0.0, 1.0, 0.0, 0.0 };
-    m_Normals.resize(kSize * kSize, kDefaultNormal);
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < m_Spectrum.Size(); ++i)
+    {
+        const auto& h0 = m_BaseWaveHeights[i];
+        const auto& kWaveVec = m_WaveVectors[i];
+
+        m_Spectrum.heightAmpRe[i] = h0.heightAmp.real();
+        m_Spectrum.heightAmpIm[i] = h0.heightAmp.imag();
+        m_Spectrum.heightAmpConjRe[i] = h0.heightAmp_conj.real();
+        m_Spectrum.heightAmpConjIm[i] = h0.heightAmp_conj.imag();
+        m_Spectrum.dispersion[i] = h0.dispersion;
+        m_Spectrum.waveVecX[i] = kWaveVec.vec.x;
+        m_Spectrum.waveVecZ[i] = kWaveVec.vec.y;
+        m_Spectrum.unitX[i] = kWaveVec.unit.x;
+        m_Spectrum.unitZ[i] = kWaveVec.unit.y;
+    }
 
-    DestroyFFTW();
-    SetupFFTW();
+    // Wave vectors and random numbers are kept for the next update
+    std::vector<BaseWaveHeight>().swap(m_BaseWaveHeights);
+    m_BuiltSpectrumVersion = m_SpectrumVersion;
+
+    ComputePhasorSteps();
+}
+
+std::vector<WSTessendorf::SpectrumSample> WSTessendorf::GetSpectrum() const
+{
+    VKP_REGISTER_FUNCTION();
+
+    std::vector<SpectrumSample> spectrum(m_Spectrum.Size());
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < spectrum.size(); ++i)
+    {
+        spectrum[i].heights = glm::vec4(
+            m_Spectrum.heightAmpRe[i],     m_Spectrum.heightAmpIm[i],
+            m_Spectrum.heightAmpConjRe[i], m_Spectrum.heightAmpConjIm[i]
+        );
+        spectrum[i].waveVec = glm::vec4(m_Spectrum.waveVecX[i],
+                                        m_Spectrum.waveVecZ[i],
+                                        m_Spectrum.dispersion[i],
+                                        0.0f);
+    }
+
+    return spectrum;
 }
 
 std::vector<WSTessendorf::WaveVector> WSTessendorf::ComputeWaveVectors() const
@@ -92,12 +229,7 @@ std::vector<WSTessendorf::Complex> WSTessendorf::ComputeGaussRandomArray() const
     const uint32_t kSize = m_TileSize;
     std::vector<Complex> randomArr(kSize * kSize);
 
-    for (int32_t m = 0; m < kSize; ++m)
-        for (int32_t n = 0; n < kSize; ++n)
-        {
-            randomArr[m * kSize + n] = Complex(glm::gaussRand(0.0f, 1.0f),
-                                               glm::gaussRand(0.0f, 1.0f));
-        }
+    wst::GenerateGaussians(m_Seed, kSize, kSize, randomArr.data());
 
     return randomArr;
 }
@@ -126,13 +258,19 @@ std::vector<WSTessendorf::BaseWaveHeight>
             const float k = glm::length(kWaveVec.vec);
 
             auto& h0 = baseWaveHeights[kIndex];
-            if (k > 0.00001f)
+            // Of the Nyquist row and column, of no opposite wave vector,
+            //  their derivatives are not real
+            const bool kIsNyquist = m == 0 || n == 0;
+            if (!kIsNyquist && k > 0.00001f && k >= m_MinWaveNumber)
             {
-                const auto gaussRandom = gaussRandomArray[kIndex];
-                h0.heightAmp =
-                    BaseWaveHeightFT(gaussRandom, kWaveVec.unit, k);
-                h0.heightAmp_conj = std::conj(
-                    BaseWaveHeightFT(gaussRandom, -kWaveVec.unit, k) );
+                // Of "-k" its own sample, of a Hermitian spectrum, i.e.,
+                //  real fields, packed in pairs as "A + iB"
+                const uint32_t kMirrorIndex =
+                    (kSize - m) * kSize + (kSize - n);
+                h0.heightAmp = BaseWaveHeightFT(
+                    gaussRandomArray[kIndex], kWaveVec.unit, k);
+                h0.heightAmp_conj = std::conj( BaseWaveHeightFT(
+                    gaussRandomArray[kMirrorIndex], -kWaveVec.unit, k) );
                 h0.dispersion = QDispersion(k);
             }
             else 
@@ -147,103 +285,331 @@ std::vector<WSTessendorf::BaseWaveHeight>
     return baseWaveHeights;
 }
 
+std::array<WSTessendorf::FieldPairFT, WSTessendorf::s_kFieldPairCount>
+    WSTessendorf::GetFieldPairs()
+{
+    return {
+        FieldPairFT{ m_SlopeX, m_SlopeZ, m_PlanSlopeX, m_PlanSlopeZ,
+                     PairFeature::Normals },
+        FieldPairFT{ m_DisplacementX, m_DisplacementZ,
+                     m_PlanDisplacementX, m_PlanDisplacementZ,
+                     PairFeature::Displacements },
+        FieldPairFT{ m_dxDisplacementX, m_dzDisplacementZ,
+                     m_PlandxDisplacementX, m_PlandzDisplacementZ,
+                     PairFeature::Normals },
+        FieldPairFT{ m_dxDisplacementZ, m_dzDisplacementX,
+                     m_PlandxDisplacementZ, m_PlandzDisplacementX,
+                     PairFeature::Jacobian },
+    };
+}
+
+bool WSTessendorf::IsSetUp(PairFeature feature) const
+{
+    switch (feature)
+    {
+        case PairFeature::Normals:  return m_ComputeNormals;
+        case PairFeature::Jacobian: return m_ComputeNormals &&
+                                           m_ComputeJacobian;
+        default:                    return true;
+    }
+}
+
+uint32_t WSTessendorf::GetTransformCount() const
+{
+    // Only the displacements are transformed along with the height, the
+    //  cross derivatives only for the Jacobian
+    uint32_t pairCount = 1;
+    if (m_ComputeNormals)
+        pairCount += m_ComputeJacobian ? 3 : 2;
+    return 1 + pairCount * (m_PackedFFT ? 1 : 2);
+}
+
 void WSTessendorf::SetupFFTW()
 {
     VKP_REGISTER_FUNCTION();
     VKP_PROFILE_SCOPE();
 
+    // Of another model planning meanwhile, e.g., on another thread
+    std::lock_guard<std::mutex> lock(s_PlannerMutex);
+
     const uint32_t kSize = m_TileSize;
     const uint32_t kSize2 = kSize * kSize;
 
-#ifndef COMPUTE_JACOBIAN
-    const uint32_t kTotalInputs = 7;
-#else
-    const uint32_t kTotalInputs = 7+2;
-#endif
+    // Height, and one or two transforms per pair of fields
+    const uint32_t kTotalInputs = GetTransformCount();
 
-    m_Height = (Complex*)fftwf_alloc_complex(kTotalInputs * kSize2);
-
-    m_SlopeX =          m_Height + kSize2;
-    m_SlopeZ =          m_SlopeX + kSize2;
-    m_DisplacementX =   m_SlopeZ + kSize2;
-    m_DisplacementZ =   m_DisplacementX + kSize2;
-    m_dxDisplacementX = m_DisplacementZ + kSize2;
-    m_dzDisplacementZ = m_dxDisplacementX + kSize2;
-#ifdef COMPUTE_JACOBIAN
-    m_dzDisplacementX = m_dzDisplacementZ + kSize2;
-    m_dxDisplacementZ = m_dzDisplacementX + kSize2;
-#endif
-    
-#ifdef CAREFUL_ALLOC
-        m_Height =          (Complex*)fftwf_alloc_complex(kSize * kSize);
-        m_SlopeX =          (Complex*)fftwf_alloc_complex(kSize * kSize);
-        m_SlopeZ =          (Complex*)fftwf_alloc_complex(kSize * kSize);
-        m_DisplacementX =   (Complex*)fftwf_alloc_complex(kSize * kSize);
-        m_DisplacementZ =   (Complex*)fftwf_alloc_complex(kSize * kSize);
-        m_dxDisplacementX = (Complex*)fftwf_alloc_complex(kSize * kSize);
-        m_dzDisplacementZ = (Complex*)fftwf_alloc_complex(kSize * kSize);
-    #ifdef COMPUTE_JACOBIAN
-        m_dzDisplacementX = (Complex*)fftwf_alloc_complex(kSize * kSize);
-        m_dxDisplacementZ = (Complex*)fftwf_alloc_complex(kSize * kSize);
-    #endif
-#endif
+    // Of one block, the height's input first, unless separate
+    m_FFTInputsSeparate = m_SeparateFFTInputs;
+    m_FFTThreadCount = static_cast<uint32_t>(omp_get_max_threads());
+    m_FFTFirstTouch = vkp::ThreadPlacement::IsFirstTouch();
+
+    // Touched before planning, of which the measurements write the inputs
+    Complex* inputs = nullptr;
+    if (!m_FFTInputsSeparate)
+    {
+        inputs = (Complex*)fftwf_alloc_complex(kTotalInputs * kSize2);
+        for (uint32_t i = 0; m_FFTFirstTouch && i < kTotalInputs; ++i)
+            FirstTouchInput(inputs + i * kSize2);
+    }
+    auto NextInput = [this, &inputs, kSize2]() {
+        if (m_FFTInputsSeparate)
+        {
+            Complex* input = (Complex*)fftwf_alloc_complex(kSize2);
+            if (m_FFTFirstTouch)
+                FirstTouchInput(input);
+            return input;
+        }
+
+        Complex* input = inputs;
+        inputs += kSize2;
+        return input;
+    };
+
+    m_FFTSchedule = ChooseFFTSchedule(kTotalInputs, m_FFTThreadsPerPlan);
+    fftwf_plan_with_nthreads(m_FFTThreadsPerPlan);
+
+    // Threads of FFTW nested within the concurrent transforms
+    omp_set_max_active_levels(m_FFTSchedule == FFTSchedule::Mixed ? 2 : 1);
+
+    VKP_LOG_INFO("FFT schedule: {}, threads per transform: {}",
+                 ToString(m_FFTSchedule), m_FFTThreadsPerPlan);
+
+    // Plans of previous runs make FFTW_MEASURE planning nearly instant
+    const bool kWisdomIsCached = ImportWisdom();
+
+    auto CreatePlan = [kSize](Complex* input) {
+        return fftwf_plan_dft_2d(
+            kSize, kSize,
+            reinterpret_cast<fftwf_complex*>(input),
+            reinterpret_cast<fftwf_complex*>(input),
+            FFTW_BACKWARD,
+            FFTW_MEASURE);
+    };
+
+    m_Height = NextInput();
+    m_PlanHeight = CreatePlan(m_Height);
+
+    for (auto& pair : GetFieldPairs())
+    {
+        if (!IsSetUp(pair.feature))
+            continue;
+
+        pair.a = NextInput();
+        pair.planA = CreatePlan(pair.a);
+
+        if (m_PackedFFT)
+        {
+            pair.b = pair.a;
+            pair.planB = nullptr;
+        }
+        else
+        {
+            pair.b = NextInput();
+            pair.planB = CreatePlan(pair.b);
+        }
+    }
+
+    VKP_LOG_INFO("FFTW transforms: {}{}{}{}", kTotalInputs,
+                 m_PackedFFT ? " (packed)" : "",
+                 m_ComputeNormals ? "" : " (without normals)",
+                 IsSetUp(PairFeature::Jacobian) ? " (with Jacobian)" : "");
+
+    if (!kWisdomIsCached)
+        ExportWisdom();
+
+    m_FFTWDirty = false;
+}
+
+void WSTessendorf::FirstTouchInput(Complex* input) const
+{
+    const uint32_t kSize = m_TileSize;
+
+    #pragma omp parallel
+    {
+        vkp::ThreadPlacement::PlaceTeamThread(omp_get_thread_num());
+
+        #pragma omp for schedule(static)
+        for (uint32_t m = 0; m < kSize; ++m)
+            std::fill_n(input + static_cast<size_t>(m) * kSize, kSize,
+                        Complex(0));
+    }
+}
+
+WSTessendorf::FFTSchedule WSTessendorf::ChooseFFTSchedule(
+    const uint32_t kTransformCount,
+    uint32_t& threadsPerPlan
+) const
+{
+    const uint32_t kThreadCount = static_cast<uint32_t>(omp_get_max_threads());
 
-    m_PlanHeight = fftwf_plan_dft_2d(
-        kSize, kSize,
-        reinterpret_cast<fftwf_complex*>(m_Height),
-        reinterpret_cast<fftwf_complex*>(m_Height),
-        FFTW_BACKWARD,
-        FFTW_MEASURE);
-    m_PlanSlopeX = fftwf_plan_dft_2d(
-        kSize, kSize, 
-        reinterpret_cast<fftwf_complex*>(m_SlopeX),
-        reinterpret_cast<fftwf_complex*>(m_SlopeX),
-        FFTW_BACKWARD,
-        FFTW_MEASURE);
-    m_PlanSlopeZ = fftwf_plan_dft_2d(
-        kSize, kSize, 
-        reinterpret_cast<fftwf_complex*>(m_SlopeZ),
-        reinterpret_cast<fftwf_complex*>(m_SlopeZ),
-        FFTW_BACKWARD,
-        FFTW_MEASURE);
-    m_PlanDisplacementX = fftwf_plan_dft_2d(
-        kSize, kSize, 
-        reinterpret_cast<fftwf_complex*>(m_DisplacementX),
-        reinterpret_cast<fftwf_complex*>(m_DisplacementX),
-        FFTW_BACKWARD,
-        FFTW_MEASURE);
-    m_PlanDisplacementZ = fftwf_plan_dft_2d(
-        kSize, kSize, 
-        reinterpret_cast<fftwf_complex*>(m_DisplacementZ),
-        reinterpret_cast<fftwf_complex*>(m_DisplacementZ),
-        FFTW_BACKWARD,
-        FFTW_MEASURE);
-    m_PlandxDisplacementX = fftwf_plan_dft_2d(
-        kSize, kSize, 
-        reinterpret_cast<fftwf_complex*>(m_dxDisplacementX),
-        reinterpret_cast<fftwf_complex*>(m_dxDisplacementX),
-        FFTW_BACKWARD,
-        FFTW_MEASURE);
-    m_PlandzDisplacementZ = fftwf_plan_dft_2d(
-        kSize, kSize, 
-        reinterpret_cast<fftwf_complex*>(m_dzDisplacementZ),
-        reinterpret_cast<fftwf_complex*>(m_dzDisplacementZ),
-        FFTW_BACKWARD,
-        FFTW_MEASURE);
-#ifdef COMPUTE_JACOBIAN
-    m_PlandzDisplacementX = fftwf_plan_dft_2d(
-        kSize, kSize, 
-        reinterpret_cast<fftwf_complex*>(m_dzDisplacementX),
-        reinterpret_cast<fftwf_complex*>(m_dzDisplacementX),
-        FFTW_BACKWARD,
-        FFTW_MEASURE);
-    m_PlandxDisplacementZ = fftwf_plan_dft_2d(
-        kSize, kSize, 
-        reinterpret_cast<fftwf_complex*>(m_dxDisplacementZ),
-        reinterpret_cast<fftwf_complex*>(m_dxDisplacementZ),
-        FFTW_BACKWARD,
-        FFTW_MEASURE);
+    FFTSchedule schedule = m_FFTScheduleRequest;
+    if (schedule == FFTSchedule::Auto)
+    {
+        // Threading a small transform costs more than it saves, and with less
+        //  than two cores per transform, they keep all cores busy on their own
+        if (m_TileSize < s_kMinThreadedFFTSize ||
+            kThreadCount < 2 * kTransformCount)
+        {
+            schedule = FFTSchedule::Transforms;
+        }
+        // Concurrent large transforms thrash the shared cache
+        else if (m_TileSize >= s_kMinSequentialFFTSize)
+        {
+            schedule = FFTSchedule::Threaded;
+        }
+        else
+        {
+            schedule = FFTSchedule::Mixed;
+        }
+    }
+
+    switch (schedule)
+    {
+        case FFTSchedule::Threaded:
+            threadsPerPlan = kThreadCount;
+            break;
+        case FFTSchedule::Mixed:
+            threadsPerPlan = glm::max(kThreadCount / kTransformCount, 1u);
+            break;
+        default:
+            threadsPerPlan = 1;
+            break;
+    }
+    return schedule;
+}
+
+void WSTessendorf::ExecuteTransforms(bool isChoppy)
+{
+    VKP_PROFILE_SCOPE();
+
+    // Plans of the second fields of packed pairs are null
+    std::array<fftwf_plan, 1 + 2 * s_kFieldPairCount> plans{};
+    int32_t planCount = 0;
+
+    plans[planCount++] = m_PlanHeight;
+    for (auto& pair : GetFieldPairs())
+    {
+        // Not set up without its feature
+        if (pair.planA == nullptr)
+            continue;
+        if (pair.feature == PairFeature::Displacements && !isChoppy)
+            continue;
+
+        plans[planCount++] = pair.planA;
+        if (pair.planB != nullptr)
+            plans[planCount++] = pair.planB;
+    }
+
+    if (m_FFTSchedule == FFTSchedule::Threaded)
+    {
+        for (int32_t i = 0; i < planCount; ++i)
+            fftwf_execute(plans[i]);
+        return;
+    }
+
+    // Concurrently, each on threads of the plan
+    const int32_t kThreadCount = m_FFTSchedule == FFTSchedule::Mixed ?
+        planCount : glm::min(planCount, omp_get_max_threads());
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(kThreadCount)
+    for (int32_t i = 0; i < planCount; ++i)
+    {
+        // Of the load balance between the threads
+        VKP_PROFILE_SCOPE("FFT plan");
+        fftwf_execute(plans[i]);
+    }
+}
+
+const char* WSTessendorf::ToString(FFTSchedule schedule)
+{
+    switch (schedule)
+    {
+        case FFTSchedule::Transforms: return "Transforms";
+        case FFTSchedule::Threaded:   return "Threaded";
+        case FFTSchedule::Mixed:      return "Mixed";
+        default:                      return "Auto";
+    }
+}
+
+// -----------------------------------------------------------------------------
+// FFTW wisdom
+
+/** @return 'str' with characters other than alphanumeric replaced by '-' */
+static std::string SanitizeFileName(std::string str)
+{
+    std::replace_if(str.begin(), str.end(),
+                    [](unsigned char c) { return !std::isalnum(c); }, '-');
+    return str;
+}
+
+/** @return Brand name of the CPU, or "generic" if not available */
+static std::string GetCPUName()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    uint32_t brand[12] = {};
+    if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004)
+    {
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            __get_cpuid(0x80000002 + i, &brand[i * 4 + 0], &brand[i * 4 + 1],
+                                        &brand[i * 4 + 2], &brand[i * 4 + 3]);
+        }
+        std::string name(reinterpret_cast<const char*>(brand), sizeof(brand));
+        name.erase(std::find(name.begin(), name.end(), '\0'), name.end());
+        return name;
+    }
 #endif
+    return "generic";
+}
+
+std::string WSTessendorf::GetWisdomFileName() const
+{
+    // Keyed by FFTW build, CPU, tile size and threads per plan
+    static const std::string s_kKey =
+        SanitizeFileName(fftwf_version) + "_" + SanitizeFileName(GetCPUName());
+
+    return s_kKey + "_" + std::to_string(m_TileSize) +
+           "_t" + std::to_string(m_FFTThreadsPerPlan) + ".wisdom";
+}
+
+bool WSTessendorf::ImportWisdom() const
+{
+    VKP_PROFILE_SCOPE();
+
+    // Only wisdom of this tile size is exported
+    fftwf_forget_wisdom();
+
+    const std::string kFileName = GetWisdomFileName();
+    const std::filesystem::path kCached =
+        std::filesystem::path(s_kWisdomCacheDir) / kFileName;
+    const std::filesystem::path kShipped =
+        std::filesystem::path(s_kWisdomShippedDir) / kFileName;
+
+    if (fftwf_import_wisdom_from_filename(kCached.string().c_str()))
+    {
+        VKP_LOG_INFO("FFTW wisdom imported: {}", kCached.string());
+        return true;
+    }
+    if (fftwf_import_wisdom_from_filename(kShipped.string().c_str()))
+    {
+        VKP_LOG_INFO("FFTW wisdom imported: {}", kShipped.string());
+    }
+    return false;
+}
+
+void WSTessendorf::ExportWisdom() const
+{
+    std::error_code err;
+    std::filesystem::create_directories(s_kWisdomCacheDir, err);
+
+    const std::filesystem::path kCached =
+        std::filesystem::path(s_kWisdomCacheDir) / GetWisdomFileName();
+
+    if (!err && fftwf_export_wisdom_to_filename(kCached.string().c_str()))
+        VKP_LOG_INFO("FFTW wisdom exported: {}", kCached.string());
+    else
+        VKP_LOG_WARN("FFTW wisdom could not be exported to: {}",
+                     kCached.string());
 }
 
 void WSTessendorf::DestroyFFTW()
@@ -253,205 +619,755 @@ void WSTessendorf::DestroyFFTW()
     if (m_PlanHeight == nullptr)
         return;
 
+    std::lock_guard<std::mutex> lock(s_PlannerMutex);
     fftwf_destroy_plan(m_PlanHeight);
     m_PlanHeight = nullptr;
-    fftwf_destroy_plan(m_PlanSlopeX);
-    fftwf_destroy_plan(m_PlanSlopeZ);
-    fftwf_destroy_plan(m_PlanDisplacementX);
-    fftwf_destroy_plan(m_PlanDisplacementZ);
-    fftwf_destroy_plan(m_PlandxDisplacementX);
-    fftwf_destroy_plan(m_PlandzDisplacementZ);
-#ifdef COMPUTE_JACOBIAN
-    fftwf_destroy_plan(m_PlandxDisplacementZ);
-    fftwf_destroy_plan(m_PlandzDisplacementX);
-#endif
 
+    for (auto& pair : GetFieldPairs())
+    {
+        if (pair.planA == nullptr)
+            continue;
+
+        fftwf_destroy_plan(pair.planA);
+        pair.planA = nullptr;
+        if (pair.planB != nullptr)
+        {
+            fftwf_destroy_plan(pair.planB);
+            pair.planB = nullptr;
+        }
+        if (m_FFTInputsSeparate)
+        {
+            fftwf_free((fftwf_complex*)pair.a);
+            if (pair.b != pair.a)
+                fftwf_free((fftwf_complex*)pair.b);
+        }
+        pair.a = nullptr;
+        pair.b = nullptr;
+    }
+
+    // Or the whole block
     fftwf_free((fftwf_complex*)m_Height);
-#ifdef CAREFUL_ALLOC
-        fftwf_free((fftwf_complex*)m_SlopeX);
-        fftwf_free((fftwf_complex*)m_SlopeZ);
-        fftwf_free((fftwf_complex*)m_DisplacementX);
-        fftwf_free((fftwf_complex*)m_DisplacementZ);
-        fftwf_free((fftwf_complex*)m_dxDisplacementX);
-        fftwf_free((fftwf_complex*)m_dzDisplacementZ);
-    #ifdef COMPUTE_JACOBIAN
-        fftwf_free((fftwf_complex*)m_dxDisplacementZ);
-        fftwf_free((fftwf_complex*)m_dzDisplacementX);
-    #endif
-#endif
+    m_Height = nullptr;
 }
 
 float WSTessendorf::ComputeWaves(float t)
+{
+    m_Displacements.resize(GetDisplacementCount());
+    m_Normals.resize(m_SlopeX != nullptr ? GetNormalCount() : 0);
+
+    return ComputeWaves(t, Outputs{
+        .displacements = m_Displacements.data(),
+        .normals = m_SlopeX != nullptr ? m_Normals.data() : nullptr,
+        .isHalf = false
+    });
+}
+
+float WSTessendorf::ComputeWaves(float t, const Outputs& outputs)
 {
     VKP_PROFILE_SCOPE();
+    VKP_ASSERT_MSG(m_PlanHeight != nullptr, "FFTW is not prepared");
     const auto kTileSize = m_TileSize;
 
-    float masterMaxHeight = std::numeric_limits<float>::min();
-    float masterMinHeight = std::numeric_limits<float>::max();
+    // Null if not set up, with the derivatives of the displacements
+    const bool kHasNormals = m_SlopeX != nullptr;
+    VKP_ASSERT_MSG(kHasNormals || outputs.normals == nullptr,
+                   "Normals are not computed");
+
+    const uint32_t kBlockRows = GetSpectrumBlockRows();
+    const uint32_t kBlockCount = (kTileSize + kBlockRows - 1) / kBlockRows;
+
+    wst::PhasorSoA* phasors = m_TimeStep > 0.0f ? &m_Phasors : nullptr;
+    const wst::PhasorUpdate kPhasorUpdate = UpdatePhasorTime(t);
+
+    // Of the dispersion quantized to the period, the waves repeat after it.
+    //  Wrapped, the phases stay in the range of the SIMD sine and cosine
+    const float kPhaseTime = std::fmod(t, m_AnimationPeriod);
+
+    // Inputs of the transforms, and their results in place
+    const wst::SpectrumOutputs kOutputs{
+        .height          = m_Height,
+        .slopeX          = m_SlopeX,
+        .slopeZ          = m_SlopeZ,
+        .displacementX   = m_DisplacementX,
+        .displacementZ   = m_DisplacementZ,
+        .dxDisplacementX = m_dxDisplacementX,
+        .dzDisplacementZ = m_dzDisplacementZ,
+        .dxDisplacementZ = m_dxDisplacementZ,
+        .dzDisplacementX = m_dzDisplacementX
+    };
+
+    // Specialized on the features, and on the common tile sizes
+    const wst::OutputFeatures kFeatures{
+        .hasNormals  = kHasNormals,
+        .hasJacobian = m_dxDisplacementZ != nullptr,
+        .isChoppy    = m_Lambda != 0.0f
+    };
+    const wst::OutputRowKernel kWriteRow =
+        wst::GetOutputRowKernel(kFeatures, kTileSize);
+
+    // Reduced by the threads of the output pass
+    float maxHeight = std::numeric_limits<float>::lowest();
+    float minHeight = std::numeric_limits<float>::max();
+
+    // Spectrum of all fields in a single pass, in blocks of rows
+    #pragma omp parallel
+    {
+        // Threads of the pool are kept, each placed on its first region
+        vkp::ThreadPlacement::PlaceTeamThread(omp_get_thread_num());
+
+        #pragma omp for schedule(static)
+        for (uint32_t block = 0; block < kBlockCount; ++block)
+        {
+            VKP_PROFILE_SCOPE("Spectrum block");
+
+            const uint32_t kRowEnd =
+                glm::min((block + 1) * kBlockRows, kTileSize);
+            m_SpectrumKernel(m_Spectrum, phasors, kPhasorUpdate, kOutputs,
+                             block * kBlockRows * kTileSize,
+                             kRowEnd * kTileSize,
+                             kPhaseTime);
+        }
+    }
+
+    ExecuteTransforms(kFeatures.isChoppy);
 
-    #pragma omp parallel shared(masterMaxHeight, masterMinHeight)
+    if (outputs.isHalf)
     {
-        #pragma omp for collapse(2) schedule(static)
-        for (uint32_t m = 0; m < kTileSize; ++m)
-            for (uint32_t n = 0; n < kTileSize; ++n)
-            {
-                m_Height[m * kTileSize + n] =
-                    WaveHeightFT(m_BaseWaveHeights[m * kTileSize + n], t);
-            }
+        const size_t kScratchSize = 2 * kTileSize *
+            static_cast<size_t>(omp_get_max_threads());
+        if (m_RowScratch.size() < kScratchSize)
+            m_RowScratch.resize(kScratchSize);
+    }
 
-        // Slopes for normals computation
-        #pragma omp for collapse(2) schedule(static) nowait
+    #pragma omp parallel
+    {
+        // Half precision rows are converted from the thread's scratch
+        Displacement* rowScratch = outputs.isHalf
+            ? &m_RowScratch[2 * kTileSize * omp_get_thread_num()]
+            : nullptr;
+
+        // Reduced values are complete after the implicit barrier at the end
+        //  of the parallel region
+        #pragma omp for schedule(static) nowait \
+            reduction(max: maxHeight) reduction(min: minHeight)
         for (uint32_t m = 0; m < kTileSize; ++m)
-            for (uint32_t n = 0; n < kTileSize; ++n)
-            {
-                const uint32_t kIndex = m * kTileSize + n;
+        {
+            const size_t kRowOffset = static_cast<size_t>(m) * kTileSize;
 
-                const auto& kWaveVec = m_WaveVectors[kIndex].vec;
-                m_SlopeX[kIndex] = Complex(0, kWaveVec.x) * m_Height[kIndex];
-                m_SlopeZ[kIndex] = Complex(0, kWaveVec.y) * m_Height[kIndex];
-            }
+            Displacement* rowDisplacements = outputs.isHalf
+                ? rowScratch
+                : static_cast<Displacement*>(outputs.displacements) + kRowOffset;
+            Normal* rowNormals = outputs.isHalf || !kHasNormals
+                ? rowScratch + kTileSize
+                : static_cast<Normal*>(outputs.normals) + kRowOffset;
 
-        // Displacement vectors
-        #pragma omp for collapse(2) schedule(static)
-        for (uint32_t m = 0; m < kTileSize; ++m)
-            for (uint32_t n = 0; n < kTileSize; ++n)
+            kWriteRow(kOutputs, m_Lambda, kTileSize, m,
+                      glm::value_ptr(rowDisplacements[0]),
+                      kHasNormals ? glm::value_ptr(rowNormals[0]) : nullptr,
+                      minHeight, maxHeight);
+
+            if (outputs.isHalf)
             {
-                const uint32_t kIndex = m * kTileSize + n;
-
-                const auto& kWaveVec = m_WaveVectors[kIndex];
-                m_DisplacementX[kIndex] = Complex(0, -kWaveVec.unit.x) *
-                                          m_Height[kIndex];
-                m_DisplacementZ[kIndex] = Complex(0, -kWaveVec.unit.y) *
-                                          m_Height[kIndex];
-                m_dxDisplacementX[kIndex] = Complex(0, kWaveVec.vec.x) *
-                                            m_DisplacementX[kIndex];
-                m_dzDisplacementZ[kIndex] = Complex(0, kWaveVec.vec.y) *
-                                            m_DisplacementZ[kIndex];
-            #ifdef COMPUTE_JACOBIAN
-                m_dzDisplacementX[kIndex] = Complex(0, kWaveVec.vec.y) *
-                                            m_DisplacementX[kIndex];
-                m_dxDisplacementZ[kIndex] = Complex(0, kWaveVec.vec.x) *
-                                            m_DisplacementZ[kIndex];
-            #endif
+                const size_t kRowFloats = 4 * static_cast<size_t>(kTileSize);
+                m_ConvertToHalf(glm::value_ptr(rowDisplacements[0]),
+                    static_cast<uint16_t*>(outputs.displacements) +
+                        4 * kRowOffset,
+                    kRowFloats);
+                if (kHasNormals)
+                {
+                    m_ConvertToHalf(glm::value_ptr(rowNormals[0]),
+                        static_cast<uint16_t*>(outputs.normals) + 4 * kRowOffset,
+                        kRowFloats);
+                }
             }
+        }
+    }
+
+    m_MinHeight = minHeight;
+    m_MaxHeight = maxHeight;
+
+    if (m_QueriesEnabled)
+        UpdateQuerySnapshot(t);
+
+    return glm::max( glm::abs(minHeight), glm::abs(maxHeight) );
+}
+
+uint32_t WSTessendorf::GetSpectrumBlockRows() const
+{
+    // Read: the spectrum arrays, written: inputs of transforms
+    const uint32_t kSpectrumArrays = 9;
+    const uint32_t kTotalInputs = GetTransformCount();
+    const size_t kRowBytes = m_TileSize * (kSpectrumArrays * sizeof(float) +
+                                           kTotalInputs * sizeof(Complex));
+
+    // Yet at least one block per thread
+    const uint32_t kThreadCount = static_cast<uint32_t>(omp_get_max_threads());
+    const uint32_t kRowsPerThread = (m_TileSize + kThreadCount - 1) /
+                                    kThreadCount;
+
+    const uint32_t kBlockRows =
+        static_cast<uint32_t>(s_kSpectrumBlockBytes / kRowBytes);
+    return glm::clamp(kBlockRows, 1u, glm::max(kRowsPerThread, 1u));
+}
+
+// -----------------------------------------------------------------------------
+// Cache of the structures of other tile sizes
+
+void WSTessendorf::SwapTile(CachedTile& tile)
+{
+    std::swap(m_WaveVectors, tile.waveVectors);
+    std::swap(m_GaussRandoms, tile.gaussRandoms);
+    std::swap(m_Spectrum, tile.spectrum);
+    std::swap(m_Phasors, tile.phasors);
+
+    std::swap(m_Height, tile.height);
+    std::swap(m_PlanHeight, tile.planHeight);
+
+    auto pairs = GetFieldPairs();
+    for (uint32_t i = 0; i < pairs.size(); ++i)
+    {
+        std::swap(pairs[i].a, tile.pairInputs[2 * i]);
+        std::swap(pairs[i].b, tile.pairInputs[2 * i + 1]);
+        std::swap(pairs[i].planA, tile.pairPlans[2 * i]);
+        std::swap(pairs[i].planB, tile.pairPlans[2 * i + 1]);
+    }
+    std::swap(m_FFTSchedule, tile.fftSchedule);
+    std::swap(m_FFTThreadsPerPlan, tile.fftThreadsPerPlan);
+    std::swap(m_FFTThreadCount, tile.fftThreadCount);
+    std::swap(m_FFTFirstTouch, tile.fftFirstTouch);
+    std::swap(m_FFTInputsSeparate, tile.fftInputsSeparate);
+}
+
+void WSTessendorf::StashTile()
+{
+    // Nothing built yet
+    if (m_WaveVectors.empty() && m_Spectrum.Size() == 0 &&
+        m_PlanHeight == nullptr)
+        return;
+
+    CachedTile tile{
+        .tileSize           = m_TileSize,
+        .lastUsed           = ++m_TileSelections,
+        .tileLength         = m_TileLength,
+        .seed               = m_Seed,
+        .spectrumVersion    = m_BuiltSpectrumVersion,
+        .timeStep           = m_TimeStep,
+        .packedFFT          = m_PackedFFT,
+        .computeNormals     = m_ComputeNormals,
+        .computeJacobian    = m_ComputeJacobian,
+        .separateFFTInputs  = m_SeparateFFTInputs,
+        .fftScheduleRequest = m_FFTScheduleRequest,
+        .waveVectorsDirty   = m_WaveVectorsDirty,
+        .gaussRandomsDirty  = m_GaussRandomsDirty,
+        .fftwDirty          = m_FFTWDirty
+    };
+    SwapTile(tile);
+
+    m_TileCache.push_back(std::move(tile));
+}
+
+bool WSTessendorf::RestoreTile()
+{
+    auto it = std::find_if(m_TileCache.begin(), m_TileCache.end(),
+        [this](const CachedTile& kTile) {
+            return kTile.tileSize == m_TileSize;
+        });
+    if (it == m_TileCache.end())
+        return false;
+
+    VKP_LOG_INFO("Water surface resolution {} restored from the cache",
+                 m_TileSize);
+
+    CachedTile tile = std::move(*it);
+    m_TileCache.erase(it);
+    SwapTile(tile);
+
+    m_WaveVectorsDirty = tile.waveVectorsDirty ||
+                         tile.tileLength != m_TileLength;
+    m_GaussRandomsDirty = tile.gaussRandomsDirty || tile.seed != m_Seed;
+    m_BuiltSpectrumVersion = tile.spectrumVersion;
+    m_FFTWDirty = tile.fftwDirty ||
+                  tile.packedFFT != m_PackedFFT ||
+                  tile.computeNormals != m_ComputeNormals ||
+                  tile.computeJacobian != m_ComputeJacobian ||
+                  tile.separateFFTInputs != m_SeparateFFTInputs ||
+                  tile.fftScheduleRequest != m_FFTScheduleRequest;
+
+    // Threads of FFTW nested within the concurrent transforms, as set up
+    if (m_PlanHeight != nullptr)
+        omp_set_max_active_levels(m_FFTSchedule == FFTSchedule::Mixed ? 2 : 1);
+
+    // Phasors are of the time when cached
+    m_PhasorsValid = false;
+    if (tile.timeStep != m_TimeStep)
+        ComputePhasorSteps();
+
+    return true;
+}
+
+void WSTessendorf::EvictTiles()
+{
+    size_t totalSize = GetTileCacheSize();
+
+    while (totalSize > m_TileCacheBudget && !m_TileCache.empty())
+    {
+        auto leastUsed = std::min_element(m_TileCache.begin(),
+                                          m_TileCache.end(),
+            [](const CachedTile& kA, const CachedTile& kB) {
+                return kA.lastUsed < kB.lastUsed;
+            });
+
+        VKP_LOG_INFO("Freeing water surface structures of resolution {}",
+                     leastUsed->tileSize);
+
+        totalSize -= GetTileBytes(*leastUsed);
+        FreeTile(*leastUsed);
+        m_TileCache.erase(leastUsed);
+    }
+}
+
+void WSTessendorf::FreeTile(CachedTile& tile)
+{
+    // Plans and memory are freed as the current ones, which are swapped back
+    SwapTile(tile);
+    DestroyFFTW();
+    SwapTile(tile);
+}
+
+size_t WSTessendorf::GetTileBytes(const CachedTile& kTile)
+{
+    const size_t kSize2 = static_cast<size_t>(kTile.tileSize) * kTile.tileSize;
+
+    // Inputs of the transforms, the second ones of packed pairs alias
+    size_t inputCount = kTile.height != nullptr ? 1 : 0;
+    for (size_t i = 0; i < kTile.pairInputs.size(); i += 2)
+    {
+        inputCount += kTile.pairInputs[i] != nullptr;
+        inputCount += kTile.pairInputs[i + 1] != nullptr &&
+                      kTile.pairInputs[i + 1] != kTile.pairInputs[i];
+    }
+
+    // Arrays of the SoA layouts
+    constexpr size_t kSpectrumArrayCount = 9;
+    constexpr size_t kPhasorArrayCount = 4;
+
+    return inputCount * kSize2 * sizeof(Complex) +
+           kTile.waveVectors.size() * sizeof(WaveVector) +
+           kTile.gaussRandoms.size() * sizeof(Complex) +
+           kTile.spectrum.Size() * kSpectrumArrayCount * sizeof(float) +
+           kTile.phasors.Size() * kPhasorArrayCount * sizeof(float);
+}
+
+size_t WSTessendorf::GetTileCacheSize() const
+{
+    size_t totalSize = 0;
+    for (const auto& kTile : m_TileCache)
+        totalSize += GetTileBytes(kTile);
+    return totalSize;
+}
+
+void WSTessendorf::SetTileCacheBudget(size_t budget)
+{
+    m_TileCacheBudget = budget;
+    EvictTiles();
+}
+
+void WSTessendorf::AdoptTileSize(WSTessendorf& prepared)
+{
+    VKP_REGISTER_FUNCTION();
+
+    if (prepared.m_TileSize == m_TileSize)
+        return;
+
+    // Its structures into its own cache, of the properties they were built of
+    prepared.StashTile();
+    if (prepared.m_TileCache.empty())
+    {
+        SetTileSize(prepared.m_TileSize);
+        return;
+    }
+
+    // Replaces any cached one of the size
+    auto it = std::find_if(m_TileCache.begin(), m_TileCache.end(),
+        [&prepared](const CachedTile& kTile) {
+            return kTile.tileSize == prepared.m_TileSize;
+        });
+    if (it != m_TileCache.end())
+    {
+        FreeTile(*it);
+        m_TileCache.erase(it);
+    }
+
+    m_TileCache.push_back(std::move(prepared.m_TileCache.back()));
+    prepared.m_TileCache.pop_back();
+
+    // Restored before the eviction of the others
+    SetTileSize(prepared.m_TileSize);
+}
+
+void WSTessendorf::SetSimdLevel(wst::SimdLevel level)
+{
+    m_SimdLevel = std::min(level, wst::GetSupportedSimdLevel());
+    m_SpectrumKernel = wst::GetSpectrumKernel(m_SimdLevel);
+    m_ConvertToHalf = wst::GetHalfConvertKernel(m_SimdLevel);
+
+    VKP_LOG_INFO("Water surface spectrum kernel: {}",
+                 wst::ToString(m_SimdLevel));
+}
+
+void WSTessendorf::SetTimeStep(float dt)
+{
+    m_TimeStep = glm::max(dt, 0.0f);
+    ComputePhasorSteps();
+}
+
+void WSTessendorf::ComputePhasorSteps()
+{
+    m_PhasorsValid = false;
+
+    if (m_TimeStep <= 0.0f)
+    {
+        m_Phasors = wst::PhasorSoA();
+        return;
+    }
+
+    VKP_PROFILE_SCOPE();
+    m_Phasors.Resize(m_Spectrum.Size());
+
+    const float kTimeStep = m_TimeStep;
 
-        #pragma omp sections
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < m_Phasors.Size(); ++i)
+    {
+        const float kOmega_dt = m_Spectrum.dispersion[i] * kTimeStep;
+        m_Phasors.stepRe[i] = glm::cos(kOmega_dt);
+        m_Phasors.stepIm[i] = glm::sin(kOmega_dt);
+    }
+}
+
+wst::PhasorUpdate WSTessendorf::UpdatePhasorTime(float t)
+{
+    if (m_TimeStep <= 0.0f)
+        return wst::PhasorUpdate::Evaluate;
+
+    const bool kIsNextStep =
+        m_PhasorsValid &&
+        glm::abs(t - (m_PhasorTime + m_TimeStep)) <=
+            m_TimeStep * s_kTimeStepTolerance;
+
+    m_PhasorTime = t;
+    m_PhasorsValid = true;
+
+    if (!kIsNextStep)
+    {
+        m_PhasorSteps = 0;
+        return wst::PhasorUpdate::Evaluate;
+    }
+
+    // Re-seeded from sin and cos, the rotations drift in both the magnitude
+    //  and the phase
+    if (++m_PhasorSteps >= s_kPhasorReseedPeriod)
+    {
+        m_PhasorSteps = 0;
+        return wst::PhasorUpdate::Evaluate;
+    }
+    return wst::PhasorUpdate::Advance;
+}
+
+// -----------------------------------------------------------------------------
+// Queries
+
+/**
+ * @brief Bilinearly samples the fields of a tile, repeated every 'size'
+ *  texels, at grid coordinates 'x' (column) and 'z' (row) of 'count' points
+ */
+template<size_t kFieldCount>
+static void SampleBilinear(const std::array<const float*, kFieldCount>& fields,
+                           uint32_t size,
+                           const float* x,
+                           const float* z,
+                           uint32_t count,
+                           const std::array<float*, kFieldCount>& results)
+{
+    // Of a power of two size
+    const int32_t kMask = static_cast<int32_t>(size) - 1;
+
+    #pragma omp simd
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float kX = std::floor(x[i]);
+        const float kZ = std::floor(z[i]);
+        const float kFracX = x[i] - kX;
+        const float kFracZ = z[i] - kZ;
+
+        const int32_t kN0 = static_cast<int32_t>(kX) & kMask;
+        const int32_t kM0 = static_cast<int32_t>(kZ) & kMask;
+        const int32_t kN1 = (kN0 + 1) & kMask;
+        const int32_t kM1 = (kM0 + 1) & kMask;
+        const int32_t kRow0 = kM0 * static_cast<int32_t>(size);
+        const int32_t kRow1 = kM1 * static_cast<int32_t>(size);
+
+        for (size_t f = 0; f < kFieldCount; ++f)
         {
-            #pragma omp section
-            {
-                fftwf_execute(m_PlanHeight);
-            }
-            #pragma omp section
-            {
-                fftwf_execute(m_PlanSlopeX);
-            }
-            #pragma omp section
-            {
-                fftwf_execute(m_PlanSlopeZ);
-            }
-            #pragma omp section
-            {
-                fftwf_execute(m_PlanDisplacementX);
-            }
-            #pragma omp section
-            {
-                fftwf_execute(m_PlanDisplacementZ);
-            }
-            #pragma omp section
-            {
-                fftwf_execute(m_PlandxDisplacementX);
-            }
-            #pragma omp section
-            {
-                fftwf_execute(m_PlandzDisplacementZ);
-            }
-        #ifdef COMPUTE_JACOBIAN
-            #pragma omp section
-            {
-                fftwf_execute(m_PlandzDisplacementX);
-            }
-            #pragma omp section
-            {
-                fftwf_execute(m_PlandxDisplacementZ);
-            }
-        #endif
+            const float* kField = fields[f];
+            const float kTop = kField[kRow0 + kN0] +
+                kFracX * (kField[kRow0 + kN1] - kField[kRow0 + kN0]);
+            const float kBottom = kField[kRow1 + kN0] +
+                kFracX * (kField[kRow1 + kN1] - kField[kRow1 + kN0]);
+            results[f][i] = kTop + kFracZ * (kBottom - kTop);
         }
+    }
+}
 
-        float maxHeight = std::numeric_limits<float>::min();
-        float minHeight = std::numeric_limits<float>::max();
+std::shared_ptr<WSTessendorf::QuerySnapshot>
+WSTessendorf::AcquireQuerySnapshot(float t, uint32_t size)
+{
+    // Spare one is reused unless a query still holds it
+    std::shared_ptr<QuerySnapshot> snapshot = std::move(m_QuerySpare);
+    if (snapshot == nullptr || snapshot.use_count() > 1)
+        snapshot = std::make_shared<QuerySnapshot>();
+
+    snapshot->tileSize = size;
+    snapshot->tileLength = m_TileLength;
+    snapshot->time = t;
+    snapshot->spectrumVersion = m_BuiltSpectrumVersion;
+
+    const size_t kSize = static_cast<size_t>(size) * size;
+    for (auto* field : { &snapshot->displacementX, &snapshot->height,
+                         &snapshot->displacementZ, &snapshot->slopeX,
+                         &snapshot->slopeZ, &snapshot->velocityX,
+                         &snapshot->velocityY, &snapshot->velocityZ })
+    {
+        field->resize(kSize);
+    }
+    return snapshot;
+}
 
-        // Conversion of the grid back to interval
-        //  [-m_TileSize/2, ..., 0, ..., m_TileSize/2]
-        const float kSigns[] = { 1.0f, -1.0f };
+void WSTessendorf::PublishQuerySnapshot(
+    std::shared_ptr<QuerySnapshot> snapshot,
+    bool hasSlopes
+)
+{
+    VKP_PROFILE_SCOPE();
 
-        #pragma omp for collapse(2) schedule(static) nowait
-        for (uint32_t m = 0; m < kTileSize; ++m)
+    QuerySnapshot& next = *snapshot;
+    const uint32_t kSize = next.tileSize;
+    const uint32_t kMask = kSize - 1;
+
+    // Velocities of the same waves only, shortly before
+    const QuerySnapshot* kPrevious = m_QueryLast.get();
+    const bool kHasPrevious =
+        kPrevious != nullptr &&
+        kPrevious->tileSize == kSize &&
+        kPrevious->tileLength == next.tileLength &&
+        kPrevious->spectrumVersion == next.spectrumVersion &&
+        next.time > kPrevious->time &&
+        next.time - kPrevious->time <= s_kMaxQueryTimeDelta;
+    const float kInvTimeDelta =
+        kHasPrevious ? 1.0f / (next.time - kPrevious->time) : 0.0f;
+
+    // Of the slopes differenced over two texels
+    const float kInvTexelLength2 =
+        static_cast<float>(kSize) / (2.0f * next.tileLength);
+
+    #pragma omp parallel for schedule(static)
+    for (uint32_t m = 0; m < kSize; ++m)
+    {
+        const size_t kRow = static_cast<size_t>(m) * kSize;
+
+        if (!hasSlopes)
         {
-            for (uint32_t n = 0; n < kTileSize; ++n)
+            // Central differences of the heights
+            const float* kHeights = &next.height[kRow];
+            const float* kUp =
+                &next.height[static_cast<size_t>((m + 1) & kMask) * kSize];
+            const float* kDown =
+                &next.height[static_cast<size_t>((m - 1) & kMask) * kSize];
+
+            for (uint32_t n = 0; n < kSize; ++n)
             {
-                const uint32_t kIndex = m * kTileSize + n;
-                const int sign = kSigns[(n + m) & 1];
-                const auto h_FT = m_Height[kIndex].real() * static_cast<float>(sign);
-                maxHeight = glm::max(h_FT, maxHeight);
-                minHeight = glm::min(h_FT, minHeight);
-
-                auto& displacement = m_Displacements[kIndex];
-                displacement.y = h_FT;
-                displacement.x =
-                    static_cast<float>(sign) * m_Lambda * m_DisplacementX[kIndex].real();
-                displacement.z =
-                    static_cast<float>(sign) * m_Lambda * m_DisplacementZ[kIndex].real();
-                displacement.w = 1.0f;
+                next.slopeX[kRow + n] = kInvTexelLength2 *
+                    (kHeights[(n + 1) & kMask] - kHeights[(n - 1) & kMask]);
+                next.slopeZ[kRow + n] = kInvTexelLength2 * (kUp[n] - kDown[n]);
             }
         }
-        // TODO reduction
-        #pragma omp critical
+
+        if (!kHasPrevious)
         {
-            masterMaxHeight = glm::max(maxHeight, masterMaxHeight);
-            masterMinHeight = glm::min(minHeight, masterMinHeight);
+            std::fill_n(&next.velocityX[kRow], kSize, 0.0f);
+            std::fill_n(&next.velocityY[kRow], kSize, 0.0f);
+            std::fill_n(&next.velocityZ[kRow], kSize, 0.0f);
+            continue;
         }
 
-        #pragma omp for collapse(2) schedule(static) nowait
-        for (uint32_t m = 0; m < kTileSize; ++m)
+        #pragma omp simd
+        for (uint32_t n = 0; n < kSize; ++n)
         {
-            for (uint32_t n = 0; n < kTileSize; ++n)
+            const size_t kIndex = kRow + n;
+            next.velocityX[kIndex] = kInvTimeDelta *
+                (next.displacementX[kIndex] - kPrevious->displacementX[kIndex]);
+            next.velocityY[kIndex] = kInvTimeDelta *
+                (next.height[kIndex] - kPrevious->height[kIndex]);
+            next.velocityZ[kIndex] = kInvTimeDelta *
+                (next.displacementZ[kIndex] - kPrevious->displacementZ[kIndex]);
+        }
+    }
+
+    // Previous published one is spare once no query holds it
+    m_QuerySpare = std::move(m_QueryLast);
+    m_QueryLast = snapshot;
+    std::shared_ptr<const QuerySnapshot> published = std::move(snapshot);
+    std::atomic_store(&m_QuerySnapshot, std::move(published));
+}
+
+void WSTessendorf::UpdateQuerySnapshot(float t)
+{
+    VKP_PROFILE_SCOPE();
+
+    const uint32_t kTileSize = m_TileSize;
+    const bool kHasNormals = m_SlopeX != nullptr;
+
+    std::shared_ptr<QuerySnapshot> snapshot =
+        AcquireQuerySnapshot(t, kTileSize);
+    QuerySnapshot& next = *snapshot;
+
+    #pragma omp parallel for schedule(static)
+    for (uint32_t m = 0; m < kTileSize; ++m)
+    {
+        for (uint32_t n = 0; n < kTileSize; ++n)
+        {
+            const uint32_t kIndex = m * kTileSize + n;
+            // Same conversion of the grid as of the outputs
+            const float kSign = ((n + m) & 1) ? -1.0f : 1.0f;
+
+            // Not transformed of a lambda of 0, still finite, zeroed by it
+            next.displacementX[kIndex] =
+                kSign * m_Lambda * m_DisplacementX[kIndex].real();
+            next.height[kIndex] = kSign * m_Height[kIndex].real();
+            next.displacementZ[kIndex] = kSign * m_Lambda *
+                wst::GetSecondOfPair(m_DisplacementX, m_DisplacementZ, kIndex);
+
+            if (kHasNormals)
             {
-                const uint32_t kIndex = m * kTileSize + n;
-                const int sign = kSigns[(n + m) & 1];
-            #ifdef COMPUTE_JACOBIAN
-                const float jacobian =
-                    (1.0f + m_Lambda * sign * m_dxDisplacementX[kIndex].real()) *
-                    (1.0f + m_Lambda * sign * m_dzDisplacementZ[kIndex].real()) -
-                    (m_Lambda * sign * m_dxDisplacementZ[kIndex].real()) *
-                    (m_Lambda * sign * m_dzDisplacementX[kIndex].real());
-                displacement.w = jacobian;
-            #endif
-
-                m_Normals[kIndex] = glm::vec4(
-                    sign * m_SlopeX[kIndex].real(),
-                    sign * m_SlopeZ[kIndex].real(),
-                    sign * m_dxDisplacementX[kIndex].real(),
-                    sign * m_dzDisplacementZ[kIndex].real()
-                );
+                next.slopeX[kIndex] = kSign * m_SlopeX[kIndex].real();
+                next.slopeZ[kIndex] =
+                    kSign * wst::GetSecondOfPair(m_SlopeX, m_SlopeZ, kIndex);
             }
         }
     }
 
-    return NormalizeHeights(masterMinHeight, masterMaxHeight);
+    PublishQuerySnapshot(std::move(snapshot), kHasNormals);
 }
 
-float WSTessendorf::NormalizeHeights(float minHeight, float maxHeight)
+void WSTessendorf::SetQueryDisplacements(float time,
+                                         uint32_t size,
+                                         const Displacement* displacements)
 {
-    m_MinHeight = minHeight;
-    m_MaxHeight = maxHeight;
+    VKP_ASSERT_MSG(size > 0 && (size & (size - 1)) == 0,
+                   "Size of the displacements must be a power of two");
+    if (!m_QueriesEnabled)
+        return;
 
-    const float A = glm::max( glm::abs(minHeight), glm::abs(maxHeight) );
-    const float OneOverA = 1.f / A;
+    std::shared_ptr<QuerySnapshot> snapshot = AcquireQuerySnapshot(time, size);
+    QuerySnapshot& next = *snapshot;
 
-    std::for_each(m_Displacements.begin(), m_Displacements.end(),
-                  [OneOverA](auto& d){ d.y *= OneOverA; });
+    const size_t kCount = static_cast<size_t>(size) * size;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        next.displacementX[i] = displacements[i].x;
+        next.height[i] = displacements[i].y;
+        next.displacementZ[i] = displacements[i].z;
+    }
 
-    return A;
+    PublishQuerySnapshot(std::move(snapshot), false);
+}
+
+bool WSTessendorf::QueryWaves(const glm::vec2* points,
+                              size_t count,
+                              WaterSample* samples) const
+{
+    VKP_PROFILE_SCOPE();
+
+    // Kept alive while sampled, even if replaced meanwhile
+    const std::shared_ptr<const QuerySnapshot> kSnapshot =
+        std::atomic_load(&m_QuerySnapshot);
+    if (kSnapshot == nullptr)
+        return false;
+
+    const QuerySnapshot& kS = *kSnapshot;
+    const float kSize = static_cast<float>(kS.tileSize);
+    const float kTexelsPerMeter = kSize / kS.tileLength;
+
+    // Grid coordinates of the points, and of their undisplaced grid points
+    alignas(64) float pointX[s_kQueryBatch];
+    alignas(64) float pointZ[s_kQueryBatch];
+    alignas(64) float gridX[s_kQueryBatch];
+    alignas(64) float gridZ[s_kQueryBatch];
+
+    alignas(64) float displacementX[s_kQueryBatch];
+    alignas(64) float displacementZ[s_kQueryBatch];
+    alignas(64) float height[s_kQueryBatch];
+    alignas(64) float slopeX[s_kQueryBatch];
+    alignas(64) float slopeZ[s_kQueryBatch];
+    alignas(64) float velocityX[s_kQueryBatch];
+    alignas(64) float velocityY[s_kQueryBatch];
+    alignas(64) float velocityZ[s_kQueryBatch];
+
+    for (size_t begin = 0; begin < count; begin += s_kQueryBatch)
+    {
+        const uint32_t kCount = static_cast<uint32_t>(
+            std::min<size_t>(count - begin, s_kQueryBatch));
+        const glm::vec2* kPoints = points + begin;
+
+        // Within the tile, the precision is not lost far from the origin
+        #pragma omp simd
+        for (uint32_t i = 0; i < kCount; ++i)
+        {
+            const float kX = kPoints[i].x * kTexelsPerMeter;
+            const float kZ = kPoints[i].y * kTexelsPerMeter;
+            pointX[i] = kX - kSize * std::floor(kX / kSize);
+            pointZ[i] = kZ - kSize * std::floor(kZ / kSize);
+            gridX[i] = pointX[i];
+            gridZ[i] = pointZ[i];
+        }
+
+        // Of p = x + D(x), by x = p - D(x)
+        for (uint32_t iteration = 0; iteration < s_kQueryIterations;
+             ++iteration)
+        {
+            SampleBilinear<2>(
+                { kS.displacementX.data(), kS.displacementZ.data() },
+                kS.tileSize, gridX, gridZ, kCount,
+                { displacementX, displacementZ });
+
+            #pragma omp simd
+            for (uint32_t i = 0; i < kCount; ++i)
+            {
+                gridX[i] = pointX[i] - displacementX[i] * kTexelsPerMeter;
+                gridZ[i] = pointZ[i] - displacementZ[i] * kTexelsPerMeter;
+            }
+        }
+
+        SampleBilinear<6>(
+            { kS.height.data(), kS.slopeX.data(), kS.slopeZ.data(),
+              kS.velocityX.data(), kS.velocityY.data(),
+              kS.velocityZ.data() },
+            kS.tileSize, gridX, gridZ, kCount,
+            { height, slopeX, slopeZ, velocityX, velocityY, velocityZ });
+
+        for (uint32_t i = 0; i < kCount; ++i)
+        {
+            samples[begin + i] = WaterSample{
+                .height = height[i],
+                .normal = glm::normalize(
+                    glm::vec3(-slopeX[i], 1.0f, -slopeZ[i])),
+                .velocity = glm::vec3(velocityX[i], velocityY[i],
+                                      velocityZ[i])
+            };
+        }
+    }
+
+    return true;
 }
 
 // =============================================================================
@@ -461,36 +1377,106 @@ void WSTessendorf::SetTileSize(uint32_t size)
     const bool kSizeIsPowerOfTwo = ( size & (size-1) ) == 0;
     VKP_ASSERT_MSG(size > 0 && kSizeIsPowerOfTwo,
                    "Tile size must be power of two");
-    if (!kSizeIsPowerOfTwo)
+    if (!kSizeIsPowerOfTwo || size == m_TileSize)
         return;
 
+    StashTile();
     m_TileSize = size;
+
+    // Results of the previous size
+    std::vector<Displacement>().swap(m_Displacements);
+    std::vector<Normal>().swap(m_Normals);
+
+    if (!RestoreTile())
+        Invalidate();
+    EvictTiles();
 }
 
 void WSTessendorf::SetTileLength(float length)
 {
     VKP_ASSERT(length > 0.0);
+    if (length == m_TileLength)
+        return;
+
     m_TileLength = length;
+    m_WaveVectorsDirty = true;
+}
+
+void WSTessendorf::SetSeed(uint64_t seed)
+{
+    if (seed == m_Seed)
+        return;
+
+    m_Seed = seed;
+    m_GaussRandomsDirty = true;
+}
+
+void WSTessendorf::SetPackedFFT(bool packed)
+{
+    m_FFTWDirty |= packed != m_PackedFFT;
+    m_PackedFFT = packed;
+}
+
+void WSTessendorf::SetComputeNormals(bool compute)
+{
+    m_FFTWDirty |= compute != m_ComputeNormals;
+    m_ComputeNormals = compute;
+}
+
+void WSTessendorf::SetComputeJacobian(bool compute)
+{
+    m_FFTWDirty |= compute != m_ComputeJacobian;
+    m_ComputeJacobian = compute;
+}
+
+void WSTessendorf::SetSeparateFFTInputs(bool separate)
+{
+    m_FFTWDirty |= separate != m_SeparateFFTInputs;
+    m_SeparateFFTInputs = separate;
+}
+
+void WSTessendorf::SetQueriesEnabled(bool enable)
+{
+    m_QueriesEnabled = enable;
+    if (enable)
+        return;
+
+    std::atomic_store(&m_QuerySnapshot,
+                      std::shared_ptr<const QuerySnapshot>());
+    m_QueryLast.reset();
+    m_QuerySpare.reset();
+}
+
+void WSTessendorf::SetFFTSchedule(FFTSchedule schedule)
+{
+    m_FFTWDirty |= schedule != m_FFTScheduleRequest;
+    m_FFTScheduleRequest = schedule;
 }
 
 void WSTessendorf::SetWindDirection(const glm::vec2& w)
 {
-    m_WindDir = glm::normalize(w);
+    const glm::vec2 kWindDir = glm::normalize(w);
+    m_SpectrumVersion += kWindDir != m_WindDir;
+    m_WindDir = kWindDir;
 }
 
 void WSTessendorf::SetWindSpeed(float v)
 {
-    m_WindSpeed = glm::max(0.0001f, v);
+    const float kWindSpeed = glm::max(0.0001f, v);
+    m_SpectrumVersion += kWindSpeed != m_WindSpeed;
+    m_WindSpeed = kWindSpeed;
 }
 
 void WSTessendorf::SetAnimationPeriod(float T)
 {
+    m_SpectrumVersion += T != m_AnimationPeriod;
     m_AnimationPeriod = T;
     m_BaseFreq = 2.0f * M_PI / m_AnimationPeriod;
 }
 
 void WSTessendorf::SetPhillipsConst(float A)
 {
+    m_SpectrumVersion += A != m_A;
     m_A = A;
 }
 
@@ -501,6 +1487,13 @@ void WSTessendorf::SetLambda(float lambda)
 
 void WSTessendorf::SetDamping(float damping)
 {
+    m_SpectrumVersion += damping != m_Damping;
     m_Damping = damping;
 }
 
+void WSTessendorf::SetMinWaveNumber(float k)
+{
+    m_SpectrumVersion += k != m_MinWaveNumber;
+    m_MinWaveNumber = k;
+}
+
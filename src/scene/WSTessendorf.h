@@ -6,16 +6,22 @@
 #ifndef WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_H_
 #define WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_H_
 
+#include <array>
+#include <string>
+#include <string_view>
 #include <complex>
 #include <vector>
 #include <random>
 #include <memory>
+#include <mutex>
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 
 #include <fftw3.h>
 
+#include "scene/WSTessendorfKernels.h"
+
 /**
  * @brief Generates data used for rendering the water surface
  *  - displacements
@@ -41,6 +47,10 @@ public:
     static constexpr float        s_kDefaultAnimPeriod{ 200.0f };
     static constexpr float        s_kDefaultPhillipsConst{ 3e-7f };
     static constexpr float        s_kDefaultPhillipsDamping{ 0.1f };
+    static constexpr uint64_t     s_kDefaultSeed{ 1 };
+
+    /// Of the structures of the tile sizes other than the current one
+    static constexpr size_t s_kDefaultTileCacheBudget{ 128ull << 20 };
 
     // Both vec4 due to GPU memory alignment requirements
     using Displacement = glm::vec4;
@@ -57,25 +67,86 @@ public:
      */
     WSTessendorf(uint32_t tileSize = WSTessendorf::s_kDefaultTileSize,
                  float tileLength  = WSTessendorf::s_kDefaultTileLength);
+    /**
+     * @brief Of the current properties of 'other', none of its structures,
+     *  e.g., to prepare another tile size apart from it, on another thread
+     *  while its waves are computed, @see AdoptTileSize()
+     */
+    WSTessendorf(const WSTessendorf& other, uint32_t tileSize);
     ~WSTessendorf();
 
     /**
      * @brief (Re)Creates necessary structures according to the previously set
-     *  properties:
-     *  a) Computes wave vectors
-     *  b) Computes base wave height field amplitudes
-     *  c) Sets up FFTW memory and plans
+     *  properties, only those of the changed ones:
+     *  a) Computes wave vectors, of the tile size and length
+     *  b) Computes random numbers, of the tile size and the seed
+     *  c) Computes base wave height field amplitudes, of all the properties
+     *  d) Sets up FFTW memory and plans, of the tile size, the packing,
+     *   the normals, the Jacobian, the allocation and the FFT schedule
      */
     void Prepare();
 
+    /**
+     * @brief (Re)Creates only the spectrum according to the previously set
+     *  properties (a - c) of "Prepare()"), releases FFTW.
+     *  Used when the waves are computed elsewhere, e.g., @see GetSpectrum()
+     */
+    void PrepareSpectrum();
+
+    /** @brief The next "Prepare()" recreates all the structures */
+    void Invalidate();
+
     /**
      * @brief Computes the wave height, horizontal displacement,
      *  and normal for each vertex. "Prepare()" must be called once before.
+     *  Heights are not normalized, min and max heights are reduced
+     *  while writing them, @see GetMinHeight(), GetMaxHeight()
      * @param time Elapsed time in seconds
-     * @return Amplitude of normalized heights (in <-1, 1> )
+     * @return Amplitude of the heights, max(|min height|, |max height|)
      */
     float ComputeWaves(float time);
 
+    /** @brief Destinations of the results, e.g., mapped staging memory */
+    struct Outputs
+    {
+        void* displacements;    ///< Of "GetDisplacementCount()" texels
+        void* normals;          ///< Of "GetNormalCount()" texels, or null
+                                ///<  if the normals are not computed
+        bool isHalf{ false };   ///< Texels of 4 half floats, else of 4 floats
+    };
+
+    /**
+     * @brief Same as "ComputeWaves(time)", but writes the results directly
+     *  to the outputs, each texel once and in order, so they may be in
+     *  write-combined memory
+     */
+    float ComputeWaves(float time, const Outputs& outputs);
+
+    /** @brief Of a point of the water surface, @see QueryWaves() */
+    struct WaterSample
+    {
+        float     height;
+        glm::vec3 normal;       ///< Of the slopes, unit vector
+        glm::vec3 velocity;     ///< Of the surface there, in m/s
+    };
+
+    /**
+     * @brief Samples the last snapshot of the waves at the points, e.g., for
+     *  buoyancy. Safe to call from any thread, also while "ComputeWaves()"
+     *  runs, neither of them waits for the other, @see SetQueriesEnabled()
+     *
+     * The undisplaced grid point, displaced to a point, is found by fixed
+     *  point iterations, which converge unless the surface folds there
+     * @param points World XZ in meters, of the repeated tile. Its texel
+     *  (m, n) is at (n, m) * tile length / tile size, before displaced
+     * @param samples Results of 'count' points. Velocities are of the last
+     *  two snapshots, zero if the first one, or of other properties
+     * @return False if there is no snapshot yet
+     */
+    bool QueryWaves(const glm::vec2* points,
+                    size_t count,
+                    WaterSample* samples) const;
+
     // ---------------------------------------------------------------------
     // Getters
 
@@ -92,14 +163,29 @@ public:
 
     // Data
 
-    size_t GetDisplacementCount() const { return m_Displacements.size(); }
+    size_t GetDisplacementCount() const { return m_Spectrum.Size(); }
+    /** @return Results of "ComputeWaves(time)" */
     const std::vector<Displacement>& GetDisplacements() const {
         return m_Displacements;
     }
 
-    size_t GetNormalCount() const { return m_Normals.size(); }
+    size_t GetNormalCount() const { return m_Spectrum.Size(); }
     const std::vector<Normal>& GetNormals() const { return m_Normals; }
 
+    /**
+     * @brief Precomputed spectrum sample of a wave, packed for the GPU
+     *  - heights: vec4(h0(k), conj(h0(-k)))
+     *  - waveVec: vec4(k, dispersion, 0)
+     */
+    struct SpectrumSample
+    {
+        glm::vec4 heights;
+        glm::vec4 waveVec;
+    };
+
+    /** @return Spectrum of the last "Prepare[Spectrum]()" call, row-major */
+    std::vector<SpectrumSample> GetSpectrum() const;
+
     // ---------------------------------------------------------------------
     // Setters
 
@@ -121,6 +207,136 @@ public:
     /** @param Damping Suppresses wave lengths smaller that its value */
     void SetDamping(float damping);
 
+    /**
+     * @brief Leaves out the waves of lower wave numbers, e.g., covered by
+     *  the model of a longer tile. Takes effect on the next "Prepare()" call
+     * @param k In rad/m, 0 keeps all of them
+     */
+    void SetMinWaveNumber(float k);
+    float GetMinWaveNumber() const { return m_MinWaveNumber; }
+
+    /**
+     * @brief Seed of the random amplitudes of the spectrum, the same seed
+     *  gives the same surface. Takes effect on the next "Prepare()" call
+     */
+    void SetSeed(uint64_t seed);
+    uint64_t GetSeed() const { return m_Seed; }
+
+    /**
+     * @brief Bytes of the structures kept of the tile sizes switched away
+     *  from: the wave vectors, random numbers, spectrum, FFTW memory and
+     *  plans. Switching back to one of them, by "SetTileSize()", then
+     *  "Prepare()" only rebuilds what the properties changed meanwhile.
+     *  The least recently used sizes over it are freed
+     */
+    void SetTileCacheBudget(size_t budget);
+    size_t GetTileCacheBudget() const { return m_TileCacheBudget; }
+    /**
+     * @brief Switches to the tile size of 'prepared', taking its structures
+     *  instead of building them, as if restored from the tile cache. Then
+     *  "Prepare()" only rebuilds those of the properties changed since it
+     *  was created, @see WSTessendorf(other, tileSize)
+     * @param prepared Of the properties of this model, left without
+     *  structures
+     */
+    void AdoptTileSize(WSTessendorf& prepared);
+    /** @return Bytes of the cached tile sizes */
+    size_t GetTileCacheSize() const;
+
+    /**
+     * @brief Whether pairs of real-valued fields share one complex FFT, as
+     *  A + iB, halving the number of transforms. Enabled by default.
+     *  Takes effect on the next "Prepare()" call
+     */
+    void SetPackedFFT(bool packed);
+    bool IsPackedFFT() const { return m_PackedFFT; }
+
+    /**
+     * @brief Whether the slopes and the derivatives of the displacements are
+     *  transformed, the normals are output. Otherwise only the height and the
+     *  displacements are, and the normals are left to be reconstructed from
+     *  them, e.g., by finite differences. Enabled by default.
+     *  Takes effect on the next "Prepare()" call
+     */
+    void SetComputeNormals(bool compute);
+    bool IsComputingNormals() const { return m_ComputeNormals; }
+
+    /**
+     * @brief Whether the cross derivatives of the displacements are also
+     *  transformed, for the Jacobian of the displacements in the fourth
+     *  component of the displacement texels, e.g., for foam, otherwise it
+     *  is 1. Only with the normals. Disabled by default.
+     *  Takes effect on the next "Prepare()" call
+     */
+    void SetComputeJacobian(bool compute);
+    bool IsComputingJacobian() const { return m_ComputeJacobian; }
+
+    /**
+     * @brief Whether each input of the transforms is allocated on its own,
+     *  e.g., for memory checkers to catch the overruns of each of them,
+     *  instead of all in one block. Disabled by default.
+     *  Takes effect on the next "Prepare()" call
+     */
+    void SetSeparateFFTInputs(bool separate);
+    bool HasSeparateFFTInputs() const { return m_SeparateFFTInputs; }
+
+    /**
+     * @brief Selects the kernel of the spectrum evaluation, by default
+     *  the widest instruction set supported is used
+     * @param level Clamped to the supported one
+     */
+    void SetSimdLevel(wst::SimdLevel level);
+    wst::SimdLevel GetSimdLevel() const { return m_SimdLevel; }
+
+    /**
+     * @brief Enables incremental time stepping: if "ComputeWaves()" is called
+     *  with 't' advanced by 'dt' since the previous call, the phasors
+     *  exp(i*w*t) are rotated by exp(i*w*dt) instead of evaluating sin and cos.
+     *  Otherwise, e.g., after a pause or a seek, they are fully evaluated,
+     *  and every s_kPhasorReseedPeriod steps, bounding their drift.
+     * @param dt Fixed animation step in seconds, 0 disables it
+     */
+    void SetTimeStep(float dt);
+    float GetTimeStep() const { return m_TimeStep; }
+
+    /**
+     * @brief Whether each "ComputeWaves()" call also keeps a snapshot of the
+     *  waves in single precision, sampled by "QueryWaves()". Disabled by
+     *  default, disabling it releases the snapshots. Set while the waves
+     *  are not being computed
+     */
+    void SetQueriesEnabled(bool enable);
+    bool AreQueriesEnabled() const { return m_QueriesEnabled; }
+
+    /**
+     * @brief Publishes displacements of the waves computed elsewhere, e.g.,
+     *  read back from the GPU backend, for "QueryWaves()". The slopes are
+     *  differenced of the heights. Ignored unless the queries are enabled
+     * @param time Of the waves, in seconds
+     * @param size Texels per side of the whole tile, a power of two, may be
+     *  fewer than the tile size
+     * @param displacements Of size^2 texels, row-major
+     */
+    void SetQueryDisplacements(float time,
+                               uint32_t size,
+                               const Displacement* displacements);
+
+    /** @brief Parallelization of the inverse FFTs */
+    enum class FFTSchedule
+    {
+        Auto = 0,   ///< Chosen by the tile size and available cores
+        Transforms, ///< Transforms run concurrently, on one thread each
+        Threaded,   ///< Transforms run one after another, on all threads
+        Mixed,      ///< Transforms run concurrently, on several threads each
+    };
+
+    /** @brief Takes effect on the next "Prepare()" call */
+    void SetFFTSchedule(FFTSchedule schedule);
+    /** @return The schedule in use, never Auto after "Prepare()" */
+    FFTSchedule GetFFTSchedule() const { return m_FFTSchedule; }
+
+    static const char* ToString(FFTSchedule schedule);
+
 private:
 
     using Complex = std::complex<float>;
@@ -146,58 +362,279 @@ private:
         float dispersion;           ///< Descrete dispersion value
     };
 
+    /** @brief Of "Prepare()", a - c), reusing the structures not changed */
+    void UpdateSpectrum();
+
     std::vector<WaveVector> ComputeWaveVectors() const;
     std::vector<Complex> ComputeGaussRandomArray() const;
     std::vector<BaseWaveHeight> ComputeBaseWaveHeightField(
         const std::vector<Complex>& gaussRandomArray
     ) const;
 
+    void SetupFFTW();
+    void DestroyFFTW();
+
     /**
-     * @brief Normalizes heights to interval <-1, 1>
-     * @return Ampltiude, to reconstruct the orignal signal
+     * @brief Zeroes the input by the pinned threads of the simulation, of
+     *  the static rows of its passes, its pages allocated on their NUMA nodes
      */
-    float NormalizeHeights(float minHeight, float maxHeight);
+    void FirstTouchInput(Complex* input) const;
 
-    void SetupFFTW();
-    void DestroyFFTW();
+    /**
+     * @brief Resolves the requested schedule for the tile size and count of
+     *  transforms
+     * @param threadsPerPlan Number of threads to plan each transform with
+     */
+    FFTSchedule ChooseFFTSchedule(const uint32_t kTransformCount,
+                                  uint32_t& threadsPerPlan) const;
+    /**
+     * @brief Executes all the plans according to the schedule
+     * @param isChoppy Else the transforms of the displacements are skipped,
+     *  they are scaled by a lambda of 0
+     */
+    void ExecuteTransforms(bool isChoppy);
+
+    /** @return Name of the wisdom file of the current tile size */
+    std::string GetWisdomFileName() const;
+    /**
+     * @brief Replaces FFTW wisdom by the one of the cache directory, or
+     *  of the shipped one
+     * @return True if imported from the cache directory
+     */
+    bool ImportWisdom() const;
+    /** @brief Exports the accumulated wisdom to the cache directory */
+    void ExportWisdom() const;
+
+    /** @brief Output feature a pair of fields is transformed for */
+    enum class PairFeature
+    {
+        Displacements,  ///< Always set up, skipped while not choppy
+        Normals,        ///< Not set up without normals
+        Jacobian,       ///< Not set up without normals or the Jacobian
+    };
+
+    /** 
+     * @brief Inputs, and plan, of the transforms of a pair of real-valued
+     *  fields, if packed then the second one aliases the first one,
+     *  and its plan is null
+     */
+    struct FieldPairFT
+    {
+        Complex*&   a;
+        Complex*&   b;
+        fftwf_plan& planA;
+        fftwf_plan& planB;
+        PairFeature feature;
+    };
+
+    static constexpr uint32_t s_kFieldPairCount{ 4 };
+    std::array<FieldPairFT, s_kFieldPairCount> GetFieldPairs();
+    /** @return Whether "SetupFFTW()" sets up the pairs of the feature */
+    bool IsSetUp(PairFeature feature) const;
+    /** @return Number of transforms, of the height and the pairs set up */
+    uint32_t GetTransformCount() const;
+
+    /** @return Number of rows of a spectrum block that fits into L2 cache */
+    uint32_t GetSpectrumBlockRows() const;
+
+    /** @brief Computes exp(i*w*dt) of each wave for the set time step */
+    void ComputePhasorSteps();
+
+    /**
+     * @brief Decides how the phasors are obtained at time 't', records 't'
+     *  as the time of the phasors
+     */
+    wst::PhasorUpdate UpdatePhasorTime(float t);
+
+    /**
+     * @brief Fields of the waves at a time, row-major, in world units,
+     *  immutable once published, @see QueryWaves()
+     */
+    struct QuerySnapshot
+    {
+        uint32_t tileSize{ 0 };     ///< Texels per side, of the fields
+        float tileLength{ 0.0f };
+        float time{ 0.0f };
+        uint64_t spectrumVersion{ 0 };
+
+        std::vector<float> displacementX;
+        std::vector<float> height;
+        std::vector<float> displacementZ;
+        std::vector<float> slopeX;
+        std::vector<float> slopeZ;
+        // Of the displaced grid points, of the previous snapshot
+        std::vector<float> velocityX;
+        std::vector<float> velocityY;
+        std::vector<float> velocityZ;
+    };
+
+    /**
+     * @brief Fills a snapshot of the transformed fields at time 't', then
+     *  publishes it for "QueryWaves()"
+     */
+    void UpdateQuerySnapshot(float t);
+    /** @return Snapshot at time 't' to fill, of 'size' texels per side */
+    std::shared_ptr<QuerySnapshot> AcquireQuerySnapshot(float t,
+                                                        uint32_t size);
+    /**
+     * @brief Differences the velocities of the filled displacements, and the
+     *  slopes of the heights unless 'hasSlopes', then publishes the snapshot
+     */
+    void PublishQuerySnapshot(std::shared_ptr<QuerySnapshot> snapshot,
+                              bool hasSlopes);
+
+    /**
+     * @brief Structures of a tile size switched away from, and whether they
+     *  were up to date with the properties they were built of
+     */
+    struct CachedTile
+    {
+        uint32_t tileSize{ 0 };
+        uint64_t lastUsed{ 0 };     ///< Selection count, for LRU eviction
+
+        std::vector<WaveVector> waveVectors;
+        std::vector<Complex> gaussRandoms;
+        wst::SpectrumSoA spectrum;
+        wst::PhasorSoA phasors;
+
+        // Null if FFTW is not set up, of the pairs the second ones alias
+        //  the first ones if packed
+        Complex* height{ nullptr };
+        fftwf_plan planHeight{ nullptr };
+        std::array<Complex*, 2 * s_kFieldPairCount> pairInputs{};
+        std::array<fftwf_plan, 2 * s_kFieldPairCount> pairPlans{};
+        FFTSchedule fftSchedule{ FFTSchedule::Transforms };
+        uint32_t fftThreadsPerPlan{ 1 };
+        uint32_t fftThreadCount{ 0 };
+        bool fftFirstTouch{ false };
+        bool fftInputsSeparate{ false };
+
+        // Properties they were built of
+        float tileLength{ 0.0f };
+        uint64_t seed{ 0 };
+        uint64_t spectrumVersion{ 0 };
+        float timeStep{ 0.0f };
+        bool packedFFT{ true };
+        bool computeNormals{ true };
+        bool computeJacobian{ false };
+        bool separateFFTInputs{ false };
+        FFTSchedule fftScheduleRequest{ FFTSchedule::Auto };
+
+        bool waveVectorsDirty{ true };
+        bool gaussRandomsDirty{ true };
+        bool fftwDirty{ true };
+    };
+
+    /** @brief Exchanges the structures of the current size with the tile's */
+    void SwapTile(CachedTile& tile);
+    /** @brief Caches the structures of the current size, if any */
+    void StashTile();
+    /**
+     * @brief Takes back the structures of the current size, if cached,
+     *  outdating those of the properties changed meanwhile
+     * @return False if not cached
+     */
+    bool RestoreTile();
+    /** @brief Frees the least recently used cached tiles over the budget */
+    void EvictTiles();
+    void FreeTile(CachedTile& tile);
+    /** @return Bytes of the structures of the tile */
+    static size_t GetTileBytes(const CachedTile& kTile);
 
 private:
     // ---------------------------------------------------------------------
     // Properties
 
-    uint32_t m_TileSize;
-    float    m_TileLength;
+    uint32_t m_TileSize{ 0 };
+    float    m_TileLength{ 0.0f };
 
-    glm::vec2 m_WindDir;        ///< Unit vector
-    float m_WindSpeed;
+    glm::vec2 m_WindDir{ 0.0f };   ///< Unit vector
+    float m_WindSpeed{ 0.0f };
 
     // Phillips spectrum
-    float m_A;
-    float m_Damping;
+    float m_A{ 0.0f };
+    float m_Damping{ 0.0f };
+    float m_MinWaveNumber{ 0.0f };
+    uint64_t m_Seed{ s_kDefaultSeed };
 
-    float m_AnimationPeriod;
+    float m_AnimationPeriod{ 0.0f };
     float m_BaseFreq{ 1.0f };
 
     float m_Lambda{ -1.0f };  ///< Importance of displacement vector
 
+    bool m_PackedFFT{ true };
+    bool m_ComputeNormals{ true };
+    bool m_ComputeJacobian{ false };
+    bool m_SeparateFFTInputs{ false };
+
+    FFTSchedule m_FFTScheduleRequest{ FFTSchedule::Auto };
+    FFTSchedule m_FFTSchedule{ FFTSchedule::Transforms };
+    uint32_t    m_FFTThreadsPerPlan{ 1 };
+    // Of the thread placement the plans were set up with
+    uint32_t    m_FFTThreadCount{ 0 };
+    bool        m_FFTFirstTouch{ false };
+
     // -------------------------------------------------------------------------
     // Data
 
-    // vec4(Displacement_X, height, Displacement_Z, [jacobian])
+    // Allocated only if computed without outputs
+    // vec4(Displacement_X, height, Displacement_Z, jacobian or 1)
     std::vector<Displacement> m_Displacements;
     // vec4(slopeX, slopeZ, dDxdx, dDzdz )
     std::vector<Normal> m_Normals;
 
+    // Rows of the half precision outputs, a pair per thread, before converted
+    std::vector<glm::vec4> m_RowScratch;
+
     // =========================================================================
     // Computation
 
+    // Used only while preparing the spectrum, kept for the changes of the
+    //  properties they do not depend on, @see Prepare()
     std::vector<WaveVector> m_WaveVectors;   ///< Precomputed Wave vectors
+    std::vector<Complex> m_GaussRandoms;     ///< Of both parts N(0, 1)
+
+    bool m_WaveVectorsDirty{ true };
+    bool m_GaussRandomsDirty{ true };
+    bool m_FFTWDirty{ true };   ///< Plans and memory, if set up
+
+    // Incremented by each change of the properties of the spectrum, it is
+    //  rebuilt if its version differs
+    uint64_t m_SpectrumVersion{ 1 };
+    uint64_t m_BuiltSpectrumVersion{ 0 };
+
+    // Of the planners and the wisdom of FFTW, shared by all the models, only
+    //  the execution of the plans is thread safe
+    static inline std::mutex s_PlannerMutex;
+    static inline uint32_t s_ModelCount{ 0 };   ///< Of FFTW's threads
+
+    // Structures of the other tile sizes, @see SetTileCacheBudget()
+    std::vector<CachedTile> m_TileCache;
+    size_t   m_TileCacheBudget{ s_kDefaultTileCacheBudget };
+    uint64_t m_TileSelections{ 0 };
 
     // Base wave height field generated from the spectrum for each wave vector
     std::vector<BaseWaveHeight> m_BaseWaveHeights;
 
+    // Precomputed spectrum, of both above, in SoA layout for SIMD kernels
+    wst::SpectrumSoA m_Spectrum;
+
+    wst::SimdLevel      m_SimdLevel{ wst::SimdLevel::Scalar };
+    wst::SpectrumKernel m_SpectrumKernel{ wst::ComputeSpectrumScalar };
+    wst::HalfConvertKernel m_ConvertToHalf{ wst::ConvertToHalfScalar };
+
+    // Incremental time stepping, @see SetTimeStep()
+    wst::PhasorSoA m_Phasors;
+    float    m_TimeStep{ 0.0f };
+    float    m_PhasorTime{ 0.0f };      ///< Time of the stored phasors
+    bool     m_PhasorsValid{ false };
+    uint32_t m_PhasorSteps{ 0 };        ///< Steps since the last evaluation
+
     // ---------------------------------------------------------------------
     // FT computation using FFTW
+    //  Height is transformed alone, other fields in pairs:
+    //  (SlopeX, SlopeZ), (DisplacementX, DisplacementZ),
+    //  (dxDisplacementX, dzDisplacementZ), [(dxDisplacementZ, dzDisplacementX)]
 
     Complex* m_Height{ nullptr };
     Complex* m_SlopeX{ nullptr };
@@ -206,10 +643,8 @@ private:
     Complex* m_DisplacementZ{ nullptr };
     Complex* m_dxDisplacementX{ nullptr };
     Complex* m_dzDisplacementZ{ nullptr };
-#ifdef COMPUTE_JACOBIAN
     Complex* m_dxDisplacementZ{ nullptr };
     Complex* m_dzDisplacementX{ nullptr };
-#endif
 
     fftwf_plan m_PlanHeight{ nullptr };
     fftwf_plan m_PlanSlopeX{ nullptr };
@@ -218,18 +653,54 @@ private:
     fftwf_plan m_PlanDisplacementZ{ nullptr };
     fftwf_plan m_PlandxDisplacementX{ nullptr };
     fftwf_plan m_PlandzDisplacementZ{ nullptr };
-#ifdef COMPUTE_JACOBIAN
     fftwf_plan m_PlandxDisplacementZ{ nullptr };
     fftwf_plan m_PlandzDisplacementX{ nullptr };
-#endif
+    // Of the memory set up, @see SetSeparateFFTInputs()
+    bool m_FFTInputsSeparate{ false };
 
     float m_MinHeight{ -1.0f };
     float m_MaxHeight{ 1.0f };
 
+    // ---------------------------------------------------------------------
+    // Snapshots of the queries, @see QueryWaves()
+    //  The published one is loaded and stored atomically, the last one and
+    //  a spare one are only of the computation. The spare one is reused
+    //  unless a query still samples it
+
+    bool m_QueriesEnabled{ false };
+    std::shared_ptr<const QuerySnapshot> m_QuerySnapshot;
+    std::shared_ptr<QuerySnapshot> m_QueryLast;
+    std::shared_ptr<QuerySnapshot> m_QuerySpare;
+
 private:
     static constexpr float s_kG{ 9.81 };   ///< Gravitational constant
     static constexpr float s_kOneOver2sqrt{ 1.0f / std::sqrt(2.0f) };
 
+    /// Bytes of a block of rows processed at once by the spectrum pass
+    static constexpr size_t s_kSpectrumBlockBytes{ 256 * 1024 };
+
+    /// Smallest tile size of transforms worth threading
+    static constexpr uint32_t s_kMinThreadedFFTSize{ 256 };
+    /// Smallest tile size of transforms better run one after another
+    static constexpr uint32_t s_kMinSequentialFFTSize{ 1024 };
+
+    /// Directory of FFTW wisdom exported by previous runs
+    static constexpr std::string_view s_kWisdomCacheDir{ "cache/fftw" };
+    /// Directory of pre-generated FFTW wisdom, shipped with the application
+    static constexpr std::string_view s_kWisdomShippedDir{ "wisdom" };
+
+    /// Number of incremental steps after which the phasors are evaluated
+    static constexpr uint32_t s_kPhasorReseedPeriod{ 64 };
+    /// Relative tolerance of the time step to advance the phasors
+    static constexpr float s_kTimeStepTolerance{ 0.01f };
+
+    /// Points of "QueryWaves()" sampled at once, of its stack arrays
+    static constexpr uint32_t s_kQueryBatch{ 64 };
+    /// Fixed point iterations of the undisplaced grid points
+    static constexpr uint32_t s_kQueryIterations{ 4 };
+    /// Longest time between snapshots the velocities are differenced over
+    static constexpr float s_kMaxQueryTimeDelta{ 0.5f };
+
     /**
      * @brief Realization of water wave height field in fourier domain
      * @return Fourier amplitudes of a wave height field
@@ -262,18 +733,6 @@ private:
                    * glm::exp(-k2 * m_Damping * m_Damping);
     }
 
-    static Complex WaveHeightFT(const BaseWaveHeight& waveHeight, const float t)
-    {
-        const float omega_t = waveHeight.dispersion * t;
-
-        // exp(ix) = cos(x) * i*sin(x)
-        const float pcos = glm::cos(omega_t);
-        const float psin = glm::sin(omega_t);
-
-        return waveHeight.heightAmp * Complex(pcos, psin) +
-               waveHeight.heightAmp_conj * Complex(pcos, -psin);
-    }
-
     // --------------------------------------------------------------------
 
     /** 
@@ -0,0 +1,629 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSTessendorfCompute.h"
+
+#include <cstring>
+
+#include <core/Profile.h>
+
+
+/** @return Number of work groups to cover 'size' invocations */
+static uint32_t GroupCount(uint32_t size, uint32_t groupSize)
+{
+    return (size + groupSize - 1) / groupSize;
+}
+
+// =============================================================================
+
+WSTessendorfCompute::WSTessendorfCompute(
+    const vkp::Device& device,
+    const vkp::DescriptorPool& descriptorPool,
+    VkFormat mapFormat
+)
+    : m_kDevice(device),
+      m_kDescriptorPool(descriptorPool),
+      m_MapFormat(mapFormat)
+{
+    VKP_REGISTER_FUNCTION();
+
+    CreateDescriptorSetLayout();
+    CreateDescriptorSet();
+    CreatePipelines();
+    CreateHeightBoundsBuffer();
+}
+
+WSTessendorfCompute::~WSTessendorfCompute()
+{
+    VKP_REGISTER_FUNCTION();
+}
+
+void WSTessendorfCompute::SetFrameCount(uint32_t count)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_ASSERT(count > 0);
+
+    if (count == m_FrameCount)
+        return;
+
+    // Slices may still be written
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    m_FrameCount = count;
+    CreateHeightBoundsBuffer();
+    m_DescriptorSetIsDirty = true;
+}
+
+void WSTessendorfCompute::Prepare(
+    VkCommandBuffer cmdBuffer,
+    const WSTessendorf& model
+)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_PROFILE_SCOPE();
+
+    const uint32_t kTileSize = model.GetTileSize();
+    const std::vector<WSTessendorf::SpectrumSample> kSpectrum =
+        model.GetSpectrum();
+    VKP_ASSERT(kSpectrum.size() == kTileSize * kTileSize);
+
+    // The buffers may be read by the frames in flight, the staging buffer
+    //  only by the previous copy, all of them submitted by now
+    const vkp::Timeline& kTimeline =
+        m_kDevice.GetTimeline(vkp::QFamily::Graphics);
+    if (kTileSize != m_TileSize || m_SpectrumCopyValue == s_kCopyUnsubmitted)
+        kTimeline.Wait(kTimeline.GetLastValue());
+    else
+        kTimeline.Wait(m_SpectrumCopyValue);
+
+    if (kTileSize != m_TileSize)
+    {
+        CreateBuffers(kTileSize);
+        m_TileSize = kTileSize;
+        m_DescriptorSetIsDirty = true;
+    }
+
+    const VkDeviceSize kSpectrumSize =
+        sizeof(WSTessendorf::SpectrumSample) * kSpectrum.size();
+
+    auto err = m_SpectrumStagingBuffer->Fill(kSpectrum.data(), kSpectrumSize);
+    VKP_ASSERT_RESULT(err);
+
+    // Of each wave, |h(k, t)| <= |h0(k)| + |conj(h0(-k))|, summed by the FFT
+    double amplitude = 0.0;
+    for (const WSTessendorf::SpectrumSample& kSample : kSpectrum)
+    {
+        amplitude += glm::length(glm::vec2(kSample.heights.x,
+                                           kSample.heights.y)) +
+                     glm::length(glm::vec2(kSample.heights.z,
+                                           kSample.heights.w));
+    }
+    SetSpectrumHeightBounds(static_cast<float>(amplitude));
+
+    // Previous reads of the spectrum must finish before the copy
+    {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(cmdBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr);
+    }
+
+    const VkBufferCopy kRegion{
+        .srcOffset = 0,
+        .dstOffset = 0,
+        .size = kSpectrumSize
+    };
+    m_SpectrumBuffer->StageCopy(*m_SpectrumStagingBuffer, &kRegion, cmdBuffer);
+
+    // Of the submission of the caller, @see RecordComputeWaves()
+    m_SpectrumCopyValue = s_kCopyUnsubmitted;
+    m_SpectrumCopyRecords = 0;
+
+    // Copy must finish before the spectrum is evaluated
+    {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmdBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr);
+    }
+}
+
+void WSTessendorfCompute::RecordComputeWaves(
+    VkCommandBuffer cmdBuffer,
+    uint32_t frameIndex,
+    float t,
+    float lambda,
+    vkp::Texture2D& displacementMap,
+    vkp::Texture2D& normalMap
+)
+{
+    VKP_ASSERT_MSG(m_TileSize > 0, "Compute backend is not prepared");
+    VKP_ASSERT(displacementMap.GetWidth() == m_TileSize &&
+               normalMap.GetWidth() == m_TileSize);
+
+    // Of the frame of the copy, or before it, submitted by the next frame
+    if (m_SpectrumCopyValue == s_kCopyUnsubmitted &&
+        m_SpectrumCopyRecords++ > 0)
+    {
+        m_SpectrumCopyValue =
+            m_kDevice.GetTimeline(vkp::QFamily::Graphics).GetLastValue();
+    }
+
+    UpdateDescriptorSet(displacementMap, normalMap);
+    UpdateHeightBounds(cmdBuffer, frameIndex);
+
+    m_PushConstants.tileSize = m_TileSize;
+    m_PushConstants.time = t;
+    m_PushConstants.lambda = lambda;
+    m_PushConstants.boundsSlice = frameIndex;
+
+    const uint32_t kGroupCount2D = GroupCount(m_TileSize, s_kGroupSize2D);
+
+    // Ping buffer may still be read by the previous frame
+    RecordComputeBarrier(cmdBuffer);
+
+    // 1. Spectrum at time t -> ping
+    BindAndPush(cmdBuffer, *m_SpectrumPipeline);
+    vkCmdDispatch(cmdBuffer, kGroupCount2D, kGroupCount2D, 1);
+
+    // 2. Inverse FFT: log2(N) stages along rows, then along columns
+    //  even number of stages in total - result ends up back in ping
+    const uint32_t kGroupCountFFT = GroupCount(m_TileSize / 2, s_kGroupSizeFFT);
+    m_PushConstants.pingPong = 0;
+
+    for (uint32_t direction = 0; direction < 2; ++direction)
+    {
+        m_PushConstants.direction = direction;
+
+        for (uint32_t Ns = 1; Ns < m_TileSize; Ns <<= 1)
+        {
+            m_PushConstants.stageSize = Ns;
+
+            RecordComputeBarrier(cmdBuffer);
+            BindAndPush(cmdBuffer, *m_FFTPipeline);
+            vkCmdDispatch(cmdBuffer, kGroupCountFFT, m_TileSize, s_kFieldCount);
+
+            m_PushConstants.pingPong ^= 1;
+        }
+    }
+    VKP_ASSERT(m_PushConstants.pingPong == 0);
+
+    // 3. Ping -> maps
+    TransitionMapToStorage(cmdBuffer, displacementMap);
+    TransitionMapToStorage(cmdBuffer, normalMap);
+    RecordComputeBarrier(cmdBuffer);
+
+    BindAndPush(cmdBuffer, *m_MapsPipeline);
+    vkCmdDispatch(cmdBuffer, kGroupCount2D, kGroupCount2D, 1);
+
+    TransitionMapToShaderRead(cmdBuffer, displacementMap);
+    TransitionMapToShaderRead(cmdBuffer, normalMap);
+
+    // Visible to the host once the frame's fence is signaled
+    const VkBufferMemoryBarrier kBarrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = *m_HeightBoundsBuffer,
+        .offset = s_kHeightBoundsSliceSize * frameIndex,
+        .size = s_kHeightBoundsSliceSize
+    };
+    vkCmdPipelineBarrier(cmdBuffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         0, nullptr,
+                         1, &kBarrier,
+                         0, nullptr);
+    m_PendingBounds[frameIndex] = true;
+}
+
+void WSTessendorfCompute::UpdateHeightBounds(
+    VkCommandBuffer cmdBuffer,
+    uint32_t frameIndex
+)
+{
+    VKP_ASSERT(frameIndex < m_FrameCount);
+
+    uint32_t* slice =
+        static_cast<uint32_t*>(m_HeightBoundsBuffer->GetMappedAddress()) +
+        2 * frameIndex;
+
+    // Reduced by the frame's previous submission, done by now
+    if (m_PendingBounds[frameIndex])
+    {
+        // Of the ordered bits, @see WSTessendorfMaps.comp
+        auto ToFloat = [](uint32_t bits) {
+            bits = (bits & 0x80000000u) != 0 ? bits & 0x7FFFFFFFu : ~bits;
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        };
+        const float kMinHeight = ToFloat(slice[0]);
+        const float kMaxHeight = ToFloat(slice[1]);
+        const float kSlack = s_kHeightBoundsSlack * (kMaxHeight - kMinHeight);
+
+        m_MinHeight = glm::max(kMinHeight - kSlack, -m_SpectrumAmplitude);
+        m_MaxHeight = glm::min(kMaxHeight + kSlack, m_SpectrumAmplitude);
+        m_PendingBounds[frameIndex] = false;
+    }
+
+    // Previous reads of the host are done, the slice is reduced into anew
+    vkCmdFillBuffer(cmdBuffer, *m_HeightBoundsBuffer,
+                    s_kHeightBoundsSliceSize * frameIndex,
+                    sizeof(uint32_t), 0xFFFFFFFFu);
+    vkCmdFillBuffer(cmdBuffer, *m_HeightBoundsBuffer,
+                    s_kHeightBoundsSliceSize * frameIndex + sizeof(uint32_t),
+                    sizeof(uint32_t), 0u);
+
+    // Fills must finish before the maps pass reduces into the slice
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT |
+                            VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr);
+}
+
+void WSTessendorfCompute::SetSpectrumHeightBounds(float amplitude)
+{
+    m_SpectrumAmplitude = amplitude;
+    m_MinHeight = -amplitude;
+    m_MaxHeight = amplitude;
+
+    // Heights reduced before are of the previous spectrum
+    m_PendingBounds.assign(m_FrameCount, false);
+}
+
+void WSTessendorfCompute::BindAndPush(
+    VkCommandBuffer cmdBuffer,
+    const vkp::Pipeline& pipeline
+) const
+{
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+    const uint32_t kFirstSet = 0, kDescriptorSetCount = 1;
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        pipeline.GetPipelineLayout(),
+        kFirstSet,
+        kDescriptorSetCount,
+        &m_DescriptorSet,
+        0, nullptr
+    );
+
+    vkCmdPushConstants(
+        cmdBuffer,
+        pipeline.GetPipelineLayout(),
+        s_kPushConstantRange.stageFlags,
+        s_kPushConstantRange.offset,
+        s_kPushConstantRange.size,
+        &m_PushConstants
+    );
+}
+
+void WSTessendorfCompute::RecordComputeBarrier(VkCommandBuffer cmdBuffer)
+{
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT |
+                            VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT |
+                            VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr);
+}
+
+void WSTessendorfCompute::TransitionMapToStorage(
+    VkCommandBuffer cmdBuffer,
+    vkp::Texture2D& map
+)
+{
+    vkp::Image& image = map.GetImage();
+
+    // Previous reads in the vertex shader, or a transfer from the CPU backend
+    image.RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_GENERAL);
+    image.SetLayout(VK_IMAGE_LAYOUT_GENERAL);
+}
+
+void WSTessendorfCompute::TransitionMapToShaderRead(
+    VkCommandBuffer cmdBuffer,
+    vkp::Texture2D& map
+)
+{
+    vkp::Image& image = map.GetImage();
+    VKP_ASSERT(image.GetLayout() == VK_IMAGE_LAYOUT_GENERAL);
+
+    image.RecordImageBarrier(cmdBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    image.SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void WSTessendorfCompute::UpdateDescriptorSet(
+    const vkp::Texture2D& displacementMap,
+    const vkp::Texture2D& normalMap
+)
+{
+    const bool kMapsChanged =
+        displacementMap.GetImageView() != m_BoundDisplacementView ||
+        normalMap.GetImageView() != m_BoundNormalView;
+
+    if (!m_DescriptorSetIsDirty && !kMapsChanged)
+        return;
+
+    VKP_REGISTER_FUNCTION();
+
+    VkDescriptorBufferInfo bufferInfos[4] = {
+        m_SpectrumBuffer->GetDescriptor(),
+        m_PingBuffer->GetDescriptor(),
+        m_PongBuffer->GetDescriptor(),
+        m_HeightBoundsBuffer->GetDescriptor()
+    };
+
+    VkDescriptorImageInfo imageInfos[2] = {
+        displacementMap.GetDescriptor(),
+        normalMap.GetDescriptor()
+    };
+    imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    vkp::DescriptorWriter descriptorWriter(*m_DescriptorSetLayout,
+                                           m_kDescriptorPool);
+    uint32_t binding = 0;
+
+    descriptorWriter
+        .AddBufferDescriptor(binding++, &bufferInfos[0])
+        .AddBufferDescriptor(binding++, &bufferInfos[1])
+        .AddBufferDescriptor(binding++, &bufferInfos[2])
+        .AddImageDescriptor(binding++, &imageInfos[0])
+        .AddImageDescriptor(binding++, &imageInfos[1])
+        .AddBufferDescriptor(binding++, &bufferInfos[3]);
+
+    // Descriptor set may still be in use by the previous frame
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+    descriptorWriter.UpdateSet(m_DescriptorSet);
+
+    m_BoundDisplacementView = displacementMap.GetImageView();
+    m_BoundNormalView = normalMap.GetImageView();
+    m_DescriptorSetIsDirty = false;
+}
+
+// -----------------------------------------------------------------------------
+// Creation functions
+
+void WSTessendorfCompute::CreateDescriptorSetLayout()
+{
+    VKP_REGISTER_FUNCTION();
+
+    uint32_t bindingPoint = 0;
+
+    m_DescriptorSetLayout = vkp::DescriptorSetLayout::Builder(m_kDevice)
+        // Spectrum
+        .AddBinding({
+            .binding = bindingPoint++,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        })
+        // Ping
+        .AddBinding({
+            .binding = bindingPoint++,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        })
+        // Pong
+        .AddBinding({
+            .binding = bindingPoint++,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        })
+        // Displacement map
+        .AddBinding({
+            .binding = bindingPoint++,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        })
+        // Normal map
+        .AddBinding({
+            .binding = bindingPoint++,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        })
+        // Height bounds
+        .AddBinding({
+            .binding = bindingPoint++,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        })
+        .Build();
+}
+
+void WSTessendorfCompute::CreateDescriptorSet()
+{
+    VKP_REGISTER_FUNCTION();
+
+    auto err = m_kDescriptorPool.AllocateDescriptorSet(*m_DescriptorSetLayout,
+                                                       m_DescriptorSet);
+    VKP_ASSERT_RESULT(err);
+}
+
+void WSTessendorfCompute::CreatePipelines()
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_ASSERT(m_DescriptorSetLayout != nullptr);
+
+    // Compiled and created concurrently
+    #pragma omp parallel sections
+    {
+        #pragma omp section
+        m_SpectrumPipeline = CreatePipeline(s_kShaderInfos[0]);
+        #pragma omp section
+        m_FFTPipeline = CreatePipeline(s_kShaderInfos[1]);
+        #pragma omp section
+        m_MapsPipeline = CreatePipeline(GetMapsShaderInfo(m_MapFormat));
+    }
+}
+
+std::unique_ptr<vkp::Pipeline> WSTessendorfCompute::CreatePipeline(
+    const vkp::ShaderInfo& shaderInfo
+) const
+{
+    std::vector<
+        std::shared_ptr<vkp::ShaderModule>
+    > shaders{
+        std::make_shared<vkp::ShaderModule>(m_kDevice, shaderInfo)
+    };
+
+    auto pipeline = std::make_unique<vkp::Pipeline>(m_kDevice, shaders);
+
+    auto& pipelineLayoutInfo = pipeline->GetPipelineLayoutInfo();
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout->GetLayout();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &s_kPushConstantRange;
+
+    pipeline->CreateCompute();
+    return pipeline;
+}
+
+const vkp::ShaderInfo& WSTessendorfCompute::GetMapsShaderInfo(
+    VkFormat mapFormat
+)
+{
+    VKP_ASSERT_MSG(mapFormat == VK_FORMAT_R32G32B32A32_SFLOAT ||
+                   mapFormat == VK_FORMAT_R16G16B16A16_SFLOAT,
+                   "Unsupported map format");
+
+    return mapFormat == VK_FORMAT_R16G16B16A16_SFLOAT ? s_kMapsShaderInfos[1]
+                                                      : s_kMapsShaderInfos[0];
+}
+
+void WSTessendorfCompute::SetMapFormat(VkFormat mapFormat)
+{
+    if (mapFormat == m_MapFormat)
+        return;
+
+    VKP_REGISTER_FUNCTION();
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    m_MapFormat = mapFormat;
+    m_MapsPipeline = CreatePipeline(GetMapsShaderInfo(m_MapFormat));
+}
+
+void WSTessendorfCompute::CreateBuffers(const uint32_t kTileSize)
+{
+    VKP_REGISTER_FUNCTION();
+
+    const VkDeviceSize kSpectrumSize =
+        sizeof(WSTessendorf::SpectrumSample) * kTileSize * kTileSize;
+
+    m_SpectrumStagingBuffer.reset(
+        new vkp::Buffer(m_kDevice, vkp::MemoryTag::Staging)
+    );
+    m_SpectrumStagingBuffer->Create(kSpectrumSize);
+
+    m_SpectrumBuffer.reset(
+        new vkp::Buffer(m_kDevice, vkp::MemoryTag::Simulation)
+    );
+    m_SpectrumBuffer->Create(kSpectrumSize,
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                             VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    const VkDeviceSize kFieldsSize =
+        sizeof(glm::vec2) * s_kFieldCount * kTileSize * kTileSize;
+
+    m_PingBuffer.reset(
+        new vkp::Buffer(m_kDevice, vkp::MemoryTag::Simulation)
+    );
+    m_PingBuffer->Create(kFieldsSize,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    m_PongBuffer.reset(
+        new vkp::Buffer(m_kDevice, vkp::MemoryTag::Simulation)
+    );
+    m_PongBuffer->Create(kFieldsSize,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void WSTessendorfCompute::CreateHeightBoundsBuffer()
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Read by the host, written by few atomics
+    m_HeightBoundsBuffer.reset(
+        new vkp::Buffer(m_kDevice, vkp::MemoryTag::Simulation)
+    );
+    m_HeightBoundsBuffer->Create(s_kHeightBoundsSliceSize * m_FrameCount,
+                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    auto err = m_HeightBoundsBuffer->Map();
+    VKP_ASSERT_RESULT(err);
+
+    m_PendingBounds.assign(m_FrameCount, false);
+}
+
+void WSTessendorfCompute::RecompileShaders()
+{
+    std::unique_ptr<vkp::Pipeline>* pipelines[] = {
+        &m_SpectrumPipeline, &m_FFTPipeline, &m_MapsPipeline
+    };
+
+    for (auto pipeline : pipelines)
+    {
+        if ((*pipeline)->RecompileShaders())
+        {
+            m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+            (*pipeline)->CreateCompute();
+        }
+    }
+}
@@ -0,0 +1,261 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_COMPUTE_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_COMPUTE_H_
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "vulkan/Device.h"
+#include "vulkan/Descriptors.h"
+#include "vulkan/ShaderModule.h"
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+#include "vulkan/Texture2D.h"
+
+#include "scene/WSTessendorf.h"
+
+
+/**
+ * @brief GPU backend of the WSTessendorf model. Evaluates the spectrum and
+ *  the inverse FFTs (radix-2 Stockham) in compute shaders, and writes the
+ *  results straight into the displacement and normal maps.
+ *  The spectrum itself is still generated on the CPU by the model,
+ *  @see WSTessendorf::PrepareSpectrum()
+ *
+ * Differences from WSTessendorf::ComputeWaves():
+ *  - min and max heights are reduced on the GPU, and read back once the
+ *    frame's slot comes around again, @see GetMinHeight()
+ */
+class WSTessendorfCompute
+{
+public:
+    /**
+     * @param descriptorPool Pool with storage buffer and storage image
+     *  descriptors, to allocate one descriptor set from
+     * @param mapFormat Format of the maps, @see SetMapFormat()
+     */
+    WSTessendorfCompute(const vkp::Device& device,
+                        const vkp::DescriptorPool& descriptorPool,
+                        VkFormat mapFormat = VK_FORMAT_R32G32B32A32_SFLOAT);
+    ~WSTessendorfCompute();
+
+    /**
+     * @brief Reallocates the height bounds with a slice for each frame in
+     *  flight, waits for the graphics queue
+     */
+    void SetFrameCount(uint32_t count);
+
+    /**
+     * @brief Records an upload of the model's spectrum, (re)creates
+     *  the FFT buffers if the resolution has changed. Until the heights of
+     *  its waves are read back, they are bound by the spectrum. Waits
+     *  for the submission of the previous upload, or of all the frames
+     *  submitted if the resolution has changed
+     * @pre The model's spectrum is prepared, the commands of the previous
+     *  call are submitted
+     * @param cmdBuffer Command buffer in recording state
+     */
+    void Prepare(VkCommandBuffer cmdBuffer, const WSTessendorf& model);
+
+    /**
+     * @brief Records the computation of the waves at time 't' into the maps.
+     *  The maps are left in LAYOUT_SHADER_READ_ONLY_OPTIMAL for the vertex
+     *  shader stage.
+     * @param cmdBuffer Command buffer in recording state, outside a render pass
+     * @param frameIndex Its previous frame is done, its heights are read
+     * @param t Elapsed time in seconds
+     * @param lambda Importance of displacement vector
+     * @param displacementMap Map of the prepared size, with STORAGE usage
+     * @param normalMap Map of the prepared size, with STORAGE usage
+     */
+    void RecordComputeWaves(VkCommandBuffer cmdBuffer,
+                            uint32_t frameIndex,
+                            float t,
+                            float lambda,
+                            vkp::Texture2D& displacementMap,
+                            vkp::Texture2D& normalMap);
+
+    void RecompileShaders();
+
+    /**
+     * @brief Recreates the pipeline writing the maps, if the format differs
+     * @param mapFormat VK_FORMAT_R32G32B32A32_SFLOAT or
+     *  VK_FORMAT_R16G16B16A16_SFLOAT
+     */
+    void SetMapFormat(VkFormat mapFormat);
+
+    uint32_t GetTileSize() const { return m_TileSize; }
+
+    /**
+     * @brief Of the last heights read back, frames behind the recorded
+     *  waves, widened by s_kHeightBoundsSlack. Within the bound of the
+     *  spectrum, not normalized, @see WSTessendorf::GetMinHeight()
+     */
+    float GetMinHeight() const { return m_MinHeight; }
+    float GetMaxHeight() const { return m_MaxHeight; }
+
+private:
+    void CreateDescriptorSetLayout();
+    void CreateDescriptorSet();
+    void CreatePipelines();
+    std::unique_ptr<vkp::Pipeline> CreatePipeline(
+        const vkp::ShaderInfo& shaderInfo) const;
+
+    /** @return Shader info of the maps pipeline writing the format */
+    static const vkp::ShaderInfo& GetMapsShaderInfo(VkFormat mapFormat);
+
+    void CreateBuffers(const uint32_t kTileSize);
+    void CreateHeightBoundsBuffer();
+
+    /**
+     * @brief Reads the frame's heights of its previous waves, if any, then
+     *  records the reset of its slice for the maps pass
+     */
+    void UpdateHeightBounds(VkCommandBuffer cmdBuffer, uint32_t frameIndex);
+
+    /** @brief Sets the bounds to those of the spectrum, of any time */
+    void SetSpectrumHeightBounds(float amplitude);
+    void UpdateDescriptorSet(const vkp::Texture2D& displacementMap,
+                             const vkp::Texture2D& normalMap);
+
+    void BindAndPush(VkCommandBuffer cmdBuffer,
+                     const vkp::Pipeline& pipeline) const;
+
+    /** @brief Makes shader writes of the previous dispatch visible */
+    static void RecordComputeBarrier(VkCommandBuffer cmdBuffer);
+
+    /** @brief Transitions the map to storage image, for compute shader writes */
+    static void TransitionMapToStorage(VkCommandBuffer cmdBuffer,
+                                       vkp::Texture2D& map);
+    /** @brief Transitions the map back for reading in the vertex shader */
+    static void TransitionMapToShaderRead(VkCommandBuffer cmdBuffer,
+                                          vkp::Texture2D& map);
+
+private:
+    const vkp::Device&         m_kDevice;
+    const vkp::DescriptorPool& m_kDescriptorPool;
+
+    // =========================================================================
+
+    static const inline std::string_view s_kCommonShaderPath{
+        "shaders/WSTessendorfCommon.comp"
+    };
+
+    static const inline std::array<vkp::ShaderInfo, 2> s_kShaderInfos {
+        vkp::ShaderInfo{
+            .paths = { s_kCommonShaderPath, "shaders/WSTessendorfSpectrum.comp" },
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .isSPV = false
+        },
+        vkp::ShaderInfo{
+            .paths = { s_kCommonShaderPath, "shaders/WSTessendorfFFT.comp" },
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .isSPV = false
+        }
+    };
+
+    // Maps shader for each of the supported map formats
+    static const inline std::array<vkp::ShaderInfo, 2> s_kMapsShaderInfos {
+        vkp::ShaderInfo{
+            .paths = { s_kCommonShaderPath,
+                       "shaders/WSTessendorfMapsRGBA32F.comp",
+                       "shaders/WSTessendorfMaps.comp" },
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .isSPV = false
+        },
+        vkp::ShaderInfo{
+            .paths = { s_kCommonShaderPath,
+                       "shaders/WSTessendorfMapsRGBA16F.comp",
+                       "shaders/WSTessendorfMaps.comp" },
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .isSPV = false
+        }
+    };
+    VkFormat m_MapFormat;
+
+    // Local sizes of the shaders
+    static constexpr uint32_t s_kGroupSize2D{ 16 };
+    static constexpr uint32_t s_kGroupSizeFFT{ 64 };
+
+    // Number of fields transformed by the FFT, same as in the shaders
+    static constexpr uint32_t s_kFieldCount{ 7 };
+
+    std::unique_ptr<vkp::DescriptorSetLayout> m_DescriptorSetLayout{ nullptr };
+    VkDescriptorSet m_DescriptorSet{ VK_NULL_HANDLE };
+    bool m_DescriptorSetIsDirty{ true };
+
+    // Maps bound in the descriptor set
+    VkImageView m_BoundDisplacementView{ VK_NULL_HANDLE };
+    VkImageView m_BoundNormalView{ VK_NULL_HANDLE };
+
+    std::unique_ptr<vkp::Pipeline> m_SpectrumPipeline{ nullptr };
+    std::unique_ptr<vkp::Pipeline> m_FFTPipeline{ nullptr };
+    std::unique_ptr<vkp::Pipeline> m_MapsPipeline{ nullptr };
+
+    struct PushConstants
+    {
+        uint32_t tileSize;
+        uint32_t stageSize;     ///< Half-size of the butterfly
+        uint32_t direction;     ///< 0: rows, 1: columns
+        uint32_t pingPong;      ///< 0: ping -> pong, 1: pong -> ping
+        float    time;
+        float    lambda;
+        uint32_t boundsSlice;   ///< Of the frame, of the height bounds
+    };
+    PushConstants m_PushConstants{};
+
+    static const inline VkPushConstantRange s_kPushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(PushConstants)
+    };
+
+    // -------------------------------------------------------------------------
+    // Buffers
+
+    uint32_t m_TileSize{ 0 };
+
+    std::unique_ptr<vkp::Buffer> m_SpectrumStagingBuffer{ nullptr };
+    std::unique_ptr<vkp::Buffer> m_SpectrumBuffer{ nullptr };
+
+    // FFT work buffers, s_kFieldCount fields of tileSize^2 complex numbers
+    std::unique_ptr<vkp::Buffer> m_PingBuffer{ nullptr };
+    std::unique_ptr<vkp::Buffer> m_PongBuffer{ nullptr };
+
+    // Of the graphics timeline, of the submission of the last copy of
+    //  the staging buffer, known by the first "RecordComputeWaves()" of
+    //  a later frame, @see Prepare()
+    static constexpr uint64_t s_kCopyUnsubmitted{ UINT64_MAX };
+    uint64_t m_SpectrumCopyValue{ 0 };
+    uint32_t m_SpectrumCopyRecords{ 0 };
+
+    // -------------------------------------------------------------------------
+    // Height bounds
+
+    // Of the range of the heights read back, the waves move on by the frames
+    //  in flight
+    static constexpr float s_kHeightBoundsSlack{ 0.1f };
+
+    // Of each frame in flight, the ordered bits of the min and max height,
+    //  @see WSTessendorfMaps.comp
+    static constexpr VkDeviceSize s_kHeightBoundsSliceSize{
+        2 * sizeof(uint32_t)
+    };
+    std::unique_ptr<vkp::Buffer> m_HeightBoundsBuffer{ nullptr };
+    uint32_t m_FrameCount{ 1 };
+    // Of each frame in flight, whether its slice has heights of the spectrum
+    std::vector<bool> m_PendingBounds;
+
+    // Of the heights at any time, the sum of |h0(k)| + |h0(-k)|
+    float m_SpectrumAmplitude{ 1.0f };
+    float m_MinHeight{ -1.0f };
+    float m_MaxHeight{ 1.0f };
+};
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_COMPUTE_H_
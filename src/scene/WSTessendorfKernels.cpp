@@ -0,0 +1,507 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSTessendorfKernels.h"
+#include "scene/WSTessendorfKernelsSimd.h"
+
+#include <cmath>
+#include <cstring>
+
+
+namespace wst {
+
+    void SpectrumSoA::Resize(size_t size)
+    {
+        heightAmpRe.resize(size);
+        heightAmpIm.resize(size);
+        heightAmpConjRe.resize(size);
+        heightAmpConjIm.resize(size);
+        dispersion.resize(size);
+        waveVecX.resize(size);
+        waveVecZ.resize(size);
+        unitX.resize(size);
+        unitZ.resize(size);
+    }
+
+    void PhasorSoA::Resize(size_t size)
+    {
+        re.resize(size);
+        im.resize(size);
+        stepRe.resize(size);
+        stepIm.resize(size);
+    }
+
+    const char* ToString(SimdLevel level)
+    {
+        switch (level)
+        {
+            case SimdLevel::AVX2:   return "AVX2";
+            case SimdLevel::AVX512: return "AVX-512";
+            default:                return "Scalar";
+        }
+    }
+
+    SimdLevel GetSupportedSimdLevel()
+    {
+    #if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_cpu_init();
+        #ifdef WST_ENABLE_AVX512
+        if (__builtin_cpu_supports("avx512f") &&
+            __builtin_cpu_supports("avx512dq"))
+            return SimdLevel::AVX512;
+        #endif
+        #ifdef WST_ENABLE_AVX2
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+            __builtin_cpu_supports("f16c"))
+            return SimdLevel::AVX2;
+        #endif
+    #endif
+        return SimdLevel::Scalar;
+    }
+
+    SpectrumKernel GetSpectrumKernel(SimdLevel level)
+    {
+        switch (level)
+        {
+        #ifdef WST_ENABLE_AVX512
+            case SimdLevel::AVX512: return ComputeSpectrumAVX512;
+        #endif
+        #ifdef WST_ENABLE_AVX2
+            case SimdLevel::AVX2:   return ComputeSpectrumAVX2;
+        #endif
+            default:                return ComputeSpectrumScalar;
+        }
+    }
+
+    HalfConvertKernel GetHalfConvertKernel(SimdLevel level)
+    {
+        switch (level)
+        {
+        #ifdef WST_ENABLE_AVX512
+            case SimdLevel::AVX512: return ConvertToHalfAVX512;
+        #endif
+        #ifdef WST_ENABLE_AVX2
+            case SimdLevel::AVX2:   return ConvertToHalfAVX2;
+        #endif
+            default:                return ConvertToHalfScalar;
+        }
+    }
+
+    /** @brief Philox4x32-10, Salmon et al., "Random123", SC'11 */
+    static inline void Philox4x32(uint32_t c[4], uint32_t k0, uint32_t k1)
+    {
+        constexpr uint32_t kM0 = 0xD2511F53;
+        constexpr uint32_t kM1 = 0xCD9E8D57;
+        constexpr uint32_t kW0 = 0x9E3779B9;    // Key schedule
+        constexpr uint32_t kW1 = 0xBB67AE85;
+
+        for (uint32_t round = 0; round < 10; ++round)
+        {
+            const uint64_t kProd0 = static_cast<uint64_t>(kM0) * c[0];
+            const uint64_t kProd1 = static_cast<uint64_t>(kM1) * c[2];
+
+            const uint32_t kC1 = c[1];
+            const uint32_t kC3 = c[3];
+            c[0] = static_cast<uint32_t>(kProd1 >> 32) ^ kC1 ^ k0;
+            c[1] = static_cast<uint32_t>(kProd1);
+            c[2] = static_cast<uint32_t>(kProd0 >> 32) ^ kC3 ^ k1;
+            c[3] = static_cast<uint32_t>(kProd0);
+
+            k0 += kW0;
+            k1 += kW1;
+        }
+    }
+
+    /** @return Of the upper 24 bits, in (0, 1), never 0 for the logarithm */
+    static inline float ToUnitFloat(const uint32_t bits)
+    {
+        return (static_cast<float>(bits >> 8) + 0.5f) * (1.0f / 16777216.0f);
+    }
+
+    /** @return Box-Muller transform of a pair of uniform numbers */
+    static inline Complex BoxMuller(const uint32_t u1, const uint32_t u2)
+    {
+        constexpr float kTwoPi = 6.28318530717958647692f;
+
+        const float kRadius = std::sqrt(-2.0f * std::log(ToUnitFloat(u1)));
+        const float kAngle = kTwoPi * ToUnitFloat(u2);
+        return Complex(kRadius * std::cos(kAngle), kRadius * std::sin(kAngle));
+    }
+
+    void GenerateGaussians(const uint64_t seed,
+                           const uint32_t rowCount,
+                           const uint32_t rowLength,
+                           Complex* out)
+    {
+        const uint32_t kKey0 = static_cast<uint32_t>(seed);
+        const uint32_t kKey1 = static_cast<uint32_t>(seed >> 32);
+        const uint32_t kPairsPerRow = rowLength / 2;
+
+        // Each block of four words is two samples, 2j and 2j + 1
+        #pragma omp parallel for schedule(static)
+        for (int32_t row = 0; row < static_cast<int32_t>(rowCount); ++row)
+        {
+            Complex* rowOut = out + static_cast<size_t>(row) * rowLength;
+            const uint64_t kFirstPair =
+                static_cast<uint64_t>(row) * kPairsPerRow;
+
+            #pragma omp simd
+            for (uint32_t j = 0; j < kPairsPerRow; ++j)
+            {
+                const uint64_t kPair = kFirstPair + j;
+                uint32_t c[4] = { static_cast<uint32_t>(kPair),
+                                  static_cast<uint32_t>(kPair >> 32),
+                                  0, 0 };
+                Philox4x32(c, kKey0, kKey1);
+
+                rowOut[2 * j]     = BoxMuller(c[0], c[1]);
+                rowOut[2 * j + 1] = BoxMuller(c[2], c[3]);
+            }
+        }
+    }
+
+    /** @return Half-precision float, rounded to nearest even */
+    static inline uint16_t FloatToHalf(const float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        const uint16_t kSign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        uint32_t absBits = bits & 0x7fffffff;
+
+        // Infinity or NaN
+        if (absBits >= 0x7f800000)
+            return kSign | 0x7c00 | (absBits > 0x7f800000 ? 0x0200 : 0);
+        // Rounds to infinity, >= 65520
+        if (absBits >= 0x477ff000)
+            return kSign | 0x7c00;
+        // Subnormal, < 2^-14, multiples of 2^-24
+        if (absBits < 0x38800000)
+        {
+            float absValue;
+            std::memcpy(&absValue, &absBits, sizeof(absValue));
+            return kSign |
+                static_cast<uint16_t>(std::nearbyint(absValue * 16777216.0f));
+        }
+
+        // Rebias the exponent by (15 - 127), round the mantissa to 10 bits
+        absBits += 0xc8000fff + ((absBits >> 13) & 1);
+        return kSign | static_cast<uint16_t>(absBits >> 13);
+    }
+
+    void ConvertToHalfScalar(const float* src, uint16_t* dst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = FloatToHalf(src[i]);
+    }
+
+    /** @brief Stores a pair of fields A, B, if packed then as A + iB */
+    static inline void StorePair(Complex* a, Complex* b, const uint32_t index,
+                                 const Complex& A, const Complex& B)
+    {
+        if (a == b)
+        {
+            a[index] = A + Complex(0, 1) * B;
+        }
+        else
+        {
+            a[index] = A;
+            b[index] = B;
+        }
+    }
+
+    void ComputeSpectrumScalar(const SpectrumSoA& spectrum,
+                               PhasorSoA* phasors,
+                               PhasorUpdate update,
+                               const SpectrumOutputs& outputs,
+                               uint32_t begin, uint32_t end, float t)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            // exp(ix) = cos(x) * i*sin(x)
+            float pcos, psin;
+            if (update == PhasorUpdate::Evaluate)
+            {
+                const float omega_t = spectrum.dispersion[i] * t;
+                pcos = glm::cos(omega_t);
+                psin = glm::sin(omega_t);
+            }
+            else
+            {
+                // exp(iw(t - dt)) * exp(iw*dt)
+                const float kRe = phasors->re[i];
+                const float kIm = phasors->im[i];
+                pcos = kRe * phasors->stepRe[i] - kIm * phasors->stepIm[i];
+                psin = kRe * phasors->stepIm[i] + kIm * phasors->stepRe[i];
+            }
+            if (phasors != nullptr)
+            {
+                phasors->re[i] = pcos;
+                phasors->im[i] = psin;
+            }
+
+            const Complex kHeight =
+                Complex(spectrum.heightAmpRe[i], spectrum.heightAmpIm[i]) *
+                    Complex(pcos, psin) +
+                Complex(spectrum.heightAmpConjRe[i], spectrum.heightAmpConjIm[i]) *
+                    Complex(pcos, -psin);
+            outputs.height[i] = kHeight;
+
+            const float kx = spectrum.waveVecX[i];
+            const float kz = spectrum.waveVecZ[i];
+
+            // Displacement vectors
+            const Complex kDisplacementX =
+                Complex(0, -spectrum.unitX[i]) * kHeight;
+            const Complex kDisplacementZ =
+                Complex(0, -spectrum.unitZ[i]) * kHeight;
+            StorePair(outputs.displacementX, outputs.displacementZ, i,
+                      kDisplacementX, kDisplacementZ);
+
+            if (outputs.slopeX == nullptr)
+                continue;
+
+            // Slopes for normals computation
+            StorePair(outputs.slopeX, outputs.slopeZ, i,
+                      Complex(0, kx) * kHeight,
+                      Complex(0, kz) * kHeight);
+
+            StorePair(outputs.dxDisplacementX, outputs.dzDisplacementZ, i,
+                      Complex(0, kx) * kDisplacementX,
+                      Complex(0, kz) * kDisplacementZ);
+
+            if (outputs.dxDisplacementZ != nullptr)
+            {
+                StorePair(outputs.dxDisplacementZ, outputs.dzDisplacementX, i,
+                          Complex(0, kx) * kDisplacementZ,
+                          Complex(0, kz) * kDisplacementX);
+            }
+        }
+    }
+
+#if defined(WST_ENABLE_AVX2) || defined(WST_ENABLE_AVX512)
+    static simd::SpectrumArrays ToArrays(const SpectrumSoA& spectrum)
+    {
+        return {
+            spectrum.heightAmpRe.data(),     spectrum.heightAmpIm.data(),
+            spectrum.heightAmpConjRe.data(), spectrum.heightAmpConjIm.data(),
+            spectrum.dispersion.data(),
+            spectrum.waveVecX.data(),        spectrum.waveVecZ.data(),
+            spectrum.unitX.data(),           spectrum.unitZ.data()
+        };
+    }
+
+    static simd::PhasorArrays ToArrays(PhasorSoA& phasors)
+    {
+        return { phasors.re.data(),     phasors.im.data(),
+                 phasors.stepRe.data(), phasors.stepIm.data() };
+    }
+
+    static simd::FieldArrays ToArrays(const SpectrumOutputs& outputs)
+    {
+        // Of "std::complex", array-compatible with float[2]
+        auto Floats = [](Complex* field) {
+            return reinterpret_cast<float*>(field);
+        };
+        return {
+            Floats(outputs.height),
+            Floats(outputs.slopeX),          Floats(outputs.slopeZ),
+            Floats(outputs.displacementX),   Floats(outputs.displacementZ),
+            Floats(outputs.dxDisplacementX), Floats(outputs.dzDisplacementZ),
+            Floats(outputs.dxDisplacementZ), Floats(outputs.dzDisplacementX)
+        };
+    }
+
+    using SimdSpectrumKernel = uint32_t (*)(const simd::SpectrumArrays*,
+                                            const simd::PhasorArrays*,
+                                            bool,
+                                            const simd::FieldArrays*,
+                                            uint32_t, uint32_t, float);
+
+    /** @brief Of a kernel of "WSTessendorfKernelsSimd.h", and the remainder */
+    static void ComputeSpectrumSimd(SimdSpectrumKernel kernel,
+                                    const SpectrumSoA& spectrum,
+                                    PhasorSoA* phasors,
+                                    PhasorUpdate update,
+                                    const SpectrumOutputs& outputs,
+                                    uint32_t begin, uint32_t end, float t)
+    {
+        const simd::SpectrumArrays kSpectrum = ToArrays(spectrum);
+        const simd::FieldArrays kOutputs = ToArrays(outputs);
+        simd::PhasorArrays phasorArrays{};
+        if (phasors != nullptr)
+            phasorArrays = ToArrays(*phasors);
+
+        const uint32_t kComputed = kernel(
+            &kSpectrum, phasors != nullptr ? &phasorArrays : nullptr,
+            update == PhasorUpdate::Evaluate, &kOutputs, begin, end, t);
+
+        // Remainder
+        ComputeSpectrumScalar(spectrum, phasors, update, outputs,
+                              kComputed, end, t);
+    }
+#endif
+
+#ifdef WST_ENABLE_AVX2
+    void ComputeSpectrumAVX2(const SpectrumSoA& spectrum,
+                             PhasorSoA* phasors,
+                             PhasorUpdate update,
+                             const SpectrumOutputs& outputs,
+                             uint32_t begin, uint32_t end, float t)
+    {
+        ComputeSpectrumSimd(simd::ComputeSpectrumAVX2, spectrum, phasors,
+                            update, outputs, begin, end, t);
+    }
+
+    void ConvertToHalfAVX2(const float* src, uint16_t* dst, size_t count)
+    {
+        const size_t kConverted = simd::ConvertToHalfAVX2(src, dst, count);
+        ConvertToHalfScalar(src + kConverted, dst + kConverted,
+                            count - kConverted);
+    }
+#endif
+
+#ifdef WST_ENABLE_AVX512
+    void ComputeSpectrumAVX512(const SpectrumSoA& spectrum,
+                               PhasorSoA* phasors,
+                               PhasorUpdate update,
+                               const SpectrumOutputs& outputs,
+                               uint32_t begin, uint32_t end, float t)
+    {
+        ComputeSpectrumSimd(simd::ComputeSpectrumAVX512, spectrum, phasors,
+                            update, outputs, begin, end, t);
+    }
+
+    void ConvertToHalfAVX512(const float* src, uint16_t* dst, size_t count)
+    {
+        const size_t kConverted = simd::ConvertToHalfAVX512(src, dst, count);
+        ConvertToHalfScalar(src + kConverted, dst + kConverted,
+                            count - kConverted);
+    }
+#endif
+
+    /**
+     * @brief Of "OutputRowKernel", of the row length 'kTileSize', or of the
+     *  given one if 0. Branches of the features are resolved at compile time
+     */
+    template<bool kHasNormals, bool kHasJacobian, bool kIsChoppy,
+             uint32_t kTileSize>
+    static void WriteOutputRow(const SpectrumOutputs& fields,
+                               float lambda,
+                               uint32_t tileSize,
+                               uint32_t row,
+                               float* displacements,
+                               float* normals,
+                               float& minHeight,
+                               float& maxHeight)
+    {
+        const uint32_t kSize = kTileSize > 0 ? kTileSize : tileSize;
+        const uint32_t kRowOffset = row * kSize;
+        const float kSigns[] = { 1.0f, -1.0f };
+
+        for (uint32_t n = 0; n < kSize; ++n)
+        {
+            const uint32_t kIndex = kRowOffset + n;
+            const float kSign = kSigns[(n + row) & 1];
+            const float kHeight = kSign * fields.height[kIndex].real();
+            maxHeight = glm::max(kHeight, maxHeight);
+            minHeight = glm::min(kHeight, minHeight);
+
+            float displacementX = 0.0f;
+            float displacementZ = 0.0f;
+            if constexpr (kIsChoppy)
+            {
+                displacementX =
+                    kSign * lambda * fields.displacementX[kIndex].real();
+                displacementZ = kSign * lambda * GetSecondOfPair(
+                    fields.displacementX, fields.displacementZ, kIndex);
+            }
+
+            float jacobian = 1.0f;
+            if constexpr (kHasNormals)
+            {
+                const float kDxDisplacementX =
+                    kSign * fields.dxDisplacementX[kIndex].real();
+                const float kDzDisplacementZ = kSign * GetSecondOfPair(
+                    fields.dxDisplacementX, fields.dzDisplacementZ, kIndex);
+
+                // Of a lambda of 0 it is 1
+                if constexpr (kHasJacobian && kIsChoppy)
+                {
+                    const float kDxDisplacementZ =
+                        kSign * fields.dxDisplacementZ[kIndex].real();
+                    const float kDzDisplacementX = kSign * GetSecondOfPair(
+                        fields.dxDisplacementZ, fields.dzDisplacementX,
+                        kIndex);
+                    jacobian = (1.0f + lambda * kDxDisplacementX) *
+                               (1.0f + lambda * kDzDisplacementZ) -
+                               (lambda * kDxDisplacementZ) *
+                               (lambda * kDzDisplacementX);
+                }
+
+                // Whole texels, stored once
+                float* normal = normals + 4 * n;
+                normal[0] = kSign * fields.slopeX[kIndex].real();
+                normal[1] = kSign * GetSecondOfPair(fields.slopeX,
+                                                    fields.slopeZ, kIndex);
+                normal[2] = kDxDisplacementX;
+                normal[3] = kDzDisplacementZ;
+            }
+
+            float* displacement = displacements + 4 * n;
+            displacement[0] = displacementX;
+            displacement[1] = kHeight;
+            displacement[2] = displacementZ;
+            displacement[3] = jacobian;
+        }
+    }
+
+    template<bool kHasNormals, bool kHasJacobian, bool kIsChoppy>
+    static OutputRowKernel GetOutputRowKernelOfSize(uint32_t tileSize)
+    {
+        switch (tileSize)
+        {
+            case 64:
+                return WriteOutputRow<kHasNormals, kHasJacobian, kIsChoppy,
+                                      64>;
+            case 128:
+                return WriteOutputRow<kHasNormals, kHasJacobian, kIsChoppy,
+                                      128>;
+            case 256:
+                return WriteOutputRow<kHasNormals, kHasJacobian, kIsChoppy,
+                                      256>;
+            case 512:
+                return WriteOutputRow<kHasNormals, kHasJacobian, kIsChoppy,
+                                      512>;
+            case 1024:
+                return WriteOutputRow<kHasNormals, kHasJacobian, kIsChoppy,
+                                      1024>;
+            // Of the row length given at runtime
+            default:
+                return WriteOutputRow<kHasNormals, kHasJacobian, kIsChoppy,
+                                      0>;
+        }
+    }
+
+    OutputRowKernel GetOutputRowKernel(const OutputFeatures& features,
+                                       uint32_t tileSize)
+    {
+        // Jacobian is of the derivatives of the normals, 1 if not choppy
+        if (!features.hasNormals)
+        {
+            return features.isChoppy
+                ? GetOutputRowKernelOfSize<false, false, true>(tileSize)
+                : GetOutputRowKernelOfSize<false, false, false>(tileSize);
+        }
+        if (!features.isChoppy)
+            return GetOutputRowKernelOfSize<true, false, false>(tileSize);
+
+        return features.hasJacobian
+            ? GetOutputRowKernelOfSize<true, true, true>(tileSize)
+            : GetOutputRowKernelOfSize<true, false, true>(tileSize);
+    }
+
+} // namespace wst
@@ -0,0 +1,201 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_KERNELS_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_KERNELS_H_
+
+#include <complex>
+#include <vector>
+#include <cstdint>
+
+
+/**
+ * @brief Kernels of the spectrum evaluation of the WSTessendorf model,
+ *  scalar and SIMD ones, selected at runtime by the supported instruction set
+ */
+namespace wst {
+
+    using Complex = std::complex<float>;
+
+    /** @brief Precomputed spectrum in structure-of-arrays layout */
+    struct SpectrumSoA
+    {
+        std::vector<float> heightAmpRe;     ///< FT amplitude of wave height
+        std::vector<float> heightAmpIm;
+        std::vector<float> heightAmpConjRe; ///< Conjugate of the amplitude
+        std::vector<float> heightAmpConjIm;
+        std::vector<float> dispersion;      ///< Descrete dispersion value
+        std::vector<float> waveVecX;        ///< Wave vector
+        std::vector<float> waveVecZ;
+        std::vector<float> unitX;           ///< Unit wave vector
+        std::vector<float> unitZ;
+
+        void Resize(size_t size);
+        size_t Size() const { return dispersion.size(); }
+    };
+
+    /**
+     * @brief Phasors exp(i*w*t) of the previous evaluation, and their
+     *  rotations exp(i*w*dt) by a fixed time step, for incremental updates
+     */
+    struct PhasorSoA
+    {
+        std::vector<float> re;
+        std::vector<float> im;
+        std::vector<float> stepRe;
+        std::vector<float> stepIm;
+
+        void Resize(size_t size);
+        size_t Size() const { return re.size(); }
+    };
+
+    /** @brief How the phasors exp(i*w*t) are obtained by a kernel */
+    enum class PhasorUpdate
+    {
+        Evaluate = 0,           ///< sin and cos of w*t
+        Advance,                ///< Previous phasors rotated by one step
+    };
+
+    /**
+     * @brief Destinations of the inputs of the transforms. Of a pair of
+     *  real-valued fields, the second one aliases the first one if packed,
+     *  then it is stored as A + iB
+     */
+    struct SpectrumOutputs
+    {
+        Complex* height;
+        Complex* slopeX;            ///< Null without normals, then also
+        Complex* slopeZ;            ///<  the derivatives are
+        Complex* displacementX;
+        Complex* displacementZ;
+        Complex* dxDisplacementX;
+        Complex* dzDisplacementZ;
+        Complex* dxDisplacementZ;   ///< May be null
+        Complex* dzDisplacementX;   ///< May be null
+    };
+
+    /**
+     * @brief Evaluates the FT inputs of elements [begin, end) at time 't',
+     *  within one animation period
+     * @param phasors If not null, the phasors are stored to it, required
+     *  unless the update is PhasorUpdate::Evaluate
+     */
+    using SpectrumKernel = void (*)(const SpectrumSoA& spectrum,
+                                    PhasorSoA* phasors,
+                                    PhasorUpdate update,
+                                    const SpectrumOutputs& outputs,
+                                    uint32_t begin,
+                                    uint32_t end,
+                                    float t);
+
+    /** @return Transformed real value of the second field of a pair */
+    inline float GetSecondOfPair(const Complex* a, const Complex* b,
+                                 const uint32_t index)
+    {
+        return a == b ? a[index].imag() : b[index].real();
+    }
+
+    /** @brief Features of the outputs, each kernel is specialized on them */
+    struct OutputFeatures
+    {
+        bool hasNormals;    ///< Else of the height and displacements alone
+        bool hasJacobian;   ///< Of the cross derivatives, else it is 1
+        bool isChoppy;      ///< Of a lambda not 0, else displaced vertically
+    };
+
+    /**
+     * @brief Unpacks a row of the transformed fields, in place of their
+     *  inputs, to texels of 4 floats, converting the grid back to interval
+     *  [-size/2, ..., 0, ..., size/2]; reduces the heights to min and max
+     * @param fields Transformed, as set up for the features
+     * @param lambda Scale of the horizontal displacements
+     * @param normals Unused without normals
+     */
+    using OutputRowKernel = void (*)(const SpectrumOutputs& fields,
+                                     float lambda,
+                                     uint32_t tileSize,
+                                     uint32_t row,
+                                     float* displacements,
+                                     float* normals,
+                                     float& minHeight,
+                                     float& maxHeight);
+
+    /**
+     * @return Kernel of the features, of a constant row length for the
+     *  common tile sizes 64 to 1024, otherwise of the given one
+     */
+    OutputRowKernel GetOutputRowKernel(const OutputFeatures& features,
+                                       uint32_t tileSize);
+
+    enum class SimdLevel
+    {
+        Scalar = 0,
+        AVX2,
+        AVX512,
+
+        Total
+    };
+
+    const char* ToString(SimdLevel level);
+
+    /** @return The widest instruction set supported by the CPU and build */
+    SimdLevel GetSupportedSimdLevel();
+
+    /** @return Kernel for the level, or the scalar one if not built */
+    SpectrumKernel GetSpectrumKernel(SimdLevel level);
+
+    /** @brief Converts 'count' floats to half-precision floats */
+    using HalfConvertKernel = void (*)(const float* src,
+                                       uint16_t* dst,
+                                       size_t count);
+
+    /** @return Kernel for the level, or the scalar one if not built */
+    HalfConvertKernel GetHalfConvertKernel(SimdLevel level);
+
+    void ConvertToHalfScalar(const float* src, uint16_t* dst, size_t count);
+#ifdef WST_ENABLE_AVX2
+    void ConvertToHalfAVX2(const float* src, uint16_t* dst, size_t count);
+#endif
+#ifdef WST_ENABLE_AVX512
+    void ConvertToHalfAVX512(const float* src, uint16_t* dst, size_t count);
+#endif
+
+    /**
+     * @brief Fills 'rowCount' rows of 'rowLength' complex samples, of both
+     *  parts standard normal, by the counter-based Philox4x32-10 generator:
+     *  each pair of samples is of its own counter, their index, under the key
+     *  of the seed. The output depends only on the seed, not on the order nor
+     *  on the number of threads it is computed by
+     * @param rowLength Even
+     */
+    void GenerateGaussians(uint64_t seed,
+                           uint32_t rowCount,
+                           uint32_t rowLength,
+                           Complex* out);
+
+    void ComputeSpectrumScalar(const SpectrumSoA& spectrum,
+                               PhasorSoA* phasors,
+                               PhasorUpdate update,
+                               const SpectrumOutputs& outputs,
+                               uint32_t begin, uint32_t end, float t);
+#ifdef WST_ENABLE_AVX2
+    void ComputeSpectrumAVX2(const SpectrumSoA& spectrum,
+                             PhasorSoA* phasors,
+                             PhasorUpdate update,
+                             const SpectrumOutputs& outputs,
+                             uint32_t begin, uint32_t end, float t);
+#endif
+#ifdef WST_ENABLE_AVX512
+    void ComputeSpectrumAVX512(const SpectrumSoA& spectrum,
+                               PhasorSoA* phasors,
+                               PhasorUpdate update,
+                               const SpectrumOutputs& outputs,
+                               uint32_t begin, uint32_t end, float t);
+#endif
+
+} // namespace wst
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_KERNELS_H_
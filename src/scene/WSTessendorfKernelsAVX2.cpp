@@ -0,0 +1,203 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "scene/WSTessendorfKernelsSimd.h"
+
+#include <immintrin.h>
+
+// Compiled with -mavx2 -mfma -mf16c, called only if supported, @see GetSupportedSimdLevel()
+
+namespace wst {
+namespace simd {
+
+    namespace {
+
+        constexpr uint32_t kWidth{ 8 };
+
+        inline __m256 Load(const float* v, const uint32_t i)
+        {
+            return _mm256_loadu_ps(v + i);
+        }
+
+        /**
+         * @brief Vectorized sine and cosine, Cephes single precision
+         *  approximation, accurate for |x| up to about 8192, the times are
+         *  wrapped to the animation period, @see WSTessendorf::ComputeWaves()
+         */
+        inline void SinCos(__m256 x, __m256& outSin, __m256& outCos)
+        {
+            const __m256 kSignMask = _mm256_set1_ps(-0.0f);
+            __m256 signSin = _mm256_and_ps(x, kSignMask);
+            x = _mm256_xor_ps(x, signSin);
+
+            // Octant of |x|, (j + 1) & ~1
+            __m256 y = _mm256_mul_ps(x, _mm256_set1_ps(1.27323954473516f));
+            __m256i j = _mm256_cvttps_epi32(y);
+            j = _mm256_add_epi32(j, _mm256_set1_epi32(1));
+            j = _mm256_and_si256(j, _mm256_set1_epi32(~1));
+            y = _mm256_cvtepi32_ps(j);
+
+            const __m256 kSwapSignSin = _mm256_castsi256_ps(_mm256_slli_epi32(
+                _mm256_and_si256(j, _mm256_set1_epi32(4)), 29));
+            const __m256 kSignCos = _mm256_castsi256_ps(_mm256_slli_epi32(
+                _mm256_andnot_si256(_mm256_sub_epi32(j, _mm256_set1_epi32(2)),
+                                _mm256_set1_epi32(4)), 29));
+            const __m256 kPolyMask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+                _mm256_and_si256(j, _mm256_set1_epi32(2)),
+                _mm256_setzero_si256()));
+            signSin = _mm256_xor_ps(signSin, kSwapSignSin);
+
+            // Extended precision reduction, x - y * pi/4
+            x = _mm256_fmadd_ps(y, _mm256_set1_ps(-0.78515625f), x);
+            x = _mm256_fmadd_ps(y, _mm256_set1_ps(-2.4187564849853515625e-4f), x);
+            x = _mm256_fmadd_ps(y, _mm256_set1_ps(-3.77489497744594108e-8f), x);
+
+            const __m256 z = _mm256_mul_ps(x, x);
+
+            __m256 yCos = _mm256_fmadd_ps(_mm256_set1_ps(2.443315711809948e-5f), z,
+                                    _mm256_set1_ps(-1.388731625493765e-3f));
+            yCos = _mm256_fmadd_ps(yCos, z, _mm256_set1_ps(4.166664568298827e-2f));
+            yCos = _mm256_mul_ps(_mm256_mul_ps(yCos, z), z);
+            yCos = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, yCos);
+            yCos = _mm256_add_ps(yCos, _mm256_set1_ps(1.0f));
+
+            __m256 ySin = _mm256_fmadd_ps(_mm256_set1_ps(-1.9515295891e-4f), z,
+                                    _mm256_set1_ps(8.3321608736e-3f));
+            ySin = _mm256_fmadd_ps(ySin, z, _mm256_set1_ps(-1.6666654611e-1f));
+            ySin = _mm256_mul_ps(ySin, z);
+            ySin = _mm256_fmadd_ps(ySin, x, x);
+
+            outSin = _mm256_xor_ps(_mm256_blendv_ps(yCos, ySin, kPolyMask), signSin);
+            outCos = _mm256_xor_ps(_mm256_blendv_ps(ySin, yCos, kPolyMask), kSignCos);
+        }
+
+        /** @brief Stores interleaved complex numbers dst[0..2 * kWidth) */
+        inline void StoreComplex(float* out, const __m256 re, const __m256 im)
+        {
+            const __m256 kLo = _mm256_unpacklo_ps(re, im);
+            const __m256 kHi = _mm256_unpackhi_ps(re, im);
+            _mm256_storeu_ps(out,     _mm256_permute2f128_ps(kLo, kHi, 0x20));
+            _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(kLo, kHi, 0x31));
+        }
+
+        /** @brief Stores a pair of fields A, B, if packed then as A + iB */
+        inline void StorePair(float* a, float* b, const uint32_t index,
+                              const __m256 aRe, const __m256 aIm,
+                              const __m256 bRe, const __m256 bIm)
+        {
+            if (a == b)
+            {
+                StoreComplex(a + 2 * index, _mm256_sub_ps(aRe, bIm),
+                                            _mm256_add_ps(aIm, bRe));
+            }
+            else
+            {
+                StoreComplex(a + 2 * index, aRe, aIm);
+                StoreComplex(b + 2 * index, bRe, bIm);
+            }
+        }
+
+    } // namespace
+
+    uint32_t ComputeSpectrumAVX2(const SpectrumArrays* spectrum,
+                                 const PhasorArrays* phasors,
+                                 bool evaluate,
+                                 const FieldArrays* outputs,
+                                 uint32_t begin, uint32_t end, float t)
+    {
+        const __m256 kTime = _mm256_set1_ps(t);
+
+        uint32_t i = begin;
+        for (; i + kWidth <= end; i += kWidth)
+        {
+            // exp(iwt) = cos(wt) + i*sin(wt)
+            __m256 pSin, pCos;
+            if (evaluate)
+            {
+                SinCos(_mm256_mul_ps(Load(spectrum->dispersion, i), kTime),
+                       pSin, pCos);
+            }
+            else
+            {
+                // exp(iw(t - dt)) * exp(iw*dt)
+                const __m256 kRe = Load(phasors->re, i);
+                const __m256 kIm = Load(phasors->im, i);
+                const __m256 kStepRe = Load(phasors->stepRe, i);
+                const __m256 kStepIm = Load(phasors->stepIm, i);
+                pCos = _mm256_fmsub_ps(kRe, kStepRe, _mm256_mul_ps(kIm, kStepIm));
+                pSin = _mm256_fmadd_ps(kRe, kStepIm, _mm256_mul_ps(kIm, kStepRe));
+            }
+            if (phasors != nullptr)
+            {
+                _mm256_storeu_ps(phasors->re + i, pCos);
+                _mm256_storeu_ps(phasors->im + i, pSin);
+            }
+
+            // h0 * exp(iwt) + conj(h0(-k)) * exp(-iwt)
+            const __m256 a = Load(spectrum->heightAmpRe, i);
+            const __m256 b = Load(spectrum->heightAmpIm, i);
+            const __m256 p = Load(spectrum->heightAmpConjRe, i);
+            const __m256 q = Load(spectrum->heightAmpConjIm, i);
+
+            const __m256 hRe = _mm256_fmadd_ps(_mm256_add_ps(a, p), pCos,
+                                         _mm256_mul_ps(_mm256_sub_ps(q, b), pSin));
+            const __m256 hIm = _mm256_fmadd_ps(_mm256_add_ps(b, q), pCos,
+                                         _mm256_mul_ps(_mm256_sub_ps(a, p), pSin));
+            StoreComplex(outputs->height + 2 * i, hRe, hIm);
+
+            const __m256 kx = Load(spectrum->waveVecX, i);
+            const __m256 kz = Load(spectrum->waveVecZ, i);
+            const __m256 ux = Load(spectrum->unitX, i);
+            const __m256 uz = Load(spectrum->unitZ, i);
+            const __m256 kZero = _mm256_setzero_ps();
+
+            // Displacements, -i * unit(k) * h
+            StorePair(outputs->displacementX, outputs->displacementZ, i,
+                      _mm256_mul_ps(ux, hIm), _mm256_fnmadd_ps(ux, hRe, kZero),
+                      _mm256_mul_ps(uz, hIm), _mm256_fnmadd_ps(uz, hRe, kZero));
+
+            if (outputs->slopeX == nullptr)
+                continue;
+
+            // Slopes, i * k * h
+            StorePair(outputs->slopeX, outputs->slopeZ, i,
+                      _mm256_fnmadd_ps(kx, hIm, kZero), _mm256_mul_ps(kx, hRe),
+                      _mm256_fnmadd_ps(kz, hIm, kZero), _mm256_mul_ps(kz, hRe));
+
+            // Derivatives of displacements, k * unit(k) * h
+            const __m256 kxux = _mm256_mul_ps(kx, ux);
+            const __m256 kzuz = _mm256_mul_ps(kz, uz);
+            StorePair(outputs->dxDisplacementX, outputs->dzDisplacementZ, i,
+                      _mm256_mul_ps(kxux, hRe), _mm256_mul_ps(kxux, hIm),
+                      _mm256_mul_ps(kzuz, hRe), _mm256_mul_ps(kzuz, hIm));
+
+            if (outputs->dxDisplacementZ != nullptr)
+            {
+                const __m256 kxuz = _mm256_mul_ps(kx, uz);
+                const __m256 kzux = _mm256_mul_ps(kz, ux);
+                StorePair(outputs->dxDisplacementZ, outputs->dzDisplacementX, i,
+                          _mm256_mul_ps(kxuz, hRe), _mm256_mul_ps(kxuz, hIm),
+                          _mm256_mul_ps(kzux, hRe), _mm256_mul_ps(kzux, hIm));
+            }
+        }
+
+        return i;
+    }
+
+    size_t ConvertToHalfAVX2(const float* src, uint16_t* dst, size_t count)
+    {
+        size_t i = 0;
+        for (; i + kWidth <= count; i += kWidth)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                _MM_FROUND_TO_NEAREST_INT));
+        }
+
+        return i;
+    }
+
+} // namespace simd
+} // namespace wst
@@ -0,0 +1,205 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "scene/WSTessendorfKernelsSimd.h"
+
+#include <immintrin.h>
+
+// Compiled with -mavx512f -mavx512dq, called only if supported, @see GetSupportedSimdLevel()
+
+namespace wst {
+namespace simd {
+
+    namespace {
+
+        constexpr uint32_t kWidth{ 16 };
+
+        inline __m512 Load(const float* v, const uint32_t i)
+        {
+            return _mm512_loadu_ps(v + i);
+        }
+
+        /**
+         * @brief Vectorized sine and cosine, Cephes single precision
+         *  approximation, accurate for |x| up to about 8192, the times are
+         *  wrapped to the animation period, @see WSTessendorf::ComputeWaves()
+         */
+        inline void SinCos(__m512 x, __m512& outSin, __m512& outCos)
+        {
+            const __m512 kSignMask = _mm512_set1_ps(-0.0f);
+            __m512 signSin = _mm512_and_ps(x, kSignMask);
+            x = _mm512_xor_ps(x, signSin);
+
+            // Octant of |x|, (j + 1) & ~1
+            __m512 y = _mm512_mul_ps(x, _mm512_set1_ps(1.27323954473516f));
+            __m512i j = _mm512_cvttps_epi32(y);
+            j = _mm512_add_epi32(j, _mm512_set1_epi32(1));
+            j = _mm512_and_si512(j, _mm512_set1_epi32(~1));
+            y = _mm512_cvtepi32_ps(j);
+
+            const __m512 kSwapSignSin = _mm512_castsi512_ps(_mm512_slli_epi32(
+                _mm512_and_si512(j, _mm512_set1_epi32(4)), 29));
+            const __m512 kSignCos = _mm512_castsi512_ps(_mm512_slli_epi32(
+                _mm512_andnot_si512(_mm512_sub_epi32(j, _mm512_set1_epi32(2)),
+                                _mm512_set1_epi32(4)), 29));
+            const __mmask16 kPolyMask = _mm512_cmpeq_epi32_mask(
+                _mm512_and_si512(j, _mm512_set1_epi32(2)),
+                _mm512_setzero_si512());
+            signSin = _mm512_xor_ps(signSin, kSwapSignSin);
+
+            // Extended precision reduction, x - y * pi/4
+            x = _mm512_fmadd_ps(y, _mm512_set1_ps(-0.78515625f), x);
+            x = _mm512_fmadd_ps(y, _mm512_set1_ps(-2.4187564849853515625e-4f), x);
+            x = _mm512_fmadd_ps(y, _mm512_set1_ps(-3.77489497744594108e-8f), x);
+
+            const __m512 z = _mm512_mul_ps(x, x);
+
+            __m512 yCos = _mm512_fmadd_ps(_mm512_set1_ps(2.443315711809948e-5f), z,
+                                    _mm512_set1_ps(-1.388731625493765e-3f));
+            yCos = _mm512_fmadd_ps(yCos, z, _mm512_set1_ps(4.166664568298827e-2f));
+            yCos = _mm512_mul_ps(_mm512_mul_ps(yCos, z), z);
+            yCos = _mm512_fnmadd_ps(_mm512_set1_ps(0.5f), z, yCos);
+            yCos = _mm512_add_ps(yCos, _mm512_set1_ps(1.0f));
+
+            __m512 ySin = _mm512_fmadd_ps(_mm512_set1_ps(-1.9515295891e-4f), z,
+                                    _mm512_set1_ps(8.3321608736e-3f));
+            ySin = _mm512_fmadd_ps(ySin, z, _mm512_set1_ps(-1.6666654611e-1f));
+            ySin = _mm512_mul_ps(ySin, z);
+            ySin = _mm512_fmadd_ps(ySin, x, x);
+
+            outSin = _mm512_xor_ps(_mm512_mask_blend_ps(kPolyMask, yCos, ySin), signSin);
+            outCos = _mm512_xor_ps(_mm512_mask_blend_ps(kPolyMask, ySin, yCos), kSignCos);
+        }
+
+        /** @brief Stores interleaved complex numbers dst[0..2 * kWidth) */
+        inline void StoreComplex(float* out, const __m512 re, const __m512 im)
+        {
+            const __m512i kLo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19,
+                                                  4, 20, 5, 21, 6, 22, 7, 23);
+            const __m512i kHi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27,
+                                                  12, 28, 13, 29, 14, 30, 15, 31);
+            _mm512_storeu_ps(out,      _mm512_permutex2var_ps(re, kLo, im));
+            _mm512_storeu_ps(out + 16, _mm512_permutex2var_ps(re, kHi, im));
+        }
+
+        /** @brief Stores a pair of fields A, B, if packed then as A + iB */
+        inline void StorePair(float* a, float* b, const uint32_t index,
+                              const __m512 aRe, const __m512 aIm,
+                              const __m512 bRe, const __m512 bIm)
+        {
+            if (a == b)
+            {
+                StoreComplex(a + 2 * index, _mm512_sub_ps(aRe, bIm),
+                                            _mm512_add_ps(aIm, bRe));
+            }
+            else
+            {
+                StoreComplex(a + 2 * index, aRe, aIm);
+                StoreComplex(b + 2 * index, bRe, bIm);
+            }
+        }
+
+    } // namespace
+
+    uint32_t ComputeSpectrumAVX512(const SpectrumArrays* spectrum,
+                                   const PhasorArrays* phasors,
+                                   bool evaluate,
+                                   const FieldArrays* outputs,
+                                   uint32_t begin, uint32_t end, float t)
+    {
+        const __m512 kTime = _mm512_set1_ps(t);
+
+        uint32_t i = begin;
+        for (; i + kWidth <= end; i += kWidth)
+        {
+            // exp(iwt) = cos(wt) + i*sin(wt)
+            __m512 pSin, pCos;
+            if (evaluate)
+            {
+                SinCos(_mm512_mul_ps(Load(spectrum->dispersion, i), kTime),
+                       pSin, pCos);
+            }
+            else
+            {
+                // exp(iw(t - dt)) * exp(iw*dt)
+                const __m512 kRe = Load(phasors->re, i);
+                const __m512 kIm = Load(phasors->im, i);
+                const __m512 kStepRe = Load(phasors->stepRe, i);
+                const __m512 kStepIm = Load(phasors->stepIm, i);
+                pCos = _mm512_fmsub_ps(kRe, kStepRe, _mm512_mul_ps(kIm, kStepIm));
+                pSin = _mm512_fmadd_ps(kRe, kStepIm, _mm512_mul_ps(kIm, kStepRe));
+            }
+            if (phasors != nullptr)
+            {
+                _mm512_storeu_ps(phasors->re + i, pCos);
+                _mm512_storeu_ps(phasors->im + i, pSin);
+            }
+
+            // h0 * exp(iwt) + conj(h0(-k)) * exp(-iwt)
+            const __m512 a = Load(spectrum->heightAmpRe, i);
+            const __m512 b = Load(spectrum->heightAmpIm, i);
+            const __m512 p = Load(spectrum->heightAmpConjRe, i);
+            const __m512 q = Load(spectrum->heightAmpConjIm, i);
+
+            const __m512 hRe = _mm512_fmadd_ps(_mm512_add_ps(a, p), pCos,
+                                         _mm512_mul_ps(_mm512_sub_ps(q, b), pSin));
+            const __m512 hIm = _mm512_fmadd_ps(_mm512_add_ps(b, q), pCos,
+                                         _mm512_mul_ps(_mm512_sub_ps(a, p), pSin));
+            StoreComplex(outputs->height + 2 * i, hRe, hIm);
+
+            const __m512 kx = Load(spectrum->waveVecX, i);
+            const __m512 kz = Load(spectrum->waveVecZ, i);
+            const __m512 ux = Load(spectrum->unitX, i);
+            const __m512 uz = Load(spectrum->unitZ, i);
+            const __m512 kZero = _mm512_setzero_ps();
+
+            // Displacements, -i * unit(k) * h
+            StorePair(outputs->displacementX, outputs->displacementZ, i,
+                      _mm512_mul_ps(ux, hIm), _mm512_fnmadd_ps(ux, hRe, kZero),
+                      _mm512_mul_ps(uz, hIm), _mm512_fnmadd_ps(uz, hRe, kZero));
+
+            if (outputs->slopeX == nullptr)
+                continue;
+
+            // Slopes, i * k * h
+            StorePair(outputs->slopeX, outputs->slopeZ, i,
+                      _mm512_fnmadd_ps(kx, hIm, kZero), _mm512_mul_ps(kx, hRe),
+                      _mm512_fnmadd_ps(kz, hIm, kZero), _mm512_mul_ps(kz, hRe));
+
+            // Derivatives of displacements, k * unit(k) * h
+            const __m512 kxux = _mm512_mul_ps(kx, ux);
+            const __m512 kzuz = _mm512_mul_ps(kz, uz);
+            StorePair(outputs->dxDisplacementX, outputs->dzDisplacementZ, i,
+                      _mm512_mul_ps(kxux, hRe), _mm512_mul_ps(kxux, hIm),
+                      _mm512_mul_ps(kzuz, hRe), _mm512_mul_ps(kzuz, hIm));
+
+            if (outputs->dxDisplacementZ != nullptr)
+            {
+                const __m512 kxuz = _mm512_mul_ps(kx, uz);
+                const __m512 kzux = _mm512_mul_ps(kz, ux);
+                StorePair(outputs->dxDisplacementZ, outputs->dzDisplacementX, i,
+                          _mm512_mul_ps(kxuz, hRe), _mm512_mul_ps(kxuz, hIm),
+                          _mm512_mul_ps(kzux, hRe), _mm512_mul_ps(kzux, hIm));
+            }
+        }
+
+        return i;
+    }
+
+    size_t ConvertToHalfAVX512(const float* src, uint16_t* dst, size_t count)
+    {
+        size_t i = 0;
+        for (; i + kWidth <= count; i += kWidth)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                _mm512_cvtps_ph(_mm512_loadu_ps(src + i),
+                                _MM_FROUND_TO_NEAREST_INT));
+        }
+
+        return i;
+    }
+
+} // namespace simd
+} // namespace wst
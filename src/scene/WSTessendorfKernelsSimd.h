@@ -0,0 +1,90 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_KERNELS_SIMD_H_
+#define WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_KERNELS_SIMD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * @brief Kernels of the wider instruction sets, of raw pointers and sizes
+ *  only. Their translation units are compiled with the instruction sets
+ *  enabled and include nothing but this and <immintrin.h>: an inline
+ *  function of the STL or glm emitted there could be the one the linker
+ *  keeps, executed also on CPUs without them. Wrapped by the kernels of
+ *  WSTessendorfKernels.h
+ */
+namespace wst {
+namespace simd {
+
+    /** @brief Of "SpectrumSoA", arrays of the elements */
+    struct SpectrumArrays
+    {
+        const float* heightAmpRe;
+        const float* heightAmpIm;
+        const float* heightAmpConjRe;
+        const float* heightAmpConjIm;
+        const float* dispersion;
+        const float* waveVecX;
+        const float* waveVecZ;
+        const float* unitX;
+        const float* unitZ;
+    };
+
+    /** @brief Of "PhasorSoA", arrays of the elements */
+    struct PhasorArrays
+    {
+        float* re;
+        float* im;
+        const float* stepRe;
+        const float* stepIm;
+    };
+
+    /**
+     * @brief Of "SpectrumOutputs", interleaved complex numbers. Of a pair
+     *  of fields, the second one equals the first one if packed
+     */
+    struct FieldArrays
+    {
+        float* height;
+        float* slopeX;              ///< Null without normals
+        float* slopeZ;
+        float* displacementX;
+        float* displacementZ;
+        float* dxDisplacementX;
+        float* dzDisplacementZ;
+        float* dxDisplacementZ;     ///< May be null
+        float* dzDisplacementX;
+    };
+
+    /**
+     * @brief Of "SpectrumKernel", of whole vectors of elements only
+     * @param phasors May be null if 'evaluate'
+     * @param evaluate Whether the phasors are of sin and cos of w*t, else
+     *  the previous ones are advanced by one step
+     * @return First element not computed, of the remainder
+     */
+    uint32_t ComputeSpectrumAVX2(const SpectrumArrays* spectrum,
+                                 const PhasorArrays* phasors,
+                                 bool evaluate,
+                                 const FieldArrays* outputs,
+                                 uint32_t begin, uint32_t end, float t);
+    uint32_t ComputeSpectrumAVX512(const SpectrumArrays* spectrum,
+                                   const PhasorArrays* phasors,
+                                   bool evaluate,
+                                   const FieldArrays* outputs,
+                                   uint32_t begin, uint32_t end, float t);
+
+    /** @return Count of the floats converted, of the remainder */
+    size_t ConvertToHalfAVX2(const float* src, uint16_t* dst, size_t count);
+    size_t ConvertToHalfAVX512(const float* src, uint16_t* dst, size_t count);
+
+} // namespace simd
+} // namespace wst
+
+
+#endif // WATER_SURFACE_RENDERING_SCENE_WS_TESSENDORF_KERNELS_SIMD_H_
@@ -7,43 +7,92 @@
 #include "pch.h"
 #include "scene/WaterSurfaceMesh.h"
 
+#include <cstring>
+
 #include <imgui/imgui.h>
 
 #include <core/Profile.h>
+#include <vulkan/GpuProfile.h>
 
 
-/**
- * @pre size > 0
- * @return Size 'size' aligned to 'alignment'
- */
-static size_t AlignSizeTo(size_t size, size_t alignment)
-{
-    return (size + alignment - 1) & ~(alignment -1);
-}
-
 // =============================================================================
 
 WaterSurfaceMesh::WaterSurfaceMesh(
     const vkp::Device& device,
-    const vkp::DescriptorPool& descriptorPool
+    const vkp::DescriptorPool& descriptorPool,
+    uint32_t viewCount
 )
     : m_kDevice(device),
-      m_kDescriptorPool(descriptorPool)
+      m_kDescriptorPool(descriptorPool),
+      m_ViewCount(viewCount)
 {
     VKP_REGISTER_FUNCTION();
 
-    CreateDescriptorSetLayout();
-    SetupPipeline();
+#ifndef DOUBLE_BUFFERED
+    const auto& kPhysicalDevice = m_kDevice.GetPhysicalDevice();
+    m_HasMapBuffer = kPhysicalDevice.GetDeviceLocalHostVisibleHeapSize() >=
+                     s_kMinMapBufferHeapSize;
+
+    // Nothing to upload when the maps are read from the map buffer
+    const auto& kIndices = kPhysicalDevice.GetQueueFamilyIndices();
+    m_HasTransferQueue = !m_HasMapBuffer &&
+                         kIndices[vkp::QFamily::Transfer].has_value() &&
+                         kIndices.Transfer() != kIndices.Graphics();
+#endif
+    // Patches of a multiview pass, only if the device draws them so
+    m_HasTessellation = m_kDevice.GetPhysicalDevice()
+        .GetEnabledFeatures().tessellationShader == VK_TRUE &&
+        (m_ViewCount == 1 || m_kDevice.SupportsMultiviewTessellation());
+    if (m_HasTessellation)
+        m_GridMode = GridMode::Tessellated;
+    m_HasPrimitiveShadingRate = m_kDevice.SupportsPrimitiveShadingRate();
+
+    if (m_HasMapBuffer)
+    {
+        VKP_LOG_INFO("Water surface maps read from device local, host visible"
+                     " memory");
+    }
+    else
+    {
+        VKP_LOG_INFO("Water surface maps uploaded on the {} queue",
+                     m_HasTransferQueue ? "transfer" : "graphics");
+    }
 
-    CreateStagingBuffer();
+    CreateDescriptorSetLayout();
+    m_PushConstantRange = VkPushConstantRange{
+        .stageFlags = GetVertexStageFlags(),
+        .offset = 0,
+        .size = sizeof(VertexPushConstants)
+    };
+    // Of the pipelines' shaders and vertex inputs of their modes
+    m_CDLODGrid.reset( new WSGridCDLOD(m_kDevice) );
+    m_TessellatedGrid.reset( new WSGridTessellated(m_kDevice) );
+    m_TiledGrid.reset( new WSGridTiled(m_kDevice) );
+    m_ProjectedGrid.reset( new WSGridProjected(m_kDevice) );
+    m_Bodies.reset( new WSBodies(m_kDevice) );
+    m_BodiesGrid.reset( new WSGridBodies(m_kDevice, *m_Bodies) );
+    SetupGrids();
+    SetupPipelines();
 
     CreateTessendorfModel();
+    CreateComputeModel();
+    m_Cascades.reset( new WSCascades(m_kDevice) );
+    m_Readback.reset( new WSMapReadback(m_kDevice) );
+    m_Terrain.reset( new TerrainMap(m_kDevice, m_kDescriptorPool) );
     CreateMesh();
 }
 
 WaterSurfaceMesh::~WaterSurfaceMesh()
 {
     VKP_REGISTER_FUNCTION();
+
+    // Worker reads the layout and the current pipelines
+    if (m_RebuiltPipelines.valid())
+        m_RebuiltPipelines.wait();
+    if (m_FullResolutionModel.valid())
+        m_FullResolutionModel.wait();
+
+    DestroyTransferSemaphores();
 }
 
 void WaterSurfaceMesh::CreateRenderData(
@@ -67,32 +116,167 @@ void WaterSurfaceMesh::CreateRenderData(
         m_UniformBuffers.clear();
         CreateUniformBuffers(kImageCount);
 
+        for (WSGrid* grid : GetGrids())
+            grid->SetFrameCount(kImageCount);
+
         m_DescriptorSets.clear();
         CreateDescriptorSets(kImageCount);
 
+        CreateMapStagingBuffer(kImageCount);
+        m_Cascades->SetFrameCount(kImageCount);
+        m_Bodies->SetFrameCount(kImageCount);
+        m_Readback->SetFrameCount(kImageCount);
+        m_ModelCompute->SetFrameCount(kImageCount);
+
+        if (m_HasTransferQueue)
+        {
+            CreateTransferResources(kImageCount);
+            // Maps per frame in flight, if already created
+            if (!m_FrameMaps.empty())
+                m_MapFormatNeedsUpdate = true;
+        }
+
         // WARN: Also must update the descriptors before render
     }
 }
 
+void WaterSurfaceMesh::PrepareModel()
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_PROFILE_SCOPE();
+
+    if (m_Backend == Backend::Compute)
+    {
+        m_ModelTess->PrepareSpectrum();
+        return;
+    }
+
+    // Baked layers are of the size of the model, baked once at the full one
+    const uint32_t kTileSize = m_ModelTess->GetTileSize();
+    const bool kIsProgressive = m_ProgressiveStart && !UsesBakedLoop() &&
+                                kTileSize > s_kProgressiveTileSize;
+    if (kIsProgressive)
+        m_ModelTess->SetTileSize(s_kProgressiveTileSize);
+
+    m_ModelTess->Prepare();
+
+    if (!kIsProgressive)
+        return;
+
+    // Planned after the low resolution, FFTW's planner is locked meanwhile
+    auto model = std::make_unique<WSTessendorf>(*m_ModelTess, kTileSize);
+    m_ProgressiveTargetSize = kTileSize;
+    m_FullResolutionModel = std::async(
+        std::launch::async,
+        [](std::unique_ptr<WSTessendorf> model) {
+            // Of the threads of its plans, as of the simulation's
+            vkp::ThreadPlacement::PlaceSimulationThread();
+            model->Prepare();
+            return model;
+        },
+        std::move(model)
+    );
+
+    VKP_LOG_INFO("Water surface progressive start: {} until {} is prepared",
+                 s_kProgressiveTileSize, kTileSize);
+}
+
+void WaterSurfaceMesh::UpdateProgressiveStart()
+{
+    const bool kIsReady = m_FullResolutionModel.wait_for(
+        std::chrono::seconds(0)) == std::future_status::ready;
+    if (!kIsReady)
+        return;
+
+    std::unique_ptr<WSTessendorf> model = m_FullResolutionModel.get();
+
+    // Of another resolution set meanwhile, e.g., by the user, it is kept
+    if (m_ModelTess->GetTileSize() != s_kProgressiveTileSize)
+    {
+        VKP_LOG_INFO("Water surface progressive start: {} not switched to",
+                     m_ProgressiveTargetSize);
+        return;
+    }
+
+    // Model is modified below
+    DrainSimulation();
+    m_ModelTess->AdoptTileSize(*model);
+
+    // Only of the properties changed meanwhile, then the maps of the size
+    SetSimulationTileSize(m_ProgressiveTargetSize);
+
+    VKP_LOG_INFO("Water surface progressive start: switched to {}",
+                 m_ProgressiveTargetSize);
+}
+
 void WaterSurfaceMesh::Prepare(VkCommandBuffer cmdBuffer)
 {
     VKP_PROFILE_SCOPE();
 
-    CreateFrameMaps(cmdBuffer);
-    const uint32_t kIndex = s_kWSResolutions.GetIndex(m_ModelTess->GetTileSize());
-    m_CurFrameMap = &m_FrameMaps[kIndex];
-    SetDescriptorSetsDirty();
+    SelectFrameMaps(cmdBuffer);
 
     PrepareModelTess(cmdBuffer);
     PrepareMesh(cmdBuffer);
 }
 
+bool WaterSurfaceMesh::SetTileSize(uint32_t size)
+{
+    const bool kSizeIsPowerOfTwo = ( size & (size-1) ) == 0;
+    if (!kSizeIsPowerOfTwo || size < s_kMinTileSize || size > s_kMaxTileSize)
+    {
+        VKP_LOG_WARN("Invalid water surface tile size: {}", size);
+        return false;
+    }
+
+    const float kTileLength = m_TileSize * m_VertexDistance;
+    m_TileSize = size;
+    m_VertexDistance = kTileLength / static_cast<float>(size);
+
+    m_ModelTess->SetTileSize(size);
+    SetupGrids();
+    return true;
+}
+
 void WaterSurfaceMesh::PrepareMesh(VkCommandBuffer cmdBuffer)
 {
+    if (m_GridMode != GridMode::Vertices)
+        return;
+
     GenerateMeshVerticesIndices();
     UpdateMeshBuffers(cmdBuffer);
 }
 
+void WaterSurfaceMesh::SetGridMode(GridMode mode)
+{
+    if (mode == m_GridMode)
+        return;
+    if (!SupportsGridMode(mode))
+    {
+        VKP_LOG_WARN("Water surface grid mode: {}, is not supported",
+                     s_kGridModes.strings[s_kGridModes.GetIndex(mode)]);
+        return;
+    }
+
+    VKP_LOG_INFO("Water surface grid mode: {}",
+                 s_kGridModes.strings[s_kGridModes.GetIndex(mode)]);
+    m_GridMode = mode;
+
+    if (m_GridMode == GridMode::Vertices)
+    {
+        // Uploaded by the next "PrepareRender()"
+        GenerateMeshVerticesIndices();
+        return;
+    }
+
+    // Previous ones may still be read by the frames in flight
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    m_Mesh.reset( new GridMesh() );
+    m_StagingBuffer.reset();
+    m_MeshVerticesCapacity = 0;
+    m_MeshIndicesCapacity = 0;
+}
+
 void WaterSurfaceMesh::GenerateMeshVerticesIndices()
 {
     VKP_REGISTER_FUNCTION();
@@ -102,20 +286,22 @@ void WaterSurfaceMesh::GenerateMeshVerticesIndices()
                                                       m_VertexDistance);
     m_Mesh->SetVertices(std::move(vertices));
 
-    std::vector<uint32_t> indices = CreateGridIndices(m_TileSize);
+    std::vector<uint16_t> indices = CreateGridIndices(m_TileSize);
     m_Mesh->SetIndices(std::move(indices));
+    m_Mesh->SetChunks(CreateGridChunks(m_TileSize));
 }
 
 void WaterSurfaceMesh::UpdateMeshBuffers(VkCommandBuffer cmdBuffer)
 {
+    ReserveMeshBuffers();
+
     bool updated = m_Mesh->UpdateDeviceBuffers(*m_StagingBuffer, cmdBuffer);
     if (!updated)
         return;
 
     m_StagingBuffer->FlushMappedRange(
         m_kDevice.GetNonCoherentAtomSizeAlignment(
-            AlignSizeTo(m_Mesh->GetVerticesSize() + m_Mesh->GetIndicesSize(),
-                        vkp::Texture2D::FormatToBytes(s_kMapFormat) )
+            m_Mesh->GetVerticesSize() + m_Mesh->GetIndicesSize()
         )
     );
 }
@@ -124,82 +310,1027 @@ void WaterSurfaceMesh::PrepareModelTess(VkCommandBuffer cmdBuffer)
 {
     VKP_REGISTER_FUNCTION();
 
+#ifdef DOUBLE_BUFFERED
+    m_FrameMapIndex = 0;
+    SetDescriptorSetsDirty();
+#endif
+
+    if (m_Backend == Backend::Compute)
+    {
+        m_ModelTess->PrepareSpectrum();
+        m_ModelCompute->Prepare(cmdBuffer, *m_ModelTess);
+        m_ComputeNeedsPrepare = false;
+        // Copies of the previous waves are not published
+        m_Readback->Reset();
+        // Of the spectrum, until the heights of its waves are read back
+        m_WavesMinHeight = m_ModelCompute->GetMinHeight();
+        m_WavesMaxHeight = m_ModelCompute->GetMaxHeight();
+
+        // Maps are initialized by the first "PrepareRender()"
+        m_FrameMapNeedsUpdate = true;
+        return;
+    }
+
+    DrainSimulation();
     m_ModelTess->Prepare();
+    m_SimulationTime = m_TimeCtr;
+    m_Loop.needsBake = m_LoopFrameCount > 0;
 
-    // Do one pass to initialize the maps
+    // Do one pass to initialize the maps, nothing is in flight yet
 
-    m_VertexUBO.WSHeightAmp = m_ModelTess->ComputeWaves(m_TimeCtr);
-    CopyModelTessDataToStagingBuffer();
+    UpdateWaves(0);
+    m_PushConstants.WSHeightAmp = 1.0f;
 
-#ifdef DOUBLE_BUFFERED
-    m_FrameMapIndex = 0;
+    // Bound by the first "PrepareRender()"
+    if (UsesMapBuffer())
+        return;
+
+    auto& frame = m_CurFrameMap->data[0];
+    m_WavesMinHeight = m_Waves->minHeight;
+    m_WavesMaxHeight = m_Waves->maxHeight;
+
+    UpdateFrameMaps(cmdBuffer, frame, m_SimulationSlices.front());
+    frame.wavesId = m_WavesId;
+}
+
+void WaterSurfaceMesh::SetBackend(Backend backend)
+{
+    if (backend == m_Backend)
+        return;
+
+    VKP_LOG_INFO("Water surface backend: {}",
+                 s_kBackends.strings[s_kBackends.GetIndex(backend)]);
+    m_Backend = backend;
+    DrainSimulation();
+    m_Readback->Reset();
+
+    // Normal maps are written by the compute backend, its maps have no
+    //  mipmaps, nor the second maps of a fixed simulation rate, nor does it
+    //  sample the baked period
+    if (m_NormalsFromDisplacement || m_MapMipmaps || m_SimulationRate > 0.0f ||
+        m_LoopFrameCount > 0)
+        m_MapFormatNeedsUpdate = true;
+
+    // Compute backend writes the first maps, read by all the frames, the
+    //  first upload to each map after it is in order on the graphics queue
+    for (auto& pair : m_FrameMaps)
+    {
+        for (auto& frame : pair.data)
+            frame.wavesId = 0;
+        for (auto& frame : pair.blendData)
+            frame.wavesId = 0;
+    }
     SetDescriptorSetsDirty();
-#endif
 
-    UpdateFrameMaps(
-        cmdBuffer,
-        m_CurFrameMap->data[0]
-    );
+    if (m_Backend == Backend::FFTW)
+    {
+        // FFTW plans are not kept for the compute backend
+        m_ModelTess->Prepare();
+    }
+    else
+    {
+        m_ComputeNeedsPrepare = true;
+    }
+
+    m_FrameMapNeedsUpdate = true;
+}
+
+void WaterSurfaceMesh::SetNormalsFromDisplacement(bool enable)
+{
+    if (enable == m_NormalsFromDisplacement)
+        return;
+
+    VKP_LOG_INFO("Water surface normals from displacement: {}", enable);
+    m_NormalsFromDisplacement = enable;
+
+    // Model is modified
+    DrainSimulation();
+    m_ModelTess->SetComputeNormals(!enable);
+    if (m_Backend == Backend::FFTW)
+        m_ModelTess->Prepare();
+
+    // Maps are recreated with or without the normal maps
+    m_MapFormatNeedsUpdate = true;
+}
+
+void WaterSurfaceMesh::SetComputeJacobian(bool enable)
+{
+    if (enable == m_ModelTess->IsComputingJacobian())
+        return;
+
+    VKP_LOG_INFO("Water surface Jacobian: {}", enable);
+
+    // Model is modified
+    DrainSimulation();
+    m_ModelTess->SetComputeJacobian(enable);
+    if (m_Backend == Backend::FFTW)
+        m_ModelTess->Prepare();
+
+    m_Loop.needsBake = m_LoopFrameCount > 0;
+    m_FrameMapNeedsUpdate = true;
+}
+
+void WaterSurfaceMesh::SetMapFormat(VkFormat format)
+{
+    if (format == m_MapFormat)
+        return;
+
+    VKP_LOG_INFO("Water surface map format: {}",
+                 s_kMapFormats.strings[s_kMapFormats.GetIndex(format)]);
+    m_MapFormat = format;
+    m_MapFormatNeedsUpdate = true;
+}
+
+void WaterSurfaceMesh::SetMapMipmaps(bool enable)
+{
+    if (enable == m_MapMipmaps)
+        return;
+
+    VKP_LOG_INFO("Water surface map mipmaps: {}", enable);
+    m_MapMipmaps = enable;
+    m_MapFormatNeedsUpdate = true;
+}
+
+void WaterSurfaceMesh::SetSimulationRate(float rate)
+{
+    rate = glm::max(rate, 0.0f);
+    if (rate == m_SimulationRate)
+        return;
+
+    VKP_LOG_INFO("Water surface simulation rate: {} Hz", rate);
+
+    // Second maps are created, or destroyed, only if it is toggled
+    if ((rate > 0.0f) != (m_SimulationRate > 0.0f))
+        m_MapFormatNeedsUpdate = true;
+
+    // Previous waves are apart by the previous step
+    DrainSimulation();
+    m_SimulationRate = rate;
+    m_SimulationTime = m_TimeCtr;
+    m_FrameMapNeedsUpdate = true;
+}
+
+void WaterSurfaceMesh::SetThreadPlacement(
+    const vkp::ThreadPlacement::Settings& settings)
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Worker is placed again before its next computation
+    DrainSimulation();
+    vkp::ThreadPlacement::SetSettings(settings);
+    vkp::ThreadPlacement::PlaceMainThread();
+
+    // Plans are of the thread count, and the inputs placed by the threads
+    if (m_Backend == Backend::FFTW)
+        m_ModelTess->Prepare();
+    if (m_Cascades->GetPreparedCount() > 0)
+        PrepareCascades();
+    PrepareBodies();
+}
+
+void WaterSurfaceMesh::SetLoopFrameCount(uint32_t count)
+{
+    if (count == m_LoopFrameCount)
+        return;
+
+    VKP_LOG_INFO("Water surface baked loop: {} frames", count);
+
+    // Pipelines of the map buffer, or the second maps of a fixed rate, are
+    //  selected again, their maps are of the simulated waves
+    if ((count > 0) != (m_LoopFrameCount > 0))
+        m_MapFormatNeedsUpdate = true;
+
+    DrainSimulation();
+    m_LoopFrameCount = count;
+    m_Loop.needsBake = count > 0;
+
+    if (count == 0 && m_Loop.displacementMaps != nullptr)
+    {
+        // Previous ones may still be read by the frames in flight
+        m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+        m_Loop = BakedLoop{};
+    }
+    m_FrameMapNeedsUpdate = true;
+    SetDescriptorSetsDirty();
+}
+
+void WaterSurfaceMesh::SetWaveQueries(bool enable)
+{
+    if (enable == m_WaveQueries)
+        return;
+
+    VKP_LOG_INFO("Water surface wave queries: {}", enable);
+    m_WaveQueries = enable;
+
+    // Snapshots are taken by the simulation's worker
+    DrainSimulation();
+    m_ModelTess->SetQueriesEnabled(enable);
+    m_Readback->Reset();
+}
+
+void WaterSurfaceMesh::SetFrameBudget(float budget)
+{
+    if (budget <= 0.0f)
+    {
+        if (m_ResolutionScaling)
+            VKP_LOG_INFO("Water surface frame budget: disabled");
+        m_ResolutionScaling = false;
+        return;
+    }
+
+    // Of the resolutions set until then, the upper bounds of the steps
+    if (!m_ResolutionScaling)
+    {
+        m_MaxSimulationTileSize = m_FullResolutionModel.valid()
+            ? m_ProgressiveTargetSize
+            : m_ModelTess->GetTileSize();
+    }
+
+    WSResolutionScaler::Settings settings = m_ResolutionScaler.GetSettings();
+    settings.budget = budget;
+    m_ResolutionScaler.SetSettings(settings);
+    m_ResolutionScaling = true;
+
+    VKP_LOG_INFO("Water surface frame budget: {} ms, simulation up to {}",
+                 budget, m_MaxSimulationTileSize);
+}
+
+void WaterSurfaceMesh::AddGpuFrameTime(float ms)
+{
+    if (m_ResolutionScaling)
+        m_ResolutionScaler.AddGpuFrameTime(ms);
+}
+
+void WaterSurfaceMesh::UpdateResolutionScaling()
+{
+    // Baked layers are of the size of the model, baked again if changed,
+    //  nor is it stepped before the switch of a progressive start
+    const bool kScalesSimulation = !UsesBakedLoop() &&
+                                   !m_FullResolutionModel.valid();
+    const uint32_t kSimulationSize = m_ModelTess->GetTileSize();
+
+    const WSResolutionScaler::Step kStep = m_ResolutionScaler.Update({
+        .simulationDown = kScalesSimulation &&
+                          kSimulationSize > s_kMinTileSize,
+        .simulationUp   = kScalesSimulation &&
+                          kSimulationSize < m_MaxSimulationTileSize,
+        .meshDown       = m_MeshDetailLevel < s_kMaxMeshDetailLevel &&
+                          CanCoarsenMesh(),
+        .meshUp         = m_MeshDetailLevel > 0
+    });
+
+    switch (kStep)
+    {
+        case WSResolutionScaler::Step::SimulationDown:
+            SetSimulationTileSize(kSimulationSize / 2);
+            break;
+        case WSResolutionScaler::Step::SimulationUp:
+            SetSimulationTileSize(kSimulationSize * 2);
+            break;
+        case WSResolutionScaler::Step::MeshDown:
+            SetMeshDetailLevel(m_MeshDetailLevel + 1);
+            break;
+        case WSResolutionScaler::Step::MeshUp:
+            SetMeshDetailLevel(m_MeshDetailLevel - 1);
+            break;
+        default:
+            return;
+    }
+
+    VKP_LOG_INFO("Water surface resolution: simulation {}, mesh detail {}, "
+                 "for a budget of {} ms", m_ModelTess->GetTileSize(),
+                 GetMeshDetail(), m_ResolutionScaler.GetSettings().budget);
+}
+
+void WaterSurfaceMesh::SetSimulationTileSize(uint32_t size)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_ASSERT(size >= s_kMinTileSize && size <= s_kMaxTileSize);
+
+    // Model is modified below
+    DrainSimulation();
+
+    // Spectrum and plans of a previous size are of the model's tile cache
+    m_ModelTess->SetTileSize(size);
+    if (m_Backend == Backend::Compute)
+    {
+        m_ModelTess->PrepareSpectrum();
+        m_ComputeNeedsPrepare = true;
+    }
+    else
+    {
+        m_ModelTess->Prepare();
+    }
+
+    // Allocated by the next "PrepareRender()", if not yet
+    m_CurFrameMap = nullptr;
+    m_Loop.needsBake = m_LoopFrameCount > 0;
+    m_FrameMapNeedsUpdate = true;
+
+    // Of the primary's wave numbers, the bodies are of its spectrum only
+    if (m_Cascades->GetPreparedCount() > 0)
+        PrepareCascades();
+}
+
+void WaterSurfaceMesh::SetMeshDetailLevel(uint32_t level)
+{
+    VKP_ASSERT(level <= s_kMaxMeshDetailLevel);
+
+    // Edges of the tessellated patches by the next "PrepareRender()"
+    m_MeshDetailLevel = level;
+    SetupGrids();
+}
+
+bool WaterSurfaceMesh::CanCoarsenMesh() const
+{
+    const WSGrid* kGrid = GetGrid(m_GridMode);
+    return kGrid != nullptr && kGrid->CanCoarsen();
+}
+
+void WaterSurfaceMesh::UpdateMapFormat(VkCommandBuffer cmdBuffer)
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Those of the other resolutions are created again when selected
+    DestroyFrameMaps();
+    SelectFrameMaps(cmdBuffer);
+
+    m_ModelCompute->SetMapFormat(m_MapFormat);
+
+    // Staging data of the previous format
+    if (m_Backend == Backend::FFTW)
+    {
+        DrainSimulation();
+        UpdateWaves(0);
+    }
+
+    // Layers of the previous format, or without the normal maps
+    m_Loop.needsBake = m_LoopFrameCount > 0;
+
+    m_FrameMapNeedsUpdate = true;
+    m_MapFormatNeedsUpdate = false;
 }
 
 void WaterSurfaceMesh::Update(float dt)
 {
+    if (m_FullResolutionModel.valid())
+        UpdateProgressiveStart();
+    if (m_ResolutionScaling)
+        UpdateResolutionScaling();
+
     if (m_PlayAnimation || m_FrameMapNeedsUpdate)
     {
-        m_TimeCtr += dt * m_AnimSpeed;
+        const float kFrameStep = s_kFixedTimeStep * m_AnimSpeed;
+        // Waves of a fixed rate are apart by its step, of each frame if fixed
+        const float kTimeStep = UsesFixedRate() ? GetSimulationStep() :
+                                m_FixedTimeStep ? kFrameStep : 0.0f;
+        if (kTimeStep != m_ModelTess->GetTimeStep())
+        {
+            DrainSimulation();
+            m_ModelTess->SetTimeStep(kTimeStep);
+        }
+
+        m_TimeCtr += m_FixedTimeStep ? kFrameStep : dt * m_AnimSpeed;
 
-        m_VertexUBO.WSHeightAmp = m_ModelTess->ComputeWaves(m_TimeCtr);
-        CopyModelTessDataToStagingBuffer();
+        // Heights are not normalized by either of the backends
+        m_PushConstants.WSHeightAmp = 1.0f;
+
+        if (m_Backend == Backend::Compute)
+        {
+            // Computed in "PrepareRender()"
+            return;
+        }
+
+        // Sampled from the layers of the baked period, nothing is simulated
+        if (UsesBakedLoop())
+            return;
+
+        // Updates of changed properties are not delayed
+        const bool kIsDelayed = m_PlayAnimation && !m_FrameMapNeedsUpdate;
+
+        if (UsesFixedRate() && kIsDelayed)
+        {
+            // Frames until the next step interpolate the acquired waves
+            if (m_TimeCtr < m_SimulationTime)
+                return;
+
+            // Behind by more than a step, e.g., after a hitch, skips ahead
+            m_SimulationTime = glm::max(m_SimulationTime + kTimeStep,
+                                        m_TimeCtr);
+        }
+        else
+        {
+            m_SimulationTime = m_TimeCtr;
+        }
+
+        UpdateWaves(kIsDelayed ? m_Simulation->GetLatency() : 0);
     }
 }
 
-void WaterSurfaceMesh::PrepareRender(
-    const uint32_t frameIndex,
-    VkCommandBuffer cmdBuffer,
-    const glm::mat4& viewMat,
-    const glm::mat4& projMat,
-    const glm::vec3& camPos,
-    const SkyModel::Params& skyParams
-)
-{
-    m_VertexUBO.model = glm::mat4(1.0f);
-    m_VertexUBO.view = viewMat;
-    m_VertexUBO.proj = projMat;
+void WaterSurfaceMesh::UpdateWaves(uint32_t latency)
+{
+    // Not uploaded, e.g., no image was acquired, superseded anyway
+    ReleaseWaves();
+
+    // Nothing left in flight to wait for
+    if (ReserveMapStagingBuffer())
+        latency = 0;
+
+    const uint32_t kSlice = FindFreeMapStagingSlice();
+    m_Simulation->Submit(m_SimulationTime, GetMapStagingOutputs(kSlice));
+    m_SimulationSlices.push_back(kSlice);
+
+    // Null while still in flight, then the maps keep the previous waves
+    m_Waves = m_Simulation->Acquire(latency);
+    if (m_Waves == nullptr)
+        return;
+
+    // Older ones were skipped
+    while (m_SimulationSlices.size() > latency + 1)
+        m_SimulationSlices.pop_front();
+
+    ++m_WavesId;
+    m_WavesTime = m_Waves->time;
+
+    if (m_ResolutionScaling)
+        m_ResolutionScaler.AddSimulationTime(m_Waves->computeTime);
+
+    // Written by the worker, of the current map format
+    const VkDeviceSize kMapSize = vkp::Texture2D::FormatToBytes(m_MapFormat) *
+                                  m_ModelTess->GetDisplacementCount();
+    m_MapStagingBuffer->FlushMappedRange(
+        m_kDevice.GetNonCoherentAtomSizeAlignment(2 * kMapSize),
+        m_MapStagingSliceSize * m_SimulationSlices.front()
+    );
+}
+
+void WaterSurfaceMesh::ReleaseWaves()
+{
+    if (m_Waves == nullptr)
+        return;
+
+    // Interpolated from until the next waves, kept in their slice
+    if (UsesFixedRate())
+    {
+        m_PrevWaves = PrevWaves{
+            .id        = m_WavesId,
+            .slice     = m_SimulationSlices.front(),
+            .time      = m_Waves->time,
+            .minHeight = m_Waves->minHeight,
+            .maxHeight = m_Waves->maxHeight
+        };
+    }
+
+    m_Simulation->Release();
+    m_SimulationSlices.pop_front();
+    m_Waves = nullptr;
+}
+
+void WaterSurfaceMesh::DrainSimulation()
+{
+    ReleaseWaves();
+    m_Simulation->Drain();
+    m_SimulationSlices.clear();
+
+    // Of the model before it is modified
+    m_PrevWaves = PrevWaves{};
+}
+
+float WaterSurfaceMesh::GetWavesBlend() const
+{
+    if (!UsesFixedRate() || m_PrevWaves.id == 0 || m_Waves == nullptr)
+        return 1.0f;
+
+    const float kSpan = m_WavesTime - m_PrevWaves.time;
+    if (kSpan <= 0.0f)
+        return 1.0f;
+
+    // Shown behind by the waves submitted since the acquired ones, i.e.,
+    //  the latency, and by a step, so that it is between the two
+    const float kTime = m_TimeCtr - (m_SimulationTime - m_WavesTime);
+    return glm::clamp((kTime - m_PrevWaves.time) / kSpan, 0.0f, 1.0f);
+}
+
+uint32_t WaterSurfaceMesh::FindFreeMapStagingSlice() const
+{
+    for (uint32_t i = 0; i < m_MapStagingSlices.size(); ++i)
+    {
+        // Read again by the next frame, if no newer waves are acquired
+        if (i == m_MapBufferSlice)
+            continue;
+        // Interpolated from, until superseded
+        if (m_PrevWaves.id != 0 && i == m_PrevWaves.slice)
+            continue;
+
+        const bool kIsComputed =
+            std::find(m_SimulationSlices.begin(), m_SimulationSlices.end(), i)
+            != m_SimulationSlices.end();
+        if (kIsComputed)
+            continue;
+
+        // Frame is done once its image is acquired again, after its fence
+        const auto& kReadFrames = m_MapStagingSlices[i].readFrames;
+        bool isRead = false;
+        for (uint32_t image = 0; image < kReadFrames.size(); ++image)
+        {
+            isRead |= kReadFrames[image] != 0 &&
+                      kReadFrames[image] == m_ImageFrameCounts[image];
+        }
+
+        if (!isRead)
+            return i;
+    }
+
+    VKP_ASSERT_MSG(false, "No free map staging slice");
+    return 0;
+}
+
+WSTessendorf::Outputs WaterSurfaceMesh::GetMapStagingOutputs(
+    const uint32_t kSlice
+) const
+{
+    VKP_ASSERT(m_MapStagingBuffer != nullptr);
+    VKP_ASSERT(kSlice < m_MapStagingSlices.size());
+
+    // MapStagingBuffer layout, of slices:
+    //  ------------------------------------------------------
+    // | Displacements | Normals | Displacements | Normals | ...
+    //  ------------------------------------------------------
+    // mapped
+
+    uint8_t* stagingData =
+        static_cast<uint8_t*>(m_MapStagingBuffer->GetMappedAddress());
+    VKP_ASSERT(stagingData != nullptr);
+
+    uint8_t* sliceData = stagingData + m_MapStagingSliceSize * kSlice;
+
+    const VkDeviceSize kMapSize = vkp::Texture2D::FormatToBytes(m_MapFormat) *
+                                  m_ModelTess->GetDisplacementCount();
+
+    return WSTessendorf::Outputs{
+        .displacements = sliceData,
+        .normals = UsesNormalMap() ? sliceData + kMapSize : nullptr,
+        .isHalf = m_MapFormat == s_kMapFormatHalf
+    };
+}
+
+void WaterSurfaceMesh::PrepareRender(
+    const uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer,
+    const vkp::Camera& camera,
+    const SkyModel& sky
+)
+{
+    // Of the uploads and the computations of the maps
+    VKP_PROFILE_GPU_SCOPE(cmdBuffer, "Water surface maps");
+
+    const glm::mat4& viewMat = camera.GetViewMat();
+    const glm::mat4& projMat = camera.GetProjMat();
+    const glm::vec3& camPos = camera.GetPosition();
+
+    // Vulkan uses inverted Y coord in comparison to OpenGL (set by glm lib)
+    // -> flip the sign on the scaling factor of the Y axis
+    glm::mat4 proj = projMat;
+    proj[1][1] *= -1;
+
+    // Once per frame instead of per vertex, the model matrix is identity
+    m_PushConstants.viewProj = proj * viewMat;
+    m_PushConstants.projScaleY = glm::abs(proj[1][1]);
+    // Of each view of a multiview pass, of the same projection
+    for (uint32_t i = 0; i < camera.GetViewCount(); ++i)
+        m_VertexUBO.viewProjs[i] = proj * camera.GetViewMat(i);
+    m_PushConstants.WSChoppy = m_ModelTess->GetDisplacementLambda();
+
+
+    m_VertexUBO.mapSize = m_ModelTess->GetTileSize();
+    m_VertexUBO.mapIsHalf = m_MapFormat == s_kMapFormatHalf;
+    // Layers of the bodies always have their normal maps
+    m_VertexUBO.normalsFromDisplacement =
+        !UsesNormalMap() && m_GridMode != GridMode::Bodies;
+    m_VertexUBO.gridSize = m_TileSize;
+    m_VertexUBO.vertexDistance = m_VertexDistance;
+    m_VertexUBO.camPos = camPos;
+    m_VertexUBO.lodRange = m_CDLODGrid->GetFinestRange();
+    m_VertexUBO.patchSize = m_CDLODGrid->GetPatchSize();
+    m_VertexUBO.bodyGridSize = m_BodiesGrid->GetBodyGridSize();
+    m_VertexUBO.tessPatchSize = m_TessellatedGrid->GetPatchSize();
+    m_VertexUBO.invViewProj = glm::inverse(m_PushConstants.viewProj);
+    m_VertexUBO.projGridCols = m_ProjectedGrid->GetColumnCount();
+    m_VertexUBO.projGridRows = m_ProjectedGrid->GetRowCount();
+    m_VertexUBO.projMaxDistance = m_ProjectedGrid->GetMaxDistance();
+    m_VertexUBO.cascadeLengths = m_Cascades->GetTileLengths();
+    m_VertexUBO.cascadeCount = m_Cascades->GetPreparedCount();
+    m_VertexUBO.sunDir = sky.GetParams().props.sunDir;
+    m_VertexUBO.tessEdgeLength = m_TessellatedGrid->GetEdgeLength();
+    
+    m_WaterSurfaceUBO.camPos = camPos;
+    if (m_ClampHeight)
+    {
+        m_WaterSurfaceUBO.height =
+            glm::max(m_WaterSurfaceUBO.height,
+                     glm::abs(m_WavesMinHeight) );
+    }
+    m_WaterSurfaceUBO.sky = sky.GetParams();
+
+    if (&sky.GetLut() != m_SkyLut)
+    {
+        m_SkyLut = &sky.GetLut();
+        SetDescriptorSetsDirty();
+    }
+    if (m_Terrain->Prepare(cmdBuffer))
+        SetDescriptorSetsDirty();
+
+    m_MapUploadSemaphore = VK_NULL_HANDLE;
+    // Its previous frame is done, after the image's fence
+    ++m_ImageFrameCounts[frameIndex];
+
+    // Copied from by the frame of the bake, done by now
+    if (m_Loop.stagingBuffer != nullptr &&
+        m_ImageFrameCounts[m_Loop.stagingFrameIndex] > m_Loop.stagingFrameCount)
+        m_Loop.stagingBuffer.reset();
+
+    // Between frames, none of this frame's commands use the replaced ones
+    ReleaseRetiredPipelines();
+    ApplyPipelineRebuild(false);
+
+    if (m_MapFormatNeedsUpdate)
+        UpdateMapFormat(cmdBuffer);
+    if (m_CurFrameMap == nullptr)
+        SelectFrameMaps(cmdBuffer);
+
+    if (UsesBakedLoop())
+    {
+        if (m_Loop.needsBake)
+            BakeLoop(frameIndex, cmdBuffer);
+
+        // Bound by "UpdateDescriptorSet()", of the layer of the frame's time
+        const uint32_t kLayer = glm::min(
+            static_cast<uint32_t>(GetLoopPosition()),
+            m_Loop.displacementMaps->GetLayerCount() - 1
+        );
+        auto& set = m_DescriptorSets[frameIndex];
+        if (set.loopLayer != kLayer)
+        {
+            set.loopLayer = kLayer;
+            set.isDirty = true;
+        }
+    }
+
+    // Each at its own rate, or all once the animation is paused
+    if (m_Cascades->Update(cmdBuffer, frameIndex, m_TimeCtr, m_PlayAnimation,
+                           GetMapPipelineStages()))
+        SetDescriptorSetsDirty();
+
+    // Maps of the bodies are bound by every pipeline, even if not drawn
+    if (m_Bodies->NeedsPrepare())
+        PrepareBodies();
+    if (m_Bodies->Update(cmdBuffer, frameIndex, m_TimeCtr,
+                         m_PlayAnimation && m_GridMode == GridMode::Bodies,
+                         GetMapPipelineStages()))
+        SetDescriptorSetsDirty();
+    
+    UpdateUniformBuffer(frameIndex);
+    if (m_GridMode == GridMode::Vertices)
+        UpdateMeshBuffers(cmdBuffer);
+
+    // Of the waves computed this frame, before the instances are culled
+    if (m_Backend == Backend::Compute)
+    {
+        if (m_ComputeNeedsPrepare)
+        {
+            m_ModelCompute->Prepare(cmdBuffer, *m_ModelTess);
+            m_ComputeNeedsPrepare = false;
+            m_Readback->Reset();
+        }
+        m_WavesMinHeight = m_ModelCompute->GetMinHeight();
+        m_WavesMaxHeight = m_ModelCompute->GetMaxHeight();
+    }
+
+    if (WSGrid* grid = GetGrid(m_GridMode))
+    {
+        grid->Update(frameIndex, {
+            .camera = camera,
+            .bounds = GetDisplacementBounds(),
+            .heightAmp = m_PushConstants.WSHeightAmp,
+            .choppiness = m_PushConstants.WSChoppy
+        });
+    }
+    else
+        UpdateGridVisibility(camera);
+    UpdateDescriptorSet(frameIndex);
+
+#ifndef DOUBLE_BUFFERED
+    const uint32_t kTransferIndex = GetFrameMapIndex(frameIndex);
+#else
+    const uint32_t kTransferIndex = (m_FrameMapIndex + 1) % m_CurFrameMap->data.size();
+#endif
+
+    auto& frame = m_CurFrameMap->data[kTransferIndex];
+    // Only the first maps are read, unless interpolated at a fixed rate
+    m_PushConstants.WSMapBlend = 0.0f;
+
+    if (m_Backend == Backend::Compute)
+    {
+        // No need to update the texture with the same data over again
+        if (m_PlayAnimation || m_FrameMapNeedsUpdate)
+        {
+            m_ModelCompute->RecordComputeWaves(
+                cmdBuffer,
+                frameIndex,
+                m_TimeCtr,
+                m_ModelTess->GetDisplacementLambda(),
+                *frame.displacementMap,
+                *frame.normalMap
+            );
+
+            // Read by the queries once this frame's slot comes around again
+            if (m_WaveQueries)
+            {
+                m_Readback->Update(cmdBuffer, frameIndex,
+                                   *frame.displacementMap, m_TimeCtr,
+                                   GetMapPipelineStages(), *m_ModelTess);
+            }
+        }
+    }
+    else if (UsesBakedLoop())
+    {
+        // Toward the next layer, the second maps
+        m_PushConstants.WSMapBlend = glm::fract(GetLoopPosition());
+        m_WavesMinHeight = m_Loop.minHeight;
+        m_WavesMaxHeight = m_Loop.maxHeight;
+    }
+    else if (UsesMapBuffer())
+    {
+        if (m_Waves != nullptr)
+        {
+            m_MapBufferSlice = m_SimulationSlices.front();
+            m_WavesMinHeight = m_Waves->minHeight;
+            m_WavesMaxHeight = m_Waves->maxHeight;
+        }
+        VKP_ASSERT(m_MapBufferSlice < m_MapStagingSlices.size());
+
+        // Read directly, not written again until this frame is done
+        m_MapStagingSlices[m_MapBufferSlice].readFrames[frameIndex] =
+            m_ImageFrameCounts[frameIndex];
+        m_DescriptorSets[frameIndex].mapSlice = m_MapBufferSlice;
+        m_DescriptorSets[frameIndex].blendSlice = m_MapBufferSlice;
+
+        // Of the previous waves, the second maps, unless the same
+        if (m_PrevWaves.id != 0 && m_PrevWaves.slice != m_MapBufferSlice)
+        {
+            m_MapStagingSlices[m_PrevWaves.slice].readFrames[frameIndex] =
+                m_ImageFrameCounts[frameIndex];
+            m_DescriptorSets[frameIndex].blendSlice = m_PrevWaves.slice;
+            m_PushConstants.WSMapBlend = 1.0f - GetWavesBlend();
+        }
+    }
+    else if (!m_CurFrameMap->blendData.empty())
+    {
+        m_PushConstants.WSMapBlend = UpdateBlendedFrameMaps(
+            frameIndex, cmdBuffer, frame,
+            m_CurFrameMap->blendData[kTransferIndex]);
+    }
+    // Each of the frames' maps is updated once with the same waves
+    else if (m_Waves != nullptr && frame.wavesId != m_WavesId)
+    {
+        // Not written again until this frame is done
+        const uint32_t kSlice = m_SimulationSlices.front();
+        m_MapStagingSlices[kSlice].readFrames[frameIndex] =
+            m_ImageFrameCounts[frameIndex];
+
+        m_WavesMinHeight = m_Waves->minHeight;
+        m_WavesMaxHeight = m_Waves->maxHeight;
+
+        if (UsesTransferQueue() && frame.wavesId != 0)
+            SubmitFrameMapsUpload(frameIndex, cmdBuffer, frame, kSlice);
+        else
+            UpdateFrameMaps(cmdBuffer, frame, kSlice);
+
+        frame.wavesId = m_WavesId;
+    }
+
+    m_FrameMapNeedsUpdate = false;
+}
+
+float WaterSurfaceMesh::UpdateBlendedFrameMaps(
+    const uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer,
+    FrameMapData& frame,
+    FrameMapData& blendFrame
+)
+{
+    // Current waves, if acquired, else the previous ones are the last ones
+    struct Source
+    {
+        uint64_t id;        ///< Zero if none
+        uint32_t slice;
+    };
+    const Source kSources[2] = {
+        { m_Waves != nullptr ? m_WavesId : 0,
+          m_Waves != nullptr ? m_SimulationSlices.front() : 0 },
+        { m_PrevWaves.id, m_PrevWaves.slice }
+    };
+
+    if (kSources[0].id == 0 && kSources[1].id == 0)
+        return 0.0f;
+
+    FrameMapData* maps[2] = { &frame, &blendFrame };
+    auto IsNeeded = [&kSources](const FrameMapData* kMaps) {
+        return kMaps->wavesId != 0 && (kMaps->wavesId == kSources[0].id ||
+                                       kMaps->wavesId == kSources[1].id);
+    };
+
+    // Each of the waves is uploaded once, to the maps of neither of them.
+    //  At each step only the current ones, the previous ones are in the maps
+    //  of the previous step
+    bool hasUploaded = false;
+    for (const Source& kSource : kSources)
+    {
+        if (kSource.id == 0 || maps[0]->wavesId == kSource.id ||
+            maps[1]->wavesId == kSource.id)
+            continue;
+
+        FrameMapData& target = IsNeeded(maps[0]) ? *maps[1] : *maps[0];
+
+        // Not written again until this frame is done
+        m_MapStagingSlices[kSource.slice].readFrames[frameIndex] =
+            m_ImageFrameCounts[frameIndex];
+
+        // One upload per frame on the transfer queue, of its semaphore
+        if (UsesTransferQueue() && target.wavesId != 0 && !hasUploaded)
+        {
+            SubmitFrameMapsUpload(frameIndex, cmdBuffer, target, kSource.slice);
+            hasUploaded = true;
+        }
+        else
+        {
+            UpdateFrameMaps(cmdBuffer, target, kSource.slice);
+        }
+        target.wavesId = kSource.id;
+    }
+
+    // Of the heights of both, the surface is between them
+    m_WavesMinHeight = m_Waves != nullptr ? m_Waves->minHeight
+                                          : m_PrevWaves.minHeight;
+    m_WavesMaxHeight = m_Waves != nullptr ? m_Waves->maxHeight
+                                          : m_PrevWaves.maxHeight;
+    if (m_Waves != nullptr && m_PrevWaves.id != 0)
+    {
+        m_WavesMinHeight = glm::min(m_WavesMinHeight, m_PrevWaves.minHeight);
+        m_WavesMaxHeight = glm::max(m_WavesMaxHeight, m_PrevWaves.maxHeight);
+    }
+
+    // Weight of the second maps, of the waves they hold
+    const float kBlend = GetWavesBlend();
+    if (kSources[0].id == 0)
+        return blendFrame.wavesId == kSources[1].id ? 1.0f : 0.0f;
+    if (kSources[1].id == 0)
+        return blendFrame.wavesId == kSources[0].id ? 1.0f : 0.0f;
+    return blendFrame.wavesId == kSources[0].id ? kBlend : 1.0f - kBlend;
+}
+
+void WaterSurfaceMesh::BakeLoop(
+    const uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer
+)
+{
+    VKP_PROFILE_SCOPE();
+
+    // Model is computed directly, of the step of the layers
+    DrainSimulation();
+
+    // Previous ones may still be read by the frames in flight
+    if (m_Loop.displacementMaps != nullptr)
+        m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    const uint32_t kLayerCount = m_LoopFrameCount;
+    const uint32_t kSize = m_ModelTess->GetTileSize();
+    const VkDeviceSize kMapSize = vkp::Texture2D::FormatToBytes(m_MapFormat) *
+                                  m_ModelTess->GetDisplacementCount();
+    const VkDeviceSize kLayerSize = UsesNormalMap() ? 2 * kMapSize : kMapSize;
+
+    // Coherent, written once
+    m_Loop.stagingBuffer.reset(
+        new vkp::Buffer(m_kDevice, vkp::MemoryTag::Staging)
+    );
+    m_Loop.stagingBuffer->Create(kLayerSize * kLayerCount);
+    auto err = m_Loop.stagingBuffer->Map();
+    VKP_ASSERT_RESULT(err);
+
+    uint8_t* stagingData =
+        static_cast<uint8_t*>(m_Loop.stagingBuffer->GetMappedAddress());
+    VKP_ASSERT(stagingData != nullptr);
 
-    // Vulkan uses inverted Y coord in comparison to OpenGL (set by glm lib)
-    // -> flip the sign on the scaling factor of the Y axis
-    m_VertexUBO.proj[1][1] *= -1;
-    m_VertexUBO.WSChoppy = m_ModelTess->GetDisplacementLambda();
-    
-    m_WaterSurfaceUBO.camPos = camPos;
-    if (m_ClampHeight)
+    WSLoopCache::Header header = WSLoopCache::GetHeader(
+        *m_ModelTess, kLayerCount, m_MapFormat == s_kMapFormatHalf,
+        UsesNormalMap()
+    );
+    WSLoopCache cache;
+    if (!m_LoopCachePath.empty() && cache.Open(m_LoopCachePath, header))
     {
-        m_WaterSurfaceUBO.height =
-            glm::max(m_WaterSurfaceUBO.height,
-                     glm::abs( m_ModelTess->GetMinHeight()) );
+        // Pages of each layer are read in by its copy, in order
+        for (uint32_t i = 0; i < kLayerCount; ++i)
+        {
+            std::memcpy(stagingData + kLayerSize * i, cache.GetFrame(i),
+                        kLayerSize);
+        }
+        m_Loop.minHeight = cache.GetHeader().minHeight;
+        m_Loop.maxHeight = cache.GetHeader().maxHeight;
+        cache.Close();
     }
-    m_WaterSurfaceUBO.sky = skyParams;
-    
-    UpdateUniformBuffer(frameIndex);
-    UpdateMeshBuffers(cmdBuffer);
-    UpdateDescriptorSet(frameIndex);
+    else
+    {
+        // Staging memory may be uncached, the written file is read from
+        std::vector<uint8_t> layers;
+        if (!m_LoopCachePath.empty())
+            layers.resize(kLayerSize * kLayerCount);
+        uint8_t* bakeData = layers.empty() ? stagingData : layers.data();
+
+        // Layers are apart by the same step, the phasors are rotated by it
+        const float kStep = m_ModelTess->GetAnimationPeriod() /
+                            static_cast<float>(kLayerCount);
+        const float kTimeStep = m_ModelTess->GetTimeStep();
+        m_ModelTess->SetTimeStep(kStep);
+
+        m_Loop.minHeight = std::numeric_limits<float>::max();
+        m_Loop.maxHeight = std::numeric_limits<float>::lowest();
+
+        for (uint32_t i = 0; i < kLayerCount; ++i)
+        {
+            uint8_t* layerData = bakeData + kLayerSize * i;
+            m_ModelTess->ComputeWaves(kStep * i, WSTessendorf::Outputs{
+                .displacements = layerData,
+                .normals = UsesNormalMap() ? layerData + kMapSize : nullptr,
+                .isHalf = m_MapFormat == s_kMapFormatHalf
+            });
+
+            m_Loop.minHeight = glm::min(m_Loop.minHeight,
+                                        m_ModelTess->GetMinHeight());
+            m_Loop.maxHeight = glm::max(m_Loop.maxHeight,
+                                        m_ModelTess->GetMaxHeight());
+        }
+        m_ModelTess->SetTimeStep(kTimeStep);
 
-#ifndef DOUBLE_BUFFERED
-    const uint32_t kTransferIndex = 0;
-#else
-    const uint32_t kTransferIndex = (m_FrameMapIndex + 1) % m_CurFrameMap->data.size();
-#endif
+        if (!layers.empty())
+        {
+            std::memcpy(stagingData, layers.data(), layers.size());
+
+            header.minHeight = m_Loop.minHeight;
+            header.maxHeight = m_Loop.maxHeight;
+            if (WSLoopCache::Write(m_LoopCachePath, header, layers.data(),
+                                   kLayerSize))
+            {
+                VKP_LOG_INFO("Water surface loop cached: {}",
+                             m_LoopCachePath.string());
+            }
+        }
+    }
 
-    // No need to update the texture with the same data over again
-    if (m_PlayAnimation || m_FrameMapNeedsUpdate)
+    m_Loop.displacementMaps.reset(
+        new vkp::Texture2DArray(m_kDevice, vkp::MemoryTag::Maps)
+    );
+    m_Loop.displacementMaps->Create(cmdBuffer, kSize, kSize, kLayerCount,
+                                    m_MapFormat);
+    m_Loop.displacementMaps->CopyFromBuffer(cmdBuffer,
+                                            *m_Loop.stagingBuffer,
+                                            0,
+                                            kLayerSize,
+                                            GetMapPipelineStages());
+
+    m_Loop.normalMaps.reset();
+    if (UsesNormalMap())
     {
-        UpdateFrameMaps(
-            cmdBuffer,
-            m_CurFrameMap->data[kTransferIndex]
+        m_Loop.normalMaps.reset(
+            new vkp::Texture2DArray(m_kDevice, vkp::MemoryTag::Maps)
         );
-
-        m_FrameMapNeedsUpdate = false;
+        m_Loop.normalMaps->Create(cmdBuffer, kSize, kSize, kLayerCount,
+                                  m_MapFormat);
+        m_Loop.normalMaps->CopyFromBuffer(cmdBuffer,
+                                          *m_Loop.stagingBuffer,
+                                          kMapSize,
+                                          kLayerSize,
+                                          GetMapPipelineStages());
     }
+
+    m_Loop.stagingFrameIndex = frameIndex;
+    m_Loop.stagingFrameCount = m_ImageFrameCounts[frameIndex];
+    m_Loop.needsBake = false;
+    SetDescriptorSetsDirty();
+
+    VKP_LOG_INFO("Water surface loop baked: {} layers of {}x{}, {:.1f} MiB",
+                 kLayerCount, kSize, kSize,
+                 kLayerSize * kLayerCount / 1048576.0);
+}
+
+float WaterSurfaceMesh::GetLoopPosition() const
+{
+    VKP_ASSERT(m_Loop.displacementMaps != nullptr);
+
+    // Frequencies are multiples of the period's, the waves repeat after it
+    const float kPeriod = m_ModelTess->GetAnimationPeriod();
+    const float kLayerCount =
+        static_cast<float>(m_Loop.displacementMaps->GetLayerCount());
+    return glm::fract(m_TimeCtr / kPeriod) * kLayerCount;
 }
 
 void WaterSurfaceMesh::Render(
@@ -207,20 +1338,35 @@ void WaterSurfaceMesh::Render(
     VkCommandBuffer cmdBuffer
 )
 {
-    vkCmdBindPipeline(
-        cmdBuffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS, 
-        *m_Pipeline
-    );
+    // Nothing in the frustum, the same as of no instances
+    const WSGrid* kGrid = GetGrid(m_GridMode);
+    if (kGrid != nullptr ? !kGrid->IsVisible() : !m_GridIsVisible)
+        return;
+
+    VKP_PROFILE_GPU_SCOPE(cmdBuffer, "Water surface pass");
+    VKP_PROFILE_GPU_STATISTICS(cmdBuffer, "Water surface pass");
 
+    // Of the same layout, the descriptor sets stay bound for both passes
+    const vkp::Pipeline& kPipeline = GetPipeline();
     const uint32_t kFirstSet = 0, kDescriptorSetCount = 1;
-    const uint32_t kDynamicOffsetCount = 0;
-    const uint32_t* kDynamicOffsets = nullptr;
+
+    // Both maps are in the frame's slice of the map buffer
+    const uint32_t kSliceOffset = static_cast<uint32_t>(
+        m_MapStagingSliceSize * m_DescriptorSets[frameIndex].mapSlice
+    );
+    // Of the second maps, in the slice of the previous waves
+    const uint32_t kBlendSliceOffset = static_cast<uint32_t>(
+        m_MapStagingSliceSize * m_DescriptorSets[frameIndex].blendSlice
+    );
+    const uint32_t kDynamicOffsets[4] = {
+        kSliceOffset, kSliceOffset, kBlendSliceOffset, kBlendSliceOffset
+    };
+    const uint32_t kDynamicOffsetCount = m_HasMapBuffer ? 4 : 0;
 
     vkCmdBindDescriptorSets(
         cmdBuffer,
         VK_PIPELINE_BIND_POINT_GRAPHICS,
-        *m_Pipeline,
+        kPipeline,
         kFirstSet,
         kDescriptorSetCount,
         &m_DescriptorSets[frameIndex].set,
@@ -228,7 +1374,27 @@ void WaterSurfaceMesh::Render(
         kDynamicOffsets
     );
 
-    m_Mesh->Render(cmdBuffer);
+    // Kept for both passes as well
+    vkCmdPushConstants(
+        cmdBuffer,
+        kPipeline,
+        m_PushConstantRange.stageFlags,
+        m_PushConstantRange.offset,
+        m_PushConstantRange.size,
+        &m_PushConstants
+    );
+
+    if (UsesDepthPrePass())
+    {
+        vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          GetPipeline(Pass::Depth));
+        RecordDraw(frameIndex, cmdBuffer);
+    }
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      m_ShowOverdraw ? GetPipeline(Pass::Overdraw)
+                                     : kPipeline);
+    RecordDraw(frameIndex, cmdBuffer);
 
 #ifdef DOUBLE_BUFFERED
     if (m_PlayAnimation)
@@ -239,6 +1405,36 @@ void WaterSurfaceMesh::Render(
 #endif
 }
 
+bool WaterSurfaceMesh::IsStatic() const
+{
+    return !m_PlayAnimation && !m_FrameMapNeedsUpdate &&
+           !m_MapFormatNeedsUpdate && m_CurFrameMap != nullptr &&
+           !m_RebuiltPipelines.valid() && m_RetiredPipelines.empty();
+}
+
+void WaterSurfaceMesh::RecordDraw(
+    const uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer
+)
+{
+    if (const WSGrid* kGrid = GetGrid(m_GridMode))
+    {
+        kGrid->RecordDraw(frameIndex, cmdBuffer);
+    }
+    else if (m_GridMode == GridMode::Vertices)
+    {
+        m_Mesh->Render(cmdBuffer, m_VisibleChunks);
+    }
+    else
+    {
+        const uint32_t kInstanceCount = 1;
+        const uint32_t kFirstVertex = 0, kFirstInstance = 0;
+
+        vkCmdDraw(cmdBuffer, GetTotalIndexCount(m_TileSize), kInstanceCount,
+                  kFirstVertex, kFirstInstance);
+    }
+}
+
 // --------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------
 // Update data functions
@@ -260,6 +1456,68 @@ void WaterSurfaceMesh::UpdateUniformBuffer(const uint32_t imageIndex)
     buffer.FlushMappedRange();
 }
 
+void WaterSurfaceMesh::UpdateGridVisibility(const vkp::Camera& camera)
+{
+    VKP_PROFILE_SCOPE();
+
+    const WSGrid::DisplacementBounds kBounds = GetDisplacementBounds();
+    const float kHalfLength = 0.5f * m_TileSize * m_VertexDistance;
+    const float kHalfExtent = kHalfLength + kBounds.margin;
+
+    m_GridIsVisible = WSGrid::IsGridVisible(camera, kBounds, kHalfLength);
+
+    if (m_GridMode != GridMode::Vertices)
+        return;
+
+    // Chunks are bands of whole rows along the Z axis, @see CreateGridChunks()
+    const uint32_t kChunkRowCount = GetGridChunkRowCount(m_TileSize);
+    const size_t kChunkCount = m_Mesh->GetChunkCount();
+    m_VisibleChunks.assign(kChunkCount, false);
+
+    if (!m_GridIsVisible)
+        return;
+
+    for (size_t i = 0; i < kChunkCount; ++i)
+    {
+        const uint32_t kFirstRow = static_cast<uint32_t>(i) * kChunkRowCount;
+        const uint32_t kEndRow = std::min(kFirstRow + kChunkRowCount,
+                                          m_TileSize);
+
+        const float kMinZ = kFirstRow * m_VertexDistance - kHalfLength;
+        const float kMaxZ = kEndRow * m_VertexDistance - kHalfLength;
+
+        m_VisibleChunks[i] = camera.IsBoxVisible(
+            glm::vec3(-kHalfExtent, kBounds.minHeight, kMinZ - kBounds.margin),
+            glm::vec3( kHalfExtent, kBounds.maxHeight, kMaxZ + kBounds.margin)
+        );
+    }
+}
+
+WSGrid::DisplacementBounds WaterSurfaceMesh::GetDisplacementBounds() const
+{
+    // Of the last acquired waves, or of the compute backend's reduction
+    // Of the cascades, not normalized
+    const float kCascadesAmplitude = m_Cascades->GetAmplitude();
+    const float kMinHeight = m_PushConstants.WSHeightAmp * m_WavesMinHeight -
+                             kCascadesAmplitude;
+    const float kMaxHeight = m_PushConstants.WSHeightAmp * m_WavesMaxHeight +
+                             kCascadesAmplitude;
+    const float kAmplitude = glm::max(glm::abs(kMinHeight),
+                                      glm::abs(kMaxHeight));
+
+    return WSGrid::DisplacementBounds{
+        .minHeight = kMinHeight,
+        .maxHeight = kMaxHeight,
+        .margin = kAmplitude * glm::max(1.0f, glm::abs(m_PushConstants.WSChoppy))
+    };
+}
+
+void WaterSurfaceMesh::SetupGrids()
+{
+    for (WSGrid* grid : GetGrids())
+        grid->Setup(m_TileSize, m_VertexDistance, GetMeshDetail());
+}
+
 void WaterSurfaceMesh::UpdateDescriptorSets()
 {
     VKP_ASSERT(m_DescriptorSets.size() == m_UniformBuffers.size());
@@ -280,46 +1538,108 @@ void WaterSurfaceMesh::UpdateDescriptorSet(const uint32_t frameIndex)
 
     VKP_REGISTER_FUNCTION();
 
+    DescriptorInfos infos{};
+
     // Add water surface uniform buffers
-    VkDescriptorBufferInfo bufferInfos[2] = {};
-    bufferInfos[0].buffer = m_UniformBuffers[frameIndex];
-    bufferInfos[0].offset = 0;
-    bufferInfos[0].range = sizeof(VertexUBO);
+    infos.vertexUBO.buffer = m_UniformBuffers[frameIndex];
+    infos.vertexUBO.offset = 0;
+    infos.vertexUBO.range = sizeof(VertexUBO);
 
-    bufferInfos[1].buffer = m_UniformBuffers[frameIndex];
-    bufferInfos[1].offset = 
+    infos.waterSurfaceUBO.buffer = m_UniformBuffers[frameIndex];
+    infos.waterSurfaceUBO.offset = 
         m_kDevice.GetUniformBufferAlignment(sizeof(VertexUBO));
-    bufferInfos[1].range = sizeof(WaterSurfaceUBO);
+    infos.waterSurfaceUBO.range = sizeof(WaterSurfaceUBO);
 
     // Add Water Surface textures
-#ifndef DOUBLE_BUFFERED
-    const auto& kFrameMaps = m_CurFrameMap->data[0];
-#else
-    const auto& kFrameMaps = m_CurFrameMap->data[m_FrameMapIndex];
-#endif
+    const auto& kFrameMaps = m_CurFrameMap->data[GetFrameMapIndex(frameIndex)];
 
     VKP_ASSERT(kFrameMaps.displacementMap != nullptr);
-    VKP_ASSERT(kFrameMaps.normalMap != nullptr);
+    VKP_ASSERT(kFrameMaps.normalMap != nullptr || !UsesNormalMap());
+
+    // Without the normal map, its binding is valid yet not read
+    const vkp::Texture2D& kNormalMap = kFrameMaps.normalMap != nullptr
+                                       ? *kFrameMaps.normalMap
+                                       : *kFrameMaps.displacementMap;
     
-    VkDescriptorImageInfo imageInfos[2] = {};
-    imageInfos[0] = kFrameMaps.displacementMap->GetDescriptor();
+    infos.maps[0] = kFrameMaps.displacementMap->GetDescriptor();
     // TODO force future image layout
-    imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    imageInfos[1] = kFrameMaps.normalMap->GetDescriptor();
+    infos.maps[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    infos.maps[1] = kNormalMap.GetDescriptor();
     // TODO force future image layout
-    imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    infos.maps[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // Maps of the cascades not created yet are valid yet not read
+    m_Cascades->GetMapDescriptors(*kFrameMaps.displacementMap,
+                                  infos.cascadeMaps);
+
+    VKP_ASSERT(m_SkyLut != nullptr);
+    infos.skyLut = m_SkyLut->GetDescriptor();
+    infos.skyLut.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-    vkp::DescriptorWriter descriptorWriter(*m_DescriptorSetLayout,
-                                           m_kDescriptorPool);
-    uint32_t binding = 0;
+    infos.terrainMap = m_Terrain->GetMap().GetDescriptor();
+    infos.terrainMap.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // Without the second maps, the first ones are valid yet not read
+    infos.blendMaps[0] = infos.maps[0];
+    infos.blendMaps[1] = infos.maps[1];
+    if (!m_CurFrameMap->blendData.empty())
+    {
+        const auto& kBlendMaps =
+            m_CurFrameMap->blendData[GetFrameMapIndex(frameIndex)];
+        const vkp::Texture2D& kBlendNormalMap =
+            kBlendMaps.normalMap != nullptr ? *kBlendMaps.normalMap
+                                            : *kBlendMaps.displacementMap;
+
+        infos.blendMaps[0] = kBlendMaps.displacementMap->GetDescriptor();
+        infos.blendMaps[0].imageLayout =
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        infos.blendMaps[1] = kBlendNormalMap.GetDescriptor();
+        infos.blendMaps[1].imageLayout =
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+
+    // Layer of the frame's time, and the next one, of the baked period
+    if (UsesBakedLoop() && m_Loop.displacementMaps != nullptr)
+    {
+        const vkp::Texture2DArray& kNormalMaps =
+            m_Loop.normalMaps != nullptr ? *m_Loop.normalMaps
+                                         : *m_Loop.displacementMaps;
+        const uint32_t kLayerCount = m_Loop.displacementMaps->GetLayerCount();
+        const uint32_t kLayers[2] = {
+            set.loopLayer % kLayerCount,
+            (set.loopLayer + 1) % kLayerCount
+        };
+
+        infos.maps[0] = m_Loop.displacementMaps->GetLayerDescriptor(kLayers[0]);
+        infos.maps[1] = kNormalMaps.GetLayerDescriptor(kLayers[0]);
+        infos.blendMaps[0] =
+            m_Loop.displacementMaps->GetLayerDescriptor(kLayers[1]);
+        infos.blendMaps[1] = kNormalMaps.GetLayerDescriptor(kLayers[1]);
+    }
+
+    // Maps in the first slice of the map buffer, then offset by the frame
+    if (m_HasMapBuffer)
+    {
+        VKP_ASSERT(m_MapStagingBuffer != nullptr);
+
+        const VkDeviceSize kMapSize =
+            vkp::Texture2D::FormatToBytes(m_MapFormat) *
+            m_ModelTess->GetDisplacementCount();
+        infos.mapBuffers[0] = m_MapStagingBuffer->GetDescriptor(0, kMapSize);
+        infos.mapBuffers[1] = m_MapStagingBuffer->GetDescriptor(kMapSize,
+                                                                kMapSize);
+        // Of another slice, by their dynamic offsets
+        infos.blendMapBuffers[0] = infos.mapBuffers[0];
+        infos.blendMapBuffers[1] = infos.mapBuffers[1];
+    }
 
-    descriptorWriter
-        .AddBufferDescriptor(binding++, &bufferInfos[0])
-        .AddBufferDescriptor(binding++, &bufferInfos[1])
-        .AddImageDescriptor(binding++, &imageInfos[0])
-        .AddImageDescriptor(binding++, &imageInfos[1]);
+    VKP_ASSERT(m_Bodies->GetDisplacementMaps() != nullptr);
+    infos.bodyMaps[0] = m_Bodies->GetDisplacementMaps()->GetDescriptor();
+    infos.bodyMaps[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    infos.bodyMaps[1] = m_Bodies->GetNormalMaps()->GetDescriptor();
+    infos.bodyMaps[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-    descriptorWriter.UpdateSet(set.set);
+    m_DescriptorTemplate->UpdateSet(set.set, &infos);
     set.isDirty = false;
 }
 
@@ -340,12 +1660,13 @@ void WaterSurfaceMesh::CreateDescriptorSetLayout()
 
     uint32_t bindingPoint = 0;
 
-    m_DescriptorSetLayout = vkp::DescriptorSetLayout::Builder(m_kDevice)
+    vkp::DescriptorSetLayout::Builder builder(m_kDevice);
+    builder
         // VertexUBO
         .AddBinding({
             .binding = bindingPoint++,
             .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT
+            .stageFlags = GetVertexStageFlags()
         })
         // WaterSurfaceUBO
         .AddBinding({
@@ -357,15 +1678,178 @@ void WaterSurfaceMesh::CreateDescriptorSetLayout()
         .AddBinding({
             .binding = bindingPoint++,
             .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT
+            .stageFlags = GetMapStageFlags()
         })
         // Normal map
         .AddBinding({
             .binding = bindingPoint++,
             .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT
+            .stageFlags = GetMapStageFlags()
+        });
+
+    if (m_HasMapBuffer)
+    {
+        builder
+            // Displacement map in the map buffer
+            .AddBinding({
+                .binding = bindingPoint++,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                .stageFlags = GetMapStageFlags()
+            })
+            // Normal map in the map buffer
+            .AddBinding({
+                .binding = bindingPoint++,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                .stageFlags = GetMapStageFlags()
+            });
+    }
+
+    builder
+        // Displacement maps of the detail cascades
+        .AddBinding(vkp::DescriptorSetLayoutBinding(
+            s_kCascadeMapsBinding,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            GetMapStageFlags(),
+            WSCascades::s_kMaxCount
+        ))
+        // Normal maps of the detail cascades
+        .AddBinding(vkp::DescriptorSetLayoutBinding(
+            s_kCascadeMapsBinding + 1,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            GetMapStageFlags(),
+            WSCascades::s_kMaxCount
+        ))
+        // Sky's LUT
+        .AddBinding({
+            .binding = s_kSkyLutBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
+        })
+        // Terrain map
+        .AddBinding({
+            .binding = s_kTerrainMapBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
+        })
+        // Second displacement map, interpolated at a fixed simulation rate
+        .AddBinding({
+            .binding = s_kBlendMapsBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .stageFlags = GetMapStageFlags()
+        })
+        // Second normal map
+        .AddBinding({
+            .binding = s_kBlendMapsBinding + 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .stageFlags = GetMapStageFlags()
+        });
+
+    if (m_HasMapBuffer)
+    {
+        builder
+            // Second displacement map in the map buffer
+            .AddBinding({
+                .binding = s_kBlendMapBuffersBinding,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                .stageFlags = GetMapStageFlags()
+            })
+            // Second normal map in the map buffer
+            .AddBinding({
+                .binding = s_kBlendMapBuffersBinding + 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                .stageFlags = GetMapStageFlags()
+            });
+    }
+
+    builder
+        // Displacement maps of the water bodies, a layer per distinct waves
+        .AddBinding({
+            .binding = s_kBodyMapsBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .stageFlags = GetMapStageFlags()
         })
-        .Build();
+        // Normal maps of the water bodies
+        .AddBinding({
+            .binding = s_kBodyMapsBinding + 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .stageFlags = GetMapStageFlags()
+        });
+
+    m_DescriptorSetLayout = builder.Build();
+
+    // Of the same bindings, from the infos of "UpdateDescriptorSet()"
+    bindingPoint = 0;
+
+    vkp::DescriptorUpdateTemplate::Builder templateBuilder(
+        m_kDevice, *m_DescriptorSetLayout);
+    templateBuilder
+        .AddBinding(bindingPoint++, offsetof(DescriptorInfos, vertexUBO))
+        .AddBinding(bindingPoint++, offsetof(DescriptorInfos, waterSurfaceUBO))
+        .AddBinding(bindingPoint++, offsetof(DescriptorInfos, maps[0]))
+        .AddBinding(bindingPoint++, offsetof(DescriptorInfos, maps[1]));
+
+    if (m_HasMapBuffer)
+    {
+        templateBuilder
+            .AddBinding(bindingPoint++, offsetof(DescriptorInfos, mapBuffers[0]))
+            .AddBinding(bindingPoint++, offsetof(DescriptorInfos, mapBuffers[1]));
+    }
+
+    templateBuilder
+        .AddBinding(s_kCascadeMapsBinding,
+                    offsetof(DescriptorInfos, cascadeMaps[0]))
+        .AddBinding(s_kCascadeMapsBinding + 1,
+                    offsetof(DescriptorInfos, cascadeMaps[1]))
+        .AddBinding(s_kSkyLutBinding, offsetof(DescriptorInfos, skyLut))
+        .AddBinding(s_kTerrainMapBinding, offsetof(DescriptorInfos, terrainMap))
+        .AddBinding(s_kBlendMapsBinding,
+                    offsetof(DescriptorInfos, blendMaps[0]))
+        .AddBinding(s_kBlendMapsBinding + 1,
+                    offsetof(DescriptorInfos, blendMaps[1]));
+
+    if (m_HasMapBuffer)
+    {
+        templateBuilder
+            .AddBinding(s_kBlendMapBuffersBinding,
+                        offsetof(DescriptorInfos, blendMapBuffers[0]))
+            .AddBinding(s_kBlendMapBuffersBinding + 1,
+                        offsetof(DescriptorInfos, blendMapBuffers[1]));
+    }
+
+    templateBuilder
+        .AddBinding(s_kBodyMapsBinding, offsetof(DescriptorInfos, bodyMaps[0]))
+        .AddBinding(s_kBodyMapsBinding + 1,
+                    offsetof(DescriptorInfos, bodyMaps[1]));
+
+    m_DescriptorTemplate = templateBuilder.Build();
+}
+
+VkShaderStageFlags WaterSurfaceMesh::GetVertexStageFlags() const
+{
+    if (!m_HasTessellation)
+        return VK_SHADER_STAGE_VERTEX_BIT;
+
+    return VK_SHADER_STAGE_VERTEX_BIT |
+           VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
+           VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+}
+
+VkShaderStageFlags WaterSurfaceMesh::GetMapStageFlags() const
+{
+    if (!m_HasTessellation)
+        return VK_SHADER_STAGE_VERTEX_BIT;
+
+    return VK_SHADER_STAGE_VERTEX_BIT |
+           VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+}
+
+VkPipelineStageFlags WaterSurfaceMesh::GetMapPipelineStages() const
+{
+    if (!m_HasTessellation)
+        return VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+
+    return VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+           VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT;
 }
 
 void WaterSurfaceMesh::CreateUniformBuffers(const uint32_t kBufferCount)
@@ -380,7 +1864,8 @@ void WaterSurfaceMesh::CreateUniformBuffers(const uint32_t kBufferCount)
 
     for (uint32_t i = 0; i < kBufferCount; ++i)
     {
-        auto& buffer = m_UniformBuffers.emplace_back(m_kDevice);
+        auto& buffer = m_UniformBuffers.emplace_back(m_kDevice,
+                                                    vkp::MemoryTag::Mesh);
 
         buffer.Create(kBufferSize,
                       VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
@@ -401,6 +1886,8 @@ std::vector<
         std::shared_ptr<vkp::ShaderModule>
     > shaders(kShaderInfoCount, nullptr);
 
+    // Serial if already within a parallel region, @see SetupPipelines()
+    #pragma omp parallel for schedule(dynamic)
     for (uint32_t i = 0; i < kShaderInfoCount; ++i)
     {
         shaders[i] = std::make_shared<vkp::ShaderModule>(
@@ -411,35 +1898,344 @@ std::vector<
     return shaders;
 }
 
-void WaterSurfaceMesh::SetupPipeline()
+/**
+ * @brief Inserts the path after the version of each stage before the
+ *  rasterization, the first path of each
+ */
+static std::vector<vkp::ShaderInfo> InsertAfterVersion(
+    std::vector<vkp::ShaderInfo> infos,
+    std::string_view path)
+{
+    for (vkp::ShaderInfo& info : infos)
+    {
+        if (info.stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+            info.paths.insert(info.paths.begin() + 1, path);
+    }
+    return infos;
+}
+
+std::vector<vkp::ShaderInfo> WaterSurfaceMesh::GetShaderInfos(
+    GridMode gridMode,
+    bool readsMapBuffer,
+    Pass pass,
+    bool ratesPrimitives,
+    bool isMultiview
+) const
+{
+    const std::string_view kMapsPath =
+        readsMapBuffer ? "shaders/WaterSurfaceMeshMapsBuffer.vert"
+                       : "shaders/WaterSurfaceMeshMapsSampled.vert";
+    const std::string_view kVersionPath =
+        "shaders/WaterSurfaceMeshVersion.glsl";
+    const std::string_view kUniformsPath =
+        "shaders/WaterSurfaceMeshVertexUBO.glsl";
+    // Between the version and the uniforms, of each stage but the fragment
+    const std::string_view kMultiviewPath =
+        "shaders/WaterSurfaceMeshMultiview.glsl";
+    const std::string_view kCascadesPath =
+        "shaders/WaterSurfaceMeshCascades.vert";
+    // Samples the sky's LUT and the terrain map, of their mappings appended
+    vkp::ShaderInfo fragmentInfo({ "shaders/WaterSurfaceMesh.frag",
+                                   "shaders/SkyLut.glsl",
+                                   TerrainMap::s_kShaderPath },
+                                 VK_SHADER_STAGE_FRAGMENT_BIT,
+                                 false);
+    if (pass == Pass::Depth)
+    {
+        fragmentInfo = vkp::ShaderInfo(
+            { "shaders/WaterSurfaceMeshDepth.frag" },
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            false
+        );
+    }
+    else if (pass == Pass::Overdraw)
+    {
+        fragmentInfo = vkp::ShaderInfo(
+            { "shaders/Overdraw.frag" },
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            false
+        );
+    }
+
+    // Of the shaded pass only, the others shade no colors
+    const std::string_view kVertexVersionPath =
+        ratesPrimitives && pass == Pass::Shaded
+            ? "shaders/WaterSurfaceMeshVersionShadingRate.glsl"
+            : kVersionPath;
+
+    const WSGrid::ShaderPaths kPaths{
+        .version = kVersionPath,
+        .vertexVersion = kVertexVersionPath,
+        .uniforms = kUniformsPath,
+        .displacement = "shaders/WaterSurfaceMesh.vert",
+        .maps = kMapsPath,
+        .cascades = kCascadesPath
+    };
+
+    if (const WSGrid* kGrid = GetGrid(gridMode))
+    {
+        std::vector<vkp::ShaderInfo> infos = kGrid->GetShaderInfos(kPaths);
+        infos.push_back(fragmentInfo);
+        return isMultiview ? InsertAfterVersion(infos, kMultiviewPath)
+                           : infos;
+    }
+
+    std::string_view gridPath = "shaders/WaterSurfaceMeshGridVertices.vert";
+    if (gridMode == GridMode::Procedural)
+        gridPath = "shaders/WaterSurfaceMeshGridProcedural.vert";
+
+    std::vector<vkp::ShaderInfo> infos{
+        WSGrid::GetVertexShaderInfo(kPaths, gridPath),
+        fragmentInfo
+    };
+    return isMultiview ? InsertAfterVersion(infos, kMultiviewPath) : infos;
+}
+
+std::vector<WaterSurfaceMesh::PipelineJob> WaterSurfaceMesh::GetPipelineJobs()
+{
+    std::vector<PipelineJob> jobs;
+
+    // Entries of the map inserted beforehand, the jobs only fill them
+    for (const GridMode kMode : s_kGridModes.types)
+    {
+        if (!SupportsGridMode(kMode))
+            continue;
+
+        auto& pipelines = m_Pipelines[kMode];
+        jobs.push_back({ kMode, false, Pass::Shaded, &pipelines.sampled });
+        jobs.push_back({ kMode, false, Pass::Depth, &pipelines.depthSampled });
+        jobs.push_back({ kMode, false, Pass::Overdraw,
+                         &pipelines.overdrawSampled });
+        if (m_HasMapBuffer)
+        {
+            jobs.push_back({ kMode, true, Pass::Shaded, &pipelines.mapBuffer });
+            jobs.push_back({ kMode, true, Pass::Depth,
+                             &pipelines.depthMapBuffer });
+            jobs.push_back({ kMode, true, Pass::Overdraw,
+                             &pipelines.overdrawMapBuffer });
+        }
+    }
+
+    return jobs;
+}
+
+void WaterSurfaceMesh::SetupPipelines()
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_PROFILE_SCOPE();
+
+    const std::vector<PipelineJob> kJobs = GetPipelineJobs();
+
+    // Compile times differ by the stages and the cached SPIR-V
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < static_cast<int>(kJobs.size()); ++i)
+    {
+        const PipelineJob& kJob = kJobs[i];
+        *kJob.pipeline = SetupPipeline(kJob.mode,
+                                       kJob.readsMapBuffer,
+                                       kJob.pass);
+    }
+}
+
+std::vector<std::unique_ptr<vkp::Pipeline>> WaterSurfaceMesh::RebuildPipelines(
+    const std::vector<PipelineJob>& jobs,
+    VkRenderPass renderPass,
+    VkExtent2D framebufferExtent,
+    bool framebufferHasDepthAttachment
+) const
+{
+    std::vector<std::unique_ptr<vkp::Pipeline>> pipelines(jobs.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < static_cast<int>(jobs.size()); ++i)
+    {
+        const PipelineJob& kJob = jobs[i];
+        auto pipeline = SetupPipeline(kJob.mode,
+                                      kJob.readsMapBuffer,
+                                      kJob.pass);
+
+        // Failed to compile, or not edited, the current one is kept
+        if (!pipeline->HasShaderModules() ||
+            pipeline->HasSameShaders(**kJob.pipeline))
+        {
+            continue;
+        }
+
+        pipeline->Create(framebufferExtent,
+                         renderPass,
+                         framebufferHasDepthAttachment);
+        pipelines[i] = std::move(pipeline);
+    }
+
+    return pipelines;
+}
+
+void WaterSurfaceMesh::ApplyPipelineRebuild(bool wait)
+{
+    if (!m_RebuiltPipelines.valid())
+        return;
+
+    const bool kIsReady = m_RebuiltPipelines.wait_for(std::chrono::seconds(0))
+                          == std::future_status::ready;
+    if (!wait && !kIsReady)
+        return;
+
+    std::vector<std::unique_ptr<vkp::Pipeline>> pipelines =
+        m_RebuiltPipelines.get();
+
+    // Last read by the frames submitted so far
+    RetiredPipelines retired{
+        .pipelines = {},
+        .submitValue =
+            m_kDevice.GetTimeline(vkp::QFamily::Graphics).GetLastValue()
+    };
+    for (size_t i = 0; i < pipelines.size(); ++i)
+    {
+        if (pipelines[i] == nullptr)
+            continue;
+
+        retired.pipelines.push_back( std::move(*m_RebuildJobs[i].pipeline) );
+        *m_RebuildJobs[i].pipeline = std::move(pipelines[i]);
+    }
+    m_RebuildJobs.clear();
+
+    VKP_LOG_INFO("Water surface pipelines rebuilt: {}",
+                 retired.pipelines.size());
+    if (!retired.pipelines.empty())
+        m_RetiredPipelines.push_back( std::move(retired) );
+}
+
+void WaterSurfaceMesh::ReleaseRetiredPipelines()
+{
+    const uint64_t kCompletedValue =
+        m_kDevice.GetTimeline(vkp::QFamily::Graphics).GetCompletedValue();
+
+    auto isDone = [kCompletedValue](const RetiredPipelines& kRetired) {
+        return kRetired.submitValue <= kCompletedValue;
+    };
+
+    m_RetiredPipelines.erase(
+        std::remove_if(m_RetiredPipelines.begin(), m_RetiredPipelines.end(),
+                       isDone),
+        m_RetiredPipelines.end()
+    );
+}
+
+std::unique_ptr<vkp::Pipeline> WaterSurfaceMesh::SetupPipeline(
+    GridMode gridMode,
+    bool readsMapBuffer,
+    Pass pass
+) const
 {
     VKP_REGISTER_FUNCTION();
 
+    const std::vector<vkp::ShaderInfo> kShaderInfos =
+        GetShaderInfos(gridMode, readsMapBuffer, pass,
+                       m_HasPrimitiveShadingRate, m_ViewCount > 1);
+
     std::vector<
         std::shared_ptr<vkp::ShaderModule>
-    > shaders = CreateShadersFromShaderInfos(s_kShaderInfos.data(),
-                                             s_kShaderInfos.size());
+    > shaders = CreateShadersFromShaderInfos(kShaderInfos.data(),
+                                             kShaderInfos.size());
 
-    m_Pipeline = std::make_unique<vkp::Pipeline>(
+    auto pipeline = std::make_unique<vkp::Pipeline>(
         m_kDevice, shaders
     );
 
-    VKP_ASSERT(m_DescriptorSetLayout != nullptr);
-    VKP_ASSERT(m_DescriptorSetLayout->GetLayout() != VK_NULL_HANDLE);
+    VKP_ASSERT(m_DescriptorSetLayout != nullptr);
+    VKP_ASSERT(m_DescriptorSetLayout->GetLayout() != VK_NULL_HANDLE);
+
+    // Set descriptor set layout
+    {
+        const auto& descriptorSetLayout = m_DescriptorSetLayout->GetLayout();
+
+        auto& pipelineLayoutInfo = pipeline->GetPipelineLayoutInfo();
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &m_PushConstantRange;
+    }
+
+    // Main pass passes the depths of the pre-pass, or the nearer ones without,
+    //  the overdraw counts the fragments the main pass would shade
+    if (pass == Pass::Depth)
+        pipeline->SetColorWriteMask(0);
+    else
+        pipeline->SetDepthState(VK_COMPARE_OP_LESS_OR_EQUAL, true);
+
+    if (pass == Pass::Overdraw)
+        pipeline->SetAdditiveBlending();
+
+    // Of the rates written by the vertex stage, @see "GetShaderInfos()"
+    if (m_HasPrimitiveShadingRate && pass == Pass::Shaded &&
+        gridMode != GridMode::Tessellated)
+        pipeline->SetPrimitiveShadingRate();
+
+    if (const WSGrid* kGrid = GetGrid(gridMode))
+    {
+        kGrid->SetupPipeline(*pipeline);
+    }
+    else if (gridMode == GridMode::Vertices)
+    {
+        pipeline->SetVertexInputState(
+            vkp::Pipeline::InitVertexInput(Vertex::s_BindingDescriptions,
+                                           Vertex::s_AttribDescriptions)
+        );
+
+        // Rows of the grid as strips, with 16-bit indices
+        auto inputAssembly = vkp::Pipeline::InitInputAssembly(
+            VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP
+        );
+        inputAssembly.primitiveRestartEnable = VK_TRUE;
+        pipeline->SetInputAssemblyState(inputAssembly);
+    }
+    else
+    {
+        pipeline->SetVertexInputState( vkp::Pipeline::InitVertexInput() );
+    }
+
+    return pipeline;
+}
 
-    // Set descriptor set layout
+const vkp::Pipeline& WaterSurfaceMesh::GetPipeline(Pass pass) const
+{
+    const auto& kPipelines = m_Pipelines.at(m_GridMode);
+    if (pass == Pass::Depth)
     {
-        const auto& descriptorSetLayout = m_DescriptorSetLayout->GetLayout();
+        return UsesMapBuffer() ? *kPipelines.depthMapBuffer
+                               : *kPipelines.depthSampled;
+    }
+    if (pass == Pass::Overdraw)
+    {
+        return UsesMapBuffer() ? *kPipelines.overdrawMapBuffer
+                               : *kPipelines.overdrawSampled;
+    }
+    return UsesMapBuffer() ? *kPipelines.mapBuffer : *kPipelines.sampled;
+}
 
-        auto& pipelineLayoutInfo = m_Pipeline->GetPipelineLayoutInfo();
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+WSGrid* WaterSurfaceMesh::GetGrid(GridMode mode) const
+{
+    switch (mode)
+    {
+        case GridMode::CDLOD:
+            return m_CDLODGrid.get();
+        case GridMode::Tessellated:
+            return m_TessellatedGrid.get();
+        case GridMode::Tiled:
+            return m_TiledGrid.get();
+        case GridMode::Projected:
+            return m_ProjectedGrid.get();
+        case GridMode::Bodies:
+            return m_BodiesGrid.get();
+        default:
+            return nullptr;
     }
+}
 
-    m_Pipeline->SetVertexInputState(
-        vkp::Pipeline::InitVertexInput(Vertex::s_BindingDescriptions,
-                                       Vertex::s_AttribDescriptions)
-    );
+std::vector<WSGrid*> WaterSurfaceMesh::GetGrids() const
+{
+    return { m_CDLODGrid.get(), m_TessellatedGrid.get(), m_TiledGrid.get(),
+             m_ProjectedGrid.get(), m_BodiesGrid.get() };
 }
 
 void WaterSurfaceMesh::CreateDescriptorSets(const uint32_t kCount)
@@ -466,13 +2262,52 @@ void WaterSurfaceMesh::CreatePipeline(
 )
 {
     VKP_REGISTER_FUNCTION();
-    VKP_ASSERT(m_Pipeline != nullptr);
+    VKP_ASSERT(!m_Pipelines.empty());
 
     m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
 
-    m_Pipeline->Create(framebufferExtent,
-                       renderPass,
-                       framebufferHasDepthAttachment);
+    // Recreated below anyway, of the new framebuffer, none is in use
+    ApplyPipelineRebuild(true);
+    m_RetiredPipelines.clear();
+
+    SetFramebufferExtent(framebufferExtent);
+    m_FramebufferHasDepth = framebufferHasDepthAttachment;
+
+    // Of the device's pipeline cache, synchronized by the driver
+    const std::vector<vkp::Pipeline*> kPipelines = GetPipelines();
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < static_cast<int>(kPipelines.size()); ++i)
+    {
+        kPipelines[i]->Create(framebufferExtent,
+                              renderPass,
+                              framebufferHasDepthAttachment);
+    }
+}
+
+void WaterSurfaceMesh::SetFramebufferExtent(const VkExtent2D& extent)
+{
+    // Of the screen size of the tessellated edges
+    m_VertexUBO.viewportHeight = static_cast<float>(extent.height);
+    m_ProjectedGrid->SetFramebufferExtent(extent);
+}
+
+std::vector<vkp::Pipeline*> WaterSurfaceMesh::GetPipelines() const
+{
+    std::vector<vkp::Pipeline*> pipelines;
+    for (const auto& [mode, kPipelines] : m_Pipelines)
+    {
+        pipelines.push_back(kPipelines.sampled.get());
+        pipelines.push_back(kPipelines.depthSampled.get());
+        pipelines.push_back(kPipelines.overdrawSampled.get());
+        if (kPipelines.mapBuffer != nullptr)
+        {
+            pipelines.push_back(kPipelines.mapBuffer.get());
+            pipelines.push_back(kPipelines.depthMapBuffer.get());
+            pipelines.push_back(kPipelines.overdrawMapBuffer.get());
+        }
+    }
+    return pipelines;
 }
 
 void WaterSurfaceMesh::CreateTessendorfModel()
@@ -483,18 +2318,85 @@ void WaterSurfaceMesh::CreateTessendorfModel()
     const auto kWaveLength = m_ModelTess->s_kDefaultTileLength;
 
     m_ModelTess.reset( new WSTessendorf(kSampleCount, kWaveLength) );
+    m_Simulation.reset( new WSSimulation(*m_ModelTess) );
+}
+
+void WaterSurfaceMesh::PrepareCascades()
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Plans of the cascades are created while the worker may execute its own
+    DrainSimulation();
+    m_Cascades->Prepare(*m_ModelTess);
+
+    // Previous maps are freed
+    SetDescriptorSetsDirty();
+}
+
+void WaterSurfaceMesh::PrepareBodies()
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Plans of the layers are created while the worker may execute its own
+    DrainSimulation();
+    m_Bodies->Prepare(*m_ModelTess);
+
+    // Previous maps are freed
+    SetDescriptorSetsDirty();
+}
+
+void WaterSurfaceMesh::CreateComputeModel()
+{
+    VKP_REGISTER_FUNCTION();
+
+    m_ModelCompute.reset(
+        new WSTessendorfCompute(m_kDevice, m_kDescriptorPool, m_MapFormat)
+    );
 }
 
 void WaterSurfaceMesh::CreateMesh()
 {
     VKP_REGISTER_FUNCTION();
 
-    const VkDeviceSize kMaxVerticesSize = sizeof(Vertex) * GetMaxVertexCount();
-    const VkDeviceSize kMaxIndicesSize = sizeof(uint32_t) * GetMaxIndexCount();
+    // Buffers are created with the first vertices, if read from them
+    m_Mesh.reset( new GridMesh() );
+}
+
+void WaterSurfaceMesh::CreateMeshBuffers(const uint32_t kTileSize)
+{
+    VKP_REGISTER_FUNCTION();
+
+    m_MeshVerticesCapacity = sizeof(Vertex) * GetTotalVertexCount(kTileSize);
+    m_MeshIndicesCapacity = sizeof(uint16_t) *
+                            GetTotalStripIndexCount(kTileSize);
 
-    m_Mesh.reset(
-        new Mesh<Vertex>(m_kDevice, kMaxVerticesSize, kMaxIndicesSize)
+    m_Mesh->CreateBuffers(m_kDevice, m_MeshVerticesCapacity,
+                          m_MeshIndicesCapacity);
+
+    m_StagingBuffer.reset(
+        new vkp::Buffer(m_kDevice, vkp::MemoryTag::Staging)
     );
+    m_StagingBuffer->Create(m_MeshVerticesCapacity + m_MeshIndicesCapacity,
+                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+    auto err = m_StagingBuffer->Map();
+    VKP_ASSERT_RESULT(err);
+}
+
+void WaterSurfaceMesh::ReserveMeshBuffers()
+{
+    const bool kNeedsRealloc =
+        NeedsRealloc(m_MeshVerticesCapacity, m_Mesh->GetVerticesSize()) ||
+        NeedsRealloc(m_MeshIndicesCapacity, m_Mesh->GetIndicesSize());
+    if (!kNeedsRealloc)
+        return;
+
+    // Previous ones may still be read by the frames in flight
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    CreateMeshBuffers(m_TileSize);
+    m_Mesh->SetBuffersDirty();
 }
 
 std::vector<WaterSurfaceMesh::Vertex> WaterSurfaceMesh::CreateGridVertices(
@@ -535,7 +2437,7 @@ std::vector<WaterSurfaceMesh::Vertex> WaterSurfaceMesh::CreateGridVertices(
     return vertices;
 }
 
-std::vector<uint32_t> WaterSurfaceMesh::CreateGridIndices(
+std::vector<uint16_t> WaterSurfaceMesh::CreateGridIndices(
     const uint32_t kTileSize
 )
 {
@@ -543,83 +2445,306 @@ std::vector<uint32_t> WaterSurfaceMesh::CreateGridIndices(
     VKP_PROFILE_SCOPE();
 
     const uint32_t kVertexCount = kTileSize+1;
+    const uint32_t kChunkRowCount = GetGridChunkRowCount(kTileSize);
 
-    std::vector<uint32_t> indices;
-    indices.reserve( GetTotalIndexCount(kVertexCount * kVertexCount) );
+    std::vector<uint16_t> indices;
+    indices.reserve( GetTotalStripIndexCount(kTileSize) );
 
     for (uint32_t y = 0; y < kTileSize; ++y)
     {
-        for (uint32_t x = 0; x < kTileSize; ++x)
+        // Relative to the first row of the chunk
+        const uint32_t kRow = y % kChunkRowCount;
+
+        // Strip of the quads between the two rows of vertices, the triangles
+        //  are wound the same way as the ones of the list
+        for (uint32_t x = 0; x < kVertexCount; ++x)
         {
-            const uint32_t kVertexIndex = y * kVertexCount + x;
+            const uint32_t kVertexIndex = kRow * kVertexCount + x;
 
-            // Top triangle
             indices.emplace_back(kVertexIndex);
             indices.emplace_back(kVertexIndex + kVertexCount);
-            indices.emplace_back(kVertexIndex + 1);
-
-            // Bottom triangle
-            indices.emplace_back(kVertexIndex + 1);
-            indices.emplace_back(kVertexIndex + kVertexCount);
-            indices.emplace_back(kVertexIndex + kVertexCount + 1);
         }
+        indices.emplace_back(s_kPrimitiveRestartIndex);
     }
 
     return indices;
 }
 
-void WaterSurfaceMesh::CreateStagingBuffer()
+std::vector<WaterSurfaceMesh::GridMesh::Chunk>
+WaterSurfaceMesh::CreateGridChunks(const uint32_t kTileSize)
 {
-    m_StagingBuffer.reset( new vkp::Buffer(m_kDevice) );
+    const uint32_t kVertexCount = kTileSize+1;
+    const uint32_t kChunkRowCount = GetGridChunkRowCount(kTileSize);
+    const uint32_t kRowIndexCount = 2 * kVertexCount + 1;
 
-    const VkDeviceSize kVerticesSize = sizeof(Vertex) * GetMaxVertexCount();
-    const VkDeviceSize kIndicesSize = sizeof(uint32_t) * GetMaxIndexCount();
+    std::vector<GridMesh::Chunk> chunks;
 
-    const VkDeviceSize kMapSize = vkp::Texture2D::FormatToBytes(s_kMapFormat) *
-                                  s_kMaxTileSize * s_kMaxTileSize;
+    for (uint32_t y = 0; y < kTileSize; y += kChunkRowCount)
+    {
+        const uint32_t kRowCount = std::min(kChunkRowCount, kTileSize - y);
 
-    const VkDeviceSize kTotalSize = 
-        AlignSizeTo(kVerticesSize + kIndicesSize,
-                    vkp::Texture2D::FormatToBytes(s_kMapFormat)) +
-        (kMapSize * 2) // * m_FrameMaps.size()
-    ;
+        chunks.push_back(GridMesh::Chunk{
+            .firstIndex = y * kRowIndexCount,
+            .indexCount = kRowCount * kRowIndexCount,
+            .vertexOffset = static_cast<int32_t>(y * kVertexCount)
+        });
+    }
 
-    m_StagingBuffer->Create(kTotalSize,
-                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    return chunks;
+}
 
-    // TODO can map to lower size after each resize
-    auto err = m_StagingBuffer->Map();
+void WaterSurfaceMesh::CreateMapStagingBuffer(const uint32_t kImageCount)
+{
+    VKP_REGISTER_FUNCTION();
+
+    // Worker may be writing to the previous buffer
+    DrainSimulation();
+
+    // Free one is left while each image's last frame reads one, and the
+    //  simulation computes the latency and the acquired ones, and at a fixed
+    //  rate the previous ones are kept
+    const uint32_t kSliceCount = kImageCount + WSSimulation::s_kMaxLatency + 3;
+
+    m_MapStagingSlices.assign(kSliceCount, MapStagingSlice{
+        .readFrames = std::vector<uint64_t>(kImageCount, 0)
+    });
+    m_ImageFrameCounts.assign(kImageCount, 0);
+
+    // Reallocated when the resolution or the map format outgrows it
+    m_MapStagingSliceSize = GetMapStagingSliceSize();
+
+    // Directly read by the vertex shader, if in device local memory
+    const VkBufferUsageFlags kUsage = m_HasMapBuffer
+        ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+        : VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    const VkMemoryPropertyFlags kProperties = m_HasMapBuffer
+        ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+        : VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+    // Read by both queues, maps just created are updated on the graphics one
+    const auto& kIndices = m_kDevice.GetPhysicalDevice().GetQueueFamilyIndices();
+    const VkSharingMode kSharingMode = m_HasTransferQueue
+                                       ? VK_SHARING_MODE_CONCURRENT
+                                       : VK_SHARING_MODE_EXCLUSIVE;
+    std::vector<uint32_t> queueFamilyIndices;
+    if (m_HasTransferQueue)
+        queueFamilyIndices = { kIndices.Graphics(), kIndices.Transfer() };
+
+    m_MapStagingBuffer.reset(
+        new vkp::Buffer(m_kDevice, vkp::MemoryTag::Staging)
+    );
+    m_MapStagingBuffer->Create(m_MapStagingSliceSize * kSliceCount,
+                               kUsage,
+                               kProperties,
+                               kSharingMode,
+                               queueFamilyIndices);
+
+    auto err = m_MapStagingBuffer->Map();
     VKP_ASSERT_RESULT(err);
+
+    if (m_HasMapBuffer)
+    {
+        // Waves read by the frames are gone with the previous buffer
+        m_MapBufferSlice = UINT32_MAX;
+        m_FrameMapNeedsUpdate = true;
+        SetDescriptorSetsDirty();
+    }
 }
 
-void WaterSurfaceMesh::CreateFrameMaps(VkCommandBuffer cmdBuffer)
+bool WaterSurfaceMesh::ReserveMapStagingBuffer()
 {
-    VKP_REGISTER_FUNCTION();
+    if (!NeedsRealloc(m_MapStagingSliceSize, GetMapStagingSliceSize()))
+        return false;
+
+    VKP_LOG_INFO("Water surface map staging buffer resized");
 
+    // Slices may still be copied from, or read by the frames in flight
     m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+    if (m_HasTransferQueue)
+        m_kDevice.QueueWaitIdle(vkp::QFamily::Transfer);
+
+    CreateMapStagingBuffer(m_ImageFrameCounts.size());
+    return true;
+}
+
+VkDeviceSize WaterSurfaceMesh::GetMapStagingSliceSize() const
+{
+    const uint32_t kTileSize = m_ModelTess->GetTileSize();
+    const VkDeviceSize kMapSize = vkp::Texture2D::FormatToBytes(m_MapFormat) *
+                                  kTileSize * kTileSize;
+
+    // Non-coherent atom size is a lot smaller, slices are flushed separately
+    const VkDeviceSize kSliceSize =
+        m_kDevice.GetNonCoherentAtomSizeAlignment(kMapSize * 2);
+
+    // Also a dynamic offset of the map buffer
+    const VkDeviceSize kOffsetAlignment =
+        m_kDevice.GetPhysicalDevice().GetMinStorageBufferOffsetAlignment();
+    return (kSliceSize + kOffsetAlignment - 1) /
+           kOffsetAlignment * kOffsetAlignment;
+}
+
+void WaterSurfaceMesh::CreateTransferResources(const uint32_t kCount)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_ASSERT(m_HasTransferQueue);
+
+    DestroyTransferSemaphores();
+
+    // A command buffer per frame in flight, reset after the image's fence
+    m_TransferCmdPool.reset(
+        new vkp::CommandPool(m_kDevice, vkp::QFamily::Transfer,
+                             VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
+    );
+    m_TransferCmdPool->AllocateCommandBuffers(kCount);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    m_TransferSemaphores.resize(kCount, VK_NULL_HANDLE);
+    for (auto& semaphore : m_TransferSemaphores)
+    {
+        auto err = vkCreateSemaphore(m_kDevice, &semaphoreInfo, nullptr,
+                                     &semaphore);
+        VKP_ASSERT_RESULT(err);
+    }
+}
+
+void WaterSurfaceMesh::DestroyTransferSemaphores()
+{
+    for (auto& semaphore : m_TransferSemaphores)
+        vkDestroySemaphore(m_kDevice, semaphore, nullptr);
+
+    m_TransferSemaphores.clear();
+    m_MapUploadSemaphore = VK_NULL_HANDLE;
+}
+
+void WaterSurfaceMesh::SelectFrameMaps(VkCommandBuffer cmdBuffer)
+{
+    VKP_REGISTER_FUNCTION();
 
-    // Create frame map pair for each water surface resolution
     m_FrameMaps.resize(s_kWSResolutions.size());
 
-    for (uint32_t i = 0; i < s_kWSResolutions.size(); ++i)
+    const uint32_t kSize = m_ModelTess->GetTileSize();
+    auto& pair = m_FrameMaps[s_kWSResolutions.GetIndex(kSize)];
+
+    if (pair.data.empty())
+        CreateFrameMaps(cmdBuffer, pair, kSize);
+
+    pair.lastUsed = ++m_FrameMapSelections;
+    m_CurFrameMap = &pair;
+    SetDescriptorSetsDirty();
+
+    EvictFrameMaps(pair);
+}
+
+void WaterSurfaceMesh::CreateFrameMaps(
+    VkCommandBuffer cmdBuffer,
+    FrameMapPair& pair,
+    const uint32_t kSize
+)
+{
+    VKP_REGISTER_FUNCTION();
+    VKP_LOG_INFO("Creating water surface maps of resolution {}", kSize);
+
+    pair.data.clear();
+    pair.data.resize(GetFrameMapCount());
+    pair.blendData.clear();
+    // Of the map buffer, the second maps are in another slice
+    if (UsesFixedRate() && !UsesMapBuffer())
+        pair.blendData.resize(GetFrameMapCount());
+
+    // Updated on the graphics queue first, in order with the creation
+    auto CreateMaps = [&](FrameMapData& frame) {
+        frame.displacementMap = CreateMap(cmdBuffer,
+                                          kSize,
+                                          m_MapFormat,
+                                          UsesMapMipmaps());
+        if (!UsesNormalMap())
+            return;
+
+        frame.normalMap = CreateMap(cmdBuffer,
+                                    kSize,
+                                    m_MapFormat,
+                                    UsesMapMipmaps());
+    };
+    std::for_each(pair.data.begin(), pair.data.end(), CreateMaps);
+    std::for_each(pair.blendData.begin(), pair.blendData.end(), CreateMaps);
+
+    // Mip chain adds a third of the base level
+    VkDeviceSize mapSize = vkp::Texture2D::FormatToBytes(m_MapFormat) *
+                           kSize * kSize;
+    if (UsesMapMipmaps())
+        mapSize += mapSize / 3;
+    const uint32_t kMapCount = UsesNormalMap() ? 2 : 1;
+    pair.size = kMapCount * mapSize *
+                (pair.data.size() + pair.blendData.size());
+}
+
+void WaterSurfaceMesh::DestroyFrameMaps()
+{
+    VKP_REGISTER_FUNCTION();
+
+    m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+
+    for (auto& pair : m_FrameMaps)
+    {
+        pair.data.clear();
+        pair.blendData.clear();
+        pair.size = 0;
+    }
+    m_CurFrameMap = nullptr;
+}
+
+void WaterSurfaceMesh::EvictFrameMaps(const FrameMapPair& kKept)
+{
+    VkDeviceSize totalSize = 0;
+    for (const auto& pair : m_FrameMaps)
+        totalSize += pair.size;
+
+    bool waitedIdle = false;
+
+    while (totalSize > m_FrameMapBudget)
     {
-        const uint32_t kSize = s_kWSResolutions[i];
+        FrameMapPair* leastUsed = nullptr;
+        for (auto& pair : m_FrameMaps)
+        {
+            if (&pair == &kKept || pair.data.empty())
+                continue;
+            if (leastUsed == nullptr || pair.lastUsed < leastUsed->lastUsed)
+                leastUsed = &pair;
+        }
 
-        for (auto& frame : m_FrameMaps[i].data)
+        if (leastUsed == nullptr)
+            break;
+
+        // May still be read by the frames in flight, or their uploads
+        if (!waitedIdle)
         {
-            frame.displacementMap = CreateMap(cmdBuffer,
-                                              kSize,
-                                              s_kMapFormat,
-                                              s_kUseMipMapping);
-            frame.normalMap = CreateMap(cmdBuffer,
-                                        kSize,
-                                        s_kMapFormat,
-                                        s_kUseMipMapping);
+            m_kDevice.QueueWaitIdle(vkp::QFamily::Graphics);
+            waitedIdle = true;
         }
+
+        VKP_LOG_INFO("Freeing water surface maps of resolution {}",
+                     leastUsed->data.front().displacementMap->GetWidth());
+
+        totalSize -= leastUsed->size;
+        leastUsed->data.clear();
+        leastUsed->blendData.clear();
+        leastUsed->size = 0;
     }
 }
 
+void WaterSurfaceMesh::SetFrameMapBudget(VkDeviceSize budget)
+{
+    if (budget == m_FrameMapBudget)
+        return;
+
+    m_FrameMapBudget = budget;
+    // Re-selects the bound maps, evicting the others over budget
+    m_CurFrameMap = nullptr;
+}
+
 std::unique_ptr<vkp::Texture2D> WaterSurfaceMesh::CreateMap(
     VkCommandBuffer cmdBuffer,
     const uint32_t kSize,
@@ -629,38 +2754,41 @@ std::unique_ptr<vkp::Texture2D> WaterSurfaceMesh::CreateMap(
 {
     VKP_REGISTER_FUNCTION();
 
-    auto map = std::make_unique<vkp::Texture2D>(m_kDevice);
+    auto map = std::make_unique<vkp::Texture2D>(m_kDevice,
+                                                vkp::MemoryTag::Maps);
 
+    // Storage for the compute backend, read back for the wave queries
     map->Create(cmdBuffer, kSize, kSize, kMapFormat,
                 kUseMipMapping,
                 VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                VK_IMAGE_USAGE_SAMPLED_BIT);
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                VK_IMAGE_USAGE_SAMPLED_BIT |
+                VK_IMAGE_USAGE_STORAGE_BIT);
 
     return map;
 }
 
 void WaterSurfaceMesh::UpdateFrameMaps(
     VkCommandBuffer cmdBuffer,
-    FrameMapData& frame
+    FrameMapData& frame,
+    const uint32_t kSlice
 )
 {
-    VkDeviceSize stagingBufferOffset =
-        AlignSizeTo(m_Mesh->GetVerticesSize() + m_Mesh->GetIndicesSize(),
-                    vkp::Texture2D::FormatToBytes(s_kMapFormat) );
+    VkDeviceSize stagingBufferOffset = m_MapStagingSliceSize * kSlice;
 
 #ifndef DOUBLE_BUFFERED
     frame.displacementMap->CopyFromBuffer(
         cmdBuffer,
-        *m_StagingBuffer,
-        s_kUseMipMapping,
-        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        *m_MapStagingBuffer,
+        UsesMapMipmaps(),
+        GetMapPipelineStages(),
         stagingBufferOffset
     );
 #else
     frame.displacementMap->CopyFromBuffer(
         cmdBuffer,
-        *m_StagingBuffer,
-        s_kUseMipMapping,
+        *m_MapStagingBuffer,
+        UsesMapMipmaps(),
         //VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
         //VK_PIPELINE_STAGE_NONE,
         //VK_PIPELINE_STAGE_TRANSFER_BIT,
@@ -670,24 +2798,27 @@ void WaterSurfaceMesh::UpdateFrameMaps(
     );
 #endif
 
-    const VkDeviceSize kMapSize = vkp::Texture2D::FormatToBytes(s_kMapFormat) *
+    const VkDeviceSize kMapSize = vkp::Texture2D::FormatToBytes(m_MapFormat) *
                                   frame.displacementMap->GetWidth() *
                                   frame.displacementMap->GetHeight();
     stagingBufferOffset += kMapSize;
 
+    if (frame.normalMap == nullptr)
+        return;
+
 #ifndef DOUBLE_BUFFERED
     frame.normalMap->CopyFromBuffer(
         cmdBuffer,
-        *m_StagingBuffer,
-        s_kUseMipMapping,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        *m_MapStagingBuffer,
+        UsesMapMipmaps(),
+        GetMapPipelineStages(),
         stagingBufferOffset
     );
 #else
     frame.normalMap->CopyFromBuffer(
         cmdBuffer,
-        *m_StagingBuffer,
-        s_kUseMipMapping,
+        *m_MapStagingBuffer,
+        UsesMapMipmaps(),
         //VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
         //VK_PIPELINE_STAGE_NONE,
         //VK_PIPELINE_STAGE_TRANSFER_BIT,
@@ -698,60 +2829,105 @@ void WaterSurfaceMesh::UpdateFrameMaps(
 #endif
 }
 
-void WaterSurfaceMesh::CopyModelTessDataToStagingBuffer()
+void WaterSurfaceMesh::SubmitFrameMapsUpload(
+    const uint32_t frameIndex,
+    VkCommandBuffer cmdBuffer,
+    FrameMapData& frame,
+    const uint32_t kSlice
+)
 {
-    VKP_ASSERT(m_StagingBuffer != nullptr);
-
-    const VkDeviceSize kDisplacementsSize = sizeof(WSTessendorf::Displacement) *
-                                            m_ModelTess->GetDisplacementCount();
-    const VkDeviceSize kNormalsSize = sizeof(WSTessendorf::Normal) *
-                                      m_ModelTess->GetNormalCount();
+    VKP_ASSERT(m_TransferCmdPool != nullptr);
+    VKP_ASSERT(frameIndex < m_TransferSemaphores.size());
 
-    // StagingBuffer layout: 
-    //  ----------------------------------------------
-    // | Vertices | Indices | Displacements | Normals |
-    //  ----------------------------------------------
-    // mapped
+    const auto& kIndices = m_kDevice.GetPhysicalDevice().GetQueueFamilyIndices();
+    const uint32_t kTransferFamily = kIndices.Transfer();
+    const uint32_t kGraphicsFamily = kIndices.Graphics();
 
-    void* stagingData = m_StagingBuffer->GetMappedAddress();
-    VKP_ASSERT(stagingData != nullptr);
+    const VkDeviceSize kStagingBufferOffset = m_MapStagingSliceSize * kSlice;
+    const VkDeviceSize kMapSize = vkp::Texture2D::FormatToBytes(m_MapFormat) *
+                                  frame.displacementMap->GetWidth() *
+                                  frame.displacementMap->GetHeight();
 
-    // Copy displacements
+    // Its previous execution was waited on by the frame's previous graphics
+    //  submission, hence finished before the image's fence
+    vkp::CommandBuffer& transferCmd = (*m_TransferCmdPool)[frameIndex];
+    transferCmd.Reset();
+    transferCmd.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
     {
-        stagingData = static_cast<void*>(
-            static_cast<uint8_t*>(stagingData) +
-                AlignSizeTo(m_Mesh->GetVerticesSize() + m_Mesh->GetIndicesSize(),
-                            vkp::Texture2D::FormatToBytes(s_kMapFormat) )
-        );
-
-        m_StagingBuffer->CopyToMapped(
-            m_ModelTess->GetDisplacements().data(),
-            kDisplacementsSize,
-            stagingData
+        frame.displacementMap->CopyFromBufferAndRelease(
+            transferCmd,
+            *m_MapStagingBuffer,
+            kStagingBufferOffset,
+            kTransferFamily, kGraphicsFamily
         );
+        if (frame.normalMap != nullptr)
+        {
+            frame.normalMap->CopyFromBufferAndRelease(
+                transferCmd,
+                *m_MapStagingBuffer,
+                kStagingBufferOffset + kMapSize,
+                kTransferFamily, kGraphicsFamily
+            );
+        }
     }
-
-    // Copy normals
+    transferCmd.End();
+
+    // Submitted right away, the copy overlaps the rendering of the previous
+    //  frame, instead of being at the head of this one
+    const VkCommandBuffer kTransferCmd = transferCmd;
+    const VkSemaphore kSignalSemaphore = m_TransferSemaphores[frameIndex];
+
+    VkSubmitInfo submitInfo {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .pWaitDstStageMask = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &kTransferCmd,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &kSignalSemaphore
+    };
+
+    auto err = m_kDevice.QueueSubmit(vkp::QFamily::Transfer, { submitInfo });
+    VKP_ASSERT_RESULT_MSG(err, "Failed to submit the maps upload");
+
+    m_MapUploadSemaphore = kSignalSemaphore;
+
+    // Acquire by the graphics queue, where the maps are first read
+    frame.displacementMap->AcquireFromQueueFamily(
+        cmdBuffer,
+        kTransferFamily, kGraphicsFamily,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+    );
+    if (frame.normalMap != nullptr)
     {
-        stagingData = static_cast<void*>(
-            static_cast<uint8_t*>(stagingData) + kDisplacementsSize
-        );
-        
-        m_StagingBuffer->CopyToMapped(
-            m_ModelTess->GetNormals().data(),
-            kNormalsSize,
-            stagingData
+        frame.normalMap->AcquireFromQueueFamily(
+            cmdBuffer,
+            kTransferFamily, kGraphicsFamily,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
         );
     }
+}
 
-    m_StagingBuffer->FlushMappedRange(
-        m_kDevice.GetNonCoherentAtomSizeAlignment(
-            AlignSizeTo(m_Mesh->GetVerticesSize() + m_Mesh->GetIndicesSize(),
-                        vkp::Texture2D::FormatToBytes(s_kMapFormat) ) +
-            kDisplacementsSize +
-            kNormalsSize
-        )
-    );
+uint32_t WaterSurfaceMesh::GetFrameMapCount() const
+{
+#ifndef DOUBLE_BUFFERED
+    VKP_ASSERT(!m_HasTransferQueue || !m_ImageFrameCounts.empty());
+    return m_HasTransferQueue ? m_ImageFrameCounts.size() : 1;
+#else
+    return 2;
+#endif
+}
+
+uint32_t WaterSurfaceMesh::GetFrameMapIndex(const uint32_t frameIndex) const
+{
+#ifndef DOUBLE_BUFFERED
+    // Compute backend writes the first one, in order on the graphics queue
+    return UsesTransferQueue() ? frameIndex : 0;
+#else
+    return m_FrameMapIndex;
+#endif
 }
 
 void WaterSurfaceMesh::RecompileShaders(
@@ -760,18 +2936,32 @@ void WaterSurfaceMesh::RecompileShaders(
     const bool kFramebufferHasDepthAttachment
 )
 {
-    bool kNeedsRecreation = m_Pipeline->RecompileShaders();
-    if (kNeedsRecreation)
+    if (m_RebuiltPipelines.valid())
     {
-        CreatePipeline(kFramebufferExtent,
-                       renderPass,
-                       kFramebufferHasDepthAttachment);
+        VKP_LOG_WARN("Water surface pipelines are still being rebuilt");
+        return;
     }
+
+    // Slots of the pipelines stay, no grid modes are added meanwhile
+    m_RebuildJobs = GetPipelineJobs();
+    m_RebuiltPipelines = std::async(
+        std::launch::async,
+        &WaterSurfaceMesh::RebuildPipelines, this,
+        m_RebuildJobs, renderPass, kFramebufferExtent,
+        kFramebufferHasDepthAttachment
+    );
+
+    m_ModelCompute->RecompileShaders();
+    m_Terrain->RecompileShaders();
 }
 
 // =============================================================================
 // GUI
 
+static void ShowComboBox(const char* name, 
+    const char* const items[], const uint32_t kItemCount,
+    const char* previewValue, uint32_t* pCurrentIndex);
+
 void WaterSurfaceMesh::ShowGUISettings()
 {
     if (ImGui::CollapsingHeader("Water Surface Settings",
@@ -796,6 +2986,9 @@ void WaterSurfaceMesh::ShowGUISettings()
 void WaterSurfaceMesh::ShowWaterSurfaceSettings()
 {
     static int tileRes = s_kWSResolutions.GetIndex(m_TileSize);
+    // Stepped by the frame budget, a size set here would be stepped again
+    if (m_ResolutionScaling)
+        tileRes = s_kWSResolutions.GetIndex(m_ModelTess->GetTileSize());
     const char* resName =
         (tileRes >= 0 && tileRes < s_kWSResolutions.size())
         ? s_kWSResolutions.strings[tileRes]
@@ -808,6 +3001,59 @@ void WaterSurfaceMesh::ShowWaterSurfaceSettings()
     static float phillipsA = m_ModelTess->GetPhillipsConst() * 1e7;
     static float damping = m_ModelTess->GetDamping();
     static float lambda = m_ModelTess->GetDisplacementLambda();
+    static int seed = static_cast<int>(m_ModelTess->GetSeed());
+
+    uint32_t backendIndex = s_kBackends.GetIndex(m_Backend);
+    ShowComboBox("Backend",
+                 s_kBackends.strings.data(),
+                 s_kBackends.size(),
+                 s_kBackends.strings[backendIndex],
+                 &backendIndex);
+    SetBackend(s_kBackends[backendIndex]);
+
+    uint32_t mapFormatIndex = s_kMapFormats.GetIndex(m_MapFormat);
+    ShowComboBox("Map Precision",
+                 s_kMapFormats.strings.data(),
+                 s_kMapFormats.size(),
+                 s_kMapFormats.strings[mapFormatIndex],
+                 &mapFormatIndex);
+    SetMapFormat(s_kMapFormats[mapFormatIndex]);
+
+    // Of the CPU waves, the shader takes finite differences of displacements
+    bool normalsFromDisplacement = m_NormalsFromDisplacement;
+    ImGui::Checkbox("Normals from Displacement", &normalsFromDisplacement);
+    SetNormalsFromDisplacement(normalsFromDisplacement);
+
+    // Of the CPU waves of the transformed normals, e.g., for foam
+    bool computeJacobian = m_ModelTess->IsComputingJacobian();
+    ImGui::Checkbox("Jacobian", &computeJacobian);
+    SetComputeJacobian(computeJacobian);
+
+    // Of the CPU waves uploaded to the maps
+    bool mapMipmaps = m_MapMipmaps;
+    ImGui::Checkbox("Map Mipmaps", &mapMipmaps);
+    SetMapMipmaps(mapMipmaps);
+
+    // Maps of the resolutions not bound are kept in it, for switching back
+    int mapBudgetMiB = static_cast<int>(m_FrameMapBudget >> 20);
+    ImGui::DragInt("Maps Budget", &mapBudgetMiB, 1.0f, 0, 4096, "%d MiB");
+    SetFrameMapBudget(static_cast<VkDeviceSize>(glm::max(mapBudgetMiB, 0))
+                      << 20);
+
+    // Plans and buffers of the resolutions switched away from
+    int tileCacheMiB =
+        static_cast<int>(m_ModelTess->GetTileCacheBudget() >> 20);
+    if (ImGui::DragInt("Simulation Cache", &tileCacheMiB, 1.0f, 0, 4096,
+                       "%d MiB"))
+    {
+        m_ModelTess->SetTileCacheBudget(
+            static_cast<size_t>(glm::max(tileCacheMiB, 0)) << 20);
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("%.1f MiB cached",
+                          m_ModelTess->GetTileCacheSize() / 1048576.0);
+    }
 
     ImGui::SliderInt("Patch Resolution", &tileRes, 0,
                      s_kWSResolutions.size() -1, resName);
@@ -829,6 +3075,15 @@ void WaterSurfaceMesh::ShowWaterSurfaceSettings()
                          "%.2f");
         ImGui::DragFloat("Damping factor", &damping, 0.0001f, 0.0f, 1.0f,
                          "%.4f");
+        // Of the random amplitudes, the same one gives the same surface
+        ImGui::InputInt("Seed", &seed);
+        ImGui::TreePop();
+    }
+
+    if ( ImGui::TreeNodeEx("Detail Cascades") )
+    {
+        if (m_Cascades->ShowGUISettings())
+            PrepareCascades();
         ImGui::TreePop();
     }
 
@@ -840,9 +3095,74 @@ void WaterSurfaceMesh::ShowWaterSurfaceSettings()
     }
 
     ImGui::Checkbox(" Play Animation ", &m_PlayAnimation);
+    ImGui::Checkbox(" Fixed time step ", &m_FixedTimeStep);
+
+    // Frames the CPU waves lag behind, computed meanwhile on the worker
+    int simLatency = static_cast<int>(m_Simulation->GetLatency());
+    if (ImGui::SliderInt("Simulation Latency", &simLatency, 0,
+                         WSSimulation::s_kMaxLatency, "%d frames"))
+    {
+        DrainSimulation();
+        m_Simulation->SetLatency(static_cast<uint32_t>(simLatency));
+        // Released waves may not have been copied to all the frames' maps
+        m_FrameMapNeedsUpdate = true;
+    }
+
+    float simRate = m_SimulationRate;
+    if (ImGui::SliderFloat("Simulation Rate", &simRate, 0.0f, 120.0f,
+                           simRate > 0.0f ? "%.0f Hz" : "Each frame"))
+    {
+        SetSimulationRate(simRate);
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Waves simulated at a fixed rate, interpolated "
+                          "between the last two steps");
+    }
+
+    if (ImGui::TreeNode("Simulation Threads"))
+    {
+        ShowThreadSettings();
+        ImGui::TreePop();
+    }
+
+    // Baked once released, not at each value dragged over
+    static int loopFrames = static_cast<int>(m_LoopFrameCount);
+    ImGui::SliderInt("Baked Loop", &loopFrames, 0, 256,
+                     loopFrames > 0 ? "%d frames" : "Off");
+    if (ImGui::IsItemDeactivatedAfterEdit())
+        SetLoopFrameCount(static_cast<uint32_t>(glm::max(loopFrames, 0)));
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Waves of one animation period baked into layers "
+                          "of map arrays, played back without simulating");
+    }
+
+    bool waveQueries = m_WaveQueries;
+    if (ImGui::Checkbox(" Wave Queries ", &waveQueries))
+        SetWaveQueries(waveQueries);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Waves kept for the CPU queries of heights, "
+                          "normals and velocities");
+    }
+    if (m_WaveQueries && m_Backend == Backend::Compute)
+    {
+        // Of the maps' size at most
+        int readbackRes = s_kWSResolutions.GetIndex(m_Readback->GetSize());
+        if (ImGui::SliderInt("Readback Size", &readbackRes, 0,
+                             s_kWSResolutions.size() - 1,
+                             s_kWSResolutions.strings[readbackRes]))
+        {
+            m_Readback->SetSize(s_kWSResolutions[readbackRes]);
+        }
+    }
 
     if (ImGui::Button("Apply"))
     {
+        // Model is modified below
+        DrainSimulation();
+
         const uint32_t kNewSize = s_kWSResolutions[tileRes];
         const bool kTileSizeChanged = kNewSize != m_ModelTess->GetTileSize();
 
@@ -865,6 +3185,8 @@ void WaterSurfaceMesh::ShowWaterSurfaceSettings()
             glm::epsilonNotEqual(damping,
                                  m_ModelTess->GetDamping(),
                                  0.001f);
+        const bool kSeedChanged =
+            static_cast<uint64_t>(seed) != m_ModelTess->GetSeed();
 
         const bool kNeedsPrepare =
             kTileSizeChanged ||
@@ -873,16 +3195,15 @@ void WaterSurfaceMesh::ShowWaterSurfaceSettings()
             kWindSpeedChanged ||
             kAnimationPeriodChanged ||
             kPhillipsConstChanged ||
-            kDampingChanged;
+            kDampingChanged ||
+            kSeedChanged;
 
         if (kTileSizeChanged)
         {
             m_ModelTess->SetTileSize(kNewSize);
 
-            const uint32_t kIndex =
-                s_kWSResolutions.GetIndex(m_ModelTess->GetTileSize());
-            m_CurFrameMap = &m_FrameMaps[kIndex];
-            SetDescriptorSetsDirty();
+            // Allocated by the next "PrepareRender()", if not yet
+            m_CurFrameMap = nullptr;
         }
 
         if (kNeedsPrepare)
@@ -894,17 +3215,142 @@ void WaterSurfaceMesh::ShowWaterSurfaceSettings()
             m_ModelTess->SetAnimationPeriod(animPeriod);
             m_ModelTess->SetPhillipsConst(phillipsA * 1e-7);
             m_ModelTess->SetDamping(damping);
-
-            m_ModelTess->Prepare();
+            m_ModelTess->SetSeed(static_cast<uint64_t>(seed));
+
+            if (m_Backend == Backend::Compute)
+            {
+                m_ModelTess->PrepareSpectrum();
+                m_ComputeNeedsPrepare = true;
+            }
+            else
+            {
+                m_ModelTess->Prepare();
+            }
+            m_Loop.needsBake = m_LoopFrameCount > 0;
             m_FrameMapNeedsUpdate = true;
         }
 
+        const bool kLambdaChanged =
+            glm::epsilonNotEqual(lambda, m_ModelTess->GetDisplacementLambda(),
+                                 0.001f);
         m_ModelTess->SetLambda(lambda);
+
+        // Of the primary's spectrum
+        if ((kNeedsPrepare || kLambdaChanged) &&
+            m_Cascades->GetPreparedCount() > 0)
+            PrepareCascades();
+        if (kNeedsPrepare || kLambdaChanged)
+            PrepareBodies();
+    }
+}
+
+void WaterSurfaceMesh::ShowThreadSettings()
+{
+    static vkp::ThreadPlacement::Settings settings =
+        vkp::ThreadPlacement::GetSettings();
+    const int kCpuCount =
+        static_cast<int>(vkp::ThreadPlacement::GetCpuCount());
+
+    ImGui::Text("CPUs: %d, NUMA nodes: %u, threads: %u", kCpuCount,
+                vkp::ThreadPlacement::GetNumaNodeCount(),
+                vkp::ThreadPlacement::GetThreadCount());
+
+    int threadCount = static_cast<int>(settings.threadCount);
+    if (ImGui::SliderInt("Thread Count", &threadCount, 0, kCpuCount,
+                         threadCount > 0 ? "%d" : "CPUs not reserved"))
+    {
+        settings.threadCount = static_cast<uint32_t>(threadCount);
+    }
+    int reservedCpus = static_cast<int>(settings.reservedCpus);
+    if (ImGui::SliderInt("Reserved CPUs", &reservedCpus, 0, kCpuCount - 1))
+        settings.reservedCpus = static_cast<uint32_t>(reservedCpus);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("First CPUs, of the main loop thread");
+
+    ImGui::Checkbox(" Pin Threads ", &settings.pin);
+    if (settings.pin)
+    {
+        ImGui::Checkbox(" NUMA First Touch ", &settings.firstTouch);
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("FFT inputs first written by the threads of "
+                              "their rows, allocated on their nodes");
+        }
+    }
+
+    if (ImGui::Button("Apply Threads"))
+        SetThreadPlacement(settings);
+}
+
+void WaterSurfaceMesh::ShowShadingRateSettings()
+{
+    bool reducedRate = m_VertexUBO.shadingRateMode != 0;
+    if (ImGui::Checkbox("Reduced Shading Rate", &reducedRate))
+        m_VertexUBO.shadingRateMode = reducedRate;
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Distant water shaded per 2x2 and 4x4 pixels, "
+                          "except its steep slopes and sun glints");
+    }
+    if (!reducedRate)
+        return;
+
+    ImGui::DragFloat2("Rate Distances",
+                      glm::value_ptr(m_VertexUBO.shadingRateDistances),
+                      1.0f, 0.0f, 10000.0f, "%.0f m");
+    m_VertexUBO.shadingRateDistances.y = glm::max(
+        m_VertexUBO.shadingRateDistances.x,
+        m_VertexUBO.shadingRateDistances.y);
+    ImGui::SliderFloat("Full Rate Glints", &m_VertexUBO.shadingRateSpecularCos,
+                       0.5f, 1.0f, "%.3f");
+    ImGui::SliderFloat("Full Rate Slope", &m_VertexUBO.shadingRateMaxSlope,
+                       0.0f, 1.0f, "%.2f");
+}
+
+void WaterSurfaceMesh::ShowResolutionSettings()
+{
+    static float budget = m_ResolutionScaler.GetSettings().budget;
+    bool scaling = m_ResolutionScaling;
+    if (ImGui::Checkbox("Frame Budget", &scaling))
+        SetFrameBudget(scaling ? budget : 0.0f);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Simulation and mesh resolutions stepped down, and "
+                          "back up to those set, to hold the budget");
     }
+    if (!scaling)
+        return;
+
+    if (ImGui::SliderFloat("Budget", &budget, 4.0f, 50.0f, "%.1f ms"))
+        SetFrameBudget(budget);
+
+    ImGui::Text("Simulation: %u of %u, mesh detail: %.2f",
+                m_ModelTess->GetTileSize(), m_MaxSimulationTileSize,
+                GetMeshDetail());
+    ImGui::Text("p95: %.2f ms CPU, %.2f ms GPU",
+                m_ResolutionScaler.GetSimulationTime(),
+                m_ResolutionScaler.GetGpuFrameTime());
 }
 
 void WaterSurfaceMesh::ShowMeshSettings()
 {
+    uint32_t gridModeIndex = s_kGridModes.GetIndex(m_GridMode);
+    ShowComboBox("Grid Vertices",
+                 s_kGridModes.strings.data(),
+                 s_kGridModes.size(),
+                 s_kGridModes.strings[gridModeIndex],
+                 &gridModeIndex);
+    SetGridMode(s_kGridModes[gridModeIndex]);
+
+    // Of a framebuffer with depth, the vertices are then processed twice
+    if (m_FramebufferHasDepth)
+        ImGui::Checkbox("Depth Pre-Pass", &m_DepthPrePass);
+
+    if (m_HasPrimitiveShadingRate && m_GridMode != GridMode::Tessellated)
+        ShowShadingRateSettings();
+
+    ShowResolutionSettings();
+
     static int tileRes = s_kWSResolutions.GetIndex(m_TileSize) +1;
     static float tileLength = WSTessendorf::s_kDefaultTileLength;
     static float vertexDist = tileLength / static_cast<float>(m_TileSize);
@@ -938,13 +3384,18 @@ void WaterSurfaceMesh::ShowMeshSettings()
             m_TileSize = tileSize;
             m_VertexDistance = vertexDist;
 
-            GenerateMeshVerticesIndices();
+            if (m_GridMode == GridMode::Vertices)
+                GenerateMeshVerticesIndices();
+            SetupGrids();
         }
 
         m_VertexUBO.scale = texScale;
     }
     ImGui::SameLine();
     ImGui::Checkbox("Auto apply", &autoApply);
+
+    if (WSGrid* grid = GetGrid(m_GridMode))
+        grid->ShowGUISettings();
 }
 
 static void ShowComboBox(const char* name, 
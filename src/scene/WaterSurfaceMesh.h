@@ -7,18 +7,39 @@
 #define WATER_SURFACE_RENDERING_SCENE_WATER_SURFACE_MESH_H_
 
 #include <vector>
+#include <deque>
 #include <memory>
+#include <map>
+#include <future>
 
 #include "vulkan/Device.h"
+#include "vulkan/CommandPool.h"
 #include "vulkan/Descriptors.h"
 #include "vulkan/ShaderModule.h"
 #include "vulkan/Buffer.h"
 #include "vulkan/Pipeline.h"
 #include "vulkan/Texture2D.h"
+#include "vulkan/Texture2DArray.h"
 
 #include "scene/Mesh.h"
+#include "scene/Camera.h"
+#include "scene/WSGridCDLOD.h"
+#include "scene/WSGridTessellated.h"
+#include "scene/WSGridTiled.h"
+#include "scene/WSGridProjected.h"
+#include "scene/WSGridBodies.h"
 #include "scene/WSTessendorf.h"
+#include "scene/WSTessendorfCompute.h"
+#include "scene/WSSimulation.h"
+#include "scene/WSCascades.h"
+#include "scene/WSBodies.h"
+#include "scene/WSLoopCache.h"
+#include "scene/WSMapReadback.h"
+#include "scene/WSResolutionScaler.h"
 #include "scene/SkyModel.h"
+#include "scene/TerrainMap.h"
+
+#include "core/Threads.h"
 
 #include "Gui.h"
 
@@ -26,7 +47,6 @@
 /**
  * EXPERIMENTAL
  *  FIXME: incorrect layout when changing to uninitialized frame map pair without animation on
- *  TODO: should be on dedicated thread
  * @brief Enable for double buffered textures: two sets of textures, one used for
  *  copying to, the other for rendering to, at each frame they are swapped.
  * For the current use-case, the performance might be slightly worse.
@@ -41,37 +61,102 @@ class WaterSurfaceMesh
 {
 public:
     struct Vertex;
+    using GridMesh = Mesh<Vertex, uint16_t>;
+
+    static constexpr uint16_t s_kPrimitiveRestartIndex{ UINT16_MAX };
 
     static const uint32_t s_kMinTileSize{ 16 };
     static const uint32_t s_kMaxTileSize{ 1024 };
+    /// Of the simulation's first frames, @see SetProgressiveStart()
+    static const uint32_t s_kProgressiveTileSize{ 64 };
+
+    /** @brief Where the waves of the model are computed */
+    enum class Backend
+    {
+        FFTW = 0,   ///< On the CPU, then copied to the maps
+        Compute,    ///< In compute shaders, directly into the maps
+    };
+
+    /** @brief How the vertices of the grid are specified */
+    enum class GridMode
+    {
+        Vertices = 0,   ///< Read from the vertex and index buffers
+        Procedural,     ///< Derived from the vertex index, without buffers
+        CDLOD,          ///< Patch instances of a quadtree, by the distance
+        Tessellated,    ///< Coarse patches, subdivided by the screen size
+        Tiled,          ///< Instances of the grid around the camera, culled
+        Projected,      ///< Grid of the screen projected onto the water plane
+        Bodies,         ///< Instances of the water bodies, @see WSBodies
+    };
 
 public:
     /**
      * @brief Creates vertex and index buffers to accomodate maximum size of
      *  vertices and indices.
      *  To render the mesh, fnc "Prepare()" must be called with the size of tile
+     * @param viewCount Of the render pass, its pipelines draw each of the
+     *  views of the camera, @see "vkp::RenderPass::SetViewCount()"
     */
     WaterSurfaceMesh(const vkp::Device& device,
-                     const vkp::DescriptorPool& descriptorPool);
+                     const vkp::DescriptorPool& descriptorPool,
+                     uint32_t viewCount = 1);
     ~WaterSurfaceMesh();
 
+    /**
+     * @param kImageCount Number of the frames in flight, indexing
+     *  the per-frame resources
+     */
     void CreateRenderData(
         VkRenderPass renderPass,
         const uint32_t kImageCount,
         const VkExtent2D kFramebufferExtent,
         const bool kFramebufferHasDepthAttachment);
 
+    /**
+     * @brief Of the framebuffer resized, of the same render pass: pipelines
+     *  are of dynamic viewport and scissor, only the sizes of the screen-space
+     *  grids and edges are updated
+     */
+    void SetFramebufferExtent(const VkExtent2D& extent);
+
+    /**
+     * @brief Of the first frames at a low resolution, while the model is
+     *  prepared at the set one on another thread, switched to by "Update()"
+     *  once ready. Of the FFTW backend without a baked loop only
+     * @pre Called before "PrepareModel()"
+     */
+    void SetProgressiveStart(bool enable) { m_ProgressiveStart = enable; }
+
+    /**
+     * @brief Prepares the spectrum and the plans of FFTW, the part of
+     *  "Prepare()" on the CPU only, e.g., on another thread while the other
+     *  assets are created. Of a progressive start, the model at the full
+     *  resolution is prepared apart, then
+     * @pre Called before "Prepare()", on the thread placed as the main one
+     */
+    void PrepareModel();
     void Prepare(VkCommandBuffer cmdBuffer);
 
+    /**
+     * @brief Of both the grid and the simulation, of the same side length,
+     *  e.g., of the command line
+     * @param size Power of two, within [s_kMinTileSize, s_kMaxTileSize]
+     * @pre Called before "Prepare()"
+     * @return False if of an invalid size
+     */
+    bool SetTileSize(uint32_t size);
+
     void Update(float dt);
 
+    /**
+     * @brief Updates the frame's data, and skips the parts of the grid out of
+     *  the camera's frustum, by their bounds grown by the waves
+     */
     void PrepareRender(
         const uint32_t frameIndex,
         VkCommandBuffer cmdBuffer,
-        const glm::mat4& viewMat,
-        const glm::mat4& projMat,
-        const glm::vec3& camPos,
-        const SkyModel::Params& skyParams
+        const vkp::Camera& camera,
+        const SkyModel& sky
     );
  
     void Render(
@@ -81,11 +166,85 @@ public:
     // @pre Called inside ImGui Window scope
     void ShowGUISettings();
 
+    /**
+     * @brief Rebuilds the pipelines of the edited shaders on a worker thread,
+     *  the current ones keep rendering. They are swapped by the first
+     *  "PrepareRender()" after being built, then destroyed once the frames
+     *  using them are done. Ignored while a rebuild is pending
+     */
     void RecompileShaders(
         VkRenderPass renderPass,
         const VkExtent2D kFramebufferExtent,
         const bool kFramebufferHasDepthAttachment);
 
+    /**
+     * @return Semaphore signaled by the upload of the maps on the transfer
+     *  queue by the last "PrepareRender()", the graphics submission of the
+     *  frame must wait on it. Null if there was no such upload.
+     */
+    VkSemaphore GetMapUploadSemaphore() const { return m_MapUploadSemaphore; }
+
+    /**
+     * @return True if the next frames are the same unless the settings
+     *  change: the animation is paused, no maps or pipelines are pending
+     */
+    bool IsStatic() const;
+
+    /**
+     * @brief Draws the main pass by the overdraw pipelines, adding a constant
+     *  color per shaded fragment, @see "shaders/Overdraw.frag"
+     */
+    void SetShowOverdraw(bool showOverdraw) { m_ShowOverdraw = showOverdraw; }
+
+    /**
+     * @brief Bakes the waves of the FFTW backend over one animation period,
+     *  after which they repeat, into layers of map arrays by the next
+     *  "PrepareRender()". Frames then interpolate the two layers around
+     *  their time, nothing is simulated. Baked again once the model or the
+     *  map format changes
+     * @param count Of the layers, 0 simulates the waves again
+     */
+    void SetLoopFrameCount(uint32_t count);
+    uint32_t GetLoopFrameCount() const { return m_LoopFrameCount; }
+    /**
+     * @brief File the baked waves are mapped from, if of the same model and
+     *  frames, else written to once baked, @see WSLoopCache
+     * @param path Empty to bake each time
+     */
+    void SetLoopCachePath(const std::filesystem::path& path) {
+        m_LoopCachePath = path;
+    }
+
+    /**
+     * @brief Keeps the waves for "QueryWaves()": snapshots of those of the
+     *  FFTW backend, or copies of the displacement maps of the GPU backend,
+     *  read back after the frames in flight, @see WSMapReadback
+     */
+    void SetWaveQueries(bool enable);
+    bool HasWaveQueries() const { return m_WaveQueries; }
+
+    /** @brief Of the model's tile, @see WSTessendorf::QueryWaves() */
+    bool QueryWaves(const glm::vec2* points,
+                    size_t count,
+                    WSTessendorf::WaterSample* samples) const {
+        return m_ModelTess->QueryWaves(points, count, samples);
+    }
+
+    /**
+     * @brief Steps the size of the simulation and the detail of the mesh,
+     *  of the CDLOD and tessellated grids, to hold a frame-time budget,
+     *  @see WSResolutionScaler. Each is up to its resolution when enabled,
+     *  the tile cache of the model keeps the switches seamless
+     * @param budget In ms, 0 disables the scaling, the resolutions are kept
+     */
+    void SetFrameBudget(float budget);
+    float GetFrameBudget() const {
+        return m_ResolutionScaling ? m_ResolutionScaler.GetSettings().budget
+                                   : 0.0f;
+    }
+    /** @param ms Of a frame on the GPU, from its first to last timestamp */
+    void AddGpuFrameTime(float ms);
+
 private:
     // TODO batch 
 
@@ -93,40 +252,228 @@ private:
     void GenerateMeshVerticesIndices();
     void UpdateMeshBuffers(VkCommandBuffer cmdBuffer);
 
+    /**
+     * @brief Creates the grid vertices and indices if read from buffers,
+     *  otherwise frees them
+     */
+    void SetGridMode(GridMode mode);
+
     void PrepareModelTess(VkCommandBuffer cmdBuffer);
+    void SetBackend(Backend backend);
+    /**
+     * @brief Selects whether the FFTW backend skips the transforms of the
+     *  slopes and the derivatives, the vertex shader then reconstructs the
+     *  normals and the Jacobian from the displacement map. Maps are
+     *  recreated, without the normal maps, by the next "PrepareRender()"
+     */
+    void SetNormalsFromDisplacement(bool enable);
+    /**
+     * @brief Selects whether the FFTW backend also transforms the cross
+     *  derivatives of the displacements, for the Jacobian in the fourth
+     *  component of the displacement map, otherwise it is 1. Only with the
+     *  normals transformed
+     */
+    void SetComputeJacobian(bool enable);
+    /** @brief Maps are recreated by the next "PrepareRender()" call */
+    void SetMapFormat(VkFormat format);
+    /**
+     * @brief Selects whether the maps of the FFTW backend have mipmaps,
+     *  blitted on the graphics queue after each upload. Maps are recreated
+     *  by the next "PrepareRender()" call
+     */
+    void SetMapMipmaps(bool enable);
+    /**
+     * @brief Simulates the waves of the FFTW backend at a fixed rate, the
+     *  frames in between interpolate the last two of them, one step behind.
+     *  Maps are recreated, with the second ones, by the next "PrepareRender()"
+     * @param rate In Hz of real time, 0 simulates the waves of each frame
+     */
+    void SetSimulationRate(float rate);
+    float GetSimulationRate() const { return m_SimulationRate; }
+    /**
+     * @brief Places the threads of the simulation and the main loop thread,
+     *  the plans of the FFTW models are created again of the thread count
+     * @pre Called on the main loop thread
+     */
+    void SetThreadPlacement(const vkp::ThreadPlacement::Settings& settings);
+    /** @brief Recreates the maps in the current format */
+    void UpdateMapFormat(VkCommandBuffer cmdBuffer);
 
     void ShowWaterSurfaceSettings();
+    void ShowThreadSettings();
     void ShowLightingSettings();
     void ShowMeshSettings();
+    void ShowShadingRateSettings();
+    void ShowResolutionSettings();
+
+    /** @brief Applies the step of the frame budget, if any, on its window */
+    void UpdateResolutionScaling();
+    /**
+     * @brief Of a progressive start, switches to the model prepared at the
+     *  full resolution once ready, unless of another resolution set meanwhile
+     */
+    void UpdateProgressiveStart();
+    /**
+     * @brief Of the simulation only, at runtime, the grid is kept. Maps of
+     *  the size are allocated by the next "PrepareRender()", if not yet
+     */
+    void SetSimulationTileSize(uint32_t size);
+    /** @brief Of the CDLOD ranges and the tessellated edges, 0 is the finest */
+    void SetMeshDetailLevel(uint32_t level);
+    /** @return Scale of the mesh's vertex density, halved every 2 levels */
+    float GetMeshDetail() const {
+        return glm::exp2(-0.5f * static_cast<float>(m_MeshDetailLevel));
+    }
+    /** @return Whether a coarser level reduces the mesh of the grid mode */
+    bool CanCoarsenMesh() const;
 
     void UpdateUniformBuffer(const uint32_t imageIndex);
+    /**
+     * @brief Flags the grid, and the chunks of its mesh, intersecting
+     *  the frustum, of the Procedural and Vertices modes
+     */
+    void UpdateGridVisibility(const vkp::Camera& camera);
+    /** @brief Of the grid's size, or the mesh's detail, of each WSGrid */
+    void SetupGrids();
+
+    /** @return Bounds of the last acquired waves */
+    WSGrid::DisplacementBounds GetDisplacementBounds() const;
     void UpdateDescriptorSets();
     void UpdateDescriptorSet(const uint32_t frameIndex);
     void SetDescriptorSetsDirty();
 
     void CreateDescriptorSetLayout();
     void CreateUniformBuffers(const uint32_t kBufferCount);
-    void SetupPipeline();
+    /** @brief Pass of the grid's pipelines, of the same vertex stages */
+    enum class Pass
+    {
+        Shaded,
+        Depth,      ///< Of the pre-pass, without color writes
+        Overdraw    ///< Adds a constant color per fragment, @see SetShowOverdraw
+    };
+
+    struct PipelineJob
+    {
+        GridMode mode;
+        bool readsMapBuffer;
+        Pass pass;
+        std::unique_ptr<vkp::Pipeline>* pipeline;   ///< Of m_Pipelines
+    };
+    /** @return Of all the pipelines of the supported grid modes */
+    std::vector<PipelineJob> GetPipelineJobs();
+
+    /**
+     * @brief Sets up the pipelines of all the supported grid modes,
+     *  compiling their shaders concurrently, joined before returning
+     */
+    void SetupPipelines();
+
+    /**
+     * @brief Sets up and creates the pipelines of the jobs, of the edited
+     *  shaders that compile, called on a worker thread
+     * @return For each job, null if its pipeline is kept
+     */
+    std::vector<std::unique_ptr<vkp::Pipeline>> RebuildPipelines(
+        const std::vector<PipelineJob>& jobs,
+        VkRenderPass renderPass,
+        VkExtent2D framebufferExtent,
+        bool framebufferHasDepthAttachment) const;
+    /**
+     * @brief Swaps in the rebuilt pipelines, if built, the replaced ones are
+     *  retired
+     * @param wait Whether to wait for the worker
+     */
+    void ApplyPipelineRebuild(bool wait);
+    /** @brief Destroys the retired pipelines of the done frames */
+    void ReleaseRetiredPipelines();
+    std::unique_ptr<vkp::Pipeline> SetupPipeline(
+        GridMode gridMode,
+        bool readsMapBuffer,
+        Pass pass) const;
+    /**
+     * @param ratesPrimitives Of the shading rates of the vertex stage
+     * @param isMultiview Of the views' matrices, of a multiview pass
+     */
+    std::vector<vkp::ShaderInfo> GetShaderInfos(GridMode gridMode,
+                                                bool readsMapBuffer,
+                                                Pass pass,
+                                                bool ratesPrimitives,
+                                                bool isMultiview) const;
     void CreateDescriptorSets(const uint32_t kCount);
 
     std::vector<
         std::shared_ptr<vkp::ShaderModule>
     > CreateShadersFromShaderInfos(const vkp::ShaderInfo* kShaderInfos,
                                    const uint32_t kShaderInfoCount) const;
+    /** @brief Creates all the set up pipelines concurrently */
     void CreatePipeline(
         const VkExtent2D& framebufferExtent,
         VkRenderPass renderPass,
         bool framebufferHasDepthAttachment);
+    /** @return All the set up pipelines, of every grid mode */
+    std::vector<vkp::Pipeline*> GetPipelines() const;
 
     void CreateTessendorfModel();
+    /**
+     * @brief Creates the detail cascades of the settings, with the spectrum
+     *  of m_ModelTess, their maps are bound by the next "PrepareRender()"
+     */
+    void PrepareCascades();
+    /**
+     * @brief Creates the simulations of the water bodies, with the spectrum
+     *  of m_ModelTess, their maps are bound by the next "PrepareRender()"
+     */
+    void PrepareBodies();
+    void CreateComputeModel();
 
     void CreateMesh();
+    /**
+     * @brief Creates the vertex, index and their staging buffers, sized for
+     *  a grid of 'kTileSize' quads per side
+     */
+    void CreateMeshBuffers(const uint32_t kTileSize);
+    /**
+     * @brief Reallocates the mesh buffers if the set vertices and indices
+     *  do not fit, or take up less than a quarter of them
+     */
+    void ReserveMeshBuffers();
     std::vector<Vertex> CreateGridVertices(const uint32_t kTileSize,
                                            const float kScale);
-    std::vector<uint32_t> CreateGridIndices(const uint32_t kTileSize);
+    /**
+     * @brief Creates row-pair triangle strips, separated by primitive restart,
+     *  of each chunk of rows, relative to the chunk's first vertex
+     */
+    std::vector<uint16_t> CreateGridIndices(const uint32_t kTileSize);
+    std::vector<GridMesh::Chunk> CreateGridChunks(const uint32_t kTileSize);
+
+    void CreateMapStagingBuffer(const uint32_t kImageCount);
+    /**
+     * @brief Reallocates the map staging buffer if the maps of the current
+     *  resolution and format do not fit a slice, or take up less than
+     *  a quarter of it
+     * @return True if reallocated, the waves in flight were discarded
+     */
+    bool ReserveMapStagingBuffer();
+    /** @return Size of a slice for the current resolution and map format */
+    VkDeviceSize GetMapStagingSliceSize() const;
+    void CreateTransferResources(const uint32_t kCount);
+    void DestroyTransferSemaphores();
 
-    void CreateStagingBuffer();
-    void CreateFrameMaps(VkCommandBuffer cmdBuffer);
+    struct FrameMapPair;
+
+    /**
+     * @brief Binds the maps of the model's resolution, creates them if not
+     *  yet allocated, then frees the least recently used others over budget
+     */
+    void SelectFrameMaps(VkCommandBuffer cmdBuffer);
+    void CreateFrameMaps(VkCommandBuffer cmdBuffer, FrameMapPair& pair,
+                         const uint32_t kSize);
+    /** @brief Frees the maps of all the resolutions, waits for the device */
+    void DestroyFrameMaps();
+    /** @brief Frees the least recently used maps, except 'kKept' */
+    void EvictFrameMaps(const FrameMapPair& kKept);
+    /** @param budget In bytes, applied by the next "PrepareRender()" */
+    void SetFrameMapBudget(VkDeviceSize budget);
     std::unique_ptr<vkp::Texture2D> CreateMap(
         VkCommandBuffer cmdBuffer,
         const uint32_t kSize,
@@ -135,28 +482,138 @@ private:
 
     struct FrameMapData;
 
+    /** @param kSlice Slice of the map staging buffer to copy from */
     void UpdateFrameMaps(
         VkCommandBuffer cmdBuffer,
-        FrameMapData& frame);
-    void CopyModelTessDataToStagingBuffer();
+        FrameMapData& frame,
+        const uint32_t kSlice);
+    /**
+     * @brief Submits the copy of a slice of the map staging buffer to the
+     *  transfer queue, records the acquire of the maps to 'cmdBuffer'
+     * @pre The maps were last read by the frame's previous submission
+     */
+    void SubmitFrameMapsUpload(
+        const uint32_t frameIndex,
+        VkCommandBuffer cmdBuffer,
+        FrameMapData& frame,
+        const uint32_t kSlice);
+    /**
+     * @brief Requests the waves at the current time from the simulation,
+     *  acquires the ones of 'kLatency' frames ago, if there are any
+     */
+    void UpdateWaves(uint32_t latency);
+    void ReleaseWaves();
+    /** @brief Discards the waves in flight, before the model is modified */
+    void DrainSimulation();
+    /**
+     * @return Weight of the current waves, against the previous ones, of
+     *  the time of the frame. 1 if not interpolated
+     */
+    float GetWavesBlend() const;
+    /** @return Animation time between the simulated waves of a fixed rate */
+    float GetSimulationStep() const {
+        return m_AnimSpeed / m_SimulationRate;
+    }
+    /**
+     * @brief Updates the frame's pair of maps to the current and the
+     *  previous waves, uploading only those not in either of them
+     * @return Weight of the second maps, of the push constants
+     */
+    float UpdateBlendedFrameMaps(
+        const uint32_t frameIndex,
+        VkCommandBuffer cmdBuffer,
+        FrameMapData& frame,
+        FrameMapData& blendFrame);
+
+    /**
+     * @brief Computes the waves of each layer of the period at once, into
+     *  a staging buffer released once the frame is done, and records their
+     *  upload into the map arrays
+     */
+    void BakeLoop(const uint32_t frameIndex, VkCommandBuffer cmdBuffer);
+    /** @return Layer of the time, its fraction is toward the next layer */
+    float GetLoopPosition() const;
+
+    /**
+     * @return Slice the simulation may write to: not computed into, and not
+     *  read by a frame still in flight
+     */
+    uint32_t FindFreeMapStagingSlice() const;
+    /** @return The slice, in the map format, as outputs of the model */
+    WSTessendorf::Outputs GetMapStagingOutputs(const uint32_t kSlice) const;
+
+    /**
+     * @brief Whether the waves are uploaded on the dedicated transfer queue,
+     *  the mipmaps are blitted on the graphics one, after the upload there
+     */
+    bool UsesTransferQueue() const {
+        return m_HasTransferQueue && m_Backend == Backend::FFTW &&
+               !UsesMapMipmaps();
+    }
+    /** @brief Whether the maps have mipmaps, of the waves uploaded to them */
+    bool UsesMapMipmaps() const {
+        return m_MapMipmaps && m_Backend == Backend::FFTW && !UsesMapBuffer();
+    }
+    /** @brief Whether the normal maps are computed, else reconstructed */
+    bool UsesNormalMap() const {
+        return !m_NormalsFromDisplacement || m_Backend != Backend::FFTW;
+    }
+    /** @brief Whether the grid mode has its pipelines on this device */
+    bool SupportsGridMode(GridMode mode) const {
+        return mode != GridMode::Tessellated || m_HasTessellation;
+    }
+    /** @brief Whether the waves are sampled from the baked period */
+    bool UsesBakedLoop() const {
+        return m_LoopFrameCount > 0 && m_Backend == Backend::FFTW;
+    }
+    /** @brief Whether the waves are simulated at a fixed rate, interpolated */
+    bool UsesFixedRate() const {
+        return m_SimulationRate > 0.0f && m_Backend == Backend::FFTW &&
+               !UsesBakedLoop();
+    }
+    /** @brief Whether the vertex shader reads the waves from the map buffer */
+    bool UsesMapBuffer() const {
+        return m_HasMapBuffer && m_Backend == Backend::FFTW &&
+               !UsesBakedLoop();
+    }
+    /** @return Number of maps of each resolution */
+    uint32_t GetFrameMapCount() const;
+    /** @return Index of the maps the frame renders with */
+    uint32_t GetFrameMapIndex(const uint32_t frameIndex) const;
 
     uint32_t GetTotalVertexCount(const uint32_t kTileSize) const {
         return (kTileSize+1) * (kTileSize+1);
     }
 
-    uint32_t GetTotalIndexCount(const uint32_t kTotalVertexCount) const
+    uint32_t GetTotalIndexCount(const uint32_t kTileSize) const
     {
         const uint32_t kIndicesPerTriangle = 3, kTrianglesPerQuad = 2;
-        return kTotalVertexCount * kIndicesPerTriangle * kTrianglesPerQuad;
+        return kTileSize * kTileSize * kIndicesPerTriangle * kTrianglesPerQuad;
+    }
+
+    /** @return Number of strip indices, including the primitive restarts */
+    uint32_t GetTotalStripIndexCount(const uint32_t kTileSize) const {
+        return kTileSize * (2 * (kTileSize+1) + 1);
     }
 
-    static uint32_t GetMaxVertexCount() {
-        return (s_kMaxTileSize+1) * (s_kMaxTileSize+1);
+    /**
+     * @return Number of rows of quads of a chunk, so that its vertices are
+     *  addressed by 16-bit indices, the restart index aside
+     */
+    static uint32_t GetGridChunkRowCount(const uint32_t kTileSize) {
+        const uint32_t kMaxVertexCount = s_kPrimitiveRestartIndex;
+        return std::min(kMaxVertexCount / (kTileSize+1) - 1, kTileSize);
     }
-    static uint32_t GetMaxIndexCount()
+
+    /**
+     * @return Whether a buffer of 'kCapacity' bytes is reallocated to hold
+     *  'kSize' bytes: grown when too small, shrunk only when below a quarter,
+     *  so that switching between neighbouring resolutions does not reallocate
+     */
+    static bool NeedsRealloc(const VkDeviceSize kCapacity,
+                             const VkDeviceSize kSize)
     {
-        const uint32_t kIndicesPerTriangle = 3, kTrianglesPerQuad = 2;
-        return GetMaxVertexCount() * kIndicesPerTriangle * kTrianglesPerQuad;
+        return kSize > kCapacity || kSize * 4 <= kCapacity;
     }
 
 private:
@@ -167,75 +624,324 @@ private:
 
     // =========================================================================
 
-    static const inline std::array<vkp::ShaderInfo, 2> s_kShaderInfos {
-        vkp::ShaderInfo{
-            .paths = { "shaders/WaterSurfaceMesh.vert" },
-            .stage = VK_SHADER_STAGE_VERTEX_BIT,
-            .isSPV = false
-        },
-        vkp::ShaderInfo{
-            .paths = { "shaders/WaterSurfaceMesh.frag" },
-            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .isSPV = false
-        }
-    };
-
     std::unique_ptr<vkp::DescriptorSetLayout> m_DescriptorSetLayout{ nullptr };
 
     struct DescriptorSet
     {
         bool            isDirty{ true };
         VkDescriptorSet set    { VK_NULL_HANDLE };
+        // Of the map buffer, read by the frame at a dynamic offset
+        uint32_t        mapSlice{ 0 };
+        // Of the second maps, of the previous waves at a fixed rate
+        uint32_t        blendSlice{ 0 };
+        // Of the maps of the baked period, the second ones of the next layer
+        uint32_t        loopLayer{ 0 };
     };
     std::vector<DescriptorSet> m_DescriptorSets;
 
+    // Of a set, at the offsets of the template's entries
+    struct DescriptorInfos
+    {
+        VkDescriptorBufferInfo vertexUBO;
+        VkDescriptorBufferInfo waterSurfaceUBO;
+        VkDescriptorImageInfo  maps[2];
+        VkDescriptorBufferInfo mapBuffers[2];
+        VkDescriptorImageInfo  cascadeMaps[2][WSCascades::s_kMaxCount];
+        VkDescriptorImageInfo  skyLut;
+        VkDescriptorImageInfo  terrainMap;
+        VkDescriptorImageInfo  blendMaps[2];
+        VkDescriptorBufferInfo blendMapBuffers[2];
+        VkDescriptorImageInfo  bodyMaps[2];
+    };
+    // Writes all the bindings of a set at once
+    std::unique_ptr<vkp::DescriptorUpdateTemplate> m_DescriptorTemplate{
+        nullptr
+    };
+
     std::vector<vkp::Buffer> m_UniformBuffers;
 
-    std::unique_ptr<vkp::Pipeline> m_Pipeline{ nullptr };
+    struct GridPipelines
+    {
+        std::unique_ptr<vkp::Pipeline> sampled{ nullptr };
+        // Reads the maps from the map buffer, if the device has one
+        std::unique_ptr<vkp::Pipeline> mapBuffer{ nullptr };
+        // Of the depth pre-pass, of the same vertices
+        std::unique_ptr<vkp::Pipeline> depthSampled{ nullptr };
+        std::unique_ptr<vkp::Pipeline> depthMapBuffer{ nullptr };
+        // Of the overdraw heatmap, in place of the main pass
+        std::unique_ptr<vkp::Pipeline> overdrawSampled{ nullptr };
+        std::unique_ptr<vkp::Pipeline> overdrawMapBuffer{ nullptr };
+    };
+    std::map<GridMode, GridPipelines> m_Pipelines;
+
+    // Of the pending rebuild, @see RecompileShaders()
+    std::vector<PipelineJob> m_RebuildJobs;
+    std::future<std::vector<std::unique_ptr<vkp::Pipeline>>> m_RebuiltPipelines;
+
+    struct RetiredPipelines
+    {
+        std::vector<std::unique_ptr<vkp::Pipeline>> pipelines;
+        // Of the graphics timeline when retired, of the last frame using them
+        uint64_t submitValue;
+    };
+    std::vector<RetiredPipelines> m_RetiredPipelines;
+
+    /**
+     * @return Pipeline of the grid mode, reading the maps as bound
+     */
+    const vkp::Pipeline& GetPipeline(Pass pass = Pass::Shaded) const;
+
+    /** @brief Records the draw of the grid mode, the pipeline is bound */
+    void RecordDraw(const uint32_t frameIndex, VkCommandBuffer cmdBuffer);
+
+    // Depth of the grid is drawn first by a depth-only pass, the main pass then
+    //  shades only the nearest fragments, once per pixel
+    bool m_DepthPrePass{ false };
+    bool m_FramebufferHasDepth{ false };
+
+    bool UsesDepthPrePass() const {
+        return m_DepthPrePass && m_FramebufferHasDepth;
+    }
+
+    bool m_ShowOverdraw{ false };
 
     // =========================================================================
     // Mesh properties
-    std::unique_ptr< Mesh<Vertex> > m_Mesh{ nullptr };
+    std::unique_ptr<GridMesh> m_Mesh{ nullptr };
 
+    GridMode m_GridMode{ GridMode::Procedural };
     uint32_t m_TileSize  { WSTessendorf::s_kDefaultTileSize };
     float m_VertexDistance{ WSTessendorf::s_kDefaultTileLength /
                             static_cast<float>(WSTessendorf::s_kDefaultTileSize) };
+
+    // Grid modes of their own instances and draws, @see GetGrid()
+    std::unique_ptr<WSGridCDLOD> m_CDLODGrid{ nullptr };
+    std::unique_ptr<WSGridTessellated> m_TessellatedGrid{ nullptr };
+    std::unique_ptr<WSGridTiled> m_TiledGrid{ nullptr };
+    std::unique_ptr<WSGridProjected> m_ProjectedGrid{ nullptr };
+    // Of the rectangles and the layers of m_Bodies
+    std::unique_ptr<WSGridBodies> m_BodiesGrid{ nullptr };
+
+    /** @return Of the grid mode, null if drawn by the mesh itself */
+    WSGrid* GetGrid(GridMode mode) const;
+    /** @return All the grids of their own */
+    std::vector<WSGrid*> GetGrids() const;
+
+    // Coarser levels scale both the LOD ranges and the tessellated edges
+    static constexpr uint32_t s_kMaxMeshDetailLevel{ 4 };
+    uint32_t m_MeshDetailLevel{ 0 };
+    // Of the last frame, whether the single grid is in the frustum, and
+    //  which chunks of its mesh are
+    bool m_GridIsVisible{ true };
+    std::vector<bool> m_VisibleChunks;
+
+    // Device supports the tessellation stages, then it is the default grid
+    bool m_HasTessellation{ false };
+    // Vertex stage of the shaded pass writes the rates of the primitives,
+    //  the tessellation evaluation stage cannot
+    bool m_HasPrimitiveShadingRate{ false };
+    // Of the multiview pass, each vertex is transformed by all the views
+    uint32_t m_ViewCount{ 1 };
+
+    /** @return Stages reading the vertex uniforms, and the maps */
+    VkShaderStageFlags GetVertexStageFlags() const;
+    VkShaderStageFlags GetMapStageFlags() const;
+    /** @return Of "GetMapStageFlags()", waiting for the copies to the maps */
+    VkPipelineStageFlags GetMapPipelineStages() const;
+
     // Model properties
     std::unique_ptr<WSTessendorf> m_ModelTess{ nullptr };
+    std::unique_ptr<WSTessendorfCompute> m_ModelCompute{ nullptr };
+    // Computes the waves of m_ModelTess for the FFTW backend, destroyed first
+    std::unique_ptr<WSSimulation> m_Simulation{ nullptr };
+    // Added to the waves of m_ModelTess, none by default
+    std::unique_ptr<WSCascades> m_Cascades{ nullptr };
+    // Of the maps of the GPU backend, published to the queries of m_ModelTess
+    std::unique_ptr<WSMapReadback> m_Readback{ nullptr };
+    bool m_WaveQueries{ false };
+    // Of the frame budget, the simulation is up to m_MaxSimulationTileSize,
+    //  the size it was enabled at
+    WSResolutionScaler m_ResolutionScaler;
+    bool m_ResolutionScaling{ false };
+    uint32_t m_MaxSimulationTileSize{ WSTessendorf::s_kDefaultTileSize };
+
+    // Of the full resolution, prepared on another thread while the first
+    //  frames are of s_kProgressiveTileSize, @see SetProgressiveStart()
+    bool m_ProgressiveStart{ false };
+    uint32_t m_ProgressiveTargetSize{ 0 };
+    std::future<std::unique_ptr<WSTessendorf>> m_FullResolutionModel;
+    // Of the cascades' maps, after those of the map buffer, even if not bound
+    static constexpr uint32_t s_kCascadeMapsBinding{ 6 };
+
+    // Of the sky's luminance, reflected by the surface, owned by the sky
+    const vkp::Texture2D* m_SkyLut{ nullptr };
+    static constexpr uint32_t s_kSkyLutBinding{ s_kCascadeMapsBinding + 2 };
+
+    // Below the surface, seen through it, baked by the first "PrepareRender()"
+    std::unique_ptr<TerrainMap> m_Terrain{ nullptr };
+    static constexpr uint32_t s_kTerrainMapBinding{ s_kSkyLutBinding + 1 };
+    // Second maps interpolated with the first ones, the same if none. Those
+    //  of the map buffer follow them, if any
+    static constexpr uint32_t s_kBlendMapsBinding{ s_kTerrainMapBinding + 1 };
+    static constexpr uint32_t s_kBlendMapBuffersBinding{
+        s_kBlendMapsBinding + 2
+    };
+    // Water areas of their own waves, their maps are always bound, the waves
+    //  advance only while drawn
+    std::unique_ptr<WSBodies> m_Bodies{ nullptr };
+    static constexpr uint32_t s_kBodyMapsBinding{
+        s_kBlendMapBuffersBinding + 2
+    };
+    // Acquired from the simulation, kept until superseded, to be copied to
+    //  the maps of each frame, from the first of m_SimulationSlices
+    const WSSimulation::Waves* m_Waves{ nullptr };
+    // Of the acquired waves, the maps store the one they were last updated to
+    uint64_t m_WavesId{ 0 };
+    // Of the waves in the staging buffer
+    float m_WavesMinHeight{ -1.0f };
+    float m_WavesMaxHeight{ 1.0f };
+
+    Backend m_Backend{ Backend::FFTW };
+    // Whether the compute backend needs the model's spectrum re-uploaded
+    bool m_ComputeNeedsPrepare{ true };
 
     bool m_PlayAnimation{ true };
     float m_TimeCtr  { 0.0 };
     float m_AnimSpeed{ 3.0 };
 
+    // Advances the animation by a fixed step each frame, instead of the frame
+    //  time, lets the model rotate its phasors incrementally
+    bool m_FixedTimeStep{ false };
+    static constexpr float s_kFixedTimeStep{ 1.0f / 60.0f };
+
+    // Waves of the FFTW backend simulated at a fixed rate, in Hz, instead of
+    //  each frame, @see SetSimulationRate()
+    float m_SimulationRate{ 0.0f };
+    // Animation time of the last submitted waves, ahead of m_TimeCtr by up
+    //  to a step of the fixed rate
+    float m_SimulationTime{ 0.0f };
+    // Of the acquired waves
+    float m_WavesTime{ 0.0f };
+
+    // Waves acquired before m_Waves, interpolated from at a fixed rate. Their
+    //  slice is not written again until superseded
+    struct PrevWaves
+    {
+        uint64_t id{ 0 };           ///< Zero if none
+        uint32_t slice{ UINT32_MAX };
+        float time{ 0.0f };
+        float minHeight{ -1.0f };
+        float maxHeight{ 1.0f };
+    };
+    PrevWaves m_PrevWaves;
+
+    // Layers of one animation period of the FFTW backend, or 0 if the waves
+    //  are simulated, @see SetLoopFrameCount()
+    uint32_t m_LoopFrameCount{ 0 };
+    std::filesystem::path m_LoopCachePath;
+    struct BakedLoop
+    {
+        std::unique_ptr<vkp::Texture2DArray> displacementMaps;
+        std::unique_ptr<vkp::Texture2DArray> normalMaps;  ///< Null if none
+        // Copied from by the frame of the bake, until its next frame
+        std::unique_ptr<vkp::Buffer> stagingBuffer;
+        uint32_t stagingFrameIndex{ 0 };
+        uint64_t stagingFrameCount{ 0 };
+        float minHeight{ -1.0f };   ///< Of all the layers
+        float maxHeight{ 1.0f };
+        bool needsBake{ false };
+    };
+    BakedLoop m_Loop;
+
     // -------------------------------------------------------------------------
     // Water Surface textures
     //  both displacementMap and normalMap are generated on the CPU, then 
-    //  transferred to the GPU, per frame
+    //  transferred to the GPU, per frame. Or written by the compute backend
+
+    // Quality switch, half precision halves the upload, staging memory and
+    //  texture cache footprint
+    static constexpr VkFormat s_kMapFormatFull = VK_FORMAT_R32G32B32A32_SFLOAT;
+    static constexpr VkFormat s_kMapFormatHalf = VK_FORMAT_R16G16B16A16_SFLOAT;
+    VkFormat m_MapFormat{ s_kMapFormatFull };
+    // Distant vertices sample the coarser levels, by their pixels' size
+    bool m_MapMipmaps{ true };
+    bool m_NormalsFromDisplacement{ false };
+    bool m_MapFormatNeedsUpdate{ false };
+
+    // Vertices and indices of the mesh
+    std::unique_ptr<vkp::Buffer> m_StagingBuffer{ nullptr };
+    // Sizes of the mesh buffers, in bytes
+    VkDeviceSize m_MeshVerticesCapacity{ 0 };
+    VkDeviceSize m_MeshIndicesCapacity{ 0 };
 
-    static constexpr VkFormat s_kMapFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
-    static constexpr bool s_kUseMipMapping = false;
+    // Slices of maps the simulation writes the waves to directly, zero-copy.
+    //  A slice is written again only once the frames that read it are done,
+    //  i.e., their images have been acquired again
+    std::unique_ptr<vkp::Buffer> m_MapStagingBuffer{ nullptr };
+    VkDeviceSize m_MapStagingSliceSize{ 0 };
 
-    std::unique_ptr<vkp::Buffer> m_StagingBuffer{ nullptr };
+    struct MapStagingSlice
+    {
+        // For each image, number of its frame that last read the slice
+        std::vector<uint64_t> readFrames;
+    };
+    std::vector<MapStagingSlice> m_MapStagingSlices;
+    // Number of frames rendered with each image
+    std::vector<uint64_t> m_ImageFrameCounts;
+    // Of the submitted waves, not released yet, oldest first
+    std::deque<uint32_t> m_SimulationSlices;
+
+    // Dedicated transfer queue, if the device has one. The maps are uploaded
+    //  by its copy engine, while the graphics queue renders the previous
+    //  frame. Then each frame in flight has its own maps, written only after
+    //  the image's fence, while the other frames' maps may still be read
+    bool m_HasTransferQueue{ false };
+    std::unique_ptr<vkp::CommandPool> m_TransferCmdPool{ nullptr };
+    // Signaled by the upload of a frame, waited on by its graphics submission
+    std::vector<VkSemaphore> m_TransferSemaphores;
+    // Of the current frame, if it has uploaded
+    VkSemaphore m_MapUploadSemaphore{ VK_NULL_HANDLE };
+
+    // Device local, host visible memory over the whole VRAM (resizable BAR).
+    //  Then the staging buffer is allocated in it as a storage buffer, the map
+    //  buffer, read by the vertex shader directly, with no copy to the maps
+    bool m_HasMapBuffer{ false };
+    static constexpr VkDeviceSize s_kMinMapBufferHeapSize{ 1ull << 30 };
+    // Read by the last frame, kept while no newer waves are acquired
+    uint32_t m_MapBufferSlice{ UINT32_MAX };
 
     struct FrameMapData
     {
         std::unique_ptr<vkp::Texture2D> displacementMap{ nullptr };
         std::unique_ptr<vkp::Texture2D> normalMap{ nullptr };
+        // Zero if the next update is recorded on the graphics queue, in order
+        //  with the maps' creation or their writes by the compute backend
+        uint64_t wavesId{ 0 };
     };
 
     struct FrameMapPair
     {
-    #ifndef DOUBLE_BUFFERED
-        std::array<FrameMapData, 1> data;
-    #else
-        std::array<FrameMapData, 2> data;
-    #endif
+        // "GetFrameMapCount()" of them, empty until the resolution is selected
+        std::vector<FrameMapData> data;
+        // Second maps of each of the above, at a fixed simulation rate, the
+        //  frames interpolate between both. Empty otherwise
+        std::vector<FrameMapData> blendData;
+        // Of all the maps in bytes, zero if not allocated
+        VkDeviceSize size{ 0 };
+        // Selection count when last bound, for the LRU eviction
+        uint64_t lastUsed{ 0 };
     };
 
-    // Map pair is preallocated for each size of the model's data
+    // Map pair for each size of the model's data, allocated on first use.
+    //  Those not bound are kept while they fit into the budget
     std::vector<FrameMapPair> m_FrameMaps;
-    // Bound pair for the current model's size
+    // Bound pair for the current model's size, null until selected again
     FrameMapPair* m_CurFrameMap{ nullptr };
+    uint64_t m_FrameMapSelections{ 0 };
+
+    // Of all the allocated maps, the bound pair is kept even if over it
+    static constexpr VkDeviceSize s_kDefaultFrameMapBudget{ 64ull << 20 };
+    VkDeviceSize m_FrameMapBudget{ s_kDefaultFrameMapBudget };
 
 #ifdef DOUBLE_BUFFERED
     uint32_t m_FrameMapIndex{ 0 };      ///< Swap index
@@ -246,14 +952,57 @@ private:
     // -------------------------------------------------------------------------
     // Uniform buffers data
 
+    // Transforms of the frame, pushed by "Render()", of all the stages before
+    //  the rasterization
+    struct VertexPushConstants
+    {
+        glm::mat4 viewProj;             ///< Y flipped, the model is identity
+        float projScaleY{ 1.0f };       ///< |proj[1][1]|, of the pixel sizes
+        float WSHeightAmp{ 1.0f };
+        float WSChoppy{ 0.0f };
+        float WSMapBlend{ 0.0f };       ///< Weight of the second maps
+    };
+    VertexPushConstants m_PushConstants{};
+    VkPushConstantRange m_PushConstantRange{};
+
     struct VertexUBO
     {
-        alignas(16) glm::mat4 model;
-        alignas(16) glm::mat4 view;
-        alignas(16) glm::mat4 proj;
-        float WSHeightAmp;
-        float WSChoppy;
         float scale{ 1.0f };            ///< Texture scale
+        uint32_t mapSize{ 0 };          ///< Resolution of the map buffer
+        uint32_t mapIsHalf{ 0 };        ///< Texels of the map buffer in RGBA16F
+        uint32_t normalsFromDisplacement{ 0 };  ///< Normal map is not bound
+        uint32_t gridSize{ 0 };         ///< Quads per side of the grid
+        float vertexDistance{ 1.0f };   ///< Between the grid vertices
+        // CDLOD grid
+        alignas(16) glm::vec3 camPos;
+        float lodRange{ 1.0f };         ///< Of level 0, doubled by each level
+        float lodMorphStart{ CDLODQuadTree::s_kMorphStart };
+        uint32_t patchSize{ WSGridCDLOD::s_kPatchSize }; ///< Quads per side
+        // Tessellated grid
+        uint32_t tessPatchSize{ WSGridTessellated::s_kPatchSize };
+        float tessEdgeLength{ 16.0f };  ///< Of the subdivided edges, in px
+        float viewportHeight{ 1.0f };   ///< Of the framebuffer, in px
+        // Projected grid
+        alignas(16) glm::mat4 invViewProj;
+        uint32_t projGridCols{ 1 };     ///< Quads per row of the screen
+        uint32_t projGridRows{ 1 };
+        float projMaxDistance{ 10000.0f };  ///< Of the vertices at the horizon
+        float projOverscan{ WSGridProjected::s_kOverscan };
+        // Detail cascades
+        alignas(16) glm::vec4 cascadeLengths{ 0.0f };   ///< In meters
+        uint32_t cascadeCount{ 0 };
+        // Water bodies
+        uint32_t bodyGridSize{ 64 };    ///< Quads per side of each body
+        // Reduced shading rate, of the primitives of the shaded pass
+        alignas(16) glm::vec3 sunDir{ 0.0f, 1.0f, 0.0f };
+        uint32_t shadingRateMode{ 0 };  ///< 0: full rate everywhere
+        glm::vec2 shadingRateDistances{ 150.0f, 600.0f };   ///< To 2x2, 4x4
+        float shadingRateSpecularCos{ 0.95f };  ///< Full rate of the glints
+        float shadingRateMaxSlope{ 0.1f };  ///< Of 1 - normal.y, full above
+        // Of the views of a multiview pass, Y flipped as "viewProj"
+        alignas(16) std::array<
+            glm::mat4, vkp::Camera::s_kMaxViewCount
+        > viewProjs{};
     };
     VertexUBO m_VertexUBO{};
 
@@ -288,6 +1037,24 @@ private:
         { "16", "32", "64", "128", "256", "512", "1024" }
     };
 
+    static const inline gui::ValueStringArray<Backend, 2> s_kBackends{
+        { Backend::FFTW, Backend::Compute },
+        { "CPU (FFTW)", "GPU (Compute shaders)" }
+    };
+
+    static const inline gui::ValueStringArray<GridMode, 7> s_kGridModes{
+        { GridMode::Vertices, GridMode::Procedural, GridMode::CDLOD,
+          GridMode::Tessellated, GridMode::Tiled, GridMode::Projected,
+          GridMode::Bodies },
+        { "Vertex Buffers", "Procedural", "CDLOD", "Tessellated",
+          "Tiled (Instanced)", "Projected", "Water Bodies (Instanced)" }
+    };
+
+    static const inline gui::ValueStringArray<VkFormat, 2> s_kMapFormats{
+        { s_kMapFormatFull, s_kMapFormatHalf },
+        { "Full (RGBA32F)", "Half (RGBA16F)" }
+    };
+
 
     // =========================================================================
     // Jerlov water types: a classification based on coefficient K_d(\lambda)
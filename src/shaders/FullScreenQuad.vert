@@ -11,5 +11,6 @@ void main()
 {
     outUV = vec2( (gl_VertexIndex << 1) & 2, gl_VertexIndex & 2 );
 
-    gl_Position = vec4(outUV * 2.0f - 1.0f, 0.0f, 1.0f);
+    // At the far plane, behind everything drawn before
+    gl_Position = vec4(outUV * 2.0f - 1.0f, 1.0f, 1.0f);
 }
@@ -0,0 +1,13 @@
+#version 450
+
+// Cached GUI image of the framebuffer's size, of premultiplied colors,
+//  blended over the frame
+
+layout(set = 0, binding = 0) uniform sampler2D uOverlay;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    outColor = texelFetch(uOverlay, ivec2(gl_FragCoord.xy), 0);
+}
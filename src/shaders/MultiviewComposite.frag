@@ -0,0 +1,26 @@
+#version 450
+
+// Layers of the views of a multiview pass, composited side by side over the
+//  frame, from the left, @see vkp::MultiviewTarget
+
+layout(set = 0, binding = 0) uniform sampler2DArray uViews;
+
+layout(push_constant) uniform CompositePushConstants
+{
+    uint viewWidth;     // Of a tile, in px
+    uint viewCount;
+} pc;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    const ivec2 kPixel = ivec2(gl_FragCoord.xy);
+
+    // Columns past the last tile, of the remainder of the width, repeat it
+    const int kView = min(kPixel.x / int(pc.viewWidth), int(pc.viewCount) - 1);
+    const int kX = min(kPixel.x - kView * int(pc.viewWidth),
+                       int(pc.viewWidth) - 1);
+
+    outColor = texelFetch(uViews, ivec3(kX, kPixel.y, kView), 0);
+}
@@ -0,0 +1,12 @@
+#version 450
+
+// Overdraw heatmap, each fragment adds the same color by additive blending:
+//  the red saturates at 8 fragments of a pixel, the green at 16, the blue
+//  at 32, from a dark red through yellow to white
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    outColor = vec4(1.0 / 8.0, 1.0 / 16.0, 1.0 / 32.0, 0.0);
+}
@@ -0,0 +1,24 @@
+// Directions of the sky LUT, a lat-long map of the whole sphere: u of
+//  the azimuth around the Y axis, v of the inclination from the zenith.
+//  Appended to the shaders writing or reading it, @see SkyModel
+
+#define SKY_LUT_PI 3.14159265358979323846
+
+vec2 SkyLutUV(const in vec3 dir)
+{
+    const float azimuth = atan(dir.z, dir.x);
+    const float inclination = acos( clamp(dir.y, -1.0f, 1.0f) );
+
+    return vec2(azimuth / (2.0f * SKY_LUT_PI) + 0.5f,
+                inclination / SKY_LUT_PI);
+}
+
+vec3 SkyLutDir(const in vec2 uv)
+{
+    const float azimuth = (uv.x - 0.5f) * 2.0f * SKY_LUT_PI;
+    const float inclination = uv.y * SKY_LUT_PI;
+
+    return vec3( sin(inclination) * cos(azimuth),
+                 cos(inclination),
+                 sin(inclination) * sin(azimuth) );
+}
@@ -0,0 +1,4 @@
+#version 450
+
+// First of the files of the sky's fragment stage, followed by
+//  "SkyPreetham.frag", @see SkyModel::s_kShaderInfos
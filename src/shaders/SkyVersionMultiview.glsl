@@ -0,0 +1,6 @@
+#version 450
+#extension GL_EXT_multiview : require
+
+// Of the sky of a multiview pass: "SkyPreetham.frag" rotates the directions
+//  by each view's matrix, instead of "SkyVersion.glsl"
+#define SKY_MULTIVIEW
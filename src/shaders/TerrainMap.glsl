@@ -0,0 +1,16 @@
+// Area of the terrain map, a square centered at the origin of the XZ plane,
+//  mirrored beyond. Appended to the shaders writing or reading it,
+//  @see TerrainMap
+
+// In meters
+const float kTerrainMapExtent = 2048.0f;
+
+vec2 TerrainMapUV(const in vec2 p)
+{
+    return p / kTerrainMapExtent + 0.5f;
+}
+
+vec2 TerrainMapPos(const in vec2 uv)
+{
+    return (uv - 0.5f) * kTerrainMapExtent;
+}
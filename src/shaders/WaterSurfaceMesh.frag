@@ -33,6 +33,11 @@ layout(set = 0, binding = 1) uniform WaterSurfaceUBO
     vec3 ZeroThetaSun;
 } surface;
 
+// Preetham sky luminance of the directions, @see SkyModel
+layout(set = 0, binding = 8) uniform sampler2D skyLut;
+// Normal and color factor of the terrain, @see TerrainMap
+layout(set = 0, binding = 9) uniform sampler2D terrainMap;
+
 #define M_PI 3.14159265358979323846
 #define ONE_OVER_PI (1.0 / M_PI)
 
@@ -65,9 +70,8 @@ vec3 SkyLuminance(const in vec3 kSunDir, const in vec3 kViewDir);
  */
 float IntersectTerrain(const in Ray ray);
 
-vec3 TerrainNormal(const in vec2 p);
-
-vec3 TerrainColor(const in vec2 p);
+/** @return Normal of the terrain in xyz, its color factor in w */
+vec4 FetchTerrain(const in vec2 p);
 
 /**
  * @brief Fresnel reflectance for unpolarized incident light
@@ -121,7 +125,9 @@ vec3 ComputeTerrainRadiance(
 )
 {
     // TODO better TERRAIN COLOR
-    return TerrainColor(p_g.xz) * dot(TerrainNormal(p_g.xz), -kIncidentDir);
+    const vec4 kTerrain = FetchTerrain(p_g.xz);
+    return kTerrain.w * surface.terrainColor *
+           dot(normalize(kTerrain.xyz), -kIncidentDir);
 }
 
 vec3 ComputeWaterSurfaceColor(
@@ -219,37 +225,20 @@ void main ()
 
 
 // =============================================================================
-// Terrain functions
-
-float Fbm4Noise2D(in vec2 p);
-
-float TerrainHeight(const in vec2 p)
-{
-    return TERRAIN_HEIGHT - 8.f * Fbm4Noise2D(p.yx * 0.02f);
-}
+// Terrain functions, of the baked map
 
-vec3 TerrainNormal(const in vec2 p)
-{
-    // Approximate normal based on central differences method for height map
-    const vec2 kEpsilon = vec2(0.0001, 0.0);
-
-    return normalize(
-        vec3(
-            // x + offset
-            TerrainHeight(p - kEpsilon.xy) - TerrainHeight(p + kEpsilon.xy), 
-            10.0f * kEpsilon.x,
-            // z + offset
-            TerrainHeight(p - kEpsilon.yx) - TerrainHeight(p + kEpsilon.yx)
-        )
-    );
-}
+// Defined by "TerrainMap.glsl" appended
+vec2 TerrainMapUV(const in vec2 p);
 
-vec3 TerrainColor(const in vec2 p)
+vec4 FetchTerrain(const in vec2 p)
 {
-    //const vec3 kMate = vec3(0.964, 1.0, 0.824);
-    float n = clamp(Fbm4Noise2D(p.yx * 0.02 * 2.), 0.6, 0.9);
+    const vec2 uv = TerrainMapUV(p);
+    vec4 terrain = texture(terrainMap, uv);
 
-    return n * surface.terrainColor;
+    // Mirrored beyond the baked area, so are its slopes
+    const vec2 kMirror = 1.0 - 2.0 * mod(floor(uv), 2.0);
+    terrain.xz *= kMirror;
+    return terrain;
 }
 
 float IntersectTerrain(const in Ray ray)
@@ -258,55 +247,6 @@ float IntersectTerrain(const in Ray ray)
            dot(ray.dir, kTerrainBoundPlane.xyz);
 }
 
-// =============================================================================
-// Noise functions
-
-float hash1(in vec2 i)
-{
-    i = 50.0 * fract( i * ONE_OVER_PI );
-    return fract( i.x * i.y * (i.x + i.y) );
-}
-
-float Noise2D(const in vec2 p)
-{
-    vec2 i = floor(p);
-    vec2 f = fract(p);
-
-#ifdef INTERPOLATION_CUBIC
-    vec2 u = f*f * (3.0-2.0*f);
-#else
-    vec2 u = f*f*f * (f * (f*6.0-15.0) +10.0);
-#endif
-    float a = hash1(i + vec2(0,0) );
-    float b = hash1(i + vec2(1,0) );
-    float c = hash1(i + vec2(0,1) );
-    float d = hash1(i + vec2(1,1) );
-
-    return -1.0 + 2.0 * (a + 
-                         (b - a) * u.x + 
-                         (c - a) * u.y + 
-                         (a - b - c + d) * u.x * u.y);
-}
-
-const mat2 MAT345 = mat2( 4./5., -3./5.,
-                          3./5.,  4./5. );
-
-float Fbm4Noise2D(in vec2 p)
-{
-    const float kFreq = 2.0;
-    const float kGain = 0.5;
-    float amplitude = 0.5;
-    float value = 0.0;
-
-    for (int i = 0; i < 4; ++i)
-    {
-        value += amplitude * Noise2D(p);
-        amplitude *= kGain;
-        p = kFreq * MAT345 * p;
-    }
-    return value;
-}
-
 // =============================================================================
 // Preetham Sky
 
@@ -315,70 +255,14 @@ float SaturateDot(const in vec3 v, const in vec3 u)
     return max( dot(v,u), 0.0f );
 }
 
-vec3 ComputePerezLuminanceYxy(const in float theta, const in float gamma)
-{
-    const float kBias = 1e-3f;
-    return (1.f + surface.A * exp( surface.B / (cos(theta)+kBias) ) ) *
-           (1.f + surface.C * exp( surface.D * gamma) +
-            surface.E * cos(gamma) * cos(gamma) );
-}
-
-vec3 ComputeSkyLuminance(const in vec3 kSunDir, const in vec3 kViewDir)
-{
-    const float thetaView = acos( SaturateDot(kViewDir, vec3(0,1,0)) );
-    const float gammaView = acos( SaturateDot(kSunDir, kViewDir) );
-
-    const vec3 fThetaGamma = ComputePerezLuminanceYxy(thetaView, gammaView);
-    
-    return surface.ZenithLum * (fThetaGamma / surface.ZeroThetaSun);
-}
-
-vec3 YxyToRGB(const in vec3 Yxy);
+// Defined by "SkyLut.glsl" appended
+vec2 SkyLutUV(const in vec3 dir);
 
 vec3 SkyLuminance(const in vec3 kSunDir, const in vec3 kViewDir)
 {
     const float kSunDisk = smoothstep(0.997f, 1.f,
                                       SaturateDot(kViewDir, kSunDir) );
 
-    const vec3 kSkyLuminance = YxyToRGB( ComputeSkyLuminance(kSunDir, kViewDir) );
+    const vec3 kSkyLuminance = texture(skyLut, SkyLutUV(kViewDir)).rgb;
     return kSkyLuminance * 0.05f + kSunDisk * kSkyLuminance;
 }
-
-// =============================================================================
-// Althar. Preetham Sky. [online]. Shadertoy.com. 2015.
-// https://www.shadertoy.com/view/llSSDR
-
-vec3 YxyToXYZ( const in vec3 Yxy )
-{
-    const float Y = Yxy.r;
-    const float x = Yxy.g;
-    const float y = Yxy.b;
-
-    const float X = x * ( Y / y );
-    const float Z = ( 1.0 - x - y ) * ( Y / y );
-
-    return vec3(X,Y,Z);
-}
-
-vec3 XYZToRGB( const in vec3 XYZ )
-{
-    // CIE/E
-    const mat3 M = mat3
-    (
-         2.3706743, -0.9000405, -0.4706338,
-        -0.5138850,  1.4253036,  0.0885814,
-          0.0052982, -0.0146949,  1.0093968
-    );
-
-    return XYZ * M;
-}
-
-
-vec3 YxyToRGB( const in vec3 Yxy )
-{
-    const vec3 XYZ = YxyToXYZ( Yxy );
-    const vec3 RGB = XYZToRGB( XYZ );
-    return RGB;
-}
-
-// =============================================================================
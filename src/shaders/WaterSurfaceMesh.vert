@@ -1,41 +1,149 @@
-#version 450
-
-layout(location = 0) in vec3 inPos;
-layout(location = 1) in vec2 inUV;
+// Displaced grid, of the vertex or the tessellation evaluation stage, appended
+//  to "WaterSurfaceMeshVertexUBO.glsl"
 
 layout(location = 0) out vec4 outPos;
 layout(location = 1) out vec3 outNormal;
 layout(location = 2) out vec2 outUV;
 
-layout(set = 0, binding = 0) uniform VertexUBO
+// Same depth in the pre-pass and in the main pass, each of its own pipeline
+invariant gl_Position;
+
+// Defined by a "WaterSurfaceMeshGrid<source>" file of the stage appended
+void GetGridVertex(out vec3 pos, out vec2 uv);
+
+// Defined by a "WaterSurfaceMeshMaps<source>.vert" file appended, 'lod' is
+//  of the mipmaps, if the maps have them
+vec4 FetchDisplacement(vec2 uv, float lod);
+vec4 FetchSlope(vec2 uv, float lod);
+
+// Defined by "WaterSurfaceMeshCascades.vert" appended, of the world position
+//  and the size of a pixel there
+vec3 FetchCascadesDisplacement(vec2 xz, float pixelSize);
+vec2 FetchCascadesSlope(vec2 xz, float pixelSize);
+
+// Of the screen's pixel at the distance of the position, in world units
+float GetPixelSize(vec3 pos)
+{
+    return 2.0 * distance(pos, ubo.camPos) /
+           (pc.projScaleY * ubo.viewportHeight);
+}
+
+// Mip level of a map, so that its texels are about the size of a pixel,
+//  no finer than the waves a pixel can show
+float GetMapLod(float pixelSize, float texelSize)
+{
+    return max(log2(pixelSize / texelSize), 0.0);
+}
+
+
+// Central differences of the displacements, one texel apart, over the ground
+//  distance of the two texels
+void ReconstructFromDisplacement(vec2 uv, float lod,
+                                 out vec3 normal, out float jacobian)
 {
-    mat4 model;
-    mat4 view;
-    mat4 proj;
-    float WSHeightAmp;
-    float WSChoppy;
-    float scale;
-} ubo;
+    // Of the mip level
+    const float texel = exp2(lod) / float(ubo.mapSize);
+    const float groundStep =
+        2.0 * texel * float(ubo.gridSize) * ubo.vertexDistance / ubo.scale;
+    const vec3 heightAmp = vec3(1.0, pc.WSHeightAmp, 1.0);
 
-layout(binding = 2) uniform sampler2D DisplacementMap;
-layout(binding = 3) uniform sampler2D NormalMap;
+    const vec3 dDx = heightAmp *
+        (FetchDisplacement(uv + vec2(texel, 0.0), lod).xyz -
+         FetchDisplacement(uv - vec2(texel, 0.0), lod).xyz);
+    const vec3 dDz = heightAmp *
+        (FetchDisplacement(uv + vec2(0.0, texel), lod).xyz -
+         FetchDisplacement(uv - vec2(0.0, texel), lod).xyz);
 
+    // Tangents of the displaced surface
+    const vec3 tangentX = vec3(groundStep, 0.0, 0.0) + dDx;
+    const vec3 tangentZ = vec3(0.0, 0.0, groundStep) + dDz;
+    normal = normalize(cross(tangentZ, tangentX));
+
+    // Of the horizontal displacement, drops below zero where waves fold
+    jacobian = (tangentX.x * tangentZ.z - tangentZ.x * tangentX.z) /
+               (groundStep * groundStep);
+}
+
+#ifdef WS_PRIMITIVE_SHADING_RATE
+// Rate of the fragments of the primitives of the provoking vertex. Coarser
+//  with the distance, of the mostly low-frequency refraction and sky colors,
+//  except where the normal is steep or reflects the sun to the camera, of
+//  the highlights
+int GetShadingRate(vec3 pos, vec3 normal)
+{
+    const int kRate1x1 = 0;
+    const int kRate2x2 = gl_ShadingRateFlag2VerticalPixelsEXT |
+                         gl_ShadingRateFlag2HorizontalPixelsEXT;
+    const int kRate4x4 = gl_ShadingRateFlag4VerticalPixelsEXT |
+                         gl_ShadingRateFlag4HorizontalPixelsEXT;
+
+    const float kDistance = distance(pos, ubo.camPos);
+    if (ubo.shadingRateMode == 0 || kDistance < ubo.shadingRateDistances.x)
+        return kRate1x1;
+
+    // Blinn-Phong half vector, as of the fragment shader
+    const vec3 kViewDir = (ubo.camPos - pos) / kDistance;
+    const vec3 kHalfWayDir = normalize(ubo.sunDir + kViewDir);
+    if (dot(normal, kHalfWayDir) > ubo.shadingRateSpecularCos ||
+        1.0 - normal.y > ubo.shadingRateMaxSlope)
+        return kRate1x1;
+
+    return kDistance < ubo.shadingRateDistances.y ? kRate2x2 : kRate4x4;
+}
+#endif
 
 void main()
 {
-    vec4 D = texture(DisplacementMap, inUV * ubo.scale);
-    D.y   *= ubo.WSHeightAmp;
+    vec3 inPos;
+    vec2 inUV;
+    GetGridVertex(inPos, inUV);
+
+    // Of the undisplaced vertex, the maps are filtered over the pixel there
+    const float pixelSize = GetPixelSize(inPos);
+    const float texelSize = float(ubo.gridSize) * ubo.vertexDistance /
+                            (ubo.scale * float(ubo.mapSize));
+    const float lod = GetMapLod(pixelSize, texelSize);
+
+    vec4 D = FetchDisplacement(inUV * ubo.scale, lod);
+    D.y   *= pc.WSHeightAmp;
+    D.xyz += FetchCascadesDisplacement(inPos.xz, pixelSize);
     outPos.xyz = inPos + D.xyz;
     outPos.w = D.w;     // jacobian
-    // TODO optimize MVP
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(outPos.xyz, 1.0);
+#ifdef WS_MULTIVIEW
+    gl_Position = ubo.viewProjs[gl_ViewIndex] * vec4(outPos.xyz, 1.0);
+#else
+    gl_Position = pc.viewProj * vec4(outPos.xyz, 1.0);
+#endif
+
+    if (ubo.normalsFromDisplacement != 0)
+    {
+        ReconstructFromDisplacement(inUV * ubo.scale, lod,
+                                    outNormal, outPos.w);
+    }
+    else
+    {
+        const vec4 slope = FetchSlope(inUV * ubo.scale, lod);
+        outNormal = normalize(vec3(
+            - ( slope.x / (1.0f + pc.WSChoppy * slope.z) ),
+            1.0f,
+            - ( slope.y / (1.0f + pc.WSChoppy * slope.w) )
+        ));
+    }
 
-    const vec4 slope = texture(NormalMap, inUV * ubo.scale);
-    outNormal = normalize(vec3(
-        - ( slope.x / (1.0f + ubo.WSChoppy * slope.z) ),
-        1.0f,
-        - ( slope.y / (1.0f + ubo.WSChoppy * slope.w) )
-    ));
+    // Slopes of the detail cascades add to those of the primary waves
+    if (ubo.cascadeCount > 0)
+    {
+        const vec2 cascadeSlope = FetchCascadesSlope(inPos.xz, pixelSize);
+        outNormal = normalize(vec3(
+            outNormal.x / outNormal.y - cascadeSlope.x,
+            1.0,
+            outNormal.z / outNormal.y - cascadeSlope.y
+        ));
+    }
 
     outUV = inUV;
+
+#ifdef WS_PRIMITIVE_SHADING_RATE
+    gl_PrimitiveShadingRateEXT = GetShadingRate(outPos.xyz, outNormal);
+#endif
 }
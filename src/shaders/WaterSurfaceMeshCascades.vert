@@ -0,0 +1,56 @@
+// Detail cascades of "WaterSurfaceMesh.vert", appended to it, @see WSCascades
+//  Maps tile the water plane, each over its cascade's length in meters
+
+const int kMaxCascadeCount = 3;
+
+layout(binding = 6) uniform sampler2D CascadeDisplacementMaps[kMaxCascadeCount];
+layout(binding = 7) uniform sampler2D CascadeNormalMaps[kMaxCascadeCount];
+
+// Of the slopes and the derivatives of the displacements of a normal map
+vec2 SlopeOf(vec4 slope)
+{
+    return slope.xy / (1.0 + pc.WSChoppy * slope.zw);
+}
+
+// Filtered over the pixel, of the map's mipmaps
+vec4 SampleCascade(sampler2D map, float tileLength, vec2 xz, float pixelSize)
+{
+    const float texelSize = tileLength / float(textureSize(map, 0).x);
+    return textureLod(map, xz / tileLength, GetMapLod(pixelSize, texelSize));
+}
+
+// Indexed by constants, the arrays need no dynamic indexing of the device
+
+vec3 FetchCascadesDisplacement(vec2 xz, float pixelSize)
+{
+    vec3 displacement = vec3(0.0);
+
+    if (ubo.cascadeCount > 0)
+        displacement += SampleCascade(CascadeDisplacementMaps[0],
+                                      ubo.cascadeLengths[0], xz, pixelSize).xyz;
+    if (ubo.cascadeCount > 1)
+        displacement += SampleCascade(CascadeDisplacementMaps[1],
+                                      ubo.cascadeLengths[1], xz, pixelSize).xyz;
+    if (ubo.cascadeCount > 2)
+        displacement += SampleCascade(CascadeDisplacementMaps[2],
+                                      ubo.cascadeLengths[2], xz, pixelSize).xyz;
+
+    return displacement;
+}
+
+vec2 FetchCascadesSlope(vec2 xz, float pixelSize)
+{
+    vec2 slope = vec2(0.0);
+
+    if (ubo.cascadeCount > 0)
+        slope += SlopeOf(SampleCascade(CascadeNormalMaps[0],
+                                       ubo.cascadeLengths[0], xz, pixelSize));
+    if (ubo.cascadeCount > 1)
+        slope += SlopeOf(SampleCascade(CascadeNormalMaps[1],
+                                       ubo.cascadeLengths[1], xz, pixelSize));
+    if (ubo.cascadeCount > 2)
+        slope += SlopeOf(SampleCascade(CascadeNormalMaps[2],
+                                       ubo.cascadeLengths[2], xz, pixelSize));
+
+    return slope;
+}
@@ -0,0 +1,8 @@
+#version 450
+
+// Depth-only pre-pass of the water surface, the fragments keep the depth
+//  interpolated from the vertices, no color is written
+
+void main()
+{
+}
@@ -0,0 +1,31 @@
+// Grids of "WaterSurfaceMesh.vert" of the water bodies, appended to it, each
+//  instance is a body, @see WSBodies. Derived from the vertex index as in
+//  "WaterSurfaceMeshGridProcedural.vert", stretched over the body's rectangle.
+
+// x and z of the body's center, then of its half extent
+layout(location = 0) in vec4 inRect;
+// Layer of the body's waves, and their tile length in meters
+layout(location = 1) in vec4 inWaves;
+
+// Corners of the two triangles of a quad
+const uvec2 kQuadCorners[6] = uvec2[](
+    uvec2(0, 0), uvec2(0, 1), uvec2(1, 0),
+    uvec2(1, 0), uvec2(0, 1), uvec2(1, 1)
+);
+
+void GetGridVertex(out vec3 pos, out vec2 uv)
+{
+    const uint quad = uint(gl_VertexIndex) / 6;
+    const uvec2 corner = kQuadCorners[uint(gl_VertexIndex) % 6];
+
+    const uvec2 grid = uvec2(quad % ubo.bodyGridSize,
+                             quad / ubo.bodyGridSize) + corner;
+
+    const vec2 xz = inRect.xy +
+        (2.0 * vec2(grid) / float(ubo.bodyGridSize) - 1.0) * inRect.zw;
+    pos = vec3(xz.x, 0.0, xz.y);
+
+    // Maps repeat over the tile length, continuous across the bodies
+    uv = xz / inWaves.y;
+    BodyLayer = inWaves.x;
+}
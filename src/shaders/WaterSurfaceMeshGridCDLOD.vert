@@ -0,0 +1,38 @@
+// Grid of "WaterSurfaceMesh.vert" of the CDLOD patches, appended to it. Each
+//  instance is a patch of "ubo.patchSize" quads per side, derived from
+//  the vertex index, 6 vertices per quad. Vertices morph into the grid of
+//  the parent level towards the end of the patch's range.
+
+// x and z of the min corner, side length, level
+layout(location = 0) in vec4 inPatch;
+
+// Corners of the two triangles of a quad
+const uvec2 kQuadCorners[6] = uvec2[](
+    uvec2(0, 0), uvec2(0, 1), uvec2(1, 0),
+    uvec2(1, 0), uvec2(0, 1), uvec2(1, 1)
+);
+
+void GetGridVertex(out vec3 pos, out vec2 uv)
+{
+    const uint quad = uint(gl_VertexIndex) / 6;
+    const uvec2 corner = kQuadCorners[uint(gl_VertexIndex) % 6];
+
+    vec2 grid = vec2(uvec2(quad % ubo.patchSize, quad / ubo.patchSize) + corner);
+    const float quadSize = inPatch.z / float(ubo.patchSize);
+
+    // Same distance as of the selection, to the undisplaced vertex
+    const vec2 gridPos = inPatch.xy + grid * quadSize;
+    const float range = ubo.lodRange * exp2(inPatch.w);
+    const float dist = distance(vec3(gridPos.x, 0.0, gridPos.y), ubo.camPos);
+    const float morph = clamp(
+        (dist - ubo.lodMorphStart * range) / ((1.0 - ubo.lodMorphStart) * range),
+        0.0, 1.0
+    );
+
+    // Odd vertices slide onto their even neighbours
+    grid -= fract(grid * 0.5) * 2.0 * morph;
+
+    const vec2 xz = inPatch.xy + grid * quadSize;
+    pos = vec3(xz.x, 0.0, xz.y);
+    uv = xz / (float(ubo.gridSize) * ubo.vertexDistance) + 0.5;
+}
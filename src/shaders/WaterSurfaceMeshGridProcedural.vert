@@ -0,0 +1,22 @@
+// Grid of "WaterSurfaceMesh.vert" derived from the vertex index, appended
+//  to it. Drawn without any buffers, 6 vertices per quad, in the order of
+//  the indices of the vertex buffer grid.
+
+// Corners of the two triangles of a quad
+const uvec2 kQuadCorners[6] = uvec2[](
+    uvec2(0, 0), uvec2(0, 1), uvec2(1, 0),
+    uvec2(1, 0), uvec2(0, 1), uvec2(1, 1)
+);
+
+void GetGridVertex(out vec3 pos, out vec2 uv)
+{
+    const uint quad = uint(gl_VertexIndex) / 6;
+    const uvec2 corner = kQuadCorners[uint(gl_VertexIndex) % 6];
+
+    const uvec2 grid = uvec2(quad % ubo.gridSize, quad / ubo.gridSize) + corner;
+    const float halfSize = float(ubo.gridSize / 2);
+
+    pos = vec3(float(grid.x) - halfSize, 0.0, float(grid.y) - halfSize)
+          * ubo.vertexDistance;
+    uv = vec2(grid) / float(ubo.gridSize);
+}
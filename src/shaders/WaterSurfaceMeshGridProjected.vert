@@ -0,0 +1,39 @@
+// Grid of "WaterSurfaceMesh.vert" projected from the screen onto the water
+//  plane, appended to it. A grid of "ubo.projGridCols" by "ubo.projGridRows"
+//  quads over the screen, 6 vertices per quad, each moved to where its view
+//  ray hits the plane at y = 0.
+
+// Corners of the two triangles of a quad
+const uvec2 kQuadCorners[6] = uvec2[](
+    uvec2(0, 0), uvec2(0, 1), uvec2(1, 0),
+    uvec2(1, 0), uvec2(0, 1), uvec2(1, 1)
+);
+
+// Of the rays at and above the horizon, still hitting the plane far away
+const float kMinRayDown = 1e-4;
+
+void GetGridVertex(out vec3 pos, out vec2 uv)
+{
+    const uint quad = uint(gl_VertexIndex) / 6;
+    const uvec2 corner = kQuadCorners[uint(gl_VertexIndex) % 6];
+
+    const uvec2 grid = uvec2(quad % ubo.projGridCols, quad / ubo.projGridCols)
+                       + corner;
+    const vec2 ndc = (vec2(grid) / vec2(ubo.projGridCols, ubo.projGridRows)
+                      * 2.0 - 1.0) * ubo.projOverscan;
+
+    // View ray through the near and far planes, depth in [0, 1]
+    const vec4 nearPos = ubo.invViewProj * vec4(ndc, 0.0, 1.0);
+    const vec4 farPos = ubo.invViewProj * vec4(ndc, 1.0, 1.0);
+    vec3 dir = normalize(farPos.xyz / farPos.w - nearPos.xyz / nearPos.w);
+
+    // Towards the plane, from either side of it
+    const float side = ubo.camPos.y >= 0.0 ? 1.0 : -1.0;
+    dir.y = -side * max(-side * dir.y, kMinRayDown);
+
+    const float t = min(abs(ubo.camPos.y / dir.y), ubo.projMaxDistance);
+    const vec2 xz = ubo.camPos.xz + dir.xz * t;
+
+    pos = vec3(xz.x, 0.0, xz.y);
+    uv = xz / (float(ubo.gridSize) * ubo.vertexDistance) + 0.5;
+}
@@ -0,0 +1,28 @@
+// Grid of "WaterSurfaceMesh.vert" repeated as instances, appended to it. Each
+//  instance is the whole grid, derived from the vertex index as in
+//  "WaterSurfaceMeshGridProcedural.vert", moved to its tile.
+
+// x and z of the tile's center
+layout(location = 0) in vec4 inTile;
+
+// Corners of the two triangles of a quad
+const uvec2 kQuadCorners[6] = uvec2[](
+    uvec2(0, 0), uvec2(0, 1), uvec2(1, 0),
+    uvec2(1, 0), uvec2(0, 1), uvec2(1, 1)
+);
+
+void GetGridVertex(out vec3 pos, out vec2 uv)
+{
+    const uint quad = uint(gl_VertexIndex) / 6;
+    const uvec2 corner = kQuadCorners[uint(gl_VertexIndex) % 6];
+
+    const uvec2 grid = uvec2(quad % ubo.gridSize, quad / ubo.gridSize) + corner;
+    const float halfSize = float(ubo.gridSize / 2);
+
+    const vec2 xz = inTile.xy +
+                    (vec2(grid) - halfSize) * ubo.vertexDistance;
+    pos = vec3(xz.x, 0.0, xz.y);
+
+    // Continuous across the tiles, the maps repeat at any texture scale
+    uv = xz / (float(ubo.gridSize) * ubo.vertexDistance) + 0.5;
+}
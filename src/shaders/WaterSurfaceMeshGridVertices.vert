@@ -0,0 +1,10 @@
+// Grid of "WaterSurfaceMesh.vert" read from the vertex buffer, appended to it
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec2 inUV;
+
+void GetGridVertex(out vec3 pos, out vec2 uv)
+{
+    pos = inPos;
+    uv = inUV;
+}
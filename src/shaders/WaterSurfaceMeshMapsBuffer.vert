@@ -0,0 +1,87 @@
+// Maps of "WaterSurfaceMesh.vert" read from storage buffers, appended to it
+//  Written by the CPU directly into device local, host visible memory, row
+//  by row, as RGBA32F, or RGBA16F texels
+
+layout(std430, binding = 4) readonly buffer DisplacementBuffer {
+    uint words[];
+} DisplacementMap;
+
+layout(std430, binding = 5) readonly buffer NormalBuffer {
+    uint words[];
+} NormalMap;
+
+// Of the previous simulation step, blended toward at a fixed rate
+layout(std430, binding = 12) readonly buffer BlendDisplacementBuffer {
+    uint words[];
+} BlendDisplacementMap;
+
+layout(std430, binding = 13) readonly buffer BlendNormalBuffer {
+    uint words[];
+} BlendNormalMap;
+
+uint LoadWord(const bool kIsBlend, const bool kIsSlope, const uint kIndex)
+{
+    if (kIsBlend)
+    {
+        return kIsSlope ? BlendNormalMap.words[kIndex]
+                        : BlendDisplacementMap.words[kIndex];
+    }
+    return kIsSlope ? NormalMap.words[kIndex] : DisplacementMap.words[kIndex];
+}
+
+vec4 LoadTexel(const bool kIsBlend, const bool kIsSlope, const uvec2 kTexel)
+{
+    // Repeated, the size is a power of two
+    const uint kMask = ubo.mapSize - 1;
+    const uint kIndex = (kTexel.y & kMask) * ubo.mapSize + (kTexel.x & kMask);
+
+    if (ubo.mapIsHalf != 0)
+    {
+        const uint kWord = 2 * kIndex;
+        return vec4(unpackHalf2x16(LoadWord(kIsBlend, kIsSlope, kWord)),
+                    unpackHalf2x16(LoadWord(kIsBlend, kIsSlope, kWord + 1)));
+    }
+
+    const uint kWord = 4 * kIndex;
+    return uintBitsToFloat(uvec4(LoadWord(kIsBlend, kIsSlope, kWord),
+                                 LoadWord(kIsBlend, kIsSlope, kWord + 1),
+                                 LoadWord(kIsBlend, kIsSlope, kWord + 2),
+                                 LoadWord(kIsBlend, kIsSlope, kWord + 3)));
+}
+
+// Bilinear, as by the samplers of the maps
+vec4 SampleMap(const bool kIsBlend, const bool kIsSlope, const vec2 kUV)
+{
+    const vec2 kPos = kUV * float(ubo.mapSize) - 0.5;
+    const vec2 kFrac = fract(kPos);
+    // Negative ones wrap around as well
+    const uvec2 kTexel = uvec2(ivec2(floor(kPos)));
+
+    return mix(
+        mix(LoadTexel(kIsBlend, kIsSlope, kTexel),
+            LoadTexel(kIsBlend, kIsSlope, kTexel + uvec2(1, 0)), kFrac.x),
+        mix(LoadTexel(kIsBlend, kIsSlope, kTexel + uvec2(0, 1)),
+            LoadTexel(kIsBlend, kIsSlope, kTexel + uvec2(1, 1)), kFrac.x),
+        kFrac.y
+    );
+}
+
+// Of the base level only, there are no mipmaps
+
+vec4 FetchDisplacement(vec2 uv, float lod)
+{
+    const vec4 kValue = SampleMap(false, false, uv);
+    if (pc.WSMapBlend <= 0.0)
+        return kValue;
+
+    return mix(kValue, SampleMap(true, false, uv), pc.WSMapBlend);
+}
+
+vec4 FetchSlope(vec2 uv, float lod)
+{
+    const vec4 kValue = SampleMap(false, true, uv);
+    if (pc.WSMapBlend <= 0.0)
+        return kValue;
+
+    return mix(kValue, SampleMap(true, true, uv), pc.WSMapBlend);
+}
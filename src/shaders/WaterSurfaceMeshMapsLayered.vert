@@ -0,0 +1,18 @@
+// Maps of "WaterSurfaceMesh.vert" sampled from the layers of the water bodies,
+//  appended to it, @see WSBodies. Without mipmaps, nor the second maps
+
+layout(binding = 14) uniform sampler2DArray BodyDisplacementMaps;
+layout(binding = 15) uniform sampler2DArray BodyNormalMaps;
+
+// Of the vertex's body, set by "WaterSurfaceMeshGridBodies.vert"
+float BodyLayer;
+
+vec4 FetchDisplacement(vec2 uv, float lod)
+{
+    return textureLod(BodyDisplacementMaps, vec3(uv, BodyLayer), 0.0);
+}
+
+vec4 FetchSlope(vec2 uv, float lod)
+{
+    return textureLod(BodyNormalMaps, vec3(uv, BodyLayer), 0.0);
+}
@@ -0,0 +1,28 @@
+// Maps of "WaterSurfaceMesh.vert" sampled from textures, appended to it
+//  Written by the compute backend, or copied from the staging buffer
+
+layout(binding = 2) uniform sampler2D DisplacementMap;
+layout(binding = 3) uniform sampler2D NormalMap;
+
+// Of the previous simulation step, blended toward at a fixed rate
+layout(binding = 10) uniform sampler2D BlendDisplacementMap;
+layout(binding = 11) uniform sampler2D BlendNormalMap;
+
+vec4 FetchDisplacement(vec2 uv, float lod)
+{
+    const vec4 kValue = textureLod(DisplacementMap, uv, lod);
+    if (pc.WSMapBlend <= 0.0)
+        return kValue;
+
+    return mix(kValue, textureLod(BlendDisplacementMap, uv, lod),
+               pc.WSMapBlend);
+}
+
+vec4 FetchSlope(vec2 uv, float lod)
+{
+    const vec4 kValue = textureLod(NormalMap, uv, lod);
+    if (pc.WSMapBlend <= 0.0)
+        return kValue;
+
+    return mix(kValue, textureLod(BlendNormalMap, uv, lod), pc.WSMapBlend);
+}
@@ -0,0 +1,6 @@
+#extension GL_EXT_multiview : require
+
+// Of the stages before the rasterization of a multiview pass, right after
+//  the version of each: "WaterSurfaceMesh.vert" transforms the vertices by
+//  the matrix of each view, @see WaterSurfaceMesh::GetShaderInfos()
+#define WS_MULTIVIEW
@@ -0,0 +1,23 @@
+// Control points of the tessellated grid, appended to
+//  "WaterSurfaceMeshVertexUBO.glsl". Drawn without any buffers, 4 vertices
+//  per patch of "ubo.tessPatchSize" quads per side.
+
+layout(location = 0) out vec2 outGridPos;
+
+// Corners of a patch, in the order of "gl_TessCoord"
+const uvec2 kPatchCorners[4] = uvec2[](
+    uvec2(0, 0), uvec2(1, 0), uvec2(0, 1), uvec2(1, 1)
+);
+
+void main()
+{
+    const uint patchCount = ubo.gridSize / ubo.tessPatchSize;
+    const uint patchIndex = uint(gl_VertexIndex) / 4;
+    const uvec2 corner = kPatchCorners[uint(gl_VertexIndex) % 4];
+
+    const uvec2 grid = (uvec2(patchIndex % patchCount, patchIndex / patchCount)
+                        + corner) * ubo.tessPatchSize;
+    const float halfSize = float(ubo.gridSize / 2);
+
+    outGridPos = (vec2(grid) - halfSize) * ubo.vertexDistance;
+}
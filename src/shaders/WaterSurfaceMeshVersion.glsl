@@ -0,0 +1,4 @@
+#version 450
+
+// First of the files of each stage before the rasterization, followed by
+//  "WaterSurfaceMeshVertexUBO.glsl", @see WaterSurfaceMesh::GetShaderInfos()
@@ -0,0 +1,7 @@
+#version 450
+#extension GL_EXT_fragment_shading_rate : require
+
+// Of the vertex stage of the shaded pass, if the device supports the rates of
+//  the primitives: "WaterSurfaceMesh.vert" writes the rate of each, instead
+//  of "WaterSurfaceMeshVersion.glsl"
+#define WS_PRIMITIVE_SHADING_RATE
@@ -0,0 +1,43 @@
+// Uniforms of the stages before the rasterization, after the version of
+//  each, @see WaterSurfaceMesh::GetShaderInfos()
+
+// Transforms of the frame, the model matrix is identity
+layout(push_constant) uniform VertexPushConstants
+{
+    mat4 viewProj;
+    float projScaleY;   // |proj[1][1]|
+    float WSHeightAmp;
+    float WSChoppy;
+    float WSMapBlend;   // Weight of the second maps, of a fixed rate
+} pc;
+
+layout(set = 0, binding = 0) uniform VertexUBO
+{
+    float scale;
+    uint mapSize;
+    uint mapIsHalf;
+    uint normalsFromDisplacement;
+    uint gridSize;
+    float vertexDistance;
+    vec3 camPos;
+    float lodRange;
+    float lodMorphStart;
+    uint patchSize;
+    uint tessPatchSize;
+    float tessEdgeLength;
+    float viewportHeight;
+    mat4 invViewProj;
+    uint projGridCols;
+    uint projGridRows;
+    float projMaxDistance;
+    float projOverscan;
+    vec4 cascadeLengths;
+    uint cascadeCount;
+    uint bodyGridSize;
+    vec3 sunDir;
+    uint shadingRateMode;
+    vec2 shadingRateDistances;
+    float shadingRateSpecularCos;
+    float shadingRateMaxSlope;
+    mat4 viewProjs[4];  // Of the views of a multiview pass, as pc.viewProj
+} ubo;
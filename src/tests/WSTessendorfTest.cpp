@@ -0,0 +1,223 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "scene/WSTessendorf.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * @brief Checks of the CPU wave simulation against its references, without
+ *  Vulkan or GLFW. Each check prints its result, the exit code is of all of
+ *  them, run by "ctest"
+ */
+
+namespace
+{
+    constexpr uint32_t s_kTileSize{ 64 };
+    // Of the amplitude of the heights
+    constexpr float s_kRelativeTolerance{ 1e-3f };
+
+    using Displacements = std::vector<WSTessendorf::Displacement>;
+
+    /** @return Largest difference of the heights and displacements */
+    float MaxDifference(const Displacements& a, const Displacements& b)
+    {
+        float diff = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            const glm::vec4 kDiff = glm::abs(a[i] - b[i]);
+            diff = glm::max(diff, glm::max(kDiff.x, glm::max(kDiff.y,
+                                                             kDiff.z)));
+        }
+        return diff;
+    }
+
+    bool Check(const char* name, float error, float tolerance)
+    {
+        const bool kPassed = error <= tolerance;
+        std::printf("%-44s %s, error %g, tolerance %g\n", name,
+                    kPassed ? "passed" : "FAILED", error, tolerance);
+        return kPassed;
+    }
+
+    /**
+     * @brief The SIMD kernels agree with the scalar one long into a session,
+     *  of the times wrapped to the animation period
+     */
+    bool CheckSimdAtLargeTime()
+    {
+        const wst::SimdLevel kSupported = wst::GetSupportedSimdLevel();
+        if (kSupported == wst::SimdLevel::Scalar)
+        {
+            std::printf("%-44s skipped, no SIMD kernels\n", "SIMD at large t");
+            return true;
+        }
+
+        // Of phases far past the range of the SIMD sine and cosine, unwrapped
+        constexpr float kTime{ 1e5f };
+
+        WSTessendorf surface(s_kTileSize);
+        surface.SetSimdLevel(wst::SimdLevel::Scalar);
+        surface.Prepare();
+
+        const float kAmplitude = surface.ComputeWaves(kTime);
+        const Displacements kReference = surface.GetDisplacements();
+
+        bool passed = true;
+        for (int level = static_cast<int>(wst::SimdLevel::Scalar) + 1;
+             level <= static_cast<int>(kSupported);
+             ++level)
+        {
+            const auto kLevel = static_cast<wst::SimdLevel>(level);
+            surface.SetSimdLevel(kLevel);
+            surface.ComputeWaves(kTime);
+
+            const std::string kName =
+                std::string("SIMD at large t: ") + wst::ToString(kLevel);
+            passed &= Check(kName.c_str(),
+                            MaxDifference(surface.GetDisplacements(),
+                                          kReference),
+                            s_kRelativeTolerance * kAmplitude);
+        }
+        return passed;
+    }
+
+    /**
+     * @brief The phasors advanced by many steps stay close to exp(i*w*t)
+     *  evaluated at once, of the drift bounded by their re-seeding
+     */
+    bool CheckPhasorDrift()
+    {
+        constexpr float kTimeStep{ 1.0f / 60.0f };
+        // Not a multiple of the re-seeding period, of the largest drift
+        constexpr uint32_t kStepCount{ 10000 - 1 };
+
+        WSTessendorf stepped(s_kTileSize);
+        stepped.SetTimeStep(kTimeStep);
+        stepped.Prepare();
+
+        for (uint32_t i = 0; i <= kStepCount; ++i)
+            stepped.ComputeWaves(static_cast<float>(i) * kTimeStep);
+
+        const float kTime = static_cast<float>(kStepCount) * kTimeStep;
+
+        WSTessendorf evaluated(s_kTileSize);
+        evaluated.Prepare();
+        const float kAmplitude = evaluated.ComputeWaves(kTime);
+
+        return Check("Phasors after many steps",
+                     MaxDifference(stepped.GetDisplacements(),
+                                   evaluated.GetDisplacements()),
+                     s_kRelativeTolerance * kAmplitude);
+    }
+
+    /**
+     * @brief The fields transformed in pairs, as "A + iB", agree with those
+     *  transformed one by one, of a Hermitian spectrum
+     */
+    bool CheckPackedFFT()
+    {
+        constexpr float kTime{ 12.5f };
+
+        WSTessendorf packed(s_kTileSize);
+        packed.SetPackedFFT(true);
+        packed.Prepare();
+        const float kAmplitude = packed.ComputeWaves(kTime);
+
+        WSTessendorf unpacked(s_kTileSize);
+        unpacked.SetPackedFFT(false);
+        unpacked.Prepare();
+        unpacked.ComputeWaves(kTime);
+
+        bool passed = Check("Packed FFT displacements",
+                            MaxDifference(packed.GetDisplacements(),
+                                          unpacked.GetDisplacements()),
+                            s_kRelativeTolerance * kAmplitude);
+        // Of the slopes and the derivatives, relative to their largest
+        const Displacements kZero(unpacked.GetNormalCount(), glm::vec4(0.0f));
+        passed &= Check("Packed FFT normals",
+                        MaxDifference(packed.GetNormals(),
+                                      unpacked.GetNormals()),
+                        s_kRelativeTolerance *
+                            MaxDifference(unpacked.GetNormals(), kZero));
+        return passed;
+    }
+
+    /**
+     * @brief The packed, SIMD and incrementally stepped surface agrees with
+     *  sin and cos evaluated at the same time, after a pause and seeks
+     */
+    bool CheckPauseAndSeek()
+    {
+        constexpr float kTimeStep{ 1.0f / 60.0f };
+
+        WSTessendorf stepped(s_kTileSize);
+        stepped.SetPackedFFT(true);
+        stepped.SetSimdLevel(wst::GetSupportedSimdLevel());
+        stepped.SetTimeStep(kTimeStep);
+        stepped.Prepare();
+
+        WSTessendorf evaluated(s_kTileSize);
+        evaluated.SetPackedFFT(false);
+        evaluated.SetSimdLevel(wst::SimdLevel::Scalar);
+        evaluated.Prepare();
+
+        bool passed = true;
+        auto CheckAt = [&](const char* name, float t) {
+            const float kAmplitude = evaluated.ComputeWaves(t);
+            passed &= Check(name,
+                            MaxDifference(stepped.GetDisplacements(),
+                                          evaluated.GetDisplacements()),
+                            s_kRelativeTolerance * kAmplitude);
+        };
+        // Of the steps from 't', each of them computed
+        auto Step = [&](float t, uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i)
+                stepped.ComputeWaves(t + static_cast<float>(i) * kTimeStep);
+            return t + static_cast<float>(count - 1) * kTimeStep;
+        };
+
+        float t = Step(0.0f, 100);
+
+        // Paused, the same time computed again
+        for (uint32_t i = 0; i < 10; ++i)
+            stepped.ComputeWaves(t);
+        CheckAt("Phasors while paused", t);
+
+        t = Step(t + kTimeStep, 30);
+        CheckAt("Phasors resumed after a pause", t);
+
+        // Seeks back and forth, each followed by steps
+        t = Step(3.0f, 50);
+        CheckAt("Phasors after a seek back", t);
+
+        t = Step(t + 37.5f, 50);
+        CheckAt("Phasors after a seek forward", t);
+
+        return passed;
+    }
+
+} // namespace
+
+int main()
+{
+    vkp::Log::Init();
+#ifdef VKP_DEBUG
+    // Only problems, not the messages of each "Prepare()"
+    vkp::Log::GetLogger()->set_level(spdlog::level::warn);
+    if (auto& assertLogger = vkp::Log::GetAssertLogger())
+        assertLogger->set_level(spdlog::level::warn);
+#endif
+
+    bool passed = true;
+    passed &= CheckSimdAtLargeTime();
+    passed &= CheckPhasorDrift();
+    passed &= CheckPackedFFT();
+    passed &= CheckPauseAndSeek();
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -9,8 +9,9 @@
 
 namespace vkp
 {
-    Buffer::Buffer(const Device& device)
-        : m_Device(device)
+    Buffer::Buffer(const Device& device, MemoryTag tag)
+        : m_Device(device),
+          m_MemoryTag(tag)
     {
         VKP_REGISTER_FUNCTION();
         VKP_ASSERT(device != VK_NULL_HANDLE);
@@ -24,16 +25,19 @@ namespace vkp
 
     void Buffer::Create(VkDeviceSize size, VkBufferUsageFlags usage, 
                         VkMemoryPropertyFlags properties, 
-                        VkSharingMode sharingMode)
+                        VkSharingMode sharingMode,
+                        const std::vector<uint32_t>& queueFamilyIndices,
+                        const MemoryAllocation* aliasedMemory)
     {
         VKP_REGISTER_FUNCTION();
-        CreateBuffer(size, usage, sharingMode);
-        AllocateMemory(properties);
+        CreateBuffer(size, usage, sharingMode, queueFamilyIndices);
+        AllocateMemory(properties, aliasedMemory);
         Bind();
     }
 
     void Buffer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, 
-                              VkSharingMode sharingMode)
+                              VkSharingMode sharingMode,
+                              const std::vector<uint32_t>& queueFamilyIndices)
     {
         VKP_REGISTER_FUNCTION();
         // Create the buffer 
@@ -42,13 +46,20 @@ namespace vkp
         bufferInfo.size = size;
         bufferInfo.usage = usage;
         bufferInfo.sharingMode = sharingMode;
+        if (sharingMode == VK_SHARING_MODE_CONCURRENT)
+        {
+            VKP_ASSERT(queueFamilyIndices.size() > 1);
+            bufferInfo.queueFamilyIndexCount = queueFamilyIndices.size();
+            bufferInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+        }
         bufferInfo.flags = 0;
 
         auto err = vkCreateBuffer(m_Device, &bufferInfo, nullptr, &m_Buffer);
         VKP_ASSERT_RESULT(err);
     }
 
-    void Buffer::AllocateMemory(VkMemoryPropertyFlags properties)
+    void Buffer::AllocateMemory(VkMemoryPropertyFlags properties,
+                                const MemoryAllocation* aliasedMemory)
     {
         VKP_ASSERT(m_Buffer != VK_NULL_HANDLE);
         VKP_REGISTER_FUNCTION();
@@ -56,29 +67,35 @@ namespace vkp
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(m_Device, m_Buffer, &memRequirements);
 
-        VKP_LOG_INFO("Allocating buffer, size: {} B", memRequirements.size);
+        auto& allocator = m_Device.GetMemoryAllocator();
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = 
-            m_Device.GetPhysicalDevice().FindMemoryType(
-                memRequirements.memoryTypeBits, 
-                properties);
+        if (aliasedMemory != nullptr)
+        {
+            VKP_ASSERT_MSG(
+                (memRequirements.memoryTypeBits &
+                    (1u << aliasedMemory->memoryTypeIndex)) &&
+                aliasedMemory->offset % memRequirements.alignment == 0 &&
+                memRequirements.size <= aliasedMemory->size,
+                "Buffer does not fit into the aliased memory");
+
+            m_Memory = allocator.Alias(*aliasedMemory);
+            return;
+        }
 
-        auto err =
-            vkAllocateMemory(m_Device, &allocInfo, nullptr, &m_BufferMemory);
-        VKP_ASSERT_RESULT(err);
+        VKP_LOG_INFO("Allocating buffer, size: {} B", memRequirements.size);
+
+        const bool kIsLinear = true;
+        m_Memory = allocator.Allocate(memRequirements, properties, kIsLinear,
+                                      m_MemoryTag);
     }
 
-    void Buffer::Bind(VkDeviceSize offset) const
+    void Buffer::Bind() const
     {
         VKP_REGISTER_FUNCTION();
-        VKP_ASSERT(m_Buffer != VK_NULL_HANDLE &&
-                        m_BufferMemory != VK_NULL_HANDLE);
+        VKP_ASSERT(m_Buffer != VK_NULL_HANDLE && m_Memory.IsValid());
 
-        auto err =
-            vkBindBufferMemory(m_Device, m_Buffer, m_BufferMemory, offset);
+        auto err = vkBindBufferMemory(m_Device, m_Buffer, m_Memory.memory,
+                                      m_Memory.offset);
         VKP_ASSERT_RESULT(err);
     }
 
@@ -99,20 +116,21 @@ namespace vkp
 
     VkResult Buffer::Map(VkDeviceSize size, VkDeviceSize offset)
     {
-        VKP_ASSERT(m_BufferMemory != VK_NULL_HANDLE);
+        VKP_ASSERT(m_Memory.IsValid());
+        VKP_ASSERT(size == VK_WHOLE_SIZE || offset + size <= m_Memory.size);
 
-        VkResult r = vkMapMemory(m_Device, m_BufferMemory, offset, size, 0, 
-                                 &m_MapAddr);
-        return r;
+        // Blocks are mapped by the allocator, once for all their resources
+        if (m_Memory.mappedAddr == nullptr)
+            return VK_ERROR_MEMORY_MAP_FAILED;
+
+        m_MapAddr = static_cast<uint8_t*>(m_Memory.mappedAddr) + offset;
+        return VK_SUCCESS;
     }
 
     VkResult Buffer::Map(void** ppData, VkDeviceSize size,
                          VkDeviceSize offset)
     {
-        VKP_ASSERT(m_BufferMemory != VK_NULL_HANDLE);
-
-        VkResult r = vkMapMemory(m_Device, m_BufferMemory, offset, size, 0, 
-                                 &m_MapAddr);
+        VkResult r = Map(size, offset);
         if (r == VK_SUCCESS)
         {
             *ppData = m_MapAddr;
@@ -123,11 +141,8 @@ namespace vkp
 
     void Buffer::Unmap() 
     {
-        if (m_MapAddr != nullptr)
-        {
-            vkUnmapMemory(m_Device, m_BufferMemory);
-            m_MapAddr = nullptr;
-        }
+        // Block stays mapped while it has other resources
+        m_MapAddr = nullptr;
     }
     
     void Buffer::CopyToMapped(const void* data, VkDeviceSize size,
@@ -139,21 +154,46 @@ namespace vkp
 
     void Buffer::FlushMappedRange(VkDeviceSize size, VkDeviceSize offset) const
     {
-        // TODO: align according to the brief:
-        // Align to the VkPhysicalDeviceProperties::nonCoherentAtomSize
-        //uint32_t alignedSize = (imageDataSize-1) - ((imageDataSize-1) % nonCoherentAtomSize);
+        VKP_ASSERT(m_Memory.IsValid() && offset < m_Memory.size);
+
+        // Allocation is aligned to the atom size, in both its offset and size
+        const VkDeviceSize kSize = size == VK_WHOLE_SIZE
+                                   ? m_Memory.size - offset
+                                   : size;
+        VKP_ASSERT(offset + kSize <= m_Memory.size);
 
         VkMappedMemoryRange range = {
             .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, 
             .pNext = nullptr,
-            .memory = m_BufferMemory,
-            .offset = 0,        // TODO align
-            .size = size
+            .memory = m_Memory.memory,
+            .offset = m_Memory.offset + offset,
+            .size = kSize
         };
 
         vkFlushMappedMemoryRanges(m_Device, 1, &range);
     }
 
+    void Buffer::InvalidateMappedRange(VkDeviceSize size,
+                                       VkDeviceSize offset) const
+    {
+        VKP_ASSERT(m_Memory.IsValid() && offset < m_Memory.size);
+
+        const VkDeviceSize kSize = size == VK_WHOLE_SIZE
+                                   ? m_Memory.size - offset
+                                   : size;
+        VKP_ASSERT(offset + kSize <= m_Memory.size);
+
+        VkMappedMemoryRange range = {
+            .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .pNext = nullptr,
+            .memory = m_Memory.memory,
+            .offset = m_Memory.offset + offset,
+            .size = kSize
+        };
+
+        vkInvalidateMappedMemoryRanges(m_Device, 1, &range);
+    }
+
     void Buffer::StageCopy(VkBuffer srcBuffer, const VkBufferCopy *pRegion,
                           VkCommandBuffer commandBuffer)
     {
@@ -165,11 +205,12 @@ namespace vkp
         if (m_Buffer != VK_NULL_HANDLE)
         {
             vkDestroyBuffer(m_Device, m_Buffer, nullptr);
+            m_Buffer = VK_NULL_HANDLE;
         }
-        if (m_BufferMemory != VK_NULL_HANDLE)
+        if (m_Memory.IsValid())
         {
             Unmap();
-            vkFreeMemory(m_Device, m_BufferMemory, nullptr);
+            m_Device.GetMemoryAllocator().Free(m_Memory);
         }
 
         DestoryBufferView();
@@ -7,8 +7,10 @@
 #define WATER_SURFACE_RENDERING_VULKAN_BUFFER_H_
 
 #include <memory>
+#include <vector>
 #include <vulkan/vulkan.h>
 #include "vulkan/Device.h"
+#include "vulkan/MemoryAllocator.h"
 
 
 namespace vkp
@@ -18,24 +20,28 @@ namespace vkp
     class Buffer
     {
     public:
-        /** @brief Initializes members for subsequent buffer creation */
-        Buffer(const Device& device);
+        /**
+         * @brief Initializes members for subsequent buffer creation
+         * @param tag Subsystem its memory is accounted to
+         */
+        Buffer(const Device& device, MemoryTag tag = MemoryTag::Other);
 
         /**
-         * @brief Destroys the buffer handle, unmaps its memory (if mapped),
-         *  and frees the memory.
+         * @brief Destroys the buffer handle, and frees its memory to the
+         *  device's allocator
          */
         ~Buffer();
 
         Buffer(Buffer&& other)
             : m_Device(other.m_Device),
+              m_MemoryTag(other.m_MemoryTag),
               m_Buffer(other.m_Buffer),
-              m_BufferMemory(other.m_BufferMemory),
+              m_Memory(other.m_Memory),
               m_MapAddr(other.m_MapAddr),
               m_BufferView(other.m_BufferView)
         {
             other.m_Buffer = VK_NULL_HANDLE;
-            other.m_BufferMemory = VK_NULL_HANDLE;
+            other.m_Memory = MemoryAllocation{};
             other.m_MapAddr = nullptr;
             other.m_BufferView = VK_NULL_HANDLE;
         }
@@ -55,7 +61,7 @@ namespace vkp
         }
     
         /**
-         * @brief Creates a buffer with required parameters, allocates its 
+         * @brief Creates a buffer with required parameters, sub-allocates its 
          *  required memory and binds it to the buffer.
          * @param size Required size of the buffer
          * @param usage Usage flags of the buffer, by default used as 
@@ -64,13 +70,20 @@ namespace vkp
          *  default in host visible coherent memory
          * @param sharingMode Accessibility among queue families, by default 
          *  accessible only to a single queue family at a time
+         * @param queueFamilyIndices Queue families accessing the buffer, 
+         *  required if the sharing mode is concurrent
+         * @param aliasedMemory Memory of another resource to be bound to,
+         *  instead of allocating, e.g., for transient resources never used
+         *  at the same time. The buffer must fit into it.
          */
         void Create(VkDeviceSize size, 
                     VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                     VkMemoryPropertyFlags properties = 
                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                    VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE);
+                    VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                    const std::vector<uint32_t>& queueFamilyIndices = {},
+                    const MemoryAllocation* aliasedMemory = nullptr);
 
         /**
          * @brief *Maps* the whole bound memory of the buffer, copies the 
@@ -94,7 +107,8 @@ namespace vkp
         /**
          * @brief Maps a memory region of the buffer. (Memory of the buffer
          *  must have the host visible property to be considered mappable).
-         *  Keeps the mapped address saved internally as a member
+         *  Keeps the mapped address saved internally as a member.
+         *  The memory block stays mapped by the allocator, no call is made
          * @param size Size of the memory to map
          * @param offset Starting offset of the mapped memory
          * @return Result of the mapping call
@@ -116,6 +130,8 @@ namespace vkp
 
         void* GetMappedAddress() const { return m_MapAddr; }
 
+        const MemoryAllocation& GetMemory() const { return m_Memory; }
+
         /** @brief Unmaps the mapped memory region */
         void Unmap();
 
@@ -135,14 +151,21 @@ namespace vkp
          * @brief Flushes mapped memory range
          *      (for case when memory is *NOT* HOST_COHERENT)
          * @param size Size of range in bytes
-         * @param offset Zero-based byte offset from the beginning of the memory
-         *   object, MUST be a multiple of VkPhysicalDeviceLimits::nonCoherentAtomSize
-         * @pre If size is not equal to VK_WHOLE_SIZE, size must either be
-         *  a multiple of VkPhysicalDeviceLimits::nonCoherentAtomSize, or offset
-         *  plus size must equal the size of memory.
+         * @param offset Zero-based byte offset from the beginning of the buffer,
+         *   MUST be a multiple of VkPhysicalDeviceLimits::nonCoherentAtomSize
+         * @pre If size is not equal to VK_WHOLE_SIZE, size must be
+         *  a multiple of VkPhysicalDeviceLimits::nonCoherentAtomSize
          */
         void FlushMappedRange(VkDeviceSize size = VK_WHOLE_SIZE,
                               VkDeviceSize offset = 0) const;
+
+        /**
+         * @brief Invalidates mapped memory range, so that the device writes
+         *  are visible to the host (for memory *NOT* HOST_COHERENT)
+         * @pre Same as of "FlushMappedRange()"
+         */
+        void InvalidateMappedRange(VkDeviceSize size = VK_WHOLE_SIZE,
+                                   VkDeviceSize offset = 0) const;
         
         /**
          * @brief In order to create a buffer view, the buffer must have been
@@ -169,22 +192,27 @@ namespace vkp
     private:
         void CreateBuffer(VkDeviceSize size, 
                           VkBufferUsageFlags usage, 
-                          VkSharingMode sharingMode);
+                          VkSharingMode sharingMode,
+                          const std::vector<uint32_t>& queueFamilyIndices);
 
-        void AllocateMemory(VkMemoryPropertyFlags properties);
+        void AllocateMemory(VkMemoryPropertyFlags properties,
+                            const MemoryAllocation* aliasedMemory);
 
         /** 
-         * @brief Associate the memory with the buffer at offset 'offset'
+         * @brief Associate the memory with the buffer, at the allocation's
+         *  offset
          */
-        void Bind(VkDeviceSize offset = 0) const;
+        void Bind() const;
 
         void Destroy();
 
     private:
         const Device& m_Device;
+        const MemoryTag m_MemoryTag;
 
-        VkBuffer       m_Buffer       { VK_NULL_HANDLE };
-        VkDeviceMemory m_BufferMemory { VK_NULL_HANDLE };
+        VkBuffer         m_Buffer{ VK_NULL_HANDLE };
+        // Range of a block shared with other resources
+        MemoryAllocation m_Memory;
 
         // Address of the mapped memory region
         void*          m_MapAddr       { nullptr }; 
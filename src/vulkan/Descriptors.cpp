@@ -19,15 +19,24 @@ namespace vkp
         return *this;
     }
 
+    DescriptorSetLayout::Builder& DescriptorSetLayout::Builder::SetFlags(
+        VkDescriptorSetLayoutCreateFlags flags)
+    {
+        m_Flags = flags;
+        return *this;
+    }
+
     std::unique_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::Build()
         const
     {
         VKP_REGISTER_FUNCTION();
-        return std::make_unique<DescriptorSetLayout>(m_Device, m_Bindings);
+        return std::make_unique<DescriptorSetLayout>(m_Device, m_Bindings,
+                                                     m_Flags);
     }
 
     DescriptorSetLayout::DescriptorSetLayout(const Device& device,
-                                             BindingMap bindings)
+                                             BindingMap bindings,
+                                             VkDescriptorSetLayoutCreateFlags flags)
         : m_Device(device),
           m_Bindings(bindings)
     {
@@ -44,6 +53,7 @@ namespace vkp
 
         VkDescriptorSetLayoutCreateInfo layoutInfo{};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.flags = flags;
         layoutInfo.bindingCount = static_cast<uint32_t>(bindingsArr.size());
         layoutInfo.pBindings = bindingsArr.data();
 
@@ -121,6 +131,7 @@ namespace vkp
         allocInfo.descriptorSetCount = 1;
         allocInfo.pSetLayouts = &descriptorSetLayout;
 
+        std::lock_guard<std::mutex> lock(m_Mutex);
         return vkAllocateDescriptorSets(m_Device, &allocInfo, &descriptorSet);
     }
 
@@ -129,6 +140,7 @@ namespace vkp
     {
         VKP_REGISTER_FUNCTION();
 
+        std::lock_guard<std::mutex> lock(m_Mutex);
         vkFreeDescriptorSets(m_Device, m_Pool, 
                              static_cast<uint32_t>(descriptorSets.size()),
                              descriptorSets.data());
@@ -137,6 +149,8 @@ namespace vkp
     void DescriptorPool::Reset(VkDescriptorPoolResetFlags flags)
     {
         VKP_REGISTER_FUNCTION();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
         vkResetDescriptorPool(m_Device, m_Pool, flags);
     }
 
@@ -253,4 +267,101 @@ namespace vkp
         return allocRes;
     }
 
+    void DescriptorWriter::PushSet(VkCommandBuffer cmdBuffer,
+                                   VkPipelineBindPoint bindPoint,
+                                   VkPipelineLayout pipelineLayout,
+                                   uint32_t set)
+    {
+        // Destination sets are ignored
+        m_Pool.m_Device.CmdPushDescriptorSet(cmdBuffer, bindPoint,
+                                             pipelineLayout, set, m_Writes);
+    }
+
+    // -------------------------------------------------------------------------
+
+    DescriptorUpdateTemplate::Builder&
+    DescriptorUpdateTemplate::Builder::AddBinding(uint32_t binding,
+                                                  size_t offset)
+    {
+        VKP_REGISTER_FUNCTION();
+        VKP_ASSERT_MSG(m_Layout.m_Bindings.count(binding) == 1,
+                       "Wrong layout binding for descriptor update template");
+
+        const VkDescriptorSetLayoutBinding& kBinding =
+            m_Layout.m_Bindings.at(binding);
+
+        m_Entries.push_back(VkDescriptorUpdateTemplateEntry{
+            .dstBinding = binding,
+            .dstArrayElement = 0,
+            .descriptorCount = kBinding.descriptorCount,
+            .descriptorType = kBinding.descriptorType,
+            .offset = offset,
+            .stride = GetInfoSize(kBinding.descriptorType)
+        });
+
+        return *this;
+    }
+
+    std::unique_ptr<DescriptorUpdateTemplate>
+    DescriptorUpdateTemplate::Builder::Build() const
+    {
+        VKP_REGISTER_FUNCTION();
+        return std::make_unique<DescriptorUpdateTemplate>(m_Device, m_Layout,
+                                                          m_Entries);
+    }
+
+    DescriptorUpdateTemplate::DescriptorUpdateTemplate(
+        const Device& device,
+        const DescriptorSetLayout& layout,
+        const std::vector<VkDescriptorUpdateTemplateEntry>& entries)
+        : m_Device(device)
+    {
+        VKP_REGISTER_FUNCTION();
+        VKP_ASSERT(!entries.empty());
+
+        VkDescriptorUpdateTemplateCreateInfo createInfo{};
+        createInfo.sType =
+            VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        createInfo.descriptorUpdateEntryCount =
+            static_cast<uint32_t>(entries.size());
+        createInfo.pDescriptorUpdateEntries = entries.data();
+        createInfo.templateType =
+            VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        createInfo.descriptorSetLayout = layout;
+
+        auto err = vkCreateDescriptorUpdateTemplate(m_Device, &createInfo,
+                                                    nullptr, &m_Template);
+        VKP_ASSERT_RESULT(err);
+    }
+
+    DescriptorUpdateTemplate::~DescriptorUpdateTemplate()
+    {
+        VKP_REGISTER_FUNCTION();
+        vkDestroyDescriptorUpdateTemplate(m_Device, m_Template, nullptr);
+    }
+
+    void DescriptorUpdateTemplate::UpdateSet(VkDescriptorSet dstSet,
+                                             const void* data) const
+    {
+        vkUpdateDescriptorSetWithTemplate(m_Device, dstSet, m_Template, data);
+    }
+
+    size_t DescriptorUpdateTemplate::GetInfoSize(VkDescriptorType type)
+    {
+        switch (type)
+        {
+            case VK_DESCRIPTOR_TYPE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                return sizeof(VkDescriptorImageInfo);
+            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                return sizeof(VkBufferView);
+            default:
+                return sizeof(VkDescriptorBufferInfo);
+        }
+    }
+
 } // namespace vkp
\ No newline at end of file
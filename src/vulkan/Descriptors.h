@@ -7,6 +7,7 @@
 #define WATER_SURFACE_RENDERING_VULKAN_DESCRIPTORS_H_
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 #include <vulkan/vulkan.h>
@@ -58,6 +59,18 @@ writer.AddBufferDescriptor(0, bufferInfo)
       .AddImageDescriptor(1, imageInfo)
       .AddBufferDescriptor(2, bufferInfo)
 .Build()
+
+// 4b. Or, update them repeatedly from a struct of the infos, with a template
+
+struct Infos { VkDescriptorBufferInfo ubo; VkDescriptorImageInfo image; };
+
+std::unique_ptr<DescriptorUpdateTemplate> updateTemplate =
+    DescriptorUpdateTemplate::Builder(device, *layout)
+        .AddBinding(0, offsetof(Infos, ubo))
+        .AddBinding(1, offsetof(Infos, image))
+    .Build();
+
+updateTemplate->UpdateSet(descriptorSets[i], &infos);
  
 */
 
@@ -108,6 +121,12 @@ namespace vkp
 
             Builder& AddBinding(DescriptorSetLayoutBinding binding);
 
+            /**
+             * @param flags E.g., VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR
+             *  for the sets pushed by "DescriptorWriter::PushSet()"
+             */
+            Builder& SetFlags(VkDescriptorSetLayoutCreateFlags flags);
+
             /** 
              * @return Unique pointer to the built DescriptorSetLayout from the
              *  previously added layout bindings
@@ -118,11 +137,13 @@ namespace vkp
             const Device& m_Device;
 
             BindingMap m_Bindings{};
+            VkDescriptorSetLayoutCreateFlags m_Flags{ 0 };
         };
 
         /// 
         DescriptorSetLayout(const Device& device, 
-                            BindingMap bindings);
+                            BindingMap bindings,
+                            VkDescriptorSetLayoutCreateFlags flags = 0);
         ~DescriptorSetLayout();
 
         operator VkDescriptorSetLayout() const { return m_Layout; }
@@ -138,6 +159,7 @@ namespace vkp
 
     private:
         friend class DescriptorWriter;
+        friend class DescriptorUpdateTemplate;
 
         const Device& m_Device;
 
@@ -218,6 +240,9 @@ namespace vkp
         Device& m_Device;
 
         VkDescriptorPool m_Pool{ VK_NULL_HANDLE };
+        // Of the allocations and frees, the pool is externally synchronized,
+        //  e.g., of the assets created concurrently at startup
+        mutable std::mutex m_Mutex;
     };
 
     class DescriptorWriter
@@ -279,6 +304,19 @@ namespace vkp
          * @return Result of allocation
          */
         VkResult BuildSet(VkDescriptorSet& dstSet);
+
+        /**
+         * @brief Records all the previously added writes into the command
+         *  buffer, as the set 'set' of the pipeline layout, without any
+         *  descriptor set to allocate or update
+         * @pre The layout was created with
+         *  VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR, and
+         *  the device "SupportsPushDescriptors()"
+         */
+        void PushSet(VkCommandBuffer cmdBuffer,
+                     VkPipelineBindPoint bindPoint,
+                     VkPipelineLayout pipelineLayout,
+                     uint32_t set = 0);
         
     private:
         const DescriptorSetLayout& m_Layout;
@@ -287,6 +325,63 @@ namespace vkp
         std::vector<VkWriteDescriptorSet> m_Writes{};
     };
 
+    /**
+     * @brief Writes all the descriptors of a set at once, read from a struct
+     *  of their VkDescriptor*Info, without building the writes on each update
+     */
+    class DescriptorUpdateTemplate
+    {
+    public:
+        class Builder
+        {
+        public:
+            Builder(const Device& device, const DescriptorSetLayout& layout)
+                : m_Device(device), m_Layout(layout) {}
+
+            /**
+             * @brief Of all the descriptors of the binding in the layout
+             * @param offset Of its first info in the data, the others of
+             *  an array follow tightly
+             */
+            Builder& AddBinding(uint32_t binding, size_t offset);
+
+            std::unique_ptr<DescriptorUpdateTemplate> Build() const;
+
+        private:
+            const Device& m_Device;
+            const DescriptorSetLayout& m_Layout;
+
+            std::vector<VkDescriptorUpdateTemplateEntry> m_Entries{};
+        };
+
+        DescriptorUpdateTemplate(
+            const Device& device,
+            const DescriptorSetLayout& layout,
+            const std::vector<VkDescriptorUpdateTemplateEntry>& entries);
+        ~DescriptorUpdateTemplate();
+
+        operator VkDescriptorUpdateTemplate() const { return m_Template; }
+
+        /**
+         * @param data Infos at the offsets of the added bindings
+         * @warn Same as of "DescriptorWriter::UpdateSet()", the set must not
+         *  be used by a pending command buffer
+         */
+        void UpdateSet(VkDescriptorSet dstSet, const void* data) const;
+
+        DescriptorUpdateTemplate(const DescriptorUpdateTemplate&) = delete;
+        DescriptorUpdateTemplate& operator=(const DescriptorUpdateTemplate&) = delete;
+
+    private:
+        /** @return Of the info of a descriptor of the type in the data */
+        static size_t GetInfoSize(VkDescriptorType type);
+
+    private:
+        const Device& m_Device;
+
+        VkDescriptorUpdateTemplate m_Template{ VK_NULL_HANDLE };
+    };
+
 } // namespace vkp
 
 
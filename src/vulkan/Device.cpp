@@ -7,6 +7,12 @@
 #include "vulkan/Device.h"
 #include "vulkan/SwapChain.h"
 
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
 
 namespace vkp
 {
@@ -20,6 +26,11 @@ namespace vkp
 
         CreateLogicalDevice();
         RetrieveQueueHandles();
+        LoadExtensionFunctions();
+        CreateTimelines();
+        CreatePipelineCache();
+
+        m_MemoryAllocator = std::make_unique<MemoryAllocator>(*this);
     }
 
     Device::~Device()
@@ -55,9 +66,20 @@ namespace vkp
     {
         VKP_REGISTER_FUNCTION();
 
-        m_PhysicalDevice.SetEnabledFeatures(requirements.deviceFeatures);
+        m_PhysicalDevice.SetEnabledFeatures(
+            requirements.deviceFeatures,
+            requirements.optionalDeviceFeatures);
         m_PhysicalDevice.AddEnabledExtensions(requirements.deviceExtensions);
 
+        for (const char* extension : requirements.optionalDeviceExtensions)
+        {
+            if (m_PhysicalDevice.HasExtensions({ extension }))
+                m_PhysicalDevice.AddEnabledExtensions({ extension });
+            else
+                VKP_LOG_WARN("Optional extension {} is not supported",
+                             extension);
+        }
+
         if (requirements.presentationSupport)
         {
             bool swapChainSupported = m_PhysicalDevice.HasExtensions(
@@ -81,9 +103,134 @@ namespace vkp
         const std::vector<const char*> deviceEnabledExtensions = 
             m_PhysicalDevice.GetEnabledExtensions();
 
+        // Required by the extension, supported if it is
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{
+            .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+            .pNext = nullptr,
+            .timelineSemaphore = VK_TRUE
+        };
+        const bool kHasTimelineSemaphores = m_PhysicalDevice.HasEnabledExtensions(
+            { VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME });
+
+        // Of the presentation latency, the extensions are of no use without
+        //  their features, which are queried
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+            .pNext = nullptr,
+            .presentWait = VK_FALSE
+        };
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+            .pNext = &presentWaitFeatures,
+            .presentId = VK_FALSE
+        };
+        if (m_PhysicalDevice.HasEnabledExtensions(
+                { VK_KHR_PRESENT_ID_EXTENSION_NAME,
+                  VK_KHR_PRESENT_WAIT_EXTENSION_NAME }))
+        {
+            VkPhysicalDeviceFeatures2 features2{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &presentIdFeatures
+            };
+            vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features2);
+
+            m_HasPresentWaitFeatures = presentIdFeatures.presentId &&
+                                       presentWaitFeatures.presentWait;
+        }
+
+        // Of the reduced shading rate of the water, written by the vertex
+        //  shaders per primitive
+        VkPhysicalDeviceFragmentShadingRateFeaturesKHR shadingRateFeatures{
+            .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR,
+            .pNext = nullptr,
+            .pipelineFragmentShadingRate = VK_FALSE,
+            .primitiveFragmentShadingRate = VK_FALSE,
+            .attachmentFragmentShadingRate = VK_FALSE
+        };
+        if (m_PhysicalDevice.HasEnabledExtensions(
+                { VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME,
+                  VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME }))
+        {
+            VkPhysicalDeviceFeatures2 features2{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &shadingRateFeatures
+            };
+            vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features2);
+
+            m_HasPrimitiveShadingRate =
+                shadingRateFeatures.pipelineFragmentShadingRate &&
+                shadingRateFeatures.primitiveFragmentShadingRate;
+            // Of the attachments, not used
+            shadingRateFeatures.attachmentFragmentShadingRate = VK_FALSE;
+        }
+
+        // Of the views rendered by a single pass, core of Vulkan 1.1
+        VkPhysicalDeviceMultiviewFeatures multiviewFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES,
+            .pNext = nullptr,
+            .multiview = VK_FALSE,
+            .multiviewGeometryShader = VK_FALSE,
+            .multiviewTessellationShader = VK_FALSE
+        };
+        if (m_PhysicalDevice.GetProperties().apiVersion >= VK_API_VERSION_1_1)
+        {
+            VkPhysicalDeviceFeatures2 features2{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &multiviewFeatures
+            };
+            vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features2);
+
+            VkPhysicalDeviceMultiviewProperties multiviewProperties{
+                .sType =
+                    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES,
+                .pNext = nullptr
+            };
+            VkPhysicalDeviceProperties2 properties2{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                .pNext = &multiviewProperties
+            };
+            vkGetPhysicalDeviceProperties2(m_PhysicalDevice, &properties2);
+
+            m_HasMultiview = multiviewFeatures.multiview;
+            m_HasMultiviewTessellation =
+                m_HasMultiview &&
+                multiviewFeatures.multiviewTessellationShader &&
+                m_PhysicalDevice.GetEnabledFeatures().tessellationShader;
+            m_MaxMultiviewViewCount =
+                m_HasMultiview ? multiviewProperties.maxMultiviewViewCount : 1;
+            // Not used
+            multiviewFeatures.multiviewGeometryShader = VK_FALSE;
+        }
+
+        void* featuresChain = nullptr;
+        if (m_HasMultiview)
+        {
+            multiviewFeatures.multiviewTessellationShader =
+                m_HasMultiviewTessellation;
+            multiviewFeatures.pNext = featuresChain;
+            featuresChain = &multiviewFeatures;
+        }
+        if (m_HasPrimitiveShadingRate)
+        {
+            shadingRateFeatures.pNext = featuresChain;
+            featuresChain = &shadingRateFeatures;
+        }
+        if (m_HasPresentWaitFeatures)
+        {
+            presentWaitFeatures.pNext = featuresChain;
+            featuresChain = &presentIdFeatures;
+        }
+        if (kHasTimelineSemaphores)
+        {
+            timelineFeatures.pNext = featuresChain;
+            featuresChain = &timelineFeatures;
+        }
+
         VkDeviceCreateInfo createInfo{
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-            .pNext = nullptr,
+            .pNext = featuresChain,
             .flags = 0,
             .queueCreateInfoCount = 
                 static_cast<uint32_t>(kQueueCreateInfos.size()),
@@ -109,6 +256,146 @@ namespace vkp
         VKP_ASSERT_RESULT(err);
     }
 
+    void Device::LoadExtensionFunctions()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        if (m_PhysicalDevice.HasEnabledExtensions(
+                { VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME }))
+        {
+            m_CmdPushDescriptorSet = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+                vkGetDeviceProcAddr(m_Device, "vkCmdPushDescriptorSetKHR")
+            );
+        }
+
+        if (m_PhysicalDevice.HasEnabledExtensions(
+                { VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME }))
+        {
+            m_WaitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(
+                vkGetDeviceProcAddr(m_Device, "vkWaitSemaphoresKHR")
+            );
+            m_GetSemaphoreCounterValue =
+                reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+                    vkGetDeviceProcAddr(m_Device,
+                                        "vkGetSemaphoreCounterValueKHR")
+                );
+        }
+
+        if (m_HasPresentWaitFeatures)
+        {
+            m_WaitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+                vkGetDeviceProcAddr(m_Device, "vkWaitForPresentKHR")
+            );
+        }
+
+        if (m_PhysicalDevice.HasEnabledExtensions(
+                { VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME }))
+        {
+            m_GetPastPresentationTiming =
+                reinterpret_cast<PFN_vkGetPastPresentationTimingGOOGLE>(
+                    vkGetDeviceProcAddr(m_Device,
+                                        "vkGetPastPresentationTimingGOOGLE")
+                );
+        }
+    }
+
+    void Device::CreateTimelines()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        const auto& kQueueIndices =
+            m_PhysicalDevice.GetQueueFamilyIndices().indices;
+
+        for (uint32_t i = 0; i < TotalQueues(); ++i)
+        {
+            if (kQueueIndices[i].has_value())
+            {
+                m_Timelines[i] = std::make_unique<Timeline>(
+                    *this, static_cast<QFamily>(i)
+                );
+            }
+        }
+
+        VKP_LOG_INFO("Queue timelines of {}", SupportsTimelineSemaphores()
+                                              ? "timeline semaphores"
+                                              : "fences");
+    }
+
+    VkResult Device::WaitSemaphore(
+        VkSemaphore semaphore,
+        uint64_t value,
+        uint64_t timeout) const
+    {
+        VKP_ASSERT(SupportsTimelineSemaphores());
+
+        VkSemaphoreWaitInfoKHR waitInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores = &semaphore,
+            .pValues = &value
+        };
+
+        return m_WaitSemaphores(m_Device, &waitInfo, timeout);
+    }
+
+    uint64_t Device::GetSemaphoreCounterValue(VkSemaphore semaphore) const
+    {
+        VKP_ASSERT(SupportsTimelineSemaphores());
+
+        uint64_t value = 0;
+        auto err = m_GetSemaphoreCounterValue(m_Device, semaphore, &value);
+        VKP_ASSERT_RESULT(err);
+
+        return value;
+    }
+
+    VkResult Device::WaitForPresent(
+        VkSwapchainKHR swapChain,
+        uint64_t presentId,
+        uint64_t timeout) const
+    {
+        VKP_ASSERT(SupportsPresentWait());
+        return m_WaitForPresent(m_Device, swapChain, presentId, timeout);
+    }
+
+    std::vector<VkPastPresentationTimingGOOGLE> Device::GetPastPresentationTiming(
+        VkSwapchainKHR swapChain) const
+    {
+        VKP_ASSERT(SupportsDisplayTiming());
+
+        uint32_t count = 0;
+        auto err = m_GetPastPresentationTiming(m_Device, swapChain, &count,
+                                               nullptr);
+        if (err != VK_SUCCESS || count == 0)
+            return {};
+
+        std::vector<VkPastPresentationTimingGOOGLE> timings(count);
+        err = m_GetPastPresentationTiming(m_Device, swapChain, &count,
+                                          timings.data());
+        // Of VK_INCOMPLETE, the rest are returned by the next call
+        if (err != VK_SUCCESS && err != VK_INCOMPLETE)
+            return {};
+
+        timings.resize(count);
+        return timings;
+    }
+
+    void Device::CmdPushDescriptorSet(
+        VkCommandBuffer cmdBuffer,
+        VkPipelineBindPoint bindPoint,
+        VkPipelineLayout layout,
+        uint32_t set,
+        const std::vector<VkWriteDescriptorSet>& writes) const
+    {
+        VKP_ASSERT(SupportsPushDescriptors());
+
+        m_CmdPushDescriptorSet(cmdBuffer, bindPoint, layout, set,
+                               static_cast<uint32_t>(writes.size()),
+                               writes.data());
+    }
+
     void Device::RetrieveQueueHandles()
     {
         const auto& kQueueIndices =
@@ -126,6 +413,113 @@ namespace vkp
             }
         }
     }
+    void Device::CreatePipelineCache()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        const std::filesystem::path kPath =
+            std::filesystem::path(s_kPipelineCacheDir) /
+            GetPipelineCacheFileName();
+
+        std::vector<char> data;
+        std::ifstream file(kPath, std::ios::ate | std::ios::binary);
+        if (file.is_open())
+        {
+            data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(data.data(), data.size());
+
+            if (!file || !IsPipelineCacheCompatible(data))
+            {
+                VKP_LOG_WARN("Pipeline cache is invalid, ignored: {}",
+                             kPath.string());
+                data.clear();
+            }
+        }
+
+        const VkPipelineCacheCreateInfo kCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .initialDataSize = data.size(),
+            .pInitialData = data.empty() ? nullptr : data.data()
+        };
+
+        auto err = vkCreatePipelineCache(m_Device, &kCreateInfo, nullptr,
+                                         &m_PipelineCache);
+        VKP_ASSERT_RESULT(err);
+
+        if (!data.empty())
+            VKP_LOG_INFO("Pipeline cache loaded: {}", kPath.string());
+    }
+
+    void Device::SavePipelineCache() const
+    {
+        size_t dataSize = 0;
+        auto err = vkGetPipelineCacheData(m_Device, m_PipelineCache,
+                                          &dataSize, nullptr);
+        if (err != VK_SUCCESS || dataSize == 0)
+            return;
+
+        std::vector<char> data(dataSize);
+        err = vkGetPipelineCacheData(m_Device, m_PipelineCache,
+                                     &dataSize, data.data());
+        if (err != VK_SUCCESS)
+            return;
+
+        std::error_code dirErr;
+        std::filesystem::create_directories(s_kPipelineCacheDir, dirErr);
+
+        const std::filesystem::path kPath =
+            std::filesystem::path(s_kPipelineCacheDir) /
+            GetPipelineCacheFileName();
+
+        std::ofstream file(kPath, std::ios::binary | std::ios::trunc);
+        if (!dirErr && file.write(data.data(), dataSize))
+            VKP_LOG_INFO("Pipeline cache saved: {}", kPath.string());
+        else
+            VKP_LOG_WARN("Pipeline cache could not be saved to: {}",
+                         kPath.string());
+    }
+
+    std::string Device::GetPipelineCacheFileName() const
+    {
+        const VkPhysicalDeviceProperties& kProps =
+            m_PhysicalDevice.GetProperties();
+
+        std::ostringstream name;
+        name << std::hex << std::setfill('0')
+             << std::setw(4) << kProps.vendorID << '_'
+             << std::setw(4) << kProps.deviceID << '_'
+             << std::setw(8) << kProps.driverVersion << '_';
+        for (uint8_t byte : kProps.pipelineCacheUUID)
+            name << std::setw(2) << static_cast<uint32_t>(byte);
+        name << ".bin";
+
+        return name.str();
+    }
+
+    bool Device::IsPipelineCacheCompatible(const std::vector<char>& data) const
+    {
+        // Header version one: length, version, vendor, device, UUID
+        const size_t kHeaderSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+        if (data.size() < kHeaderSize)
+            return false;
+
+        uint32_t header[4];
+        std::memcpy(header, data.data(), sizeof(header));
+
+        const VkPhysicalDeviceProperties& kProps =
+            m_PhysicalDevice.GetProperties();
+
+        return header[0] >= kHeaderSize &&
+               header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header[2] == kProps.vendorID &&
+               header[3] == kProps.deviceID &&
+               std::memcmp(data.data() + sizeof(header),
+                           kProps.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
     void Device::RetrievePresentQueueHandle()
 
     {
@@ -143,6 +537,10 @@ namespace vkp
 
     void Device::Destroy()
     {
+        // Wait for their submissions
+        for (auto& timeline : m_Timelines)
+            timeline.reset();
+
         // Descriptor sets allocated from the pool are implicitly freed
         for (auto descriptorPool : m_DescriptorPools)
         {
@@ -150,6 +548,15 @@ namespace vkp
             descriptorPool = VK_NULL_HANDLE;
         }
 
+        m_MemoryAllocator.reset();
+
+        if (m_PipelineCache != VK_NULL_HANDLE)
+        {
+            SavePipelineCache();
+            vkDestroyPipelineCache(m_Device, m_PipelineCache, nullptr);
+            m_PipelineCache = VK_NULL_HANDLE;
+        }
+
         vkDestroyDevice(m_Device, nullptr);
     }
 
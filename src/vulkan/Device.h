@@ -6,12 +6,18 @@
 #ifndef WATER_SURFACE_RENDERING_VULKAN_DEVICE_H_ 
 #define WATER_SURFACE_RENDERING_VULKAN_DEVICE_H_
 
+#include <array>
 #include <optional>
 #include <vector>
 #include <map>
+#include <memory>
+#include <string>
+#include <string_view>
 #include "vulkan/Instance.h"
 #include "vulkan/PhysicalDevice.h"
 #include "vulkan/QueueTypes.h"
+#include "vulkan/MemoryAllocator.h"
+#include "vulkan/Timeline.h"
 
 
 namespace vkp
@@ -30,8 +36,12 @@ namespace vkp
         {
             VkPhysicalDeviceType         deviceType;
             VkPhysicalDeviceFeatures     deviceFeatures;
+            // Enabled only if supported, @see PhysicalDevice::GetEnabledFeatures()
+            VkPhysicalDeviceFeatures     optionalDeviceFeatures;
             std::vector<VkQueueFlagBits> queueFamilies;
             std::vector<const char*>     deviceExtensions;
+            // Enabled only if supported, @see PhysicalDevice::HasEnabledExtensions()
+            std::vector<const char*>     optionalDeviceExtensions;
             bool                         presentationSupport;
         };
 
@@ -54,6 +64,106 @@ namespace vkp
 
         VkQueue GetQueue(QFamily f) const { return m_Queues[f]; }
 
+        /** @brief Sub-allocates the memory of the buffers and images */
+        MemoryAllocator& GetMemoryAllocator() const
+        {
+            return *m_MemoryAllocator;
+        }
+
+        /**
+         * @brief Shared by all the pipelines of the device, loaded from
+         *  s_kPipelineCacheDir on creation if it matches the device and
+         *  the driver, saved back on destruction
+         */
+        VkPipelineCache GetPipelineCache() const { return m_PipelineCache; }
+
+        /** @return True if VK_KHR_push_descriptor is enabled */
+        bool SupportsPushDescriptors() const {
+            return m_CmdPushDescriptorSet != nullptr;
+        }
+
+        /** @pre "SupportsPushDescriptors()" */
+        void CmdPushDescriptorSet(
+            VkCommandBuffer cmdBuffer,
+            VkPipelineBindPoint bindPoint,
+            VkPipelineLayout layout,
+            uint32_t set,
+            const std::vector<VkWriteDescriptorSet>& writes) const;
+
+        /** @return True if VK_KHR_timeline_semaphore is enabled */
+        bool SupportsTimelineSemaphores() const {
+            return m_WaitSemaphores != nullptr;
+        }
+
+        /**
+         * @return Of the submissions to the queue of the family, through
+         *  "Timeline::Submit()"
+         * @pre The queue family has a queue
+         */
+        Timeline& GetTimeline(QFamily f) const {
+            VKP_ASSERT(m_Timelines[QFamilyToSize(f)] != nullptr);
+            return *m_Timelines[QFamilyToSize(f)];
+        }
+
+        /** @pre "SupportsTimelineSemaphores()" */
+        VkResult WaitSemaphore(VkSemaphore semaphore,
+                               uint64_t value,
+                               uint64_t timeout = UINT64_MAX) const;
+        /** @pre "SupportsTimelineSemaphores()" */
+        uint64_t GetSemaphoreCounterValue(VkSemaphore semaphore) const;
+
+        /**
+         * @return True if VK_KHR_present_id and VK_KHR_present_wait are
+         *  enabled, along with their features
+         */
+        bool SupportsPresentWait() const { return m_WaitForPresent != nullptr; }
+
+        /**
+         * @pre "SupportsPresentWait()"
+         * @return VK_SUCCESS once the present of the id is displayed,
+         *  VK_TIMEOUT if it is not yet within the timeout
+         */
+        VkResult WaitForPresent(VkSwapchainKHR swapChain,
+                                uint64_t presentId,
+                                uint64_t timeout) const;
+
+        /**
+         * @return True if VK_KHR_fragment_shading_rate is enabled, with its
+         *  pipeline and primitive features, e.g., of the rates written by
+         *  the vertex shaders
+         */
+        bool SupportsPrimitiveShadingRate() const {
+            return m_HasPrimitiveShadingRate;
+        }
+
+        /**
+         * @return True if the multiview feature of Vulkan 1.1 is enabled, of
+         *  the render passes of several views,
+         *  @see "RenderPass::SetViewCount()"
+         */
+        bool SupportsMultiview() const { return m_HasMultiview; }
+        /** @return True if the multiview passes may draw tessellated patches */
+        bool SupportsMultiviewTessellation() const {
+            return m_HasMultiviewTessellation;
+        }
+        /** @return Of the views of a multiview pass, 1 without the feature */
+        uint32_t GetMaxMultiviewViewCount() const {
+            return m_MaxMultiviewViewCount;
+        }
+
+        /** @return True if VK_GOOGLE_display_timing is enabled */
+        bool SupportsDisplayTiming() const {
+            return m_GetPastPresentationTiming != nullptr;
+        }
+
+        /**
+         * @pre "SupportsDisplayTiming()"
+         * @return Timings of the presents displayed since the last call,
+         *  each returned once
+         */
+        std::vector<VkPastPresentationTimingGOOGLE> GetPastPresentationTiming(
+            VkSwapchainKHR swapChain) const;
+
         /**
          * @brief Submits command buffers in 'submitInfos' to a queue of the
          *  requested queue family.
@@ -161,6 +271,22 @@ namespace vkp
         std::vector<VkDeviceQueueCreateInfo> InitRequiredQueueCreateInfos() const;
 
         void RetrieveQueueHandles();
+        /** @brief Of the enabled optional extensions */
+        void LoadExtensionFunctions();
+        void CreateTimelines();
+
+        /** @brief Of the cached data, if valid, else empty */
+        void CreatePipelineCache();
+        void SavePipelineCache() const;
+
+        /**
+         * @return Keyed by the vendor, the device, the driver version and
+         *  the pipeline cache UUID, of which cached data are compatible
+         */
+        std::string GetPipelineCacheFileName() const;
+
+        /** @return Whether the header of the data matches the device */
+        bool IsPipelineCacheCompatible(const std::vector<char>& data) const;
 
         void Destroy();
 
@@ -171,6 +297,28 @@ namespace vkp
         Queues m_Queues;    ///< Queues created along with the device
 
         std::vector<VkDescriptorPool> m_DescriptorPools;
+
+        static constexpr std::string_view s_kPipelineCacheDir{ "cache/pipeline" };
+        VkPipelineCache m_PipelineCache{ VK_NULL_HANDLE };
+
+        PFN_vkCmdPushDescriptorSetKHR m_CmdPushDescriptorSet{ nullptr };
+        PFN_vkWaitSemaphoresKHR m_WaitSemaphores{ nullptr };
+        PFN_vkGetSemaphoreCounterValueKHR m_GetSemaphoreCounterValue{ nullptr };
+        PFN_vkWaitForPresentKHR m_WaitForPresent{ nullptr };
+        PFN_vkGetPastPresentationTimingGOOGLE m_GetPastPresentationTiming{ nullptr };
+        // Both features of VK_KHR_present_id and VK_KHR_present_wait
+        bool m_HasPresentWaitFeatures{ false };
+        // Pipeline and primitive features of VK_KHR_fragment_shading_rate
+        bool m_HasPrimitiveShadingRate{ false };
+        // Features of the multiview of Vulkan 1.1
+        bool m_HasMultiview{ false };
+        bool m_HasMultiviewTessellation{ false };
+        uint32_t m_MaxMultiviewViewCount{ 1 };
+
+        // Of each queue family with a queue
+        std::array<std::unique_ptr<Timeline>, TotalQueues()> m_Timelines;
+
+        std::unique_ptr<MemoryAllocator> m_MemoryAllocator{ nullptr };
     };
 
 } // namespace vkp
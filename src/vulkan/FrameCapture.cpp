@@ -0,0 +1,294 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "vulkan/FrameCapture.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "core/Profile.h"
+
+
+namespace vkp
+{
+    FrameCapture::FrameCapture(const Device& device, const Settings& settings)
+        : m_kDevice(device),
+          m_Settings(settings)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        m_Settings.latency = std::max(settings.latency, 1u);
+
+        std::error_code err;
+        std::filesystem::create_directories(m_Settings.outputDir, err);
+        if (err)
+        {
+            VKP_LOG_WARN("Frame capture: could not create {}",
+                         m_Settings.outputDir.string());
+        }
+
+        // Slices are invalidated separately
+        m_SliceSize = m_kDevice.GetNonCoherentAtomSizeAlignment(GetCopySize());
+
+        m_Buffer.reset(new Buffer(m_kDevice, MemoryTag::Staging));
+        m_Buffer->Create(m_SliceSize * m_Settings.latency,
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         GetMemoryProperties());
+
+        auto mapErr = m_Buffer->Map();
+        VKP_ASSERT_RESULT(mapErr);
+
+        m_CmdPool.reset(new CommandPool(
+            m_kDevice, QFamily::Graphics,
+            VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+        ));
+        m_CmdPool->AllocateCommandBuffers(m_Settings.latency);
+        m_SubmitValues.assign(m_Settings.latency, 0);
+
+        m_Thread = std::thread(&FrameCapture::Run, this);
+
+        VKP_LOG_INFO("Frame capture: {} frames of {}x{}, step {} s, into {}",
+                     m_Settings.frameCount, m_Settings.width,
+                     m_Settings.height, m_Settings.timeStep,
+                     m_Settings.outputDir.string());
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        // Submitted frames are written first
+        m_Running.store(false);
+        Notify(m_WorkCondition);
+
+        if (m_Thread.joinable())
+            m_Thread.join();
+
+        VKP_LOG_INFO("Frame capture: {} frames written",
+                     m_Written.load(std::memory_order_relaxed));
+    }
+
+    VkCommandBuffer FrameCapture::RecordCopy(VkImage image, VkExtent2D extent)
+    {
+        VKP_PROFILE_SCOPE();
+        VKP_ASSERT(!m_IsRecorded);
+        VKP_ASSERT(extent.width == m_Settings.width &&
+                   extent.height == m_Settings.height);
+
+        const uint64_t kIndex = m_Submitted.load(std::memory_order_relaxed);
+        const auto kIsFree = [this, kIndex]() {
+            return kIndex - m_Written.load(std::memory_order_acquire) <
+                   m_Settings.latency;
+        };
+
+        // Slot is free once its previous frame is written
+        if (!kIsFree())
+        {
+            VKP_PROFILE_SCOPE("FrameCapture::RecordCopy wait");
+
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_DoneCondition.wait(lock, kIsFree);
+        }
+
+        const uint32_t kSlot = static_cast<uint32_t>(kIndex %
+                                                     m_Settings.latency);
+        const VkDeviceSize kSliceOffset = m_SliceSize * kSlot;
+
+        // Its previous submission is done, the writer waited for it
+        CommandBuffer& cmdBuffer = (*m_CmdPool)[kSlot];
+        cmdBuffer.Reset();
+        cmdBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        // After the render pass, its final layout is kept
+        const VkImageMemoryBarrier kImageBarrier{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+        vkCmdPipelineBarrier(cmdBuffer,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &kImageBarrier);
+
+        const VkBufferImageCopy kRegion{
+            .bufferOffset = kSliceOffset,
+            // Tightly packed data
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = { extent.width, extent.height, 1 }
+        };
+        vkCmdCopyImageToBuffer(cmdBuffer,
+                               image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               *m_Buffer,
+                               1, &kRegion);
+
+        // Visible to the host once the timeline reaches the submission
+        const VkBufferMemoryBarrier kBufferBarrier{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = *m_Buffer,
+            .offset = kSliceOffset,
+            .size = GetCopySize()
+        };
+        vkCmdPipelineBarrier(cmdBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                             0,
+                             0, nullptr,
+                             1, &kBufferBarrier,
+                             0, nullptr);
+
+        cmdBuffer.End();
+        m_IsRecorded = true;
+
+        return cmdBuffer;
+    }
+
+    void FrameCapture::Submit(uint64_t submitValue)
+    {
+        VKP_ASSERT(m_IsRecorded);
+
+        const uint64_t kIndex = m_Submitted.load(std::memory_order_relaxed);
+        m_SubmitValues[kIndex % m_Settings.latency] = submitValue;
+        m_IsRecorded = false;
+
+        m_Submitted.store(kIndex + 1, std::memory_order_release);
+        Notify(m_WorkCondition);
+    }
+
+    // =========================================================================
+
+    void FrameCapture::Run()
+    {
+        const auto kHasWork = [this]() {
+            return m_Submitted.load(std::memory_order_acquire) >
+                   m_Written.load(std::memory_order_relaxed);
+        };
+
+        const Timeline& kTimeline = m_kDevice.GetTimeline(QFamily::Graphics);
+        const uint8_t* kMapped =
+            static_cast<const uint8_t*>(m_Buffer->GetMappedAddress());
+        std::vector<uint8_t> rgb(GetCopySize() / 4 * 3);
+
+        while (true)
+        {
+            if (!kHasWork())
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_WorkCondition.wait(lock, [this, &kHasWork]() {
+                    return !m_Running.load() || kHasWork();
+                });
+            }
+
+            // Stopped, once the submitted frames are written
+            if (!kHasWork())
+                return;
+
+            const uint64_t kIndex = m_Written.load(std::memory_order_relaxed);
+            const uint32_t kSlot = static_cast<uint32_t>(kIndex %
+                                                         m_Settings.latency);
+            const VkDeviceSize kSliceOffset = m_SliceSize * kSlot;
+
+            kTimeline.Wait(m_SubmitValues[kSlot]);
+            m_Buffer->InvalidateMappedRange(m_SliceSize, kSliceOffset);
+
+            Write(kIndex, kMapped + kSliceOffset, rgb);
+
+            m_Written.store(kIndex + 1, std::memory_order_release);
+            Notify(m_DoneCondition);
+        }
+    }
+
+    bool FrameCapture::Write(uint64_t frame, const uint8_t* data,
+                             std::vector<uint8_t>& rgb) const
+    {
+        VKP_PROFILE_SCOPE();
+
+        // BGRA to the RGB of binary PPM, alpha is dropped
+        const size_t kTexelCount = rgb.size() / 3;
+        for (size_t i = 0; i < kTexelCount; ++i)
+        {
+            rgb[3 * i + 0] = data[4 * i + 2];
+            rgb[3 * i + 1] = data[4 * i + 1];
+            rgb[3 * i + 2] = data[4 * i + 0];
+        }
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%06llu.ppm",
+                      static_cast<unsigned long long>(frame));
+        const std::filesystem::path kPath = m_Settings.outputDir / name;
+
+        std::ofstream file(kPath, std::ios::binary | std::ios::trunc);
+        file << "P6\n" << m_Settings.width << " " << m_Settings.height
+             << "\n255\n";
+        file.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+
+        if (!file)
+        {
+            VKP_LOG_ERR("Frame capture: could not write {}", kPath.string());
+            return false;
+        }
+        return true;
+    }
+
+    VkMemoryPropertyFlags FrameCapture::GetMemoryProperties() const
+    {
+        // Read by the host, uncached reads are slow
+        constexpr VkMemoryPropertyFlags kCached =
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+        const VkPhysicalDeviceMemoryProperties& kProperties =
+            m_kDevice.GetPhysicalDevice().GetMemoryProperties();
+        for (uint32_t i = 0; i < kProperties.memoryTypeCount; ++i)
+        {
+            if ((kProperties.memoryTypes[i].propertyFlags & kCached) ==
+                kCached)
+            {
+                return kCached;
+            }
+        }
+        return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    }
+
+    void FrameCapture::Notify(std::condition_variable& condition)
+    {
+        // Waiter is either before its check of the counters, or already
+        //  waiting
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+        }
+        condition.notify_one();
+    }
+
+} // namespace vkp
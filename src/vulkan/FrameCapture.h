@@ -0,0 +1,136 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_VULKAN_FRAME_CAPTURE_H_
+#define WATER_SURFACE_RENDERING_VULKAN_FRAME_CAPTURE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan/Device.h"
+#include "vulkan/Buffer.h"
+#include "vulkan/CommandPool.h"
+
+
+namespace vkp
+{
+    /**
+     * @brief Captures a fixed count of frames rendered offscreen, each
+     *  advanced by the same time step, into "frame_NNNNNN.ppm" images of
+     *  a directory, e.g., to be encoded by "ffmpeg -i frame_%06d.ppm".
+     *
+     * Each frame's image is copied by a command buffer of its own, submitted
+     *  after those of the frame, to a slot of a ring of host-visible slices.
+     *  A writer thread waits for the graphics timeline to reach the frame's
+     *  submission, converts the slice to RGB and writes it, then frees the
+     *  slot. The writer is up to "latency" frames behind, the main loop waits
+     *  only once all the slots are taken, so frames are rendered as fast as
+     *  the GPU and the disk allow, not at the display's rate.
+     *
+     * Usage, each frame:
+     *  1. "RecordCopy(image, extent)" once rendered, its buffer submitted
+     *      last of the frame
+     *  2. "Submit(submitValue)" of the frame's submission
+     */
+    class FrameCapture
+    {
+    public:
+        struct Settings
+        {
+            uint32_t frameCount{ 600 };
+            float timeStep{ 1.0f / 60.0f };     ///< In seconds
+            uint32_t width{ 1920 };
+            uint32_t height{ 1080 };
+            // Frames the writer may lag behind, slots of the ring
+            uint32_t latency{ 4 };
+            std::filesystem::path outputDir{ "capture" };
+        };
+
+        // Of the offscreen images of the swap chain, of 4 bytes per texel
+        static constexpr VkFormat s_kFormat{ VK_FORMAT_B8G8R8A8_UNORM };
+
+    public:
+        FrameCapture(const Device& device, const Settings& settings);
+        /** @brief Waits for the writer to write the submitted frames */
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        /**
+         * @brief Waits for the writer to free the slot of the next frame,
+         *  then records the copy of the image to it
+         * @param image Of s_kFormat, in LAYOUT_TRANSFER_SRC_OPTIMAL once
+         *  rendered to, of the extent of the settings, left in it
+         * @return Command buffer to submit after those rendering the image
+         */
+        VkCommandBuffer RecordCopy(VkImage image, VkExtent2D extent);
+
+        /**
+         * @brief Hands the slot of the last "RecordCopy()" to the writer
+         * @param submitValue Of the graphics timeline, of the submission of
+         *  the copy
+         */
+        void Submit(uint64_t submitValue);
+
+        bool IsDone() const {
+            return m_Submitted.load(std::memory_order_relaxed) >=
+                   m_Settings.frameCount;
+        }
+
+        const Settings& GetSettings() const { return m_Settings; }
+        float GetTimeStep() const { return m_Settings.timeStep; }
+
+    private:
+        void Run();
+        /** @return False if the frame's file is not written */
+        bool Write(uint64_t frame, const uint8_t* data,
+                   std::vector<uint8_t>& rgb) const;
+
+        /** @return Of the host-visible memory, cached if there is one */
+        VkMemoryPropertyFlags GetMemoryProperties() const;
+
+        VkDeviceSize GetCopySize() const {
+            return static_cast<VkDeviceSize>(m_Settings.width) *
+                   m_Settings.height * 4;
+        }
+
+        /** @brief Wakes up a thread waiting on the condition */
+        void Notify(std::condition_variable& condition);
+
+    private:
+        const Device& m_kDevice;
+        Settings m_Settings;
+
+        std::unique_ptr<Buffer> m_Buffer{ nullptr };
+        VkDeviceSize m_SliceSize{ 0 };
+        // Of each slot, reset once the slot is free again
+        std::unique_ptr<CommandPool> m_CmdPool{ nullptr };
+        // Of each slot, of its frame's submission
+        std::vector<uint64_t> m_SubmitValues;
+
+        // Counters of the ring, slot of a counter 'c' is 'c % latency'
+        std::atomic<uint64_t> m_Submitted{ 0 };    ///< Written by the caller
+        std::atomic<uint64_t> m_Written{ 0 };      ///< Written by the writer
+        bool m_IsRecorded{ false };     ///< Of the next frame, not submitted
+
+        std::atomic<bool> m_Running{ true };
+        std::mutex m_Mutex;
+        std::condition_variable m_WorkCondition;
+        std::condition_variable m_DoneCondition;
+
+        std::thread m_Thread;
+    };
+
+} // namespace vkp
+
+#endif // WATER_SURFACE_RENDERING_VULKAN_FRAME_CAPTURE_H_
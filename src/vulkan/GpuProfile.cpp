@@ -0,0 +1,339 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "vulkan/GpuProfile.h"
+
+
+namespace vkp
+{
+    static constexpr double s_kNanoToMillis{ 1e-6 };
+
+    void GpuProfile::Init(const Device& device, uint32_t frameCount,
+                          uint32_t viewCount)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        Destroy();
+
+        const PhysicalDevice& kPhysDevice = device.GetPhysicalDevice();
+        const uint32_t kValidBits =
+            kPhysDevice.GetTimestampValidBits(QFamily::Graphics);
+        if (kValidBits == 0)
+        {
+            VKP_LOG_WARN("GPU profiling: graphics queue has no timestamps");
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(s_Mutex);
+
+        s_Device = device;
+        s_TimestampPeriod = kPhysDevice.GetTimestampPeriod() * s_kNanoToMillis;
+        s_TimestampMask = kValidBits >= 64 ? ~0ull : (1ull << kValidBits) - 1;
+        s_QueryStride = std::max(viewCount, 1u);
+
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = 2 * s_kMaxScopeCount * s_QueryStride;
+
+        s_Frames.resize(frameCount);
+        for (Frame& frame : s_Frames)
+        {
+            auto err = vkCreateQueryPool(s_Device, &poolInfo, nullptr,
+                                         &frame.queryPool);
+            VKP_ASSERT_RESULT(err);
+            frame.scopes.reserve(s_kMaxScopeCount);
+        }
+
+        if (!kPhysDevice.GetEnabledFeatures().pipelineStatisticsQuery)
+            return;
+
+        // Written in the order of the bits, the tessellation's last
+        s_StatisticsFlags =
+            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+        if (kPhysDevice.GetEnabledFeatures().tessellationShader)
+        {
+            s_StatisticsFlags |= VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT;
+        }
+
+        VkQueryPoolCreateInfo statisticsPoolInfo{};
+        statisticsPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        statisticsPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statisticsPoolInfo.queryCount =
+            s_kMaxStatisticsScopeCount * s_QueryStride;
+        statisticsPoolInfo.pipelineStatistics = s_StatisticsFlags;
+
+        for (Frame& frame : s_Frames)
+        {
+            auto err = vkCreateQueryPool(s_Device, &statisticsPoolInfo,
+                                         nullptr, &frame.statisticsQueryPool);
+            VKP_ASSERT_RESULT(err);
+            frame.statisticsScopes.reserve(s_kMaxStatisticsScopeCount);
+        }
+    }
+
+    void GpuProfile::Destroy()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+
+        for (Frame& frame : s_Frames)
+        {
+            vkDestroyQueryPool(s_Device, frame.queryPool, nullptr);
+            vkDestroyQueryPool(s_Device, frame.statisticsQueryPool, nullptr);
+        }
+
+        s_Frames.clear();
+        s_RecordedFrame = nullptr;
+        s_FrameDuration = -1.0f;
+        s_StatisticsFlags = 0;
+        s_Statistics.clear();
+        s_QueryStride = 1;
+    }
+
+    void GpuProfile::BeginFrame(VkCommandBuffer cmdBuffer, uint32_t frameIndex)
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+
+        if (frameIndex >= s_Frames.size())
+            return;
+
+        Frame& frame = s_Frames[frameIndex];
+        s_FrameDuration = -1.0f;
+        if (!frame.scopes.empty())
+            ReadResults(frame);
+
+        vkCmdResetQueryPool(cmdBuffer, frame.queryPool, 0,
+                            2 * s_kMaxScopeCount * s_QueryStride);
+        frame.scopes.clear();
+
+        if (frame.statisticsQueryPool != VK_NULL_HANDLE)
+        {
+            s_Statistics.clear();
+            if (!frame.statisticsScopes.empty())
+                ReadStatistics(frame);
+
+            vkCmdResetQueryPool(cmdBuffer, frame.statisticsQueryPool, 0,
+                                s_kMaxStatisticsScopeCount * s_QueryStride);
+            frame.statisticsScopes.clear();
+        }
+        frame.cpuBegin = Profile::ToEpochMicros(Profile::Clock::now());
+
+        s_RecordedFrame = &frame;
+    }
+
+    void GpuProfile::EndFrame()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        s_RecordedFrame = nullptr;
+    }
+
+    uint32_t GpuProfile::BeginScope(
+        VkCommandBuffer cmdBuffer,
+        const char* name,
+        const char* fileName,
+        VkQueryPool* queryPool)
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+
+        if (s_RecordedFrame == nullptr ||
+            s_RecordedFrame->scopes.size() >= s_kMaxScopeCount)
+        {
+            return 0;
+        }
+
+        const auto kIndex =
+            static_cast<uint32_t>(s_RecordedFrame->scopes.size());
+        s_RecordedFrame->scopes.push_back({ name, fileName });
+
+        *queryPool = s_RecordedFrame->queryPool;
+        vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                            *queryPool, 2 * kIndex * s_QueryStride);
+        return kIndex;
+    }
+
+    void GpuProfile::EndScope(
+        VkCommandBuffer cmdBuffer,
+        VkQueryPool queryPool,
+        uint32_t index)
+    {
+        if (queryPool == VK_NULL_HANDLE)
+            return;
+
+        // Once all the commands of the scope are done
+        vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            queryPool, (2 * index + 1) * s_QueryStride);
+    }
+
+    uint32_t GpuProfile::BeginStatisticsScope(
+        VkCommandBuffer cmdBuffer,
+        const char* name,
+        VkQueryPool* queryPool)
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+
+        if (s_RecordedFrame == nullptr ||
+            s_RecordedFrame->statisticsQueryPool == VK_NULL_HANDLE ||
+            s_RecordedFrame->statisticsScopes.size() >=
+                s_kMaxStatisticsScopeCount)
+        {
+            return 0;
+        }
+
+        const auto kIndex =
+            static_cast<uint32_t>(s_RecordedFrame->statisticsScopes.size());
+        s_RecordedFrame->statisticsScopes.push_back(name);
+
+        *queryPool = s_RecordedFrame->statisticsQueryPool;
+        const VkQueryControlFlags kFlags = 0;
+        vkCmdBeginQuery(cmdBuffer, *queryPool, kIndex * s_QueryStride,
+                        kFlags);
+        return kIndex;
+    }
+
+    void GpuProfile::EndStatisticsScope(
+        VkCommandBuffer cmdBuffer,
+        VkQueryPool queryPool,
+        uint32_t index)
+    {
+        if (queryPool == VK_NULL_HANDLE)
+            return;
+
+        vkCmdEndQuery(cmdBuffer, queryPool, index * s_QueryStride);
+    }
+
+    void GpuProfile::ReadResults(Frame& frame)
+    {
+        const auto kQueryCount = static_cast<uint32_t>(2 * frame.scopes.size());
+        std::vector<uint64_t> timestamps(kQueryCount);
+
+        // Never waits, the frame's submission is done, unless it was not
+        //  submitted. Of the queries of a multiview pass, the first one
+        for (uint32_t i = 0; i < kQueryCount; ++i)
+        {
+            const VkResult kResult = vkGetQueryPoolResults(
+                s_Device, frame.queryPool, i * s_QueryStride, 1,
+                sizeof(uint64_t), &timestamps[i],
+                sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+            );
+            if (kResult != VK_SUCCESS)
+                return;
+        }
+
+        uint64_t frameTicks = 0;
+        for (size_t i = 0; i < frame.scopes.size(); ++i)
+        {
+            const uint64_t kTicks =
+                (timestamps[2 * i + 1] - timestamps[2 * i]) & s_TimestampMask;
+            const uint64_t kOffsetTicks =
+                (timestamps[2 * i] - timestamps[0]) & s_TimestampMask;
+            frameTicks = std::max(frameTicks, kOffsetTicks + kTicks);
+
+            Profile::Record record(
+                frame.scopes[i].name, 0.0f, frame.scopes[i].fileName,
+                static_cast<float>(kTicks * s_TimestampPeriod)
+            );
+            record.begin = frame.cpuBegin +
+                static_cast<uint64_t>(kOffsetTicks * s_TimestampPeriod * 1000.0);
+
+            Profile::InsertGpuRecord(record);
+        }
+
+        s_FrameDuration = static_cast<float>(frameTicks * s_TimestampPeriod);
+    }
+
+    void GpuProfile::ReadStatistics(Frame& frame)
+    {
+        const auto kQueryCount =
+            static_cast<uint32_t>(frame.statisticsScopes.size());
+        const bool kHasTessellation = s_StatisticsFlags &
+            VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT;
+        const uint32_t kCounterCount = kHasTessellation ? 6 : 5;
+        std::vector<uint64_t> counters(kQueryCount * kCounterCount, 0);
+
+        // Of the queries of a multiview pass, the views' counts add up
+        for (uint32_t i = 0; i < kQueryCount; ++i)
+        {
+            if (!AddQueryResults(frame.statisticsQueryPool,
+                                 i * s_QueryStride, s_QueryStride,
+                                 kCounterCount, &counters[i * kCounterCount]))
+                return;
+        }
+
+        s_Statistics.resize(kQueryCount);
+        for (uint32_t i = 0; i < kQueryCount; ++i)
+        {
+            const uint64_t* kCounters = &counters[i * kCounterCount];
+
+            Statistics& statistics = s_Statistics[i];
+            statistics.name = frame.statisticsScopes[i];
+            statistics.inputPrimitives = kCounters[0];
+            statistics.vertexInvocations = kCounters[1];
+            statistics.clippingInvocations = kCounters[2];
+            statistics.clippingPrimitives = kCounters[3];
+            statistics.fragmentInvocations = kCounters[4];
+            statistics.tessEvaluationInvocations =
+                kHasTessellation ? kCounters[5] : 0;
+        }
+    }
+
+    bool GpuProfile::AddQueryResults(
+        VkQueryPool queryPool,
+        uint32_t firstQuery,
+        uint32_t queryCount,
+        uint32_t resultCount,
+        uint64_t* results)
+    {
+        // Each query's results followed by its availability, unwritten ones
+        //  of a pass of fewer views are not available
+        const uint32_t kStride = resultCount + 1;
+        std::vector<uint64_t> values(queryCount * kStride, 0);
+
+        const VkResult kResult = vkGetQueryPoolResults(
+            s_Device, queryPool, firstQuery, queryCount,
+            values.size() * sizeof(uint64_t), values.data(),
+            kStride * sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+        );
+        if (kResult != VK_SUCCESS && kResult != VK_NOT_READY)
+            return false;
+
+        bool isAvailable = false;
+        for (uint32_t i = 0; i < queryCount; ++i)
+        {
+            const uint64_t* kValues = &values[i * kStride];
+            if (kValues[resultCount] == 0)
+                continue;
+
+            for (uint32_t j = 0; j < resultCount; ++j)
+                results[j] += kValues[j];
+            isAvailable = true;
+        }
+        return isAvailable;
+    }
+
+    float GpuProfile::GetFrameDuration()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_FrameDuration;
+    }
+
+    bool GpuProfile::HasStatistics()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_StatisticsFlags != 0;
+    }
+
+    std::vector<GpuProfile::Statistics> GpuProfile::GetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_Statistics;
+    }
+
+} // namespace vkp
@@ -0,0 +1,249 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_VULKAN_GPU_PROFILE_H_
+#define WATER_SURFACE_RENDERING_VULKAN_GPU_PROFILE_H_
+
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "core/Profile.h"
+#include "vulkan/Device.h"
+
+/**
+ * @brief Define VKP_PROFILE to use the GPU *Profiling macro*:
+ * VKP_PROFILE_GPU_SCOPE(cmdBuffer, "your description"), records in one
+ *  profile record both the CPU time of the recording, and the GPU time of
+ *  the execution of the scope's commands
+ *
+ * VKP_PROFILE_GPU_STATISTICS(cmdBuffer, "your description"), counts the
+ *  pipeline statistics of the scope's draws, @see GpuProfile::Statistics,
+ *  begun and ended in the same command buffer, not nested
+ */
+
+#ifdef VKP_PROFILE
+    #define VKP_PGSCOPE1(cmd, name, line) \
+        constexpr auto ff##line = ::vkp::GetBaseName(__FILE__); \
+        const char* const kName##line = name; \
+        ::vkp::Profile::Timer timer##line( \
+            ::vkp::Profile::Record(kName##line, ff##line) ); \
+        ::vkp::GpuProfile::Scope gpuScope##line(cmd, kName##line, ff##line)
+    #define VKP_PGSCOPE0(cmd, name, line) VKP_PGSCOPE1(cmd, name, line)
+
+// -----------------------------
+    #define VKP_PGSTATS1(cmd, name, line) \
+        ::vkp::GpuProfile::StatisticsScope gpuStats##line(cmd, name)
+    #define VKP_PGSTATS0(cmd, name, line) VKP_PGSTATS1(cmd, name, line)
+
+// -----------------------------
+    #define VKP_PROFILE_GPU_SCOPE(cmd, name) VKP_PGSCOPE0(cmd, name, __LINE__)
+    #define VKP_PROFILE_GPU_STATISTICS(cmd, name) \
+        VKP_PGSTATS0(cmd, name, __LINE__)
+// ^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+#else
+    #define VKP_PROFILE_GPU_SCOPE(cmd, name)
+    #define VKP_PROFILE_GPU_STATISTICS(cmd, name)
+#endif
+
+
+namespace vkp
+{
+    /**
+     * @brief Singleton for global GPU profiling, of a timestamp query pool for
+     *  each frame in flight:
+     *  a) "BeginFrame()" reads back the timestamps of the frame's previous
+     *      submission, already done, without waiting, then resets its queries,
+     *  b) each scope writes a timestamp at its begin and end, in primary or
+     *      secondary command buffers, recorded from any thread,
+     *  c) the durations are merged into the records of vkp::Profile, of
+     *      the same name, as their GPU durations,
+     *  d) of a capture, the scopes begin relative to the frame's first
+     *      timestamp, aligned to the CPU time of its "BeginFrame()", not
+     *      calibrated,
+     *  e) if the device enables "pipelineStatisticsQuery", a statistics scope
+     *      counts the primitives and the shader invocations of its draws,
+     *      read back with the timestamps.
+     *
+     * Scopes outside "BeginFrame()" and "EndFrame()" are not measured, e.g.,
+     *  of command buffers reused over frames.
+     *
+     * Inside a multiview render pass, each query takes as many consecutive
+     *  ones as the views, so the queries are strided by the view count: the
+     *  first timestamp of each is read, the statistics of all are summed.
+     */
+    class GpuProfile
+    {
+    public:
+        static constexpr uint32_t s_kMaxScopeCount{ 32 };
+        static constexpr uint32_t s_kMaxStatisticsScopeCount{ 8 };
+
+        /** @brief Counters of a statistics scope's draws */
+        struct Statistics
+        {
+            const char* name{ nullptr };
+            uint64_t inputPrimitives{ 0 };      ///< Of the input assembly
+            uint64_t vertexInvocations{ 0 };
+            // Zero if the device has no tessellation shaders
+            uint64_t tessEvaluationInvocations{ 0 };
+            uint64_t clippingInvocations{ 0 };  ///< Primitives to clip
+            uint64_t clippingPrimitives{ 0 };   ///< Output by the clipping
+            uint64_t fragmentInvocations{ 0 };
+        };
+
+        /**
+         * @brief (Re)Creates the query pools, none if the graphics queue has
+         *  no timestamps
+         * @param viewCount Of the multiview render passes the scopes are
+         *  recorded in, if any
+         * @pre None of the previous pools is in use
+         */
+        static void Init(const Device& device, uint32_t frameCount,
+                         uint32_t viewCount = 1);
+        static void Destroy();
+
+        /**
+         * @brief Reads back the timestamps of the frame, resets its queries,
+         *  its scopes are measured until "EndFrame()"
+         * @param cmdBuffer Primary one, outside of a render pass
+         * @pre The frame's previous submission is done
+         */
+        static void BeginFrame(VkCommandBuffer cmdBuffer, uint32_t frameIndex);
+        static void EndFrame();
+
+        /**
+         * @return In milliseconds, of the frame read back by the last
+         *  "BeginFrame()", from its first timestamp to its last one, negative
+         *  if none
+         */
+        static float GetFrameDuration();
+
+        /** @return If the device counts the pipeline statistics */
+        static bool HasStatistics();
+        /**
+         * @return Of the frame read back by the last "BeginFrame()", each
+         *  statistics scope in the order recorded
+         */
+        static std::vector<Statistics> GetStatistics();
+
+        class Scope
+        {
+        public:
+            Scope(VkCommandBuffer cmdBuffer,
+                  const char* name,
+                  const char* fileName)
+                : m_CmdBuffer(cmdBuffer)
+            {
+                m_Query = GpuProfile::BeginScope(cmdBuffer, name, fileName,
+                                                 &m_QueryPool);
+            }
+
+            ~Scope() { GpuProfile::EndScope(m_CmdBuffer, m_QueryPool, m_Query); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            VkCommandBuffer m_CmdBuffer;
+            VkQueryPool m_QueryPool{ VK_NULL_HANDLE };
+            uint32_t m_Query{ 0 };
+        };
+
+        class StatisticsScope
+        {
+        public:
+            StatisticsScope(VkCommandBuffer cmdBuffer, const char* name)
+                : m_CmdBuffer(cmdBuffer)
+            {
+                m_Query = GpuProfile::BeginStatisticsScope(cmdBuffer, name,
+                                                           &m_QueryPool);
+            }
+
+            ~StatisticsScope() {
+                GpuProfile::EndStatisticsScope(m_CmdBuffer, m_QueryPool,
+                                               m_Query);
+            }
+
+            StatisticsScope(const StatisticsScope&) = delete;
+            StatisticsScope& operator=(const StatisticsScope&) = delete;
+
+        private:
+            VkCommandBuffer m_CmdBuffer;
+            VkQueryPool m_QueryPool{ VK_NULL_HANDLE };
+            uint32_t m_Query{ 0 };
+        };
+
+    private:
+        // Of the queries 2 * index and 2 * index + 1
+        struct ScopeInfo
+        {
+            const char* name;
+            const char* fileName;
+        };
+
+        struct Frame
+        {
+            VkQueryPool queryPool{ VK_NULL_HANDLE };
+            std::vector<ScopeInfo> scopes;
+            // Of a query each, null if the device counts no statistics
+            VkQueryPool statisticsQueryPool{ VK_NULL_HANDLE };
+            std::vector<const char*> statisticsScopes;
+            // In microseconds since the profile epoch
+            uint64_t cpuBegin{ 0 };
+        };
+
+        /** @return Index of the scope, null query pool if not measured */
+        static uint32_t BeginScope(VkCommandBuffer cmdBuffer,
+                                   const char* name,
+                                   const char* fileName,
+                                   VkQueryPool* queryPool);
+        static void EndScope(VkCommandBuffer cmdBuffer,
+                             VkQueryPool queryPool,
+                             uint32_t index);
+
+        /** @return Index of the query, null query pool if not counted */
+        static uint32_t BeginStatisticsScope(VkCommandBuffer cmdBuffer,
+                                             const char* name,
+                                             VkQueryPool* queryPool);
+        static void EndStatisticsScope(VkCommandBuffer cmdBuffer,
+                                       VkQueryPool queryPool,
+                                       uint32_t index);
+
+        /** @brief Inserts the durations into the records, if available */
+        static void ReadResults(Frame& frame);
+        static void ReadStatistics(Frame& frame);
+
+        /**
+         * @brief Adds the results of the available queries of the range
+         * @return False if none is available
+         */
+        static bool AddQueryResults(VkQueryPool queryPool,
+                                    uint32_t firstQuery,
+                                    uint32_t queryCount,
+                                    uint32_t resultCount,
+                                    uint64_t* results);
+
+    private:
+        static inline VkDevice s_Device{ VK_NULL_HANDLE };
+        // In milliseconds per increment
+        static inline double s_TimestampPeriod{ 0.0 };
+        static inline uint64_t s_TimestampMask{ 0 };
+        // Of the consecutive queries of a multiview pass, per query
+        static inline uint32_t s_QueryStride{ 1 };
+
+        static inline std::vector<Frame> s_Frames;
+        static inline Frame* s_RecordedFrame{ nullptr };
+        static inline float s_FrameDuration{ -1.0f };
+
+        // Of the counters in the order of "Statistics", if any
+        static inline VkQueryPipelineStatisticFlags s_StatisticsFlags{ 0 };
+        static inline std::vector<Statistics> s_Statistics;
+        // Scopes are recorded also from worker threads
+        static inline std::mutex s_Mutex;
+    };
+
+} // namespace vkp
+
+#endif // WATER_SURFACE_RENDERING_VULKAN_GPU_PROFILE_H_
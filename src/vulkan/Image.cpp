@@ -10,8 +10,9 @@
 
 namespace vkp
 {
-    Image::Image(const Device& device)
-        : m_Device(device)
+    Image::Image(const Device& device, MemoryTag tag)
+        : m_Device(device),
+          m_MemoryTag(tag)
     {
         VKP_REGISTER_FUNCTION();
         VKP_ASSERT(device != VK_NULL_HANDLE);
@@ -19,8 +20,9 @@ namespace vkp
 
     Image::Image(Image&& other)
         : m_Device(other.m_Device),
+          m_MemoryTag(other.m_MemoryTag),
           m_Image(other.m_Image),
-          m_ImageMemory(other.m_ImageMemory),
+          m_Memory(other.m_Memory),
           m_Type(other.m_Type),
           m_Extent(other.m_Extent),
           m_MipLevelCount(other.m_MipLevelCount),
@@ -30,7 +32,7 @@ namespace vkp
     {
         VKP_REGISTER_FUNCTION();
         other.m_Image = VK_NULL_HANDLE;
-        other.m_ImageMemory = VK_NULL_HANDLE;
+        other.m_Memory = MemoryAllocation{};
     }
 
     Image::~Image()
@@ -46,10 +48,9 @@ namespace vkp
             vkDestroyImage(m_Device, m_Image, nullptr);
             m_Image = VK_NULL_HANDLE;
         }
-        if (m_ImageMemory != VK_NULL_HANDLE)
+        if (m_Memory.IsValid())
         {
-            vkFreeMemory(m_Device, m_ImageMemory, nullptr);
-            m_ImageMemory = VK_NULL_HANDLE;
+            m_Device.GetMemoryAllocator().Free(m_Memory);
         }
     }
 
@@ -94,7 +95,8 @@ namespace vkp
                        VkMemoryPropertyFlags memoryProps, VkImageTiling tiling,
                        VkSampleCountFlagBits samples, uint32_t arrayLayers,
                        VkImageCreateFlags flags, uint32_t queueFamilyCount,
-                       const uint32_t* queueFamilies)
+                       const uint32_t* queueFamilies,
+                       const MemoryAllocation* aliasedMemory)
     {
         VKP_ASSERT(mipLevels > 0 && arrayLayers > 0 && queueFamilyCount >= 0);
 
@@ -141,35 +143,46 @@ namespace vkp
             VKP_ASSERT_RESULT(err);
         }
 
-        AllocateMemory(memoryProps);
+        AllocateMemory(memoryProps, tiling, aliasedMemory);
 
         BindMemory();
     }
 
-    void Image::AllocateMemory(VkMemoryPropertyFlags properties)
+    void Image::AllocateMemory(VkMemoryPropertyFlags properties,
+                               VkImageTiling tiling,
+                               const MemoryAllocation* aliasedMemory)
     {
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(m_Device, m_Image, &memRequirements);
 
-        VKP_LOG_INFO("Allocating image with size: {}", memRequirements.size);
+        auto& allocator = m_Device.GetMemoryAllocator();
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = 
-            m_Device.GetPhysicalDevice().FindMemoryType(
-                memRequirements.memoryTypeBits, 
-                properties);
+        if (aliasedMemory != nullptr)
+        {
+            VKP_ASSERT_MSG(
+                (memRequirements.memoryTypeBits &
+                    (1u << aliasedMemory->memoryTypeIndex)) &&
+                aliasedMemory->offset % memRequirements.alignment == 0 &&
+                memRequirements.size <= aliasedMemory->size,
+                "Image does not fit into the aliased memory");
+
+            m_Memory = allocator.Alias(*aliasedMemory);
+            return;
+        }
 
-        auto err = vkAllocateMemory(m_Device, &allocInfo, nullptr, &m_ImageMemory);
-        VKP_ASSERT_RESULT(err);
+        VKP_LOG_INFO("Allocating image with size: {}", memRequirements.size);
+
+        // Kept apart from the optimal ones, for the buffer-image granularity
+        const bool kIsLinear = tiling == VK_IMAGE_TILING_LINEAR;
+        m_Memory = allocator.Allocate(memRequirements, properties, kIsLinear,
+                                      m_MemoryTag);
     }
 
-    void Image::BindMemory(VkDeviceSize offset)
+    void Image::BindMemory()
     {
-        VKP_ASSERT(m_Image != VK_NULL_HANDLE && 
-                   m_ImageMemory != VK_NULL_HANDLE);
-        auto err = vkBindImageMemory(m_Device, m_Image, m_ImageMemory, offset);
+        VKP_ASSERT(m_Image != VK_NULL_HANDLE && m_Memory.IsValid());
+        auto err = vkBindImageMemory(m_Device, m_Image, m_Memory.memory,
+                                     m_Memory.offset);
         VKP_ASSERT_RESULT(err);
     }
 
@@ -266,7 +279,8 @@ namespace vkp
     void Image::RecordImageBarrier(VkCommandBuffer cmdBuffer,
         VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask,
         VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
-        VkImageLayout newLayout) const
+        VkImageLayout newLayout, uint32_t srcQueueFamilyIndex,
+        uint32_t dstQueueFamilyIndex) const
     {
         VKP_ASSERT(cmdBuffer != VK_NULL_HANDLE);
 
@@ -279,9 +293,9 @@ namespace vkp
             // >> Layout transition
             .oldLayout = m_ImageLayout,
             .newLayout = newLayout,
-            // Not transferring queue family ownership
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            // Ownership transfer, if the families differ
+            .srcQueueFamilyIndex = srcQueueFamilyIndex,
+            .dstQueueFamilyIndex = dstQueueFamilyIndex,
             .image = m_Image,
             .subresourceRange = {   // Transition the whole image at once
                 .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -7,6 +7,7 @@
 #define WATER_SURFACE_RENDERING_VULKAN_IMAGE_H_
 
 #include <vulkan/vulkan.h>
+#include "vulkan/MemoryAllocator.h"
 
 
 namespace vkp
@@ -27,7 +28,8 @@ namespace vkp
         static VkImageCreateInfo InitImageInfo();
 
     public:
-        Image(const Device& device);
+        /** @param tag Subsystem its memory is accounted to */
+        Image(const Device& device, MemoryTag tag = MemoryTag::Other);
         Image(Image&& other);
 
         ~Image();
@@ -41,9 +43,10 @@ namespace vkp
         //void Create(const VkImageCreateInfo& info);
 
         /**
-         * @brief 1) Creates VkImage handle, 2) allocates memory according to
-         *  image memory requirements on the device, 3) binds the memory to the
-         *  image handle
+         * @brief 1) Creates VkImage handle, 2) sub-allocates memory according
+         *  to image memory requirements on the device, or aliases
+         *  'aliasedMemory' of another resource the image fits into,
+         *  3) binds the memory to the image handle
          *  Created in layout: VK_IMAGE_LAYOUT_UNDEFINED
          */
         void Create(const VkExtent3D& extent, 
@@ -56,7 +59,8 @@ namespace vkp
                     uint32_t arrayLayers = 1,
                     VkImageCreateFlags flags = 0,
                     uint32_t queueFamilyCount = 0,
-                    const uint32_t* queueFamilies = nullptr);
+                    const uint32_t* queueFamilies = nullptr,
+                    const MemoryAllocation* aliasedMemory = nullptr);
         
         /**
          * @brief Destroys the image handle, frees the bound image memory,
@@ -121,6 +125,7 @@ namespace vkp
         VkImage GetHandle() const { return m_Image; }
         VkFormat GetFormat() const { return m_Format; }
         VkImageLayout GetLayout() const { return m_ImageLayout; }
+        const MemoryAllocation& GetMemory() const { return m_Memory; }
         uint32_t GetArrayLayerCount() const { return m_ArrayLayerCount; }
         void SetLayout(VkImageLayout layout) { m_ImageLayout = layout; }
 
@@ -132,29 +137,41 @@ namespace vkp
          * @param srcAccessMask Source ACCESS bitmask
          * @param dstAccessMask Destination ACCESS bitmask
          * @param newLayout New layout to transition to
+         * @param srcQueueFamilyIndex Queue family releasing the ownership,
+         *  to be recorded by both families, by default no ownership transfer
+         * @param dstQueueFamilyIndex Queue family acquiring the ownership
          */
         void RecordImageBarrier(VkCommandBuffer cmdBuffer,
                                 VkPipelineStageFlags srcStageMask, 
                                 VkPipelineStageFlags dstStageMask,
                                 VkAccessFlags srcAccessMask, 
                                 VkAccessFlags dstAccessMask,
-                                VkImageLayout newLayout) const;
+                                VkImageLayout newLayout,
+                                uint32_t srcQueueFamilyIndex =
+                                    VK_QUEUE_FAMILY_IGNORED,
+                                uint32_t dstQueueFamilyIndex =
+                                    VK_QUEUE_FAMILY_IGNORED) const;
 
     private:
         void CreateImage();
 
-        void AllocateMemory(VkMemoryPropertyFlags properties);
+        void AllocateMemory(VkMemoryPropertyFlags properties,
+                            VkImageTiling tiling,
+                            const MemoryAllocation* aliasedMemory);
 
         /** 
-         * @brief Associate the memory with the image at offset 'offset'
+         * @brief Associate the memory with the image, at the allocation's
+         *  offset
          */
-        void BindMemory(VkDeviceSize offset = 0);
+        void BindMemory();
 
     private:
         const Device& m_Device;
+        const MemoryTag m_MemoryTag;
 
         VkImage        m_Image      { VK_NULL_HANDLE };
-        VkDeviceMemory m_ImageMemory{ VK_NULL_HANDLE };
+        // Range of a block shared with other resources
+        MemoryAllocation m_Memory;
 
         VkImageType    m_Type           {};
         VkExtent3D     m_Extent         {};
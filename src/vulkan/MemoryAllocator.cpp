@@ -0,0 +1,433 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "vulkan/MemoryAllocator.h"
+#include "vulkan/Device.h"
+
+
+namespace vkp
+{
+    const char* ToString(MemoryTag tag)
+    {
+        switch (tag)
+        {
+        case MemoryTag::Framebuffer: return "Framebuffer";
+        case MemoryTag::Mesh:        return "Mesh";
+        case MemoryTag::Maps:        return "Maps";
+        case MemoryTag::Staging:     return "Staging";
+        case MemoryTag::Simulation:  return "Simulation";
+        case MemoryTag::Sky:         return "Sky";
+        case MemoryTag::Terrain:     return "Terrain";
+        default:                     return "Other";
+        }
+    }
+
+    MemoryAllocator::MemoryAllocator(const Device& device,
+                                     VkDeviceSize blockSize)
+        : m_Device(device),
+          m_BlockSize(blockSize)
+    {
+        VKP_REGISTER_FUNCTION();
+        VKP_ASSERT(blockSize > 0);
+    }
+
+    MemoryAllocator::~MemoryAllocator()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        for (auto& pool : m_Pools)
+        {
+            for (auto& block : pool.blocks)
+            {
+                if (!block->allocations.empty())
+                {
+                    VKP_LOG_WARN("Freeing a memory block with {} allocations",
+                                 block->allocations.size());
+                }
+                DestroyBlock(*block);
+            }
+        }
+    }
+
+    MemoryAllocation MemoryAllocator::Allocate(
+        const VkMemoryRequirements& requirements,
+        VkMemoryPropertyFlags properties,
+        bool isLinear,
+        MemoryTag tag)
+    {
+        const uint32_t kTypeIndex =
+            m_Device.GetPhysicalDevice().FindMemoryType(
+                requirements.memoryTypeBits,
+                properties);
+
+        VkDeviceSize alignment = requirements.alignment;
+        VkDeviceSize size = requirements.size;
+        if (IsHostVisible(kTypeIndex))
+        {
+            // Flushed ranges are rounded to the atom, must not reach into
+            //  a neighbour
+            const VkDeviceSize kAtomSize =
+                m_Device.GetPhysicalDevice().GetNonCoherentAtomSize();
+            alignment = std::max(alignment, kAtomSize);
+            size = m_Device.GetNonCoherentAtomSizeAlignment(size);
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        Pool& pool = GetPool(kTypeIndex, isLinear);
+        const VkDeviceSize kBlockSize = GetBlockSize(kTypeIndex);
+
+        Block* block = nullptr;
+        VkDeviceSize offset = UINT64_MAX;
+
+        // Large ones would leave most of a block unused
+        if (size > kBlockSize / 2)
+        {
+            block = CreateBlock(pool, size, true);
+            offset = ReserveRange(*block, size, alignment);
+        }
+        else
+        {
+            for (auto& poolBlock : pool.blocks)
+            {
+                if (poolBlock->isDedicated)
+                    continue;
+
+                offset = ReserveRange(*poolBlock, size, alignment);
+                if (offset != UINT64_MAX)
+                {
+                    block = poolBlock.get();
+                    break;
+                }
+            }
+
+            if (block == nullptr)
+            {
+                block = CreateBlock(pool, kBlockSize, false);
+                offset = ReserveRange(*block, size, alignment);
+            }
+        }
+        VKP_ASSERT(offset != UINT64_MAX);
+
+        block->allocations[offset] = Reserved{ .size = size, .refCount = 1,
+                                               .tag = tag };
+        AccountUsage(tag, kTypeIndex, size, false);
+
+        return MemoryAllocation{
+            .memory = block->memory,
+            .offset = offset,
+            .size = size,
+            .mappedAddr = block->mappedAddr != nullptr
+                          ? static_cast<uint8_t*>(block->mappedAddr) + offset
+                          : nullptr,
+            .memoryTypeIndex = kTypeIndex
+        };
+    }
+
+    MemoryAllocation MemoryAllocator::Alias(const MemoryAllocation& allocation)
+    {
+        VKP_ASSERT(allocation.IsValid());
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        Block* block = FindBlock(allocation.memory);
+        VKP_ASSERT(block != nullptr);
+
+        auto it = block->allocations.find(allocation.offset);
+        VKP_ASSERT_MSG(it != block->allocations.end(),
+                       "Aliased memory is not allocated");
+        ++it->second.refCount;
+
+        return allocation;
+    }
+
+    void MemoryAllocator::Free(MemoryAllocation& allocation)
+    {
+        if (!allocation.IsValid())
+            return;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        Pool* pool = nullptr;
+        Block* block = FindBlock(allocation.memory, &pool);
+        VKP_ASSERT(block != nullptr);
+
+        auto it = block->allocations.find(allocation.offset);
+        VKP_ASSERT_MSG(it != block->allocations.end(),
+                       "Freed memory is not allocated");
+
+        if (--it->second.refCount == 0)
+        {
+            AccountUsage(it->second.tag, pool->memoryTypeIndex,
+                         it->second.size, true);
+            ReleaseRange(*block, it->first, it->second.size);
+            block->allocations.erase(it);
+
+            if (block->isDedicated)
+            {
+                DestroyBlock(*block);
+
+                auto& blocks = pool->blocks;
+                blocks.erase(
+                    std::find_if(blocks.begin(), blocks.end(),
+                        [block](const auto& b) { return b.get() == block; })
+                );
+            }
+        }
+
+        allocation = MemoryAllocation{};
+    }
+
+    uint32_t MemoryAllocator::GetBlockCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        uint32_t count = 0;
+        for (const auto& pool : m_Pools)
+            count += pool.blocks.size();
+        return count;
+    }
+
+    VkDeviceSize MemoryAllocator::GetReservedSize() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        VkDeviceSize size = 0;
+        for (const auto& pool : m_Pools)
+        {
+            for (const auto& block : pool.blocks)
+                size += block->size;
+        }
+        return size;
+    }
+
+    std::vector<VkDeviceSize> MemoryAllocator::GetHeapReservedSizes() const
+    {
+        const auto& kProps = m_Device.GetPhysicalDevice().GetMemoryProperties();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        std::vector<VkDeviceSize> sizes(kProps.memoryHeapCount, 0);
+        for (const auto& pool : m_Pools)
+        {
+            const uint32_t kHeapIndex =
+                kProps.memoryTypes[pool.memoryTypeIndex].heapIndex;
+            for (const auto& block : pool.blocks)
+                sizes[kHeapIndex] += block->size;
+        }
+        return sizes;
+    }
+
+    std::array<MemoryAllocator::TagUsage, MemoryAllocator::s_kTagCount>
+    MemoryAllocator::GetTagUsages() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_TagUsages;
+    }
+
+    // -------------------------------------------------------------------------
+
+    void MemoryAllocator::AccountUsage(MemoryTag tag,
+                                       uint32_t memoryTypeIndex,
+                                       VkDeviceSize size,
+                                       bool isFreed)
+    {
+        TagUsage& usage = m_TagUsages[static_cast<size_t>(tag)];
+        const VkDeviceSize kDeviceLocalSize =
+            IsDeviceLocal(memoryTypeIndex) ? size : 0;
+
+        if (isFreed)
+        {
+            --usage.allocationCount;
+            usage.size -= size;
+            usage.deviceLocalSize -= kDeviceLocalSize;
+            return;
+        }
+
+        ++usage.allocationCount;
+        usage.size += size;
+        usage.deviceLocalSize += kDeviceLocalSize;
+        usage.peakSize = std::max(usage.peakSize, usage.size);
+    }
+
+    MemoryAllocator::Pool& MemoryAllocator::GetPool(uint32_t memoryTypeIndex,
+                                                    bool isLinear)
+    {
+        for (auto& pool : m_Pools)
+        {
+            if (pool.memoryTypeIndex == memoryTypeIndex &&
+                pool.isLinear == isLinear)
+                return pool;
+        }
+
+        return m_Pools.emplace_back(Pool{
+            .memoryTypeIndex = memoryTypeIndex,
+            .isLinear = isLinear,
+            .blocks = {}
+        });
+    }
+
+    MemoryAllocator::Block* MemoryAllocator::FindBlock(VkDeviceMemory memory,
+                                                       Pool** pPool)
+    {
+        for (auto& pool : m_Pools)
+        {
+            for (auto& block : pool.blocks)
+            {
+                if (block->memory != memory)
+                    continue;
+
+                if (pPool != nullptr)
+                    *pPool = &pool;
+                return block.get();
+            }
+        }
+        return nullptr;
+    }
+
+    MemoryAllocator::Block* MemoryAllocator::CreateBlock(Pool& pool,
+                                                         VkDeviceSize size,
+                                                         bool isDedicated)
+    {
+        VKP_REGISTER_FUNCTION();
+        VKP_LOG_INFO("Allocating memory block, type: {}, size: {} B{}",
+                     pool.memoryTypeIndex, size,
+                     isDedicated ? ", dedicated" : "");
+
+        auto block = std::make_unique<Block>();
+        block->size = size;
+        block->isDedicated = isDedicated;
+        block->freeRanges = { Range{ .offset = 0, .size = size } };
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = size;
+        allocInfo.memoryTypeIndex = pool.memoryTypeIndex;
+
+        auto err = vkAllocateMemory(m_Device, &allocInfo, nullptr,
+                                    &block->memory);
+        VKP_ASSERT_RESULT(err);
+
+        if (IsHostVisible(pool.memoryTypeIndex))
+        {
+            err = vkMapMemory(m_Device, block->memory, 0, VK_WHOLE_SIZE, 0,
+                              &block->mappedAddr);
+            VKP_ASSERT_RESULT(err);
+        }
+
+        pool.blocks.push_back(std::move(block));
+        return pool.blocks.back().get();
+    }
+
+    void MemoryAllocator::DestroyBlock(Block& block)
+    {
+        if (block.mappedAddr != nullptr)
+        {
+            vkUnmapMemory(m_Device, block.memory);
+            block.mappedAddr = nullptr;
+        }
+        if (block.memory != VK_NULL_HANDLE)
+        {
+            vkFreeMemory(m_Device, block.memory, nullptr);
+            block.memory = VK_NULL_HANDLE;
+        }
+    }
+
+    VkDeviceSize MemoryAllocator::ReserveRange(Block& block,
+                                               VkDeviceSize size,
+                                               VkDeviceSize alignment)
+    {
+        auto& ranges = block.freeRanges;
+
+        for (auto it = ranges.begin(); it != ranges.end(); ++it)
+        {
+            const VkDeviceSize kOffset =
+                (it->offset + alignment - 1) / alignment * alignment;
+            const VkDeviceSize kRangeEnd = it->offset + it->size;
+            if (kOffset + size > kRangeEnd)
+                continue;
+
+            const Range kAfter{ .offset = kOffset + size,
+                                .size = kRangeEnd - (kOffset + size) };
+
+            // Padding for the alignment stays free
+            if (kOffset > it->offset)
+            {
+                it->size = kOffset - it->offset;
+                if (kAfter.size > 0)
+                    ranges.insert(it + 1, kAfter);
+            }
+            else if (kAfter.size > 0)
+            {
+                *it = kAfter;
+            }
+            else
+            {
+                ranges.erase(it);
+            }
+
+            return kOffset;
+        }
+
+        return UINT64_MAX;
+    }
+
+    void MemoryAllocator::ReleaseRange(Block& block,
+                                       VkDeviceSize offset,
+                                       VkDeviceSize size)
+    {
+        auto& ranges = block.freeRanges;
+
+        auto it = std::lower_bound(ranges.begin(), ranges.end(), offset,
+            [](const Range& range, VkDeviceSize value) {
+                return range.offset < value;
+            });
+        it = ranges.insert(it, Range{ .offset = offset, .size = size });
+
+        // Coalesce with the neighbours
+        auto next = it + 1;
+        if (next != ranges.end() && it->offset + it->size == next->offset)
+        {
+            it->size += next->size;
+            ranges.erase(next);
+        }
+        if (it != ranges.begin())
+        {
+            auto prev = it - 1;
+            if (prev->offset + prev->size == it->offset)
+            {
+                prev->size += it->size;
+                ranges.erase(it);
+            }
+        }
+    }
+
+    VkDeviceSize MemoryAllocator::GetBlockSize(uint32_t memoryTypeIndex) const
+    {
+        const auto& kProps = m_Device.GetPhysicalDevice().GetMemoryProperties();
+        const uint32_t kHeapIndex = kProps.memoryTypes[memoryTypeIndex].heapIndex;
+
+        // Small heaps, e.g., the device local host visible one, are not
+        //  taken up by a single block
+        return std::min(m_BlockSize, kProps.memoryHeaps[kHeapIndex].size / 8);
+    }
+
+    bool MemoryAllocator::IsHostVisible(uint32_t memoryTypeIndex) const
+    {
+        const auto& kProps = m_Device.GetPhysicalDevice().GetMemoryProperties();
+        return kProps.memoryTypes[memoryTypeIndex].propertyFlags &
+               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    }
+
+    bool MemoryAllocator::IsDeviceLocal(uint32_t memoryTypeIndex) const
+    {
+        const auto& kProps = m_Device.GetPhysicalDevice().GetMemoryProperties();
+        const uint32_t kHeapIndex = kProps.memoryTypes[memoryTypeIndex].heapIndex;
+        return kProps.memoryHeaps[kHeapIndex].flags &
+               VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    }
+
+} // namespace vkp
@@ -0,0 +1,190 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_VULKAN_MEMORY_ALLOCATOR_H_
+#define WATER_SURFACE_RENDERING_VULKAN_MEMORY_ALLOCATOR_H_
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+
+namespace vkp
+{
+    class Device;
+
+    /** @brief Subsystem owning a resource, of the memory accounting */
+    enum class MemoryTag : uint8_t
+    {
+        Other = 0,
+        Framebuffer,    ///< Depth and offscreen images of the swap chain
+        Mesh,           ///< Vertices, indices, instances, uniforms of the grid
+        Maps,           ///< Displacement and normal maps of the water
+        Staging,        ///< Uploads of the maps, the meshes and the spectrum
+        Simulation,     ///< Buffers of the GPU simulation
+        Sky,
+        Terrain,
+
+        Count
+    };
+
+    const char* ToString(MemoryTag tag);
+
+    /** @brief Range of a block of device memory, bound by a resource */
+    struct MemoryAllocation
+    {
+        VkDeviceMemory memory    { VK_NULL_HANDLE };
+        VkDeviceSize   offset    { 0 };         ///< In the memory
+        VkDeviceSize   size      { 0 };         ///< Reserved, aligned
+        // Persistently mapped address at the offset, if host visible
+        void*          mappedAddr{ nullptr };
+        uint32_t       memoryTypeIndex{ UINT32_MAX };
+
+        bool IsValid() const { return memory != VK_NULL_HANDLE; }
+    };
+
+    /**
+     * @brief Sub-allocates the memory of buffers and images from large blocks,
+     *  instead of a "vkAllocateMemory()" call for each resource.
+     *
+     * Blocks are pooled per memory type, and separately for linear (buffers)
+     *  and optimal (images) resources, so that neighbours never break
+     *  the buffer-image granularity. Host visible blocks are mapped once,
+     *  for their whole lifetime, since a memory object cannot be mapped twice.
+     * Ranges are found first-fit and coalesced when freed, empty blocks are
+     *  kept for reuse, except those of dedicated allocations.
+     *
+     * Aliasing: "Alias()" returns another reference to an allocation, resources
+     *  bound to it share the memory, freed with the last one.
+     */
+    class MemoryAllocator
+    {
+    public:
+        static constexpr VkDeviceSize s_kDefaultBlockSize{ 64ull << 20 };
+        static constexpr size_t s_kTagCount{
+            static_cast<size_t>(MemoryTag::Count)
+        };
+
+        /** @brief Of the allocations of a tag, aliases not counted again */
+        struct TagUsage
+        {
+            uint32_t     allocationCount{ 0 };
+            VkDeviceSize size           { 0 };  ///< Reserved, aligned
+            VkDeviceSize deviceLocalSize{ 0 };  ///< Of it on device local heaps
+            VkDeviceSize peakSize       { 0 };  ///< Of "size"
+        };
+
+    public:
+        /** @param blockSize Preferred size of a block, smaller on small heaps */
+        MemoryAllocator(const Device& device,
+                        VkDeviceSize blockSize = s_kDefaultBlockSize);
+        /** @brief Frees all the blocks, the resources must be destroyed */
+        ~MemoryAllocator();
+
+        MemoryAllocator(const MemoryAllocator&) = delete;
+        MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+        /**
+         * @param requirements Of the resource to be bound to the allocation
+         * @param properties Required properties of the memory type
+         * @param isLinear Whether the resource is a buffer, or a linear image
+         * @param tag Accounted to, until the allocation is freed
+         * @return Allocation aligned for the resource, and to the non-coherent
+         *  atom size if host visible, so that it can be flushed on its own
+         */
+        MemoryAllocation Allocate(const VkMemoryRequirements& requirements,
+                                  VkMemoryPropertyFlags properties,
+                                  bool isLinear,
+                                  MemoryTag tag = MemoryTag::Other);
+
+        /**
+         * @brief References the allocation for another resource, has to be
+         *  freed once more
+         * @pre The resource fits into the allocation, and the accesses of
+         *  the aliasing resources are synchronized by the caller
+         */
+        MemoryAllocation Alias(const MemoryAllocation& allocation);
+
+        /** @brief Releases a reference to the allocation, resets it */
+        void Free(MemoryAllocation& allocation);
+
+        uint32_t GetBlockCount() const;
+        /** @return Total size of the allocated blocks, in bytes */
+        VkDeviceSize GetReservedSize() const;
+        /** @return Of each memory heap, the size of its allocated blocks */
+        std::vector<VkDeviceSize> GetHeapReservedSizes() const;
+
+        /** @return Indexed by MemoryTag */
+        std::array<TagUsage, s_kTagCount> GetTagUsages() const;
+
+    private:
+        struct Range
+        {
+            VkDeviceSize offset;
+            VkDeviceSize size;
+        };
+
+        struct Reserved
+        {
+            VkDeviceSize size;
+            uint32_t     refCount;
+            MemoryTag    tag;
+        };
+
+        struct Block
+        {
+            VkDeviceMemory memory    { VK_NULL_HANDLE };
+            VkDeviceSize   size      { 0 };
+            void*          mappedAddr{ nullptr };
+            bool           isDedicated{ false };
+            // Sorted by offset, never adjacent
+            std::vector<Range> freeRanges;
+            // Reserved ranges, by their offset
+            std::map<VkDeviceSize, Reserved> allocations;
+        };
+
+        struct Pool
+        {
+            uint32_t memoryTypeIndex;
+            bool     isLinear;
+            std::vector<std::unique_ptr<Block>> blocks;
+        };
+
+        Pool& GetPool(uint32_t memoryTypeIndex, bool isLinear);
+        Block* FindBlock(VkDeviceMemory memory, Pool** pPool = nullptr);
+
+        Block* CreateBlock(Pool& pool, VkDeviceSize size, bool isDedicated);
+        void DestroyBlock(Block& block);
+
+        /** @return Offset of the reserved range, or UINT64_MAX if none fit */
+        static VkDeviceSize ReserveRange(Block& block, VkDeviceSize size,
+                                         VkDeviceSize alignment);
+        static void ReleaseRange(Block& block, VkDeviceSize offset,
+                                 VkDeviceSize size);
+
+        VkDeviceSize GetBlockSize(uint32_t memoryTypeIndex) const;
+        bool IsHostVisible(uint32_t memoryTypeIndex) const;
+        bool IsDeviceLocal(uint32_t memoryTypeIndex) const;
+
+        /** @brief Adds the size to the tag's usage, or subtracts it if freed */
+        void AccountUsage(MemoryTag tag, uint32_t memoryTypeIndex,
+                          VkDeviceSize size, bool isFreed);
+
+    private:
+        const Device& m_Device;
+        VkDeviceSize  m_BlockSize;
+
+        std::vector<Pool> m_Pools;
+        std::array<TagUsage, s_kTagCount> m_TagUsages{};
+        mutable std::mutex m_Mutex;
+    };
+
+} // namespace vkp
+
+
+#endif // WATER_SURFACE_RENDERING_VULKAN_MEMORY_ALLOCATOR_H_
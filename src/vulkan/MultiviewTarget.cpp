@@ -0,0 +1,315 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "vulkan/MultiviewTarget.h"
+
+#include "core/Profile.h"
+#include "vulkan/GpuProfile.h"
+
+
+namespace vkp
+{
+    MultiviewTarget::MultiviewTarget(const Device& device,
+                                     const DescriptorPool& descriptorPool)
+        : m_kDevice(device),
+          m_kDescriptorPool(descriptorPool)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        CreateDescriptorSetLayout();
+        SetupPipeline();
+
+        auto err = m_kDescriptorPool.AllocateDescriptorSet(
+            *m_DescriptorSetLayout,
+            m_DescriptorSet
+        );
+        VKP_ASSERT_RESULT(err);
+
+        // Texels are fetched, not filtered
+        m_Sampler.reset(new Sampler(m_kDevice));
+        m_Sampler->Create(Sampler::InitSamplerInfo());
+    }
+
+    MultiviewTarget::~MultiviewTarget()
+    {
+        VKP_REGISTER_FUNCTION();
+        DestroyImages();
+    }
+
+    void MultiviewTarget::CreateRenderData(
+        VkRenderPass renderPass,
+        const VkExtent2D kFramebufferExtent,
+        const bool kFramebufferHasDepthAttachment,
+        uint32_t viewCount,
+        VkFormat imageFormat,
+        VkFormat depthFormat)
+    {
+        VKP_REGISTER_FUNCTION();
+        VKP_ASSERT(m_kDevice.SupportsMultiview() &&
+                   viewCount <= m_kDevice.GetMaxMultiviewViewCount());
+
+        // Composited by the pending frames
+        m_kDevice.QueueWaitIdle(QFamily::Graphics);
+        DestroyImages();
+
+        m_ViewCount = std::max(viewCount, 1u);
+        m_FramebufferExtent = kFramebufferExtent;
+        m_ViewExtent = VkExtent2D{
+            std::max(kFramebufferExtent.width / m_ViewCount, 1u),
+            std::max(kFramebufferExtent.height, 1u)
+        };
+
+        // Left as a color attachment, transitioned by "Begin()" and "End()"
+        m_RenderPass.reset(
+            new RenderPass(m_kDevice, imageFormat, depthFormat)
+        );
+        auto& colorAttachment = m_RenderPass->GetAttachmentDescriptions()[0];
+        colorAttachment.initialLayout =
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        m_RenderPass->SetViewCount(m_ViewCount);
+        m_RenderPass->Create(depthFormat != VK_FORMAT_UNDEFINED);
+
+        CreateImages();
+
+        m_Pipeline->Create(kFramebufferExtent,
+                           renderPass,
+                           kFramebufferHasDepthAttachment);
+    }
+
+    void MultiviewTarget::Begin(VkCommandBuffer cmdBuffer,
+                                const std::array<VkClearValue, 2>& clearValues)
+    {
+        VKP_ASSERT(m_Framebuffer != VK_NULL_HANDLE);
+
+        // Previous composites of the frames in flight, the contents are
+        //  cleared
+        m_Image->RecordImageBarrier(cmdBuffer,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            0,
+            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        m_Image->SetLayout(VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = *m_RenderPass;
+        renderPassInfo.framebuffer = m_Framebuffer;
+        renderPassInfo.renderArea.offset = { 0, 0 };
+        renderPassInfo.renderArea.extent = m_ViewExtent;
+        renderPassInfo.clearValueCount = HasDepthAttachment() ? 2 : 1;
+        renderPassInfo.pClearValues = clearValues.data();
+
+        vkCmdBeginRenderPass(cmdBuffer, &renderPassInfo,
+                             VK_SUBPASS_CONTENTS_INLINE);
+
+        Pipeline::CmdSetViewportScissor(cmdBuffer, m_ViewExtent);
+    }
+
+    void MultiviewTarget::End(VkCommandBuffer cmdBuffer)
+    {
+        vkCmdEndRenderPass(cmdBuffer);
+
+        // Composited by the main render pass of this frame
+        m_Image->RecordImageBarrier(cmdBuffer,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            VK_ACCESS_SHADER_READ_BIT,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        m_Image->SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    void MultiviewTarget::Render(VkCommandBuffer cmdBuffer) const
+    {
+        VKP_PROFILE_GPU_SCOPE(cmdBuffer, "Multiview composite");
+
+        // Dynamic states are not inherited by the secondary buffers
+        Pipeline::CmdSetViewportScissor(cmdBuffer, m_FramebufferExtent);
+
+        vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          *m_Pipeline);
+
+        const uint32_t kFirstSet = 0, kDescriptorSetCount = 1;
+        vkCmdBindDescriptorSets(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            m_Pipeline->GetPipelineLayout(),
+            kFirstSet,
+            kDescriptorSetCount,
+            &m_DescriptorSet,
+            0, nullptr
+        );
+
+        const CompositePushConstants kPushConstants{
+            .viewWidth = m_ViewExtent.width,
+            .viewCount = m_ViewCount
+        };
+        vkCmdPushConstants(
+            cmdBuffer,
+            m_Pipeline->GetPipelineLayout(),
+            s_kPushConstantRange.stageFlags,
+            s_kPushConstantRange.offset,
+            s_kPushConstantRange.size,
+            &kPushConstants
+        );
+
+        // Draw fullscreen triangle
+        const uint32_t kVertexCount = 3, kInstanceCount = 1;
+        const uint32_t kFirstVertex = 0, kFirstInstance = 0;
+        vkCmdDraw(cmdBuffer, kVertexCount, kInstanceCount,
+                             kFirstVertex, kFirstInstance);
+    }
+
+    void MultiviewTarget::RecompileShaders(
+        VkRenderPass renderPass,
+        const VkExtent2D kFramebufferExtent,
+        const bool kFramebufferHasDepthAttachment)
+    {
+        if (!m_Pipeline->RecompileShaders())
+            return;
+
+        m_kDevice.QueueWaitIdle(QFamily::Graphics);
+        m_Pipeline->Create(kFramebufferExtent,
+                           renderPass,
+                           kFramebufferHasDepthAttachment);
+    }
+
+    // -------------------------------------------------------------------------
+    // Creation functions
+
+    void MultiviewTarget::CreateDescriptorSetLayout()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        m_DescriptorSetLayout = DescriptorSetLayout::Builder(m_kDevice)
+            // Layers of the views
+            .AddBinding({
+                .binding = 0,
+                .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
+            })
+            .Build();
+    }
+
+    void MultiviewTarget::SetupPipeline()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        std::vector<std::shared_ptr<ShaderModule>> shaders;
+        shaders.reserve(s_kShaderInfos.size());
+        for (const auto& kInfo : s_kShaderInfos)
+            shaders.push_back(std::make_shared<ShaderModule>(m_kDevice, kInfo));
+
+        m_Pipeline = std::make_unique<Pipeline>(m_kDevice, shaders);
+
+        auto& pipelineLayoutInfo = m_Pipeline->GetPipelineLayoutInfo();
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout->GetLayout();
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &s_kPushConstantRange;
+
+        // Fullscreen triangle
+        m_Pipeline->SetVertexInputState( Pipeline::InitVertexInput() );
+
+        auto rasterizationState = Pipeline::InitRasterization();
+        rasterizationState.cullMode = VK_CULL_MODE_FRONT_BIT;
+        rasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        m_Pipeline->SetRasterizationState(rasterizationState);
+
+        // Of every pixel, the depths of the views are their own
+        m_Pipeline->SetDepthState(VK_COMPARE_OP_ALWAYS, false);
+    }
+
+    void MultiviewTarget::CreateImages()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        const VkExtent3D kExtent{ m_ViewExtent.width, m_ViewExtent.height, 1 };
+        const VkFormat kFormat = m_RenderPass->GetAttachmentFormat();
+        const VkFormat kDepthFormat = m_RenderPass->GetDepthAttachmentFormat();
+
+        m_Image.reset(new Image(m_kDevice, MemoryTag::Framebuffer));
+        m_Image->Create(kExtent, 1, kFormat,
+                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                        VK_IMAGE_USAGE_SAMPLED_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        VK_IMAGE_TILING_OPTIMAL,
+                        VK_SAMPLE_COUNT_1_BIT,
+                        m_ViewCount);
+        m_ImageView.reset(new ImageView(m_kDevice));
+        m_ImageView->Create(*m_Image, kFormat,
+                            VK_IMAGE_ASPECT_COLOR_BIT,
+                            VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+                            1, 0, m_ViewCount, 0);
+
+        std::array<VkImageView, 2> attachments{
+            *m_ImageView,
+            VK_NULL_HANDLE
+        };
+        uint32_t attachmentCount = 1;
+
+        if (kDepthFormat != VK_FORMAT_UNDEFINED)
+        {
+            m_DepthImage.reset(new Image(m_kDevice, MemoryTag::Framebuffer));
+            m_DepthImage->Create(kExtent, 1, kDepthFormat,
+                                 VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                 VK_IMAGE_TILING_OPTIMAL,
+                                 VK_SAMPLE_COUNT_1_BIT,
+                                 m_ViewCount);
+            m_DepthImageView.reset(new ImageView(m_kDevice));
+            m_DepthImageView->Create(*m_DepthImage, kDepthFormat,
+                                     VK_IMAGE_ASPECT_DEPTH_BIT,
+                                     VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+                                     1, 0, m_ViewCount, 0);
+
+            attachments[1] = *m_DepthImageView;
+            ++attachmentCount;
+        }
+
+        // Of a single layer, the views select theirs
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = *m_RenderPass;
+        framebufferInfo.attachmentCount = attachmentCount;
+        framebufferInfo.pAttachments = attachments.data();
+        framebufferInfo.width = m_ViewExtent.width;
+        framebufferInfo.height = m_ViewExtent.height;
+        framebufferInfo.layers = 1;
+
+        auto err = vkCreateFramebuffer(m_kDevice, &framebufferInfo, nullptr,
+                                       &m_Framebuffer);
+        VKP_ASSERT_RESULT(err);
+
+        // Not used by any pending frame, waited for by "CreateRenderData()"
+        VkDescriptorImageInfo imageInfo{
+            .sampler = *m_Sampler,
+            .imageView = *m_ImageView,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        };
+
+        DescriptorWriter(*m_DescriptorSetLayout, m_kDescriptorPool)
+            .AddImageDescriptor(0, &imageInfo)
+            .UpdateSet(m_DescriptorSet);
+    }
+
+    void MultiviewTarget::DestroyImages()
+    {
+        if (m_Framebuffer != VK_NULL_HANDLE)
+        {
+            vkDestroyFramebuffer(m_kDevice, m_Framebuffer, nullptr);
+            m_Framebuffer = VK_NULL_HANDLE;
+        }
+        m_DepthImageView.reset();
+        m_DepthImage.reset();
+        m_ImageView.reset();
+        m_Image.reset();
+    }
+
+} // namespace vkp
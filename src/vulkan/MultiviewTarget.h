@@ -0,0 +1,146 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_VULKAN_MULTIVIEW_TARGET_H_
+#define WATER_SURFACE_RENDERING_VULKAN_MULTIVIEW_TARGET_H_
+
+#include <array>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan/Device.h"
+#include "vulkan/Descriptors.h"
+#include "vulkan/ShaderModule.h"
+#include "vulkan/Pipeline.h"
+#include "vulkan/RenderPass.h"
+#include "vulkan/Image.h"
+#include "vulkan/ImageView.h"
+#include "vulkan/Sampler.h"
+
+
+namespace vkp
+{
+    /**
+     * @brief Layered color and depth images of a multiview render pass, a
+     *  layer per view, e.g., of the eyes of a stereo pair or the projectors
+     *  of a wall. Each draw of the pass is rendered to all the layers at
+     *  once, of the same vertex fetch, @see "RenderPass::SetViewCount()"
+     *
+     * The views are composited side by side over the main framebuffer by a
+     *  single full-screen triangle, each of a tile of its width divided by
+     *  the view count, so a window spanning the displays drives them all.
+     *
+     * Usage, each frame:
+     *  1. "Begin()", draws of the pipelines of "GetRenderPass()", "End()",
+     *      outside the main render pass
+     *  2. "Render()" inside the main render pass
+     */
+    class MultiviewTarget
+    {
+    public:
+        /** @param descriptorPool Of a combined image sampler, and a set */
+        MultiviewTarget(const Device& device,
+                        const DescriptorPool& descriptorPool);
+        ~MultiviewTarget();
+
+        MultiviewTarget(const MultiviewTarget&) = delete;
+        MultiviewTarget& operator=(const MultiviewTarget&) = delete;
+
+        /**
+         * @brief Creates the layers of a tile of the framebuffer each, their
+         *  pass, and the composite pipeline of the main render pass
+         * @param depthFormat Of a depth layer per view, if defined
+         * @pre The device supports the multiview of 'viewCount' views
+         */
+        void CreateRenderData(
+            VkRenderPass renderPass,
+            const VkExtent2D kFramebufferExtent,
+            const bool kFramebufferHasDepthAttachment,
+            uint32_t viewCount,
+            VkFormat imageFormat,
+            VkFormat depthFormat);
+
+        /**
+         * @brief Begins the pass of the layers, of its viewport and scissor
+         * @param cmdBuffer Command buffer in recording state, outside a render
+         *  pass
+         */
+        void Begin(VkCommandBuffer cmdBuffer,
+                   const std::array<VkClearValue, 2>& clearValues);
+        /** @brief Ends the pass, the layers are then read by "Render()" */
+        void End(VkCommandBuffer cmdBuffer);
+
+        /** @brief Composites the views, inside the main render pass */
+        void Render(VkCommandBuffer cmdBuffer) const;
+
+        void RecompileShaders(
+            VkRenderPass renderPass,
+            const VkExtent2D kFramebufferExtent,
+            const bool kFramebufferHasDepthAttachment);
+
+        /** @return Of the layers, for the pipelines drawing all the views */
+        const RenderPass& GetRenderPass() const { return *m_RenderPass; }
+        VkExtent2D GetViewExtent() const { return m_ViewExtent; }
+        uint32_t GetViewCount() const { return m_ViewCount; }
+        bool HasDepthAttachment() const {
+            return m_DepthImage != nullptr;
+        }
+
+    private:
+        void CreateDescriptorSetLayout();
+        void SetupPipeline();
+        /** @brief Of the layers, their framebuffer and descriptor */
+        void CreateImages();
+        void DestroyImages();
+
+    private:
+        const Device& m_kDevice;
+        const DescriptorPool& m_kDescriptorPool;
+
+        static const inline std::array<ShaderInfo, 2> s_kShaderInfos {
+            ShaderInfo{
+                .paths = { "shaders/FullScreenQuad.vert" },
+                .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                .isSPV = false
+            },
+            ShaderInfo{
+                .paths = { "shaders/MultiviewComposite.frag" },
+                .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .isSPV = false
+            }
+        };
+
+        std::unique_ptr<DescriptorSetLayout> m_DescriptorSetLayout{ nullptr };
+        VkDescriptorSet m_DescriptorSet{ VK_NULL_HANDLE };
+        std::unique_ptr<Pipeline> m_Pipeline{ nullptr };
+
+        struct CompositePushConstants
+        {
+            uint32_t viewWidth{ 1 };    ///< Of a tile, in px
+            uint32_t viewCount{ 1 };
+        };
+        static const inline VkPushConstantRange s_kPushConstantRange{
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .offset = 0,
+            .size = sizeof(CompositePushConstants)
+        };
+
+        std::unique_ptr<RenderPass> m_RenderPass{ nullptr };
+        uint32_t m_ViewCount{ 1 };
+        VkExtent2D m_ViewExtent{ 0, 0 };        ///< Of each layer
+        VkExtent2D m_FramebufferExtent{ 0, 0 }; ///< Of the main one
+
+        std::unique_ptr<Image> m_Image{ nullptr };
+        std::unique_ptr<ImageView> m_ImageView{ nullptr };
+        std::unique_ptr<Image> m_DepthImage{ nullptr };
+        std::unique_ptr<ImageView> m_DepthImageView{ nullptr };
+        std::unique_ptr<Sampler> m_Sampler{ nullptr };
+        VkFramebuffer m_Framebuffer{ VK_NULL_HANDLE };
+    };
+
+} // namespace vkp
+
+#endif // WATER_SURFACE_RENDERING_VULKAN_MULTIVIEW_TARGET_H_
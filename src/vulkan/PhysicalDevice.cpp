@@ -108,6 +108,65 @@ namespace vkp
         return UINT32_MAX;
     }
 
+    VkDeviceSize PhysicalDevice::GetDeviceLocalHostVisibleHeapSize() const
+    {
+        const VkMemoryPropertyFlags kRequiredProperties =
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+        VkDeviceSize heapSize = 0;
+        for (uint32_t i = 0; i < m_MemProperties.memoryTypeCount; ++i)
+        {
+            const VkMemoryType& kType = m_MemProperties.memoryTypes[i];
+            if ((kType.propertyFlags & kRequiredProperties) != kRequiredProperties)
+                continue;
+
+            heapSize = std::max(heapSize,
+                                m_MemProperties.memoryHeaps[kType.heapIndex].size);
+        }
+
+        return heapSize;
+    }
+
+    bool PhysicalDevice::SupportsMemoryBudget() const
+    {
+        return HasEnabledExtensions({ VK_EXT_MEMORY_BUDGET_EXTENSION_NAME });
+    }
+
+    std::vector<PhysicalDevice::HeapBudget>
+    PhysicalDevice::GetMemoryBudgets() const
+    {
+        std::vector<HeapBudget> budgets(m_MemProperties.memoryHeapCount);
+        for (uint32_t i = 0; i < m_MemProperties.memoryHeapCount; ++i)
+        {
+            const VkMemoryHeap& kHeap = m_MemProperties.memoryHeaps[i];
+            budgets[i].size = kHeap.size;
+            budgets[i].budget = kHeap.size;
+            budgets[i].isDeviceLocal =
+                kHeap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+        }
+
+        if (!SupportsMemoryBudget())
+            return budgets;
+
+        // Changes with the allocations of all the processes, queried anew
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{};
+        budgetProps.sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 memProps{};
+        memProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        memProps.pNext = &budgetProps;
+        vkGetPhysicalDeviceMemoryProperties2(m_Device, &memProps);
+
+        for (uint32_t i = 0; i < m_MemProperties.memoryHeapCount; ++i)
+        {
+            budgets[i].budget = budgetProps.heapBudget[i];
+            budgets[i].usage = budgetProps.heapUsage[i];
+        }
+        return budgets;
+    }
+
     std::vector<const char*> PhysicalDevice::GetEnabledExtensions() const
     {
         std::vector<const char*> deviceEnabledExtensions;
@@ -173,6 +232,30 @@ namespace vkp
         m_EnabledFeatures = features;
     }
 
+    void PhysicalDevice::SetEnabledFeatures(
+        VkPhysicalDeviceFeatures features,
+        VkPhysicalDeviceFeatures optionalFeatures)
+    {
+        // Compare struct members using pointers
+        VkBool32* pFeature = (VkBool32*)(&features);
+        const VkBool32* pOptFeature = (VkBool32*)(&optionalFeatures);
+        const VkBool32* pDevFeature = (VkBool32*)(&m_Features);
+        const size_t kMemberCount = sizeof(VkPhysicalDeviceFeatures) /
+                                    sizeof(VkBool32);
+
+        for (size_t i = 0; i < kMemberCount; ++i)
+        {
+            if (*pOptFeature == VK_TRUE && *pDevFeature == VK_TRUE)
+                *pFeature = VK_TRUE;
+
+            ++pFeature;
+            ++pOptFeature;
+            ++pDevFeature;
+        }
+
+        SetEnabledFeatures(features);
+    }
+
     void PhysicalDevice::AddEnabledExtensions(
         const std::vector<const char*>& extensions)
     {
@@ -17,6 +17,18 @@ namespace vkp
 {
     class PhysicalDevice 
     {
+    public:
+        /** @brief Of a memory heap, in bytes */
+        struct HeapBudget
+        {
+            VkDeviceSize size{ 0 };
+            // Of this process, the heap's size without VK_EXT_memory_budget
+            VkDeviceSize budget{ 0 };
+            // Of this process, all its allocations, zero if not reported
+            VkDeviceSize usage{ 0 };
+            bool isDeviceLocal{ false };
+        };
+
     public:
         static void PrintLogTraceMemoryRequirements(
             const VkMemoryRequirements& requirements);
@@ -45,6 +57,21 @@ namespace vkp
          */
         uint32_t FindMemoryType(uint32_t memoryTypeBitsRequirement,
                                 VkMemoryPropertyFlags requiredProperties) const;
+
+        /**
+         * @return Size of the largest heap with a memory type that is both
+         *  device local and host visible, 0 if there is none. Over 256 MiB
+         *  when the whole VRAM is mapped, i.e., with resizable BAR
+         */
+        VkDeviceSize GetDeviceLocalHostVisibleHeapSize() const;
+
+        /** @return If VK_EXT_memory_budget is enabled */
+        bool SupportsMemoryBudget() const;
+        /**
+         * @return Of each memory heap, its budget and usage queried at
+         *  the call, from VK_EXT_memory_budget if enabled
+         */
+        std::vector<HeapBudget> GetMemoryBudgets() const;
  
         bool HasFeatures(VkPhysicalDeviceFeatures reqFeatures) const;
         bool HasExtensions(
@@ -53,6 +80,12 @@ namespace vkp
             const std::vector<VkQueueFlagBits>& reqQFamilies) const;
 
         void SetEnabledFeatures(VkPhysicalDeviceFeatures features);
+        /**
+         * @brief Enables 'features', and those of 'optionalFeatures' that
+         *  the device supports
+         */
+        void SetEnabledFeatures(VkPhysicalDeviceFeatures features,
+                                VkPhysicalDeviceFeatures optionalFeatures);
 
         void AddEnabledExtensions(const std::vector<const char*>& extensions);
         bool HasEnabledExtensions(
@@ -104,11 +137,31 @@ namespace vkp
             return m_Properties.limits.minUniformBufferOffsetAlignment;
         }
 
+        inline size_t GetMinStorageBufferOffsetAlignment() const
+        {
+            return m_Properties.limits.minStorageBufferOffsetAlignment;
+        }
+
         inline size_t GetNonCoherentAtomSize() const
         {
             return m_Properties.limits.nonCoherentAtomSize;
         }
 
+        /** @return Nanoseconds per increment of the timestamps */
+        inline float GetTimestampPeriod() const
+        {
+            return m_Properties.limits.timestampPeriod;
+        }
+
+        /** @return Zero if the queues of the family have no timestamps */
+        uint32_t GetTimestampValidBits(QFamily qFamily) const
+        {
+            if (!m_QFamilyIndices[qFamily].has_value())
+                return 0;
+            return m_QFamilyProps[m_QFamilyIndices[qFamily].value()]
+                .timestampValidBits;
+        }
+
     private:
 
         void FindSupportedExtensions();
@@ -9,13 +9,14 @@
 
 namespace vkp
 {
-    Pipeline::Pipeline(VkDevice device, 
+    Pipeline::Pipeline(const Device& device, 
         const std::vector<std::shared_ptr<ShaderModule>>& modules)
         : m_Device(device),
+          m_PipelineCache(device.GetPipelineCache()),
           m_ShaderModules(modules)
     {
         VKP_REGISTER_FUNCTION();
-        VKP_ASSERT(device != VK_NULL_HANDLE);
+        VKP_ASSERT(m_Device != VK_NULL_HANDLE);
 
         InitShaderStages();
 
@@ -29,8 +30,6 @@ namespace vkp
         m_ColorBlendAttachment = Pipeline::InitColorBlendAttachment();
         m_ColorBlending = Pipeline::InitColorBlending(m_ColorBlendAttachment);
         m_PipelineLayoutInfo = Pipeline::InitPipelineLayout();
-
-        m_PipelineCache = CreatePipelineCache();
     }
 
     Pipeline::~Pipeline()
@@ -38,7 +37,6 @@ namespace vkp
         VKP_REGISTER_FUNCTION();
         DestroyPipeline();
         DestroyPipelineLayout();
-        DestroyPipelineCache();
     }
 
     void Pipeline::DestroyPipeline()
@@ -59,15 +57,6 @@ namespace vkp
         }
     }
 
-    void Pipeline::DestroyPipelineCache()
-    {
-        if (m_PipelineCache != VK_NULL_HANDLE)
-        {
-            vkDestroyPipelineCache(m_Device, m_PipelineCache, nullptr);
-            m_PipelineCache = VK_NULL_HANDLE;
-        }
-    }
-
     void Pipeline::InitShaderStages()
     {
         m_ShaderStages.resize(m_ShaderModules.size());
@@ -80,19 +69,6 @@ namespace vkp
         }
     }
 
-    VkPipelineCache Pipeline::CreatePipelineCache()
-    {
-    	VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
-	    pipelineCacheCreateInfo.sType = 
-            VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-
-        VkPipelineCache pipelineCache;
-        auto err = vkCreatePipelineCache(m_Device, &pipelineCacheCreateInfo,
-                                         nullptr, &pipelineCache);
-        VKP_ASSERT_RESULT(err);
-        return pipelineCache;
-    }
-
     void Pipeline::Create(const VkExtent2D kSurfaceExtent, 
                           VkRenderPass renderPass, 
                           bool enableDepthTesting)
@@ -111,6 +87,12 @@ namespace vkp
         m_ViewportState = Pipeline::InitViewportScissor(viewport, scissor);
 
         m_DepthStencil = Pipeline::InitDepthStencil(enableDepthTesting);
+        if (enableDepthTesting)
+        {
+            m_DepthStencil.depthCompareOp = m_DepthCompareOp;
+            m_DepthStencil.depthWriteEnable =
+                m_DepthWriteEnable ? VK_TRUE : VK_FALSE;
+        }
 
         m_RenderPass = renderPass;
         m_Pipeline = CreatePipeline();
@@ -129,18 +111,32 @@ namespace vkp
     {
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        if (m_ShadingRateState.sType != 0)
+            pipelineInfo.pNext = &m_ShadingRateState;
 
         pipelineInfo.stageCount = m_ShaderStages.size();
         pipelineInfo.pStages = m_ShaderStages.data();
         pipelineInfo.pVertexInputState = &m_VertexInputInfo;
         pipelineInfo.pInputAssemblyState = &m_InputAssembly;
+        pipelineInfo.pTessellationState =
+            m_TessellationState.patchControlPoints > 0 ? &m_TessellationState
+                                                       : nullptr;
         pipelineInfo.pViewportState = &m_ViewportState;
         pipelineInfo.pRasterizationState = &m_RasterizationState;
         pipelineInfo.pMultisampleState = &m_Multisampling;
         pipelineInfo.pDepthStencilState = &m_DepthStencil;
         pipelineInfo.pColorBlendState = &m_ColorBlending;
-        // TODO
-        pipelineInfo.pDynamicState = nullptr;
+        // Independent of the framebuffer extent
+        const std::array<VkDynamicState, 2> kDynamicStates{
+            VK_DYNAMIC_STATE_VIEWPORT,
+            VK_DYNAMIC_STATE_SCISSOR
+        };
+        VkPipelineDynamicStateCreateInfo dynamicState{};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount =
+            static_cast<uint32_t>(kDynamicStates.size());
+        dynamicState.pDynamicStates = kDynamicStates.data();
+        pipelineInfo.pDynamicState = &dynamicState;
 
         pipelineInfo.layout = m_PipelineLayout;
         // Specify the render pass and the index of the subpass where this 
@@ -151,7 +147,6 @@ namespace vkp
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
         //  Create just 1 graphics pipeline
-        //      No VkPipelineCache object TODO
         VkPipeline pipeline;
         auto err = vkCreateGraphicsPipelines(m_Device, m_PipelineCache, 1,
                                              &pipelineInfo, nullptr, &pipeline);
@@ -205,6 +200,36 @@ namespace vkp
         return needsRecreation;
     }
 
+    bool Pipeline::HasShaderModules() const
+    {
+        for (const auto& kModule : m_ShaderModules)
+        {
+            if (kModule->GetModule() == VK_NULL_HANDLE)
+                return false;
+        }
+        return true;
+    }
+
+    bool Pipeline::HasSameShaders(const Pipeline& other) const
+    {
+        if (m_ShaderModules.size() != other.m_ShaderModules.size())
+            return false;
+
+        for (size_t i = 0; i < m_ShaderModules.size(); ++i)
+        {
+            const ShaderModule& kModule = *m_ShaderModules[i];
+            const ShaderModule& kOther = *other.m_ShaderModules[i];
+
+            if (kModule.GetSourceHash() == 0 ||
+                kModule.GetSourceHash() != kOther.GetSourceHash() ||
+                kModule.GetStage() != kOther.GetStage())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
     // =========================================================================
     // =========================================================================
 
@@ -220,6 +245,21 @@ namespace vkp
         m_VertexInputInfo = state;
     }
 
+    void Pipeline::SetInputAssemblyState(
+        const VkPipelineInputAssemblyStateCreateInfo& state)
+    {
+        m_InputAssembly = state;
+    }
+
+    void Pipeline::SetTessellationState(uint32_t patchControlPoints)
+    {
+        m_TessellationState.sType =
+            VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+        m_TessellationState.patchControlPoints = patchControlPoints;
+
+        m_InputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+    }
+
     void Pipeline::SetRasterizationState(
         const VkPipelineRasterizationStateCreateInfo& state)
     {
@@ -232,6 +272,57 @@ namespace vkp
         m_RasterizationState = state;
     }
 
+    void Pipeline::SetDepthState(VkCompareOp compareOp, bool writesDepth)
+    {
+        m_DepthCompareOp = compareOp;
+        m_DepthWriteEnable = writesDepth;
+    }
+
+    void Pipeline::SetColorWriteMask(VkColorComponentFlags mask)
+    {
+        // Referenced by the color blending state
+        m_ColorBlendAttachment.colorWriteMask = mask;
+    }
+
+    void Pipeline::SetAdditiveBlending()
+    {
+        m_ColorBlendAttachment.blendEnable = VK_TRUE;
+        m_ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        m_ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        m_ColorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+        m_ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        m_ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        m_ColorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    }
+
+    void Pipeline::SetPremultipliedBlending()
+    {
+        m_ColorBlendAttachment.blendEnable = VK_TRUE;
+        m_ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        m_ColorBlendAttachment.dstColorBlendFactor =
+            VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        m_ColorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+        m_ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        m_ColorBlendAttachment.dstAlphaBlendFactor =
+            VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        m_ColorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    }
+
+    void Pipeline::SetPrimitiveShadingRate()
+    {
+        m_ShadingRateState = {
+            .sType =
+                VK_STRUCTURE_TYPE_PIPELINE_FRAGMENT_SHADING_RATE_STATE_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .fragmentSize = { 1, 1 },
+            // Primitive's rate replaces the pipeline's, no attachment
+            .combinerOps = {
+                VK_FRAGMENT_SHADING_RATE_COMBINER_OP_REPLACE_KHR,
+                VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR
+            }
+        };
+    }
+
 
 
     // =========================================================================
@@ -324,6 +415,17 @@ namespace vkp
         };
     }
 
+    void Pipeline::CmdSetViewportScissor(
+        VkCommandBuffer cmdBuffer,
+        const VkExtent2D& surfaceExtent)
+    {
+        const VkViewport kViewport = Pipeline::InitViewport(surfaceExtent);
+        const VkRect2D kScissor = Pipeline::InitScissor(surfaceExtent);
+
+        vkCmdSetViewport(cmdBuffer, 0, 1, &kViewport);
+        vkCmdSetScissor(cmdBuffer, 0, 1, &kScissor);
+    }
+
     VkPipelineRasterizationStateCreateInfo Pipeline::InitRasterization()
     {
         //> m_RasterizationState
@@ -9,6 +9,7 @@
 #include <array>
 #include <memory>
 #include <vulkan/vulkan.h>
+#include "vulkan/Device.h"
 #include "vulkan/ShaderModule.h"
 
 
@@ -20,11 +21,11 @@ namespace vkp
     public:
         /**
          * @brief Makes the pipeline ready for any subsequent creation
-         * @param device Created logical device
+         * @param device Created logical device, of the pipeline cache
          * @param shaderStages Vector of shader stages to be used for the
          *  pipeline creation
          */
-        Pipeline(VkDevice device,
+        Pipeline(const Device& device,
                  const std::vector<std::shared_ptr<ShaderModule>>& modules);
         ~Pipeline();
 
@@ -37,6 +38,8 @@ namespace vkp
         /**
          * @brief On any subsequent call creates a new pipeline and pipeline 
          *  layout from its own initialized data members and parameters.
+         *  Viewport and scissor are dynamic, of the surface extent by
+         *  "CmdSetViewportScissor()", hence it is not recreated on a resize
          */
         // TODO fix needed params
         void Create(const VkExtent2D surfaceExtent,
@@ -53,6 +56,14 @@ namespace vkp
          */
         bool RecompileShaders();
 
+        /** @return Whether all the shader modules were created */
+        bool HasShaderModules() const;
+        /**
+         * @return Whether the other's shader modules are of the same GLSL
+         *  sources, stage by stage
+         */
+        bool HasSameShaders(const Pipeline& other) const;
+
         // ---------------------------------------------------------------------
 
         /**
@@ -63,11 +74,46 @@ namespace vkp
             const VkPipelineVertexInputStateCreateInfo& state);
         void SetVertexInputState(VkPipelineVertexInputStateCreateInfo&& state);
 
+        void SetInputAssemblyState(
+            const VkPipelineInputAssemblyStateCreateInfo& state);
+
+        /**
+         * @brief Enables the tessellation stages, the topology must be
+         *  a patch list
+         * @param patchControlPoints Number of vertices of a patch
+         */
+        void SetTessellationState(uint32_t patchControlPoints);
+
         void SetRasterizationState(
             const VkPipelineRasterizationStateCreateInfo& state);
         void SetRasterizationState(
             VkPipelineRasterizationStateCreateInfo&& state);
 
+        /**
+         * @brief Sets the depth test of subsequent creations with depth
+         *  testing enabled, VK_COMPARE_OP_LESS with writes by default
+         */
+        void SetDepthState(VkCompareOp compareOp, bool writesDepth);
+
+        /** @brief Zero for none of the color, e.g., of a depth-only pass */
+        void SetColorWriteMask(VkColorComponentFlags mask);
+
+        /** @brief Adds the fragments' colors to the attachment's ones */
+        void SetAdditiveBlending();
+
+        /**
+         * @brief Blends the fragments' premultiplied colors over the
+         *  attachment's ones, of the fragments' alpha
+         */
+        void SetPremultipliedBlending();
+
+        /**
+         * @brief Fragments are shaded at the rate written by the last stage
+         *  before the rasterization, of each primitive, 1x1 if none
+         * @pre "Device::SupportsPrimitiveShadingRate()"
+         */
+        void SetPrimitiveShadingRate();
+
         VkPipelineRasterizationStateCreateInfo& GetRasterizationState()
         {
             return m_RasterizationState;
@@ -111,6 +157,14 @@ namespace vkp
         static VkPipelineViewportStateCreateInfo InitViewportScissor(
             const VkViewport& kViewport, const VkRect2D& kScissor);
 
+        /**
+         * @brief Sets the dynamic viewport and scissor of the graphics
+         *  pipelines, for the entire surface, not inherited by secondary
+         *  command buffers
+         */
+        static void CmdSetViewportScissor(VkCommandBuffer cmdBuffer,
+                                          const VkExtent2D& surfaceExtent);
+
         // @brief Initializes rasterizer state with predefined parameters
         static VkPipelineRasterizationStateCreateInfo InitRasterization();
 
@@ -136,14 +190,12 @@ namespace vkp
 
         VkPipelineLayout CreatePipelineLayout();
         VkPipeline       CreatePipeline(uint32_t subpass = 0) const;
-        VkPipelineCache  CreatePipelineCache();
 
         VkPipeline CreateComputePipeline() const;
 
 
         void DestroyPipelineLayout();
         void DestroyPipeline();
-        void DestroyPipelineCache();
 
     private:
         VkDevice         m_Device    { VK_NULL_HANDLE };
@@ -153,6 +205,7 @@ namespace vkp
         // Owned
         VkPipelineLayout m_PipelineLayout{ VK_NULL_HANDLE };
         VkPipeline       m_Pipeline      { VK_NULL_HANDLE };
+        // Of the device, shared
         VkPipelineCache  m_PipelineCache { VK_NULL_HANDLE };
 
         std::vector<std::shared_ptr<ShaderModule>>   m_ShaderModules{};
@@ -162,6 +215,8 @@ namespace vkp
 
         VkPipelineVertexInputStateCreateInfo   m_VertexInputInfo     {};
         VkPipelineInputAssemblyStateCreateInfo m_InputAssembly       {};
+        // Without patch control points, if not tessellated
+        VkPipelineTessellationStateCreateInfo  m_TessellationState   {};
         VkPipelineViewportStateCreateInfo      m_ViewportState       {};
         VkPipelineRasterizationStateCreateInfo m_RasterizationState  {};
         VkPipelineMultisampleStateCreateInfo   m_Multisampling       {};
@@ -170,6 +225,13 @@ namespace vkp
         VkPipelineColorBlendStateCreateInfo    m_ColorBlending       {};
 
         VkPipelineLayoutCreateInfo             m_PipelineLayoutInfo  {};
+
+        // Chained to the creation, if set by "SetPrimitiveShadingRate()"
+        VkPipelineFragmentShadingRateStateCreateInfoKHR m_ShadingRateState{};
+
+        // Of the depth test, if enabled by "Create()"
+        VkCompareOp m_DepthCompareOp{ VK_COMPARE_OP_LESS };
+        bool        m_DepthWriteEnable{ true };
     };
 
 } // namespace vkp
@@ -116,7 +116,26 @@ namespace vkp
         info.pSubpasses = m_Subpasses.data();
         info.dependencyCount = static_cast<uint32_t>(m_SubpassDependencies.size());
         info.pDependencies = m_SubpassDependencies.data();
-    
+
+        // Each view of its own layer, correlated as the views of a rig, so
+        //  they may be rendered concurrently
+        const uint32_t kViewMask = (1u << m_ViewCount) - 1;
+        const VkRenderPassMultiviewCreateInfo kMultiviewInfo{
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO,
+            .pNext = nullptr,
+            .subpassCount = 1,
+            .pViewMasks = &kViewMask,
+            .dependencyCount = 0,
+            .pViewOffsets = nullptr,
+            .correlationMaskCount = 1,
+            .pCorrelationMasks = &kViewMask
+        };
+        if (m_ViewCount > 1)
+        {
+            VKP_ASSERT(m_Subpasses.size() == 1);
+            info.pNext = &kMultiviewInfo;
+        }
+
         auto err = vkCreateRenderPass(m_Device, &info, nullptr, &m_RenderPass);
         VKP_ASSERT_RESULT(err);
     }
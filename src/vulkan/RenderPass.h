@@ -70,6 +70,20 @@ namespace vkp
         
         std::vector<VkAttachmentDescription>& 
             GetAttachmentDescriptions() { return m_Attachments; }
+
+        /**
+         * @brief Of the next "Create()", renders each draw of the subpass to
+         *  'viewCount' layers of the attachments, the view index of each is
+         *  "gl_ViewIndex" of the shaders, @see "Device::SupportsMultiview()"
+         * @param viewCount 1 of a single view, without the multiview
+         */
+        void SetViewCount(uint32_t viewCount) { m_ViewCount = viewCount; }
+        uint32_t GetViewCount() const { return m_ViewCount; }
+
+        VkFormat GetAttachmentFormat() const { return m_AttachmentFormat; }
+        VkFormat GetDepthAttachmentFormat() const {
+            return m_DepthAttachmentFormat;
+        }
         
     private:
 
@@ -95,6 +109,9 @@ namespace vkp
 
         std::vector<VkSubpassDescription>    m_Subpasses{};
         std::vector<VkSubpassDependency>     m_SubpassDependencies{};
+
+        // Of the layers of the attachments, of the single subpass
+        uint32_t m_ViewCount{ 1 };
     };
 
 } // namespace vkp
@@ -6,6 +6,10 @@
 #include "pch.h"
 #include "vulkan/ShaderModule.h"
 
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
 #include "vulkan/utils.h"
 #include <shaderc/shaderc.hpp>
 
@@ -198,6 +202,108 @@ namespace vkp
         return { module.cbegin(), module.cend() };
     }
 
+    // -------------------------------------------------------------------------
+    // SPIR-V cache
+
+    // Bump when the compile options, or the key, change
+    static constexpr uint32_t s_kSPVCacheVersion{ 1 };
+
+    /** @return 64-bit FNV-1a hash of the data, continued from 'hash' */
+    uint64_t HashFNV1a(const void* data, size_t size,
+                       uint64_t hash = 14695981039346656037ull)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /**
+     * @return Hash of the whole GLSL source, of the concatenated files, and
+     *  of everything else the compiled SPIR-V depends on
+     */
+    uint64_t HashGLSL(const std::vector<char>& source,
+                      shaderc_shader_kind kind,
+                      bool optimize)
+    {
+        unsigned int spvVersion = 0, spvRevision = 0;
+        shaderc_get_spv_version(&spvVersion, &spvRevision);
+
+        const uint32_t kOptions[] = {
+            s_kSPVCacheVersion,
+            static_cast<uint32_t>(kind),
+            optimize,
+            spvVersion,
+            spvRevision
+        };
+
+        const uint64_t kHash = HashFNV1a(kOptions, sizeof(kOptions));
+        return HashFNV1a(source.data(), source.size(), kHash);
+    }
+
+    std::filesystem::path GetSPVCachePath(std::string_view dir, uint64_t hash)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.spv",
+                 static_cast<unsigned long long>(hash));
+        return std::filesystem::path(dir) / name;
+    }
+
+    /** @return Empty if not cached, or not a SPIR-V binary */
+    std::vector<uint32_t> LoadCachedSPV(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (!file.is_open())
+            return {};
+
+        const size_t kSize = static_cast<size_t>(file.tellg());
+        if (kSize == 0 || kSize % sizeof(uint32_t) != 0)
+            return {};
+
+        std::vector<uint32_t> spv(kSize / sizeof(uint32_t));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(spv.data()), kSize);
+
+        const uint32_t kSPVMagic = 0x07230203;
+        if (!file || spv[0] != kSPVMagic)
+            return {};
+
+        return spv;
+    }
+
+    void StoreCachedSPV(std::string_view dir,
+                        const std::filesystem::path& path,
+                        const std::vector<uint32_t>& spv)
+    {
+        std::error_code err;
+        std::filesystem::create_directories(dir, err);
+
+        // Written aside, then renamed, not to leave a partial binary, nor to
+        //  interleave with another thread compiling the same source
+        std::filesystem::path tmpPath = path;
+        tmpPath += "." + std::to_string(
+            std::hash<std::thread::id>{}(std::this_thread::get_id())
+        ) + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(spv.data()),
+                       spv.size() * sizeof(uint32_t));
+            if (err || !file)
+            {
+                VKP_LOG_WARN("SPIR-V could not be cached to: {}",
+                             path.string());
+                return;
+            }
+        }
+
+        std::filesystem::rename(tmpPath, path, err);
+        if (err)
+            std::filesystem::remove(tmpPath, err);
+    }
+
     // -------------------------------------------------------------------------
 
     bool ShaderModule::FromGLSL(const std::vector<std::string_view>& files,
@@ -216,16 +322,38 @@ namespace vkp
         }
         VKP_ASSERT(code.size() > 0);
 
-        // Compile the GLSL code in SPV binary
-        std::vector<uint32_t> spvBinary = 
-            CompileGLSL(code.data(), code.size(),
-                                      FromShaderStageToKind(stage),
-                                      files.back().data());
-        if (spvBinary.empty())  // an error occured
+        const shaderc_shader_kind kKind = FromShaderStageToKind(stage);
+        const bool kOptimize = false;
+        const uint64_t kHash = HashGLSL(code, kKind, kOptimize);
+
+        // Nothing to recompile
+        if (m_ShaderModule != VK_NULL_HANDLE && m_IsFromGLSL &&
+            stage == m_ShaderStage && kHash == m_SourceHash)
         {
             return false;
         }
 
+        const std::filesystem::path kCachePath =
+            GetSPVCachePath(s_kSPVCacheDir, kHash);
+
+        std::vector<uint32_t> spvBinary = LoadCachedSPV(kCachePath);
+        if (spvBinary.empty())
+        {
+            // Compile the GLSL code in SPV binary
+            spvBinary = CompileGLSL(code.data(), code.size(), kKind,
+                                    files.back().data(), kOptimize);
+            if (spvBinary.empty())  // an error occured
+            {
+                return false;
+            }
+
+            StoreCachedSPV(s_kSPVCacheDir, kCachePath, spvBinary);
+        }
+        else
+        {
+            VKP_LOG_INFO("Loaded cached SPIR-V: {}", kCachePath.string());
+        }
+
         if (m_ShaderModule != VK_NULL_HANDLE)
         {
             Destroy();
@@ -234,6 +362,7 @@ namespace vkp
         m_ShaderModule = CreateShaderModule(spvBinary);
         m_ShaderStage = stage;
         m_IsFromGLSL = true;
+        m_SourceHash = kHash;
 
         VKP_LOG_INFO("same? {}", m_Files == files);
         if (m_Files != files)
@@ -81,6 +81,10 @@ namespace vkp
          *  Reads the GLSL files, concatenates the contents in the given order,
          *  tries to compile it, if succeeds, then creates a shader module. 
          *  Can be called consecutively to reload the shader code.
+         *  The SPIR-V is cached in s_kSPVCacheDir by the hash of the contents,
+         *  the stage and the compile options, only new contents are compiled
+         * @return False also if the module was already created of the same
+         *  contents, then it persists
          * @param files Path to files with shader code
          * @param stage Stage of the shader module, to be used in pipeline
          * @return True if succeded
@@ -100,6 +104,8 @@ namespace vkp
 
         VkShaderModule        GetModule() const { return m_ShaderModule; }
         VkShaderStageFlagBits GetStage() const { return m_ShaderStage; }
+        /** @return Of the GLSL the module was created from, 0 if of SPV */
+        uint64_t              GetSourceHash() const { return m_SourceHash; }
 
     private:
 
@@ -115,6 +121,8 @@ namespace vkp
         void Destroy();
 
     private:
+        static constexpr std::string_view s_kSPVCacheDir{ "cache/spirv" };
+
         VkDevice              m_Device      { VK_NULL_HANDLE };
         VkShaderModule        m_ShaderModule{ VK_NULL_HANDLE };
 
@@ -122,6 +130,8 @@ namespace vkp
 
         std::vector<std::string_view> m_Files;
         bool                          m_IsFromGLSL{false};
+        // Of the GLSL contents and options of the module, @see FromGLSL()
+        uint64_t                      m_SourceHash{ 0 };
     };
 
 } // namespace vkp
@@ -12,7 +12,7 @@ namespace vkp
     SwapChain::SwapChain(const Device& device, const Surface& surface)
         : m_Device(device),
           m_Surface(surface),
-          m_DepthImage(device),
+          m_DepthImage(device, MemoryTag::Framebuffer),
           m_DepthImageView(device)
     {
         VKP_REGISTER_FUNCTION();
@@ -106,6 +106,11 @@ namespace vkp
         return VK_FORMAT_UNDEFINED;
     }
 
+    void SwapChain::SetFramesInFlight(uint32_t count)
+    {
+        m_FramesInFlight = std::clamp(count, 1u, s_kMaxFramesInFlight);
+    }
+
     void SwapChain::Create(uint32_t width, uint32_t height,
                            bool depthAttachment)
     {
@@ -116,43 +121,70 @@ namespace vkp
 
         const VkPresentModeKHR kPresentMode =
             SelectSwapPresentMode(m_Details.presentModes);
+        m_PresentMode = kPresentMode;
 
-        auto err = m_Device.WaitIdle();
-        VKP_ASSERT_RESULT(err);
+        // Of the frames in flight, the resources of each are reused once its
+        //  previous submission is done
+        std::vector<uint64_t> frameSubmitValues(m_FramesInFlight,
+                                                m_LastSubmitValue);
+        for (size_t i = 0; i < m_FrameSyncs.size() && i < m_FramesInFlight; ++i)
+            frameSubmitValues[i] = m_FrameSyncs[i].submitValue;
 
-        VKP_ASSERT(m_Frames.size() == m_FrameSemaphores.size());
-        for (uint32_t i = 0; i < m_Frames.size(); ++i)
-        {
-            DestroyFrame(m_Frames[i]);
-            DestroyFrameSemaphores(m_FrameSemaphores[i]);
-        }
+        const uint32_t kCurrentFrame =
+            m_CurrentFrame < m_FramesInFlight ? m_CurrentFrame : 0;
 
-        if (m_HasDepthAttachment)
-            DestroyDepthResources();
+        // Instead of waiting for the device
+        RetireResources();
 
         // Min image count was not specified
         if (m_MinImageCount == 0)
             m_MinImageCount = GetMinImageCountFromPresentMode(kPresentMode);
 
-        VkSwapchainKHR oldSwapChain = m_SwapChain;
+        if (m_IsOffscreen)
+        {
+            // Any previous swap chain is no longer presented to
+            if (m_SwapChain != VK_NULL_HANDLE)
+            {
+                VKP_ASSERT(!m_Retired.empty());
+                m_Retired.back().swapChain = m_SwapChain;
+                m_SwapChain = VK_NULL_HANDLE;
+            }
+
+            CreateOffscreenImages(width, height);
+            CreateImageViews({ m_ImageFormat, s_kRequestedSurfaceColorSpace });
+        }
+        else
+        {
+            VkSwapchainKHR oldSwapChain = m_SwapChain;
 
-        CreateSwapChain(kSurfaceFormat, kPresentMode, width, height);
+            CreateSwapChain(kSurfaceFormat, kPresentMode, width, height);
 
-        RetrieveAllocateImageHandles();
+            RetrieveAllocateImageHandles();
 
-        if (oldSwapChain != VK_NULL_HANDLE)
-            vkDestroySwapchainKHR(m_Device, oldSwapChain, nullptr);
+            if (oldSwapChain != VK_NULL_HANDLE)
+            {
+                VKP_ASSERT(!m_Retired.empty());
+                m_Retired.back().swapChain = oldSwapChain;
+            }
 
-        CreateImageViews(kSurfaceFormat);
+            CreateImageViews(kSurfaceFormat);
+        }
         CreateSyncObjects();
 
+        for (size_t i = 0; i < m_FrameSyncs.size(); ++i)
+            m_FrameSyncs[i].submitValue = frameSubmitValues[i];
+
         if (depthAttachment)
             CreateDepthResources();
 
         m_HasDepthAttachment = depthAttachment;
 
-        m_FrameIndex = 0;
+        m_ImageIndex = 0;
+        m_CurrentFrame = kCurrentFrame;
         m_SwapChainRecreate = false;
+
+        // Presents to the old swap chain are no longer polled
+        m_LastDisplayedId = m_LastPresentId;
     }
 
     // =========================================================================
@@ -164,12 +196,33 @@ namespace vkp
     {
         VKP_ASSERT(imageIndex != nullptr);
 
-        auto& imageAcquiredSemaphore =
-            m_FrameSemaphores[m_SemaphoreIndex].imageAcquiredSemaphore;
+        const FrameSync& kSync = m_FrameSyncs[m_CurrentFrame];
+        const Timeline& kTimeline = m_Device.GetTimeline(QFamily::Graphics);
+
+        using Clock = std::chrono::steady_clock;
+        const auto kWaitBegin = Clock::now();
+        auto toMillis = [](Clock::duration d) {
+            return std::chrono::duration<float, std::milli>(d).count();
+        };
+
+        // Resources of the frame in flight are free once its previous
+        //  submission has finished
+        kTimeline.Wait(kSync.submitValue);
+        m_FrameWaitTime = toMillis(Clock::now() - kWaitBegin);
+
+        ReleaseRetired(false);
+
+        // Image of the frame in flight, free once its submission is done
+        if (m_IsOffscreen)
+        {
+            m_ImageIndex = m_CurrentFrame;
+            *imageIndex = m_ImageIndex;
+            return VK_SUCCESS;
+        }
 
         VkResult err = vkAcquireNextImageKHR(m_Device, m_SwapChain, UINT64_MAX,
-                                             imageAcquiredSemaphore,
-                                             VK_NULL_HANDLE, &m_FrameIndex);
+                                             kSync.imageAcquiredSemaphore,
+                                             VK_NULL_HANDLE, &m_ImageIndex);
         if (err == VK_ERROR_OUT_OF_DATE_KHR || err == VK_SUBOPTIMAL_KHR)
         {
             m_SwapChainRecreate = true;
@@ -177,21 +230,13 @@ namespace vkp
         }
         VKP_ASSERT_RESULT_MSG(err, "Failed to acquire swap chain image");
 
-        *imageIndex = m_FrameIndex;
-
-        m_CurrentFrame = (m_CurrentFrame + 1) % GetImageCount();
-
-        // Wait for any previous frame that is using the image
-        //  there is a fence to wait on
+        *imageIndex = m_ImageIndex;
 
-        auto& fence = m_Frames[m_FrameIndex].fence;
-
-        auto err1 = vkWaitForFences(m_Device, 1, &fence, VK_TRUE, UINT64_MAX);
-        VKP_ASSERT_RESULT(err1);
-
-        //  Restore the fence to the unsignaled state
-        err1 = vkResetFences(m_Device, 1, &fence);
-        VKP_ASSERT_RESULT(err1);
+        // Another frame in flight may still render to the image, if there are
+        //  more frames than images, or the images are acquired out of order
+        const auto kImageWaitBegin = Clock::now();
+        kTimeline.Wait(m_Frames[m_ImageIndex].submitValue);
+        m_FrameWaitTime += toMillis(Clock::now() - kImageWaitBegin);
 
         return err;
     }
@@ -206,11 +251,11 @@ namespace vkp
         // Execute the command buffers
 
         const std::array<VkSemaphore, 1> kWaitSemaphores { 
-            m_FrameSemaphores[m_SemaphoreIndex].imageAcquiredSemaphore
+            m_FrameSyncs[m_CurrentFrame].imageAcquiredSemaphore
         };
         // Which semaphores to signal once the cmd buffer(s) have finished exec.
         const std::array<VkSemaphore, 1> kSignalSemaphores { 
-            m_FrameSemaphores[m_SemaphoreIndex].renderCompleteSemaphore
+            m_Frames[m_ImageIndex].renderCompleteSemaphore
         };
 
         VkSubmitInfo submitInfo {
@@ -227,32 +272,32 @@ namespace vkp
             .pSignalSemaphores = kSignalSemaphores.data()
         };
 
-        //  Add fences to sync CPU-GPU - should be signaled when the command buffer
-        //  finishes executing -> signal that a frame has finished
-
-        auto err = m_Device.QueueSubmit(QFamily::Graphics, { submitInfo },
-                                        m_Frames[m_FrameIndex].fence);
-        VKP_ASSERT_RESULT_MSG(err, "Failed to submit draw command buffer");
+        SubmitToTimeline(submitInfo, {});
     }
 
     void SwapChain::SubmitFrame(
         std::vector<VkSemaphore> waitSemaphores,
         const std::vector<VkPipelineStageFlags>& kWaitStages,
         const std::vector<VkCommandBuffer>& commandBuffers,
-        std::vector<VkSemaphore> signalSemaphores)
+        std::vector<VkSemaphore> signalSemaphores,
+        const std::vector<uint64_t>& kWaitValues)
     {
         if (m_SwapChainRecreate)
             return; 
 
         // Submit the command buffers
 
-        waitSemaphores.push_back(
-            m_FrameSemaphores[m_SemaphoreIndex].imageAcquiredSemaphore
-        );
+        // Neither acquired nor presented, the last wait stage is unused
+        if (!m_IsOffscreen)
+        {
+            waitSemaphores.push_back(
+                m_FrameSyncs[m_CurrentFrame].imageAcquiredSemaphore
+            );
 
-        signalSemaphores.push_back(
-            m_FrameSemaphores[m_SemaphoreIndex].renderCompleteSemaphore
-        );
+            signalSemaphores.push_back(
+                m_Frames[m_ImageIndex].renderCompleteSemaphore
+            );
+        }
 
         VkSubmitInfo submitInfo {
             .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
@@ -268,12 +313,21 @@ namespace vkp
             .pSignalSemaphores = signalSemaphores.data()
         };
 
-        //  Add fences to sync CPU-GPU - should be signaled when the command buffer
-        //  finishes executing -> signal that a frame has finished
+        SubmitToTimeline(submitInfo, kWaitValues);
+    }
+
+    void SwapChain::SubmitToTimeline(
+        const VkSubmitInfo& submitInfo,
+        const std::vector<uint64_t>& waitValues)
+    {
+        // Signals the value the next acquire of the frame, and of the image,
+        //  waits for, instead of a fence reset and signaled per frame
+        m_LastSubmitValue = m_Device.GetTimeline(QFamily::Graphics).Submit(
+            submitInfo, waitValues
+        );
 
-        auto err = m_Device.QueueSubmit(QFamily::Graphics, { submitInfo },
-                                        m_Frames[m_FrameIndex].fence);
-        VKP_ASSERT_RESULT_MSG(err, "Failed to submit draw command buffer");
+        m_FrameSyncs[m_CurrentFrame].submitValue = m_LastSubmitValue;
+        m_Frames[m_ImageIndex].submitValue = m_LastSubmitValue;
     }
 
     void SwapChain::PresentFrame()
@@ -281,7 +335,14 @@ namespace vkp
         if (m_SwapChainRecreate)
             return; 
 
-        VKP_ASSERT(m_FrameSemaphores.size() > m_SemaphoreIndex);
+        VKP_ASSERT(m_Frames.size() > m_ImageIndex);
+
+        if (m_IsOffscreen)
+        {
+            m_CurrentFrame = (m_CurrentFrame + 1) % GetFramesInFlight();
+            ++m_PresentCount;
+            return;
+        }
 
         // Return the image to the swap chain for presentation
 
@@ -289,10 +350,36 @@ namespace vkp
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
         presentInfo.waitSemaphoreCount = 1;
         presentInfo.pWaitSemaphores =
-            &m_FrameSemaphores[m_SemaphoreIndex].renderCompleteSemaphore;
+            &m_Frames[m_ImageIndex].renderCompleteSemaphore;
         presentInfo.swapchainCount = 1;
         presentInfo.pSwapchains = &m_SwapChain;
-        presentInfo.pImageIndices = &m_FrameIndex;
+        presentInfo.pImageIndices = &m_ImageIndex;
+
+        // Id of the present, by which its display time is polled
+        const PresentTiming kPresentTiming = GetPresentTiming();
+        const uint64_t kPresentId = m_LastPresentId + 1;
+
+        VkPresentIdKHR presentIdInfo{
+            .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+            .pNext = nullptr,
+            .swapchainCount = 1,
+            .pPresentIds = &kPresentId
+        };
+        const VkPresentTimeGOOGLE kPresentTime{
+            .presentID = static_cast<uint32_t>(kPresentId),
+            .desiredPresentTime = 0     // As soon as possible
+        };
+        VkPresentTimesInfoGOOGLE presentTimesInfo{
+            .sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE,
+            .pNext = nullptr,
+            .swapchainCount = 1,
+            .pTimes = &kPresentTime
+        };
+
+        if (kPresentTiming == PresentTiming::DisplayTiming)
+            presentInfo.pNext = &presentTimesInfo;
+        else if (kPresentTiming == PresentTiming::PresentWait)
+            presentInfo.pNext = &presentIdInfo;
 
         // Submits the request to present an image to the swap chain
 
@@ -304,8 +391,76 @@ namespace vkp
         } 
         VKP_ASSERT_RESULT_MSG(err, "Failed to present swap chain image");
 
+        if (kPresentTiming != PresentTiming::None)
+            m_LastPresentId = kPresentId;
+
         // Set the following frame for processing
-        m_SemaphoreIndex = (m_SemaphoreIndex + 1) % GetImageCount();
+        m_CurrentFrame = (m_CurrentFrame + 1) % GetFramesInFlight();
+        ++m_PresentCount;
+    }
+
+    SwapChain::PresentTiming SwapChain::GetPresentTiming() const
+    {
+        if (m_IsOffscreen)
+            return PresentTiming::None;
+        if (m_Device.SupportsDisplayTiming())
+            return PresentTiming::DisplayTiming;
+        if (m_Device.SupportsPresentWait())
+            return PresentTiming::PresentWait;
+        return PresentTiming::None;
+    }
+
+    std::vector<SwapChain::PresentTime> SwapChain::PollPresentTimes()
+    {
+        std::vector<PresentTime> times;
+        if (m_SwapChain == VK_NULL_HANDLE || m_LastDisplayedId == m_LastPresentId)
+            return times;
+
+        switch (GetPresentTiming())
+        {
+        case PresentTiming::DisplayTiming:
+        {
+            for (const auto& kTiming :
+                    m_Device.GetPastPresentationTiming(m_SwapChain))
+            {
+                // Of the 32-bit ids, those of a replaced swap chain are older
+                const uint64_t kId = (m_LastPresentId & ~0xFFFFFFFFull) |
+                                     kTiming.presentID;
+                if (kId <= m_LastDisplayedId || kId > m_LastPresentId)
+                    continue;
+
+                times.push_back({
+                    kId,
+                    std::chrono::steady_clock::time_point(
+                        std::chrono::nanoseconds(kTiming.actualPresentTime)
+                    )
+                });
+                m_LastDisplayedId = kId;
+            }
+            break;
+        }
+        case PresentTiming::PresentWait:
+        {
+            // Displayed in order, the first one not yet ends the polling
+            const auto kNow = std::chrono::steady_clock::now();
+            while (m_LastDisplayedId < m_LastPresentId)
+            {
+                const uint64_t kId = m_LastDisplayedId + 1;
+                const VkResult kResult =
+                    m_Device.WaitForPresent(m_SwapChain, kId, 0);
+                if (kResult != VK_SUCCESS)
+                    break;
+
+                times.push_back({ kId, kNow });
+                m_LastDisplayedId = kId;
+            }
+            break;
+        }
+        case PresentTiming::None:
+            break;
+        }
+
+        return times;
     }
 
     // =========================================================================
@@ -381,13 +536,37 @@ namespace vkp
 
         //VKP_ASSERT(m_Frames.empty());
 
-        m_Frames.resize(imageCount, Frame{});
-        m_FrameSemaphores.resize(imageCount, FrameSemaphores{});
+        m_Frames.assign(imageCount, Frame{});
+        m_FrameSyncs.assign(m_FramesInFlight, FrameSync{});
 
         for (uint32_t i = 0; i < imageCount; ++i)
             m_Frames[i].backbuffer = backbuffers[i];
     }
 
+    void SwapChain::CreateOffscreenImages(uint32_t width, uint32_t height)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        m_ImageFormat = s_kOffscreenImageFormat;
+        m_Extent = { width, height };
+
+        m_Frames.assign(m_FramesInFlight, Frame{});
+        m_FrameSyncs.assign(m_FramesInFlight, FrameSync{});
+
+        m_OffscreenImages.clear();
+        for (auto& frame : m_Frames)
+        {
+            auto& image = m_OffscreenImages.emplace_back(
+                new Image(m_Device, MemoryTag::Framebuffer)
+            );
+            image->Create(VkExtent3D{ width, height, 1 }, 1, m_ImageFormat,
+                          VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                          VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            frame.backbuffer = *image;
+        }
+    }
+
     void SwapChain::CreateImageViews(
         const VkSurfaceFormatKHR& kSurfaceFormat
     )
@@ -459,44 +638,28 @@ namespace vkp
     }
 
     void SwapChain::CreateSyncObjects()
-    {
-        VKP_ASSERT(m_Frames.size() == m_FrameSemaphores.size());
-
-        CreateFrameFences();
-        CreateFrameSemaphores();
-    }
-
-    void SwapChain::CreateFrameFences()
     {
         VkResult err;
 
-        VkFenceCreateInfo fenceInfo{};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        // Set the fences to start in a signaled state
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-        for (auto& frame : m_Frames)
-        {
-            err = vkCreateFence(m_Device, &fenceInfo, nullptr, 
-                                &frame.fence);
-            VKP_ASSERT_RESULT(err);
-        }
-    }
-
-    void SwapChain::CreateFrameSemaphores()
-    {
-        VkResult err;
         VkSemaphoreCreateInfo semaphoreInfo{};
         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-        for (auto& frameSem : m_FrameSemaphores)
+        // Nothing submitted yet, the values are reached
+        for (auto& sync : m_FrameSyncs)
         {
+            sync.submitValue = 0;
+
             err = vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr,
-                                    &frameSem.imageAcquiredSemaphore);
+                                    &sync.imageAcquiredSemaphore);
             VKP_ASSERT_RESULT(err);
+        }
+
+        for (auto& frame : m_Frames)
+        {
+            frame.submitValue = 0;
 
             err = vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr,
-                                    &frameSem.renderCompleteSemaphore);
+                                    &frame.renderCompleteSemaphore);
             VKP_ASSERT_RESULT(err);
         }
     }
@@ -571,6 +734,17 @@ namespace vkp
     {
         VKP_REGISTER_FUNCTION();
 
+        for (const auto& availablePresentMode : availablePresentModes)
+        {
+            if (availablePresentMode == m_PreferredPresentMode)
+            {
+                VKP_LOG_INFO("Selected Present mode: {}", availablePresentMode);
+                return availablePresentMode;
+            }
+        }
+        VKP_LOG_WARN("Preferred present mode {} is not supported",
+                     m_PreferredPresentMode);
+
         // Check for VK_PRESENT_MODE_MAILBOX_KHR for lowest latency
         static const VkPresentModeKHR kReqPresentModes[] = {
             VK_PRESENT_MODE_MAILBOX_KHR,
@@ -729,48 +903,109 @@ namespace vkp
     {
         VKP_REGISTER_FUNCTION();
 
-        if (m_SwapChain == VK_NULL_HANDLE)
+        // Offscreen frames are of no swap chain
+        if (m_SwapChain == VK_NULL_HANDLE && m_Frames.empty())
             return;
 
         // TODO wait on queue
         m_Device.WaitIdle();
 
-        VKP_ASSERT(m_Frames.size() == m_FrameSemaphores.size());
-        for (uint32_t i = 0; i < m_Frames.size(); ++i)
+        RetireResources();
+        m_Retired.back().swapChain = m_SwapChain;
+        m_SwapChain = VK_NULL_HANDLE;
+
+        ReleaseRetired(true);
+    }
+
+    void SwapChain::RetireResources()
+    {
+        Retired& retired = m_Retired.emplace_back(Retired{
+            .swapChain = VK_NULL_HANDLE,
+            .frames = std::move(m_Frames),
+            .frameSyncs = std::move(m_FrameSyncs),
+            .depthImage = nullptr,
+            .depthImageView = nullptr,
+            .offscreenImages = std::move(m_OffscreenImages),
+            .submitValue = m_LastSubmitValue,
+            .presentCount = m_PresentCount
+        });
+        m_Frames.clear();
+        m_FrameSyncs.clear();
+        m_OffscreenImages.clear();
+
+        // Recreated in place by "CreateDepthResources()"
+        if (m_HasDepthAttachment)
         {
-            DestroyFrame(m_Frames[i]);
-            DestroyFrameSemaphores(m_FrameSemaphores[i]);
+            retired.depthImage = std::make_unique<Image>(
+                std::move(m_DepthImage)
+            );
+            retired.depthImageView = std::make_unique<ImageView>(
+                std::move(m_DepthImageView)
+            );
         }
+    }
 
-        if (m_HasDepthAttachment)
-            DestroyDepthResources();
+    void SwapChain::ReleaseRetired(bool all)
+    {
+        if (m_Retired.empty())
+            return;
 
-        vkDestroySwapchainKHR(m_Device, m_SwapChain, nullptr);
-        m_SwapChain = VK_NULL_HANDLE;
+        const Timeline& kTimeline = m_Device.GetTimeline(QFamily::Graphics);
+
+        // Presented by then, one frame in flight after the last one of them
+        auto isDone = [&](const Retired& kRetired) {
+            return all ||
+                   (kTimeline.IsComplete(kRetired.submitValue) &&
+                    m_PresentCount > kRetired.presentCount + GetFramesInFlight());
+        };
+
+        for (Retired& retired : m_Retired)
+        {
+            if (!isDone(retired))
+                continue;
+
+            for (auto& frame : retired.frames)
+                DestroyFrame(frame);
+            for (auto& sync : retired.frameSyncs)
+                DestroyFrameSync(sync);
+
+            retired.depthImageView.reset();
+            retired.depthImage.reset();
+            // After their views and framebuffers
+            retired.offscreenImages.clear();
+
+            if (retired.swapChain != VK_NULL_HANDLE)
+                vkDestroySwapchainKHR(m_Device, retired.swapChain, nullptr);
+            retired.swapChain = VK_NULL_HANDLE;
+            retired.frames.clear();
+        }
+
+        m_Retired.erase(
+            std::remove_if(m_Retired.begin(), m_Retired.end(),
+                           [](const Retired& kRetired) {
+                               return kRetired.frames.empty() &&
+                                      kRetired.swapChain == VK_NULL_HANDLE;
+                           }),
+            m_Retired.end()
+        );
     }
 
     void SwapChain::DestroyFrame(Frame& frame) const
     {
-        vkDestroyFence(m_Device, frame.fence, nullptr);
-        frame.fence = VK_NULL_HANDLE;
+        vkDestroySemaphore(m_Device, frame.renderCompleteSemaphore, nullptr);
+        frame.renderCompleteSemaphore = VK_NULL_HANDLE;
+        frame.submitValue = 0;
 
         vkDestroyImageView(m_Device, frame.backbufferView, nullptr);
         vkDestroyFramebuffer(m_Device, frame.framebuffer, nullptr);        
     }
 
-    void SwapChain::DestroyFrameSemaphores(FrameSemaphores& fr) const
+    void SwapChain::DestroyFrameSync(FrameSync& sync) const
     {
-        vkDestroySemaphore(m_Device, fr.imageAcquiredSemaphore, nullptr);
-        vkDestroySemaphore(m_Device, fr.renderCompleteSemaphore, nullptr);
+        vkDestroySemaphore(m_Device, sync.imageAcquiredSemaphore, nullptr);
 
-        fr.imageAcquiredSemaphore = VK_NULL_HANDLE;
-        fr.renderCompleteSemaphore = VK_NULL_HANDLE;
-    }
-
-    void SwapChain::DestroyDepthResources()
-    {
-        m_DepthImageView.Destroy();
-        m_DepthImage.Destroy();
+        sync.submitValue = 0;
+        sync.imageAcquiredSemaphore = VK_NULL_HANDLE;
     }
 
 } // namespace vkp
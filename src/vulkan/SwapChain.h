@@ -6,6 +6,7 @@
 #ifndef WATER_SURFACE_RENDERING_VULKAN_SWAPCHAIN_H_
 #define WATER_SURFACE_RENDERING_VULKAN_SWAPCHAIN_H_
 
+#include <chrono>
 #include <vulkan/vulkan.h>
 
 #include "vulkan/PhysicalDevice.h"
@@ -30,22 +31,31 @@ namespace vkp
             std::vector<VkPresentModeKHR>   presentModes;
         };
 
+        // Of each swap chain image
         struct Frame
         {
-            VkFence       fence;
             VkImage       backbuffer;
             VkImageView   backbufferView;
             VkFramebuffer framebuffer;
+            // Waited on by the presentation, reusable once the image is
+            //  acquired again
+            VkSemaphore   renderCompleteSemaphore;
+            // Of the graphics timeline, of the last submission rendering to
+            //  the image
+            uint64_t      submitValue;
         };
 
-        // Each frame has its own set of semaphores
-        //  should be cleaned up when all commands have finished
-        struct FrameSemaphores
+        // Each frame in flight has its own acquire semaphore, its resources
+        //  are reusable once the graphics timeline reaches its submit value
+        struct FrameSync
         {
+            uint64_t    submitValue;
             VkSemaphore imageAcquiredSemaphore;
-            VkSemaphore renderCompleteSemaphore;
         };
 
+        static constexpr uint32_t s_kDefaultFramesInFlight{ 2 };
+        static constexpr uint32_t s_kMaxFramesInFlight{ 8 };
+
         /** 
          * @brief Required extensions that must be supported by a physical
          *  device 
@@ -81,6 +91,55 @@ namespace vkp
                   const Surface& surface);
         ~SwapChain();
 
+        /**
+         * @brief Number of frames recorded and submitted while the previous
+         *  ones are still executing, independent of the image count, clamped
+         *  to [1, s_kMaxFramesInFlight]. Takes effect on the next "Create()"
+         */
+        void SetFramesInFlight(uint32_t count);
+
+        /**
+         * @brief Present mode to use if the surface supports it, otherwise
+         *  the first supported of MAILBOX, IMMEDIATE, FIFO. Takes effect on
+         *  the next "Create()"
+         */
+        void SetPreferredPresentMode(VkPresentModeKHR presentMode) {
+            m_PreferredPresentMode = presentMode;
+        }
+
+        /**
+         * @brief Renders into an image of each frame in flight, instead of
+         *  the swap chain's, nothing is acquired nor presented, e.g., for
+         *  benchmarking. The images end up in s_kOffscreenImageLayout, of
+         *  the extent passed to "Create()". Takes effect on the next
+         *  "Create()"
+         */
+        void SetOffscreen(bool offscreen) { m_IsOffscreen = offscreen; }
+        bool IsOffscreen() const { return m_IsOffscreen; }
+
+        static constexpr VkFormat s_kOffscreenImageFormat{
+            VK_FORMAT_B8G8R8A8_UNORM
+        };
+        static constexpr VkImageLayout s_kOffscreenImageLayout{
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+        };
+
+        /** @brief How the times the presents are displayed are obtained */
+        enum class PresentTiming
+        {
+            None = 0,
+            PresentWait,    ///< Polled by VK_KHR_present_wait, once a frame
+            DisplayTiming,  ///< Reported by VK_GOOGLE_display_timing
+        };
+
+        struct PresentTime
+        {
+            uint64_t presentId;
+            // Of VK_GOOGLE_display_timing, its CLOCK_MONOTONIC, otherwise
+            //  when polled, no earlier than displayed
+            std::chrono::steady_clock::time_point time;
+        };
+
         // ---------------------------------------------------------------------
         // Setup
         //  ... Destroy frame-related resources (*renderpass, pipeline, ...)
@@ -89,10 +148,13 @@ namespace vkp
         //  3. Create swap chain framebuffers using renderpass
 
         /** 
-         * @brief Creates (Recreates) the swap chain with new dimensions
+         * @brief Creates (Recreates) the swap chain with new dimensions, from
+         *  the old one, without waiting for the device. The old images,
+         *  framebuffers and semaphores are destroyed once the frames in flight
+         *  that used them are done
          * @param depthAttachment To create depth attachment for depth testing
-         * @pre Destroyed: renderPass, pipeline, buffers, ... anything that
-         *  depends on imageCount
+         * @pre Destroyed: anything that depends on imageCount, the frame
+         *  resources of each frame in flight are reused
          */
         void Create(uint32_t width,
                     uint32_t height,
@@ -111,25 +173,68 @@ namespace vkp
         // Drawing
 
         /**
+         * @brief Waits for the previous submission of the current frame in
+         *  flight, acquires an image, and waits for any other frame in flight
+         *  still rendering to it
          * @param imageIndex Aquired image index if successfully acquired
          * @return Result of the 'vkAcquireNextImageKHR'
          */
         VkResult AcquireNextImage(uint32_t* imageIndex);
 
         /**
+         * @brief Submitted through the graphics timeline, as all frames
          * @param waitStages Destination stages to wait on
          * @param cmdBuffers Command buffers to execute
          */
         void DrawFrame(const std::vector<VkPipelineStageFlags>& waitStages,
                        const std::vector<VkCommandBuffer>& cmdBuffers);
 
+        /**
+         * @param kWaitSemaphores Semaphores to wait on, besides the acquired
+         *  image, which is waited on last
+         * @param kWaitStages Destination stages of each of the semaphores,
+         *  the one of the acquired image last
+         * @param commandBuffers Command buffers to execute
+         * @param kSignalSemaphores Semaphores to signal, besides the render
+         *  complete one
+         * @param kWaitValues Of the wait semaphores that are timelines,
+         *  @see Timeline::Submit()
+         */
         void SubmitFrame(std::vector<VkSemaphore> kWaitSemaphores,
                          const std::vector<VkPipelineStageFlags>& kWaitStages,
                          const std::vector<VkCommandBuffer>& commandBuffers,
-                         std::vector<VkSemaphore> kSignalSemaphores);
+                         std::vector<VkSemaphore> kSignalSemaphores,
+                         const std::vector<uint64_t>& kWaitValues = {});
 
+        /**
+         * @brief Also advances to the next frame in flight. Of a present
+         *  timing, the present is given the next id, @see GetLastPresentId()
+         */
         void PresentFrame();
 
+        /** @return Of the device's extensions, none if offscreen */
+        PresentTiming GetPresentTiming() const;
+
+        /**
+         * @return Id of the last "PresentFrame()", increasing over the swap
+         *  chains, 0 if none, or without a present timing
+         */
+        uint64_t GetLastPresentId() const { return m_LastPresentId; }
+
+        /**
+         * @return Times of the presents of the current swap chain displayed
+         *  since the last call, in the order of their ids. Those presented
+         *  to a replaced swap chain are never returned
+         */
+        std::vector<PresentTime> PollPresentTimes();
+
+        /**
+         * @return In milliseconds, of the last "AcquireNextImage()", how long
+         *  the host waited for the previous submissions of the frame in
+         *  flight, and of the image, e.g., of a GPU-bound frame
+         */
+        float GetFrameWaitTime() const { return m_FrameWaitTime; }
+
         // ---------------------------------------------------------------------
 
         VkFramebuffer GetFramebuffer(uint32_t index) const
@@ -137,6 +242,11 @@ namespace vkp
             VKP_ASSERT(index < m_Frames.size());
             return m_Frames[index].framebuffer;
         }
+        VkImage GetImage(uint32_t index) const
+        {
+            VKP_ASSERT(index < m_Frames.size());
+            return m_Frames[index].backbuffer;
+        }
 
         VkSurfaceKHR GetSurface() const { return m_Surface; }
         VkFormat GetImageFormat() const { return m_ImageFormat; }
@@ -147,11 +257,27 @@ namespace vkp
             return static_cast<uint32_t>(m_Frames.size());
         }
 
+        /** @return Count of the per-frame resources, as of the last "Create()" */
+        uint32_t GetFramesInFlight() const {
+            return static_cast<uint32_t>(m_FrameSyncs.size());
+        }
+        /** @return Of the frame in flight being recorded, indexes its resources */
+        uint32_t GetFrameIndex() const { return m_CurrentFrame; }
+        /**
+         * @return Of the graphics timeline, of the last submitted frame,
+         *  e.g., resources it used are free once reached
+         */
+        uint64_t GetLastSubmitValue() const { return m_LastSubmitValue; }
+
+        VkPresentModeKHR GetPresentMode() const { return m_PresentMode; }
+
         bool HasDepthAttachment() const { return m_HasDepthAttachment; }
 
         VkFormat GetDepthAttachmentFormat() const {
             return m_DepthImage.GetFormat();
         }
+        /** @return Of the depth attachment, recreated by "Create()" */
+        VkImageView GetDepthImageView() const { return m_DepthImageView; }
 
     private:
         void CreateSwapChain(
@@ -160,12 +286,21 @@ namespace vkp
             uint32_t width, uint32_t height);
 
         void RetrieveAllocateImageHandles();
+        /** @brief One image of each frame in flight, instead of the swap chain */
+        void CreateOffscreenImages(uint32_t width, uint32_t height);
         void CreateImageViews(const VkSurfaceFormatKHR& kSurfaceFormat);
         void CreateSyncObjects();
-        void CreateFrameFences();
-        void CreateFrameSemaphores();
         void CreateDepthResources();
 
+        /** @brief Of the current frame in flight, to the acquired image */
+        void SubmitToTimeline(const VkSubmitInfo& submitInfo,
+                              const std::vector<uint64_t>& waitValues);
+
+        /** @brief Moves the resources of the current swap chain to retire */
+        void RetireResources();
+        /** @brief Destroys the retired resources no longer in use */
+        void ReleaseRetired(bool all);
+
         static constexpr VkFormat s_kRequestedSurfaceImageFormats[] = {
             VK_FORMAT_B8G8R8A8_UNORM,
             VK_FORMAT_R8G8B8A8_UNORM,
@@ -201,8 +336,7 @@ namespace vkp
 
         void Destroy();
         void DestroyFrame(Frame& frame) const;
-        void DestroyFrameSemaphores(FrameSemaphores& fr) const;
-        void DestroyDepthResources();
+        void DestroyFrameSync(FrameSync& sync) const;
 
     private:
         const Device& m_Device;
@@ -226,7 +360,30 @@ namespace vkp
 
         // Size of frames is imageCount
         std::vector<Frame> m_Frames;
-        std::vector<FrameSemaphores> m_FrameSemaphores;
+        // Size is the frames in flight
+        std::vector<FrameSync> m_FrameSyncs;
+
+        bool m_IsOffscreen{ false };
+        // Of the frames, if offscreen
+        std::vector<std::unique_ptr<Image>> m_OffscreenImages;
+
+        // Of a replaced swap chain, still read by the frames in flight, or
+        //  the presentation
+        struct Retired
+        {
+            VkSwapchainKHR swapChain;
+            std::vector<Frame> frames;
+            std::vector<FrameSync> frameSyncs;
+            std::unique_ptr<Image> depthImage;
+            std::unique_ptr<ImageView> depthImageView;
+            std::vector<std::unique_ptr<Image>> offscreenImages;
+            // Of the graphics timeline, of the last frame using them
+            uint64_t submitValue;
+            // Of m_PresentCount when retired, the presentation is done
+            //  a frame in flight later
+            uint64_t presentCount;
+        };
+        std::vector<Retired> m_Retired;
 
         // ---------------------------------------------------------------------
         // Rendering
@@ -235,10 +392,22 @@ namespace vkp
         static const int MIN_FRAMES_IN_FLIGHT = 2;
 
         uint32_t m_MinImageCount{ MIN_FRAMES_IN_FLIGHT };  // TODO needed?
-        uint32_t m_FrameIndex    { 0 };
-        uint32_t m_SemaphoreIndex{ 0 };
+        uint32_t m_ImageIndex   { 0 };   ///< Of the acquired image
+
+        uint32_t m_FramesInFlight{ s_kDefaultFramesInFlight };
+        uint32_t m_CurrentFrame { 0 };   ///< Goes conseq. from 0, to framesInFlight
+        uint64_t m_LastSubmitValue{ 0 };
+        uint64_t m_PresentCount{ 0 };
+
+        // Of the present timing, ids of the last present, and of the last
+        //  one displayed of the current swap chain
+        uint64_t m_LastPresentId{ 0 };
+        uint64_t m_LastDisplayedId{ 0 };
+
+        float m_FrameWaitTime{ 0.0f };
 
-        uint32_t m_CurrentFrame { 0 };   ///< Goes conseq. from 0, to imageCount
+        VkPresentModeKHR m_PreferredPresentMode{ VK_PRESENT_MODE_MAILBOX_KHR };
+        VkPresentModeKHR m_PresentMode{ VK_PRESENT_MODE_FIFO_KHR };
 
         // ---------------------------------------------------------------------
         // Depth attachment
@@ -15,9 +15,9 @@
 namespace vkp
 {
 
-    Texture2D::Texture2D(const Device& device)
+    Texture2D::Texture2D(const Device& device, MemoryTag tag)
         : m_Device(device),
-          m_Image(device),
+          m_Image(device, tag),
           m_ImageView(device),
           m_Sampler(device),
           m_SamplerInfo(Sampler::InitSamplerInfo()),
@@ -194,6 +194,53 @@ namespace vkp
         }
     }
 
+    void Texture2D::CopyFromBufferAndRelease(VkCommandBuffer cmdBuffer,
+                                             VkBuffer buffer,
+                                             uint32_t bufferOffset,
+                                             uint32_t srcQueueFamily,
+                                             uint32_t dstQueueFamily)
+    {
+        VKP_ASSERT_MSG(m_MipLevels == 1,
+                       "Mipmaps are not generated on a released image");
+
+        // Discarded contents need no ownership acquire by this family
+        m_Image.SetLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+        m_Image.TransitionLayout_UNDEFtoDST_OPTIMAL(cmdBuffer);
+
+        CopyBufferToImage(cmdBuffer, buffer, bufferOffset);
+
+        // Release, the destination scope is ignored, the layout transition
+        //  is repeated exactly by the acquire
+        m_Image.RecordImageBarrier(
+            cmdBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            VK_ACCESS_TRANSFER_WRITE_BIT, 0,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            srcQueueFamily, dstQueueFamily
+        );
+    }
+
+    void Texture2D::AcquireFromQueueFamily(VkCommandBuffer cmdBuffer,
+                                           uint32_t srcQueueFamily,
+                                           uint32_t dstQueueFamily,
+                                           VkPipelineStageFlags dstStage,
+                                           VkAccessFlags dstAccessMask)
+    {
+        VKP_ASSERT(m_Image.GetLayout() == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+        // Source scope is ignored, the transition waits for the semaphore
+        //  wait operation at 'dstStage'
+        m_Image.RecordImageBarrier(
+            cmdBuffer,
+            dstStage, dstStage,
+            0, dstAccessMask,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            srcQueueFamily, dstQueueFamily
+        );
+
+        m_Image.SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
     void Texture2D::CopyBufferToImage(VkCommandBuffer cmdBuffer,
         VkBuffer buffer, uint32_t offset)
     {
@@ -51,8 +51,9 @@ namespace vkp
          * @brief Sets up the texture resources for subsequent creation with the
          *  'Create' call. 
          * @param device Created logical device
+         * @param tag Subsystem the image's memory is accounted to
          */
-        Texture2D(const Device& device);
+        Texture2D(const Device& device, MemoryTag tag = MemoryTag::Other);
         ~Texture2D(); 
 
         /**
@@ -113,6 +114,34 @@ namespace vkp
                             VkAccessFlags dstAccessMask =
                                 VK_ACCESS_SHADER_READ_BIT);
 
+        /**
+         * @brief Copies contents of the buffer to the Image on a queue of
+         *  another family than the one reading it, e.g., a dedicated transfer
+         *  queue. Previous contents are discarded. The image is released to
+         *  'dstQueueFamily' in LAYOUT_SHADER_READ, not usable until acquired
+         *  by "AcquireFromQueueFamily()"
+         * @param cmdBuffer Command buffer of 'srcQueueFamily' in recording state
+         * @pre Created without mipmaps
+         */
+        void CopyFromBufferAndRelease(VkCommandBuffer cmdBuffer,
+                                      VkBuffer buffer,
+                                      uint32_t bufferOffset,
+                                      uint32_t srcQueueFamily,
+                                      uint32_t dstQueueFamily);
+
+        /**
+         * @brief Acquires the image released by "CopyFromBufferAndRelease()"
+         * @param cmdBuffer Command buffer of 'dstQueueFamily' in recording
+         *  state, its submission waits for the release, at 'dstStage'
+         */
+        void AcquireFromQueueFamily(VkCommandBuffer cmdBuffer,
+                                    uint32_t srcQueueFamily,
+                                    uint32_t dstQueueFamily,
+                                    VkPipelineStageFlags dstStage = 
+                                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                    VkAccessFlags dstAccessMask =
+                                        VK_ACCESS_SHADER_READ_BIT);
+
         /**
          * @brief Creates a 2D RGBA texture with pixels loaded from a file, 
          *  Uses staging buffer to copy the image data from host to the
@@ -0,0 +1,115 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "vulkan/Texture2DArray.h"
+
+
+namespace vkp
+{
+
+    Texture2DArray::Texture2DArray(const Device& device, MemoryTag tag)
+        : m_Device(device),
+          m_Image(device, tag),
+          m_ImageView(device),
+          m_Sampler(device)
+    {
+        VKP_REGISTER_FUNCTION();
+        VKP_ASSERT(device != VK_NULL_HANDLE);
+    }
+
+    Texture2DArray::~Texture2DArray()
+    {
+        VKP_REGISTER_FUNCTION();
+    }
+
+    void Texture2DArray::Create(VkCommandBuffer cmdBuffer,
+        uint32_t width, uint32_t height, uint32_t layerCount, VkFormat format)
+    {
+        VKP_REGISTER_FUNCTION();
+        VKP_ASSERT(layerCount > 0);
+
+        const VkPhysicalDeviceLimits& kLimits =
+            m_Device.GetPhysicalDevice().GetProperties().limits;
+        VKP_ASSERT_MSG(layerCount <= kLimits.maxImageArrayLayers,
+                       "Device does not support {} image array layers",
+                       layerCount);
+
+        m_Width = width;
+        m_Height = height;
+
+        m_Image.Create(VkExtent3D{m_Width, m_Height, 1},
+                       1,
+                       format,
+                       VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                           VK_IMAGE_USAGE_SAMPLED_BIT,
+                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                       VK_IMAGE_TILING_OPTIMAL,
+                       VK_SAMPLE_COUNT_1_BIT,
+                       layerCount);
+
+        m_Image.TransitionLayout_UNDEFtoDST_OPTIMAL(cmdBuffer);
+
+        m_ImageView.Create(m_Image, format,
+                           VK_IMAGE_ASPECT_COLOR_BIT,
+                           VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+                           1, 0, layerCount, 0);
+
+        // Not reallocated, the views are not copyable
+        m_LayerViews.clear();
+        m_LayerViews.reserve(layerCount);
+        for (uint32_t i = 0; i < layerCount; ++i)
+        {
+            m_LayerViews.emplace_back(m_Device);
+            m_LayerViews.back().Create(m_Image, format,
+                                       VK_IMAGE_ASPECT_COLOR_BIT,
+                                       VK_IMAGE_VIEW_TYPE_2D,
+                                       1, 0, 1, i);
+        }
+
+        // Repeated and filtered as the maps of a single layer
+        m_Sampler.Create(Sampler::InitSamplerInfo());
+    }
+
+    void Texture2DArray::CopyFromBuffer(VkCommandBuffer cmdBuffer,
+                                        VkBuffer buffer,
+                                        VkDeviceSize bufferOffset,
+                                        VkDeviceSize layerStride,
+                                        VkPipelineStageFlags dstStage)
+    {
+        // Of a previous copy, after the reads at 'dstStage'
+        m_Image.TransitionLayoutToDST_OPTIMAL(cmdBuffer, dstStage);
+
+        std::vector<VkBufferImageCopy> regions(GetLayerCount());
+        for (uint32_t i = 0; i < regions.size(); ++i)
+        {
+            regions[i] = VkBufferImageCopy{
+                .bufferOffset = bufferOffset + layerStride * i,
+                // Tightly packed data
+                .bufferRowLength = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = 0,
+                    .baseArrayLayer = i,
+                    .layerCount = 1,
+                },
+                .imageOffset = { 0, 0, 0 },
+                .imageExtent = { m_Width, m_Height, 1 }
+            };
+        }
+
+        vkCmdCopyBufferToImage(
+            cmdBuffer,
+            buffer,
+            m_Image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(regions.size()), regions.data()
+        );
+
+        m_Image.TransitionLayout_DST_OPTIMALtoSHADER_READ(cmdBuffer, dstStage);
+    }
+
+} // namespace vkp
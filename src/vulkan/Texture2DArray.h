@@ -0,0 +1,101 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_VULKAN_TEXTURE2DARRAY_H_
+#define WATER_SURFACE_RENDERING_VULKAN_TEXTURE2DARRAY_H_
+
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "vulkan/Device.h"
+#include "vulkan/Image.h"
+#include "vulkan/ImageView.h"
+#include "vulkan/Sampler.h"
+
+
+namespace vkp
+{
+    /**
+     * @brief Layers of 2D images of the same size and format, without
+     *  mipmaps. Each layer is also viewed as a 2D texture, so that it is
+     *  bound where a "Texture2D" is, of the same shaders
+     */
+    class Texture2DArray
+    {
+    public:
+        /**
+         * @param device Created logical device
+         * @param tag Subsystem the image's memory is accounted to
+         */
+        Texture2DArray(const Device& device, MemoryTag tag = MemoryTag::Other);
+        ~Texture2DArray();
+
+        Texture2DArray(const Texture2DArray&) = delete;
+        Texture2DArray& operator=(const Texture2DArray&) = delete;
+
+        /**
+         * @brief Creates a device local texture of 'layerCount' layers, in a
+         *  state that is ready for transfer
+         * @param cmdBuffer Command buffer in recording state, for image
+         *  layout transition to DST_OPTIMAL
+         */
+        void Create(VkCommandBuffer cmdBuffer,
+                    uint32_t width,
+                    uint32_t height,
+                    uint32_t layerCount,
+                    VkFormat format);
+
+        /**
+         * @brief Copies all the layers from the buffer, the first one at
+         *  'bufferOffset', each next one 'layerStride' bytes further, then
+         *  transitions the layout from DST_OPTIMAL to SHADER_READ. Copied
+         *  again, the layout is transitioned back to DST_OPTIMAL first
+         * @param cmdBuffer Command buffer in recording state
+         */
+        void CopyFromBuffer(VkCommandBuffer cmdBuffer,
+                            VkBuffer buffer,
+                            VkDeviceSize bufferOffset,
+                            VkDeviceSize layerStride,
+                            VkPipelineStageFlags dstStage =
+                                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        uint32_t GetWidth() const { return m_Width; }
+        uint32_t GetHeight() const { return m_Height; }
+        uint32_t GetLayerCount() const { return m_Image.GetArrayLayerCount(); }
+
+        /** @return Of the whole array, of a "sampler2DArray" */
+        VkDescriptorImageInfo GetDescriptor() const {
+            return VkDescriptorImageInfo {
+                .sampler = m_Sampler,
+                .imageView = m_ImageView,
+                .imageLayout = m_Image.GetLayout()
+            };
+        }
+
+        /** @return Of a single layer, of a "sampler2D" */
+        VkDescriptorImageInfo GetLayerDescriptor(uint32_t layer) const {
+            return VkDescriptorImageInfo {
+                .sampler = m_Sampler,
+                .imageView = m_LayerViews[layer],
+                .imageLayout = m_Image.GetLayout()
+            };
+        }
+
+    private:
+        const Device& m_Device;
+
+        uint32_t m_Width { 0 };
+        uint32_t m_Height{ 0 };
+
+        Image     m_Image;
+        ImageView m_ImageView;
+        std::vector<ImageView> m_LayerViews;
+        Sampler   m_Sampler;
+    };
+
+} // namespace vkp
+
+
+#endif // WATER_SURFACE_RENDERING_VULKAN_TEXTURE2DARRAY_H_
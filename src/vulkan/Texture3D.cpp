@@ -14,9 +14,9 @@
 namespace vkp
 {
 
-    Texture3D::Texture3D(const Device& device)
+    Texture3D::Texture3D(const Device& device, MemoryTag tag)
         : m_Device(device),
-          m_Image(device),
+          m_Image(device, tag),
           m_ImageView(device),
           m_Sampler(device),
           m_SamplerInfo(Sampler::InitSamplerInfo())
@@ -30,8 +30,9 @@ namespace vkp
          * @brief Sets up the texture resources for subsequent creation with the
          *  'Create' call. 
          * @param device Created logical device
+         * @param tag Subsystem the image's memory is accounted to
          */
-        Texture3D(const Device& device);
+        Texture3D(const Device& device, MemoryTag tag = MemoryTag::Other);
         ~Texture3D(); 
 
         /**
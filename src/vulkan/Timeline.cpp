@@ -0,0 +1,199 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "vulkan/Timeline.h"
+#include "vulkan/Device.h"
+
+
+namespace vkp
+{
+    Timeline::Timeline(const Device& device, QFamily qFamily)
+        : m_Device(device), m_QFamily(qFamily)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        if (!m_Device.SupportsTimelineSemaphores())
+            return;
+
+        VkSemaphoreTypeCreateInfoKHR typeInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+            .initialValue = 0
+        };
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &typeInfo;
+
+        auto err = vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr,
+                                     &m_Semaphore);
+        VKP_ASSERT_RESULT(err);
+    }
+
+    Timeline::~Timeline()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        // Fences and the semaphore may still be signaled
+        WaitIdle();
+
+        vkDestroySemaphore(m_Device, m_Semaphore, nullptr);
+
+        for (const PendingFence& kPending : m_PendingFences)
+            vkDestroyFence(m_Device, kPending.fence, nullptr);
+        for (VkFence fence : m_FreeFences)
+            vkDestroyFence(m_Device, fence, nullptr);
+    }
+
+    uint64_t Timeline::Submit(
+        VkSubmitInfo submitInfo,
+        const std::vector<uint64_t>& waitValues)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        const uint64_t kValue = m_LastValue + 1;
+        VkFence fence = VK_NULL_HANDLE;
+
+        // Arrays of the values must outlive the submission
+        std::vector<uint64_t> allWaitValues;
+        std::vector<VkSemaphore> signalSemaphores;
+        std::vector<uint64_t> signalValues;
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+
+        if (IsSemaphore())
+        {
+            allWaitValues.assign(submitInfo.waitSemaphoreCount, 0);
+            std::copy_n(waitValues.begin(),
+                        std::min<size_t>(waitValues.size(),
+                                         allWaitValues.size()),
+                        allWaitValues.begin());
+
+            signalSemaphores.assign(
+                submitInfo.pSignalSemaphores,
+                submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount
+            );
+            signalSemaphores.push_back(m_Semaphore);
+            signalValues.assign(signalSemaphores.size(), 0);
+            signalValues.back() = kValue;
+
+            timelineInfo.sType =
+                VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+            timelineInfo.pNext = submitInfo.pNext;
+            timelineInfo.waitSemaphoreValueCount =
+                static_cast<uint32_t>(allWaitValues.size());
+            timelineInfo.pWaitSemaphoreValues = allWaitValues.data();
+            timelineInfo.signalSemaphoreValueCount =
+                static_cast<uint32_t>(signalValues.size());
+            timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+            submitInfo.pNext = &timelineInfo;
+            submitInfo.signalSemaphoreCount =
+                static_cast<uint32_t>(signalSemaphores.size());
+            submitInfo.pSignalSemaphores = signalSemaphores.data();
+        }
+        else
+        {
+            fence = AcquireFence();
+        }
+
+        auto err = m_Device.QueueSubmit(m_QFamily, { submitInfo }, fence);
+        VKP_ASSERT_RESULT_MSG(err, "Failed to submit to the timeline's queue");
+
+        if (fence != VK_NULL_HANDLE)
+            m_PendingFences.push_back({ kValue, fence });
+
+        m_LastValue = kValue;
+        return kValue;
+    }
+
+    uint64_t Timeline::GetLastValue() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_LastValue;
+    }
+
+    uint64_t Timeline::GetCompletedValue() const
+    {
+        if (IsSemaphore())
+            return m_Device.GetSemaphoreCounterValue(m_Semaphore);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        RetireFences();
+        return m_CompletedValue;
+    }
+
+    void Timeline::Wait(uint64_t value) const
+    {
+        if (IsSemaphore())
+        {
+            if (value == 0)
+                return;
+
+            auto err = m_Device.WaitSemaphore(m_Semaphore, value);
+            VKP_ASSERT_RESULT(err);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        VKP_ASSERT(value <= m_LastValue);
+
+        RetireFences();
+        if (value <= m_CompletedValue)
+            return;
+
+        // Each pending value has its own fence, in ascending order
+        const PendingFence& kPending =
+            m_PendingFences[value - m_PendingFences.front().value];
+        VKP_ASSERT(kPending.value == value);
+
+        auto err = vkWaitForFences(m_Device, 1, &kPending.fence, VK_TRUE,
+                                   UINT64_MAX);
+        VKP_ASSERT_RESULT(err);
+
+        RetireFences();
+    }
+
+    VkFence Timeline::AcquireFence()
+    {
+        RetireFences();
+
+        if (!m_FreeFences.empty())
+        {
+            VkFence fence = m_FreeFences.back();
+            m_FreeFences.pop_back();
+            return fence;
+        }
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        VkFence fence;
+        auto err = vkCreateFence(m_Device, &fenceInfo, nullptr, &fence);
+        VKP_ASSERT_RESULT(err);
+
+        return fence;
+    }
+
+    void Timeline::RetireFences() const
+    {
+        // Submissions to a queue complete in order
+        while (!m_PendingFences.empty())
+        {
+            const PendingFence kPending = m_PendingFences.front();
+            if (vkGetFenceStatus(m_Device, kPending.fence) != VK_SUCCESS)
+                break;
+
+            auto err = vkResetFences(m_Device, 1, &kPending.fence);
+            VKP_ASSERT_RESULT(err);
+
+            m_CompletedValue = kPending.value;
+            m_FreeFences.push_back(kPending.fence);
+            m_PendingFences.pop_front();
+        }
+    }
+
+} // namespace vkp
@@ -0,0 +1,100 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_VULKAN_TIMELINE_H_
+#define WATER_SURFACE_RENDERING_VULKAN_TIMELINE_H_
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "vulkan/QueueTypes.h"
+
+
+namespace vkp
+{
+    class Device;
+
+    /**
+     * @brief Progress of the submissions to the queue of a queue family: each
+     *  submission through "Submit()" signals the next value, so that a single
+     *  value tells which of them are done, e.g., a frame, an upload, or
+     *  the last use of a resource to release.
+     *
+     * Of a timeline semaphore, if the device "SupportsTimelineSemaphores()",
+     *  which the submissions to the other queues can wait on at a value.
+     *  Otherwise a fence is signaled by each submission, recycled once done,
+     *  for the host only.
+     */
+    class Timeline
+    {
+    public:
+        Timeline(const Device& device, QFamily qFamily);
+        ~Timeline();
+
+        /** @return Null without the timeline semaphores */
+        operator VkSemaphore() const { return m_Semaphore; }
+        bool IsSemaphore() const { return m_Semaphore != VK_NULL_HANDLE; }
+
+        /**
+         * @brief Submits to the queue, signaling the next value, besides
+         *  the semaphores of the submit info
+         * @param waitValues Of each of the wait semaphores of the submit
+         *  info, binary ones ignore theirs, the missing are zero
+         * @return Value signaled once the submission is done
+         */
+        uint64_t Submit(VkSubmitInfo submitInfo,
+                        const std::vector<uint64_t>& waitValues = {});
+
+        /** @return Of the last submission, zero before any */
+        uint64_t GetLastValue() const;
+
+        /** @return Highest value of the finished submissions */
+        uint64_t GetCompletedValue() const;
+
+        bool IsComplete(uint64_t value) const {
+            return value <= GetCompletedValue();
+        }
+
+        /** @brief Blocks until the submission of the value is done */
+        void Wait(uint64_t value) const;
+
+        /** @brief Blocks until all the submissions are done */
+        void WaitIdle() const { Wait(GetLastValue()); }
+
+        Timeline(const Timeline&) = delete;
+        Timeline& operator=(const Timeline&) = delete;
+
+    private:
+        // Of the fallback, signaled by the submission of the value
+        struct PendingFence
+        {
+            uint64_t value;
+            VkFence  fence;
+        };
+
+        VkFence AcquireFence();
+        /** @brief Recycles the signaled fences, in the order of the values */
+        void RetireFences() const;
+
+    private:
+        const Device& m_Device;
+        const QFamily m_QFamily;
+
+        VkSemaphore m_Semaphore{ VK_NULL_HANDLE };
+
+        // Values follow the order of the submissions to the queue
+        mutable std::mutex m_Mutex;
+        uint64_t m_LastValue{ 0 };
+
+        mutable uint64_t m_CompletedValue{ 0 };
+        mutable std::deque<PendingFence> m_PendingFences;
+        mutable std::vector<VkFence> m_FreeFences;
+    };
+
+} // namespace vkp
+
+#endif // WATER_SURFACE_RENDERING_VULKAN_TIMELINE_H_
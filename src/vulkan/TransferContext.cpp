@@ -0,0 +1,108 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "pch.h"
+#include "vulkan/TransferContext.h"
+
+
+namespace vkp
+{
+    TransferContext::TransferContext(const Device& device, QFamily qFamily)
+        : m_Timeline(device.GetTimeline(qFamily)),
+          m_CommandPool(device, qFamily,
+                        VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |  // short-lived
+                        VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
+    {
+        VKP_REGISTER_FUNCTION();
+
+        // Never reallocated, the references to the buffers stay valid
+        m_CommandPool.AllocateCommandBuffers(s_kBufferCount);
+        m_Batch.reserve(s_kBufferCount);
+    }
+
+    TransferContext::~TransferContext()
+    {
+        VKP_REGISTER_FUNCTION();
+
+        Flush();
+        m_Timeline.Wait(m_LastFlushValue);
+    }
+
+    CommandBuffer& TransferContext::Begin()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        const uint32_t kIndex = m_NextSlot;
+        Slot& slot = m_Slots[kIndex];
+
+        // Every buffer of the ring is recorded, the batch is submitted
+        if (slot.inUse)
+        {
+            VKP_ASSERT_MSG(std::find(m_Batch.begin(), m_Batch.end(), kIndex) !=
+                           m_Batch.end(),
+                           "Transfer command buffer still recording");
+            FlushBatch();
+        }
+
+        // Submitted in the order of the ring, the oldest one
+        m_Timeline.Wait(slot.submitValue);
+
+        slot.inUse = true;
+        m_NextSlot = (m_NextSlot + 1) % s_kBufferCount;
+
+        // Implicitly reset, by the flag of the pool
+        CommandBuffer& cmdBuffer = m_CommandPool[kIndex];
+        cmdBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        return cmdBuffer;
+    }
+
+    void TransferContext::End(CommandBuffer& cmdBuffer)
+    {
+        cmdBuffer.End();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        const auto kIndex = static_cast<uint32_t>(&cmdBuffer - &m_CommandPool[0]);
+        VKP_ASSERT(kIndex < s_kBufferCount && m_Slots[kIndex].inUse);
+
+        m_Batch.push_back(kIndex);
+    }
+
+    uint64_t TransferContext::Flush()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return FlushBatch();
+    }
+
+    uint64_t TransferContext::FlushBatch()
+    {
+        if (m_Batch.empty())
+            return m_LastFlushValue;
+
+        std::vector<VkCommandBuffer> cmdBuffers;
+        cmdBuffers.reserve(m_Batch.size());
+        for (uint32_t index : m_Batch)
+            cmdBuffers.push_back(m_CommandPool[index]);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = static_cast<uint32_t>(cmdBuffers.size());
+        submitInfo.pCommandBuffers = cmdBuffers.data();
+
+        // Timeline of the queue is shared, e.g., with the frames
+        m_LastFlushValue = m_Timeline.Submit(submitInfo);
+
+        for (uint32_t index : m_Batch)
+        {
+            m_Slots[index].submitValue = m_LastFlushValue;
+            m_Slots[index].inUse = false;
+        }
+        m_Batch.clear();
+
+        return m_LastFlushValue;
+    }
+
+} // namespace vkp
@@ -0,0 +1,95 @@
+/**
+ *  Copyright (c) 2022 WaterSurfaceRendering authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef WATER_SURFACE_RENDERING_VULKAN_TRANSFER_CONTEXT_H_
+#define WATER_SURFACE_RENDERING_VULKAN_TRANSFER_CONTEXT_H_
+
+#include <array>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "vulkan/Device.h"
+#include "vulkan/CommandPool.h"
+
+
+namespace vkp
+{
+    /**
+     * @brief One-time commands of the uploads, e.g., of the meshes, maps,
+     *  fonts, recorded into a ring of command buffers allocated once, each
+     *  reused once its submission is done, by the timeline of the queue.
+     *
+     * Recorded buffers are batched, submitted together by "Flush()", which
+     *  returns the value of the timeline to wait for, or to poll.
+     */
+    class TransferContext
+    {
+    public:
+        static constexpr uint32_t s_kBufferCount{ 8 };
+
+        TransferContext(const Device& device, QFamily qFamily);
+        ~TransferContext();
+
+        /**
+         * @brief Begins the recording of the next buffer of the ring, as
+         *  a "one time submit buffer". Waits for its previous submission, if
+         *  not yet done, flushes the batch if it is still in it
+         * @return Command buffer in a recording state
+         */
+        CommandBuffer& Begin();
+
+        /**
+         * @brief Ends the recording, the buffer is submitted by the next
+         *  "Flush()"
+         * @param cmdBuffer Of "Begin()", in recording state
+         */
+        void End(CommandBuffer& cmdBuffer);
+
+        /**
+         * @brief Submits the batched buffers to the queue, in one submission
+         * @return Value of the timeline reached once they are done, of
+         *  the last flush if none is batched
+         */
+        uint64_t Flush();
+
+        bool IsComplete(uint64_t value) const {
+            return m_Timeline.IsComplete(value);
+        }
+        /** @brief Host waits for the transfers of the value, not for any other
+         *  work of the queue */
+        void Wait(uint64_t value) const { m_Timeline.Wait(value); }
+
+        QFamily GetAssignedQueueFamily() const {
+            return m_CommandPool.GetAssignedQueueFamily();
+        }
+
+    private:
+        struct Slot
+        {
+            // Of the timeline, of its last submission
+            uint64_t submitValue{ 0 };
+            // Begun and not yet submitted
+            bool inUse{ false };
+        };
+
+        uint64_t FlushBatch();
+
+    private:
+        Timeline& m_Timeline;
+        CommandPool m_CommandPool;
+
+        std::mutex m_Mutex;
+        std::array<Slot, s_kBufferCount> m_Slots;
+        // Next of the ring, the oldest submitted
+        uint32_t m_NextSlot{ 0 };
+
+        std::vector<uint32_t> m_Batch;
+        uint64_t m_LastFlushValue{ 0 };
+    };
+
+} // namespace vkp
+
+#endif // WATER_SURFACE_RENDERING_VULKAN_TRANSFER_CONTEXT_H_